@@ -60,6 +60,12 @@ enum
     kitText,          /* text string => id */
     kitU64,           /* uint64 (like file offset) to row id */
 
+    /* version 4 */
+
+    kitHash,          /* text string => id through a minimal perfect hash,
+                         found in constant time, no projection. mappings
+                         become visible when the index is committed */
+
     kitProj = 128     /* reverse index flag, row id => key */
 };
 
@@ -190,6 +196,21 @@ KDB_EXTERN rc_t CC KIndexConsistencyCheck ( const KIndex *self, uint32_t level,
     uint64_t *num_rows, uint64_t *num_holes );
 
 
+/* SetBulkInsert
+ *  switches an empty text index to a bulk loading mode, where
+ *  inserted keys are sorted on disk and the index is built by
+ *  KIndexCommit without holding all keys in memory.
+ *
+ *  inserts follow the same rules as in-core inserts: ids must
+ *  increase, and a key repeated after other keys is refused by
+ *  KIndexInsertText. ids can be projected, but keys cannot be
+ *  deleted or found until the index is committed.
+ *
+ *  "mem_limit" [ IN ] - memory to use for sorting, or 0 for default
+ */
+KDB_EXTERN rc_t CC KIndexSetBulkInsert ( KIndex *self, size_t mem_limit );
+
+
 /* Insert
  *  creates a mapping from key to id
  *  and potentially from id to key if supported
@@ -208,6 +229,12 @@ KDB_EXTERN rc_t CC KIndexInsertText ( KIndex *self, bool unique,
  */
 KDB_EXTERN rc_t CC KIndexDeleteText ( KIndex *self, const char *key );
 
+/* CopyText
+ *  inserts all mappings of a projecting text index "src"
+ *  into "self", e.g. to build a kitHash index from a trie
+ */
+KDB_EXTERN rc_t CC KIndexCopyText ( KIndex *self, const KIndex *src );
+
 /* Find
  *  finds a single mapping from key
  *
@@ -227,6 +254,24 @@ KDB_EXTERN rc_t CC KIndexFindText ( const KIndex *self,
         struct PBSTNode const *n, void *data ),
     void *data );
 
+/* FindTextBatch
+ *  finds a single mapping for each of several keys,
+ *  sharing the work of looking up similar keys
+ *
+ *  "count" [ IN ] - number of keys
+ *
+ *  "keys" [ IN ] - array of NUL terminated strings to be found
+ *
+ *  "start_id" [ OUT ] and "id_count" [ OUT ] - arrays of "count"
+ *  elements receiving the found ranges in the order of "keys".
+ *  keys that are not found have an "id_count" of 0.
+ *
+ *  "num_found" [ OUT, NULL OKAY ] - the number of keys found
+ */
+KDB_EXTERN rc_t CC KIndexFindTextBatch ( const KIndex *self,
+    uint32_t count, const char *const keys [],
+    int64_t start_id [], uint64_t id_count [], uint32_t *num_found );
+
 /* FindAll
  *  finds all mappings from key
  */
@@ -293,6 +338,25 @@ KDB_EXTERN rc_t CC KIndexDeleteU64 ( KIndex *self, uint64_t key );
 KDB_EXTERN rc_t CC KIndexFindU64 ( const KIndex *self, uint64_t offset,
     uint64_t *key, uint64_t *key_size, int64_t *start_id, uint64_t *id_count );
 
+/* FindU64Batch
+ *  finds a FIRST chunk for each of several offsets within file
+ *
+ *  "count" [ IN ] - number of offsets
+ *
+ *  "offset" [ IN ] - array of offsets to be found
+ *
+ *  "key" [ OUT ], "key_size" [ OUT ], "start_id" [ OUT ] and
+ *  "id_count" [ OUT ] - arrays of "count" elements receiving the
+ *  found chunks in the order of "offset". offsets that are not
+ *  found have an "id_count" of 0.
+ *
+ *  "num_found" [ OUT, NULL OKAY ] - the number of offsets found
+ */
+KDB_EXTERN rc_t CC KIndexFindU64Batch ( const KIndex *self,
+    uint32_t count, const uint64_t offset [],
+    uint64_t key [], uint64_t key_size [],
+    int64_t start_id [], uint64_t id_count [], uint32_t *num_found );
+
 /* FindAllU64
  *  Iterate through all chunks with an offset and call f() for each range
  */
@@ -87,6 +87,42 @@ KFS_EXTERN rc_t CC KBufWriteFileMakeWrite ( struct KFile ** bp,
      struct KFile * original, size_t bsize );
 
 
+/* MakeReadAhead
+ *  make a read-only file buffer for sequential scans over slow storage
+ *
+ *  while reads are sequential, the next window of the original file is
+ *  read by a background thread and the window doubles every time the
+ *  reader moves into it; a random access shrinks it back to "bsize"
+ *
+ *  "bp" [ OUT ] - return parameter for new buffered file
+ *
+ *  "original" [ IN ] - source file to be buffered. must have read access
+ *
+ *  "bsize" [ IN ] - initial window size
+ *
+ *  "max_bsize" [ IN ] - upper limit of the window size, 0 for 16 * "bsize".
+ *  two windows of this size are allocated up front
+ */
+KFS_EXTERN rc_t CC KBufReadFileMakeReadAhead ( const struct KFile ** bp,
+     const struct KFile * original, size_t bsize, size_t max_bsize );
+
+/* GetReadAheadStats
+ *  report how well read-ahead is working for a file made by
+ *  KBufReadFileMakeReadAhead
+ *
+ *  "num_reads" [ OUT, NULL OKAY ] - number of read requests
+ *
+ *  "num_hits" [ OUT, NULL OKAY ] - requests served from a window
+ *  without reading the original file in the caller's thread
+ *
+ *  "bytes_prefetched" [ OUT, NULL OKAY ] - bytes read by the background thread
+ *
+ *  "window" [ OUT, NULL OKAY ] - current window size
+ */
+KFS_EXTERN rc_t CC KBufReadFileGetReadAheadStats ( const struct KFile * self,
+     uint64_t * num_reads, uint64_t * num_hits, uint64_t * bytes_prefetched, size_t * window );
+
+
 #ifdef __cplusplus
 }
 #endif
@@ -43,6 +43,7 @@ extern "C" {
  * forwards
  */
 struct KFile;
+struct KParZipPool;
 
 /* MakeBzip2ForRead
  *  creates an adapter to bunzip2 a source file
@@ -70,6 +71,28 @@ KFS_EXTERN rc_t CC KFileMakeBzip2ForRead ( struct KFile const **bz, struct KFile
 KFS_EXTERN rc_t CC KFileMakeBzip2ForWrite ( struct KFile **bz, struct KFile *src );
 
 
+/* MakeParallelBzip2ForWrite
+ *  creates an adapter to bzip2 a source file using a pool of threads
+ *
+ *  "bz" [ OUT ] - return parameter for compressed file
+ *
+ *  "src" [ IN ] - uncompressed source file with write permission
+ *
+ *  "chunk_size" [ IN ] - number of uncompressed bytes compressed
+ *  independently of each other, 0 for default ( 900K )
+ *
+ *  "pool" [ IN, NULL OKAY ] - compression threads shared with other
+ *  writers ( see <kfs/pzip.h> ). NULL starts a pool with the default
+ *  number of threads for this writer alone
+ *
+ * NB - output is a series of complete bzip2 streams in input order,
+ *  which bunzip2 reads as one. creates a write-only file that
+ *  must be written serially from offset 0
+ */
+KFS_EXTERN rc_t CC KFileMakeParallelBzip2ForWrite ( struct KFile **bz, struct KFile *src,
+    size_t chunk_size, struct KParZipPool *pool );
+
+
 #ifdef __cplusplus
 }
 #endif
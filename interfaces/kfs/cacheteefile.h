@@ -68,7 +68,8 @@ struct KDirectory;
  *                       ( if 0 ... default-value will be 32k )
  *
  *  "cluster" [ IN ] - a blocking factor for accessing "remote"
- *  reads are in blocks of size "blocksize" * "cluster"
+ *  the background filler reads ahead in requests of "blocksize" * "cluster" * 4
+ *  bytes, up to "blocksize" * "cluster" * 32 bytes past a sequential reader
  *  ( 1...4 makes most sense )
  *
  *  "report" [ IN ] - when true, provides more verbose debugging output
@@ -93,6 +94,11 @@ struct KDirectory;
  * part that comes first either from the remote or from the local file
  * in this case the file will return less data than requested
  *
+ * the process holding the lock on the local file fills it in a background thread
+ * ahead of sequential reads, and persists the bitmap of cached blocks in batches;
+ * other processes open the local file read-only and use every block the lock-holder
+ * has persisted, taking over the lock once the holder is gone
+ *
  * when the caller opens an existing local file that contains a full copy of the
  * remote file, the local KFile will be returned in self
  *
@@ -43,6 +43,7 @@ extern "C" {
  * forwards
  */
 struct KFile;
+struct KParZipPool;
 
 /* MakeGzipForRead
  *  creates an adapter to gunzip a source file
@@ -70,6 +71,28 @@ KFS_EXTERN rc_t CC KFileMakeGzipForRead ( struct KFile const **gz, struct KFile
 KFS_EXTERN rc_t CC KFileMakeGzipForWrite ( struct KFile **gz, struct KFile *file );
 
 
+/* MakeParallelGzipForWrite
+ *  creates an adapter to gzip a source file using a pool of threads
+ *
+ *  "gz" [ OUT ] - return parameter for compressed file
+ *
+ *  "src" [ IN ] - uncompressed source file with write permission
+ *
+ *  "chunk_size" [ IN ] - number of uncompressed bytes compressed
+ *  independently of each other, 0 for default ( 256K )
+ *
+ *  "pool" [ IN, NULL OKAY ] - compression threads shared with other
+ *  writers ( see <kfs/pzip.h> ). NULL starts a pool with the default
+ *  number of threads for this writer alone
+ *
+ * NB - output is a series of complete gzip members in input order,
+ *  which is a valid gzip stream. like KFileMakeGzipForWrite, creates
+ *  a write-only file that must be written serially from offset 0
+ */
+KFS_EXTERN rc_t CC KFileMakeParallelGzipForWrite ( struct KFile **gz, struct KFile *file,
+    size_t chunk_size, struct KParZipPool *pool );
+
+
 #ifdef __cplusplus
 }
 #endif
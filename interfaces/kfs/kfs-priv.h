@@ -35,6 +35,8 @@
 #include <klib/defs.h>
 #endif
 
+#include <stdarg.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -58,6 +60,40 @@ struct KNamelist;
 KFS_EXTERN rc_t CC KFileMakeFDFileRead ( struct KFile const **f, int fd );
 KFS_EXTERN rc_t CC KFileMakeFDFileWrite ( struct KFile **f, bool update, int fd );
 
+/* CopySysRange
+ *  copy a range of bytes from one file to another within the kernel
+ *  when both are backed by contiguous regions of system files
+ *  not supported under Windows
+ *
+ *  "dst" [ IN ] and "dst_pos" [ IN ] - destination file and position
+ *
+ *  "src" [ IN ] and "src_pos" [ IN ] - source file and position
+ *
+ *  "bytes" [ IN ] - number of bytes to copy
+ *
+ *  "num_copied" [ OUT ] - return parameter giving number of bytes
+ *  actually copied. a short count with zero return code means
+ *  end of source.
+ *
+ *  returns rcUnsupported when no bytes were copied because either
+ *  file lacks a system file or the platform refused the request;
+ *  the caller is then expected to fall back upon KFileRead/KFileWrite
+ */
+KFS_EXTERN rc_t CC KFileCopySysRange ( struct KFile *dst, uint64_t dst_pos,
+    struct KFile const *src, uint64_t src_pos, uint64_t bytes, uint64_t *num_copied );
+
+/* AdviseReadAhead
+ *  tell the operating system that a range of a file will be read soon,
+ *  so it can start reading it into the page cache
+ *  only a hint, not supported under Windows
+ *
+ *  "pos" [ IN ] and "bytes" [ IN ] - range of the file that will be read
+ *
+ *  returns rcUnsupported when the file lacks a system file
+ */
+KFS_EXTERN rc_t CC KFileAdviseReadAhead ( struct KFile const *self,
+    uint64_t pos, uint64_t bytes );
+
 /* GetMeta
  *  extracts metadata into a string-vector
  *
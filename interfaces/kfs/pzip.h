@@ -0,0 +1,78 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _h_kfs_pzip_
+#define _h_kfs_pzip_
+
+#ifndef _h_kfs_extern_
+#include <kfs/extern.h>
+#endif
+
+#ifndef _h_klib_defs_
+#include <klib/defs.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*--------------------------------------------------------------------------
+ * KParZipPool
+ *  compression threads shared by parallel gzip and bzip2 writers
+ *
+ *  every writer made with a pool hands its chunks to the same threads,
+ *  so any number of open compressed files can be written in parallel
+ *  without starting threads for each of them
+ */
+typedef struct KParZipPool KParZipPool;
+
+
+/* Make
+ *  starts a pool of compression threads
+ *
+ *  "pool" [ OUT ] - return parameter for new pool
+ *
+ *  "num_threads" [ IN ] - number of compression threads, 0 for default ( 4 ).
+ *  if no thread can be started, writers compress their own chunks
+ */
+KFS_EXTERN rc_t CC KParZipPoolMake ( KParZipPool **pool, uint32_t num_threads );
+
+
+/* AddRef
+ * Release
+ *  every writer keeps a reference to its pool:
+ *  the threads stop when the last writer and the caller let go
+ */
+KFS_EXTERN rc_t CC KParZipPoolAddRef ( const KParZipPool *self );
+KFS_EXTERN rc_t CC KParZipPoolRelease ( const KParZipPool *self );
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _h_kfs_pzip_ */
@@ -99,6 +99,16 @@ KLIB_EXTERN rc_t CC ReportInitVDB(
  */
 KLIB_EXTERN void CC ReportRecordZombieFile ( void );
 
+
+/* SeqConvUseVector
+ *  allows or forbids the vector implementations of the kernels
+ *  in <klib/seq-conv.h>. they are allowed by default and used when
+ *  the processor supports them. lets tests compare both paths
+ *
+ *  returns true if vector code will be used
+ */
+KLIB_EXTERN bool CC SeqConvUseVector ( bool allow );
+
 #ifdef __cplusplus
 }
 #endif
@@ -44,6 +44,7 @@ extern "C" {
  * forwards
  */
 struct Trie;
+struct TNode;
 struct String;
 
 
@@ -185,6 +186,26 @@ KLIB_EXTERN rc_t CC PTrieGetNode ( const PTrie *self, PTNode *node, uint32_t id
 KLIB_EXTERN uint32_t CC PTrieFind ( const PTrie *self, struct String const *key, PTNode *rtn,
     int ( CC * custom_cmp ) ( const void *item, const PBSTNode *n ,void *data), void * data );
 
+/* FindBatch
+ *  find a single { id, value } pair for each of several keys
+ *
+ *  "keys" [ IN ] and "count" [ IN ] - exact match text strings.
+ *  the transitions taken for a key are reused for the prefix it
+ *  shares with the previous key, so sorted keys are found fastest.
+ *
+ *  "rtn" [ OUT ] - array of "count" return parameters, one per key.
+ *  the id of a node is 0 when its key was not found.
+ *
+ *  "custom_cmp" [ IN, NULL OKAY ] and "data" [ OPAQUE ] - optional
+ *  comparison function
+ *
+ *  return value:
+ *    the number of keys found
+ */
+KLIB_EXTERN uint32_t CC PTrieFindBatch ( const PTrie *self,
+    struct String const *keys, uint32_t count, PTNode *rtn,
+    int ( CC * custom_cmp ) ( const void *item, const PBSTNode *n ,void *data), void * data );
+
 #if 0
 KLIB_EXTERN uint32_t CC PTrieFindRE ( const PTrie *self, struct String const *re, PTNode *rtn );
 #endif
@@ -289,6 +310,70 @@ KLIB_EXTERN rc_t CC TriePersist ( struct Trie const *self, size_t *num_writ, boo
     PTWriteFunc write, void *write_param, PTAuxFunc aux, void *aux_param );
 
 
+/*--------------------------------------------------------------------------
+ * PTrieBuilder
+ *  produces the persisted image of a Trie from keys arriving in sorted
+ *  order, without holding the keys in memory.
+ *
+ *  the shape of a Trie depends only upon its set of keys, so the
+ *  builder keeps just the transition nodes and, for every container,
+ *  the position of its first key within the caller's storage. the
+ *  keys themselves are loaded back one container at a time while
+ *  the image is being written.
+ */
+typedef struct PTrieBuilder PTrieBuilder;
+
+/* PTLoadFunc
+ *  loads "count" consecutive keys from caller's storage
+ *
+ *  "pos" [ IN ] - position given to PTrieBuilderAppend for the first key
+ *
+ *  "nodes" [ OUT ] - return parameter for "count" TNodes created
+ *  with TNodeMake. the builder takes ownership of them on success.
+ */
+typedef rc_t ( CC * PTLoadFunc ) ( void *param, uint64_t pos,
+    struct TNode **nodes, uint32_t count );
+
+/* Make
+ *  "accept" [ IN ] and "limit" [ IN ] - as with TrieInit.
+ *  the character set is always expanded to include new characters.
+ */
+KLIB_EXTERN rc_t CC PTrieBuilderMake ( PTrieBuilder **b,
+    const char *accept, uint32_t limit );
+
+/* Append
+ *  adds the next key
+ *
+ *  "key" [ IN ] - must sort after the previous key
+ *
+ *  "pos" [ IN ] - opaque position of the key within caller's storage.
+ *  keys are loaded back in runs, so the key following "pos" must be
+ *  the key appended after this one.
+ */
+KLIB_EXTERN rc_t CC PTrieBuilderAppend ( PTrieBuilder *self,
+    struct String const *key, uint64_t pos );
+
+/* Persist
+ *  writes the image TriePersist would write for a Trie holding the
+ *  appended keys. characters added to the set are numbered in order
+ *  of appearance, which may break ties in character frequency
+ *  differently. no keys may be appended afterward.
+ *
+ *  "load" [ IN ] and "load_param" [ IN ] - function for loading the
+ *  keys of a container. it is called twice for each container: once
+ *  to gather sizes and once to write.
+ *
+ *  all other parameters are as with TriePersist.
+ */
+KLIB_EXTERN rc_t CC PTrieBuilderPersist ( PTrieBuilder *self, size_t *num_writ,
+    bool ext_keys, PTWriteFunc write, void *write_param,
+    PTAuxFunc aux, void *aux_param, PTLoadFunc load, void *load_param );
+
+/* Whack
+ */
+KLIB_EXTERN void CC PTrieBuilderWhack ( PTrieBuilder *self );
+
+
 #ifdef __cplusplus
 }
 #endif
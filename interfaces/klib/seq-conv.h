@@ -0,0 +1,100 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _h_klib_seq_conv_
+#define _h_klib_seq_conv_
+
+#ifndef _h_klib_extern_
+#include <klib/extern.h>
+#endif
+
+#ifndef _h_klib_defs_
+#include <klib/defs.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*--------------------------------------------------------------------------
+ * sequence conversion kernels
+ *  element-wise table lookups that underlie conversions between
+ *  unpacked 2na, 4na and text, complementing, and quality offsets
+ *
+ *  a nibble map covers 2na => 4na, 2na/4na => text and 4na complement.
+ *  a byte map covers text => 2na/4na and text complement. the "Reverse"
+ *  forms write elements in reverse order, i.e. "dst [ i ]" is computed
+ *  from "src [ count - 1 - i ]", giving a reverse complement when the
+ *  map is a complement. "dst" and "src" may not overlap.
+ *
+ *  vector implementations are selected at run time when the
+ *  processor supports them, and give results identical to scalar code.
+ */
+
+
+/* MapNibbles
+ * MapNibblesReverse
+ *  "dst [ i ] = map [ src [ i ] ]" for source values below 16
+ *
+ *  returns the number of elements converted, which is less than
+ *  "count" only if a source value of 16 or more was found. in that
+ *  case the returned count is the number of leading elements converted
+ *  ( in destination order ) and the rest of "dst" is undefined.
+ */
+KLIB_EXTERN size_t CC SeqMapNibbles ( uint8_t *dst,
+    const uint8_t *src, size_t count, const uint8_t map [ 16 ] );
+KLIB_EXTERN size_t CC SeqMapNibblesReverse ( uint8_t *dst,
+    const uint8_t *src, size_t count, const uint8_t map [ 16 ] );
+
+
+/* MapBytes
+ * MapBytesReverse
+ *  "dst [ i ] = map [ src [ i ] ]" for all source values
+ */
+KLIB_EXTERN void CC SeqMapBytes ( uint8_t *dst,
+    const uint8_t *src, size_t count, const uint8_t map [ 256 ] );
+KLIB_EXTERN void CC SeqMapBytesReverse ( uint8_t *dst,
+    const uint8_t *src, size_t count, const uint8_t map [ 256 ] );
+
+
+/* AddOffset
+ * AddOffsetReverse
+ *  "dst [ i ] = src [ i ] + offset" modulo 256
+ *  e.g. an offset of 33 converts phred qualities to fastq text,
+ *  and -33 converts back. an offset of 0 copies or reverses.
+ */
+KLIB_EXTERN void CC SeqAddOffset ( uint8_t *dst,
+    const uint8_t *src, size_t count, int offset );
+KLIB_EXTERN void CC SeqAddOffsetReverse ( uint8_t *dst,
+    const uint8_t *src, size_t count, int offset );
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _h_klib_seq_conv_ */
@@ -0,0 +1,138 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _h_kproc_ordered_queue_
+#define _h_kproc_ordered_queue_
+
+#ifndef _h_klib_defs_
+#include <klib/defs.h>
+#endif
+
+#include <kproc/q-extern.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*--------------------------------------------------------------------------
+ * KOrderedItem
+ *  the first member of every item that goes through a KOrderedQueue
+ */
+typedef struct KOrderedItem KOrderedItem;
+struct KOrderedItem
+{
+    volatile bool done;     /* no worker needs the item any more */
+    volatile bool head;     /* the consumer is waiting for the item */
+};
+
+
+/*--------------------------------------------------------------------------
+ * KOrderedQueue
+ *  one producer submits items, a pool of workers takes them in any order
+ *  and one consumer gets them back in the order they were submitted.
+ *  every item is in two KQueues: the work queue that the workers pop
+ *  and the order queue that the consumer pops, so the capacity of the
+ *  order queue limits how many items are in flight at the same time
+ */
+typedef struct KOrderedQueue KOrderedQueue;
+
+/* AddRef
+ * Release
+ *  ignores NULL references
+ *
+ *  the last release whacks the items that are still queued
+ */
+KQ_EXTERN rc_t CC KOrderedQueueAddRef ( const KOrderedQueue *self );
+KQ_EXTERN rc_t CC KOrderedQueueRelease ( const KOrderedQueue *self );
+
+/* Make
+ *  create an empty queue object
+ *
+ *  "work" [ IN ] - minimum length of the queue of items waiting for a worker
+ *
+ *  "order" [ IN ] - minimum length of the queue of all items in submission order
+ *
+ *  "whack" [ IN ] and "data" [ IN, OPAQUE ] - destroys an item that the
+ *  queue cannot hand to the consumer
+ */
+KQ_EXTERN rc_t CC KOrderedQueueMake ( KOrderedQueue **q, uint32_t work, uint32_t order,
+    void ( CC * whack ) ( KOrderedItem *item, void *data ), void *data );
+
+/* Submit
+ *  the producer adds an item, it belongs to the queue from now on
+ *  and is whacked if it cannot be queued
+ *
+ *  "work" [ IN ] - false if the item goes straight to the consumer
+ */
+KQ_EXTERN rc_t CC KOrderedQueueSubmit ( KOrderedQueue *self, KOrderedItem *item, bool work );
+
+/* Seal
+ *  the producer submits no further items
+ */
+KQ_EXTERN rc_t CC KOrderedQueueSeal ( KOrderedQueue *self );
+
+/* Quit
+ *  Submit stops waiting for space in a full queue and HeadWait stops
+ *  waiting at all, the workers should hand back the items they take
+ *  without working on them
+ */
+KQ_EXTERN rc_t CC KOrderedQueueQuit ( KOrderedQueue *self );
+KQ_EXTERN bool CC KOrderedQueueQuitting ( const KOrderedQueue *self );
+
+/* Work
+ *  a worker takes the next item
+ *
+ *  "item" [ OUT ] - NULL once the queue is sealed and empty
+ */
+KQ_EXTERN rc_t CC KOrderedQueueWork ( KOrderedQueue *self, KOrderedItem **item );
+
+/* Done
+ *  the worker hands the item back to the consumer
+ */
+KQ_EXTERN rc_t CC KOrderedQueueDone ( KOrderedQueue *self, KOrderedItem *item );
+
+/* HeadWait
+ *  the worker waits until the consumer waits for the item, i.e. until
+ *  everything submitted before it has been consumed
+ */
+KQ_EXTERN rc_t CC KOrderedQueueHeadWait ( KOrderedQueue *self, KOrderedItem *item );
+
+/* Next
+ *  the consumer takes the next item in submission order, once it is done.
+ *  if waiting for it fails, the item stays with the queue: the next call
+ *  waits for it again and the last release whacks it
+ *
+ *  "item" [ OUT ] - NULL once the queue is sealed and empty
+ */
+KQ_EXTERN rc_t CC KOrderedQueueNext ( KOrderedQueue *self, KOrderedItem **item );
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _h_kproc_ordered_queue_ */
@@ -362,6 +362,38 @@ VDB_EXTERN rc_t CC VCursorCellDataDirect ( const VCursor *self, int64_t row_id,
     uint32_t *boff, uint32_t *row_len );
 
 
+/* CellDataRange
+ *  access pointers to a run of consecutive cells held in a single blob
+ *  bypasses SetRowId/OpenRow/CloseRow like CellDataDirect, but answers
+ *  for as many rows as the blob holding "first_id" will give
+ *
+ *  "col_idx" [ IN ] - index of column to be read, returned by "AddColumn"
+ *
+ *  "first_id" [ IN ] - id of first row to access
+ *
+ *  "max_rows" [ IN ] - capacity of "offsets" and "lengths" arrays
+ *
+ *  "elem_bits" [ OUT, NULL OKAY ] - optional return parameter for
+ *  element size in bits
+ *
+ *  "base" [ OUT ] - pointer to blob data, byte aligned
+ *
+ *  "offsets" [ OUT ] and "lengths" [ OUT ] - for each row returned,
+ *  the index of its first element relative to "base" and its number
+ *  of elements. i.e. row "first_id + i" starts at bit
+ *  "offsets [ i ] * elem_bits" from "base".
+ *
+ *  "num_rows" [ OUT ] - number of rows returned, from 1 to "max_rows",
+ *  stopping short at the end of the blob. callers continue with the
+ *  next id to cross into the following blob.
+ *
+ *  pointers are valid under the same terms as for CellDataDirect
+ */
+VDB_EXTERN rc_t CC VCursorCellDataRange ( const VCursor *self, uint32_t col_idx,
+    int64_t first_id, uint32_t max_rows, uint32_t *elem_bits, const void **base,
+    uint32_t *offsets, uint32_t *lengths, uint32_t *num_rows );
+
+
 /* Default
  *  give a default row value for cell
  *  TBD - document full cell data, not append
@@ -131,6 +131,30 @@ VFS_EXTERN rc_t CC VResolverQuery ( const VResolver * self,
     struct VPath const ** cache );
 
 
+/* QueryBatch
+ *  resolve "count" queries in one call
+ *
+ *  "queries" [ IN ] - array of paths, each as for VResolverQuery
+ *
+ *  "local", "remote", "cache" [ OUT, NULL OKAY ] - optional arrays
+ *   of "count" return parameters, each as for VResolverQuery
+ *
+ *  "rcs" [ OUT, NULL OKAY ] - optional array of "count" results.
+ *   when provided, every query is attempted and the function returns 0
+ *   unless its parameters are bad. when NULL, the first failure is returned
+ *   but the remaining queries are still attempted.
+ *
+ *  remote and local answers are remembered by the resolver for a while,
+ *  so repeated accessions within a batch or across batches do not go
+ *  back to the network or walk the local volumes again. remote answers
+ *  may also be kept on disk, see "/vfs/resolver-cache" in KConfig.
+ */
+VFS_EXTERN rc_t CC VResolverQueryBatch ( const VResolver * self,
+    VRemoteProtocols protocols, struct VPath const * const * queries,
+    uint32_t count, struct VPath const ** local, struct VPath const ** remote,
+    struct VPath const ** cache, rc_t * rcs );
+
+
 /* Local - DEPRECATED
  *  Find an existing local file/directory that is named by the accession.
  *  rcState of rcNotFound means it does not exist.
@@ -26,6 +26,7 @@
 #include <align/extern.h>
 
 #include <klib/rc.h>
+#include <klib/seq-conv.h>
 #include <insdc/insdc.h>
 #include <sysalloc.h>
 
@@ -36,7 +37,6 @@
 LIB_EXPORT rc_t CC DNAReverseCompliment(const INSDC_dna_text* seq, INSDC_dna_text* cmpl, uint32_t len)
 {
     rc_t rc = 0;
-    uint32_t i;
     static INSDC_dna_text compl[256] = "~";
 
     if( seq == NULL || compl == NULL ) {
@@ -66,13 +66,10 @@ LIB_EXPORT rc_t CC DNAReverseCompliment(const INSDC_dna_text* seq, INSDC_dna_tex
             x['2'] = '2';
             x['3'] = '3';
         }
-        cmpl += len;
-        for(i = 0; i < len; i++) {
-            *--cmpl= compl[(int)seq[i]];
-            if( *cmpl == '\0' ) {
-                rc = RC(rcAlign, rcFormatter, rcWriting, rcData, rcInvalid);
-                break;
-            }
+        /* unknown bases map to 0 */
+        SeqMapBytesReverse((uint8_t*)cmpl, (const uint8_t*)seq, len, (const uint8_t*)compl);
+        if( memchr(cmpl, '\0', len) != NULL ) {
+            rc = RC(rcAlign, rcFormatter, rcWriting, rcData, rcInvalid);
         }
     }
     ALIGN_DBGERR(rc);
@@ -1384,6 +1384,11 @@ LIB_EXPORT rc_t CC ReferenceObj_MakePlacementIterator ( const ReferenceObj* csel
                 o->last_ref_row_of_window_rel += ref_window_len;
                 o->last_ref_row_of_window_rel /= mgr->max_seq_len;
                 o->rowcount_of_ref = ( cself->end_rowid - cself->start_rowid ) + 1;
+                /* a window reaching the end of a linear reference must not read into
+                   the first row of the next reference, when the length of the reference
+                   is a multiple of max_seq_len the window-end points right at this row */
+                if ( !cself->circular && o->last_ref_row_of_window_rel >= o->rowcount_of_ref )
+                    o->last_ref_row_of_window_rel = o->rowcount_of_ref - 1;
 
                 /* get effective starting offset based on overlap
                    from alignments which started before the requested pos */
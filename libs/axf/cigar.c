@@ -47,6 +47,11 @@
 
 #include <insdc/insdc.h>
 
+#include "xform-priv.h"
+#include "blob-priv.h"
+#include "blob.h"
+#include "page-map.h"
+
 #define ARG_BASE(TYPE, N) (((TYPE const *)argv[(N)].u.data.base) + argv[(N)].u.data.first_elem)
 #define ARG_ALIAS(TYPE, NAME, N) TYPE const *const NAME = ARG_BASE(TYPE, N)
 #define ARG_ALIAS_COND(TYPE, NAME, N, ALT) TYPE const *const NAME = ((argc > (N)) ? ARG_BASE(TYPE, N) : ALT)
@@ -336,9 +341,13 @@ rc_t CC cigar_impl ( void *data, const VXformInfo *info, int64_t row_id,
     return rc;
 }
 
+/* cigar_row_2
+ *  writes the cigar #2 output for one row at element "offset" of "dst"
+ *  and returns its element count
+ */
 static
-rc_t CC cigar_impl_2 ( void *data, const VXformInfo *info, int64_t row_id,
-                        VRowResult *rslt, uint32_t argc, const VRowData argv [] )
+rc_t cigar_row_2 ( void const *data, KDataBuffer *dst, uint64_t offset,
+                   uint64_t *count, uint32_t argc, const VRowData argv [] )
 {
     self_t const *self = data;
     bool const *has_mismatch        = argv[0].u.data.base;
@@ -353,7 +362,7 @@ rc_t CC cigar_impl_2 ( void *data, const VXformInfo *info, int64_t row_id,
     uint64_t cnt;
     INSDC_coord_zero start;
     INSDC_coord_len *cigar_len = NULL;
-    KDataBuffer *buf = (self->version & 0x04) ? NULL : rslt->data;
+    KDataBuffer *buf = (self->version & 0x04) ? NULL : dst;
     
     assert(argv[0].u.data.elem_bits == 8);
     assert(argv[1].u.data.elem_bits == 8);
@@ -366,10 +375,11 @@ rc_t CC cigar_impl_2 ( void *data, const VXformInfo *info, int64_t row_id,
     read_len       += argv[3].u.data.first_elem;
 
     if( self->version & 0x4 ) {
-        rslt->data->elem_bits = sizeof(*cigar_len) * 8;
-        rslt->elem_count = nreads;
-        rc = KDataBufferResize(rslt->data, rslt->elem_count); if (rc) return rc;
-        cigar_len = rslt->data->base;
+        *count = nreads;
+        if (offset + nreads > dst->elem_count) {
+            rc = KDataBufferResize(dst, offset + nreads); if (rc) return rc;
+        }
+        cigar_len = ((INSDC_coord_len *)dst->base) + offset;
         if (argv[0].u.data.elem_count == 0 ||
             argv[1].u.data.elem_count == 0)
         {
@@ -378,19 +388,18 @@ rc_t CC cigar_impl_2 ( void *data, const VXformInfo *info, int64_t row_id,
         }
     }
     else {
-        rslt->data->elem_bits = 8;
-        rslt->elem_count = 0;
+        *count = 0;
     }
     for (n = 0, start = 0, ro_offset = 0; n < nreads; start += read_len[n++]) {
         if (argc == 4)
-            rc = cigar_string(buf, rslt->elem_count, &cnt, self->version & 0x1,
+            rc = cigar_string(buf, offset + *count, &cnt, self->version & 0x1,
                               has_mismatch, has_ref_offset,
                               start, start + read_len[n],
                               ref_offset, ro_len, &ro_offset);
         else {
             int32_t const *const reflen = argv[4].u.data.base;
             
-            rc = cigar_string_2(buf, rslt->elem_count, &cnt, self->version & 0x1,
+            rc = cigar_string_2(buf, offset + *count, &cnt, self->version & 0x1,
                                 has_mismatch, has_ref_offset,
                                 start, start + read_len[n],
                                 ref_offset, ro_len, &ro_offset,
@@ -400,11 +409,161 @@ rc_t CC cigar_impl_2 ( void *data, const VXformInfo *info, int64_t row_id,
         if (cigar_len != NULL /*self->version & 0x04*/)
             cigar_len[n] = cnt;
         else
-            rslt->elem_count += cnt;
+            *count += cnt;
     }
     return 0;
 }
 
+/* blob_rows
+ *  computes a whole output blob from the rows that all input blobs share
+ *  with "row_id", writing each row straight into the output buffer. a run
+ *  of rows over which every input repeats its data is computed once, and
+ *  a row equal to the one before it shares its data.
+ */
+#define BLOB_MAX_ARGS 8
+#define BLOB_ROW_RESERVE 4096
+
+typedef rc_t ( * blob_row_writer ) ( void const *self, KDataBuffer *dst, uint64_t offset,
+    uint64_t *count, uint32_t argc, const VRowData argv [] );
+
+static
+rc_t blob_rows ( void const *self, blob_row_writer write, uint32_t elem_bits,
+    int64_t row_id, VBlob **rslt, uint32_t argc, const VBlob *argv [], const char *name )
+{
+    rc_t rc;
+    uint32_t i;
+    int64_t id;
+    int64_t start_id = -INT64_MAX - 1;
+    int64_t stop_id = INT64_MAX;
+    uint64_t used = 0;
+    uint64_t last = 0;
+    uint64_t last_len = 0;
+    VBlob *blob;
+    VRowData args [ BLOB_MAX_ARGS ];
+    PageMapIterator iter [ BLOB_MAX_ARGS ];
+
+    assert ( ( elem_bits & 7 ) == 0 );
+    * rslt = NULL;
+    if ( argc == 0 || argc > BLOB_MAX_ARGS )
+        return RC ( rcXF, rcFunction, rcExecuting, rcParam, rcExcessive );
+
+    /* static inputs cover every row */
+    for ( i = 0; i < argc; ++ i )
+    {
+        if ( argv [ i ] -> start_id == -INT64_MAX - 1 )
+            continue;
+        if ( start_id < argv [ i ] -> start_id )
+            start_id = argv [ i ] -> start_id;
+        if ( stop_id > argv [ i ] -> stop_id )
+            stop_id = argv [ i ] -> stop_id;
+    }
+    if ( start_id == -INT64_MAX - 1 || stop_id == INT64_MAX )
+        start_id = stop_id = row_id;
+    assert ( start_id <= row_id && row_id <= stop_id );
+
+    rc = VBlobNew ( & blob, start_id, stop_id, name );
+    if ( rc != 0 )
+        return rc;
+    rc = PageMapNew ( & blob -> pm, BlobRowCount ( blob ) );
+    if ( rc == 0 )
+        rc = PageMapPreExpandFull ( blob -> pm, BlobRowCount ( blob ) );
+    if ( rc == 0 )
+        rc = KDataBufferMake ( & blob -> data, elem_bits, 0 );
+
+    for ( i = 0; rc == 0 && i < argc; ++ i )
+    {
+        const VBlob *in = argv [ i ];
+
+        if ( in -> start_id == -INT64_MAX - 1 )
+            rc = PageMapNewIterator ( in -> pm, & iter [ i ], 0, -1 );
+        else
+            rc = PageMapNewIterator ( in -> pm, & iter [ i ],
+                start_id - in -> start_id, stop_id - start_id + 1 );
+
+        memset ( & args [ i ], 0, sizeof args [ i ] );
+        args [ i ] . variant = vrdData;
+        args [ i ] . u . data . elem_bits = in -> data . elem_bits;
+        args [ i ] . u . data . base = in -> data . base;
+    }
+
+    for ( id = start_id; rc == 0 && id <= stop_id; )
+    {
+        uint64_t count;
+        size_t const bytes = elem_bits >> 3;
+        row_count_t rows = PageMapIteratorRepeatCount ( & iter [ 0 ] );
+
+        for ( i = 1; i < argc; ++ i )
+        {
+            row_count_t const n = PageMapIteratorRepeatCount ( & iter [ i ] );
+            if ( rows > n )
+                rows = n;
+        }
+        if ( id + rows > stop_id + 1 )
+            rows = ( row_count_t ) ( stop_id + 1 - id );
+
+        for ( i = 0; i < argc; ++ i )
+        {
+            args [ i ] . u . data . elem_count = PageMapIteratorDataLength ( & iter [ i ] );
+            args [ i ] . u . data . first_elem = PageMapIteratorDataOffset ( & iter [ i ] );
+        }
+
+        /* keep room ahead so that the writers rarely reallocate */
+        if ( blob -> data . elem_count < used + BLOB_ROW_RESERVE )
+        {
+            uint64_t capacity = blob -> data . elem_count * 2;
+            if ( capacity < used + BLOB_ROW_RESERVE )
+                capacity = used + BLOB_ROW_RESERVE;
+            rc = KDataBufferResize ( & blob -> data, capacity );
+            if ( rc != 0 )
+                break;
+        }
+
+        rc = ( * write ) ( self, & blob -> data, used, & count, argc, args );
+        if ( rc != 0 )
+            break;
+
+        if ( id != start_id && count == last_len &&
+             memcmp ( ( const char* ) blob -> data . base + last * bytes,
+                      ( const char* ) blob -> data . base + used * bytes,
+                      ( size_t ) ( count * bytes ) ) == 0 )
+        {
+            rc = PageMapAppendRows ( blob -> pm, count, rows, true );
+        }
+        else
+        {
+            last = used;
+            last_len = count;
+            used += count;
+            rc = PageMapAppendRows ( blob -> pm, count, rows, false );
+        }
+
+        for ( i = 0; i < argc; ++ i )
+            PageMapIteratorAdvance ( & iter [ i ], rows );
+        id += rows;
+    }
+
+    /* trim to the filled size: shrinking does not reallocate */
+    if ( rc == 0 )
+        rc = KDataBufferResize ( & blob -> data, used );
+    if ( rc == 0 )
+    {
+        * rslt = blob;
+        return 0;
+    }
+    VBlobRelease ( blob );
+    return rc;
+}
+
+static
+rc_t CC cigar_blob_2 ( void *data, const VXformInfo *info, int64_t row_id,
+    VBlob **rslt, uint32_t argc, const VBlob *argv [] )
+{
+    self_t const *self = data;
+
+    return blob_rows(self, cigar_row_2, (self->version & 0x4) ? sizeof(INSDC_coord_len) * 8 : 8,
+                     row_id, rslt, argc, argv, "ALIGN:cigar_2");
+}
+
 static
 void CC self_whack( void *ptr )
 {
@@ -460,8 +619,8 @@ VTRANSFACT_IMPL ( ALIGN_cigar_2, 2, 0, 0 ) ( const void *Self, const VXfactInfo
     } else {
         return RC(rcXF, rcFunction, rcConstructing, rcParam, rcIncorrect);
     }
-    rslt->u.rf = cigar_impl_2;
-    rslt->variant = vftRow;
+    VFUNCDESC_INTERNAL_FUNCS(rslt)->bfN = cigar_blob_2;
+    rslt->variant = vftBlobN;
     rslt->self = malloc(sizeof self);
     memcpy(rslt->self, &self, sizeof(self));
     rslt->whack = self_whack;
@@ -590,11 +749,15 @@ unsigned edit_distance(bool const has_ref_offset[],
     }
 }
 
+/* edit_distance_row_2
+ *  writes the edit_distance #2 output for one row at element "offset"
+ *  of "dst" and returns its element count
+ */
 static
-rc_t CC edit_distance_2_impl ( void *data, const VXformInfo *info, int64_t row_id,
-    VRowResult *rslt, uint32_t argc, const VRowData argv [] )
+rc_t edit_distance_row_2 ( void const *self, KDataBuffer *dst, uint64_t offset,
+                           uint64_t *count, uint32_t argc, const VRowData argv [] )
 {
-    rc_t rc;
+    rc_t rc = 0;
     unsigned const nreads = argc > 4 ? argv[4].u.data.elem_count : 1;
     unsigned const len = argv[0].u.data.elem_count;
     unsigned const noffsets = argv[2].u.data.elem_count;
@@ -611,20 +774,19 @@ rc_t CC edit_distance_2_impl ( void *data, const VXformInfo *info, int64_t row_i
     assert(argv[2].u.data.elem_bits == sizeof(ref_offset    [0]) * 8);
     assert(argv[3].u.data.elem_bits == sizeof(ref_len       [0]) * 8);
 
-    rslt->data->elem_bits = rslt->elem_bits;
-    if (len == 0) {
-        return KDataBufferResize(rslt->data, rslt->elem_count = 0);
-    }
+    *count = 0;
+    if (len == 0)
+        return 0;
     
     assert(len == argv[1].u.data.elem_count);
 
-    rslt->elem_count = nreads;
-    rc = KDataBufferResize(rslt->data, nreads);
+    if (offset + nreads > dst->elem_count)
+        rc = KDataBufferResize(dst, offset + nreads);
     if (rc == 0) {
         unsigned i;
         unsigned start = 0;
-        unsigned offset = 0;
-        uint32_t *const dst = rslt->data->base;
+        unsigned offset_ro = 0;
+        uint32_t *const out = ((uint32_t *)dst->base) + offset;
         
         for (i = 0; i < nreads; ++i) {
             unsigned const rlen = readlen[i];
@@ -635,22 +797,31 @@ rc_t CC edit_distance_2_impl ( void *data, const VXformInfo *info, int64_t row_i
                 if (has_ref_offset[start + j])
                     ++offsets;
             }
-            if (offsets + offset > noffsets)
+            if (offsets + offset_ro > noffsets)
                 return RC(rcXF, rcFunction, rcExecuting, rcData, rcInvalid);
             
-            dst[i] = edit_distance(has_ref_offset + start,
+            out[i] = edit_distance(has_ref_offset + start,
                                    has_mismatch + start,
                                    rlen,
                                    ref_len[0],
-                                   ref_offset + offset,
+                                   ref_offset + offset_ro,
                                    offsets);
             start += rlen;
-            offset += offsets;
+            offset_ro += offsets;
         }
+        *count = nreads;
     }
     return rc;
 }
 
+static
+rc_t CC edit_distance_2_blob ( void *data, const VXformInfo *info, int64_t row_id,
+    VBlob **rslt, uint32_t argc, const VBlob *argv [] )
+{
+    return blob_rows(NULL, edit_distance_row_2, 32, row_id, rslt, argc, argv,
+                     "NCBI:align:edit_distance_2");
+}
+
 /*
  * function
  * U32 NCBI:align:edit_distance #2 ( bool has_mismatch, bool has_ref_offset,
@@ -659,8 +830,8 @@ rc_t CC edit_distance_2_impl ( void *data, const VXformInfo *info, int64_t row_i
 VTRANSFACT_IMPL ( NCBI_align_edit_distance_2, 2, 0, 0 ) ( const void *Self, const VXfactInfo *info,
     VFuncDesc *rslt, const VFactoryParams *cp, const VFunctionParams *dp )
 {
-    rslt->u.rf = edit_distance_2_impl;
-    rslt->variant = vftRow;
+    VFUNCDESC_INTERNAL_FUNCS(rslt)->bfN = edit_distance_2_blob;
+    rslt->variant = vftBlobN;
     return 0;
 }
 
@@ -44,6 +44,31 @@
 #include <assert.h>
 
 
+/* REFERENCE rows kept unpacked: nearby alignments hit the same rows */
+#define REF_CHUNK_CACHE_SIZE 16
+/* recently seen references: alignments of mates may alternate between them */
+#define REF_INFO_CACHE_SIZE 4
+
+typedef struct RefChunk RefChunk;
+struct RefChunk
+{
+    int64_t row_id; /* 0 - unused */
+    uint64_t stamp; /* for LRU replacement */
+    uint32_t bits;
+    uint32_t len;
+    KDataBuffer data; /* byte aligned copy of the row */
+};
+
+typedef struct RefInfo RefInfo;
+struct RefInfo
+{
+    int64_t start_id;
+    int64_t stop_id;
+    uint32_t max_seq_len;
+    INSDC_coord_len seq_len;
+    bool circular;
+};
+
 typedef struct RefTableSubSelect RefTableSubSelect;
 struct RefTableSubSelect
 {
@@ -70,6 +95,10 @@ struct RefTableSubSelect
             INSDC_coord_len seq_len;
             bool circular;
             bool local;
+            RefInfo info[REF_INFO_CACHE_SIZE];
+            uint32_t info_next; /* round robin replacement */
+            RefChunk chunk[REF_CHUNK_CACHE_SIZE];
+            uint64_t chunk_stamp;
         } ref;
         struct {
             uint32_t ref_id_idx;
@@ -82,6 +111,53 @@ struct RefTableSubSelect
     } u;
 };
 
+static
+rc_t RefTableSubSelect_GetChunk(RefTableSubSelect* self, int64_t row_id, const RefChunk** chunk)
+{
+    rc_t rc;
+    uint32_t i;
+    RefChunk* victim = &self->u.ref.chunk[0];
+    uint32_t bits, boff, row_len;
+    const void* output;
+
+    for (i = 0; i < REF_CHUNK_CACHE_SIZE; ++i) {
+        RefChunk* c = &self->u.ref.chunk[i];
+        if (c->row_id == row_id && row_id != 0) {
+            c->stamp = ++self->u.ref.chunk_stamp;
+            *chunk = c;
+            return 0;
+        }
+        if (c->stamp < victim->stamp) {
+            victim = c;
+        }
+    }
+
+    if ((rc = VCursorCellDataDirect(self->curs, row_id, self->out_idx, &bits, &output, &boff, &row_len)) != 0) {
+        return rc;
+    }
+    if (victim->data.base == NULL || victim->bits != bits) {
+        KDataBufferWhack(&victim->data);
+        rc = KDataBufferMake(&victim->data, bits, row_len);
+    }
+    else {
+        rc = KDataBufferResize(&victim->data, row_len);
+    }
+    if (rc == 0) {
+        if (row_len > 0) {
+            bitcpy(victim->data.base, 0, output, boff, (bitsz_t)row_len * bits);
+        }
+        victim->row_id = row_id;
+        victim->stamp = ++self->u.ref.chunk_stamp;
+        victim->bits = bits;
+        victim->len = row_len;
+        *chunk = victim;
+    }
+    else {
+        victim->row_id = 0;
+    }
+    return rc;
+}
+
 /*
   ref_ploidy != 0 means that offset here is relative to ref_row_id, so it can be
     negative or positive and can extend between rows within same refseq
@@ -96,6 +172,21 @@ rc_t CC REFERENCE_TABLE_sub_select(RefTableSubSelect* self, int64_t ref_row_id,
     rc_t rc = 0;
     INSDC_coord_len num_read;
     
+    if (ref_row_id < self->u.ref.start_id || ref_row_id > self->u.ref.stop_id ) {
+        uint32_t i;
+        for (i = 0; i < REF_INFO_CACHE_SIZE; ++i) {
+            const RefInfo* ri = &self->u.ref.info[i];
+            if (ri->max_seq_len != 0 && ref_row_id >= ri->start_id && ref_row_id <= ri->stop_id) {
+                /* seen recently */
+                self->u.ref.start_id = ri->start_id;
+                self->u.ref.stop_id = ri->stop_id;
+                self->u.ref.seq_len = ri->seq_len;
+                self->u.ref.max_seq_len = ri->max_seq_len;
+                self->u.ref.circular = ri->circular;
+                break;
+            }
+        }
+    }
     if (ref_row_id < self->u.ref.start_id || ref_row_id > self->u.ref.stop_id ) {
         /* update cached ref data if ref has changed */
         const char* n;
@@ -144,10 +235,17 @@ rc_t CC REFERENCE_TABLE_sub_select(RefTableSubSelect* self, int64_t ref_row_id,
                     && (rc = VCursorCellDataDirect(self->curs, self->u.ref.stop_id, self->u.ref.max_seq_len_idx, NULL, (const void**)&m, NULL, NULL)) == 0
                     )
                 {
+                    RefInfo* ri = &self->u.ref.info[self->u.ref.info_next++ % REF_INFO_CACHE_SIZE];
+
                     self->u.ref.circular = c[0] || cmp_read_len != 0;
                     self->u.ref.seq_len = m[0] * (self->u.ref.stop_id - self->u.ref.start_id) + sl[0];
                     self->u.ref.max_seq_len = m[0];
                     
+                    ri->start_id = self->u.ref.start_id;
+                    ri->stop_id = self->u.ref.stop_id;
+                    ri->seq_len = self->u.ref.seq_len;
+                    ri->max_seq_len = self->u.ref.max_seq_len;
+                    ri->circular = self->u.ref.circular;
                 }
             }
         }
@@ -171,12 +269,12 @@ rc_t CC REFERENCE_TABLE_sub_select(RefTableSubSelect* self, int64_t ref_row_id,
     }
     /* read the data */
     for(num_read = 0; rc == 0 && num_read < ref_len && ref_row_id <= self->u.ref.stop_id; offset = 0) {
-        uint32_t bits;
-        const void* output;
-        uint32_t boff;
-        uint32_t row_len;
+        const RefChunk* chunk = NULL;
         
-        if ((rc = VCursorCellDataDirect(self->curs, ref_row_id,self->out_idx, &bits, &output, &boff, &row_len)) == 0 ) {
+        if ((rc = RefTableSubSelect_GetChunk(self, ref_row_id, &chunk)) == 0 ) {
+            uint32_t const bits = chunk->bits;
+            uint32_t row_len = chunk->len;
+
             /* row_len MUST be > offset */
             if (row_len <= offset ) {
                 rc = RC(rcXF, rcFunction, rcSelecting, rcData, rcCorrupt);
@@ -187,7 +285,14 @@ rc_t CC REFERENCE_TABLE_sub_select(RefTableSubSelect* self, int64_t ref_row_id,
                     row_len = ref_len - num_read;
                 }
                 /* copy data */
-                bitcpy(rslt->data->base, rslt->elem_count * bits, output, offset * bits + boff, row_len * bits);
+                if ((bits & 7) == 0) {
+                    memcpy(((uint8_t*)rslt->data->base) + (rslt->elem_count * bits >> 3),
+                           ((const uint8_t*)chunk->data.base) + ((uint64_t)offset * bits >> 3),
+                           (size_t)row_len * bits >> 3);
+                }
+                else {
+                    bitcpy(rslt->data->base, rslt->elem_count * bits, chunk->data.base, offset * bits, row_len * bits);
+                }
                 rslt->elem_count += row_len;
                 num_read += row_len;
                 if (++ref_row_id > self->u.ref.stop_id && self->u.ref.circular ) {
@@ -291,6 +396,10 @@ void CC RefTableSubSelect_Whack ( void *obj )
             RefTableSubSelect_Whack(self->u.mod.parent);
         }
         else {
+            uint32_t i;
+            for (i = 0; i < REF_CHUNK_CACHE_SIZE; ++i) {
+                KDataBufferWhack(&self->u.ref.chunk[i].data);
+            }
             free(self->u.ref.name);
         }
         free(self);
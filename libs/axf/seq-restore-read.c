@@ -46,11 +46,44 @@
 #include <stdio.h>
 #include <insdc/sra.h>
 
+/* SEQUENCE rows looked ahead when reads are restored in row order:
+   starts with MIN, grows 4 times with every following batch up to MAX */
+#define RESTORE_READ_BATCH_MIN 4
+#define RESTORE_READ_BATCH_MAX 4096
+
+typedef struct RestoreReadItem RestoreReadItem;
+struct RestoreReadItem
+{
+    int64_t align_id;
+    uint64_t offset; /* into RestoreRead.data */
+    uint32_t len;
+};
+
 typedef struct RestoreRead RestoreRead;
 struct RestoreRead
 {
     const VCursor *curs;
     uint32_t read_idx;
+
+    /* SEQUENCE.PRIMARY_ALIGNMENT_ID: opened with the first batch */
+    const VTable *tbl;
+    const VCursor *seq_curs;
+    uint32_t seq_align_idx;
+    int64_t seq_last_row;
+    bool no_batch;
+
+    /* the last SEQUENCE row seen */
+    int64_t last_row;
+
+    /* alignment READs of SEQUENCE rows [ batch_first, batch_last ]
+       sorted by align_id */
+    int64_t batch_first;
+    int64_t batch_last;
+    uint32_t batch_rows;
+    RestoreReadItem *items;
+    uint32_t num_items;
+    uint32_t max_items;
+    KDataBuffer data;
 };
 
 static
@@ -58,7 +91,11 @@ void CC RestoreReadWhack ( void *obj )
 {
     RestoreRead * self = obj;
     if ( self != NULL ) {
+        VCursorRelease ( self -> seq_curs );
+        VTableRelease ( self -> tbl );
         VCursorRelease ( self -> curs );
+        KDataBufferWhack ( & self -> data );
+        free ( self -> items );
         free ( self );
     }
 }
@@ -69,7 +106,7 @@ rc_t RestoreReadMake ( RestoreRead **objp, const VTable *tbl )
     rc_t rc;
 
     /* create the object */
-    RestoreRead *obj = malloc ( sizeof * obj );
+    RestoreRead *obj = calloc ( 1, sizeof * obj );
     if ( obj == NULL ) {
         rc = RC ( rcXF, rcFunction, rcConstructing, rcMemory, rcExhausted );
     } else {
@@ -91,8 +128,18 @@ rc_t RestoreReadMake ( RestoreRead **objp, const VTable *tbl )
                     if ( rc == 0 ){
                         rc = VCursorOpen ( obj -> curs );
 			if ( rc == 0 ) {
-			   * objp = obj;
-			   return 0;
+			   rc = KDataBufferMakeBytes ( & obj -> data, 0 );
+			}
+			if ( rc == 0 ) {
+			   rc = VTableAddRef ( tbl );
+			   if ( rc == 0 ) {
+			      obj -> tbl = tbl;
+			      obj -> batch_first = 1;
+			      obj -> batch_last = 0;
+			      * objp = obj;
+			      return 0;
+			   }
+			   KDataBufferWhack ( & obj -> data );
 			}
 		    }
                     VCursorRelease ( obj -> curs );
@@ -122,6 +169,170 @@ static INSDC_4na_bin  map[]={
 /*15  1111 - 1111*/ 15
 };
 
+static
+rc_t RestoreReadOpenSeq ( RestoreRead *self )
+{
+    rc_t rc = VTableCreateCursorRead ( self -> tbl, & self -> seq_curs );
+    if ( rc == 0 ) {
+        rc = VCursorAddColumn ( self -> seq_curs, & self -> seq_align_idx, "PRIMARY_ALIGNMENT_ID" );
+        if ( rc == 0 ) {
+            rc = VCursorOpen ( self -> seq_curs );
+        }
+        if ( rc == 0 ) {
+            int64_t first;
+            uint64_t count;
+            rc = VCursorIdRange ( self -> seq_curs, self -> seq_align_idx, & first, & count );
+            if ( rc == 0 ) {
+                self -> seq_last_row = first + count - 1;
+                return 0;
+            }
+        }
+        VCursorRelease ( self -> seq_curs );
+        self -> seq_curs = NULL;
+    }
+    return rc;
+}
+
+static
+int CC RestoreReadItemCmp ( const void *a, const void *b )
+{
+    const RestoreReadItem *ia = a;
+    const RestoreReadItem *ib = b;
+    if ( ia -> align_id < ib -> align_id )
+        return -1;
+    return ia -> align_id > ib -> align_id;
+}
+
+/* RestoreReadFill
+ *  collect alignment ids of the following SEQUENCE rows,
+ *  fetch every alignment once and in id order
+ */
+static
+rc_t RestoreReadFill ( RestoreRead *self, int64_t row_id )
+{
+    rc_t rc = 0;
+    int64_t row, last;
+    uint64_t size;
+    uint32_t i, j;
+
+    if ( self -> seq_curs == NULL ) {
+        rc = RestoreReadOpenSeq ( self );
+        if ( rc != 0 ) {
+            self -> no_batch = true;
+            return rc;
+        }
+    }
+
+    if ( row_id == self -> batch_last + 1 ) {
+        if ( self -> batch_rows < RESTORE_READ_BATCH_MAX )
+            self -> batch_rows *= 4;
+    } else {
+        self -> batch_rows = RESTORE_READ_BATCH_MIN;
+    }
+    last = row_id + self -> batch_rows - 1;
+    if ( last > self -> seq_last_row )
+        last = self -> seq_last_row;
+
+    self -> batch_first = 1;
+    self -> batch_last = 0;
+    self -> num_items = 0;
+
+    for ( row = row_id; row <= last && rc == 0; ++ row ) {
+        const int64_t *ids;
+        uint32_t n;
+        rc = VCursorCellDataDirect ( self -> seq_curs, row, self -> seq_align_idx, NULL, ( const void** ) & ids, NULL, & n );
+        for ( i = 0; i < n && rc == 0; ++ i ) {
+            if ( ids [ i ] <= 0 )
+                continue;
+            if ( self -> num_items == self -> max_items ) {
+                uint32_t max_items = self -> max_items == 0 ? 1024 : self -> max_items * 2;
+                RestoreReadItem *items = realloc ( self -> items, max_items * sizeof * items );
+                if ( items == NULL ) {
+                    rc = RC ( rcXF, rcFunction, rcExecuting, rcMemory, rcExhausted );
+                    break;
+                }
+                self -> items = items;
+                self -> max_items = max_items;
+            }
+            self -> items [ self -> num_items ++ ] . align_id = ids [ i ];
+        }
+    }
+
+    if ( rc == 0 && self -> num_items > 1 ) {
+        qsort ( self -> items, self -> num_items, sizeof * self -> items, RestoreReadItemCmp );
+        for ( i = 1, j = 0; i < self -> num_items; ++ i ) {
+            if ( self -> items [ i ] . align_id != self -> items [ j ] . align_id )
+                self -> items [ ++ j ] = self -> items [ i ];
+        }
+        self -> num_items = j + 1;
+    }
+
+    for ( i = 0, size = 0; i < self -> num_items && rc == 0; ++ i ) {
+        RestoreReadItem *item = & self -> items [ i ];
+        const INSDC_4na_bin *r_src;
+        uint32_t r_src_len;
+        rc = VCursorCellDataDirect ( self -> curs, item -> align_id, self -> read_idx, NULL, ( const void** ) & r_src, NULL, & r_src_len );
+        if ( rc == 0 ) {
+            rc = KDataBufferResize ( & self -> data, size + r_src_len );
+            if ( rc == 0 ) {
+                memcpy ( ( uint8_t* ) self -> data . base + size, r_src, r_src_len );
+                item -> offset = size;
+                item -> len = r_src_len;
+                size += r_src_len;
+            }
+        }
+    }
+
+    if ( rc == 0 ) {
+        self -> batch_first = row_id;
+        self -> batch_last = last;
+    } else {
+        self -> num_items = 0;
+    }
+    return rc;
+}
+
+static
+const RestoreReadItem *RestoreReadFind ( const RestoreRead *self, int64_t align_id )
+{
+    uint32_t lo = 0, hi = self -> num_items;
+    while ( lo < hi ) {
+        uint32_t mid = lo + ( hi - lo ) / 2;
+        const RestoreReadItem *item = & self -> items [ mid ];
+        if ( item -> align_id == align_id )
+            return item;
+        if ( item -> align_id < align_id )
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return NULL;
+}
+
+/* RestoreReadGet
+ *  READ of alignment "align_id" referenced from SEQUENCE row "row_id":
+ *  from the current batch, from a new batch when SEQUENCE is read in order
+ *  or directly from PRIMARY_ALIGNMENT on random access
+ */
+static
+rc_t RestoreReadGet ( RestoreRead *self, int64_t row_id, bool sequential,
+    int64_t align_id, const INSDC_4na_bin **r_src, uint32_t *r_src_len )
+{
+    if ( ! self -> no_batch ) {
+        const RestoreReadItem *item = NULL;
+        if ( row_id >= self -> batch_first && row_id <= self -> batch_last )
+            item = RestoreReadFind ( self, align_id );
+        else if ( sequential && RestoreReadFill ( self, row_id ) == 0 )
+            item = RestoreReadFind ( self, align_id );
+        if ( item != NULL ) {
+            * r_src = ( const INSDC_4na_bin* ) self -> data . base + item -> offset;
+            * r_src_len = item -> len;
+            return 0;
+        }
+    }
+    return VCursorCellDataDirect ( self -> curs, align_id, self -> read_idx, NULL, ( const void** ) r_src, NULL, r_src_len );
+}
+
 static
 rc_t CC seq_restore_read_impl ( void *data, const VXformInfo *info, int64_t row_id,
                                VRowResult *rslt, uint32_t argc, const VRowData argv [] )
@@ -137,6 +348,7 @@ rc_t CC seq_restore_read_impl ( void *data, const VXformInfo *info, int64_t row_
     const int64_t	*align_id	= argv[1].u.data.base;
     const INSDC_coord_len *read_len  	= argv[2].u.data.base;
     const uint8_t	*read_type	= argv[3].u.data.base;
+    bool		sequential	= row_id == self -> last_row + 1;
     
     assert(argv[0].u.data.elem_bits == 8);
     assert(argv[1].u.data.elem_bits == 64);
@@ -150,6 +362,8 @@ rc_t CC seq_restore_read_impl ( void *data, const VXformInfo *info, int64_t row_
     read_len  += argv [ 2 ] . u . data . first_elem;
     read_type += argv [ 3 ] . u . data . first_elem;
     
+    self -> last_row = row_id;
+
     for(i=0,len=0;i<num_reads;i++){
         len+=read_len[i];
     }
@@ -165,7 +379,7 @@ rc_t CC seq_restore_read_impl ( void *data, const VXformInfo *info, int64_t row_
             if(align_id[i] > 0) {
                     const INSDC_4na_bin *r_src;
                     uint32_t             r_src_len;
-                    rc = VCursorCellDataDirect ( self -> curs,  align_id[i], self -> read_idx, NULL, ( const void** ) & r_src, NULL, & r_src_len );
+                    rc = RestoreReadGet ( self, row_id, sequential, align_id[i], & r_src, & r_src_len );
                     if(rc == 0){
                         if(r_src_len == read_len[i]){
                             if(read_type[i]&SRA_READ_TYPE_FORWARD){
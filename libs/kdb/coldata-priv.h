@@ -39,6 +39,7 @@ extern "C" {
  * forwards
  */
 typedef union KColumnPageMap KColumnPageMap;
+struct KLock;
 
 
 /*--------------------------------------------------------------------------
@@ -58,6 +59,10 @@ struct KColumnData
     /* data fork itself */
     struct KFile const *f;
 
+    /* serializes reads through the buffered file
+       when a column is shared between threads */
+    struct KLock *lock;
+
     /* page size */
     size_t pgsize;
 };
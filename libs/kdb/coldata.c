@@ -29,6 +29,7 @@
 #include <kfs/file.h>
 #include <kfs/buffile.h>
 #include <kfs/impl.h>
+#include <kproc/lock.h>
 #include <klib/rc.h>
 #include <sysalloc.h>
 
@@ -95,6 +96,15 @@ rc_t KColumnDataOpenRead ( KColumnData *self,
 #endif
     if ( rc == 0 )
         rc = KColumnDataInit ( self, eof, pgsize );
+    if ( rc == 0 )
+    {
+        rc = KLockMake ( & self -> lock );
+        if ( rc != 0 )
+        {
+            KFileRelease ( self -> f );
+            self -> f = NULL;
+        }
+    }
     return rc;
 }
 
@@ -104,7 +114,11 @@ rc_t KColumnDataWhack ( KColumnData *self )
 {
     rc_t rc = KFileRelease ( self -> f );
     if ( rc == 0 )
+    {
         self -> f = NULL;
+        KLockRelease ( self -> lock );
+        self -> lock = NULL;
+    }
     return rc;
 }
 
@@ -114,6 +128,7 @@ rc_t KColumnDataWhack ( KColumnData *self )
 rc_t KColumnDataRead ( const KColumnData *self, const KColumnPageMap *pm,
     size_t offset, void *buffer, size_t bsize, size_t *num_read )
 {
+    rc_t rc;
     uint64_t pos;
 
     assert ( self != NULL );
@@ -127,7 +142,14 @@ rc_t KColumnDataRead ( const KColumnData *self, const KColumnPageMap *pm,
     }
 
     pos = pm -> pg * self -> pgsize;
-    return KFileRead ( self -> f, pos + offset, buffer, bsize, num_read );
+
+    rc = KLockAcquire ( self -> lock );
+    if ( rc == 0 )
+    {
+        rc = KFileRead ( self -> f, pos + offset, buffer, bsize, num_read );
+        KLockUnlock ( self -> lock );
+    }
+    return rc;
 }
 
 
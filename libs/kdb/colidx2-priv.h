@@ -73,6 +73,10 @@ struct KColumnIdx2
     /* full caching mechanism */
     KDataBuffer cstorage;
     uint32_t	last;
+
+    /* guards the cache and buffered file
+       when a column is shared between threads */
+    struct KLock *lock;
 };
 
 /* Open
@@ -29,6 +29,7 @@
 #include "idxblk-priv.h"
 #include <kfs/file.h>
 #include <kfs/buffile.h>
+#include <kproc/lock.h>
 #include <klib/rc.h>
 #include <sysalloc.h>
 
@@ -91,6 +92,14 @@ rc_t KColumnIdx2OpenRead ( KColumnIdx2 *self,
         return rc;
     }
 
+    rc = KLockMake ( & self -> lock );
+    if ( rc != 0 )
+    {
+        KDataBufferWhack ( & self -> cstorage );
+        memset ( self, 0, sizeof * self );
+        return rc;
+    }
+
     self -> last = 0;
 
     if ( eof == 0 )
@@ -141,6 +150,8 @@ rc_t KColumnIdx2Whack ( KColumnIdx2 *self )
             free(cache[i].block);
         }
         KDataBufferWhack(&self->cstorage);
+        KLockRelease ( self -> lock );
+        self -> lock = NULL;
     }
     return rc;
 }
@@ -171,7 +182,8 @@ rc_t KColIdxBlockLocateBlob ( const KColIdxBlock *iblk,
     return 0;
 }
 
-rc_t KColumnIdx2LocateBlob ( const KColumnIdx2 *self,
+static
+rc_t KColumnIdx2LocateBlobInt ( const KColumnIdx2 *self,
     KColBlobLoc *loc, const KColBlockLoc *bloc,
     int64_t first, int64_t upper, bool bswap )
 {
@@ -277,3 +289,17 @@ BSEARCH_DONE:
 
     return rc;
 }
+
+rc_t KColumnIdx2LocateBlob ( const KColumnIdx2 *self,
+    KColBlobLoc *loc, const KColBlockLoc *bloc,
+    int64_t first, int64_t upper, bool bswap )
+{
+    /* the block cache is updated on lookup */
+    rc_t rc = KLockAcquire ( self -> lock );
+    if ( rc == 0 )
+    {
+        rc = KColumnIdx2LocateBlobInt ( self, loc, bloc, first, upper, bswap );
+        KLockUnlock ( self -> lock );
+    }
+    return rc;
+}
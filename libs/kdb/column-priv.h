@@ -58,6 +58,7 @@ extern "C" {
 struct KTable;
 struct KDBManager;
 struct KDirectory;
+struct KDBOpenCacheEntry;
 
 
 /*--------------------------------------------------------------------------
@@ -68,6 +69,7 @@ struct KColumn
     struct KTable const *tbl;
     struct KDBManager const *mgr;
     struct KDirectory const *dir;
+    struct KDBOpenCacheEntry *cached;
 
     KColumnIdx idx;
     KColumnData df;
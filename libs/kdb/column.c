@@ -62,6 +62,10 @@ rc_t KColumnWhack ( KColumn *self )
 
     KRefcountWhack ( & self -> refcount, "KColumn" );
 
+    /* no longer shared */
+    KDBManagerOpenCacheRemove ( self -> mgr, self -> cached );
+    self -> cached = NULL;
+
     /* shut down index */
     rc = KColumnIdxWhack ( & self -> idx );
     if ( rc == 0 )
@@ -233,8 +237,8 @@ rc_t KColumnMakeRead ( KColumn **colp, const KDirectory *dir, const char *path )
  */
 static
 rc_t KDBManagerVOpenColumnReadInt ( const KDBManager *self,
-    const KColumn **colp, const KDirectory *wd, bool try_srapath,
-    const char *path, va_list args )
+    const KColumn **colp, const KDirectory *wd, const KTable *tbl,
+    bool try_srapath, const char *path, va_list args )
 {
     char colpath [ 4096 ];
     rc_t rc;
@@ -248,6 +252,14 @@ rc_t KDBManagerVOpenColumnReadInt ( const KDBManager *self,
         KColumn *col;
         const KDirectory *dir;
 
+        /* share a column already open under the same path */
+        col = KDBManagerOpenCacheFind ( self, wd, kptColumn, colpath );
+        if ( col != NULL )
+        {
+            * colp = col;
+            return 0;
+        }
+
         /* open table directory */
         rc = KDBOpenPathTypeRead ( self, wd, colpath, &dir, kptColumn, NULL, try_srapath );
         if ( rc == 0 )
@@ -256,6 +268,9 @@ rc_t KDBManagerVOpenColumnReadInt ( const KDBManager *self,
             if ( rc == 0 )
             {
                 col -> mgr = KDBManagerAttach ( self );
+                col -> tbl = KTableAttach ( tbl );
+                col -> cached = KDBManagerOpenCacheInsert ( self,
+                    wd, kptColumn, colpath, col, & col -> refcount );
                 * colp = col;
                 return 0;
             }
@@ -294,7 +309,7 @@ LIB_EXPORT rc_t CC KDBManagerVOpenColumnRead ( const KDBManager *self,
         return RC ( rcDB, rcMgr, rcOpening, rcSelf, rcNull );
 
     return KDBManagerVOpenColumnReadInt
-        ( self, col, self -> wd, true, path, args );
+        ( self, col, self -> wd, NULL, true, path, args );
 }
 
 
@@ -330,12 +345,7 @@ LIB_EXPORT rc_t CC KTableVOpenColumnRead ( const KTable *self,
     if ( rc == 0 )
     {
         rc = KDBManagerVOpenColumnReadInt ( self -> mgr,
-            colp, self -> dir, false, path, NULL );
-        if ( rc == 0 )
-        {
-            KColumn *col = ( KColumn* ) * colp;
-            col -> tbl = KTableAttach ( self );
-        }
+            colp, self -> dir, self, false, path, NULL );
     }
     return rc;
 }
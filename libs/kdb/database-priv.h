@@ -54,6 +54,7 @@ extern "C" {
 struct KDBManager;
 struct KDirectory;
 struct KMD5SumFmt;
+struct KDBOpenCacheEntry;
 
 
 /*--------------------------------------------------------------------------
@@ -71,6 +72,9 @@ struct KDatabase
     /* database directory */
     struct KDirectory KONST *dir;
 
+    /* entry in manager's read-only open cache */
+    struct KDBOpenCacheEntry *cached;
+
     /* MD5 format object */
     struct KMD5SumFmt *md5;
 
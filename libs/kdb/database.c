@@ -75,6 +75,10 @@ rc_t KDatabaseWhack ( KDatabase *self )
 
     KRefcountWhack ( & self -> refcount, "KDatabase" );
 
+    /* no longer shared */
+    KDBManagerOpenCacheRemove ( self -> mgr, self -> cached );
+    self -> cached = NULL;
+
     /* release dad */
     if ( self -> dad != NULL )
     {
@@ -188,6 +192,7 @@ rc_t KDatabaseMake ( KDatabase **dbp, const KDirectory *dir, const char *path )
     db -> mgr = NULL;
     db -> dad = NULL;
     db -> dir = dir;
+    db -> cached = NULL;
     KRefcountInit ( & db -> refcount, 1, "KDatabase", "make", path );
     strcpy ( db -> path, path );
 
@@ -207,8 +212,8 @@ rc_t KDatabaseMake ( KDatabase **dbp, const KDirectory *dir, const char *path )
  */
 static
 rc_t KDBManagerVOpenDBReadInt ( const KDBManager *self, const KDatabase **dbp,
-                                const KDirectory *wd, bool try_srapath,
-                                const char *path, va_list args )
+                                const KDirectory *wd, const KDatabase *dad,
+                                bool try_srapath, const char *path, va_list args )
 {
     rc_t rc;
 
@@ -224,17 +229,26 @@ rc_t KDBManagerVOpenDBReadInt ( const KDBManager *self, const KDatabase **dbp,
     {
         const KDirectory *dir;
 
+        /* share a database already open under the same path */
+        KDatabase *db = KDBManagerOpenCacheFind ( self, wd, kptDatabase, dbpath );
+        if ( db != NULL )
+        {
+            * dbp = db;
+            return 0;
+        }
+
         /* open the directory if its a database */
         rc = KDBOpenPathTypeRead ( self, wd, dbpath, &dir, kptDatabase, NULL, try_srapath );
         if ( rc == 0 )
         {
-            KDatabase *db;
-
             /* allocate a new guy */
             rc = KDatabaseMake ( & db, dir, dbpath );
             if ( rc == 0 )
             {
                 db -> mgr = KDBManagerAttach ( self );
+                db -> dad = KDatabaseAttach ( dad );
+                db -> cached = KDBManagerOpenCacheInsert ( self,
+                    wd, kptDatabase, dbpath, db, & db -> refcount );
                 * dbp = db;
                 return 0;
             }
@@ -282,7 +296,7 @@ LIB_EXPORT rc_t CC KDBManagerVOpenDBRead ( const KDBManager *self,
     if ( self == NULL )
         return RC ( rcDB, rcMgr, rcOpening, rcSelf, rcNull );
 
-    return KDBManagerVOpenDBReadInt ( self, db, self -> wd, true, path, args );
+    return KDBManagerVOpenDBReadInt ( self, db, self -> wd, NULL, true, path, args );
 }
 
 LIB_EXPORT rc_t CC KDatabaseVOpenDBRead ( const KDatabase *self,
@@ -304,12 +318,7 @@ LIB_EXPORT rc_t CC KDatabaseVOpenDBRead ( const KDatabase *self,
     if ( rc == 0 )
     {
         rc = KDBManagerVOpenDBReadInt ( self -> mgr, dbp,
-            self -> dir, false, path, NULL );
-        if ( rc == 0 )
-        {
-            KDatabase *db = ( KDatabase* ) * dbp;
-            db -> dad = KDatabaseAttach ( self );
-        }
+            self -> dir, self, false, path, NULL );
     }
 
     return rc;
@@ -36,7 +36,9 @@
 
 #include <vfs/manager.h>
 #include <kfs/directory.h>
+#include <kproc/lock.h>
 #include <klib/symbol.h>
+#include <atomic32.h>
 #include <klib/checksum.h>
 #include <klib/rc.h>
 #include <sysalloc.h>
@@ -65,6 +67,9 @@ rc_t KDBManagerWhack ( KDBManager *self )
 
     /* everything should be closed */
     assert ( self -> open_objs . root == NULL );
+    assert ( self -> open_cache . root == NULL );
+
+    KLockRelease ( self -> open_cache_lock );
 
     rc = VFSManagerRelease ( self -> vfsmgr );
 
@@ -190,6 +195,11 @@ rc_t KDBManagerMake ( KDBManager **mgrp, const KDirectory *wd, const char *op,
 
                     BSTreeInit ( & mgr -> open_objs );
 
+                    /* without a lock, objects are simply not shared */
+                    BSTreeInit ( & mgr -> open_cache );
+                    if ( KLockMake ( & mgr -> open_cache_lock ) != 0 )
+                        mgr -> open_cache_lock = NULL;
+
                     KRefcountInit ( & mgr -> refcount, 1, "KDBManager", op, "kmgr" );
 
                     * mgrp = mgr;
@@ -411,6 +421,163 @@ rc_t KDBManagerOpenObjectDelete ( KDBManager *self, KSymbol *obj )
 }
 
 
+/*--------------------------------------------------------------------------
+ * KDBOpenCacheEntry
+ *  a read-only object open within the manager
+ *
+ *  entries do not hold references: an object is found only while it
+ *  is open elsewhere, and removes its entry when it is whacked. a
+ *  lookup never revives an object whose count has already dropped to
+ *  zero, so a whack in progress simply causes a fresh open.
+ */
+#define KDB_OPEN_CACHE_LIMIT 4096
+
+typedef struct KDBOpenCacheEntry KDBOpenCacheEntry;
+struct KDBOpenCacheEntry
+{
+    BSTNode n;
+    const void *parent;
+    void *obj;
+    KRefcount *refcount;
+    uint32_t type;
+    char path [ 1 ];
+};
+
+typedef struct KDBOpenCacheKey KDBOpenCacheKey;
+struct KDBOpenCacheKey
+{
+    const void *parent;
+    const char *path;
+    uint32_t type;
+};
+
+static
+int CC KDBOpenCacheEntryCmp ( const void *item, const BSTNode *n )
+{
+    const KDBOpenCacheKey *key = item;
+    const KDBOpenCacheEntry *entry = ( const KDBOpenCacheEntry* ) n;
+
+    if ( key -> parent != entry -> parent )
+        return ( size_t ) key -> parent < ( size_t ) entry -> parent ? -1 : 1;
+    if ( key -> type != entry -> type )
+        return key -> type < entry -> type ? -1 : 1;
+    return strcmp ( key -> path, entry -> path );
+}
+
+static
+int CC KDBOpenCacheEntrySort ( const BSTNode *item, const BSTNode *n )
+{
+    const KDBOpenCacheEntry *entry = ( const KDBOpenCacheEntry* ) item;
+
+    KDBOpenCacheKey key;
+    key . parent = entry -> parent;
+    key . path = entry -> path;
+    key . type = entry -> type;
+
+    return KDBOpenCacheEntryCmp ( & key, n );
+}
+
+
+/* OpenCacheFind
+ */
+void *KDBManagerOpenCacheFind ( const KDBManager *self,
+    const void *parent, uint32_t type, const char *path )
+{
+    void *obj = NULL;
+
+    if ( self != NULL && self -> open_cache_lock != NULL &&
+         KLockAcquire ( self -> open_cache_lock ) == 0 )
+    {
+        const KDBOpenCacheEntry *entry;
+
+        KDBOpenCacheKey key;
+        key . parent = parent;
+        key . path = path;
+        key . type = type;
+
+        entry = ( const KDBOpenCacheEntry* )
+            BSTreeFind ( & self -> open_cache, & key, KDBOpenCacheEntryCmp );
+
+        /* attach only to a live object */
+        if ( entry != NULL && atomic32_read_and_add_gt ( entry -> refcount, 1, 0 ) > 0 )
+            obj = entry -> obj;
+
+        KLockUnlock ( self -> open_cache_lock );
+    }
+
+    return obj;
+}
+
+
+/* OpenCacheInsert
+ */
+KDBOpenCacheEntry *KDBManagerOpenCacheInsert ( const KDBManager *self,
+    const void *parent, uint32_t type, const char *path,
+    void *obj, KRefcount *refcount )
+{
+    KDBOpenCacheEntry *entry = NULL;
+
+    if ( self != NULL && self -> open_cache_lock != NULL &&
+         self -> open_cache_count < KDB_OPEN_CACHE_LIMIT )
+    {
+        entry = malloc ( sizeof * entry + strlen ( path ) );
+        if ( entry != NULL )
+        {
+            KDBManager *mgr = ( KDBManager* ) self;
+
+            entry -> parent = parent;
+            entry -> obj = obj;
+            entry -> refcount = refcount;
+            entry -> type = type;
+            strcpy ( entry -> path, path );
+
+            if ( KLockAcquire ( mgr -> open_cache_lock ) != 0 )
+            {
+                free ( entry );
+                return NULL;
+            }
+
+            /* an existing entry belongs to an object still being whacked */
+            if ( BSTreeInsertUnique ( & mgr -> open_cache,
+                     & entry -> n, NULL, KDBOpenCacheEntrySort ) == 0 )
+                ++ mgr -> open_cache_count;
+            else
+            {
+                free ( entry );
+                entry = NULL;
+            }
+
+            KLockUnlock ( mgr -> open_cache_lock );
+        }
+    }
+
+    return entry;
+}
+
+
+/* OpenCacheRemove
+ */
+void KDBManagerOpenCacheRemove ( const KDBManager *self, KDBOpenCacheEntry *entry )
+{
+    if ( entry != NULL )
+    {
+        KDBManager *mgr = ( KDBManager* ) self;
+
+        assert ( mgr != NULL );
+        assert ( mgr -> open_cache_lock != NULL );
+
+        /* the lock is needed to keep finders away from the tree;
+           there is no sane recovery from failing to acquire it */
+        KLockAcquire ( mgr -> open_cache_lock );
+        BSTreeUnlink ( & mgr -> open_cache, & entry -> n );
+        -- mgr -> open_cache_count;
+        KLockUnlock ( mgr -> open_cache_lock );
+
+        free ( entry );
+    }
+}
+
+
 /* ModDate
  *  return a modification timestamp for table
  */
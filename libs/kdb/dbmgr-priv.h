@@ -52,8 +52,10 @@ extern "C" {
  * forwards
  */
 struct KSymbol;
+struct KLock;
 struct KDirectory;
 struct VFSManager;
+struct KDBOpenCacheEntry;
 
 /*--------------------------------------------------------------------------
  * KDBManager
@@ -67,6 +69,11 @@ struct KDBManager
     /* open objects */
     BSTree open_objs;
 
+    /* read-only objects shared between openers */
+    BSTree open_cache;
+    struct KLock *open_cache_lock;
+    uint32_t open_cache_count;
+
     /* open references */
     KRefcount refcount;
 
@@ -118,6 +125,31 @@ rc_t KDBManagerOpenObjectAdd ( KDBManager *self, struct KSymbol *obj );
  */
 rc_t KDBManagerOpenObjectDelete ( KDBManager *self, struct KSymbol *obj );
 
+/* OpenCacheFind
+ *  look for a read-only object of "type" already open under "path"
+ *  relative to "parent" - the directory of its owner
+ *  returns the object with a new reference, or NULL
+ */
+void *KDBManagerOpenCacheFind ( const KDBManager *self,
+    const void *parent, uint32_t type, const char *path );
+
+/* OpenCacheInsert
+ *  share a newly opened and fully initialized read-only object
+ *  "refcount" is the object's own reference counter
+ *  returns an entry to be given back to OpenCacheRemove when the
+ *  object is whacked, or NULL if the object is not shared
+ */
+struct KDBOpenCacheEntry *KDBManagerOpenCacheInsert ( const KDBManager *self,
+    const void *parent, uint32_t type, const char *path,
+    void *obj, KRefcount *refcount );
+
+/* OpenCacheRemove
+ *  called from an object's whack
+ *  NULL entries are ignored
+ */
+void KDBManagerOpenCacheRemove ( const KDBManager *self,
+    struct KDBOpenCacheEntry *entry );
+
 
 #ifdef __cplusplus
 }
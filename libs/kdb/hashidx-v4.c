@@ -0,0 +1,277 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include <kdb/extern.h>
+
+#include "index-cmn.h"
+
+#include <kdb/index.h>
+#include <kfs/mmap.h>
+#include <klib/rc.h>
+#include <sysalloc.h>
+
+#include <byteswap.h>
+
+#include <string.h>
+#include <assert.h>
+
+#if _ARCH_BITS == 32
+#define UL( x ) x ## ULL
+#else
+#define UL( x ) x ## UL
+#endif
+
+
+/*--------------------------------------------------------------------------
+ * KHashIndex_v4
+ *  hash functions
+ */
+
+static
+uint64_t KHashIndexMix_v4 ( uint64_t h )
+{
+    h ^= h >> 33;
+    h *= UL ( 0xff51afd7ed558ccd );
+    h ^= h >> 33;
+    h *= UL ( 0xc4ceb9fe1a85ec53 );
+    h ^= h >> 33;
+    return h;
+}
+
+/* Hash
+ *  bytes are combined in little-endian order,
+ *  so that the hash does not depend upon the host
+ */
+uint64_t KHashIndexHash_v4 ( const char *key, size_t size, uint32_t seed )
+{
+    uint32_t i;
+    uint64_t k, h = seed ^ ( size * UL ( 0x9e3779b97f4a7c15 ) );
+    const uint8_t *p = ( const uint8_t* ) key;
+
+    for ( ; size >= 8; p += 8, size -= 8 )
+    {
+        k = ( uint64_t ) p [ 0 ]         | ( ( uint64_t ) p [ 1 ] << 8 )  |
+            ( ( uint64_t ) p [ 2 ] << 16 ) | ( ( uint64_t ) p [ 3 ] << 24 ) |
+            ( ( uint64_t ) p [ 4 ] << 32 ) | ( ( uint64_t ) p [ 5 ] << 40 ) |
+            ( ( uint64_t ) p [ 6 ] << 48 ) | ( ( uint64_t ) p [ 7 ] << 56 );
+        h ^= KHashIndexMix_v4 ( k );
+        h = ( ( h << 27 ) | ( h >> 37 ) ) * 5 + 0x52dce729;
+    }
+
+    for ( k = 0, i = 0; i < size; ++ i )
+        k |= ( uint64_t ) p [ i ] << ( i * 8 );
+    h ^= KHashIndexMix_v4 ( k ^ size );
+
+    return KHashIndexMix_v4 ( h );
+}
+
+/* Slot
+ *  the probe sequence of a key is ( h2 + disp * h3 ) % count,
+ *  with h2 and h3 drawn from a second mix of its hash
+ */
+uint32_t KHashIndexSlot_v4 ( uint64_t hash, uint32_t disp, uint32_t count )
+{
+    uint64_t g;
+
+    if ( ( disp & KHASHIDX_DIRECT_SLOT ) != 0 )
+        return disp & ~ KHASHIDX_DIRECT_SLOT;
+
+    g = KHashIndexMix_v4 ( hash ^ UL ( 0x2545f4914f6cdd1d ) );
+    return ( uint32_t ) ( ( ( g & 0xFFFFFFFF ) +
+        ( uint64_t ) disp * ( ( g >> 32 ) | 1 ) ) % count );
+}
+
+
+/*--------------------------------------------------------------------------
+ * KPHashIndex_v4
+ *  persisted hash index
+ */
+
+/* Init
+ *  opens and initializes persisted hash index
+ */
+rc_t KPHashIndexInit_v4 ( KPHashIndex_v4 *self, const KMMap *mm, bool byteswap )
+{
+    rc_t rc;
+    size_t size, disp_size, avail;
+    const KPHashIndexHdr_v4 *hdr;
+
+    memset ( self, 0, sizeof * self );
+    self -> byteswap = byteswap;
+
+    /* when opened for create, there will be no existing index */
+    if ( mm == NULL )
+        return 0;
+
+    rc = KMMapSize ( mm, & size );
+    if ( rc == 0 )
+        rc = KMMapAddrRead ( mm, ( const void** ) & hdr );
+    if ( rc != 0 )
+        return rc;
+
+    if ( size < sizeof * hdr )
+        return RC ( rcDB, rcIndex, rcConstructing, rcData, rcCorrupt );
+
+    if ( byteswap )
+    {
+        self -> first = bswap_64 ( hdr -> first );
+        self -> last = bswap_64 ( hdr -> last );
+        self -> key_bytes = bswap_64 ( hdr -> key_bytes );
+        self -> count = bswap_32 ( hdr -> count );
+        self -> num_buckets = bswap_32 ( hdr -> num_buckets );
+        self -> seed = bswap_32 ( hdr -> seed );
+    }
+    else
+    {
+        self -> first = hdr -> first;
+        self -> last = hdr -> last;
+        self -> key_bytes = hdr -> key_bytes;
+        self -> count = hdr -> count;
+        self -> num_buckets = hdr -> num_buckets;
+        self -> seed = hdr -> seed;
+    }
+
+    /* the file existed but was empty */
+    if ( self -> count == 0 )
+        return 0;
+
+    /* check that all arrays are within file,
+       each remainder is tested before it is subtracted from */
+    disp_size = ( ( size_t ) self -> num_buckets * sizeof self -> disp [ 0 ] + 7 ) & ~ ( size_t ) 7;
+    if ( self -> num_buckets == 0 || disp_size > size - sizeof * hdr )
+    {
+        self -> count = 0;
+        return RC ( rcDB, rcIndex, rcConstructing, rcData, rcCorrupt );
+    }
+    avail = size - sizeof * hdr - disp_size;
+    if ( avail / sizeof self -> slot [ 0 ] < self -> count ||
+         avail - ( size_t ) self -> count * sizeof self -> slot [ 0 ] < self -> key_bytes )
+    {
+        self -> count = 0;
+        return RC ( rcDB, rcIndex, rcConstructing, rcData, rcCorrupt );
+    }
+
+    self -> disp = ( const void* ) ( hdr + 1 );
+    self -> slot = ( const void* ) ( ( const char* ) self -> disp + disp_size );
+    self -> keys = ( const void* ) ( self -> slot + self -> count );
+
+    /* retain a reference to memory map */
+    rc = KMMapAddRef ( mm );
+    if ( rc == 0 )
+        self -> mm = mm;
+    else
+        self -> count = 0;
+
+    return rc;
+}
+
+/* Whack
+ */
+void KPHashIndexWhack_v4 ( KPHashIndex_v4 *self )
+{
+    KMMapRelease ( self -> mm );
+    memset ( self, 0, sizeof * self );
+}
+
+/* GetSlot
+ *  returns the contents of a slot, with key pointing into the heap
+ */
+rc_t KPHashIndexGetSlot_v4 ( const KPHashIndex_v4 *self, uint32_t i,
+    const char **key, size_t *key_size, int64_t *start_id, uint32_t *span )
+{
+    uint64_t off, end;
+    const KPHashIndexSlot_v4 *slot;
+
+    if ( i >= self -> count )
+        return RC ( rcDB, rcIndex, rcSelecting, rcId, rcNotFound );
+
+    slot = & self -> slot [ i ];
+    end = self -> key_bytes;
+    if ( self -> byteswap )
+    {
+        off = bswap_64 ( slot -> key_off );
+        if ( i + 1 < self -> count )
+            end = bswap_64 ( slot [ 1 ] . key_off );
+        * start_id = bswap_64 ( slot -> start_id );
+        * span = bswap_32 ( slot -> span );
+    }
+    else
+    {
+        off = slot -> key_off;
+        if ( i + 1 < self -> count )
+            end = slot [ 1 ] . key_off;
+        * start_id = slot -> start_id;
+        * span = slot -> span;
+    }
+
+    if ( off > end || end > self -> key_bytes )
+        return RC ( rcDB, rcIndex, rcSelecting, rcIndex, rcCorrupt );
+
+    * key = self -> keys + off;
+    * key_size = ( size_t ) ( end - off );
+    return 0;
+}
+
+/* Find
+ *  a lookup touches the displacement of the bucket, the slot
+ *  and, when the fingerprint matches, the key
+ */
+rc_t KPHashIndexFind_v4 ( const KPHashIndex_v4 *self,
+    const char *str, int64_t *start_id, uint32_t *span )
+{
+    if ( self -> count != 0 )
+    {
+        uint64_t hash;
+        uint32_t i, disp, fp;
+        size_t size = strlen ( str );
+
+        hash = KHashIndexHash_v4 ( str, size, self -> seed );
+        disp = self -> disp [ KHashIndexBucket_v4 ( hash, self -> num_buckets ) ];
+        if ( self -> byteswap )
+            disp = bswap_32 ( disp );
+
+        i = KHashIndexSlot_v4 ( hash, disp, self -> count );
+        if ( i < self -> count )
+        {
+            fp = self -> slot [ i ] . fp;
+            if ( self -> byteswap )
+                fp = bswap_32 ( fp );
+
+            if ( fp == KHashIndexFP_v4 ( hash ) )
+            {
+                const char *key;
+                size_t key_size;
+                rc_t rc = KPHashIndexGetSlot_v4 ( self, i, & key, & key_size, start_id, span );
+                if ( rc != 0 )
+                    return rc;
+                if ( key_size == size && memcmp ( key, str, size ) == 0 )
+                    return 0;
+            }
+        }
+    }
+
+    return RC ( rcDB, rcIndex, rcSelecting, rcString, rcNotFound );
+}
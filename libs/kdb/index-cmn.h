@@ -279,6 +279,99 @@ rc_t KU64IndexFindAll_v3 ( const KU64Index_v3 *self, uint64_t offset,
     rc_t ( CC * f ) ( uint64_t key, uint64_t key_size, int64_t id, uint64_t id_qty, void* data ),
     void* data );
 
+
+/*--------------------------------------------------------------------------
+ * V4 hash
+ *  maps text keys to id ranges through a minimal perfect hash
+ *
+ *  keys are hashed to buckets, and the displacement stored for each
+ *  bucket selects a distinct slot for each of its keys. the slot holds
+ *  a fingerprint of the key, rejecting most absent keys without
+ *  touching the key heap, and the id range. the key itself is stored
+ *  in a heap ordered by slot, so that its size is the distance to the
+ *  key of the next slot.
+ *
+ *  file layout:
+ *    KPHashIndexHdr_v4
+ *    uint32_t disp [ num_buckets ], padded to 8 bytes
+ *    KPHashIndexSlot_v4 slot [ count ]
+ *    char keys [ key_bytes ]
+ */
+typedef struct KPHashIndexHdr_v4 KPHashIndexHdr_v4;
+struct KPHashIndexHdr_v4
+{
+    KIndexFileHeader_v3 dad;
+    int64_t first, last;
+    uint64_t key_bytes;
+    uint32_t count;
+    uint32_t num_buckets;
+    uint32_t seed;
+    uint32_t reserved;
+};
+
+typedef struct KPHashIndexSlot_v4 KPHashIndexSlot_v4;
+struct KPHashIndexSlot_v4
+{
+    int64_t start_id;
+    uint64_t key_off;
+    uint32_t span;
+    uint32_t fp;
+};
+
+/* a displacement with this bit set is the slot of a single-key bucket */
+#define KHASHIDX_DIRECT_SLOT 0x80000000
+
+/*--------------------------------------------------------------------------
+ * KPHashIndex_v4
+ *  persisted hash index
+ */
+typedef struct KPHashIndex_v4 KPHashIndex_v4;
+struct KPHashIndex_v4
+{
+    int64_t first, last;
+    uint64_t key_bytes;
+    struct KMMap const *mm;
+    const uint32_t *disp;
+    const KPHashIndexSlot_v4 *slot;
+    const char *keys;
+    uint32_t count;
+    uint32_t num_buckets;
+    uint32_t seed;
+    bool byteswap;
+};
+
+/* hash of a key, shared by builder and reader */
+uint64_t KHashIndexHash_v4 ( const char *key, size_t size, uint32_t seed );
+
+/* slot for a key hash given the displacement of its bucket */
+uint32_t KHashIndexSlot_v4 ( uint64_t hash, uint32_t disp, uint32_t count );
+
+/* bucket and fingerprint of a key hash */
+#define KHashIndexBucket_v4( hash, num_buckets ) \
+    ( ( uint32_t ) ( ( ( hash ) >> 32 ) * ( num_buckets ) >> 32 ) )
+#define KHashIndexFP_v4( hash ) \
+    ( ( uint32_t ) ( hash ) )
+
+/* initialize an index from file - can be NULL */
+rc_t KPHashIndexInit_v4 ( KPHashIndex_v4 *self, struct KMMap const *mm, bool byteswap );
+
+/* whackitywhack */
+void KPHashIndexWhack_v4 ( KPHashIndex_v4 *self );
+
+/* map key to id range */
+rc_t KPHashIndexFind_v4 ( const KPHashIndex_v4 *self,
+    const char *key, int64_t *start_id, uint32_t *span );
+
+/* retrieve the contents of a slot */
+rc_t KPHashIndexGetSlot_v4 ( const KPHashIndex_v4 *self, uint32_t slot,
+    const char **key, size_t *key_size, int64_t *start_id, uint32_t *span );
+
+/*--------------------------------------------------------------------------
+ * KHashIndex_v4
+ */
+typedef struct KHashIndex_v4 KHashIndex_v4;
+
+
 #ifdef __cplusplus
 }
 #endif
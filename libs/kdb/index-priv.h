@@ -117,6 +117,12 @@ struct KTrieIndex_v2
     KPTrieIndex_v2 pt;
 };
 
+/* map several keys to id ranges, in the order of "keys".
+   ranges of keys not found are left untouched */
+rc_t KTrieIndexFindBatch_v2 ( const KTrieIndex_v2 *self, uint32_t count,
+    const char *const keys [], int64_t start_id [], uint64_t id_count [],
+    uint32_t *num_found, bool convertFromV1 );
+
 
 /*--------------------------------------------------------------------------
  * KU64Index_v3
@@ -127,6 +133,12 @@ struct KU64Index_v3
     struct KMMap const *mm;
 };
 
+/* find the first range containing each offset, in the order
+   of "offset". ranges of offsets not found are left untouched */
+rc_t KU64IndexFindBatch_v3 ( const KU64Index_v3 *self, uint32_t count,
+    const uint64_t offset [], uint64_t key [], uint64_t key_size [],
+    int64_t id [], uint64_t id_qty [], uint32_t *num_found );
+
 #ifdef __cplusplus
 }
 #endif
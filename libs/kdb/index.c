@@ -58,6 +58,7 @@ struct KIndex
     const KDBManager *mgr;
     const KDatabase *db;
     const KTable *tbl;
+    struct KDBOpenCacheEntry *cached;
     KRefcount refcount;
     uint32_t vers;
     union
@@ -65,6 +66,7 @@ struct KIndex
         KTrieIndex_v1 txt1;
         KTrieIndex_v2 txt234;
         KU64Index_v3  u64_3;
+        KPHashIndex_v4 hash4;
     } u;
     bool converted_from_v1;
     uint8_t type;
@@ -81,6 +83,10 @@ rc_t KIndexWhack ( KIndex *self )
 
     KRefcountWhack ( & self -> refcount, "KIndex" );
 
+    /* no longer shared */
+    KDBManagerOpenCacheRemove ( self -> mgr, self -> cached );
+    self -> cached = NULL;
+
     /* release owner */
     if ( self -> db != NULL )
     {
@@ -134,6 +140,11 @@ rc_t KIndexWhack ( KIndex *self )
             }
             break;
 
+        case kitHash:
+            KPHashIndexWhack_v4 ( & self -> u . hash4 );
+            rc = 0;
+            break;
+
         }
 
         if ( rc == 0 )
@@ -286,6 +297,9 @@ rc_t KIndexAttach ( KIndex *self, const KMMap *mm, bool *byteswap )
                     case kitText:
                     case kitU64:
                         break;
+                    case kitHash:
+                        if ( hdr -> version >= 4 )
+                            break;
                     default:
                         rc = RC(rcDB, rcIndex, rcConstructing, rcIndex, rcUnrecognized);
                     }
@@ -355,6 +369,10 @@ rc_t KIndexMakeRead ( KIndex **idxp,
                             case kitU64:
                                 rc = KU64IndexOpen_v3 ( & idx -> u . u64_3, mm, byteswap );
                                 break;
+
+                            case kitHash:
+                                rc = KPHashIndexInit_v4 ( & idx -> u . hash4, mm, byteswap );
+                                break;
                         }
                         break;
 #endif
@@ -383,15 +401,21 @@ rc_t KIndexMakeRead ( KIndex **idxp,
  *  "name" [ IN ] - NUL terminated string in UTF-8 giving simple name of idx
  */
 static
-rc_t KDBManagerOpenIndexReadInt ( const KDBManager *self,
-    KIndex **idxp, const KDirectory *wd, const char *path )
+rc_t KDBManagerOpenIndexReadInt ( const KDBManager *self, KIndex **idxp,
+    const KDirectory *wd, const KDatabase *db, const KTable *tbl, const char *path )
 {
     char idxpath [ 4096 ];
     rc_t rc = KDirectoryVResolvePath ( wd, true,
         idxpath, sizeof idxpath, path, NULL );
     if ( rc == 0 )
     {
-        KIndex *idx;
+        /* share an index already open under the same path */
+        KIndex *idx = KDBManagerOpenCacheFind ( self, wd, kptIndex, idxpath );
+        if ( idx != NULL )
+        {
+            * idxp = idx;
+            return 0;
+        }
 
         switch ( KDirectoryVPathType ( wd, idxpath, NULL ) )
         {
@@ -410,6 +434,12 @@ rc_t KDBManagerOpenIndexReadInt ( const KDBManager *self,
         if ( rc == 0 )
         {
             idx -> mgr = KDBManagerAttach ( self );
+            if ( db != NULL )
+                idx -> db = KDatabaseAttach ( db );
+            else
+                idx -> tbl = KTableAttach ( tbl );
+            idx -> cached = KDBManagerOpenCacheInsert ( self,
+                wd, kptIndex, idxpath, idx, & idx -> refcount );
             * idxp = idx;
             return 0;
         }
@@ -451,12 +481,9 @@ LIB_EXPORT rc_t CC KDatabaseVOpenIndexRead ( const KDatabase *self,
     {
         KIndex *idx;
         rc = KDBManagerOpenIndexReadInt ( self -> mgr,
-            & idx, self -> dir, path );
+            & idx, self -> dir, self, NULL, path );
         if ( rc == 0 )
-        {
-            idx -> db = KDatabaseAttach ( self );
             * idxp = idx;
-        }
     }
     return rc;
 }
@@ -509,12 +536,9 @@ LIB_EXPORT rc_t CC KTableVOpenIndexRead ( const KTable *self,
     {
         KIndex *idx;
         rc = KDBManagerOpenIndexReadInt ( self -> mgr,
-            & idx, self -> dir, path );
+            & idx, self -> dir, NULL, self, path );
         if ( rc == 0 )
-        {
-            idx -> tbl = KTableAttach ( self );
             * idxp = idx;
-        }
     }
     return rc;
 }
@@ -710,6 +734,12 @@ LIB_EXPORT rc_t CC KIndexFindText ( const KIndex *self, const char *key, int64_t
             return RC ( rcDB, rcIndex, rcSelecting, rcIndex, rcBadVersion );
         }
         break;
+    case kitHash:
+        /* keys are only compared for equality */
+        if ( custom_cmp != NULL )
+            return RC ( rcDB, rcIndex, rcSelecting, rcFunction, rcUnsupported );
+        rc = KPHashIndexFind_v4 ( & self -> u . hash4, key, start_id, & span );
+        break;
     default:
         return RC ( rcDB, rcIndex, rcSelecting, rcNoObj, rcUnknown );
     }
@@ -721,6 +751,92 @@ LIB_EXPORT rc_t CC KIndexFindText ( const KIndex *self, const char *key, int64_t
 }
 
 
+/* FindTextBatch
+ *  finds a single mapping for each of several keys
+ */
+LIB_EXPORT rc_t CC KIndexFindTextBatch ( const KIndex *self,
+    uint32_t count, const char *const keys [],
+    int64_t start_id [], uint64_t id_count [], uint32_t *num_found )
+{
+    rc_t rc = 0;
+    uint32_t i, id32, span, found;
+
+    if ( num_found != NULL )
+        * num_found = 0;
+
+    if ( count == 0 )
+        return 0;
+
+    if ( keys == NULL || start_id == NULL || id_count == NULL )
+        return RC ( rcDB, rcIndex, rcSelecting, rcParam, rcNull );
+
+    for ( i = 0; i < count; ++ i )
+    {
+        start_id [ i ] = 0;
+        id_count [ i ] = 0;
+    }
+
+    if ( self == NULL )
+        return RC ( rcDB, rcIndex, rcSelecting, rcSelf, rcNull );
+
+    found = 0;
+
+    switch ( self -> type )
+    {
+    case kitText:
+    case kitText | kitProj:
+        switch ( self -> vers )
+        {
+        case 1:
+            for ( i = 0; i < count; ++ i )
+            {
+                if ( keys [ i ] != NULL && keys [ i ] [ 0 ] != 0 &&
+                     KTrieIndexFind_v1 ( & self -> u . txt1, keys [ i ], & id32, NULL, NULL ) == 0 )
+                {
+                    start_id [ i ] = id32;
+                    id_count [ i ] = 1;
+                    ++ found;
+                }
+            }
+            break;
+        case 2:
+        case 3:
+        case 4:
+            rc = KTrieIndexFindBatch_v2 ( & self -> u . txt234, count, keys,
+                start_id, id_count, & found, self -> converted_from_v1 );
+            break;
+        default:
+            return RC ( rcDB, rcIndex, rcSelecting, rcIndex, rcBadVersion );
+        }
+        break;
+    case kitHash:
+        /* lookups are independent */
+        for ( i = 0; i < count; ++ i )
+        {
+            /* a fingerprint hit on another key leaves its id in start_id */
+            if ( keys [ i ] != NULL && keys [ i ] [ 0 ] != 0 &&
+                 KPHashIndexFind_v4 ( & self -> u . hash4, keys [ i ], & start_id [ i ], & span ) == 0 )
+            {
+                id_count [ i ] = span;
+                ++ found;
+            }
+            else
+            {
+                start_id [ i ] = 0;
+            }
+        }
+        break;
+    default:
+        return RC ( rcDB, rcIndex, rcSelecting, rcNoObj, rcUnknown );
+    }
+
+    if ( num_found != NULL )
+        * num_found = found;
+
+    return rc;
+}
+
+
 /* FindAll
  *  finds all mappings from key
  */
@@ -770,6 +886,11 @@ LIB_EXPORT rc_t CC KIndexFindAllText ( const KIndex *self, const char *key,
             return RC ( rcDB, rcIndex, rcSelecting, rcIndex, rcBadVersion );
         }
         break;
+    case kitHash:
+        rc = KPHashIndexFind_v4 ( & self -> u . hash4, key, & id64, & span );
+        if ( rc == 0 )
+            rc = ( * f ) ( id64, span, data );
+        break;
     default:
         return RC ( rcDB, rcIndex, rcSelecting, rcNoObj, rcUnknown );
     }
@@ -949,6 +1070,55 @@ LIB_EXPORT rc_t CC KIndexFindU64( const KIndex* self, uint64_t offset, uint64_t*
     return rc;
 }
 
+LIB_EXPORT rc_t CC KIndexFindU64Batch ( const KIndex *self,
+    uint32_t count, const uint64_t offset [],
+    uint64_t key [], uint64_t key_size [],
+    int64_t start_id [], uint64_t id_count [], uint32_t *num_found )
+{
+    rc_t rc = 0;
+    uint32_t i, found;
+
+    if ( num_found != NULL )
+        * num_found = 0;
+
+    if ( count == 0 )
+        return 0;
+
+    if ( offset == NULL || key == NULL || key_size == NULL || start_id == NULL || id_count == NULL )
+        return RC ( rcDB, rcIndex, rcSelecting, rcParam, rcNull );
+
+    for ( i = 0; i < count; ++ i )
+        key [ i ] = key_size [ i ] = start_id [ i ] = id_count [ i ] = 0;
+
+    if ( self == NULL )
+        return RC ( rcDB, rcIndex, rcSelecting, rcSelf, rcNull );
+
+    found = 0;
+
+    switch ( self -> type )
+    {
+    case kitU64:
+        switch ( self -> vers )
+        {
+        case 3:
+        case 4:
+            rc = KU64IndexFindBatch_v3 ( & self -> u . u64_3, count, offset,
+                key, key_size, start_id, id_count, & found );
+            break;
+        default:
+            return RC ( rcDB, rcIndex, rcSelecting, rcIndex, rcBadVersion );
+        }
+        break;
+    default:
+        return RC ( rcDB, rcIndex, rcSelecting, rcNoObj, rcUnknown );
+    }
+
+    if ( num_found != NULL )
+        * num_found = found;
+
+    return rc;
+}
+
 LIB_EXPORT rc_t CC KIndexFindAllU64( const KIndex* self, uint64_t offset,
     rc_t ( CC * f )(uint64_t key, uint64_t key_size, int64_t id, uint64_t id_qty, void* data ), void* data)
 {
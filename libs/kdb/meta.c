@@ -48,6 +48,7 @@ struct KMDataNodeNamelist;
 #include <klib/impl.h>
 #include <kfs/file.h>
 #include <kfs/mmap.h>
+#include <kproc/lock.h>
 #include <klib/refcount.h>
 #include <klib/debug.h>
 #include <klib/log.h>
@@ -79,6 +80,7 @@ struct KMDataNodeInflateData
     uint32_t node_child_limit;
     rc_t rc;
     bool byteswap;
+    bool skip_inflated;
 };
 
 /*--------------------------------------------------------------------------
@@ -95,9 +97,19 @@ struct KMetadata
     const KTable *tbl;
     const KColumn *col;
 
+    /* entry in manager's read-only open cache */
+    struct KDBOpenCacheEntry *cached;
+
     /* root node */
     KMDataNode *root;
 
+    /* mapped image, referenced by node values and children
+       that have not been inflated yet */
+    const KMMap *mm;
+
+    /* guards inflation of children on demand */
+    KLock *lock;
+
     KRefcount refcount;
     uint32_t vers;
     uint32_t rev;
@@ -203,6 +215,10 @@ struct KMDataNode
     size_t vsize;
     BSTree attr;
     BSTree child;
+
+    /* persisted children not yet inflated into "child" */
+    PBSTree *pending;
+
     KRefcount refcount;
     char name [ 1 ];
 };
@@ -279,7 +295,7 @@ LIB_EXPORT rc_t CC KMDataNodeRelease ( const KMDataNode *cself )
 
             BSTreeWhack ( & self -> attr, KMAttrNodeWhack, NULL );
             BSTreeWhack ( & self -> child, KMDataNodeWhack, NULL );
-            free ( self -> value );
+            PBSTreeWhack ( self -> pending );
             free ( self );
             break;
 
@@ -295,7 +311,6 @@ LIB_EXPORT rc_t CC KMDataNodeRelease ( const KMDataNode *cself )
 static
 bool CC KMDataNodeInflate_v1 ( PBSTNode *n, void *data )
 {
-    void *value;
     KMDataNode *b;
     KMDataNodeInflateData *pb = data;
 
@@ -310,6 +325,10 @@ bool CC KMDataNodeInflate_v1 ( PBSTNode *n, void *data )
         return true;
     }
 
+    /* already inflated by an earlier lookup */
+    if ( pb -> skip_inflated && BSTreeFind ( pb -> bst, name, KMDataNodeCmp ) != NULL )
+        return false;
+
     b = malloc ( sizeof * b + size );
     if ( b == NULL )
     {
@@ -317,36 +336,23 @@ bool CC KMDataNodeInflate_v1 ( PBSTNode *n, void *data )
         return true;
     }
 
+    /* the value stays within the mapped image */
     b -> par = pb -> par;
     b -> meta = pb -> meta;
     b -> value = ( void* ) ( name + size + 1 );
     b -> vsize = n -> data . size - size - 1;
     BSTreeInit ( & b -> attr );
     BSTreeInit ( & b -> child );
+    b -> pending = NULL;
     KRefcountInit ( & b -> refcount, 0, "KMDataNode", "inflate", name );
     strcpy ( b -> name, name );
      
     /* a name with no associated value */
     if ( b -> vsize == 0 )
-    {
         b -> value = NULL;
-        BSTreeInsert ( pb -> bst, & b -> n, KMDataNodeSort );
-        return false;
-    }
-
-    /* allocate value because v2+ code expects this */
-    value = malloc ( b -> vsize );
-    if ( value != NULL )
-    {
-        memcpy ( value, b -> value, b -> vsize );
-        b -> value = value;
-        BSTreeInsert ( pb -> bst, & b -> n, KMDataNodeSort );
-        return false;
-    }
 
-    pb -> rc = RC ( rcDB, rcMetadata, rcConstructing, rcMemory, rcExhausted );
-    free ( b );
-    return true;
+    BSTreeInsert ( pb -> bst, & b -> n, KMDataNodeSort );
+    return false;
 }
 
 static
@@ -368,6 +374,7 @@ rc_t KMDataNodeInflateAttr ( KMDataNode *n, bool byteswap )
         pb . node_child_limit = NODE_CHILD_LIMIT;
         pb . rc = 0;
         pb . byteswap = byteswap;
+        pb . skip_inflated = false;
         PBSTreeDoUntil ( bst, 0, KMAttrNodeInflate, & pb );
         rc = pb . rc;
         
@@ -379,11 +386,12 @@ rc_t KMDataNodeInflateAttr ( KMDataNode *n, bool byteswap )
     return rc;
 }
 
+/* MapChild
+ *  children are left in the mapped image
+ *  and inflated as they are looked up
+ */
 static
-bool CC KMDataNodeInflate ( PBSTNode *n, void *data );
-
-static
-rc_t KMDataNodeInflateChild ( KMDataNode *n,
+rc_t KMDataNodeMapChild ( KMDataNode *n,
     size_t node_size_limit, uint32_t node_child_limit, bool byteswap )
 {
     PBSTree *bst;
@@ -420,16 +428,8 @@ rc_t KMDataNodeInflateChild ( KMDataNode *n,
         }
         else
         {
-            KMDataNodeInflateData pb;
-            pb . meta = n -> meta;
-            pb . par = n;        
-            pb . bst = & n -> child;
-            pb . node_size_limit = node_size_limit;
-            pb . node_child_limit = node_child_limit;
-            pb . rc = 0;
-            pb . byteswap = byteswap;
-            PBSTreeDoUntil ( bst, 0, KMDataNodeInflate, & pb );
-            rc = pb . rc;
+            n -> pending = bst;
+            bst = NULL;
         }
         
         PBSTreeWhack ( bst );
@@ -465,43 +465,38 @@ bool CC KMDataNodeInflate ( PBSTNode *n, void *data )
         return true;
     }
 
+    memcpy ( b -> name, name, size );
+    b -> name [ size ] = 0;
+
+    /* already inflated by an earlier lookup */
+    if ( pb -> skip_inflated && BSTreeFind ( pb -> bst, b -> name, KMDataNodeCmp ) != NULL )
+    {
+        free ( b );
+        return false;
+    }
+
+    /* the value stays within the mapped image */
     b -> par = pb -> par;
     b -> meta = pb -> meta;
     b -> value = ( void* ) ( name + size );
     b -> vsize = n -> data . size - size - 1;
     BSTreeInit ( & b -> attr );
     BSTreeInit ( & b -> child );
+    b -> pending = NULL;
     KRefcountInit ( & b -> refcount, 0, "KMDataNode", "inflate", b -> name );
-    memcpy ( b -> name, name, size );
-    b -> name [ size ] = 0;
 
     pb -> rc = ( bits & 1 ) != 0 ? KMDataNodeInflateAttr ( b, pb -> byteswap ) : 0;
     if ( pb -> rc == 0 )
     {
         pb -> rc = ( bits & 2 ) != 0 ?
-            KMDataNodeInflateChild ( b, pb -> node_size_limit, pb -> node_child_limit, pb -> byteswap ) : 0;
+            KMDataNodeMapChild ( b, pb -> node_size_limit, pb -> node_child_limit, pb -> byteswap ) : 0;
         if ( pb -> rc == 0 )
         {
-            void *value;
-
             if ( b -> vsize == 0 )
-            {
                 b -> value = NULL;
-                BSTreeInsert ( pb -> bst, & b -> n, KMDataNodeSort );
-                return false;
-            }
-
-            value = malloc ( b -> vsize );
-            if ( value != NULL )
-            {
-                memcpy ( value, b -> value, b -> vsize );
-                b -> value = value;
-                BSTreeInsert ( pb -> bst, & b -> n, KMDataNodeSort );
-                return false;
-            }
-            pb -> rc = RC ( rcDB, rcMetadata, rcConstructing, rcMemory, rcExhausted );
 
-            BSTreeWhack ( & b -> child, KMDataNodeWhack, NULL );
+            BSTreeInsert ( pb -> bst, & b -> n, KMDataNodeSort );
+            return false;
         }
 
         BSTreeWhack ( & b -> attr, KMAttrNodeWhack, NULL );
@@ -511,12 +506,104 @@ bool CC KMDataNodeInflate ( PBSTNode *n, void *data )
     return true;
 }
 
+/* InflateChild
+ *  inflates the persisted child matching "name", if any
+ *
+ *  InflateChildren
+ *  inflates all remaining persisted children
+ *
+ *  both are called with the metadata lock held
+ */
+static
+int CC KMDataNodeCmpPersisted ( const void *item, const PBSTNode *n, void *data )
+{
+    const char *name = n -> data . addr;
+    size_t size;
+    int diff;
+
+    if ( ( ( const KMetadata* ) data ) -> vers == 1 )
+        return strncmp ( item, name, n -> data . size );
+
+    size = ( * ( const uint8_t* ) name ++ >> 2 ) + 1;
+    if ( size >= n -> data . size )
+        size = n -> data . size - 1;
+
+    diff = strncmp ( item, name, size );
+    if ( diff == 0 && ( ( const char* ) item ) [ size ] != 0 )
+        return 1;
+    return diff;
+}
+
+static
+void KMDataNodeInflateDataInit ( KMDataNodeInflateData *pb, KMDataNode *self, bool skip_inflated )
+{
+    pb -> meta = self -> meta;
+    pb -> par = self;
+    pb -> bst = & self -> child;
+    pb -> node_size_limit = NODE_SIZE_LIMIT;
+    pb -> node_child_limit = NODE_CHILD_LIMIT;
+    pb -> rc = 0;
+    pb -> byteswap = self -> meta -> byteswap;
+    pb -> skip_inflated = skip_inflated;
+}
+
+static
+rc_t KMDataNodeInflateChild ( const KMDataNode *cself, const char *name, const KMDataNode **child )
+{
+    KMDataNode *self = ( KMDataNode* ) cself;
+
+    * child = ( const KMDataNode* ) BSTreeFind ( & self -> child, name, KMDataNodeCmp );
+    if ( * child == NULL && self -> pending != NULL )
+    {
+        PBSTNode n;
+        if ( PBSTreeFind ( self -> pending, & n, name, KMDataNodeCmpPersisted, ( void* ) self -> meta ) != 0 )
+        {
+            KMDataNodeInflateData pb;
+            KMDataNodeInflateDataInit ( & pb, self, false );
+
+            if ( self -> meta -> vers == 1 )
+                KMDataNodeInflate_v1 ( & n, & pb );
+            else
+                KMDataNodeInflate ( & n, & pb );
+            if ( pb . rc != 0 )
+                return pb . rc;
+
+            * child = ( const KMDataNode* ) BSTreeFind ( & self -> child, name, KMDataNodeCmp );
+        }
+    }
+    return 0;
+}
+
+static
+rc_t KMDataNodeInflateChildren ( const KMDataNode *cself )
+{
+    KMDataNode *self = ( KMDataNode* ) cself;
+
+    if ( self -> pending != NULL )
+    {
+        KMDataNodeInflateData pb;
+        KMDataNodeInflateDataInit ( & pb, self, true );
+
+        if ( self -> meta -> vers == 1 )
+            PBSTreeDoUntil ( self -> pending, 0, KMDataNodeInflate_v1, & pb );
+        else
+            PBSTreeDoUntil ( self -> pending, 0, KMDataNodeInflate, & pb );
+        if ( pb . rc != 0 )
+            return pb . rc;
+
+        PBSTreeWhack ( self -> pending );
+        self -> pending = NULL;
+    }
+    return 0;
+}
+
 
 /* Find
  */
 static
 rc_t KMDataNodeFind ( const KMDataNode *self, const KMDataNode **np, char **path )
 {
+    rc_t rc;
     const KMDataNode *found;
 
     char *end, *name = * path;
@@ -561,8 +648,9 @@ rc_t KMDataNodeFind ( const KMDataNode *self, const KMDataNode **np, char **path
         }
 
         /* find actual path */
-        found = ( const KMDataNode* )
-            BSTreeFind ( & self -> child, name, KMDataNodeCmp );
+        rc = KMDataNodeInflateChild ( self, name, & found );
+        if ( rc != 0 )
+            return rc;
         if ( found == NULL )
         {
             /* not found also gets partially found state */
@@ -621,7 +709,12 @@ LIB_EXPORT rc_t CC KMDataNodeVOpenNodeRead ( const KMDataNode *self,
             return RC ( rcDB, rcNode, rcOpening, rcPath, rcExcessive );
     }
 
-    rc = KMDataNodeFind ( self, ( const KMDataNode** ) & found, & p );
+    rc = KLockAcquire ( self -> meta -> lock );
+    if ( rc == 0 )
+    {
+        rc = KMDataNodeFind ( self, ( const KMDataNode** ) & found, & p );
+        KLockUnlock ( self -> meta -> lock );
+    }
     if ( rc == 0 )
     {
         KMetadataAttach ( found -> meta );
@@ -1444,6 +1537,10 @@ rc_t KMetadataWhack ( KMetadata *self )
 
     KRefcountWhack ( & self -> refcount, "KMetadata" );
 
+    /* no longer shared */
+    KDBManagerOpenCacheRemove ( self -> mgr, self -> cached );
+    self -> cached = NULL;
+
     if ( self -> db != NULL )
     {
         rc = KDatabaseSever ( self -> db );
@@ -1470,6 +1567,8 @@ rc_t KMetadataWhack ( KMetadata *self )
     {
         KDirectoryRelease ( self -> dir );
         KMDataNodeWhack ( ( BSTNode* ) & self -> root -> n, NULL );
+        KMMapRelease ( self -> mm );
+        KLockRelease ( self -> lock );
         free ( self );
         return 0;
     }
@@ -1595,31 +1694,16 @@ rc_t KMetadataPopulate ( KMetadata *self, const KDirectory *dir, const char *pat
                 }
                 if ( rc == 0 )
                 {
-                    PBSTree *bst;
-                    rc = PBSTreeMake ( & bst, pbstree_src, size - sizeof * hdr, self -> byteswap );
+                    /* nodes are inflated from the mapped image as they are
+                       looked up, their values are never copied out of it */
+                    rc = PBSTreeMake ( & self -> root -> pending, pbstree_src, size - sizeof * hdr, self -> byteswap );
                     if ( rc != 0 )
                         rc = RC ( rcDB, rcMetadata, rcConstructing, rcData, rcCorrupt );
                     else
                     {
-                        KMDataNodeInflateData pb;
-
-                        pb . meta = self;
-                        pb . par = self -> root;
-                        pb . bst = & self -> root -> child;
-                        pb . node_size_limit = NODE_SIZE_LIMIT;
-                        pb . node_child_limit = NODE_CHILD_LIMIT;
-                        pb . rc = 0;
-                        pb . byteswap = self -> byteswap;
-
-                        if ( hdr -> version == 1 )
-                            PBSTreeDoUntil ( bst, 0, KMDataNodeInflate_v1, & pb );
-                        else
-                            PBSTreeDoUntil ( bst, 0, KMDataNodeInflate, & pb );
-                        rc = pb . rc;
-
                         self -> vers = hdr -> version;
-
-                        PBSTreeWhack ( bst );
+                        self -> mm = mm;
+                        mm = NULL;
                     }
                 }
             }
@@ -1657,12 +1741,18 @@ rc_t KMetadataMakeRead ( KMetadata **metap,
 
             KRefcountInit ( & meta -> root -> refcount, 0, "KMDataNode", "make-read", "/" );
 
-            rc = KMetadataPopulate ( meta, dir, path );
+            rc = KLockMake ( & meta -> lock );
             if ( rc == 0 )
             {
-                KDirectoryAddRef ( dir );
-                * metap = meta;
-                return 0;
+                rc = KMetadataPopulate ( meta, dir, path );
+                if ( rc == 0 )
+                {
+                    KDirectoryAddRef ( dir );
+                    * metap = meta;
+                    return 0;
+                }
+
+                KLockRelease ( meta -> lock );
             }
 
             free ( meta -> root );
@@ -1682,7 +1772,8 @@ rc_t KMetadataMakeRead ( KMetadata **metap,
  */
 static
 rc_t KDBManagerOpenMetadataReadInt ( const KDBManager *self,
-    KMetadata **metap, const KDirectory *wd, uint32_t rev, bool prerelease )
+    KMetadata **metap, const KDirectory *wd, uint32_t rev, bool prerelease,
+    const KDatabase *db, const KTable *tbl, const KColumn *col )
 {
     char metapath [ 4096 ];
     rc_t rc = ( prerelease == 1 ) ?
@@ -1692,7 +1783,13 @@ rc_t KDBManagerOpenMetadataReadInt ( const KDBManager *self,
           KDirectoryResolvePath ( wd, true, metapath, sizeof metapath, "md/r%.3u", rev ) );
     if ( rc == 0 )
     {
-        KMetadata *meta;
+        /* share metadata already open under the same path */
+        KMetadata *meta = KDBManagerOpenCacheFind ( self, wd, kptMetadata, metapath );
+        if ( meta != NULL )
+        {
+            * metap = meta;
+            return 0;
+        }
 
         switch ( KDirectoryVPathType ( wd, metapath, NULL ) )
         {
@@ -1711,6 +1808,14 @@ rc_t KDBManagerOpenMetadataReadInt ( const KDBManager *self,
         if ( rc == 0 )
         {
             meta -> mgr = KDBManagerAttach ( self );
+            if ( db != NULL )
+                meta -> db = KDatabaseAttach ( db );
+            else if ( tbl != NULL )
+                meta -> tbl = KTableAttach ( tbl );
+            else if ( col != NULL )
+                meta -> col = KColumnAttach ( col );
+            meta -> cached = KDBManagerOpenCacheInsert ( self,
+                wd, kptMetadata, metapath, meta, & meta -> refcount );
             * metap = meta;
             return 0;
         }
@@ -1732,12 +1837,10 @@ LIB_EXPORT rc_t CC KDatabaseOpenMetadataRead ( const KDatabase *self, const KMet
     if ( self == NULL )
         return RC ( rcDB, rcDatabase, rcOpening, rcSelf, rcNull );
 
-    rc = KDBManagerOpenMetadataReadInt ( self -> mgr, & meta, self -> dir, 0, false );
+    rc = KDBManagerOpenMetadataReadInt ( self -> mgr, & meta,
+        self -> dir, 0, false, self, NULL, NULL );
     if ( rc == 0 )
-    {
-        meta -> db = KDatabaseAttach ( self );
         * metap = meta;
-    }
 
     return rc;
 }
@@ -1756,12 +1859,9 @@ LIB_EXPORT rc_t CC KTableOpenMetadataRead ( const KTable *self, const KMetadata
         return RC ( rcDB, rcTable, rcOpening, rcSelf, rcNull );
 
     rc = KDBManagerOpenMetadataReadInt ( self -> mgr, & meta,
-        self -> dir, 0, self -> prerelease );
+        self -> dir, 0, self -> prerelease, NULL, self, NULL );
     if ( rc == 0 )
-    {
-        meta -> tbl = KTableAttach ( self );
         * metap = meta;
-    }
 
     return rc;
 }
@@ -1779,12 +1879,10 @@ LIB_EXPORT rc_t CC KColumnOpenMetadataRead ( const KColumn *self, const KMetadat
     if ( self == NULL )
         return RC ( rcDB, rcColumn, rcOpening, rcSelf, rcNull );
 
-    rc = KDBManagerOpenMetadataReadInt ( self -> mgr, & meta, self -> dir, 0, false );
+    rc = KDBManagerOpenMetadataReadInt ( self -> mgr, & meta,
+        self -> dir, 0, false, NULL, NULL, self );
     if ( rc == 0 )
-    {
-        meta -> col = KColumnAttach ( self );
         * metap = meta;
-    }
 
     return rc;
 }
@@ -1928,19 +2026,10 @@ LIB_EXPORT rc_t CC KMetadataOpenRevision ( const KMetadata *self,
     if ( self == NULL )
         return RC ( rcDB, rcMetadata, rcOpening, rcSelf, rcNull );
 
-    rc = KDBManagerOpenMetadataReadInt ( self -> mgr,
-        & meta, self -> dir, revision, false );
+    rc = KDBManagerOpenMetadataReadInt ( self -> mgr, & meta,
+        self -> dir, revision, false, self -> db, self -> tbl, self -> col );
     if ( rc == 0 )
-    {
-        if ( self -> db != NULL )
-            meta -> db = KDatabaseAttach ( self -> db );
-        else if ( self -> tbl != NULL )
-            meta -> tbl = KTableAttach ( self -> tbl );
-        else if ( self -> col != NULL )
-            meta -> col = KColumnAttach ( self -> col );
-
         * metap = meta;
-    }
 
     return rc;
 }
@@ -2128,6 +2217,17 @@ LIB_EXPORT rc_t CC KMDataNodeListChildren ( const KMDataNode *self, KNamelist **
         rc_t rc;
 
         uint32_t count = 0;
+
+        /* once inflated, children no longer change */
+        rc = KLockAcquire ( self -> meta -> lock );
+        if ( rc == 0 )
+        {
+            rc = KMDataNodeInflateChildren ( self );
+            KLockUnlock ( self -> meta -> lock );
+        }
+        if ( rc != 0 )
+            return rc;
+
         BSTreeForEach ( & self -> child, 0, KMDataNodeListCount, & count );
 
         rc = KMDataNodeNamelistMake ( names, count );
@@ -46,6 +46,7 @@ extern "C" {
 struct KDatabase;
 struct KDBManager;
 struct KDirectory;
+struct KDBOpenCacheEntry;
 
 
 /*--------------------------------------------------------------------------
@@ -60,6 +61,7 @@ struct KTable
     struct KDirectory const *dir;
     struct KDBManager const *mgr;
     struct KDatabase const *db;
+    struct KDBOpenCacheEntry *cached;
     KRefcount refcount;
     uint8_t prerelease;
     char path [ 1 ];
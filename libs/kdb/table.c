@@ -78,6 +78,10 @@ rc_t KTableWhack ( KTable *self )
 
     KRefcountWhack ( & self -> refcount, "KTable" );
 
+    /* no longer shared */
+    KDBManagerOpenCacheRemove ( self -> mgr, self -> cached );
+    self -> cached = NULL;
+
     if ( self -> db != NULL )
     {
         rc = KDatabaseSever ( self -> db );
@@ -209,8 +213,8 @@ rc_t KTableMake ( KTable **tblp, const KDirectory *dir, const char *path )
  */
 static
 rc_t KDBManagerVOpenTableReadInt ( const KDBManager *self,
-    const KTable **tblp, const KDirectory *wd, bool try_srapath,
-    const char *path, va_list args )
+    const KTable **tblp, const KDirectory *wd, const KDatabase *db,
+    bool try_srapath, const char *path, va_list args )
 {
     rc_t rc;
 
@@ -226,6 +230,14 @@ rc_t KDBManagerVOpenTableReadInt ( const KDBManager *self,
         const KDirectory *dir;
         bool prerelease = false;
 
+        /* share a table already open under the same path */
+        tbl = KDBManagerOpenCacheFind ( self, wd, kptTable, tblpath );
+        if ( tbl != NULL )
+        {
+            * tblp = tbl;
+            return 0;
+        }
+
         rc = KDBOpenPathTypeRead ( self, wd, tblpath, &dir, kptTable, NULL, try_srapath );
         if ( rc != 0 )
         {
@@ -239,7 +251,10 @@ rc_t KDBManagerVOpenTableReadInt ( const KDBManager *self,
             if ( rc == 0 )
             {
                 tbl -> mgr = KDBManagerAttach ( self );
+                tbl -> db = KDatabaseAttach ( db );
                 tbl -> prerelease = prerelease;
+                tbl -> cached = KDBManagerOpenCacheInsert ( self,
+                    wd, kptTable, tblpath, tbl, & tbl -> refcount );
                 * tblp = tbl;
                 return 0;
             }
@@ -275,7 +290,7 @@ LIB_EXPORT rc_t CC KDBManagerVOpenTableRead ( const KDBManager *self,
     if ( self == NULL )
         return RC ( rcDB, rcMgr, rcOpening, rcSelf, rcNull );
 
-    return KDBManagerVOpenTableReadInt ( self, tbl, self -> wd, true, path, args);
+    return KDBManagerVOpenTableReadInt ( self, tbl, self -> wd, NULL, true, path, args);
 }
 
 LIB_EXPORT rc_t CC KDatabaseOpenTableRead ( const KDatabase *self,
@@ -310,12 +325,7 @@ LIB_EXPORT rc_t CC KDatabaseVOpenTableRead ( const KDatabase *self,
     if ( rc == 0 )
     {
         rc = KDBManagerVOpenTableReadInt ( self -> mgr, tblp,
-            self -> dir, false, path, NULL );
-        if ( rc == 0 )
-        {
-            KTable *tbl = ( KTable* ) * tblp;
-            tbl -> db = KDatabaseAttach ( self );
-        }
+            self -> dir, self, false, path, NULL );
     }
 
     return rc;
@@ -33,6 +33,7 @@
 #include <kfs/file.h>
 #include <kfs/mmap.h>
 #include <klib/pack.h>
+#include <klib/sort.h>
 #include <klib/rc.h>
 #include <sysalloc.h>
 
@@ -826,6 +827,94 @@ rc_t KPTrieIndexProject_v2 ( const KPTrieIndex_v2 *self,
     return RC ( rcDB, rcIndex, rcProjecting, rcId, rcNotFound );
 }
 
+/* NodeIds
+ *  extracts the id range of a found node
+ */
+static
+rc_t KPTrieIndexNodeIds_v2 ( const KPTrieIndex_v2 *self,
+    uint32_t nid, const PTNode *pnode, int64_t *start_id,
+#if V2FIND_RETURNS_SPAN
+    uint32_t *span,
+#endif
+    bool convertFromV1 )
+{
+    rc_t rc;
+    size_t usize;
+
+    /* detect conversion from v1 */
+    if ( convertFromV1 && self -> id_bits == 0 )
+    {
+        /* v1 stored tree will have just a 32-bit spot id as data */
+        uint32_t id;
+        assert ( pnode -> data . size == sizeof id );
+        memcpy ( & id, pnode -> data . addr, sizeof id );
+        * start_id = id;
+        rc = 0;
+    }
+    else
+    {
+        /* should be native v2 */
+        if ( self -> id_bits > 0 )
+        {
+            rc = Unpack ( self -> id_bits, sizeof * start_id * 8,
+                pnode -> data . addr, 0, self -> id_bits, NULL,
+                start_id, sizeof * start_id, & usize );
+        }
+        else
+        {
+            rc = 0;
+        }
+        * start_id += self -> first;
+    }
+
+    if ( rc == 0 )
+    {
+#if V2FIND_RETURNS_SPAN
+        if ( self -> ord2node != NULL )
+        {
+            uint32_t ord = KPTrieIndexID2Ord_v2 ( self, * start_id );
+            if ( ord == 0 )
+                rc = RC ( rcDB, rcIndex, rcSelecting, rcId, rcNotFound );
+            else if ( ord == self -> count )
+                * span = ( uint32_t ) ( self -> maxid - * start_id + 1 );
+            else switch ( self -> variant )
+            {
+            case 0:
+                for ( ; ord < self -> count; ++ ord )
+                {
+                    if ( nid != self -> ord2node [ ord ] )
+                        break;
+                }
+                * span = ( uint32_t ) ( self -> first + ord - * start_id );
+                break;
+            case 1:
+                * span = ( uint32_t ) ( self -> first + self -> id2ord . v8 [ ord ] - * start_id );
+                break;
+            case 2:
+                * span = ( uint32_t ) ( self -> first + self -> id2ord . v16 [ ord ] - * start_id );
+                break;
+            case 3:
+                * span = ( uint32_t ) ( self -> first + self -> id2ord . v32 [ ord ] - * start_id );
+                break;
+            case 4:
+                * span = ( uint32_t ) ( self -> first + self -> id2ord . v64 [ ord ] - * start_id );
+                break;
+            }
+        }
+        else if ( self -> span_bits == 0 )
+            * span = 1;
+        else
+        {
+            rc = Unpack ( self -> span_bits, sizeof * span * 8,
+                pnode -> data . addr, 0, self -> id_bits, NULL,
+                span, sizeof * span, & usize );
+        }
+#endif
+    }
+
+    return rc;
+}
+
 /* Find
  */
 static
@@ -854,82 +943,92 @@ rc_t KPTrieIndexFind_v2 ( const KPTrieIndex_v2 *self,
             rc = RC ( rcDB, rcIndex, rcSelecting, rcString, rcNotFound );
         else
         {
-            size_t usize;
+            rc = KPTrieIndexNodeIds_v2 ( self, nid, & pnode, start_id,
+#if V2FIND_RETURNS_SPAN
+                span,
+#endif
+                convertFromV1 );
+        }
+    }
 
-            /* detect conversion from v1 */
-            if ( convertFromV1 && self -> id_bits == 0 )
-            {
-                /* v1 stored tree will have just a 32-bit spot id as data */
-                uint32_t id;
-                assert ( pnode . data . size == sizeof id );
-                memcpy ( & id, pnode . data . addr, sizeof id );
-                * start_id = id;
-                rc = 0;
-            }
-            else
-            {
-                /* should be native v2 */
-                if ( self -> id_bits > 0 )
-                {
-                    rc = Unpack ( self -> id_bits, sizeof * start_id * 8,
-                        pnode . data . addr, 0, self -> id_bits, NULL,
-                        start_id, sizeof * start_id, & usize );
-                }
-                else
-                {
-                    rc = 0;
-                }
-                * start_id += self -> first;
-            }
+    return rc;
+}
 
-            if ( rc == 0 )
-            {
+/* FindBatch
+ *  keys are found in sorted order, letting the trie
+ *  share the walk over common prefixes
+ */
+typedef struct KPTrieIndexBatchKey_v2 KPTrieIndexBatchKey_v2;
+struct KPTrieIndexBatchKey_v2
+{
+    const char *key;
+    uint32_t idx;
+};
+
+static
+int CC KPTrieIndexBatchKeyCmp_v2 ( const void *a, const void *b, void *ignore )
+{
+    const KPTrieIndexBatchKey_v2 *ka = a;
+    const KPTrieIndexBatchKey_v2 *kb = b;
+    return strcmp ( ka -> key, kb -> key );
+}
+
+static
+rc_t KPTrieIndexFindBatch_v2 ( const KPTrieIndex_v2 *self, uint32_t count,
+    const char *const keys [], int64_t start_id [], uint64_t id_count [],
+    uint32_t *num_found, bool convertFromV1 )
+{
+    uint32_t i;
+    String *items;
+    PTNode *nodes;
+    KPTrieIndexBatchKey_v2 *order;
+
+    if ( self -> count == 0 )
+        return 0;
+
+    order = malloc ( count * ( sizeof * order + sizeof * items + sizeof * nodes ) );
+    if ( order == NULL )
+        return RC ( rcDB, rcIndex, rcSelecting, rcMemory, rcExhausted );
+    nodes = ( PTNode* ) & order [ count ];
+    items = ( String* ) & nodes [ count ];
+
+    for ( i = 0; i < count; ++ i )
+    {
+        order [ i ] . key = keys [ i ] != NULL ? keys [ i ] : "";
+        order [ i ] . idx = i;
+    }
+    ksort ( order, count, sizeof * order, KPTrieIndexBatchKeyCmp_v2, NULL );
+
+    for ( i = 0; i < count; ++ i )
+        StringInitCString ( & items [ i ], order [ i ] . key );
+
+    PTrieFindBatch ( self -> key2id, items, count, nodes, NULL, NULL );
+
+    for ( i = 0; i < count; ++ i )
+    {
+        if ( nodes [ i ] . id != 0 )
+        {
+            int64_t id;
+            uint32_t span = 1;
+            uint32_t idx = order [ i ] . idx;
+
+            if ( KPTrieIndexNodeIds_v2 ( self, nodes [ i ] . id, & nodes [ i ], & id,
 #if V2FIND_RETURNS_SPAN
-                if ( self -> ord2node != NULL )
-                {
-                    uint32_t ord = KPTrieIndexID2Ord_v2 ( self, * start_id );
-                    if ( ord == 0 )
-                        rc = RC ( rcDB, rcIndex, rcSelecting, rcId, rcNotFound );
-                    else if ( ord == self -> count )
-                        * span = ( uint32_t ) ( self -> maxid - * start_id + 1 );
-                    else switch ( self -> variant )
-                    {
-                    case 0:
-                        for ( ; ord < self -> count; ++ ord )
-                        {
-                            if ( nid != self -> ord2node [ ord ] )
-                                break;
-                        }
-                        * span = ( uint32_t ) ( self -> first + ord - * start_id );
-                        break;
-                    case 1:
-                        * span = ( uint32_t ) ( self -> first + self -> id2ord . v8 [ ord ] - * start_id );
-                        break;
-                    case 2:
-                        * span = ( uint32_t ) ( self -> first + self -> id2ord . v16 [ ord ] - * start_id );
-                        break;
-                    case 3:
-                        * span = ( uint32_t ) ( self -> first + self -> id2ord . v32 [ ord ] - * start_id );
-                        break;
-                    case 4:
-                        * span = ( uint32_t ) ( self -> first + self -> id2ord . v64 [ ord ] - * start_id );
-                        break;
-                    }
-                }
-                else if ( self -> span_bits == 0 )
-                    * span = 1;
-                else
-                {
-                    rc = Unpack ( self -> span_bits, sizeof * span * 8,
-                        pnode . data . addr, 0, self -> id_bits, NULL,
-                        span, sizeof * span, & usize );
-                }
+                     & span,
 #endif
+                     convertFromV1 ) == 0 )
+            {
+                start_id [ idx ] = id;
+                if ( id_count != NULL )
+                    id_count [ idx ] = span;
+                ++ * num_found;
             }
         }
     }
 
-    return rc;
+    free ( order );
+
+    return 0;
 }
 
 
@@ -1029,6 +1128,17 @@ rc_t KTrieIndexFind_v2 ( const KTrieIndex_v2 *self,
     return RC ( rcDB, rcIndex, rcSelecting, rcString, rcNotFound );
 }
 
+rc_t KTrieIndexFindBatch_v2 ( const KTrieIndex_v2 *self, uint32_t count,
+    const char *const keys [], int64_t start_id [], uint64_t id_count [],
+    uint32_t *num_found, bool convertFromV1 )
+{
+    if ( self -> pt . key2id == NULL )
+        return 0;
+
+    return KPTrieIndexFindBatch_v2 ( & self -> pt, count, keys,
+        start_id, id_count, num_found, convertFromV1 );
+}
+
 rc_t KTrieIndexProject_v2 ( const KTrieIndex_v2 *self,
     int64_t id,
 #if V2FIND_RETURNS_SPAN
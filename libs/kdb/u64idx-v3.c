@@ -34,6 +34,7 @@
 #include <kfs/mmap.h>
 #include <klib/pbstree.h>
 #include <klib/rc.h>
+#include <klib/sort.h>
 #include <sysalloc.h>
 
 #include <string.h>
@@ -160,3 +161,112 @@ rc_t KU64IndexFindAll_v3( const KU64Index_v3* self, uint64_t offset,
     PBSTreeDoUntil(self->tree, false, KU64Index_Grep, &d);
     return d.rc;
 }
+
+
+/* FindBatch
+ *  a single pass over the tree resolves all offsets: for each
+ *  node, the sorted offsets falling within its range are found
+ *  by binary search. as with Find, the first node in tree order
+ *  containing an offset is the one reported.
+ */
+typedef struct KU64Index_BatchOffset KU64Index_BatchOffset;
+struct KU64Index_BatchOffset
+{
+    uint64_t offset;
+    uint32_t idx;
+    bool found;
+};
+
+typedef struct KU64Index_BatchData KU64Index_BatchData;
+struct KU64Index_BatchData
+{
+    KU64Index_BatchOffset *order;
+    uint64_t *key;
+    uint64_t *key_size;
+    int64_t *id;
+    uint64_t *id_qty;
+    uint32_t count;
+    uint32_t remaining;
+};
+
+static
+int CC KU64Index_BatchCmp ( const void *a, const void *b, void *ignore )
+{
+    const KU64Index_BatchOffset *oa = a;
+    const KU64Index_BatchOffset *ob = b;
+    if ( oa -> offset < ob -> offset )
+        return -1;
+    return oa -> offset > ob -> offset;
+}
+
+static
+bool CC KU64Index_BatchGrep ( PBSTNode *node, void *data )
+{
+    const KU64Index_PNode *n = node -> data . addr;
+    KU64Index_BatchData *d = data;
+    uint32_t lower, upper;
+
+    /* first offset >= node key */
+    for ( lower = 0, upper = d -> count; lower < upper; )
+    {
+        uint32_t i = ( lower + upper ) >> 1;
+        if ( d -> order [ i ] . offset < n -> key )
+            lower = i + 1;
+        else
+            upper = i;
+    }
+
+    for ( ; lower < d -> count && d -> order [ lower ] . offset - n -> key < n -> key_size; ++ lower )
+    {
+        KU64Index_BatchOffset *o = & d -> order [ lower ];
+        if ( ! o -> found )
+        {
+            o -> found = true;
+            d -> key [ o -> idx ] = n -> key;
+            d -> key_size [ o -> idx ] = n -> key_size;
+            d -> id [ o -> idx ] = n -> id;
+            d -> id_qty [ o -> idx ] = n -> id_qty;
+
+            /* stop when all are resolved */
+            if ( -- d -> remaining == 0 )
+                return true;
+        }
+    }
+    return false;
+}
+
+rc_t KU64IndexFindBatch_v3 ( const KU64Index_v3 *self, uint32_t count,
+    const uint64_t offset [], uint64_t key [], uint64_t key_size [],
+    int64_t id [], uint64_t id_qty [], uint32_t *num_found )
+{
+    uint32_t i;
+    KU64Index_BatchData d;
+
+    if ( self -> tree == NULL || count == 0 )
+        return 0;
+
+    d . order = malloc ( count * sizeof d . order [ 0 ] );
+    if ( d . order == NULL )
+        return RC ( rcDB, rcIndex, rcSelecting, rcMemory, rcExhausted );
+
+    for ( i = 0; i < count; ++ i )
+    {
+        d . order [ i ] . offset = offset [ i ];
+        d . order [ i ] . idx = i;
+        d . order [ i ] . found = false;
+    }
+    ksort ( d . order, count, sizeof d . order [ 0 ], KU64Index_BatchCmp, NULL );
+
+    d . key = key;
+    d . key_size = key_size;
+    d . id = id;
+    d . id_qty = id_qty;
+    d . count = d . remaining = count;
+
+    PBSTreeDoUntil ( self -> tree, false, KU64Index_BatchGrep, & d );
+
+    * num_found += count - d . remaining;
+
+    free ( d . order );
+    return 0;
+}
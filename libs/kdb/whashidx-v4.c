@@ -0,0 +1,599 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include <kdb/extern.h>
+
+#include "windex-priv.h"
+
+#include <kdb/index.h>
+#include <kfs/directory.h>
+#include <kfs/file.h>
+#include <kfs/buffile.h>
+#include <kfs/md5.h>
+#include <kfs/mmap.h>
+#include <klib/rc.h>
+#include <sysalloc.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+/* average number of keys per bucket */
+#define KHASHIDX_BUCKET_LOAD 2
+
+/* displacements tried for a bucket before choosing another seed */
+#define KHASHIDX_MAX_DISP 0x1000000
+#define KHASHIDX_MAX_SEEDS 16
+
+#define KHASHIDX_BUF_SIZE ( 256 * 1024 )
+
+
+/*--------------------------------------------------------------------------
+ * KHashIndex_v4
+ */
+
+/* initialize an index from file - can be NULL */
+rc_t KHashIndexOpen_v4 ( KHashIndex_v4 *self, const KMMap *mm, bool byteswap )
+{
+    memset ( self, 0, sizeof * self );
+    return KPHashIndexInit_v4 ( & self -> pt, mm, byteswap );
+}
+
+/* whack whack */
+void KHashIndexWhack_v4 ( KHashIndex_v4 *self )
+{
+    KPHashIndexWhack_v4 ( & self -> pt );
+    free ( self -> entry );
+    free ( self -> keys );
+    memset ( self, 0, sizeof * self );
+}
+
+static
+rc_t KHashIndexAppend_v4 ( KHashIndex_v4 *self,
+    const char *key, size_t size, int64_t id, uint32_t span )
+{
+    KHashIdxEntry_v4 *e;
+
+    if ( self -> count == self -> max )
+    {
+        /* slots must fit beside the direct slot flag */
+        uint32_t new_max = self -> max == 0 ? 4096 : self -> max << 1;
+        if ( self -> max >= KHASHIDX_DIRECT_SLOT )
+            return RC ( rcDB, rcIndex, rcInserting, rcRange, rcExcessive );
+        if ( new_max > KHASHIDX_DIRECT_SLOT )
+            new_max = KHASHIDX_DIRECT_SLOT;
+
+        e = realloc ( self -> entry, ( size_t ) new_max * sizeof * e );
+        if ( e == NULL )
+            return RC ( rcDB, rcIndex, rcInserting, rcMemory, rcExhausted );
+        self -> entry = e;
+        self -> max = new_max;
+    }
+
+    if ( self -> key_bytes + size > self -> key_max )
+    {
+        char *keys;
+        uint64_t new_max = self -> key_max == 0 ? 64 * 1024 : self -> key_max << 1;
+        while ( self -> key_bytes + size > new_max )
+            new_max <<= 1;
+        if ( ( size_t ) new_max != new_max )
+            return RC ( rcDB, rcIndex, rcInserting, rcMemory, rcExhausted );
+        keys = realloc ( self -> keys, ( size_t ) new_max );
+        if ( keys == NULL )
+            return RC ( rcDB, rcIndex, rcInserting, rcMemory, rcExhausted );
+        self -> keys = keys;
+        self -> key_max = new_max;
+    }
+
+    e = & self -> entry [ self -> count ++ ];
+    e -> key_off = self -> key_bytes;
+    e -> start_id = id;
+    e -> span = span;
+    e -> key_size = ( uint32_t ) size;
+
+    memmove ( self -> keys + self -> key_bytes, key, size );
+    self -> key_bytes += size;
+
+    return 0;
+}
+
+/* Attach
+ *  loads persisted entries for update
+ */
+static
+rc_t KHashIndexAttach_v4 ( KHashIndex_v4 *self )
+{
+    rc_t rc = 0;
+    uint32_t i;
+
+    for ( i = 0; rc == 0 && i < self -> pt . count; ++ i )
+    {
+        const char *key;
+        size_t key_size;
+        int64_t start_id;
+        uint32_t span;
+
+        rc = KPHashIndexGetSlot_v4 ( & self -> pt, i, & key, & key_size, & start_id, & span );
+        if ( rc == 0 )
+            rc = KHashIndexAppend_v4 ( self, key, key_size, start_id, span );
+    }
+
+    return rc;
+}
+
+/* Insert
+ *  a key repeating the last key extends its range when the ids
+ *  are contiguous. any other repeat is detected by Persist.
+ */
+rc_t KHashIndexInsert_v4 ( KHashIndex_v4 *self,
+    const char *key, int64_t id, uint32_t span )
+{
+    size_t size = strlen ( key );
+    if ( size > UINT32_MAX )
+        return RC ( rcDB, rcIndex, rcInserting, rcString, rcExcessive );
+
+    /* detect first modification of persisted data */
+    if ( self -> count == 0 && self -> pt . count != 0 )
+    {
+        rc_t rc = KHashIndexAttach_v4 ( self );
+        if ( rc != 0 )
+            return rc;
+    }
+
+    if ( self -> count != 0 )
+    {
+        KHashIdxEntry_v4 *e = & self -> entry [ self -> count - 1 ];
+        if ( e -> key_size == size && memcmp ( self -> keys + e -> key_off, key, size ) == 0 )
+        {
+            if ( id != e -> start_id + e -> span )
+                return RC ( rcDB, rcIndex, rcInserting, rcString, rcExists );
+            if ( span > UINT32_MAX - e -> span )
+                return RC ( rcDB, rcIndex, rcInserting, rcRange, rcExcessive );
+            e -> span += span;
+            return 0;
+        }
+    }
+
+    return KHashIndexAppend_v4 ( self, key, size, id, span );
+}
+
+
+/*--------------------------------------------------------------------------
+ * KHashIdxBuild_v4
+ *  hash and displace: buckets are placed in order of decreasing size,
+ *  each trying displacements until all of its keys land in free slots.
+ *  single-key buckets, the bulk of the last ones, take the next free
+ *  slot directly, which keeps the table minimal without long searches.
+ */
+typedef struct KHashIdxBuild_v4 KHashIdxBuild_v4;
+struct KHashIdxBuild_v4
+{
+    uint64_t *hash;
+    uint32_t *disp;
+    uint32_t *order;
+    uint32_t *bstart;
+    uint32_t *border;
+    uint32_t *slot2entry;
+    uint8_t *taken;
+    uint32_t num_buckets;
+    uint32_t seed;
+};
+
+#define TAKEN( b, i ) \
+    ( ( ( b ) -> taken [ ( i ) >> 3 ] & ( 1 << ( ( i ) & 7 ) ) ) != 0 )
+#define TAKE( b, i ) \
+    ( ( b ) -> taken [ ( i ) >> 3 ] |= ( uint8_t ) ( 1 << ( ( i ) & 7 ) ) )
+
+static
+void KHashIdxBuildWhack_v4 ( KHashIdxBuild_v4 *b )
+{
+    free ( b -> hash );
+    free ( b -> disp );
+    free ( b -> order );
+    free ( b -> bstart );
+    free ( b -> border );
+    free ( b -> slot2entry );
+    free ( b -> taken );
+}
+
+static
+rc_t KHashIdxBuildInit_v4 ( KHashIdxBuild_v4 *b, uint32_t count )
+{
+    memset ( b, 0, sizeof * b );
+    b -> num_buckets = count / KHASHIDX_BUCKET_LOAD + 1;
+
+    b -> hash = malloc ( ( size_t ) count * sizeof b -> hash [ 0 ] );
+    b -> disp = malloc ( ( size_t ) b -> num_buckets * sizeof b -> disp [ 0 ] );
+    b -> order = malloc ( ( size_t ) count * sizeof b -> order [ 0 ] );
+    b -> bstart = malloc ( ( ( size_t ) b -> num_buckets + 1 ) * sizeof b -> bstart [ 0 ] );
+    b -> border = malloc ( ( size_t ) b -> num_buckets * sizeof b -> border [ 0 ] );
+    b -> slot2entry = malloc ( ( size_t ) count * sizeof b -> slot2entry [ 0 ] );
+    b -> taken = malloc ( ( ( size_t ) count + 7 ) >> 3 );
+
+    if ( b -> hash == NULL || b -> disp == NULL || b -> order == NULL || b -> bstart == NULL ||
+         b -> border == NULL || b -> slot2entry == NULL || b -> taken == NULL )
+    {
+        KHashIdxBuildWhack_v4 ( b );
+        return RC ( rcDB, rcIndex, rcPersisting, rcMemory, rcExhausted );
+    }
+
+    return 0;
+}
+
+/* Group
+ *  hashes all keys with current seed, groups entries by bucket
+ *  and orders buckets by decreasing size
+ */
+static
+rc_t KHashIdxBuildGroup_v4 ( KHashIdxBuild_v4 *b, const KHashIndex_v4 *self, uint32_t *max_size )
+{
+    uint32_t i, size, nb = b -> num_buckets;
+    uint32_t *cursor, *by_size;
+
+    memset ( b -> bstart, 0, ( ( size_t ) nb + 1 ) * sizeof b -> bstart [ 0 ] );
+    for ( i = 0; i < self -> count; ++ i )
+    {
+        const KHashIdxEntry_v4 *e = & self -> entry [ i ];
+        b -> hash [ i ] = KHashIndexHash_v4 ( self -> keys + e -> key_off, e -> key_size, b -> seed );
+        ++ b -> bstart [ KHashIndexBucket_v4 ( b -> hash [ i ], nb ) + 1 ];
+    }
+
+    /* find largest bucket, convert sizes to starts */
+    for ( * max_size = 0, i = 0; i < nb; ++ i )
+    {
+        if ( b -> bstart [ i + 1 ] > * max_size )
+            * max_size = b -> bstart [ i + 1 ];
+        b -> bstart [ i + 1 ] += b -> bstart [ i ];
+    }
+
+    /* group entries, using "border" as cursor */
+    cursor = b -> border;
+    memmove ( cursor, b -> bstart, ( size_t ) nb * sizeof cursor [ 0 ] );
+    for ( i = 0; i < self -> count; ++ i )
+        b -> order [ cursor [ KHashIndexBucket_v4 ( b -> hash [ i ], nb ) ] ++ ] = i;
+
+    /* counting sort of buckets by decreasing size */
+    by_size = calloc ( ( size_t ) * max_size + 2, sizeof by_size [ 0 ] );
+    if ( by_size == NULL )
+        return RC ( rcDB, rcIndex, rcPersisting, rcMemory, rcExhausted );
+    for ( i = 0; i < nb; ++ i )
+        ++ by_size [ * max_size - ( b -> bstart [ i + 1 ] - b -> bstart [ i ] ) + 1 ];
+    for ( size = 0; size <= * max_size; ++ size )
+        by_size [ size + 1 ] += by_size [ size ];
+    for ( i = 0; i < nb; ++ i )
+        b -> border [ by_size [ * max_size - ( b -> bstart [ i + 1 ] - b -> bstart [ i ] ) ] ++ ] = i;
+    free ( by_size );
+
+    return 0;
+}
+
+/* Place
+ *  assigns every entry a slot. "retry" is set when the
+ *  current seed does not separate the keys
+ */
+static
+rc_t KHashIdxBuildPlace_v4 ( KHashIdxBuild_v4 *b, const KHashIndex_v4 *self, bool *retry )
+{
+    rc_t rc;
+    uint32_t i, j, k, d, size, max_size, next_free, *pos;
+    const uint32_t n = self -> count;
+
+    * retry = false;
+
+    rc = KHashIdxBuildGroup_v4 ( b, self, & max_size );
+    if ( rc != 0 )
+        return rc;
+
+    pos = malloc ( ( size_t ) max_size * sizeof pos [ 0 ] );
+    if ( pos == NULL )
+        return RC ( rcDB, rcIndex, rcPersisting, rcMemory, rcExhausted );
+
+    memset ( b -> disp, 0, ( size_t ) b -> num_buckets * sizeof b -> disp [ 0 ] );
+    memset ( b -> taken, 0, ( ( size_t ) n + 7 ) >> 3 );
+
+    for ( next_free = i = 0; i < b -> num_buckets; ++ i )
+    {
+        uint32_t bucket = b -> border [ i ];
+        const uint32_t *m = & b -> order [ b -> bstart [ bucket ] ];
+        size = b -> bstart [ bucket + 1 ] - b -> bstart [ bucket ];
+
+        /* buckets are in decreasing size */
+        if ( size < 2 )
+        {
+            if ( size == 0 )
+                break;
+
+            while ( TAKEN ( b, next_free ) )
+                ++ next_free;
+            assert ( next_free < n );
+
+            TAKE ( b, next_free );
+            b -> slot2entry [ next_free ] = m [ 0 ];
+            b -> disp [ bucket ] = KHASHIDX_DIRECT_SLOT | next_free;
+            continue;
+        }
+
+        /* equal hashes cannot be separated */
+        for ( j = 1; j < size; ++ j )
+        {
+            for ( k = 0; k < j; ++ k )
+            {
+                if ( b -> hash [ m [ j ] ] == b -> hash [ m [ k ] ] )
+                {
+                    const KHashIdxEntry_v4 *ej = & self -> entry [ m [ j ] ];
+                    const KHashIdxEntry_v4 *ek = & self -> entry [ m [ k ] ];
+                    if ( ej -> key_size == ek -> key_size &&
+                         memcmp ( self -> keys + ej -> key_off, self -> keys + ek -> key_off, ej -> key_size ) == 0 )
+                    {
+                        rc = RC ( rcDB, rcIndex, rcPersisting, rcString, rcExists );
+                    }
+                    else
+                    {
+                        * retry = true;
+                    }
+                    free ( pos );
+                    return rc;
+                }
+            }
+        }
+
+        /* search for a displacement */
+        for ( d = 0; d < KHASHIDX_MAX_DISP; ++ d )
+        {
+            for ( j = 0; j < size; ++ j )
+            {
+                pos [ j ] = KHashIndexSlot_v4 ( b -> hash [ m [ j ] ], d, n );
+                if ( TAKEN ( b, pos [ j ] ) )
+                    break;
+                for ( k = 0; k < j; ++ k )
+                {
+                    if ( pos [ k ] == pos [ j ] )
+                        break;
+                }
+                if ( k < j )
+                    break;
+            }
+            if ( j == size )
+                break;
+        }
+
+        if ( d == KHASHIDX_MAX_DISP )
+        {
+            * retry = true;
+            break;
+        }
+
+        for ( j = 0; j < size; ++ j )
+        {
+            TAKE ( b, pos [ j ] );
+            b -> slot2entry [ pos [ j ] ] = m [ j ];
+        }
+        b -> disp [ bucket ] = d;
+    }
+
+    free ( pos );
+    return 0;
+}
+
+static
+rc_t KHashIndexWriteAll_v4 ( KFile *f, uint64_t *pos, const void *buffer, size_t size )
+{
+    size_t num_writ;
+    rc_t rc = KFileWriteAll ( f, * pos, buffer, size, & num_writ );
+    if ( rc == 0 )
+    {
+        if ( num_writ != size )
+            rc = RC ( rcDB, rcIndex, rcPersisting, rcTransfer, rcIncomplete );
+        else
+            * pos += size;
+    }
+    return rc;
+}
+
+/* Write
+ *  writes the image described in index-cmn.h
+ */
+static
+rc_t KHashIndexWrite_v4 ( const KHashIndex_v4 *self, const KHashIdxBuild_v4 *b, KFile *f )
+{
+    rc_t rc;
+    uint32_t i;
+    uint64_t pos, off;
+    KPHashIndexHdr_v4 hdr;
+    static const uint8_t zeros [ 8 ];
+
+    memset ( & hdr, 0, sizeof hdr );
+    KDBHdrInit ( & hdr . dad . h, KDBINDEXVERS );
+    hdr . dad . index_type = kitHash;
+
+    hdr . first = self -> entry [ 0 ] . start_id;
+    hdr . last = self -> entry [ 0 ] . start_id + self -> entry [ 0 ] . span - 1;
+    for ( i = 1; i < self -> count; ++ i )
+    {
+        const KHashIdxEntry_v4 *e = & self -> entry [ i ];
+        if ( e -> start_id < hdr . first )
+            hdr . first = e -> start_id;
+        if ( e -> start_id + e -> span - 1 > hdr . last )
+            hdr . last = e -> start_id + e -> span - 1;
+    }
+
+    hdr . key_bytes = self -> key_bytes;
+    hdr . count = self -> count;
+    hdr . num_buckets = b -> num_buckets;
+    hdr . seed = b -> seed;
+
+    pos = 0;
+    rc = KHashIndexWriteAll_v4 ( f, & pos, & hdr, sizeof hdr );
+    if ( rc == 0 )
+        rc = KHashIndexWriteAll_v4 ( f, & pos, b -> disp, ( size_t ) b -> num_buckets * sizeof b -> disp [ 0 ] );
+    if ( rc == 0 && ( b -> num_buckets & 1 ) != 0 )
+        rc = KHashIndexWriteAll_v4 ( f, & pos, zeros, sizeof b -> disp [ 0 ] );
+
+    /* slots, with keys laid out in slot order */
+    for ( off = 0, i = 0; rc == 0 && i < self -> count; ++ i )
+    {
+        KPHashIndexSlot_v4 slot;
+        const KHashIdxEntry_v4 *e = & self -> entry [ b -> slot2entry [ i ] ];
+
+        slot . start_id = e -> start_id;
+        slot . key_off = off;
+        slot . span = e -> span;
+        slot . fp = KHashIndexFP_v4 ( b -> hash [ b -> slot2entry [ i ] ] );
+        rc = KHashIndexWriteAll_v4 ( f, & pos, & slot, sizeof slot );
+
+        off += e -> key_size;
+    }
+
+    for ( i = 0; rc == 0 && i < self -> count; ++ i )
+    {
+        const KHashIdxEntry_v4 *e = & self -> entry [ b -> slot2entry [ i ] ];
+        rc = KHashIndexWriteAll_v4 ( f, & pos, self -> keys + e -> key_off, e -> key_size );
+    }
+
+    return rc;
+}
+
+/* WriteFile
+ *  creates the index file under a temporary name
+ *  and renames it on success
+ */
+static
+rc_t KHashIndexWriteFile_v4 ( const KHashIndex_v4 *self, const KHashIdxBuild_v4 *b,
+    KDirectory *dir, const char *path, bool use_md5 )
+{
+    rc_t rc;
+    KFile *f;
+    char tmpname [ 256 ], tmpmd5name [ 260 ], md5name [ 260 ];
+
+    rc = KDirectoryResolvePath ( dir, false, tmpname, sizeof tmpname, "%s.tmp", path );
+    if ( rc == 0 )
+    {
+        sprintf ( tmpmd5name, "%s.md5", tmpname );
+        rc = KDirectoryResolvePath ( dir, false, md5name, sizeof md5name, "%s.md5", path );
+    }
+    if ( rc == 0 )
+    {
+        rc = KDirectoryCreateFile ( dir, & f, false, 0664, kcmInit, "%s", tmpname );
+    }
+    if ( rc != 0 )
+        return rc;
+
+    if ( use_md5 )
+    {
+        KFile *mf;
+        rc = KDirectoryCreateFile ( dir, & mf, true, 0664, kcmInit, "%s", tmpmd5name );
+        if ( rc == 0 )
+        {
+            KMD5SumFmt *fmt;
+            rc = KMD5SumFmtMakeUpdate ( & fmt, mf );
+            if ( rc != 0 )
+                KFileRelease ( mf );
+            else
+            {
+                /* the sum is recorded under the final leaf name */
+                KMD5File *fmd5;
+                const char *leaf = strrchr ( path, '/' );
+                rc = KMD5FileMakeWrite ( & fmd5, f, fmt, leaf != NULL ? leaf + 1 : path );
+                KMD5SumFmtRelease ( fmt );
+                if ( rc == 0 )
+                    f = KMD5FileToKFile ( fmd5 );
+            }
+        }
+    }
+
+    if ( rc == 0 )
+    {
+        KFile *bf;
+        rc = KBufFileMakeWrite ( & bf, f, false, KHASHIDX_BUF_SIZE );
+        if ( rc == 0 )
+        {
+            rc = KHashIndexWrite_v4 ( self, b, bf );
+
+            /* releasing the buffer flushes it */
+            if ( rc == 0 )
+                rc = KFileRelease ( bf );
+            else
+                KFileRelease ( bf );
+        }
+    }
+    KFileRelease ( f );
+
+    if ( rc == 0 )
+    {
+        rc = KDirectoryRename ( dir, false, tmpname, path );
+        if ( rc == 0 )
+        {
+            if ( ! use_md5 )
+                return 0;
+
+            rc = KDirectoryRename ( dir, false, tmpmd5name, md5name );
+            if ( rc == 0 )
+                return 0;
+        }
+    }
+
+    KDirectoryRemove ( dir, false, "%s", tmpname );
+    if ( use_md5 )
+        KDirectoryRemove ( dir, false, "%s", tmpmd5name );
+
+    return rc;
+}
+
+/* Persist
+ *  builds the hash and writes index to file
+ */
+rc_t KHashIndexPersist_v4 ( KHashIndex_v4 *self,
+    KDirectory *dir, const char *path, bool use_md5 )
+{
+    rc_t rc;
+    KHashIdxBuild_v4 b;
+
+    if ( self -> count == 0 )
+        return 0;
+
+    rc = KHashIdxBuildInit_v4 ( & b, self -> count );
+    if ( rc == 0 )
+    {
+        bool retry = true;
+        for ( b . seed = 0; rc == 0 && retry; ++ b . seed )
+        {
+            if ( b . seed == KHASHIDX_MAX_SEEDS )
+            {
+                rc = RC ( rcDB, rcIndex, rcPersisting, rcIndex, rcExhausted );
+                break;
+            }
+
+            rc = KHashIdxBuildPlace_v4 ( & b, self, & retry );
+            if ( rc == 0 && ! retry )
+                rc = KHashIndexWriteFile_v4 ( self, & b, dir, path, use_md5 );
+        }
+
+        KHashIdxBuildWhack_v4 ( & b );
+    }
+
+    return rc;
+}
@@ -195,6 +195,31 @@ rc_t KTrieIndexPersist_v2 ( const KTrieIndex_v2 *self,
     bool proj, struct KDirectory *dir, const char *path, bool use_md5 );
 
 
+/*--------------------------------------------------------------------------
+ * KTrieIdxBulk_v2
+ *  builds a KTrieIndex_v2 file from inserts sorted externally,
+ *  without an in-core Trie
+ */
+typedef struct KTrieIdxBulk_v2 KTrieIdxBulk_v2;
+
+/* make a builder for the index at "path" relative to "dir" */
+rc_t KTrieIdxBulkMake_v2 ( KTrieIdxBulk_v2 **bulk, struct KDirectory *dir,
+    const char *path, bool proj, size_t mem_limit );
+
+/* insert string, mapping to 64 bit id */
+rc_t KTrieIdxBulkInsert_v2 ( KTrieIdxBulk_v2 *self, const char *key, int64_t id );
+
+/* map id to string for a projecting builder */
+rc_t KTrieIdxBulkProject_v2 ( KTrieIdxBulk_v2 *self, int64_t id,
+    int64_t *start_id, uint32_t *span, char *key_buff, size_t buff_size, size_t *actsize );
+
+/* persist index to file */
+rc_t KTrieIdxBulkPersist_v2 ( KTrieIdxBulk_v2 *self, bool use_md5 );
+
+/* release builder and its temporary files */
+void KTrieIdxBulkWhack_v2 ( KTrieIdxBulk_v2 *self );
+
+
 /*--------------------------------------------------------------------------
  * KU64Index_v3
  */
@@ -210,6 +235,43 @@ rc_t KU64IndexDelete_v3(KU64Index_v3* self, uint64_t key);
 rc_t KU64IndexPersist_v3(KU64Index_v3* self, bool proj, struct KDirectory *dir, const char *path, bool use_md5);
 
 
+/*--------------------------------------------------------------------------
+ * KHashIndex_v4
+ *  entries are collected in core and hashed when persisted
+ */
+typedef struct KHashIdxEntry_v4 KHashIdxEntry_v4;
+struct KHashIdxEntry_v4
+{
+    uint64_t key_off;
+    int64_t start_id;
+    uint32_t span;
+    uint32_t key_size;
+};
+
+struct KHashIndex_v4
+{
+    KPHashIndex_v4 pt;
+    KHashIdxEntry_v4 *entry;
+    char *keys;
+    uint64_t key_bytes, key_max;
+    uint32_t count, max;
+};
+
+/* initialize an index from file - can be NULL */
+rc_t KHashIndexOpen_v4 ( KHashIndex_v4 *self, struct KMMap const *mm, bool byteswap );
+
+/* whack whack */
+void KHashIndexWhack_v4 ( KHashIndex_v4 *self );
+
+/* map key to range of "span" ids starting with "id" */
+rc_t KHashIndexInsert_v4 ( KHashIndex_v4 *self,
+    const char *key, int64_t id, uint32_t span );
+
+/* persist index to file */
+rc_t KHashIndexPersist_v4 ( KHashIndex_v4 *self,
+    struct KDirectory *dir, const char *path, bool use_md5 );
+
+
 
 /*--------------------------------------------------------------------------
  * KIndex
@@ -70,7 +70,9 @@ struct KIndex
         KTrieIndex_v1 txt1;
         KTrieIndex_v2 txt2;
         KU64Index_v3  u64_3;
+        KHashIndex_v4 hash4;
     } u;
+    KTrieIdxBulk_v2 *bulk;
     bool converted_from_v1;
     uint8_t type;
     uint8_t read_only;
@@ -146,6 +148,7 @@ rc_t KIndexWhack ( KIndex *self )
                     case 2:
                     case 3:
                     case 4:
+                        KTrieIdxBulkWhack_v2 ( self -> bulk );
                         KTrieIndexWhack_v2 ( & self -> u . txt2 );
                         rc = 0;
                         break;
@@ -161,6 +164,11 @@ rc_t KIndexWhack ( KIndex *self )
                         break;
                     }
                     break;
+
+                case kitHash:
+                    KHashIndexWhack_v4 ( & self -> u . hash4 );
+                    rc = 0;
+                    break;
                 }
             }
         }
@@ -286,6 +294,9 @@ rc_t KIndexAttach ( KIndex *self, const KMMap *mm, bool *byteswap )
                     case kitText:
                     case kitU64:
                         break;
+                    case kitHash:
+                        if ( hdr -> version >= 4 )
+                            break;
                     default:
                         rc = RC(rcDB, rcIndex, rcConstructing, rcIndex, rcUnrecognized);
                     }
@@ -428,6 +439,10 @@ rc_t KIndexMakeRead ( KIndex **idxp, const KDirectory *dir, const char *path )
                             case kitU64:
                                 rc = KU64IndexOpen_v3(&idx->u.u64_3, mm, byteswap);
                                 break;
+
+                            case kitHash:
+                                rc = KHashIndexOpen_v4 ( & idx -> u . hash4, mm, byteswap );
+                                break;
                         }
                         break;
 #endif
@@ -513,6 +528,10 @@ rc_t KIndexMakeUpdate ( KIndex **idxp, KDirectory *dir, const char *path )
                             case kitU64:
                                 rc = KU64IndexOpen_v3(&idx->u.u64_3, mm, byteswap);
                                 break;
+
+                            case kitHash:
+                                rc = KHashIndexOpen_v4 ( & idx -> u . hash4, mm, byteswap );
+                                break;
                         }
                         break;
 #endif
@@ -635,6 +654,10 @@ rc_t KIndexCreate ( KIndex **idxp, KDirectory *dir,
             rc = KU64IndexOpen_v3 ( & idx->u.u64_3, NULL, false );
             break;
 
+        case kitHash:
+            rc = KHashIndexOpen_v4 ( & idx -> u . hash4, NULL, false );
+            break;
+
         default:
             rc = RC ( rcDB, rcIndex, rcConstructing, rcType, rcUnsupported );
         }
@@ -1293,6 +1316,58 @@ LIB_EXPORT rc_t CC KIndexType ( const KIndex *self, KIdxType *type )
     return 0;
 }
 
+/* Reopen
+ *  replaces in-core contents with the committed file
+ */
+static
+rc_t KIndexReopen ( KIndex *self )
+{
+    const KFile *f;
+
+    /* nothing was written for an empty index */
+    rc_t rc = KDirectoryOpenFileRead ( self -> dir, & f, "%s", self -> path );
+    if ( GetRCState ( rc ) == rcNotFound )
+        return 0;
+    if ( rc == 0 )
+    {
+        const KMMap *mm;
+        rc = KMMapMakeRead ( & mm, f );
+        if ( rc == 0 )
+        {
+            switch ( self -> type )
+            {
+            case kitHash:
+                KHashIndexWhack_v4 ( & self -> u . hash4 );
+                rc = KHashIndexOpen_v4 ( & self -> u . hash4, mm, false );
+                break;
+            default:
+                KTrieIndexWhack_v2 ( & self -> u . txt2 );
+                rc = KTrieIndexOpen_v2 ( & self -> u . txt2, mm, false );
+            }
+            KMMapRelease ( mm );
+        }
+        KFileRelease ( f );
+    }
+    return rc;
+}
+
+/* CommitBulk
+ *  builds the index from bulk inserts and reopens it from disk
+ */
+static
+rc_t KIndexCommitBulk ( KIndex *self )
+{
+    rc_t rc = KTrieIdxBulkPersist_v2 ( self -> bulk, self -> use_md5 );
+    if ( rc == 0 )
+    {
+        KTrieIdxBulkWhack_v2 ( self -> bulk );
+        self -> bulk = NULL;
+
+        rc = KIndexReopen ( self );
+    }
+    return rc;
+}
+
 /* Commit
  *  ensure any changes are committed to disk
  */
@@ -1324,8 +1399,13 @@ LIB_EXPORT rc_t CC KIndexCommit ( KIndex *self )
             case 2:
             case 3:
             case 4:
-                rc = KTrieIndexPersist_v2 ( & self -> u . txt2,
-                    proj, self -> dir, self -> path, self -> use_md5 );
+                if ( self -> bulk != NULL )
+                    rc = KIndexCommitBulk ( self );
+                else
+                {
+                    rc = KTrieIndexPersist_v2 ( & self -> u . txt2,
+                        proj, self -> dir, self -> path, self -> use_md5 );
+                }
                 break;
             }
             break;
@@ -1339,6 +1419,14 @@ LIB_EXPORT rc_t CC KIndexCommit ( KIndex *self )
                 break;
             }
             break;
+
+        case kitHash:
+            /* finds only see the built hash, so reopen it */
+            rc = KHashIndexPersist_v4 ( & self -> u . hash4,
+                self -> dir, self -> path, self -> use_md5 );
+            if ( rc == 0 )
+                rc = KIndexReopen ( self );
+            break;
     }
 
     if ( rc == 0 )
@@ -1347,6 +1435,39 @@ LIB_EXPORT rc_t CC KIndexCommit ( KIndex *self )
     return rc;
 }
 
+/* SetBulkInsert
+ *  switches an empty text index to bulk loading mode
+ */
+LIB_EXPORT rc_t CC KIndexSetBulkInsert ( KIndex *self, size_t mem_limit )
+{
+    if ( self == NULL )
+        return RC ( rcDB, rcIndex, rcUpdating, rcSelf, rcNull );
+    if ( self -> read_only )
+        return RC ( rcDB, rcIndex, rcUpdating, rcIndex, rcReadonly );
+    if ( self -> bulk != NULL )
+        return 0;
+
+    switch ( self -> type )
+    {
+    case kitText:
+    case kitText | kitProj:
+        switch ( self -> vers )
+        {
+        case 2:
+        case 3:
+        case 4:
+            /* only an index with no entries can be built in bulk */
+            if ( self -> u . txt2 . count != 0 || self -> u . txt2 . pt . key2id != NULL )
+                return RC ( rcDB, rcIndex, rcUpdating, rcData, rcExists );
+            return KTrieIdxBulkMake_v2 ( & self -> bulk, self -> dir, self -> path,
+                ( self -> type & kitProj ) != 0, mem_limit );
+        }
+        return RC ( rcDB, rcIndex, rcUpdating, rcIndex, rcBadVersion );
+    }
+
+    return RC ( rcDB, rcIndex, rcUpdating, rcType, rcUnsupported );
+}
+
 /* Insert
  *  creates a mapping from key to id
  *  and potentially from id to key if supported
@@ -1391,13 +1512,21 @@ LIB_EXPORT rc_t CC KIndexInsertText ( KIndex *self, bool unique,
         case 2:
         case 3:
         case 4:
-            rc = KTrieIndexInsert_v2 ( & self -> u . txt2,
-                proj, key, id );
+            if ( self -> bulk != NULL )
+                rc = KTrieIdxBulkInsert_v2 ( self -> bulk, key, id );
+            else
+            {
+                rc = KTrieIndexInsert_v2 ( & self -> u . txt2,
+                    proj, key, id );
+            }
             break;
         default:
             return RC ( rcDB, rcIndex, rcInserting, rcIndex, rcBadVersion );
         }
         break;
+    case kitHash:
+        rc = KHashIndexInsert_v4 ( & self -> u . hash4, key, id, 1 );
+        break;
     default:
         return RC ( rcDB, rcIndex, rcInserting, rcType, rcUnsupported );
     }
@@ -1449,6 +1578,8 @@ LIB_EXPORT rc_t CC KIndexDeleteText ( KIndex *self, const char *key )
         case 2:
         case 3:
         case 4:
+            if ( self -> bulk != NULL )
+                return RC ( rcDB, rcIndex, rcRemoving, rcIndex, rcBusy );
             rc = KTrieIndexDelete_v2 ( & self -> u . txt2, proj, key );
             break;
         default:
@@ -1466,6 +1597,82 @@ LIB_EXPORT rc_t CC KIndexDeleteText ( KIndex *self, const char *key )
 }
 
 
+/* CopyText
+ *  inserts every mapping of a projecting text index
+ */
+LIB_EXPORT rc_t CC KIndexCopyText ( KIndex *self, const KIndex *src )
+{
+    rc_t rc = 0;
+    int64_t id, last;
+    const KTrieIndex_v2 *txt;
+    char key [ 4096 ];
+
+    if ( self == NULL )
+        return RC ( rcDB, rcIndex, rcInserting, rcSelf, rcNull );
+    if ( src == NULL )
+        return RC ( rcDB, rcIndex, rcInserting, rcParam, rcNull );
+    if ( self -> read_only )
+        return RC ( rcDB, rcIndex, rcInserting, rcIndex, rcReadonly );
+
+    /* keys are enumerated by projecting ids */
+    if ( src -> type != ( uint8_t ) ( kitText | kitProj ) )
+        return RC ( rcDB, rcIndex, rcInserting, rcType, rcUnsupported );
+    if ( src -> vers < 2 || src -> bulk != NULL )
+        return RC ( rcDB, rcIndex, rcInserting, rcIndex, rcBadVersion );
+
+    txt = & src -> u . txt2;
+    if ( txt -> count != 0 )
+    {
+        id = txt -> first;
+        last = txt -> last;
+    }
+    else if ( txt -> pt . ord2node != NULL )
+    {
+        id = txt -> pt . first;
+        last = txt -> pt . last;
+    }
+    else
+    {
+        return 0;
+    }
+
+    while ( rc == 0 && id <= last )
+    {
+        int64_t start_id;
+        uint32_t span;
+
+        rc = KTrieIndexProject_v2 ( txt, id, & start_id, & span, key, sizeof key, NULL );
+        if ( rc != 0 )
+        {
+            /* skip holes in the id space */
+            if ( GetRCState ( rc ) == rcNotFound )
+            {
+                rc = 0;
+                ++ id;
+            }
+            continue;
+        }
+
+        if ( self -> type == ( uint8_t ) kitHash )
+        {
+            rc = KHashIndexInsert_v4 ( & self -> u . hash4, key, start_id, span );
+            if ( rc == 0 )
+                self -> dirty = true;
+        }
+        else
+        {
+            uint32_t i;
+            for ( i = 0; rc == 0 && i < span; ++ i )
+                rc = KIndexInsertText ( self, true, key, start_id + i );
+        }
+
+        id = start_id + span;
+    }
+
+    return rc;
+}
+
+
 /* Find
  *  finds a single mapping from key
  */
@@ -1507,6 +1714,9 @@ LIB_EXPORT rc_t CC KIndexFindText ( const KIndex *self, const char *key, int64_t
         case 2:
         case 3:
         case 4:
+            /* entries are not searchable until committed */
+            if ( self -> bulk != NULL )
+                return RC ( rcDB, rcIndex, rcSelecting, rcIndex, rcBusy );
 #if V2FIND_RETURNS_SPAN
             rc = KTrieIndexFind_v2 ( & self -> u . txt2, key, start_id, & span, custom_cmp, data, self -> converted_from_v1 );
 #else
@@ -1518,6 +1728,12 @@ LIB_EXPORT rc_t CC KIndexFindText ( const KIndex *self, const char *key, int64_t
             return RC ( rcDB, rcIndex, rcSelecting, rcIndex, rcBadVersion );
         }
         break;
+    case kitHash:
+        /* keys are only compared for equality */
+        if ( custom_cmp != NULL )
+            return RC ( rcDB, rcIndex, rcSelecting, rcFunction, rcUnsupported );
+        rc = KPHashIndexFind_v4 ( & self -> u . hash4 . pt, key, start_id, & span );
+        break;
     default:
         return RC ( rcDB, rcIndex, rcSelecting, rcType, rcUnsupported );
     }
@@ -1529,6 +1745,51 @@ LIB_EXPORT rc_t CC KIndexFindText ( const KIndex *self, const char *key, int64_t
 }
 
 
+/* FindTextBatch
+ *  finds a single mapping for each of several keys
+ *  an index open for update looks each key up in turn
+ */
+LIB_EXPORT rc_t CC KIndexFindTextBatch ( const KIndex *self,
+    uint32_t count, const char *const keys [],
+    int64_t start_id [], uint64_t id_count [], uint32_t *num_found )
+{
+    rc_t rc;
+    uint32_t i, found;
+
+    if ( num_found != NULL )
+        * num_found = 0;
+
+    if ( count == 0 )
+        return 0;
+
+    if ( keys == NULL || start_id == NULL || id_count == NULL )
+        return RC ( rcDB, rcIndex, rcSelecting, rcParam, rcNull );
+
+    for ( rc = 0, found = i = 0; i < count; ++ i )
+    {
+        if ( keys [ i ] == NULL || keys [ i ] [ 0 ] == 0 )
+        {
+            start_id [ i ] = 0;
+            id_count [ i ] = 0;
+            continue;
+        }
+
+        rc = KIndexFindText ( self, keys [ i ], & start_id [ i ], & id_count [ i ], NULL, NULL );
+        if ( rc == 0 )
+            ++ found;
+        else if ( GetRCState ( rc ) == rcNotFound )
+            rc = 0;
+        else
+            break;
+    }
+
+    if ( num_found != NULL )
+        * num_found = found;
+
+    return rc;
+}
+
+
 /* FindAll
  *  finds all mappings from key
  */
@@ -1564,6 +1825,8 @@ LIB_EXPORT rc_t CC KIndexFindAllText ( const KIndex *self, const char *key,
         case 2:
         case 3:
         case 4:
+            if ( self -> bulk != NULL )
+                return RC ( rcDB, rcIndex, rcSelecting, rcIndex, rcBusy );
 #if V2FIND_RETURNS_SPAN
             rc = KTrieIndexFind_v2 ( & self -> u . txt2, key, & id64, & span, NULL, NULL, self -> converted_from_v1 );
 #else
@@ -1576,6 +1839,11 @@ LIB_EXPORT rc_t CC KIndexFindAllText ( const KIndex *self, const char *key,
             return RC ( rcDB, rcIndex, rcSelecting, rcIndex, rcBadVersion );
         }
         break;
+    case kitHash:
+        rc = KPHashIndexFind_v4 ( & self -> u . hash4 . pt, key, & id64, & span );
+        if ( rc == 0 )
+            rc = ( * f ) ( id64, span, data );
+        break;
     default:
         return RC ( rcDB, rcIndex, rcSelecting, rcType, rcUnsupported );
     }
@@ -1636,6 +1904,11 @@ LIB_EXPORT rc_t CC KIndexProjectText ( const KIndex *self,
         case 2:
         case 3:
         case 4:
+            if ( self -> bulk != NULL )
+            {
+                rc = KTrieIdxBulkProject_v2 ( self -> bulk, id, start_id, & span, key, kmax, actsize );
+                break;
+            }
 #if V2FIND_RETURNS_SPAN
             rc = KTrieIndexProject_v2 ( & self -> u . txt2, id, start_id, & span, key, kmax, actsize );
 #else
@@ -1702,8 +1975,13 @@ LIB_EXPORT rc_t CC KIndexProjectAllText ( const KIndex *self, int64_t id,
         case 3:
         case 4:
 #if V2FIND_RETURNS_SPAN
-            rc = KTrieIndexProject_v2 ( & self -> u . txt2, id, & start_id, & span, key, sizeof key, NULL );
+            if ( self -> bulk != NULL )
+                rc = KTrieIdxBulkProject_v2 ( self -> bulk, id, & start_id, & span, key, sizeof key, NULL );
+            else
+                rc = KTrieIndexProject_v2 ( & self -> u . txt2, id, & start_id, & span, key, sizeof key, NULL );
 #else
+            if ( self -> bulk != NULL )
+                return RC ( rcDB, rcIndex, rcProjecting, rcIndex, rcBusy );
             rc = KTrieIndexProject_v2 ( & self -> u . txt2, id, key, sizeof key, NULL );
 #endif
             if ( rc == 0 )
@@ -1831,6 +2109,40 @@ LIB_EXPORT rc_t CC KIndexFindU64( const KIndex* self, uint64_t offset, uint64_t*
     return rc;
 }
 
+LIB_EXPORT rc_t CC KIndexFindU64Batch ( const KIndex *self,
+    uint32_t count, const uint64_t offset [],
+    uint64_t key [], uint64_t key_size [],
+    int64_t start_id [], uint64_t id_count [], uint32_t *num_found )
+{
+    rc_t rc;
+    uint32_t i, found;
+
+    if ( num_found != NULL )
+        * num_found = 0;
+
+    if ( count == 0 )
+        return 0;
+
+    if ( offset == NULL || key == NULL || key_size == NULL || start_id == NULL || id_count == NULL )
+        return RC ( rcDB, rcIndex, rcSelecting, rcParam, rcNull );
+
+    for ( rc = 0, found = i = 0; i < count; ++ i )
+    {
+        rc = KIndexFindU64 ( self, offset [ i ], & key [ i ], & key_size [ i ], & start_id [ i ], & id_count [ i ] );
+        if ( rc == 0 )
+            ++ found;
+        else if ( GetRCState ( rc ) == rcNotFound )
+            rc = 0;
+        else
+            break;
+    }
+
+    if ( num_found != NULL )
+        * num_found = found;
+
+    return rc;
+}
+
 LIB_EXPORT rc_t CC KIndexFindAllU64( const KIndex* self, uint64_t offset,
     rc_t ( CC * f )(uint64_t key, uint64_t key_size, int64_t id, uint64_t id_qty, void* data ), void* data)
 {
@@ -32,11 +32,13 @@
 #include <kdb/index.h>
 #include <kfs/directory.h>
 #include <kfs/file.h>
+#include <kfs/buffile.h>
 #include <kfs/md5.h>
 #include <kfs/mmap.h>
 #include <klib/ptrie.h>
 #include <klib/text.h>
 #include <klib/pack.h>
+#include <klib/sort.h>
 #include <klib/rc.h>
 #include <os-native.h>
 #include <sysalloc.h>
@@ -1170,10 +1172,41 @@ rc_t CC KTrieIndexAux_v2_s2 ( void *param, const void *node, size_t *num_writ,
 /* KTrieIndexPersist_v*
  *  write keymap to indicated location
  */
+
+/* KTrieIndexMaxSpan_v2
+ *  if we have maintained a projection index,
+ *  calculate max span now
+ */
+static
+uint32_t KTrieIndexMaxSpan_v2 ( KTrieIndex_v2 *self )
+{
+    if ( self -> ord2node != NULL )
+    {
+        uint32_t i, span, max_span;
+        int64_t cur, prev = self -> first;
+        for ( i = max_span = 1; i < self -> count; prev = cur, ++ i )
+        {
+            cur = self -> ord2node [ i ] -> start_id;
+            span = ( uint32_t ) ( cur - prev );
+            if ( span > max_span )
+                max_span = span;
+        }
+        
+        span = ( uint32_t ) ( self -> last - prev );
+        if ( span > max_span )
+            max_span = span;
+
+        self -> max_span = max_span;
+    }
+
+    return self -> max_span;
+}
+
 #if KDBINDEXVERS == 2
 
 static
-void KTrieIndexPersistHdr_v2 ( KTrieIndex_v2 *self, PersistTrieData *pb )
+void KTrieIndexPersistHdr_v2 ( PersistTrieData *pb,
+    int64_t first, int64_t last, uint32_t max_span )
 {
     KPTrieIndexHdr_v2 *hdr;
 
@@ -1189,14 +1222,14 @@ void KTrieIndexPersistHdr_v2 ( KTrieIndex_v2 *self, PersistTrieData *pb )
     KDBHdrInit(&hdr->dad, 2);
 
     /* store first and last ids */
-    pb -> first = self -> first;
-    hdr -> first = self -> first;
-    hdr -> last = self -> last;
+    pb -> first = first;
+    hdr -> first = first;
+    hdr -> last = last;
 
     /* calculate id bits - notice that
        total_id gets right shifted so that
        the loop is guaranteed to exit */
-    total_id = self -> last - self -> first;
+    total_id = last - first;
     if ( total_id == 0 )
         pb -> id_bits = 0;
     else for ( total_id >>= 1, pb -> id_bits = 1, test_id = 1;
@@ -1204,29 +1237,8 @@ void KTrieIndexPersistHdr_v2 ( KTrieIndex_v2 *self, PersistTrieData *pb )
           ++ pb -> id_bits, test_id <<= 1 )
         ( void ) 0;
 
-    /* if we have maintained a projection index,
-       calculate max span now */
-    if ( self -> ord2node != NULL )
-    {
-        uint32_t i, span, max_span;
-        int64_t cur, prev = self -> first;
-        for ( i = max_span = 1; i < self -> count; prev = cur, ++ i )
-        {
-            cur = self -> ord2node [ i ] -> start_id;
-            span = ( uint32_t ) ( cur - prev );
-            if ( span > max_span )
-                max_span = span;
-        }
-        
-        span = ( uint32_t ) ( self -> last - prev );
-        if ( span > max_span )
-            max_span = span;
-
-        self -> max_span = max_span;
-    }
-
     /* calculate span bits */
-    total_span = self -> max_span;
+    total_span = max_span;
     if ( total_span == 0 )
         pb -> span_bits = 0;
     else for ( total_span >>= 1, pb -> span_bits = 1, test_span = 1;
@@ -1245,7 +1257,8 @@ void KTrieIndexPersistHdr_v2 ( KTrieIndex_v2 *self, PersistTrieData *pb )
 #else
 
 static
-void KTrieIndexPersistHdr_v3_v4 ( KTrieIndex_v2 *self, PersistTrieData *pb )
+void KTrieIndexPersistHdr_v3_v4 ( PersistTrieData *pb,
+    int64_t first, int64_t last, uint32_t max_span )
 {
     KPTrieIndexHdr_v3 *hdr;
 
@@ -1262,14 +1275,14 @@ void KTrieIndexPersistHdr_v3_v4 ( KTrieIndex_v2 *self, PersistTrieData *pb )
     hdr->dad.index_type = kitText;
 
     /* store first and last ids */
-    pb -> first = self -> first;
-    hdr -> first = self -> first;
-    hdr -> last = self -> last;
+    pb -> first = first;
+    hdr -> first = first;
+    hdr -> last = last;
 
     /* calculate id bits - notice that
        total_id gets right shifted so that
        the loop is guaranteed to exit */
-    total_id = self -> last - self -> first;
+    total_id = last - first;
     if ( total_id == 0 )
         pb -> id_bits = 0;
     else for ( total_id >>= 1, pb -> id_bits = 1, test_id = 1;
@@ -1277,29 +1290,8 @@ void KTrieIndexPersistHdr_v3_v4 ( KTrieIndex_v2 *self, PersistTrieData *pb )
           ++ pb -> id_bits, test_id <<= 1 )
         ( void ) 0;
 
-    /* if we have maintained a projection index,
-       calculate max span now */
-    if ( self -> ord2node != NULL )
-    {
-        uint32_t i, span, max_span;
-        int64_t cur, prev = self -> first;
-        for ( i = max_span = 1; i < self -> count; prev = cur, ++ i )
-        {
-            cur = self -> ord2node [ i ] -> start_id;
-            span = ( uint32_t ) ( cur - prev );
-            if ( span > max_span )
-                max_span = span;
-        }
-        
-        span = ( uint32_t ) ( self -> last - prev );
-        if ( span > max_span )
-            max_span = span;
-
-        self -> max_span = max_span;
-    }
-
     /* calculate span bits */
-    total_span = self -> max_span;
+    total_span = max_span;
     if ( total_span == 0 )
         pb -> span_bits = 0;
     else for ( total_span >>= 1, pb -> span_bits = 1, test_span = 1;
@@ -1766,16 +1758,17 @@ rc_t KTrieIndexCreateMD5Wrapper ( KDirectory *dir, KFile ** fp, KMD5File ** wrap
     return rc;
 }
 
-rc_t KTrieIndexPersist_v2 ( const KTrieIndex_v2 *self,
-    bool proj, KDirectory *dir, const char *path, bool use_md5 )
+/* KTrieIndexPersistFile_v2
+ *  creates the index file under a temporary name,
+ *  has "persist" write its contents and renames it on success
+ */
+static
+rc_t KTrieIndexPersistFile_v2 ( KDirectory *dir, const char *path, bool use_md5,
+    rc_t ( * persist ) ( void *obj, PersistTrieData *pb ), void *obj )
 {
     rc_t rc;
     PersistTrieData pb;
 
-    assert ( self != NULL );
-    if ( self -> count == 0 )
-        return 0;
-
     pb . fmd5 = NULL;
 
     /** Trie may have holes in serialization due to memory alignments ***/
@@ -1809,26 +1802,7 @@ rc_t KTrieIndexPersist_v2 ( const KTrieIndex_v2 *self,
                 {
                     /* initial size */
                     pb . ptt_size = 0;
-#if KDBINDEXVERS == 2
-                    KTrieIndexPersistHdr_v2 ( ( KTrieIndex_v2* ) self, & pb );
-#else
-                    KTrieIndexPersistHdr_v3_v4 ( ( KTrieIndex_v2* ) self, & pb );
-#endif
-
-                    /* persist tree */
-                    rc = KTrieIndexPersistTrie_v2 ( self, & pb );
-                    if ( rc == 0 )
-                    {
-                        /* persist projection table */
-                        if ( proj )
-                        {
-#if KDBINDEXVERS == 2
-                            rc = KTrieIndexPersistProj_v2 ( self, & pb );
-#else
-                            rc = KTrieIndexPersistProj_v3 ( self, & pb );
-#endif
-                        }
-                    }
+                    rc = ( * persist ) ( obj, & pb );
                 }
                     
                 /* close down the file now, success or not */
@@ -1884,6 +1858,62 @@ rc_t KTrieIndexPersist_v2 ( const KTrieIndex_v2 *self,
 }
 
 
+typedef struct KTrieIndexPersistData_v2 KTrieIndexPersistData_v2;
+struct KTrieIndexPersistData_v2
+{
+    KTrieIndex_v2 *self;
+    bool proj;
+};
+
+static
+rc_t KTrieIndexPersistContents_v2 ( void *obj, PersistTrieData *pb )
+{
+    rc_t rc;
+    KTrieIndexPersistData_v2 *data = obj;
+    KTrieIndex_v2 *self = data -> self;
+    uint32_t max_span = KTrieIndexMaxSpan_v2 ( self );
+
+#if KDBINDEXVERS == 2
+    KTrieIndexPersistHdr_v2 ( pb, self -> first, self -> last, max_span );
+#else
+    KTrieIndexPersistHdr_v3_v4 ( pb, self -> first, self -> last, max_span );
+#endif
+
+    /* persist tree */
+    rc = KTrieIndexPersistTrie_v2 ( self, pb );
+    if ( rc == 0 )
+    {
+        /* persist projection table */
+        if ( data -> proj )
+        {
+#if KDBINDEXVERS == 2
+            rc = KTrieIndexPersistProj_v2 ( self, pb );
+#else
+            rc = KTrieIndexPersistProj_v3 ( self, pb );
+#endif
+        }
+    }
+
+    return rc;
+}
+
+rc_t KTrieIndexPersist_v2 ( const KTrieIndex_v2 *self,
+    bool proj, KDirectory *dir, const char *path, bool use_md5 )
+{
+    KTrieIndexPersistData_v2 data;
+
+    assert ( self != NULL );
+    if ( self -> count == 0 )
+        return 0;
+
+    data . self = ( KTrieIndex_v2* ) self;
+    data . proj = proj;
+
+    return KTrieIndexPersistFile_v2 ( dir, path, use_md5,
+        KTrieIndexPersistContents_v2, & data );
+}
+
+
 /* whack whack */
 void KTrieIndexWhack_v2 ( KTrieIndex_v2 *self )
 {
@@ -2558,3 +2588,1306 @@ rc_t KTrieIndexProject_v2 ( const KTrieIndex_v2 *self,
 
     return RC ( rcDB, rcIndex, rcProjecting, rcId, rcNotFound );
 }
+
+
+/*--------------------------------------------------------------------------
+ * KTrieIdxBulk_v2
+ *  builds a text index from a large number of inserts without
+ *  holding the keys in a Trie. entries are sorted in runs that are
+ *  spilled to temporary files next to the index, merged in key order
+ *  at commit and fed to a PTrieBuilder, which loads them back from
+ *  the merged file while writing the image.
+ */
+
+#define KTRIEIDX_BULK_MEM_LIMIT ( ( size_t ) 256 * 1024 * 1024 )
+#define KTRIEIDX_BULK_BUF_SIZE ( 256 * 1024 )
+
+/* temporary entry record, followed by key bytes
+   all temporary files are in native byte order */
+typedef struct KTrieIdxBulkRec_v2 KTrieIdxBulkRec_v2;
+struct KTrieIdxBulkRec_v2
+{
+    uint32_t size;
+    uint32_t span;
+    int64_t start_id;
+};
+
+/* sequential reader of temporary records */
+typedef struct KTrieIdxBulkReader_v2 KTrieIdxBulkReader_v2;
+struct KTrieIdxBulkReader_v2
+{
+    const KFile *f;
+    uint64_t pos;
+    KTrieIdxBulkRec_v2 rec;
+    char *key;
+    size_t kmax;
+    bool eof;
+};
+
+/* a spilled run as seen by inserts, which must find
+   a key repeated after other keys without merging.
+   a filter hit is confirmed by reading the stretch
+   of the run that follows the nearest sampled key */
+#define KTRIEIDX_BULK_SAMPLE 64
+#define KTRIEIDX_BULK_BLOOM_BITS 10
+#define KTRIEIDX_BULK_BLOOM_PROBES 7
+
+typedef struct KTrieIdxBulkRun_v2 KTrieIdxBulkRun_v2;
+struct KTrieIdxBulkRun_v2
+{
+    const KFile *f;
+    uint64_t eof;
+
+    /* Bloom filter over the keys of the run */
+    uint64_t *bloom;
+    uint64_t bloom_bits;
+
+    /* position and key of every KTRIEIDX_BULK_SAMPLE'th record */
+    uint64_t *spos;
+    size_t *soff;
+    char *skeys;
+    size_t skeys_max;
+    size_t num_samples;
+};
+
+struct KTrieIdxBulk_v2
+{
+    KDirectory *dir;
+    PTrieBuilder *builder;
+
+    /* entries in id order, including holes - proj only,
+       with the position and start id of every KTRIEIDX_BULK_SAMPLE'th */
+    KFile *ids;
+    uint64_t ids_pos;
+    uint64_t *ids_spos;
+    int64_t *ids_sid;
+    size_t ids_smax;
+
+    /* merged entries in key order */
+    const KFile *keys;
+
+    /* records of the current run and their offsets */
+    uint8_t *arena;
+    size_t arena_size, arena_max;
+    size_t *ord;
+    size_t ord_count, ord_max;
+    size_t mem_limit;
+    uint32_t num_runs;
+
+    /* open addressed table of arena offsets + 1 over the current run */
+    size_t *ht;
+    size_t ht_max;
+
+    /* spilled runs and a buffer for reading them back */
+    KTrieIdxBulkRun_v2 *runs;
+    char *chunk;
+    size_t chunk_max;
+
+    /* the entry being extended by inserts */
+    KTrieIdxBulkRec_v2 cur;
+    char *cur_key;
+    size_t cur_kmax;
+
+    int64_t first, last, prev_start;
+    uint32_t count;
+    uint32_t max_span;
+    bool proj;
+
+    char path [ 1 ];
+};
+
+static
+rc_t KTrieIdxBulkReserve_v2 ( char **buffer, size_t *bmax, size_t size )
+{
+    if ( size > * bmax )
+    {
+        size_t new_max = ( size + 255 ) & ~ ( size_t ) 255;
+        char *new_buffer = realloc ( * buffer, new_max );
+        if ( new_buffer == NULL )
+            return RC ( rcDB, rcIndex, rcAllocating, rcMemory, rcExhausted );
+        * buffer = new_buffer;
+        * bmax = new_max;
+    }
+    return 0;
+}
+
+static
+int KTrieIdxBulkKeyCmp_v2 ( const char *a, size_t asize, const char *b, size_t bsize )
+{
+    int diff = memcmp ( a, b, asize < bsize ? asize : bsize );
+    if ( diff == 0 && asize != bsize )
+        diff = asize < bsize ? -1 : 1;
+    return diff;
+}
+
+static
+int CC KTrieIdxBulkSort_v2 ( const void *a, const void *b, void *data )
+{
+    const uint8_t *arena = data;
+    const KTrieIdxBulkRec_v2 *ra = ( const void* ) ( arena + * ( const size_t* ) a );
+    const KTrieIdxBulkRec_v2 *rb = ( const void* ) ( arena + * ( const size_t* ) b );
+    return KTrieIdxBulkKeyCmp_v2 ( ( const char* ) ( ra + 1 ), ra -> size,
+        ( const char* ) ( rb + 1 ), rb -> size );
+}
+
+static
+rc_t KTrieIdxBulkWriteRec_v2 ( KFile *f, uint64_t *pos,
+    const KTrieIdxBulkRec_v2 *rec, const void *key )
+{
+    size_t num_writ;
+    rc_t rc = KFileWriteAll ( f, * pos, rec, sizeof * rec, & num_writ );
+    if ( rc == 0 && num_writ != sizeof * rec )
+        rc = RC ( rcDB, rcIndex, rcWriting, rcTransfer, rcIncomplete );
+    if ( rc == 0 && rec -> size != 0 )
+    {
+        rc = KFileWriteAll ( f, * pos + sizeof * rec, key, rec -> size, & num_writ );
+        if ( rc == 0 && num_writ != rec -> size )
+            rc = RC ( rcDB, rcIndex, rcWriting, rcTransfer, rcIncomplete );
+    }
+    if ( rc == 0 )
+        * pos += sizeof * rec + rec -> size;
+    return rc;
+}
+
+static
+rc_t KTrieIdxBulkReadRec_v2 ( KTrieIdxBulkReader_v2 *r )
+{
+    size_t num_read;
+    rc_t rc = KFileReadAll ( r -> f, r -> pos, & r -> rec, sizeof r -> rec, & num_read );
+    if ( rc == 0 )
+    {
+        if ( num_read == 0 )
+        {
+            r -> eof = true;
+            return 0;
+        }
+        if ( num_read != sizeof r -> rec )
+            return RC ( rcDB, rcIndex, rcReading, rcData, rcCorrupt );
+
+        rc = KTrieIdxBulkReserve_v2 ( & r -> key, & r -> kmax, r -> rec . size + 1 );
+        if ( rc == 0 && r -> rec . size != 0 )
+        {
+            rc = KFileReadAll ( r -> f, r -> pos + sizeof r -> rec,
+                r -> key, r -> rec . size, & num_read );
+            if ( rc == 0 && num_read != r -> rec . size )
+                rc = RC ( rcDB, rcIndex, rcReading, rcData, rcCorrupt );
+        }
+        if ( rc == 0 )
+            r -> pos += sizeof r -> rec + r -> rec . size;
+    }
+    return rc;
+}
+
+static
+rc_t KTrieIdxBulkCreateFile_v2 ( KTrieIdxBulk_v2 *self, KFile **fp,
+    bool update, const char *ext, uint32_t run )
+{
+    KFile *f;
+    rc_t rc = KDirectoryCreateFile ( self -> dir, & f, update,
+        0664, kcmInit, "%s.sort.%s%u", self -> path, ext, run );
+    if ( rc == 0 )
+    {
+        rc = KBufFileMakeWrite ( fp, f, update, KTRIEIDX_BULK_BUF_SIZE );
+        KFileRelease ( f );
+    }
+    return rc;
+}
+
+static
+rc_t KTrieIdxBulkOpenFile_v2 ( KTrieIdxBulk_v2 *self, const KFile **fp, const char *ext, uint32_t run )
+{
+    const KFile *f;
+    rc_t rc = KDirectoryOpenFileRead ( self -> dir, & f,
+        "%s.sort.%s%u", self -> path, ext, run );
+    if ( rc == 0 )
+    {
+        rc = KBufFileMakeRead ( fp, f, KTRIEIDX_BULK_BUF_SIZE );
+        KFileRelease ( f );
+    }
+    return rc;
+}
+
+/* HashCap
+ *  size of the table over "count" records of the current run,
+ *  which is kept at most half full
+ */
+static
+size_t KTrieIdxBulkHashCap_v2 ( size_t count )
+{
+    size_t cap = 64;
+    while ( cap < count * 2 )
+        cap <<= 1;
+    return cap;
+}
+
+/* HashFind
+ *  looks for a key among the records of the current run.
+ *  "slot" receives the slot of the record or the empty slot ending the probe.
+ */
+static
+bool KTrieIdxBulkHashFind_v2 ( const KTrieIdxBulk_v2 *self,
+    const char *key, size_t size, uint64_t hash, size_t *slot )
+{
+    size_t i, mask = self -> ht_max - 1;
+
+    for ( i = ( size_t ) hash & mask; self -> ht [ i ] != 0; i = ( i + 1 ) & mask )
+    {
+        const KTrieIdxBulkRec_v2 *rec = ( const void* ) ( self -> arena + self -> ht [ i ] - 1 );
+        if ( KTrieIdxBulkKeyCmp_v2 ( key, size, ( const char* ) ( rec + 1 ), rec -> size ) == 0 )
+        {
+            * slot = i;
+            return true;
+        }
+    }
+
+    * slot = i;
+    return false;
+}
+
+/* HashAdd
+ *  enters the record at arena offset "off" into the table,
+ *  growing it as records are added to the run
+ */
+static
+rc_t KTrieIdxBulkHashAdd_v2 ( KTrieIdxBulk_v2 *self, size_t off )
+{
+    size_t slot;
+    const KTrieIdxBulkRec_v2 *rec;
+    size_t cap = KTrieIdxBulkHashCap_v2 ( self -> ord_count );
+
+    if ( cap > self -> ht_max )
+    {
+        size_t i;
+        size_t *ht = calloc ( cap, sizeof * ht );
+        if ( ht == NULL )
+            return RC ( rcDB, rcIndex, rcInserting, rcMemory, rcExhausted );
+
+        free ( self -> ht );
+        self -> ht = ht;
+        self -> ht_max = cap;
+
+        /* the new record is the last in the run */
+        for ( i = 0; i + 1 < self -> ord_count; ++ i )
+        {
+            rec = ( const void* ) ( self -> arena + self -> ord [ i ] );
+            KTrieIdxBulkHashFind_v2 ( self, ( const char* ) ( rec + 1 ), rec -> size,
+                KHashIndexHash_v4 ( ( const char* ) ( rec + 1 ), rec -> size, 0 ), & slot );
+            self -> ht [ slot ] = self -> ord [ i ] + 1;
+        }
+    }
+
+    rec = ( const void* ) ( self -> arena + off );
+    KTrieIdxBulkHashFind_v2 ( self, ( const char* ) ( rec + 1 ), rec -> size,
+        KHashIndexHash_v4 ( ( const char* ) ( rec + 1 ), rec -> size, 0 ), & slot );
+    self -> ht [ slot ] = off + 1;
+
+    return 0;
+}
+
+/* BloomProbe
+ *  the bit examined by probe "i" of a key hash
+ */
+static
+uint64_t KTrieIdxBulkBloomProbe_v2 ( const KTrieIdxBulkRun_v2 *run, uint64_t hash, uint32_t i )
+{
+    uint64_t h1 = ( uint32_t ) hash;
+    uint64_t h2 = ( hash >> 32 ) | 1;
+    return ( h1 + i * h2 ) % run -> bloom_bits;
+}
+
+/* RunWhack
+ *  releases the lookup structures of a spilled run
+ */
+static
+void KTrieIdxBulkRunWhack_v2 ( KTrieIdxBulkRun_v2 *run )
+{
+    KFileRelease ( run -> f );
+    free ( run -> bloom );
+    free ( run -> spos );
+    free ( run -> soff );
+    free ( run -> skeys );
+    memset ( run, 0, sizeof * run );
+}
+
+/* RunFind
+ *  looks for a key in a spilled run
+ */
+static
+rc_t KTrieIdxBulkRunFind_v2 ( KTrieIdxBulk_v2 *self, const KTrieIdxBulkRun_v2 *run,
+    const char *key, size_t size, uint64_t hash, bool *found )
+{
+    rc_t rc;
+    uint32_t i;
+    size_t lower, upper, num_read, len, pos;
+    uint64_t start, end;
+
+    * found = false;
+
+    for ( i = 0; i < KTRIEIDX_BULK_BLOOM_PROBES; ++ i )
+    {
+        uint64_t bit = KTrieIdxBulkBloomProbe_v2 ( run, hash, i );
+        if ( ( run -> bloom [ bit >> 6 ] & ( ( uint64_t ) 1 << ( bit & 63 ) ) ) == 0 )
+            return 0;
+    }
+
+    /* find the last sample not above the key */
+    for ( lower = 0, upper = run -> num_samples; lower < upper; )
+    {
+        size_t mid = ( lower + upper ) >> 1;
+        int diff = KTrieIdxBulkKeyCmp_v2 ( key, size, run -> skeys + run -> soff [ mid ],
+            run -> soff [ mid + 1 ] - run -> soff [ mid ] );
+        if ( diff < 0 )
+            upper = mid;
+        else
+            lower = mid + 1;
+    }
+    if ( lower == 0 )
+        return 0;
+
+    start = run -> spos [ lower - 1 ];
+    end = lower < run -> num_samples ? run -> spos [ lower ] : run -> eof;
+    len = ( size_t ) ( end - start );
+
+    rc = KTrieIdxBulkReserve_v2 ( & self -> chunk, & self -> chunk_max, len );
+    if ( rc == 0 )
+        rc = KFileReadAll ( run -> f, start, self -> chunk, len, & num_read );
+    if ( rc == 0 && num_read != len )
+        rc = RC ( rcDB, rcIndex, rcReading, rcData, rcCorrupt );
+
+    for ( pos = 0; rc == 0 && pos + sizeof ( KTrieIdxBulkRec_v2 ) <= len; )
+    {
+        int diff;
+        KTrieIdxBulkRec_v2 rec;
+
+        memmove ( & rec, self -> chunk + pos, sizeof rec );
+        pos += sizeof rec;
+        if ( pos + rec . size > len )
+            return RC ( rcDB, rcIndex, rcReading, rcData, rcCorrupt );
+
+        diff = KTrieIdxBulkKeyCmp_v2 ( key, size, self -> chunk + pos, rec . size );
+        if ( diff <= 0 )
+        {
+            * found = diff == 0;
+            break;
+        }
+        pos += rec . size;
+    }
+
+    return rc;
+}
+
+/* Seen
+ *  tells whether a key was inserted before the current entry
+ */
+static
+rc_t KTrieIdxBulkSeen_v2 ( KTrieIdxBulk_v2 *self, const char *key, size_t size, bool *seen )
+{
+    rc_t rc = 0;
+    size_t slot;
+    uint32_t i;
+    uint64_t hash = KHashIndexHash_v4 ( key, size, 0 );
+
+    * seen = self -> ht_max != 0 &&
+        KTrieIdxBulkHashFind_v2 ( self, key, size, hash, & slot );
+
+    for ( i = 0; rc == 0 && ! * seen && i < self -> num_runs; ++ i )
+        rc = KTrieIdxBulkRunFind_v2 ( self, & self -> runs [ i ], key, size, hash, seen );
+
+    return rc;
+}
+
+/* Spill
+ *  sorts the current run and writes it out,
+ *  keeping what inserts need to search it
+ */
+static
+rc_t KTrieIdxBulkSpill_v2 ( KTrieIdxBulk_v2 *self )
+{
+    KFile *f;
+    rc_t rc;
+    size_t num_samples;
+    KTrieIdxBulkRun_v2 *run;
+
+    run = realloc ( self -> runs, ( self -> num_runs + 1 ) * sizeof * run );
+    if ( run == NULL )
+        return RC ( rcDB, rcIndex, rcInserting, rcMemory, rcExhausted );
+    self -> runs = run;
+    run += self -> num_runs;
+    memset ( run, 0, sizeof * run );
+
+    num_samples = ( self -> ord_count + KTRIEIDX_BULK_SAMPLE - 1 ) / KTRIEIDX_BULK_SAMPLE;
+    run -> bloom_bits = ( ( uint64_t ) self -> ord_count * KTRIEIDX_BULK_BLOOM_BITS + 63 ) & ~ ( uint64_t ) 63;
+    run -> bloom = calloc ( ( size_t ) ( run -> bloom_bits >> 6 ), sizeof run -> bloom [ 0 ] );
+    run -> spos = malloc ( num_samples * sizeof run -> spos [ 0 ] );
+    run -> soff = malloc ( ( num_samples + 1 ) * sizeof run -> soff [ 0 ] );
+    if ( run -> bloom == NULL || run -> spos == NULL || run -> soff == NULL )
+    {
+        KTrieIdxBulkRunWhack_v2 ( run );
+        return RC ( rcDB, rcIndex, rcInserting, rcMemory, rcExhausted );
+    }
+    run -> soff [ 0 ] = 0;
+
+    rc = KTrieIdxBulkCreateFile_v2 ( self, & f, false, "run.", self -> num_runs );
+    if ( rc == 0 )
+    {
+        size_t i;
+        uint32_t j;
+        uint64_t pos = 0;
+
+        ksort ( self -> ord, self -> ord_count, sizeof self -> ord [ 0 ],
+            KTrieIdxBulkSort_v2, self -> arena );
+
+        for ( i = 0; rc == 0 && i < self -> ord_count; ++ i )
+        {
+            const KTrieIdxBulkRec_v2 *rec = ( const void* ) ( self -> arena + self -> ord [ i ] );
+            uint64_t hash = KHashIndexHash_v4 ( ( const char* ) ( rec + 1 ), rec -> size, 0 );
+
+            for ( j = 0; j < KTRIEIDX_BULK_BLOOM_PROBES; ++ j )
+            {
+                uint64_t bit = KTrieIdxBulkBloomProbe_v2 ( run, hash, j );
+                run -> bloom [ bit >> 6 ] |= ( uint64_t ) 1 << ( bit & 63 );
+            }
+
+            if ( i % KTRIEIDX_BULK_SAMPLE == 0 )
+            {
+                size_t n = run -> num_samples;
+                rc = KTrieIdxBulkReserve_v2 ( & run -> skeys, & run -> skeys_max,
+                    run -> soff [ n ] + rec -> size );
+                if ( rc != 0 )
+                    break;
+                memmove ( run -> skeys + run -> soff [ n ], rec + 1, rec -> size );
+                run -> spos [ n ] = pos;
+                run -> soff [ n + 1 ] = run -> soff [ n ] + rec -> size;
+                run -> num_samples = n + 1;
+            }
+
+            rc = KTrieIdxBulkWriteRec_v2 ( f, & pos, rec, rec + 1 );
+        }
+
+        /* releasing the buffer flushes it */
+        if ( rc == 0 )
+            rc = KFileRelease ( f );
+        else
+            KFileRelease ( f );
+
+        /* the run is read back in small pieces, unbuffered */
+        if ( rc == 0 )
+        {
+            rc = KDirectoryOpenFileRead ( self -> dir, & run -> f,
+                "%s.sort.run.%u", self -> path, self -> num_runs );
+        }
+        run -> eof = pos;
+
+        ++ self -> num_runs;
+        self -> arena_size = 0;
+        self -> ord_count = 0;
+        if ( self -> ht != NULL )
+            memset ( self -> ht, 0, self -> ht_max * sizeof self -> ht [ 0 ] );
+    }
+    else
+    {
+        KTrieIdxBulkRunWhack_v2 ( run );
+    }
+
+    return rc;
+}
+
+/* AddSlot
+ *  records the next entry in id order
+ */
+static
+rc_t KTrieIdxBulkAddSlot_v2 ( KTrieIdxBulk_v2 *self,
+    const KTrieIdxBulkRec_v2 *rec, const char *key )
+{
+    if ( self -> count == UINT32_MAX )
+        return RC ( rcDB, rcIndex, rcInserting, rcRange, rcExcessive );
+
+    if ( self -> proj )
+    {
+        /* max span in projection mode is the
+           largest distance between start ids */
+        if ( self -> count == 0 )
+            self -> max_span = 1;
+        else
+        {
+            uint32_t span = ( uint32_t ) ( rec -> start_id - self -> prev_start );
+            if ( span > self -> max_span )
+                self -> max_span = span;
+        }
+        self -> prev_start = rec -> start_id;
+
+        if ( self -> ids == NULL )
+        {
+            /* projected while loading, so read back through the buffer */
+            rc_t rc = KTrieIdxBulkCreateFile_v2 ( self, & self -> ids, true, "ids", 0 );
+            if ( rc != 0 )
+                return rc;
+        }
+
+        if ( self -> count % KTRIEIDX_BULK_SAMPLE == 0 )
+        {
+            size_t n = self -> count / KTRIEIDX_BULK_SAMPLE;
+            if ( n == self -> ids_smax )
+            {
+                size_t new_max = self -> ids_smax == 0 ? 1024 : self -> ids_smax << 1;
+                uint64_t *spos = realloc ( self -> ids_spos, new_max * sizeof * spos );
+                int64_t *sid;
+                if ( spos == NULL )
+                    return RC ( rcDB, rcIndex, rcInserting, rcMemory, rcExhausted );
+                self -> ids_spos = spos;
+                sid = realloc ( self -> ids_sid, new_max * sizeof * sid );
+                if ( sid == NULL )
+                    return RC ( rcDB, rcIndex, rcInserting, rcMemory, rcExhausted );
+                self -> ids_sid = sid;
+                self -> ids_smax = new_max;
+            }
+            self -> ids_spos [ n ] = self -> ids_pos;
+            self -> ids_sid [ n ] = rec -> start_id;
+        }
+
+        {
+            rc_t rc = KTrieIdxBulkWriteRec_v2 ( self -> ids, & self -> ids_pos, rec, key );
+            if ( rc != 0 )
+                return rc;
+        }
+    }
+
+    ++ self -> count;
+    return 0;
+}
+
+/* Flush
+ *  moves the current entry into the run
+ */
+static
+rc_t KTrieIdxBulkFlush_v2 ( KTrieIdxBulk_v2 *self )
+{
+    rc_t rc;
+    size_t rsize;
+    KTrieIdxBulkRec_v2 *rec;
+
+    rc = KTrieIdxBulkAddSlot_v2 ( self, & self -> cur, self -> cur_key );
+    if ( rc != 0 )
+        return rc;
+
+    /* records are kept 8-byte aligned */
+    rsize = ( sizeof * rec + self -> cur . size + 7 ) & ~ ( size_t ) 7;
+
+    /* spill when over budget */
+    if ( self -> ord_count != 0 && self -> arena_size + rsize +
+         ( self -> ord_count + 1 ) * sizeof self -> ord [ 0 ] +
+         KTrieIdxBulkHashCap_v2 ( self -> ord_count + 1 ) * sizeof self -> ht [ 0 ] > self -> mem_limit )
+    {
+        rc = KTrieIdxBulkSpill_v2 ( self );
+        if ( rc != 0 )
+            return rc;
+    }
+
+    if ( self -> arena_size + rsize > self -> arena_max )
+    {
+        size_t new_max = self -> arena_max == 0 ? 64 * 1024 : self -> arena_max << 1;
+        while ( self -> arena_size + rsize > new_max )
+            new_max <<= 1;
+        rc = KTrieIdxBulkReserve_v2 ( ( char** ) & self -> arena, & self -> arena_max, new_max );
+        if ( rc != 0 )
+            return rc;
+    }
+
+    if ( self -> ord_count == self -> ord_max )
+    {
+        size_t new_max = self -> ord_max == 0 ? 4096 : self -> ord_max << 1;
+        size_t *ord = realloc ( self -> ord, new_max * sizeof * ord );
+        if ( ord == NULL )
+            return RC ( rcDB, rcIndex, rcInserting, rcMemory, rcExhausted );
+        self -> ord = ord;
+        self -> ord_max = new_max;
+    }
+
+    rec = ( void* ) ( self -> arena + self -> arena_size );
+    * rec = self -> cur;
+    memmove ( rec + 1, self -> cur_key, self -> cur . size );
+
+    self -> ord [ self -> ord_count ++ ] = self -> arena_size;
+    rc = KTrieIdxBulkHashAdd_v2 ( self, self -> arena_size );
+    if ( rc != 0 )
+    {
+        -- self -> ord_count;
+        return rc;
+    }
+    self -> arena_size += rsize;
+
+    /* nothing is current */
+    self -> cur . span = 0;
+
+    return 0;
+}
+
+/* Make
+ *  "path" [ IN ] - path of the index relative to "dir".
+ *  temporary files are created next to it.
+ *
+ *  "mem_limit" [ IN ] - memory to use for sorting, 0 for default.
+ */
+rc_t KTrieIdxBulkMake_v2 ( KTrieIdxBulk_v2 **bulkp,
+    KDirectory *dir, const char *path, bool proj, size_t mem_limit )
+{
+    rc_t rc;
+    KTrieIdxBulk_v2 *bulk;
+
+#if DISABLE_PROJ
+    proj = false;
+#endif
+
+    bulk = calloc ( 1, sizeof * bulk + strlen ( path ) );
+    if ( bulk == NULL )
+        return RC ( rcDB, rcIndex, rcConstructing, rcMemory, rcExhausted );
+
+    rc = KDirectoryAddRef ( dir );
+    if ( rc == 0 )
+    {
+        bulk -> dir = dir;
+        bulk -> mem_limit = mem_limit != 0 ? mem_limit : KTRIEIDX_BULK_MEM_LIMIT;
+        bulk -> proj = proj;
+        strcpy ( bulk -> path, path );
+
+        * bulkp = bulk;
+        return 0;
+    }
+
+    free ( bulk );
+    return rc;
+}
+
+/* Whack
+ *  releases all resources and removes temporary files
+ */
+void KTrieIdxBulkWhack_v2 ( KTrieIdxBulk_v2 *self )
+{
+    if ( self != NULL )
+    {
+        uint32_t i;
+
+        KFileRelease ( self -> ids );
+        KFileRelease ( self -> keys );
+        PTrieBuilderWhack ( self -> builder );
+
+        for ( i = 0; i < self -> num_runs; ++ i )
+        {
+            KTrieIdxBulkRunWhack_v2 ( & self -> runs [ i ] );
+            KDirectoryRemove ( self -> dir, false, "%s.sort.run.%u", self -> path, i );
+        }
+        KDirectoryRemove ( self -> dir, false, "%s.sort.keys0", self -> path );
+        KDirectoryRemove ( self -> dir, false, "%s.sort.ids0", self -> path );
+
+        KDirectoryRelease ( self -> dir );
+        free ( self -> arena );
+        free ( self -> ord );
+        free ( self -> ht );
+        free ( self -> ids_spos );
+        free ( self -> ids_sid );
+        free ( self -> runs );
+        free ( self -> chunk );
+        free ( self -> cur_key );
+        free ( self );
+    }
+}
+
+/* Insert
+ *  follows KTrieIndexInsert_v2, including the refusal
+ *  of a key repeated after other keys
+ */
+rc_t KTrieIdxBulkInsert_v2 ( KTrieIdxBulk_v2 *self, const char *key, int64_t id )
+{
+    rc_t rc;
+    size_t size = strlen ( key );
+
+    if ( size > UINT32_MAX )
+        return RC ( rcDB, rcIndex, rcInserting, rcString, rcExcessive );
+
+    if ( self -> builder != NULL )
+        return RC ( rcDB, rcIndex, rcInserting, rcIndex, rcReadonly );
+
+    if ( self -> count != 0 || self -> cur . span != 0 )
+    {
+        /* v2 only allows increasing ids */
+        if ( id <= self -> last )
+            return RC ( rcDB, rcIndex, rcInserting, rcConstraint, rcViolated );
+
+        if ( self -> cur . span != 0 )
+        {
+            /* extend the current entry */
+            if ( KTrieIdxBulkKeyCmp_v2 ( key, size, self -> cur_key, self -> cur . size ) == 0 )
+            {
+                if ( id != self -> last + 1 )
+                {
+                    if ( self -> proj )
+                        return RC ( rcDB, rcIndex, rcInserting, rcConstraint, rcViolated );
+                    return RC ( rcDB, rcIndex, rcInserting, rcString, rcExists );
+                }
+
+                self -> last = id;
+                ++ self -> cur . span;
+                if ( ! self -> proj && self -> cur . span > self -> max_span )
+                    self -> max_span = self -> cur . span;
+                return 0;
+            }
+        }
+
+        /* a key may only be inserted again to extend its range */
+        {
+            bool seen;
+            rc = KTrieIdxBulkSeen_v2 ( self, key, size, & seen );
+            if ( rc != 0 )
+                return rc;
+            if ( seen )
+                return RC ( rcDB, rcIndex, rcInserting, rcString, rcExists );
+        }
+
+        if ( self -> cur . span != 0 )
+        {
+            rc = KTrieIdxBulkFlush_v2 ( self );
+            if ( rc != 0 )
+                return rc;
+        }
+
+        /* create a hole in id space */
+        if ( self -> proj && id != self -> last + 1 )
+        {
+            KTrieIdxBulkRec_v2 hole;
+            hole . size = 0;
+            hole . span = 0;
+            hole . start_id = self -> last + 1;
+            rc = KTrieIdxBulkAddSlot_v2 ( self, & hole, NULL );
+            if ( rc != 0 )
+                return rc;
+        }
+    }
+    else
+    {
+        self -> first = id;
+        self -> max_span = 1;
+    }
+
+    rc = KTrieIdxBulkReserve_v2 ( & self -> cur_key, & self -> cur_kmax, size + 1 );
+    if ( rc != 0 )
+        return rc;
+
+    memmove ( self -> cur_key, key, size );
+    self -> cur . size = ( uint32_t ) size;
+    self -> cur . span = 1;
+    self -> cur . start_id = id;
+    self -> last = id;
+
+    return 0;
+}
+
+/* Project
+ *  follows KTrieIndexProject_v2 for the entries inserted so far.
+ *  a write cursor may project rows it has just inserted.
+ */
+rc_t KTrieIdxBulkProject_v2 ( KTrieIdxBulk_v2 *self, int64_t id,
+    int64_t *start_id, uint32_t *span, char *key_buff, size_t buff_size, size_t *actsize )
+{
+    rc_t rc;
+    size_t lower, upper, key_size = 0;
+    int64_t end;
+    KTrieIdxBulkReader_v2 r;
+
+    if ( ! self -> proj || self -> builder != NULL || self -> cur . span == 0 ||
+         id < self -> first || id > self -> last )
+    {
+        return RC ( rcDB, rcIndex, rcProjecting, rcId, rcNotFound );
+    }
+
+    /* the current entry is not yet written */
+    if ( id >= self -> cur . start_id )
+    {
+        if ( actsize != NULL )
+            * actsize = self -> cur . size;
+        if ( self -> cur . size >= buff_size )
+            return RC ( rcDB, rcIndex, rcProjecting, rcBuffer, rcInsufficient );
+        string_copy ( key_buff, buff_size, self -> cur_key, self -> cur . size );
+        * start_id = self -> cur . start_id;
+        * span = ( uint32_t ) ( self -> last + 1 - self -> cur . start_id );
+        return 0;
+    }
+
+    /* find the last sampled slot not above id */
+    for ( lower = 0, upper = ( self -> count + KTRIEIDX_BULK_SAMPLE - 1 ) / KTRIEIDX_BULK_SAMPLE; lower < upper; )
+    {
+        size_t mid = ( lower + upper ) >> 1;
+        if ( id < self -> ids_sid [ mid ] )
+            upper = mid;
+        else
+            lower = mid + 1;
+    }
+    assert ( lower != 0 );
+
+    memset ( & r, 0, sizeof r );
+    r . f = self -> ids;
+    r . pos = self -> ids_spos [ lower - 1 ];
+    r . key = self -> chunk;
+    r . kmax = self -> chunk_max;
+
+    /* the slot extends to the start of the next one.
+       the buffer reads zeros past what was written */
+    for ( rc = 0, end = self -> cur . start_id; r . pos < self -> ids_pos; )
+    {
+        rc = KTrieIdxBulkReadRec_v2 ( & r );
+        if ( rc != 0 || r . eof )
+            break;
+        if ( r . rec . start_id > id )
+        {
+            end = r . rec . start_id;
+            break;
+        }
+
+        * start_id = r . rec . start_id;
+        if ( actsize != NULL )
+            * actsize = r . rec . size;
+        if ( r . rec . size < buff_size )
+            string_copy ( key_buff, buff_size, r . key, r . rec . size );
+        else if ( buff_size != 0 )
+            key_buff [ 0 ] = 0;
+        key_size = r . rec . size;
+    }
+
+    /* the key buffer may have moved */
+    self -> chunk = r . key;
+    self -> chunk_max = r . kmax;
+
+    if ( rc == 0 )
+    {
+        if ( key_size >= buff_size )
+            return RC ( rcDB, rcIndex, rcProjecting, rcBuffer, rcInsufficient );
+        * span = ( uint32_t ) ( end - * start_id );
+    }
+
+    return rc;
+}
+
+/* Merge
+ *  merges the runs into a single file and builds the Trie skeleton
+ */
+static
+rc_t KTrieIdxBulkMerge_v2 ( KTrieIdxBulk_v2 *self )
+{
+    rc_t rc;
+    KFile *keys;
+    uint32_t i;
+    KTrieIdxBulkReader_v2 *runs;
+
+    runs = calloc ( self -> num_runs, sizeof * runs );
+    if ( runs == NULL )
+        return RC ( rcDB, rcIndex, rcPersisting, rcMemory, rcExhausted );
+
+    /* no more inserts */
+    for ( i = 0; i < self -> num_runs; ++ i )
+        KTrieIdxBulkRunWhack_v2 ( & self -> runs [ i ] );
+
+    for ( rc = 0, i = 0; rc == 0 && i < self -> num_runs; ++ i )
+    {
+        rc = KTrieIdxBulkOpenFile_v2 ( self, & runs [ i ] . f, "run.", i );
+        if ( rc == 0 )
+            rc = KTrieIdxBulkReadRec_v2 ( & runs [ i ] );
+    }
+
+    if ( rc == 0 )
+    {
+        /* the Trie index is always created with this character set */
+        rc = PTrieBuilderMake ( & self -> builder, "0-9", 512 );
+        if ( rc == 0 )
+            rc = KTrieIdxBulkCreateFile_v2 ( self, & keys, false, "keys", 0 );
+        if ( rc == 0 )
+        {
+            uint64_t pos = 0;
+            while ( rc == 0 )
+            {
+                String key;
+                KTrieIdxBulkReader_v2 *r = NULL;
+
+                /* the number of runs is small */
+                for ( i = 0; i < self -> num_runs; ++ i )
+                {
+                    if ( ! runs [ i ] . eof && ( r == NULL ||
+                         KTrieIdxBulkKeyCmp_v2 ( runs [ i ] . key, runs [ i ] . rec . size,
+                             r -> key, r -> rec . size ) < 0 ) )
+                    {
+                        r = & runs [ i ];
+                    }
+                }
+                if ( r == NULL )
+                    break;
+
+                /* the builder still rejects a repeated key */
+                StringInit ( & key, r -> key, r -> rec . size,
+                    string_len ( r -> key, r -> rec . size ) );
+                rc = PTrieBuilderAppend ( self -> builder, & key, pos );
+                if ( rc != 0 )
+                {
+                    if ( GetRCState ( rc ) == rcExists )
+                        rc = RC ( rcDB, rcIndex, rcPersisting, rcString, rcExists );
+                    break;
+                }
+
+                rc = KTrieIdxBulkWriteRec_v2 ( keys, & pos, & r -> rec, r -> key );
+                if ( rc == 0 )
+                    rc = KTrieIdxBulkReadRec_v2 ( r );
+            }
+
+            if ( rc == 0 )
+                rc = KFileRelease ( keys );
+            else
+                KFileRelease ( keys );
+
+            if ( rc == 0 )
+                rc = KTrieIdxBulkOpenFile_v2 ( self, & self -> keys, "keys", 0 );
+        }
+    }
+
+    for ( i = 0; i < self -> num_runs; ++ i )
+    {
+        KFileRelease ( runs [ i ] . f );
+        free ( runs [ i ] . key );
+        KDirectoryRemove ( self -> dir, false, "%s.sort.run.%u", self -> path, i );
+    }
+    free ( runs );
+    self -> num_runs = 0;
+
+    return rc;
+}
+
+/* Load
+ *  PTLoadFunc reading container keys back from the merged file
+ */
+static
+rc_t CC KTrieIdxBulkLoad_v2 ( void *param, uint64_t pos, TNode **nodes, uint32_t count )
+{
+    rc_t rc = 0;
+    uint32_t i;
+    KTrieIdxBulk_v2 *self = param;
+    KTrieIdxBulkReader_v2 r;
+
+    memset ( & r, 0, sizeof r );
+    r . f = self -> keys;
+    r . pos = pos;
+    r . key = self -> cur_key;
+    r . kmax = self -> cur_kmax;
+
+    for ( i = 0; i < count; ++ i )
+    {
+        String key;
+
+        rc = KTrieIdxBulkReadRec_v2 ( & r );
+        if ( rc == 0 && r . eof )
+            rc = RC ( rcDB, rcIndex, rcPersisting, rcData, rcInsufficient );
+        if ( rc != 0 )
+            break;
+
+        StringInit ( & key, r . key, r . rec . size, string_len ( r . key, r . rec . size ) );
+        if ( self -> proj )
+        {
+            KTrieIdxNode_v2_s1 *node;
+            rc = KTrieIdxNodeMake_v2_s1 ( & node, & key, r . rec . start_id );
+            if ( rc == 0 )
+                nodes [ i ] = & node -> n;
+        }
+        else
+        {
+            KTrieIdxNode_v2_s2 *node;
+            rc = KTrieIdxNodeMake_v2_s2 ( & node, & key, r . rec . start_id );
+            if ( rc == 0 )
+            {
+                node -> span = r . rec . span;
+                nodes [ i ] = & node -> n;
+            }
+        }
+        if ( rc != 0 )
+            break;
+    }
+
+    /* the key buffer may have moved */
+    self -> cur_key = r . key;
+    self -> cur_kmax = r . kmax;
+
+    if ( rc != 0 )
+    {
+        while ( i > 0 )
+            KTrieIdxNodeWhack_v2 ( nodes [ -- i ], NULL );
+    }
+
+    return rc;
+}
+
+static
+rc_t KTrieIdxBulkProjNid_v2 ( const PTrie *tt, const KTrieIdxBulkReader_v2 *r, uint32_t *nid )
+{
+    /* check for a hole in id space */
+    if ( r -> rec . size == 0 )
+        * nid = 0;
+    else
+    {
+        String key;
+        PTNode pn;
+        StringInit ( & key, r -> key, r -> rec . size, string_len ( r -> key, r -> rec . size ) );
+        * nid = PTrieFind ( tt, & key, & pn, NULL, NULL );
+        if ( * nid == 0 )
+            return RC ( rcDB, rcIndex, rcPersisting, rcTransfer, rcIncomplete );
+    }
+    return 0;
+}
+
+/* PersistProj
+ *  writes the projection index from the entries in id order,
+ *  in the layout produced by KTrieIndexPersistProj_v3
+ */
+static
+rc_t KTrieIdxBulkPersistProj_v2 ( KTrieIdxBulk_v2 *self, PersistTrieData *pb, const PTrie *tt )
+{
+    rc_t rc;
+    size_t num_writ;
+    uint32_t nid, count = self -> count;
+    uint64_t num_ids = self -> last - self -> first + 1;
+    KTrieIdxBulkReader_v2 r;
+
+    memset ( & r, 0, sizeof r );
+    r . key = self -> cur_key;
+    r . kmax = self -> cur_kmax;
+
+    rc = KTrieIdxBulkOpenFile_v2 ( self, & r . f, "ids", 0 );
+    if ( rc == 0 )
+        rc = KTrieIndexWrite_v2 ( pb, & count, sizeof count, & num_writ );
+
+    /* same strategy selection as KTrieIndexPersistProj_v3 */
+    if ( rc == 0 && num_ids <= ( ( uint64_t ) count << 1 ) )
+    {
+        /* 1-1 projection, back filling repeats */
+        int64_t id = self -> first;
+        for ( nid = 0; rc == 0; ++ id )
+        {
+            rc = KTrieIdxBulkReadRec_v2 ( & r );
+            if ( rc != 0 || r . eof )
+                break;
+
+            for ( ; rc == 0 && id < r . rec . start_id; ++ id )
+                rc = KTrieIndexWrite_v2 ( pb, & nid, sizeof nid, & num_writ );
+            if ( rc == 0 )
+                rc = KTrieIdxBulkProjNid_v2 ( tt, & r, & nid );
+            if ( rc == 0 )
+                rc = KTrieIndexWrite_v2 ( pb, & nid, sizeof nid, & num_writ );
+        }
+
+        /* finish off trailing span */
+        for ( ; rc == 0 && id <= self -> last; ++ id )
+            rc = KTrieIndexWrite_v2 ( pb, & nid, sizeof nid, & num_writ );
+    }
+    else if ( rc == 0 )
+    {
+        /* node ids */
+        while ( rc == 0 )
+        {
+            rc = KTrieIdxBulkReadRec_v2 ( & r );
+            if ( rc != 0 || r . eof )
+                break;
+
+            rc = KTrieIdxBulkProjNid_v2 ( tt, & r, & nid );
+            if ( rc == 0 )
+                rc = KTrieIndexWrite_v2 ( pb, & nid, sizeof nid, & num_writ );
+        }
+
+        /* 1st derivative of start ids packed to span-bits.
+           a full chunk packs to a whole number of bytes,
+           so chunks concatenate into the same bit stream */
+        if ( rc == 0 )
+        {
+            int64_t prev = self -> first;
+            int64_t *deriv = malloc ( 8192 * sizeof * deriv );
+            if ( deriv == NULL )
+                rc = RC ( rcDB, rcIndex, rcPersisting, rcMemory, rcExhausted );
+            else
+            {
+                uint32_t i, n;
+
+                r . pos = 0;
+                r . eof = false;
+
+                /* skip first entry */
+                rc = KTrieIdxBulkReadRec_v2 ( & r );
+                for ( i = 1, n = 0; rc == 0 && i <= count; ++ i )
+                {
+                    if ( i < count )
+                    {
+                        rc = KTrieIdxBulkReadRec_v2 ( & r );
+                        if ( rc == 0 && r . eof )
+                            rc = RC ( rcDB, rcIndex, rcPersisting, rcData, rcInsufficient );
+                        if ( rc != 0 )
+                            break;
+
+                        deriv [ n ++ ] = r . rec . start_id - prev;
+                        prev = r . rec . start_id;
+                    }
+
+                    if ( n != 0 && ( n == 8192 || i == count ) )
+                    {
+                        bitsz_t psize;
+                        rc = Pack ( 64, pb -> span_bits, deriv, ( size_t ) n << 3,
+                            NULL, deriv, 0, ( bitsz_t ) n << 6, & psize );
+                        if ( rc == 0 )
+                        {
+                            rc = KTrieIndexWrite_v2 ( pb, deriv,
+                                ( size_t ) ( ( psize + 7 ) >> 3 ), & num_writ );
+                        }
+                        n = 0;
+                    }
+                }
+
+                free ( deriv );
+            }
+        }
+    }
+
+    KFileRelease ( r . f );
+
+    /* the key buffer may have moved */
+    self -> cur_key = r . key;
+    self -> cur_kmax = r . kmax;
+
+    return rc;
+}
+
+static
+rc_t KTrieIdxBulkPersistContents_v2 ( void *obj, PersistTrieData *pb )
+{
+    rc_t rc;
+    size_t num_writ;
+    KTrieIdxBulk_v2 *self = obj;
+    uint32_t max_span = self -> max_span;
+
+    /* include the span of the last entry */
+    if ( self -> proj )
+    {
+        uint32_t span = ( uint32_t ) ( self -> last - self -> prev_start );
+        if ( span > max_span )
+            max_span = span;
+    }
+
+#if KDBINDEXVERS == 2
+    KTrieIndexPersistHdr_v2 ( pb, self -> first, self -> last, max_span );
+#else
+    KTrieIndexPersistHdr_v3_v4 ( pb, self -> first, self -> last, max_span );
+#endif
+
+    /* persist tree */
+    if ( self -> proj )
+    {
+        pb -> node_data_size = ( pb -> id_bits + 7 ) >> 3;
+        rc = PTrieBuilderPersist ( self -> builder, & pb -> ptt_size, false,
+            KTrieIndexWrite_v2, pb, KTrieIndexAux_v2_s1, pb, KTrieIdxBulkLoad_v2, self );
+    }
+    else
+    {
+        pb -> node_data_size = ( pb -> id_bits + pb -> span_bits + 7 ) >> 3;
+        rc = PTrieBuilderPersist ( self -> builder, & pb -> ptt_size, false,
+            KTrieIndexWrite_v2, pb, KTrieIndexAux_v2_s2, pb, KTrieIdxBulkLoad_v2, self );
+    }
+
+    if ( rc == 0 && pb -> marker != 0 )
+    {
+        rc = KFileWrite ( pb -> f, pb -> pos,
+            pb -> buffer, pb -> marker, & num_writ );
+        if ( rc == 0 && num_writ != pb -> marker )
+            rc = RC ( rcDB, rcIndex, rcPersisting, rcTransfer, rcIncomplete );
+        pb -> pos += num_writ;
+        pb -> marker = 0;
+    }
+
+    /* persist projection table */
+    if ( rc == 0 && self -> proj )
+    {
+        /* inflate the image just written */
+        size_t hdr_size, num_read;
+        void *addr = malloc ( pb -> ptt_size );
+        if ( addr == NULL )
+            return RC ( rcDB, rcIndex, rcPersisting, rcMemory, rcExhausted );
+
+#if KDBINDEXVERS == 2
+        hdr_size = sizeof ( KPTrieIndexHdr_v2 );
+#else
+        hdr_size = sizeof ( KPTrieIndexHdr_v3 );
+#endif
+        rc = KFileReadAll ( pb -> f, hdr_size, addr, pb -> ptt_size, & num_read );
+        if ( rc == 0 && num_read != pb -> ptt_size )
+            rc = RC ( rcDB, rcIndex, rcPersisting, rcHeader, rcInsufficient );
+        if ( rc == 0 )
+        {
+            PTrie *tt;
+#if KDBINDEXVERS > 3
+            rc = PTrieMake ( & tt, addr, pb -> ptt_size, false );
+#elif KDBINDEXVERS == 3
+            rc = PTrieMakeOrig ( & tt, addr, pb -> ptt_size, false );
+#else
+            rc = PTrieMakeOrig ( & tt, addr, pb -> ptt_size );
+#endif
+            if ( rc == 0 )
+            {
+                rc = KTrieIdxBulkPersistProj_v2 ( self, pb, tt );
+                PTrieWhack ( tt );
+            }
+        }
+        free ( addr );
+
+        if ( rc == 0 && pb -> marker != 0 )
+        {
+            rc = KFileWrite ( pb -> f, pb -> pos,
+                pb -> buffer, pb -> marker, & num_writ );
+            if ( rc == 0 && num_writ != pb -> marker )
+                rc = RC ( rcDB, rcIndex, rcPersisting, rcTransfer, rcIncomplete );
+        }
+    }
+
+    return rc;
+}
+
+/* Persist
+ *  writes the index to the path given to Make
+ */
+rc_t KTrieIdxBulkPersist_v2 ( KTrieIdxBulk_v2 *self, bool use_md5 )
+{
+    rc_t rc = 0;
+
+    if ( self -> builder != NULL )
+        return RC ( rcDB, rcIndex, rcPersisting, rcIndex, rcReadonly );
+
+    if ( self -> cur . span != 0 )
+        rc = KTrieIdxBulkFlush_v2 ( self );
+    if ( rc == 0 && self -> ord_count != 0 )
+        rc = KTrieIdxBulkSpill_v2 ( self );
+    if ( rc != 0 || self -> count == 0 )
+        return rc;
+
+    /* done with sorting memory */
+    free ( self -> arena );
+    free ( self -> ord );
+    free ( self -> ht );
+    self -> arena = NULL;
+    self -> ord = NULL;
+    self -> ht = NULL;
+    self -> arena_max = self -> ord_max = self -> ht_max = 0;
+
+    /* releasing the buffer flushes it */
+    if ( self -> ids != NULL )
+    {
+        rc = KFileRelease ( self -> ids );
+        self -> ids = NULL;
+    }
+
+    if ( rc == 0 )
+        rc = KTrieIdxBulkMerge_v2 ( self );
+    if ( rc == 0 )
+    {
+        rc = KTrieIndexPersistFile_v2 ( self -> dir, self -> path, use_md5,
+            KTrieIdxBulkPersistContents_v2, self );
+    }
+
+    return rc;
+}
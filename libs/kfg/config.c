@@ -48,6 +48,8 @@ struct KfgConfigNamelist;
 #include <kfs/file.h>
 #include <kfs/dyload.h>
 #include <kfs/mmap.h>
+#include <klib/checksum.h>
+#include <klib/time.h>
 #include <os-native.h>
 #include <vfs/path.h>
 #include <strtol.h>
@@ -62,6 +64,7 @@ struct KfgConfigNamelist;
 
 #if !WINDOWS
     #include <sys/utsname.h>
+    #include <unistd.h>
 #endif
 
 #include "kfg-parse.h"
@@ -75,6 +78,10 @@ struct KfgConfigNamelist;
    must reside in the user's $HOME/.ncbi directory */
 #define MAGIC_LEAF_NAME "user-settings.mkfg"
 
+/* names a file for the binary snapshot of the loaded configuration.
+   snapshots are neither read nor written unless it is set */
+#define SNAPSHOT_ENV_NAME "VDB_CONFIG_SNAPSHOT"
+
 static bool s_disable_user_settings = false;
 
 
@@ -295,6 +302,10 @@ struct KConfig
     const char *magic_file_path;
     size_t magic_file_path_size;
 
+    /* paths consulted while loading files,
+       NULL unless a snapshot is being recorded */
+    struct KConfigSnapBuf *deps;
+
     bool dirty;
     bool initialized;
 };
@@ -1244,11 +1255,20 @@ rc_t write_nvp(void* pself, const char* name, size_t nameLen, VNamelist* values)
     return rc;
 }
 
+static bool KConfigSnapVolatileName ( const char *name, size_t size );
+static void KConfigSnapDisable ( KConfig *self );
+
 static
 bool look_up_var(void * self, struct KFGParseBlock* pb)
 {
     const KConfigNode* node;
-    rc_t rc = KConfigOpenNodeRead((KConfig*)self, &node, "%.*s", pb->tokenLength-3, pb->tokenText+2);
+    rc_t rc;
+
+    /* values built from per-process nodes cannot be reused by a snapshot */
+    if ( KConfigSnapVolatileName ( pb->tokenText+2, pb->tokenLength-3 ) )
+        KConfigSnapDisable ( ( KConfig* ) self );
+
+    rc = KConfigOpenNodeRead((KConfig*)self, &node, "%.*s", pb->tokenLength-3, pb->tokenText+2);
     if (rc == 0)
     {
         pb->tokenText   = node->value.addr; 
@@ -1898,6 +1918,142 @@ rc_t make_include_path ( KConfigIncluded **p, const KDirectory *dir, const char
 }
 
 
+/*--------------------------------------------------------------------------
+ * KConfigSnapBuf
+ *  growable buffer for building and recording a snapshot
+ */
+typedef struct KConfigSnapBuf KConfigSnapBuf;
+struct KConfigSnapBuf
+{
+    char *base;
+    size_t size;
+    size_t cap;
+    uint32_t count;
+    bool failed;
+};
+
+static
+void KConfigSnapBufPut ( KConfigSnapBuf *self, const void *data, size_t size )
+{
+    if ( self -> failed )
+        return;
+
+    if ( self -> size + size > self -> cap )
+    {
+        char *base;
+        size_t cap = ( self -> cap == 0 ) ? 4096 : self -> cap;
+        while ( cap < self -> size + size )
+            cap += cap;
+
+        base = realloc ( self -> base, cap );
+        if ( base == NULL )
+        {
+            self -> failed = true;
+            return;
+        }
+        self -> base = base;
+        self -> cap = cap;
+    }
+
+    memmove ( & self -> base [ self -> size ], data, size );
+    self -> size += size;
+}
+
+static
+void KConfigSnapBufPutU32 ( KConfigSnapBuf *self, uint32_t val )
+{
+    KConfigSnapBufPut ( self, & val, sizeof val );
+}
+
+static
+void KConfigSnapBufPutU64 ( KConfigSnapBuf *self, uint64_t val )
+{
+    KConfigSnapBufPut ( self, & val, sizeof val );
+}
+
+static
+void KConfigSnapBufPutStr ( KConfigSnapBuf *self, const char *str, size_t size )
+{
+    KConfigSnapBufPutU32 ( self, ( uint32_t ) size );
+    KConfigSnapBufPut ( self, str, size );
+}
+
+static
+void KConfigSnapBufWhack ( KConfigSnapBuf *self )
+{
+    free ( self -> base );
+    memset ( self, 0, sizeof * self );
+}
+
+/* Stat
+ *  what a snapshot remembers about a path
+ */
+static
+void KConfigSnapStat ( const KDirectory *dir, const char *path,
+    uint32_t *type, uint64_t *date, uint64_t *size )
+{
+    KTime_t mtime = 0;
+    uint64_t fsize = 0;
+
+    * type = KDirectoryPathType ( dir, "%s", path );
+    switch ( * type & ~ kptAlias )
+    {
+    case kptFile:
+        KDirectoryFileSize ( dir, & fsize, "%s", path );
+        /* no break */
+    case kptDir:
+        KDirectoryDate ( dir, & mtime, "%s", path );
+        break;
+    }
+
+    * date = ( uint64_t ) mtime;
+    * size = fsize;
+}
+
+/* Disable
+ *  the configuration being loaded cannot be recorded
+ */
+static
+void KConfigSnapDisable ( KConfig *self )
+{
+    if ( self -> deps != NULL )
+        self -> deps -> failed = true;
+}
+
+/* Note
+ *  record a path consulted while loading
+ *  a snapshot stays valid while none of them change
+ */
+static
+void KConfigSnapNote ( KConfig *self, const KDirectory *dir, const char *path, size_t sz )
+{
+    KConfigSnapBuf *deps = self -> deps;
+    if ( deps != NULL && ! deps -> failed )
+    {
+        char full [ 4096 ];
+        if ( KDirectoryResolvePath ( dir, true, full, sizeof full, "%.*s", ( int ) sz, path ) != 0 )
+            deps -> failed = true;
+        else
+        {
+            uint32_t type;
+            uint64_t date, size;
+            KConfigSnapStat ( dir, full, & type, & date, & size );
+
+            /* dates have 1 second resolution:
+               something touched just now may change again unnoticed */
+            if ( date + 2 > ( uint64_t ) KTimeStamp () )
+                deps -> failed = true;
+
+            KConfigSnapBufPutStr ( deps, full, string_size ( full ) );
+            KConfigSnapBufPutU32 ( deps, type );
+            KConfigSnapBufPutU64 ( deps, date );
+            KConfigSnapBufPutU64 ( deps, size );
+            ++ deps -> count;
+        }
+    }
+}
+
+
 static
 bool load_from_file_path ( KConfig *self, const KDirectory *dir, const char *path, size_t sz, bool is_magic )
 {
@@ -1907,6 +2063,8 @@ bool load_from_file_path ( KConfig *self, const KDirectory *dir, const char *pat
     /* record magic file path, regardless of whether it exists as a file */
     if ( is_magic )
         record_magic_path ( self, dir, path, sz );
+
+    KConfigSnapNote ( self, dir, path, sz );
     
     DBGMSG( DBG_KFG, DBG_FLAG(DBG_KFG), ( "KFG: try to load from file '%.*s'\n", (int)sz, path ) );
     rc = KDirectoryOpenFileRead ( dir, & cfg_file, "%.*s", ( int ) sz, path );
@@ -1981,7 +2139,11 @@ bool load_from_dir_path ( KConfig *self, const KDirectory *dir, const char *path
 {
     bool loaded = false;
     const KDirectory *cfg_dir;
-    rc_t rc = KDirectoryOpenDirRead ( dir, & cfg_dir, false, "%.*s", ( uint32_t ) sz, path );
+    rc_t rc;
+
+    KConfigSnapNote ( self, dir, path, sz );
+
+    rc = KDirectoryOpenDirRead ( dir, & cfg_dir, false, "%.*s", ( uint32_t ) sz, path );
     if ( rc == 0 )
     {
         DBGMSG( DBG_KFG, DBG_FLAG(DBG_KFG), ( "KFG: try to load from directory '%.*s'\n", (int)sz, path ) );
@@ -2007,6 +2169,9 @@ bool load_from_path ( KConfig *self, const KDirectory * dir, const char *path, s
         case kptDir:
             loaded = load_from_dir_path ( self, dir, path, sz );
             break;
+        default:
+            /* remember it was missing */
+            KConfigSnapNote ( self, dir, path, sz );
         }
     }
     return loaded;
@@ -2448,6 +2613,590 @@ void add_predefined_nodes ( KConfig * self, const char *appname )
     KDirectoryRelease ( cwd );
 }
 
+/*--------------------------------------------------------------------------
+ * KConfigSnapshot
+ *  binary image of the tree as loaded from configuration files.
+ *  it is keyed by the predefined nodes that files may refer to
+ *  and stays valid while none of the consulted paths change,
+ *  so later processes skip searching and parsing altogether.
+ *
+ *  nodes that differ from one process or host to the next are
+ *  neither keyed nor stored, but carried over from the live tree.
+ */
+#define SNAPSHOT_MAGIC "KFGSNAP1"
+
+static const char *volatile_nodes [] =
+{
+    "APPNAME", "APPPATH", "HOST", "PWD", "kfg/arch/name"
+};
+
+static
+bool KConfigSnapVolatileName ( const char *name, size_t size )
+{
+    uint32_t i;
+    for ( i = 0; i < sizeof volatile_nodes / sizeof volatile_nodes [ 0 ]; ++ i )
+    {
+        size_t vsize = string_size ( volatile_nodes [ i ] );
+        if ( size == vsize && memcmp ( name, volatile_nodes [ i ], size ) == 0 )
+            return true;
+    }
+    return false;
+}
+
+/* FindPath
+ *  walk a '/' separated path of child names
+ */
+static
+KConfigNode *KConfigNodeFindPath ( KConfigNode *self, const char *path )
+{
+    while ( self != NULL && path [ 0 ] != 0 )
+    {
+        String name;
+        const char *sep = strchr ( path, '/' );
+        size_t size = ( sep == NULL ) ? string_size ( path ) : ( size_t ) ( sep - path );
+
+        StringInit ( & name, path, size, string_len ( path, size ) );
+        self = ( KConfigNode* ) BSTreeFind ( & self -> children, & name, KConfigNodeCmp );
+
+        path += size;
+        if ( path [ 0 ] == '/' )
+            ++ path;
+    }
+    return self;
+}
+
+typedef struct KConfigSnapTree KConfigSnapTree;
+struct KConfigSnapTree
+{
+    KConfigSnapBuf *buf;
+    const KConfigNode *skip [ sizeof volatile_nodes / sizeof volatile_nodes [ 0 ] ];
+    KConfigIncluded **inc;
+    uint32_t inc_count;
+    uint32_t count;
+};
+
+static
+bool KConfigSnapSkip ( const KConfigSnapTree *pb, const KConfigNode *node )
+{
+    uint32_t i;
+    for ( i = 0; i < sizeof pb -> skip / sizeof pb -> skip [ 0 ]; ++ i )
+    {
+        if ( pb -> skip [ i ] == node )
+            return true;
+    }
+    return false;
+}
+
+static
+void CC KConfigSnapCountChild ( BSTNode *n, void *data )
+{
+    KConfigSnapTree *pb = data;
+    if ( ! KConfigSnapSkip ( pb, ( const KConfigNode* ) n ) )
+        ++ pb -> count;
+}
+
+static void CC KConfigSnapPutChild ( BSTNode *n, void *data );
+
+static
+void KConfigSnapPutNode ( const KConfigNode *self, KConfigSnapTree *pb )
+{
+    uint32_t i, came_from = 0;
+    for ( i = 0; i < pb -> inc_count; ++ i )
+    {
+        if ( pb -> inc [ i ] == self -> came_from )
+        {
+            came_from = i + 1;
+            break;
+        }
+    }
+
+    KConfigSnapBufPutStr ( pb -> buf, self -> name . addr, self -> name . size );
+    KConfigSnapBufPutStr ( pb -> buf, self -> value . addr, self -> value . size );
+    KConfigSnapBufPutU32 ( pb -> buf, self -> internal );
+    KConfigSnapBufPutU32 ( pb -> buf, came_from );
+
+    pb -> count = 0;
+    BSTreeForEach ( & self -> children, false, KConfigSnapCountChild, pb );
+    KConfigSnapBufPutU32 ( pb -> buf, pb -> count );
+    BSTreeForEach ( & self -> children, false, KConfigSnapPutChild, pb );
+}
+
+static
+void CC KConfigSnapPutChild ( BSTNode *n, void *data )
+{
+    KConfigSnapTree *pb = data;
+    if ( ! KConfigSnapSkip ( pb, ( const KConfigNode* ) n ) )
+        KConfigSnapPutNode ( ( const KConfigNode* ) n, pb );
+}
+
+/* PutTree
+ *  write the tree minus its volatile nodes
+ */
+static
+void KConfigSnapPutTree ( const KConfig *self, KConfigSnapBuf *buf,
+    KConfigIncluded **inc, uint32_t inc_count )
+{
+    uint32_t i;
+    KConfigSnapTree pb;
+    KConfigNode *root = ( KConfigNode* ) self -> tree . root;
+
+    pb . buf = buf;
+    pb . inc = inc;
+    pb . inc_count = inc_count;
+    for ( i = 0; i < sizeof pb . skip / sizeof pb . skip [ 0 ]; ++ i )
+        pb . skip [ i ] = KConfigNodeFindPath ( root, volatile_nodes [ i ] );
+
+    KConfigSnapPutNode ( root, & pb );
+}
+
+/* MakeKey
+ *  everything besides the files themselves that loading depends on.
+ *  called while the tree holds only predefined nodes
+ */
+static
+void KConfigSnapMakeKey ( const KConfig *self, KConfigSnapBuf *key )
+{
+    uint32_t i;
+    const char * env_list [] =
+    {
+        "KLIB_CONFIG",
+        "VDBCONFIG",
+        "USERPROFILE"
+    };
+
+    KConfigSnapBufPutU32 ( key, sizeof ( void* ) );
+    KConfigSnapBufPutU32 ( key, s_disable_user_settings );
+    for ( i = 0; i < sizeof env_list / sizeof env_list [ 0 ]; ++ i )
+    {
+        const char *eval = getenv ( env_list [ i ] );
+        if ( eval == NULL )
+            eval = "";
+        KConfigSnapBufPutStr ( key, eval, string_size ( eval ) );
+    }
+
+    KConfigSnapPutTree ( self, key, NULL, 0 );
+}
+
+static
+void CC KConfigSnapCountIncluded ( BSTNode *n, void *data )
+{
+    * ( uint32_t* ) data += 1;
+}
+
+static
+void CC KConfigSnapGrabIncluded ( BSTNode *n, void *data )
+{
+    KConfigSnapTree *pb = data;
+    pb -> inc [ pb -> inc_count ++ ] = ( KConfigIncluded* ) n;
+}
+
+/* Save
+ *  write snapshot atomically, ignoring failures
+ */
+static
+void KConfigSnapSave ( const KConfig *self, const char *path, const KConfigSnapBuf *key )
+{
+    uint32_t i, count = 0;
+    KConfigSnapBuf body;
+    KConfigSnapTree inc;
+
+    memset ( & body, 0, sizeof body );
+
+    KConfigSnapBufPutStr ( & body, key -> base, key -> size );
+    KConfigSnapBufPutU32 ( & body, self -> deps -> count );
+    KConfigSnapBufPut ( & body, self -> deps -> base, self -> deps -> size );
+
+    KConfigSnapBufPutStr ( & body, self -> load_path,
+        self -> load_path == NULL ? 0 : string_size ( self -> load_path ) );
+    KConfigSnapBufPutStr ( & body, self -> magic_file_path,
+        self -> magic_file_path == NULL ? 0 : self -> magic_file_path_size );
+
+    BSTreeForEach ( & self -> included, false, KConfigSnapCountIncluded, & count );
+    inc . inc_count = 0;
+    inc . inc = malloc ( ( count + 1 ) * sizeof inc . inc [ 0 ] );
+    if ( inc . inc == NULL )
+        body . failed = true;
+    else
+    {
+        BSTreeForEach ( & self -> included, false, KConfigSnapGrabIncluded, & inc );
+        KConfigSnapBufPutU32 ( & body, inc . inc_count );
+        for ( i = 0; i < inc . inc_count; ++ i )
+        {
+            KConfigSnapBufPutU32 ( & body, inc . inc [ i ] -> is_magic_file );
+            KConfigSnapBufPutStr ( & body, inc . inc [ i ] -> path,
+                string_size ( inc . inc [ i ] -> path ) );
+        }
+
+        KConfigSnapPutTree ( self, & body, inc . inc, inc . inc_count );
+        free ( inc . inc );
+    }
+
+    if ( ! body . failed )
+    {
+        KDirectory *wd;
+        rc_t rc = KDirectoryNativeDir ( & wd );
+        if ( rc == 0 )
+        {
+            char tmp_path [ 4096 ];
+#if ! WINDOWS
+            rc = string_printf ( tmp_path, sizeof tmp_path, NULL, "%s.%u.tmp", path, ( uint32_t ) getpid () );
+#else
+            rc = string_printf ( tmp_path, sizeof tmp_path, NULL, "%s.tmp", path );
+#endif
+            if ( rc == 0 )
+            {
+                KFile *f;
+                rc = KDirectoryCreateFile ( wd, & f, false, 0644, kcmInit | kcmParents, "%s", tmp_path );
+                if ( rc == 0 )
+                {
+                    size_t num_writ;
+                    uint32_t crc;
+
+                    CRC32Init ();
+                    crc = CRC32 ( 0, body . base, body . size );
+
+                    rc = KFileWriteAll ( f, 0, SNAPSHOT_MAGIC, 8, & num_writ );
+                    if ( rc == 0 )
+                        rc = KFileWriteAll ( f, 8, & crc, sizeof crc, & num_writ );
+                    if ( rc == 0 )
+                        rc = KFileWriteAll ( f, 8 + sizeof crc, body . base, body . size, & num_writ );
+                    if ( rc == 0 && num_writ != body . size )
+                        rc = RC ( rcKFG, rcFile, rcWriting, rcTransfer, rcIncomplete );
+
+                    KFileRelease ( f );
+
+                    if ( rc == 0 )
+                        rc = KDirectoryRename ( wd, true, tmp_path, path );
+                    if ( rc != 0 )
+                        KDirectoryRemove ( wd, true, "%s", tmp_path );
+                    else
+                        DBGMSG( DBG_KFG, DBG_FLAG(DBG_KFG), ( "KFG: saved snapshot '%s'\n", path ) );
+                }
+            }
+            KDirectoryRelease ( wd );
+        }
+    }
+
+    KConfigSnapBufWhack ( & body );
+}
+
+typedef struct KConfigSnapReader KConfigSnapReader;
+struct KConfigSnapReader
+{
+    const char *pos;
+    const char *end;
+};
+
+static
+bool KConfigSnapGet ( KConfigSnapReader *self, void *data, size_t size )
+{
+    if ( ( size_t ) ( self -> end - self -> pos ) < size )
+        return false;
+    memmove ( data, self -> pos, size );
+    self -> pos += size;
+    return true;
+}
+
+static
+bool KConfigSnapGetStr ( KConfigSnapReader *self, const char **str, size_t *size )
+{
+    uint32_t len;
+    if ( ! KConfigSnapGet ( self, & len, sizeof len ) ||
+         ( size_t ) ( self -> end - self -> pos ) < len )
+        return false;
+    * str = self -> pos;
+    * size = len;
+    self -> pos += len;
+    return true;
+}
+
+/* GetDeps
+ *  true if all recorded paths are unchanged
+ */
+static
+bool KConfigSnapGetDeps ( KConfigSnapReader *rd, const KDirectory *wd )
+{
+    uint32_t i, count;
+    if ( ! KConfigSnapGet ( rd, & count, sizeof count ) )
+        return false;
+
+    for ( i = 0; i < count; ++ i )
+    {
+        const char *path;
+        size_t size;
+        char full [ 4096 ];
+        uint32_t type, cur_type;
+        uint64_t date, cur_date, bytes, cur_bytes;
+
+        if ( ! KConfigSnapGetStr ( rd, & path, & size ) || size >= sizeof full ||
+             ! KConfigSnapGet ( rd, & type, sizeof type ) ||
+             ! KConfigSnapGet ( rd, & date, sizeof date ) ||
+             ! KConfigSnapGet ( rd, & bytes, sizeof bytes ) )
+            return false;
+
+        memmove ( full, path, size );
+        full [ size ] = 0;
+        KConfigSnapStat ( wd, full, & cur_type, & cur_date, & cur_bytes );
+        if ( cur_type != type || cur_date != date || cur_bytes != bytes )
+        {
+            DBGMSG( DBG_KFG, DBG_FLAG(DBG_KFG), ( "KFG: snapshot is stale: '%s' changed\n", full ) );
+            return false;
+        }
+    }
+    return true;
+}
+
+/* GetNode
+ *  rebuild a subtree
+ */
+static
+bool KConfigSnapGetNode ( KConfigSnapReader *rd, KConfig *mgr, KConfigNode *dad,
+    KConfigNode **np, KConfigIncluded **inc, uint32_t inc_count, uint32_t depth )
+{
+    String str;
+    KConfigNode *n;
+    const char *name, *value;
+    size_t name_size, value_size;
+    uint32_t i, internal, came_from, count;
+
+    if ( depth > 256 ||
+         ! KConfigSnapGetStr ( rd, & name, & name_size ) ||
+         ! KConfigSnapGetStr ( rd, & value, & value_size ) ||
+         ! KConfigSnapGet ( rd, & internal, sizeof internal ) ||
+         ! KConfigSnapGet ( rd, & came_from, sizeof came_from ) ||
+         ! KConfigSnapGet ( rd, & count, sizeof count ) ||
+         came_from > inc_count )
+        return false;
+
+    StringInit ( & str, name, name_size, string_len ( name, name_size ) );
+    if ( KConfigNodeMake ( & n, & str ) != 0 )
+        return false;
+
+    n -> dad = dad;
+    n -> internal = internal;
+    n -> came_from = ( came_from == 0 ) ? NULL : inc [ came_from - 1 ];
+
+    if ( value_size != 0 )
+    {
+        n -> val_buffer = malloc ( value_size + 1 );
+        if ( n -> val_buffer == NULL )
+        {
+            KConfigNodeWhack ( & n -> n, mgr );
+            return false;
+        }
+        memmove ( n -> val_buffer, value, value_size );
+        n -> val_buffer [ value_size ] = 0;
+        StringInit ( & n -> value, n -> val_buffer, value_size, string_len ( n -> val_buffer, value_size ) );
+    }
+
+    for ( i = 0; i < count; ++ i )
+    {
+        KConfigNode *child;
+        if ( ! KConfigSnapGetNode ( rd, mgr, n, & child, inc, inc_count, depth + 1 ) )
+        {
+            KConfigNodeWhack ( & n -> n, mgr );
+            return false;
+        }
+        BSTreeInsert ( & n -> children, & child -> n, KConfigNodeSort );
+    }
+
+    * np = n;
+    return true;
+}
+
+/* Load
+ *  replace the tree of predefined nodes with a valid snapshot
+ */
+static
+bool KConfigSnapLoad ( KConfig *self, const char *path, const KConfigSnapBuf *key )
+{
+    bool loaded = false;
+    KDirectory *wd;
+    rc_t rc = KDirectoryNativeDir ( & wd );
+    if ( rc == 0 )
+    {
+        const KFile *f;
+        rc = KDirectoryOpenFileRead ( wd, & f, "%s", path );
+        if ( rc == 0 )
+        {
+            const KMMap *mm;
+            rc = KMMapMakeRead ( & mm, f );
+            if ( rc == 0 )
+            {
+                size_t size;
+                const void *addr;
+                rc = KMMapAddrRead ( mm, & addr );
+                if ( rc == 0 )
+                    rc = KMMapSize ( mm, & size );
+                if ( rc == 0 && size >= 8 + sizeof ( uint32_t ) &&
+                     memcmp ( addr, SNAPSHOT_MAGIC, 8 ) == 0 )
+                {
+                    uint32_t crc;
+                    KConfigSnapReader rd;
+                    const char *str, *load_path, *magic_path;
+                    size_t str_size, load_path_size, magic_path_size;
+                    uint32_t i, inc_count;
+                    KConfigIncluded **inc = NULL;
+                    KConfigNode *root = NULL;
+                    BSTree included;
+
+                    BSTreeInit ( & included );
+
+                    rd . pos = ( const char* ) addr + 8;
+                    rd . end = ( const char* ) addr + size;
+                    KConfigSnapGet ( & rd, & crc, sizeof crc );
+
+                    CRC32Init ();
+                    if ( CRC32 ( 0, rd . pos, rd . end - rd . pos ) == crc &&
+                         KConfigSnapGetStr ( & rd, & str, & str_size ) &&
+                         str_size == key -> size && memcmp ( str, key -> base, str_size ) == 0 &&
+                         KConfigSnapGetDeps ( & rd, wd ) &&
+                         KConfigSnapGetStr ( & rd, & load_path, & load_path_size ) &&
+                         KConfigSnapGetStr ( & rd, & magic_path, & magic_path_size ) &&
+                         KConfigSnapGet ( & rd, & inc_count, sizeof inc_count ) &&
+                         ( size_t ) ( rd . end - rd . pos ) / 8 >= inc_count &&
+                         ( inc = calloc ( inc_count + 1, sizeof inc [ 0 ] ) ) != NULL )
+                    {
+                        bool ok = true;
+                        for ( i = 0; ok && i < inc_count; ++ i )
+                        {
+                            uint32_t is_magic;
+                            ok = KConfigSnapGet ( & rd, & is_magic, sizeof is_magic ) &&
+                                 KConfigSnapGetStr ( & rd, & str, & str_size ) &&
+                                 ( inc [ i ] = malloc ( sizeof * inc [ i ] + str_size ) ) != NULL;
+                            if ( ok )
+                            {
+                                inc [ i ] -> is_magic_file = is_magic != 0;
+                                string_copy ( inc [ i ] -> path, str_size + 1, str, str_size );
+                                BSTreeInsert ( & included, & inc [ i ] -> n, KConfigIncludedSort );
+                            }
+                        }
+
+                        if ( ok &&
+                             KConfigSnapGetNode ( & rd, self, NULL, & root, inc, inc_count, 0 ) &&
+                             rd . pos == rd . end )
+                        {
+                            char *lp = NULL, *mp = NULL;
+                            if ( load_path_size != 0 )
+                                lp = malloc ( load_path_size + 1 );
+                            if ( magic_path_size != 0 )
+                                mp = malloc ( magic_path_size + 1 );
+
+                            if ( ( load_path_size == 0 || lp != NULL ) &&
+                                 ( magic_path_size == 0 || mp != NULL ) )
+                            {
+                                KConfigNode *old = ( KConfigNode* ) self -> tree . root;
+
+                                /* carry over per-process nodes */
+                                for ( i = 0; i < sizeof volatile_nodes / sizeof volatile_nodes [ 0 ]; ++ i )
+                                {
+                                    const char *leaf = strrchr ( volatile_nodes [ i ], '/' );
+                                    KConfigNode *n = KConfigNodeFindPath ( old, volatile_nodes [ i ] );
+                                    KConfigNode *dad = root;
+                                    if ( leaf != NULL )
+                                    {
+                                        char dad_path [ 256 ];
+                                        string_copy ( dad_path, sizeof dad_path,
+                                            volatile_nodes [ i ], leaf - volatile_nodes [ i ] );
+                                        dad = KConfigNodeFindPath ( root, dad_path );
+                                    }
+                                    if ( n != NULL && dad != NULL )
+                                    {
+                                        BSTreeUnlink ( & n -> dad -> children, & n -> n );
+                                        n -> dad = dad;
+                                        BSTreeInsert ( & dad -> children, & n -> n, KConfigNodeSort );
+                                    }
+                                }
+
+                                BSTreeWhack ( & self -> tree, KConfigNodeWhack, self );
+                                BSTreeInsert ( & self -> tree, & root -> n, KConfigNodeSort );
+                                root = NULL;
+
+                                BSTreeWhack ( & self -> included, KConfigIncludedWhack, NULL );
+                                self -> included = included;
+                                BSTreeInit ( & included );
+
+                                free ( self -> load_path );
+                                self -> load_path = lp;
+                                self -> load_path_sz_tmp = 0;
+                                if ( lp != NULL )
+                                {
+                                    string_copy ( lp, load_path_size + 1, load_path, load_path_size );
+                                    self -> load_path_sz_tmp = load_path_size + 1;
+                                }
+
+                                free ( ( void* ) self -> magic_file_path );
+                                self -> magic_file_path = mp;
+                                self -> magic_file_path_size = magic_path_size;
+                                if ( mp != NULL )
+                                    string_copy ( mp, magic_path_size + 1, magic_path, magic_path_size );
+
+                                lp = mp = NULL;
+                                loaded = true;
+                                DBGMSG( DBG_KFG, DBG_FLAG(DBG_KFG), ( "KFG: loaded snapshot '%s'\n", path ) );
+                            }
+
+                            free ( lp );
+                            free ( mp );
+                        }
+                    }
+
+                    if ( root != NULL )
+                        KConfigNodeWhack ( & root -> n, self );
+                    BSTreeWhack ( & included, KConfigIncludedWhack, NULL );
+                    free ( inc );
+                }
+
+                KMMapRelease ( mm );
+            }
+            KFileRelease ( f );
+        }
+        KDirectoryRelease ( wd );
+    }
+    return loaded;
+}
+
+/* Begin
+ *  load from a snapshot if one is configured and valid.
+ *  otherwise start recording for KConfigSnapEnd
+ */
+static
+bool KConfigSnapBegin ( KConfig *self, const KDirectory *cfgdir, KConfigSnapBuf *key )
+{
+    const char *path = getenv ( SNAPSHOT_ENV_NAME );
+
+    memset ( key, 0, sizeof * key );
+
+    /* an explicit configuration directory is not worth remembering */
+    if ( cfgdir != NULL || path == NULL || path [ 0 ] == 0 )
+        return false;
+
+    KConfigSnapMakeKey ( self, key );
+    if ( key -> failed )
+        return false;
+
+    if ( KConfigSnapLoad ( self, path, key ) )
+        return true;
+
+    self -> deps = calloc ( 1, sizeof * self -> deps );
+    return false;
+}
+
+static
+void KConfigSnapEnd ( KConfig *self, KConfigSnapBuf *key )
+{
+    if ( self -> deps != NULL )
+    {
+        if ( ! self -> deps -> failed && ! self -> dirty )
+            KConfigSnapSave ( self, getenv ( SNAPSHOT_ENV_NAME ), key );
+
+        KConfigSnapBufWhack ( self -> deps );
+        free ( self -> deps );
+        self -> deps = NULL;
+    }
+    KConfigSnapBufWhack ( key );
+}
+
 static
 rc_t KConfigFill ( KConfig * self, const KDirectory * cfgdir, const char *appname, bool local)
 {
@@ -2460,10 +3209,16 @@ rc_t KConfigFill ( KConfig * self, const KDirectory * cfgdir, const char *appnam
     rc = KConfigNodeMake ( & root, & empty );
     if (rc == 0)
     {
+        KConfigSnapBuf key;
+
         KConfigInit ( self, root );
         add_predefined_nodes ( self, appname );
-        load_config_files ( self, cfgdir );
-        KConfigCommit ( self ); /* commit changes made to magic file nodes duting parsing (e.g. fixed spelling of dbGaP names) */
+        if ( ! KConfigSnapBegin ( self, cfgdir, & key ) )
+        {
+            load_config_files ( self, cfgdir );
+            KConfigCommit ( self ); /* commit changes made to magic file nodes duting parsing (e.g. fixed spelling of dbGaP names) */
+        }
+        KConfigSnapEnd ( self, & key );
     }
     return rc;
 }
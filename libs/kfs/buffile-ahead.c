@@ -0,0 +1,490 @@
+/*===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+typedef struct KBufAheadFile KBufAheadFile;
+#define KFILE_IMPL KBufAheadFile
+
+#include <kfs/extern.h>
+
+#include <kfs/file.h>
+#include <kfs/buffile.h>
+#include <kfs/kfs-priv.h>
+#include <kfs/impl.h>
+#include <kproc/thread.h>
+#include <kproc/lock.h>
+#include <kproc/cond.h>
+#include <klib/rc.h>
+#include <sysalloc.h>
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*-----------------------------------------------------------------------
+ * KBufAheadFile
+ *  a read-only buffer with two windows onto the original file:
+ *  "cur" serves the reader, "next" is filled by a background thread
+ *  with the bytes that follow "cur" while the reader is sequential.
+ *  every time the reader moves into a prefetched window the window
+ *  size doubles, up to max_bsize; a random access shrinks it again.
+ */
+enum
+{
+    ahead_empty,        /* window holds nothing */
+    ahead_queued,       /* window was handed to the thread */
+    ahead_busy,         /* thread is reading into the window */
+    ahead_done          /* window holds valid data or a read error */
+};
+
+typedef struct KBufAheadWindow KBufAheadWindow;
+struct KBufAheadWindow
+{
+    uint64_t pos;       /* position of the window within the original file */
+    size_t len;         /* bytes requested */
+    size_t num_valid;   /* bytes actually read */
+    uint8_t *buff;
+    rc_t rc;
+    int state;
+};
+
+struct KBufAheadFile
+{
+    KFile dad;
+
+    const KFile *f;     /* original file being buffered */
+
+    KLock *lock;
+    KCondition *cond;
+    KThread *thread;
+
+    KBufAheadWindow win [ 2 ];
+    KBufAheadWindow *cur;
+    KBufAheadWindow *next;
+
+    uint64_t last_end;  /* end of the last read, to detect sequential access */
+    uint64_t eof;       /* size of the original file */
+
+    uint64_t num_reads;
+    uint64_t num_hits;
+    uint64_t bytes_prefetched;
+
+    size_t min_bsize;
+    size_t max_bsize;
+    size_t window;      /* current window size */
+
+    bool running;       /* the thread is available */
+    bool quit;
+};
+
+static
+rc_t CC KBufAheadFileThread ( const KThread *t, void *data )
+{
+    KBufAheadFile *self = data;
+    rc_t rc = KLockAcquire ( self -> lock );
+    if ( rc != 0 )
+    {
+        self -> running = false;
+        return rc;
+    }
+
+    while ( ! self -> quit )
+    {
+        KBufAheadWindow *w = self -> next;
+        if ( w -> state != ahead_queued )
+        {
+            rc = KConditionWait ( self -> cond, self -> lock );
+            if ( rc != 0 )
+                break;
+            continue;
+        }
+
+        /* the reader does not touch a busy window */
+        w -> state = ahead_busy;
+        KLockUnlock ( self -> lock );
+
+        w -> rc = KFileReadAll ( self -> f, w -> pos, w -> buff, w -> len, & w -> num_valid );
+
+        KLockAcquire ( self -> lock );
+        w -> state = ahead_done;
+        if ( w -> rc == 0 )
+            self -> bytes_prefetched += w -> num_valid;
+        KConditionBroadcast ( self -> cond );
+    }
+
+    self -> running = false;
+    KConditionBroadcast ( self -> cond );
+    KLockUnlock ( self -> lock );
+    return rc;
+}
+
+/* called with the lock held: a window in flight must land before
+   the reader touches the original file or the window itself */
+static
+void KBufAheadFileSettle ( KBufAheadFile *self )
+{
+    while ( self -> running &&
+            ( self -> next -> state == ahead_queued || self -> next -> state == ahead_busy ) )
+    {
+        if ( KConditionWait ( self -> cond, self -> lock ) != 0 )
+            break;
+    }
+}
+
+/* called with the lock held after "cur" has been filled or used */
+static
+void KBufAheadFileSchedule ( KBufAheadFile *self )
+{
+    KBufAheadWindow *w = self -> next;
+    uint64_t pos = self -> cur -> pos + self -> cur -> num_valid;
+
+    if ( ! self -> running || pos >= self -> eof )
+        return;
+    if ( w -> state == ahead_queued || w -> state == ahead_busy )
+        return;
+    if ( w -> state == ahead_done && w -> pos == pos )
+        return;
+
+    w -> pos = pos;
+    w -> len = self -> window;
+    w -> num_valid = 0;
+    w -> rc = 0;
+    w -> state = ahead_queued;
+    KConditionSignal ( self -> cond );
+
+    /* let the os start on what comes after the prefetched window */
+    KFileAdviseReadAhead ( self -> f, pos + w -> len, w -> len );
+}
+
+static
+rc_t CC KBufAheadFileDestroy ( KBufAheadFile *self )
+{
+    rc_t rc;
+
+    if ( self -> thread != NULL )
+    {
+        KLockAcquire ( self -> lock );
+        self -> quit = true;
+        KConditionBroadcast ( self -> cond );
+        KLockUnlock ( self -> lock );
+
+        KThreadWait ( self -> thread, NULL );
+        KThreadRelease ( self -> thread );
+    }
+
+    KConditionRelease ( self -> cond );
+    KLockRelease ( self -> lock );
+
+    rc = KFileRelease ( self -> f );
+    if ( rc == 0 )
+    {
+        free ( self -> win [ 0 ] . buff );
+        free ( self );
+    }
+    return rc;
+}
+
+static
+struct KSysFile* CC KBufAheadFileSysFile ( const KBufAheadFile *self, uint64_t *offset )
+{
+    /* does not support SysFile */
+    * offset = 0;
+    return NULL;
+}
+
+static
+rc_t CC KBufAheadFileRandomAccess ( const KBufAheadFile *self )
+{
+    return KFileRandomAccess ( self -> f );
+}
+
+static
+rc_t CC KBufAheadFileSize ( const KBufAheadFile *self, uint64_t *size )
+{
+    return KFileSize ( self -> f, size );
+}
+
+static
+rc_t CC KBufAheadFileSetSize ( KBufAheadFile *self, uint64_t size )
+{
+    return RC ( rcFS, rcFile, rcAccessing, rcFunction, rcUnsupported );
+}
+
+static
+bool KBufAheadWindowHas ( const KBufAheadWindow *w, uint64_t pos )
+{
+    return w -> state == ahead_done && w -> rc == 0 &&
+        pos >= w -> pos && pos < w -> pos + w -> num_valid;
+}
+
+static
+rc_t CC KBufAheadFileRead ( const KBufAheadFile *cself, uint64_t pos,
+    void *buffer, size_t bsize, size_t *num_read )
+{
+    KBufAheadFile *self = ( KBufAheadFile* ) cself;
+    KBufAheadWindow *cur;
+    bool sequential;
+    rc_t rc;
+
+    assert ( buffer != NULL );
+    assert ( num_read != NULL );
+
+    * num_read = 0;
+    if ( bsize == 0 )
+        return 0;
+
+    rc = KLockAcquire ( self -> lock );
+    if ( rc != 0 )
+        return rc;
+
+    ++ self -> num_reads;
+    sequential = ( pos == self -> last_end );
+
+    if ( KBufAheadWindowHas ( self -> cur, pos ) )
+        ++ self -> num_hits;
+    else
+    {
+        /* the prefetched window is the one wanted: swap it in and widen */
+        KBufAheadFileSettle ( self );
+        if ( KBufAheadWindowHas ( self -> next, pos ) )
+        {
+            KBufAheadWindow *w = self -> cur;
+            self -> cur = self -> next;
+            self -> next = w;
+            self -> next -> state = ahead_empty;
+
+            if ( self -> window < self -> max_bsize )
+            {
+                self -> window *= 2;
+                if ( self -> window > self -> max_bsize )
+                    self -> window = self -> max_bsize;
+            }
+            ++ self -> num_hits;
+        }
+        else
+        {
+            /* a miss: read the current window in place */
+            if ( ! sequential )
+                self -> window = self -> min_bsize;
+
+            cur = self -> cur;
+            cur -> pos = pos;
+            cur -> len = self -> window;
+            cur -> state = ahead_done;
+            cur -> rc = KFileReadAll ( self -> f, pos, cur -> buff, cur -> len, & cur -> num_valid );
+            rc = cur -> rc;
+        }
+    }
+
+    cur = self -> cur;
+    if ( rc == 0 && KBufAheadWindowHas ( cur, pos ) )
+    {
+        size_t offset = ( size_t ) ( pos - cur -> pos );
+        size_t to_copy = cur -> num_valid - offset;
+        if ( to_copy > bsize )
+            to_copy = bsize;
+
+        memmove ( buffer, cur -> buff + offset, to_copy );
+        * num_read = to_copy;
+
+        self -> last_end = pos + to_copy;
+        if ( sequential )
+            KBufAheadFileSchedule ( self );
+    }
+    else if ( rc == 0 )
+    {
+        /* nothing there: end of file */
+        self -> last_end = pos;
+    }
+
+    KLockUnlock ( self -> lock );
+    return rc;
+}
+
+static
+rc_t CC KBufAheadFileWrite ( KBufAheadFile *self, uint64_t pos,
+    const void *buffer, size_t size, size_t *num_writ )
+{
+    return RC ( rcFS, rcFile, rcWriting, rcFunction, rcUnsupported );
+}
+
+static
+uint32_t CC KBufAheadFileType ( const KBufAheadFile * self )
+{
+    return KFileType ( self -> f );
+}
+
+static
+const KFile_vt_v1 vtKBufAheadFile_v1 =
+{
+    /* version */
+    1, 1,
+
+    /* 1.0 */
+    KBufAheadFileDestroy,
+    KBufAheadFileSysFile,
+    KBufAheadFileRandomAccess,
+    KBufAheadFileSize,
+    KBufAheadFileSetSize,
+    KBufAheadFileRead,
+    KBufAheadFileWrite,
+
+    /* 1.1 */
+    KBufAheadFileType
+};
+
+static
+rc_t KBufAheadFileMake ( KBufAheadFile ** bp, const KFile *f, size_t bsize, size_t max_bsize )
+{
+    rc_t rc;
+
+    KBufAheadFile *buf = calloc ( 1, sizeof * buf );
+    if ( buf == NULL )
+        return RC ( rcFS, rcFile, rcConstructing, rcMemory, rcExhausted );
+
+    buf -> win [ 0 ] . buff = malloc ( 2 * max_bsize );
+    if ( buf -> win [ 0 ] . buff == NULL )
+        rc = RC ( rcFS, rcFile, rcConstructing, rcMemory, rcExhausted );
+    else
+    {
+        buf -> win [ 1 ] . buff = buf -> win [ 0 ] . buff + max_bsize;
+        buf -> cur = & buf -> win [ 0 ];
+        buf -> next = & buf -> win [ 1 ];
+        buf -> min_bsize = buf -> window = bsize;
+        buf -> max_bsize = max_bsize;
+
+        rc = KFileSize ( f, & buf -> eof );
+        if ( rc != 0 )
+            buf -> eof = ( uint64_t ) -1;
+
+        rc = KLockMake ( & buf -> lock );
+        if ( rc == 0 )
+        {
+            rc = KConditionMake ( & buf -> cond );
+            if ( rc == 0 )
+            {
+                rc = KFileInit ( & buf -> dad, ( const KFile_vt* ) & vtKBufAheadFile_v1,
+                                 "KBufAheadFile", "no-name", true, false );
+                if ( rc == 0 )
+                {
+                    rc = KFileAddRef ( f );
+                    if ( rc == 0 )
+                    {
+                        buf -> f = f;
+
+                        /* without a thread the file still adapts its window,
+                           it just does not read ahead */
+                        buf -> running = true;
+                        if ( KThreadMake ( & buf -> thread, KBufAheadFileThread, buf ) != 0 )
+                        {
+                            buf -> thread = NULL;
+                            buf -> running = false;
+                        }
+
+                        * bp = buf;
+                        return 0;
+                    }
+                }
+                KConditionRelease ( buf -> cond );
+            }
+            KLockRelease ( buf -> lock );
+        }
+        free ( buf -> win [ 0 ] . buff );
+    }
+
+    free ( buf );
+    return rc;
+}
+
+LIB_EXPORT
+rc_t CC KBufReadFileMakeReadAhead ( const KFile ** bp, const KFile * original,
+    size_t bsize, size_t max_bsize )
+{
+    rc_t rc;
+
+    if ( bp == NULL )
+        rc = RC ( rcFS, rcFile, rcConstructing, rcParam, rcNull );
+    else
+    {
+        if ( original == NULL )
+            rc = RC ( rcFS, rcFile, rcConstructing, rcFile, rcNull );
+        else if ( ! original -> read_enabled )
+        {
+            if ( original -> write_enabled )
+                rc = RC ( rcFS, rcFile, rcConstructing, rcFile, rcWriteonly );
+            else
+                rc = RC ( rcFS, rcFile, rcConstructing, rcFile, rcNoPerm );
+        }
+        else if ( bsize == 0 )
+            rc = RC ( rcFS, rcFile, rcConstructing, rcParam, rcInvalid );
+        else
+        {
+            KBufAheadFile *buf;
+
+            if ( max_bsize == 0 )
+                max_bsize = 16 * bsize;
+            else if ( max_bsize < bsize )
+                max_bsize = bsize;
+
+            rc = KBufAheadFileMake ( & buf, original, bsize, max_bsize );
+            if ( rc == 0 )
+            {
+                * bp = & buf -> dad;
+                return 0;
+            }
+        }
+
+        * bp = NULL;
+    }
+
+    return rc;
+}
+
+LIB_EXPORT
+rc_t CC KBufReadFileGetReadAheadStats ( const KFile * self, uint64_t * num_reads,
+    uint64_t * num_hits, uint64_t * bytes_prefetched, size_t * window )
+{
+    KBufAheadFile *buf;
+
+    if ( self == NULL )
+        return RC ( rcFS, rcFile, rcAccessing, rcSelf, rcNull );
+    if ( self -> vt != ( const KFile_vt* ) & vtKBufAheadFile_v1 )
+        return RC ( rcFS, rcFile, rcAccessing, rcType, rcIncorrect );
+
+    buf = ( KBufAheadFile* ) self;
+    KLockAcquire ( buf -> lock );
+
+    if ( num_reads != NULL )
+        * num_reads = buf -> num_reads;
+    if ( num_hits != NULL )
+        * num_hits = buf -> num_hits;
+    if ( bytes_prefetched != NULL )
+        * bytes_prefetched = buf -> bytes_prefetched;
+    if ( window != NULL )
+        * window = buf -> window;
+
+    KLockUnlock ( buf -> lock );
+    return 0;
+}
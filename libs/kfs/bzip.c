@@ -36,6 +36,8 @@ struct KBZipFile;
 #include <klib/log.h>
 #include <sysalloc.h>
 
+#include "pzip-priv.h" /* KParZipFileMake */
+
 #include <bzlib.h>      /* bz_stream */
 #include <assert.h>
 #include <stdlib.h>    /* malloc */
@@ -835,4 +837,74 @@ LIB_EXPORT rc_t CC KFileMakeBzip2ForWrite (struct KFile **pnew_obj,
 }
 
 
+/* ======================================================================
+ * parallel bzip2 output
+ *  each chunk becomes a complete bzip2 stream; bunzip2 accepts
+ *  the concatenation of such streams
+ */
+static
+size_t CC KBZipBound (size_t ssize)
+{
+    /* documented worst case for BZ2_bzBuffToBuffCompress */
+    return ssize + ssize / 100 + 600;
+}
+
+static
+rc_t CC KBZipChunk (void *dst, size_t dsize, size_t *num_writ,
+                    const void *src, size_t ssize)
+{
+    rc_t rc;
+    unsigned int dest_len;
+    int zret;
+
+    dest_len = (unsigned int)dsize;
+    zret = BZ2_bzBuffToBuffCompress (dst, &dest_len, (char*)src,
+                                     (unsigned int)ssize,
+                                     9, /* blockSize100k */
+                                     0, /* verbosity */
+                                     30); /* workFactor */
+    switch (zret)
+    {
+    case BZ_OK:
+        *num_writ = dest_len;
+        return 0;
+
+    case BZ_OUTBUFF_FULL:
+        rc = RC (rcFS, rcFile, rcWriting, rcBuffer, rcInsufficient);
+        LOGERR (klogInt, rc, "coding error bzip2 output bound");
+        break;
+
+    case BZ_MEM_ERROR:
+        rc = RC (rcFS, rcFile, rcWriting, rcMemory, rcExhausted);
+        LOGERR (klogErr, rc, "memory exhausted compressing bzip2 chunk");
+        break;
+
+    case BZ_CONFIG_ERROR:
+        rc = RC (rcFS, rcFile, rcWriting, rcLibrary, rcCorrupt);
+        LOGERR (klogFatal, rc, "bzip2 library miscompiled");
+        break;
+
+    default:
+        rc = RC (rcFS, rcFile, rcWriting, rcLibrary, rcUnexpected);
+        LOGERR (klogFatal, rc, "bzip2 library return unexpected error");
+        break;
+    }
+
+    *num_writ = 0;
+    return rc;
+}
+
+LIB_EXPORT rc_t CC KFileMakeParallelBzip2ForWrite (struct KFile **pnew_obj,
+                                                   struct KFile *compfile,
+                                                   size_t chunk_size,
+                                                   struct KParZipPool *pool)
+{
+    if (chunk_size == 0)
+        chunk_size = KPZIP_BZIP2_CHUNK_SIZE;
+
+    return KParZipFileMake (pnew_obj, compfile, "KBZipFile",
+                            chunk_size, pool, KBZipBound, KBZipChunk);
+}
+
+
 /* EOF */
@@ -29,6 +29,9 @@ struct KCacheTeeFile;
 #define KFILE_IMPL struct KCacheTeeFile
 #include <kfs/impl.h>
 #include <kfs/lockfile.h>
+#include <kproc/thread.h>
+#include <kproc/lock.h>
+#include <kproc/cond.h>
 
 #include <klib/rc.h>
 #include <klib/log.h>
@@ -64,6 +67,19 @@ struct KCacheTeeFile;
 #define CACHE_TEE_DEFAULT_BLOCKSIZE ( 32 * 1024 )
 #define CACHE_TEE_REPORT 0
 
+/* the background filler prefetches up to this many blocks ( times cluster )
+   ahead of a sequential reader, fetching at most CACHE_TEE_FILL_BLOCKS
+   ( times cluster ) blocks per remote request */
+#define CACHE_TEE_READ_AHEAD_BLOCKS 32
+#define CACHE_TEE_FILL_BLOCKS 4
+
+/* the bitmap is persisted after this many blocks have been fetched,
+   when the filler runs idle and when the file is destroyed */
+#define CACHE_TEE_BITMAP_FLUSH_BLOCKS 64
+
+/* a read-only cache-tee tries to take over the lock every so many cache-misses */
+#define CACHE_TEE_UPGRADE_INTERVAL 16
+
 typedef struct KCacheTeeFile
 {
     KFile dad;
@@ -73,23 +89,45 @@ typedef struct KCacheTeeFile
     KDirectory * dir;
     KLockFile * lock;
 
+    /* fill_lock guards the bitmap and the fill-window and is only held to look
+       at or update them, remote_lock serializes requests to the remote file
+       and guards the scratch-buffer; fill_lock is taken before remote_lock */
+    KLock * fill_lock;
+    KLock * remote_lock;
+    KCondition * fill_cond;
+    KThread * filler;
+
     uint8_t * bitmap;
     uint8_t * scratch_buffer;
+    uint8_t * fill_buffer;
 
     uint64_t remote_size;
     uint64_t local_size;
     uint64_t block_count;
     uint64_t log_file_pos;
-    uint64_t first_block_in_scratch;
+    uint64_t last_read_end;
+
+    /* blocks [ fill_next, fill_end [ are wanted by the background filler */
+    uint64_t fill_next;
+    uint64_t fill_end;
+
+    /* blocks [ dirty_first, dirty_last ] contain bits not yet persisted */
+    uint64_t dirty_first;
+    uint64_t dirty_last;
+    uint64_t dirty_count;
 
     /* size_t */ uint64_t bitmap_bytes;
     /* size_t */ uint64_t scratch_size;
-    /* size_t */ uint64_t valid_scratch_bytes;
     uint32_t block_size;
     uint32_t cluster_factor;
+    uint32_t read_ahead;
+    uint32_t fill_blocks;
+    uint32_t misses_since_upgrade;
     bool fully_in_cache;
     bool report;
     bool local_read_only;
+    bool shared;
+    bool fill_quit;
     char local_path [ 1 ];
 } KCacheTeeFile;
 
@@ -573,6 +611,10 @@ static rc_t promote_cache( KCacheTeeFile * cf )
 }
 
 
+static void stop_filler( KCacheTeeFile *self );
+static rc_t flush_bitmap( KCacheTeeFile *self );
+
+
 /* Destroy
  */
 static rc_t CC KCacheTeeFileDestroy( KCacheTeeFile *self )
@@ -582,9 +624,13 @@ static rc_t CC KCacheTeeFileDestroy( KCacheTeeFile *self )
         OUTMSG(( "\nDESTROY cacheteefile '%s'\n\n", self -> local_path ));
     }
 
+    stop_filler( self );
+
     if ( !self -> local_read_only && self -> lock != NULL )
     {
-        rc_t rc = IsCacheFileComplete ( self -> local, &self -> fully_in_cache, false );
+        rc_t rc;
+        flush_bitmap( self );
+        rc = IsCacheFileComplete ( self -> local, &self -> fully_in_cache, false );
         if ( rc == 0 && self -> fully_in_cache )
         {
             if ( self->report )
@@ -600,6 +646,10 @@ static rc_t CC KCacheTeeFileDestroy( KCacheTeeFile *self )
     if ( self->scratch_buffer != NULL )
         free( self->scratch_buffer );
 
+    KConditionRelease ( self -> fill_cond );
+    KLockRelease ( self -> remote_lock );
+    KLockRelease ( self -> fill_lock );
+
     KDirectoryRelease ( self->dir );
     KFileRelease ( self -> remote );
     KFileRelease ( self -> local );
@@ -665,6 +715,67 @@ static rc_t write_bitmap( const KCacheTeeFile *cself, uint64_t start_block, uint
 }
 
 
+/* persist the range of the bitmap that was modified since the last flush */
+static rc_t flush_bitmap( KCacheTeeFile *self )
+{
+    rc_t rc = 0;
+    if ( self->dirty_count > 0 )
+    {
+        rc = write_bitmap( self, self->dirty_first, ( self->dirty_last - self->dirty_first ) + 1 );
+        if ( rc == 0 )
+            self->dirty_count = 0;
+    }
+    return rc;
+}
+
+
+/* the content is always written before the bitmap-bits that describe it,
+   a bitmap that was not flushed because of a crash only costs re-fetching */
+static rc_t mark_bitmap( KCacheTeeFile *self, uint64_t start_block, uint64_t block_count )
+{
+    uint64_t last_block = start_block + block_count - 1;
+    if ( block_count == 0 )
+        return 0;
+
+    set_bitmap( self, start_block, block_count );
+    if ( self->dirty_count == 0 )
+    {
+        self->dirty_first = start_block;
+        self->dirty_last = last_block;
+    }
+    else
+    {
+        if ( start_block < self->dirty_first )
+            self->dirty_first = start_block;
+        if ( last_block > self->dirty_last )
+            self->dirty_last = last_block;
+    }
+    self->dirty_count += block_count;
+
+    if ( self->dirty_count >= CACHE_TEE_BITMAP_FLUSH_BLOCKS )
+        return flush_bitmap( self );
+    return 0;
+}
+
+
+/* a read-only cache-tee shares the local file with the process holding the lock:
+   pick up the bits that process has persisted since we last looked */
+static void refresh_bitmap( KCacheTeeFile *self, uint64_t start_block, uint64_t block_count )
+{
+    size_t num_read;
+    uint64_t start_byte = ( start_block >> 3 );
+    uint64_t end_byte = ( ( start_block + block_count - 1 ) >> 3 );
+    if ( end_byte >= self->bitmap_bytes )
+        end_byte = self->bitmap_bytes - 1;
+
+    /* bits are only ever set by the writer, so reading them in place is safe;
+       a short read means the writer has promoted ( truncated ) the cache-file */
+    if ( start_byte <= end_byte )
+        KFileReadAll( self->local, self->remote_size + start_byte,
+                      &self->bitmap[ start_byte ], ( end_byte - start_byte ) + 1, &num_read );
+}
+
+
 static rc_t resize_scratch_buffer( const KCacheTeeFile *cself, /* size_t */ uint64_t new_size )
 {
     rc_t rc = 0;
@@ -710,6 +821,7 @@ size_t check_rd_len( const KCacheTeeFile *cself, uint64_t pos, size_t bsize )
 }
 
 
+/* called with remote_lock held */
 static rc_t rd_remote_wr_local( const KCacheTeeFile *cself, uint64_t pos,
                                 void *buffer, size_t bsize, size_t *num_read )
 {
@@ -743,6 +855,214 @@ static rc_t rd_remote_wr_local( const KCacheTeeFile *cself, uint64_t pos,
     return rc;
 }
 
+
+/* the background filler:
+   fetches the blocks in the fill-window that are not yet cached, the remote request
+   and the write to the local file are made without holding fill_lock so readers
+   are not delayed */
+static rc_t CC KCacheTeeFileFiller( const KThread *t, void *data )
+{
+    KCacheTeeFile *self = data;
+    rc_t rc = KLockAcquire( self->fill_lock );
+    if ( rc != 0 )
+        return rc;
+
+    while ( rc == 0 && !self->fill_quit )
+    {
+        uint64_t block, count, pos;
+        size_t to_read, num_read = 0;
+
+        while ( self->fill_next < self->fill_end && IS_CACHE_BIT( self, self->fill_next ) )
+            ++self->fill_next;
+
+        if ( self->fill_next >= self->fill_end )
+        {
+            /* nothing to do: persist what was fetched and wait for the next window */
+            flush_bitmap( self );
+            rc = KConditionWait( self->fill_cond, self->fill_lock );
+            continue;
+        }
+
+        block = self->fill_next;
+        count = 1;
+        while ( count < self->fill_blocks && block + count < self->fill_end &&
+                !( IS_CACHE_BIT( self, block + count ) ) )
+            ++count;
+        self->fill_next = block + count;
+
+        pos = block * self->block_size;
+        to_read = check_rd_len( self, pos, count * self->block_size );
+        KLockUnlock( self->fill_lock );
+
+        rc = KLockAcquire( self->remote_lock );
+        if ( rc == 0 )
+        {
+            rc = KFileReadAll( self->remote, pos, self->fill_buffer, to_read, &num_read );
+            KLockUnlock( self->remote_lock );
+            if ( rc == 0 && num_read != to_read )
+                rc = RC ( rcFS, rcFile, rcReading, rcTransfer, rcIncomplete );
+        }
+
+        if ( rc == 0 )
+        {
+            size_t written;
+            rc = KFileWriteAll( self->local, pos, self->fill_buffer, to_read, &written );
+            if ( rc == 0 && written != to_read )
+                rc = RC ( rcFS, rcFile, rcWriting, rcTransfer, rcIncomplete );
+        }
+
+        {
+            rc_t rc2 = KLockAcquire( self->fill_lock );
+            if ( rc2 != 0 )
+                return rc2;
+        }
+
+        if ( rc == 0 )
+            rc = mark_bitmap( self, block, count );
+
+        if ( rc != 0 )
+        {
+            /* give up on this window, the reader will run into the same problem
+               on demand and report it */
+            if ( self->report )
+                OUTMSG(( "filler failed at %,lu.%,lu rc=%R\n", pos, to_read, rc ));
+            self->fill_end = self->fill_next;
+            rc = 0;
+        }
+        else if ( self->report )
+        {
+            OUTMSG(( "filler fetched blocks #%,lu..#%,lu\n", block, block + count - 1 ));
+        }
+    }
+
+    KLockUnlock( self->fill_lock );
+    return rc;
+}
+
+
+static void start_filler( KCacheTeeFile *self )
+{
+    self->fill_buffer = malloc( ( size_t ) self->fill_blocks * self->block_size );
+    if ( self->fill_buffer != NULL )
+    {
+        /* without a filler the cache works as before, on demand only */
+        rc_t rc = KThreadMake( &self->filler, KCacheTeeFileFiller, self );
+        if ( rc != 0 )
+        {
+            self->filler = NULL;
+            free( self->fill_buffer );
+            self->fill_buffer = NULL;
+        }
+    }
+}
+
+
+static void stop_filler( KCacheTeeFile *self )
+{
+    if ( self->filler != NULL )
+    {
+        if ( KLockAcquire( self->fill_lock ) == 0 )
+        {
+            self->fill_quit = true;
+            KConditionBroadcast( self->fill_cond );
+            KLockUnlock( self->fill_lock );
+        }
+        KThreadWait( self->filler, NULL );
+        KThreadRelease( self->filler );
+        self->filler = NULL;
+    }
+    if ( self->fill_buffer != NULL )
+    {
+        free( self->fill_buffer );
+        self->fill_buffer = NULL;
+    }
+}
+
+
+/* called with fill_lock held after every successful read:
+   a sequential reader moves the fill-window ahead of itself */
+static void schedule_read_ahead( KCacheTeeFile *self, uint64_t pos, size_t num_read )
+{
+    if ( num_read > 0 )
+    {
+        uint64_t end_pos = pos + num_read;
+        uint64_t next_block = SIZE_2_BLOCK_COUNT( end_pos, self->block_size );
+        if ( pos == self->last_read_end && next_block < self->block_count )
+        {
+            uint64_t end_block = next_block + self->read_ahead;
+            if ( end_block > self->block_count )
+                end_block = self->block_count;
+            if ( self->fill_next < next_block || self->fill_next > end_block )
+                self->fill_next = next_block;
+            self->fill_end = end_block;
+            KConditionSignal( self->fill_cond );
+        }
+        self->last_read_end = end_pos;
+    }
+}
+
+
+/* a read-only cache-tee opened while another process held the lock:
+   periodically try to take over the lock, if the other process is gone
+   and has left the cache-file unpromoted we become the writer */
+static void try_take_over( KCacheTeeFile *self )
+{
+    KLockFile *lock;
+    rc_t rc;
+
+    if ( ++self->misses_since_upgrade < CACHE_TEE_UPGRADE_INTERVAL )
+        return;
+    self->misses_since_upgrade = 0;
+
+    rc = KDirectoryCreateLockFile ( self->dir, &lock, "%s.cache.lock", self->local_path );
+    if ( rc == 0 )
+    {
+        KFile *local;
+        rc = KDirectoryOpenFileWrite( self->dir, &local, true, "%s.cache", self->local_path );
+        if ( rc == 0 )
+        {
+            uint64_t local_size;
+            size_t num_read;
+            rc = KFileSize( local, &local_size );
+            if ( rc == 0 && local_size != self->local_size )
+                rc = RC ( rcFS, rcFile, rcOpening, rcSize, rcIncorrect );
+            if ( rc == 0 )
+                rc = KFileReadAll( local, self->remote_size, self->bitmap, self->bitmap_bytes, &num_read );
+            if ( rc == 0 && num_read != self->bitmap_bytes )
+                rc = RC ( rcFS, rcFile, rcOpening, rcTransfer, rcIncomplete );
+            /* a reader fetching a miss uses local and local_read_only under remote_lock */
+            if ( rc == 0 )
+                rc = KLockAcquire( self->remote_lock );
+            if ( rc == 0 )
+            {
+                if ( self->report )
+                    OUTMSG(( "took over cache-file '%s.cache'\n", self->local_path ));
+                KFileRelease( self->local );
+                self->local = local;
+                self->lock = lock;
+                self->local_read_only = false;
+                self->shared = false;
+                KLockUnlock( self->remote_lock );
+                start_filler( self );
+                return;
+            }
+            KFileRelease( local );
+        }
+        KLockFileRelease ( lock );
+
+        /* the cache-file has been promoted or cannot be written: stop trying */
+        self->shared = false;
+    }
+}
+
+
+static void share_cache( KCacheTeeFile *self, uint64_t first_req_block, uint64_t req_blocks )
+{
+    refresh_bitmap( self, first_req_block, req_blocks );
+    if ( !( IS_CACHE_BIT( self, first_req_block ) ) )
+        try_take_over( self );
+}
+
 #if 0
 static rc_t KCacheTeeFileRead_Starting_with_Cache_Hit( const KCacheTeeFile *cself, uint64_t pos,
                                void *buffer, size_t bsize, size_t *num_read, uint64_t first_requested_block )
@@ -1024,20 +1344,14 @@ static uint64_t calc_req_blocks( uint64_t pos, uint64_t first_req_block, size_t
     return res;
 }
 
-static rc_t KCacheTeeFileRead_simple_cached( const KCacheTeeFile *cself, uint64_t pos,
-                                             void *buffer, size_t bsize, size_t *num_read, uint64_t first_req_block )
+/* called with fill_lock held: how many blocks from first_req_block on
+   up to req_blocks are in the same state ( cached or not ) as the first one */
+static uint64_t count_blocks_alike( const KCacheTeeFile *cself, uint64_t first_req_block,
+                                    uint64_t req_blocks, bool cached )
 {
-    rc_t rc = 0;
-    bool found_in_scratch = false;
-    size_t to_read;
-    size_t block_count = 1;
-    uint64_t req_blocks = calc_req_blocks( pos, first_req_block, bsize, cself->block_size );
-
-    /* we read as much as we have from the local cache, forcing the caller
-       to eventually make another request ( the non-cached part of it ) afterwards */
+    uint64_t block_count = 1;
     if ( req_blocks > 1 )
     {
-        /* detect how many blocks are in cache after the first_req_block */
         uint64_t block = first_req_block;
         block_count = 0;
         do
@@ -1045,93 +1359,53 @@ static rc_t KCacheTeeFileRead_simple_cached( const KCacheTeeFile *cself, uint64_
             block++;
             block_count++;
         }
-        while ( ( block_count < req_blocks ) && ( IS_CACHE_BIT( cself, block ) ) );
+        while ( ( block_count < req_blocks ) && ( ( IS_CACHE_BIT( cself, block ) ) == cached ) );
     }
+    return block_count;
+}
 
-    /* check if we eventually have the requested bytes in the scratch-buffer */
-    if ( cself -> first_block_in_scratch == first_req_block )
-    {
-        uint64_t first_pos_in_scratch = first_req_block;
-        first_pos_in_scratch *= cself->block_size;
-        if ( pos >= first_pos_in_scratch )
-        {
-            uint64_t last_pos_in_scratch = first_pos_in_scratch;
-            last_pos_in_scratch += cself -> valid_scratch_bytes;
-            found_in_scratch = ( pos < last_pos_in_scratch );
-            if ( found_in_scratch )
-            {
-                uint64_t available_in_scratch = ( last_pos_in_scratch - pos );
-                if ( bsize > available_in_scratch )
-                    to_read = available_in_scratch;
-                else
-                    to_read = bsize;
-
-                memmove ( buffer, &( cself->scratch_buffer[ pos - first_pos_in_scratch ] ), to_read );
-                *num_read = to_read;
-            }
-        }
-    }
-
-    if ( !found_in_scratch )
-    {
-        /* now we have to check how much of the request can be satisfied from the local file */
-        uint64_t reachable = first_req_block;
-        reachable += block_count;
-        reachable *= cself->block_size;
-        reachable -= pos;
-
-        /* are we requesting beyond the end of file? */
-        if ( reachable >= bsize )
-            to_read = check_rd_len( cself, pos, bsize );
-        else
-            to_read = check_rd_len( cself, pos, reachable );
-
-        rc = KFileReadAll( cself->local, pos, buffer, to_read, num_read );
-    }
+static rc_t KCacheTeeFileRead_simple_cached( const KCacheTeeFile *cself, const KFile *local, uint64_t pos,
+                                             void *buffer, size_t bsize, size_t *num_read,
+                                             uint64_t first_req_block, uint64_t block_count )
+{
+    /* we read as much as we have from the local cache, forcing the caller
+       to eventually make another request ( the non-cached part of it ) afterwards */
+    size_t to_read;
+    uint64_t reachable = first_req_block;
+    reachable += block_count;
+    reachable *= cself->block_size;
+    reachable -= pos;
+
+    /* are we requesting beyond the end of file? */
+    if ( reachable >= bsize )
+        to_read = check_rd_len( cself, pos, bsize );
+    else
+        to_read = check_rd_len( cself, pos, reachable );
 
-    return rc;
+    return KFileReadAll( local, pos, buffer, to_read, num_read );
 }
 
 
-static rc_t KCacheTeeFileRead_simple_not_cached( const KCacheTeeFile *cself, uint64_t pos,
-                                                 void *buffer, size_t bsize, size_t *num_read, uint64_t first_req_block )
+static rc_t KCacheTeeFileRead_simple_not_cached( KCacheTeeFile *self, uint64_t pos,
+                                                 void *buffer, size_t bsize, size_t *num_read,
+                                                 uint64_t first_req_block, uint64_t block_count )
 {
-    rc_t rc;
-    size_t to_read_remote;
-    size_t block_count = 1;
-    uint64_t req_blocks = calc_req_blocks( pos, first_req_block, bsize, cself->block_size );
-
-    if ( req_blocks >  1 )
-    {
-        uint64_t block = first_req_block;
-        block_count = 0;
-        do
-        {
-            block++;
-            block_count++;
-        }
-        while ( ( block_count < req_blocks ) && ( !( IS_CACHE_BIT( cself, block ) ) ) );
-    }
+    bool marked;
+    size_t to_read_remote = ( block_count * self->block_size );
+    rc_t rc = KLockAcquire( self->remote_lock );
+    if ( rc != 0 )
+        return rc;
 
-    to_read_remote = ( block_count * cself->block_size );
-    rc = resize_scratch_buffer( cself, to_read_remote );
+    /* local_read_only can only change while remote_lock is held */
+    marked = !self->local_read_only;
+    rc = resize_scratch_buffer( self, to_read_remote );
     if ( rc == 0 )
     {
         size_t l_num_read;
         uint64_t block_start = first_req_block;
-        block_start *= cself->block_size;
-        to_read_remote = check_rd_len( cself, block_start, to_read_remote );
-        rc = rd_remote_wr_local( cself, block_start, cself->scratch_buffer, to_read_remote, &l_num_read );
-        if ( rc == 0 )
-        {
-            ( ( KCacheTeeFile * )cself ) -> first_block_in_scratch = first_req_block;
-            ( ( KCacheTeeFile * )cself ) -> valid_scratch_bytes = l_num_read;
-            if ( !cself->local_read_only )
-            {
-                set_bitmap( cself, first_req_block, block_count );
-                rc = write_bitmap( cself, first_req_block, block_count );
-            }
-        }
+        block_start *= self->block_size;
+        to_read_remote = check_rd_len( self, block_start, to_read_remote );
+        rc = rd_remote_wr_local( self, block_start, self->scratch_buffer, to_read_remote, &l_num_read );
         if ( rc == 0 )
         {
             /* what we have to return to the caller is somewhere in the scratch_buffer */
@@ -1145,7 +1419,7 @@ static rc_t KCacheTeeFileRead_simple_not_cached( const KCacheTeeFile *cself, uin
                 l_num_read -= offset;
                 if ( l_num_read > bsize )
                     l_num_read = bsize;
-                memmove ( buffer, &( cself->scratch_buffer[ offset ] ), l_num_read );
+                memmove ( buffer, &( self->scratch_buffer[ offset ] ), l_num_read );
             }
             else
             {
@@ -1154,38 +1428,70 @@ static rc_t KCacheTeeFileRead_simple_not_cached( const KCacheTeeFile *cself, uin
             *num_read = l_num_read;
         }
     }
+    KLockUnlock( self->remote_lock );
+
+    /* the content is in the local file, now its bits can be set */
+    if ( rc == 0 && marked )
+    {
+        rc = KLockAcquire( self->fill_lock );
+        if ( rc == 0 )
+        {
+            rc = mark_bitmap( self, first_req_block, block_count );
+            KLockUnlock( self->fill_lock );
+        }
+    }
     return rc;
 }
 
 
-static rc_t KCacheTeeFileRead_simple( const KCacheTeeFile *cself, uint64_t pos,
+static rc_t KCacheTeeFileRead_simple( KCacheTeeFile *self, uint64_t pos,
                                       void *buffer, size_t bsize, size_t *num_read )
 {
     rc_t rc;
+    bool cached;
+    uint64_t block_count;
+    const KFile *local;
     uint64_t first_req_block = pos;
-    first_req_block /= cself->block_size;
+    first_req_block /= self->block_size;
 
     *num_read = 0;
-    if ( cself->report )
+    if ( self->report )
         OUTMSG(( "\nREQUEST '%s': %,lu .[%,lu] ( first_req_block=%,lu )\n",
-                 cself->local_path, pos, bsize, first_req_block ));
+                 self->local_path, pos, bsize, first_req_block ));
 
-    /* "simple" strategy, read only that much as requested... */
-    if ( IS_CACHE_BIT( cself, first_req_block ) )
-    {
-        rc = KCacheTeeFileRead_simple_cached( cself, pos, buffer, bsize, num_read, first_req_block );
-    }
-    else
-    {
-        rc = KCacheTeeFileRead_simple_not_cached( cself, pos, buffer, bsize, num_read, first_req_block );
-    }
+    /* nothing to read at or beyond the end, and no bit in the bitmap to look at */
+    if ( pos >= self->remote_size )
+        return 0;
 
-    if ( cself->logger != NULL )
+    /* look at the bitmap, but do not hold fill_lock while reading
+       the local or the remote file */
+    rc = KLockAcquire( self->fill_lock );
+    if ( rc != 0 )
+        return rc;
     {
-        KCacheTeeFile * self = ( KCacheTeeFile * ) cself;
-        log_to_file( self->logger, &self->log_file_pos, pos, bsize, *num_read );
+        uint64_t req_blocks = calc_req_blocks( pos, first_req_block, bsize, self->block_size );
+        if ( self->shared && !( IS_CACHE_BIT( self, first_req_block ) ) )
+            share_cache( self, first_req_block, req_blocks );
+
+        cached = IS_CACHE_BIT( self, first_req_block );
+        block_count = count_blocks_alike( self, first_req_block, req_blocks, cached );
     }
+    /* a take-over can replace the local file */
+    local = self->local;
+    rc = KFileAddRef( local );
+    KLockUnlock( self->fill_lock );
+    if ( rc != 0 )
+        return rc;
+
+    /* "simple" strategy, read only that much as requested... */
+    if ( cached )
+        rc = KCacheTeeFileRead_simple_cached( self, local, pos, buffer, bsize, num_read,
+                                              first_req_block, block_count );
+    else
+        rc = KCacheTeeFileRead_simple_not_cached( self, pos, buffer, bsize, num_read,
+                                                  first_req_block, block_count );
 
+    KFileRelease( local );
     return rc;
 }
 
@@ -1229,7 +1535,17 @@ static rc_t KCacheTeeFileRead( const KCacheTeeFile *cself, uint64_t pos,
         return KCacheTeeFileRead_simple( cself, pos, buffer, bsize, num_read );
     */
 
-    return KCacheTeeFileRead_simple( cself, pos, buffer, bsize, num_read );
+    KCacheTeeFile *self = ( KCacheTeeFile * ) cself;
+    rc_t rc = KCacheTeeFileRead_simple( self, pos, buffer, bsize, num_read );
+    if ( KLockAcquire( self->fill_lock ) == 0 )
+    {
+        if ( rc == 0 && self->filler != NULL )
+            schedule_read_ahead( self, pos, *num_read );
+        if ( self->logger != NULL )
+            log_to_file( self->logger, &self->log_file_pos, pos, bsize, *num_read );
+        KLockUnlock( self->fill_lock );
+    }
+    return rc;
 }
 
 
@@ -1263,7 +1579,7 @@ static KFile_vt_v1 vtKCacheTeeFile =
 
 static rc_t make_cache_tee( struct KDirectory *self, struct KFile const **tee,
     struct KFile const *remote, struct KFile *local, struct KFile *logger, KLockFile *lock,
-    uint32_t blocksize, uint32_t cluster, bool report, const char *path )
+    uint32_t blocksize, uint32_t cluster, bool report, bool shared, const char *path )
 {
     rc_t rc;
     size_t path_size = string_size ( path );
@@ -1285,8 +1601,19 @@ static rc_t make_cache_tee( struct KDirectory *self, struct KFile const **tee,
         cf -> bitmap = NULL;
         cf -> scratch_buffer = NULL;
         cf -> scratch_size = 0;
-        cf -> first_block_in_scratch = 0;
-        cf -> valid_scratch_bytes = 0;
+        cf -> shared = shared;
+        cf -> fill_lock = NULL;
+        cf -> remote_lock = NULL;
+        cf -> fill_cond = NULL;
+        cf -> filler = NULL;
+        cf -> fill_buffer = NULL;
+        cf -> fill_quit = false;
+        cf -> last_read_end = 0;
+        cf -> fill_next = cf -> fill_end = 0;
+        cf -> dirty_first = cf -> dirty_last = cf -> dirty_count = 0;
+        cf -> misses_since_upgrade = 0;
+        cf -> read_ahead = CACHE_TEE_READ_AHEAD_BLOCKS * ( cluster > 1 ? cluster : 1 );
+        cf -> fill_blocks = CACHE_TEE_FILL_BLOCKS * ( cluster > 1 ? cluster : 1 );
 
         rc = KFileSize( local, &cf -> local_size );
         if ( rc != 0 )
@@ -1365,11 +1692,21 @@ static rc_t make_cache_tee( struct KDirectory *self, struct KFile const **tee,
                         {
                             if ( cf -> logger != NULL )
                                 rc = KFileAddRef( cf -> logger );
+                            if ( rc == 0 )
+                                rc = KLockMake ( &cf -> fill_lock );
+                            if ( rc == 0 )
+                                rc = KLockMake ( &cf -> remote_lock );
+                            if ( rc == 0 )
+                                rc = KConditionMake ( &cf -> fill_cond );
                             if ( rc == 0 )
                             {
                                 rc = KFileInit( &cf -> dad, (const union KFile_vt *)&vtKCacheTeeFile, "KCacheTeeFile", path, true, false );
                                 if ( rc == 0 )
                                 {
+                                    /* only the holder of the lock fills the local file in the background */
+                                    if ( !cf -> local_read_only && cf -> lock != NULL )
+                                        start_filler( cf );
+
                                     /* the wrapper is ready to use now! */
                                     *tee = ( const KFile * ) &cf -> dad;
                                     return 0;
@@ -1377,6 +1714,9 @@ static rc_t make_cache_tee( struct KDirectory *self, struct KFile const **tee,
                                 else
                                 {
                                     LOGERR( klogErr, rc, "cannot initialize KFile-structure" );
+                                    KConditionRelease( cf -> fill_cond );
+                                    KLockRelease( cf -> remote_lock );
+                                    KLockRelease( cf -> fill_lock );
                                     KFileRelease( cf -> logger );
                                     KFileRelease( cf -> local );
                                     KFileRelease( cf -> remote );
@@ -1385,6 +1725,9 @@ static rc_t make_cache_tee( struct KDirectory *self, struct KFile const **tee,
                             }
                             else
                             {
+                                KConditionRelease( cf -> fill_cond );
+                                KLockRelease( cf -> remote_lock );
+                                KLockRelease( cf -> fill_lock );
                                 KFileRelease( cf -> local );
                                 KFileRelease( cf -> remote );
                                 KDirectoryRelease ( cf -> dir );
@@ -1409,7 +1752,7 @@ static rc_t make_cache_tee( struct KDirectory *self, struct KFile const **tee,
 
 static rc_t make_read_only_cache_tee( struct KDirectory *self,
     struct KFile const **tee, struct KFile const *remote, struct KFile *logger,
-    uint32_t blocksize, uint32_t cluster, bool report, const char *path )
+    uint32_t blocksize, uint32_t cluster, bool report, bool shared, const char *path )
 {
     const struct KFile * local;
     rc_t rc = KDirectoryOpenFileRead( self, &local, "%s.cache", path );
@@ -1419,7 +1762,7 @@ static rc_t make_read_only_cache_tee( struct KDirectory *self,
             KOutMsg( "successfuly opened cache file '%s.cache' in read/only-mode\n",
                       path );
         rc = make_cache_tee( self, tee, remote, ( struct KFile * )local, logger, NULL,
-                             blocksize, cluster, report, path );
+                             blocksize, cluster, report, shared, path );
     }
     else
     {
@@ -1492,7 +1835,7 @@ LIB_EXPORT rc_t CC KDirectoryVMakeCacheTee ( struct KDirectory *self,
 
                         /* we have the exclusive rd/wr access to the cache file !*/
                         rc = make_cache_tee( self, tee, remote, local, logger, lock,
-                                             blocksize, cluster, report, full );
+                                             blocksize, cluster, report, false, full );
                     }
                     else if ( GetRCState( rc ) == rcNotFound )
                     {
@@ -1503,7 +1846,7 @@ LIB_EXPORT rc_t CC KDirectoryVMakeCacheTee ( struct KDirectory *self,
                                 KOutMsg( "cache-file '%s.cache' created with rd/wr-access\n", full );
                             /* we have the exclusive rd/wr access to the cache file !*/
                             rc = make_cache_tee( self, tee, remote, local, logger, lock,
-                                                 blocksize, cluster, report, full );
+                                                 blocksize, cluster, report, false, full );
                         }
                     }
                     else
@@ -1515,7 +1858,7 @@ LIB_EXPORT rc_t CC KDirectoryVMakeCacheTee ( struct KDirectory *self,
                         rc = KLockFileRelease ( lock );
                         if ( rc == 0 )
                             rc = make_read_only_cache_tee( self, tee, remote, logger,
-                                    blocksize, cluster, report, full );
+                                    blocksize, cluster, report, false, full );
                     }
                 }
                 else if ( GetRCState ( rc ) == rcBusy )
@@ -1523,9 +1866,10 @@ LIB_EXPORT rc_t CC KDirectoryVMakeCacheTee ( struct KDirectory *self,
                     if ( report )
                         KOutMsg( "failed to aquired lockfile '%s.cache.lock'\n", full );
 
-                    /* it was NOT possible to aquire the lock on the cache-file */
+                    /* it was NOT possible to aquire the lock on the cache-file:
+                       share the blocks the lock-holder fetches */
                     rc = make_read_only_cache_tee( self, tee, remote, logger,
-                            blocksize, cluster, report, full );
+                            blocksize, cluster, report, true, full );
                 }
                 else
                 {
@@ -35,9 +35,12 @@ struct KGZipFile;
 #include <klib/out.h>
 #include <sysalloc.h>
 
+#include "pzip-priv.h" /* KParZipFileMake */
+
 #include <zlib.h>      /* z_stream */
 #include <assert.h>
 #include <stdlib.h>    /* malloc */
+#include <string.h>    /* memset */
 
 #ifdef _DEBUGGING
 #define GZIP_DEBUG(msg) DBGMSG(DBG_KFS,DBG_FLAG(DBG_KFS_GZIP), msg)
@@ -580,4 +583,56 @@ static int s_GzipAndWrite ( KGZipFile *self,
     return ret;
 }
 
+/***************************************************************************************/
+/* Parallel Gzip Output File                                                           */
+/***************************************************************************************/
+
+/* each chunk becomes a complete gzip member with its own header and trailer */
+static size_t CC s_GzipBound(size_t ssize)
+{
+    /* gzip header and trailer are 12 bytes larger than zlib's */
+    return compressBound((uLong) ssize) + 12;
+}
+
+static rc_t CC s_GzipChunk(void *dst,
+    size_t dsize,
+    size_t *num_writ,
+    const void *src,
+    size_t ssize)
+{
+    z_stream strm;
+    int ret;
+
+    memset(&strm, 0, sizeof strm);
+    if (deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, WINDOW_BITS,
+        8, /* The default value for the memLevel parameter is 8 */
+        Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        return RC ( rcFS, rcFile, rcWriting, rcNoObj, rcUnknown );
+    }
+
+    strm.next_in   = (Bytef*) src;
+    strm.avail_in  = (uInt) ssize;
+    strm.next_out  = (Bytef*) dst;
+    strm.avail_out = (uInt) dsize;
+
+    ret = deflate(&strm, Z_FINISH);
+    *num_writ = dsize - strm.avail_out;
+    deflateEnd(&strm);
+
+    if (ret != Z_STREAM_END)
+        return RC ( rcFS, rcFile, rcWriting, rcBuffer, rcInsufficient );
+
+    return 0;
+}
+
+LIB_EXPORT rc_t CC KFileMakeParallelGzipForWrite( struct KFile **result,
+    struct KFile *file,
+    size_t chunk_size,
+    struct KParZipPool *pool )
+{
+    return KParZipFileMake(result, file, "KGZipFile",
+        chunk_size, pool, s_GzipBound, s_GzipChunk);
+}
+
 /* EOF */
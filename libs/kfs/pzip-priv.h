@@ -0,0 +1,103 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _h_pzip_priv_
+#define _h_pzip_priv_
+
+#ifndef _h_klib_defs_
+#include <klib/defs.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*--------------------------------------------------------------------------
+ * forwards
+ */
+struct KFile;
+struct KParZipPool;
+
+
+/*--------------------------------------------------------------------------
+ * KParZipFile
+ *  a write-only file that cuts its serial input into independent chunks,
+ *  has them compressed on the threads of a KParZipPool and writes the
+ *  compressed chunks to the destination in input order
+ *
+ *  each chunk must compress into a self-contained member of the format,
+ *  such that a concatenation of members is still a valid stream
+ */
+
+/* default chunk sizes and number of threads.
+   a bzip2 chunk shorter than the 900K block of level 9
+   would compress worse than the serial writer */
+#define KPZIP_DEFAULT_CHUNK_SIZE ( 256 * 1024 )
+#define KPZIP_BZIP2_CHUNK_SIZE ( 900 * 1024 )
+#define KPZIP_DEFAULT_THREADS 4
+
+/* Bound
+ *  returns the largest possible compressed size of "ssize" input bytes
+ */
+typedef size_t ( CC * KParZipBound ) ( size_t ssize );
+
+/* Compress
+ *  compress one chunk into a complete member
+ *
+ *  "dst" [ OUT ] and "dsize" [ IN ] - output buffer of at least
+ *  Bound ( "ssize" ) bytes
+ *
+ *  "num_writ" [ OUT ] - return parameter for compressed size
+ *
+ *  "src" [ IN ] and "ssize" [ IN ] - uncompressed chunk, may be empty
+ */
+typedef rc_t ( CC * KParZipCompress ) ( void *dst, size_t dsize,
+    size_t *num_writ, const void *src, size_t ssize );
+
+/* Make
+ *  creates the adapter
+ *
+ *  "pz" [ OUT ] - return parameter for new file
+ *
+ *  "dst" [ IN ] - compressed destination file with write permission
+ *
+ *  "classname" [ IN ] - class name for KFileInit
+ *
+ *  "chunk_size" [ IN ] - uncompressed bytes per member, 0 for default
+ *
+ *  "pool" [ IN, NULL OKAY ] - compression threads,
+ *  NULL for a pool of the default size used by this file alone
+ */
+rc_t KParZipFileMake ( struct KFile **pz, struct KFile *dst,
+    const char *classname, size_t chunk_size, struct KParZipPool *pool,
+    KParZipBound bound, KParZipCompress compress );
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _h_pzip_priv_ */
@@ -0,0 +1,718 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+struct KParZipFile;
+#define KFILE_IMPL struct KParZipFile
+
+#include <kfs/extern.h>
+#include <kfs/impl.h>
+#include <kfs/pzip.h>
+#include <kproc/thread.h>
+#include <kproc/lock.h>
+#include <kproc/cond.h>
+#include <klib/refcount.h>
+#include <klib/rc.h>
+#include <klib/log.h>
+#include <sysalloc.h>
+
+#include "pzip-priv.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct KParZipFile KParZipFile;
+
+/*--------------------------------------------------------------------------
+ * KParZipChunk
+ *  an uncompressed input buffer and its compressed image
+ *
+ *  a chunk cycles through the states
+ *    empty  -> owned by the writer while being filled
+ *    queued -> waiting in the pool for a worker
+ *    busy   -> being compressed by a worker or by its writer
+ *    done   -> waiting to be written to the destination in order
+ *
+ *  the buffers are allocated when the chunk starts to be filled
+ *  and freed when it has been written, so an idle file holds
+ *  no more than the chunk it is filling
+ */
+enum
+{
+    pzcEmpty,
+    pzcQueued,
+    pzcBusy,
+    pzcDone
+};
+
+typedef struct KParZipChunk KParZipChunk;
+struct KParZipChunk
+{
+    KParZipChunk *next;
+    KParZipFile *owner;
+    uint8_t *in;
+    uint8_t *out;
+    size_t in_size;
+    size_t out_size;
+    rc_t rc;
+    uint32_t state;
+};
+
+
+/*--------------------------------------------------------------------------
+ * KParZipPool
+ *  worker threads and a single queue of chunks from all of its files.
+ *  the pool lock also guards the state of every chunk of its files
+ */
+struct KParZipPool
+{
+    KLock *lock;
+    KCondition *work;
+
+    KThread **threads;
+    uint32_t num_threads;
+
+    /* queued chunks of all files, in queueing order */
+    KParZipChunk *head;
+    KParZipChunk *tail;
+
+    KRefcount refcount;
+    bool quit;
+};
+
+
+/* Worker
+ *  compresses queued chunks of any file until told to quit
+ */
+static
+rc_t CC KParZipPoolWorker ( const KThread *t, void *data );
+
+/* Compress
+ *  compresses a chunk taken off the queue
+ *  called while holding the lock, which is released meanwhile
+ */
+static void KParZipPoolCompress ( KParZipPool *self, KParZipChunk *c );
+
+/* Unlink
+ *  takes a queued chunk off the queue
+ *  called while holding the lock
+ */
+static
+void KParZipPoolUnlink ( KParZipPool *self, KParZipChunk *c )
+{
+    KParZipChunk *prev, *cur;
+
+    for ( prev = NULL, cur = self -> head; cur != NULL; prev = cur, cur = cur -> next )
+    {
+        if ( cur == c )
+        {
+            if ( prev == NULL )
+                self -> head = c -> next;
+            else
+                prev -> next = c -> next;
+            if ( self -> tail == c )
+                self -> tail = prev;
+            c -> next = NULL;
+            return;
+        }
+    }
+    assert ( ! "chunk is not queued" );
+}
+
+/* Whack
+ *  stops the workers
+ */
+static
+rc_t KParZipPoolWhack ( KParZipPool *self )
+{
+    uint32_t i;
+
+    if ( self -> threads != NULL )
+    {
+        KLockAcquire ( self -> lock );
+        assert ( self -> head == NULL );
+        self -> quit = true;
+        KConditionBroadcast ( self -> work );
+        KLockUnlock ( self -> lock );
+
+        for ( i = 0; i < self -> num_threads; ++ i )
+        {
+            KThreadWait ( self -> threads [ i ], NULL );
+            KThreadRelease ( self -> threads [ i ] );
+        }
+        free ( self -> threads );
+    }
+
+    KConditionRelease ( self -> work );
+    KLockRelease ( self -> lock );
+    free ( self );
+
+    return 0;
+}
+
+/* AddRef
+ * Release
+ */
+LIB_EXPORT rc_t CC KParZipPoolAddRef ( const KParZipPool *self )
+{
+    if ( self != NULL ) switch ( KRefcountAdd ( & self -> refcount, "KParZipPool" ) )
+    {
+    case krefOkay:
+        break;
+    default:
+        return RC ( rcFS, rcFile, rcAttaching, rcConstraint, rcViolated );
+    }
+
+    return 0;
+}
+
+LIB_EXPORT rc_t CC KParZipPoolRelease ( const KParZipPool *self )
+{
+    if ( self != NULL ) switch ( KRefcountDrop ( & self -> refcount, "KParZipPool" ) )
+    {
+    case krefOkay:
+        break;
+    case krefWhack:
+        return KParZipPoolWhack ( ( KParZipPool* ) self );
+    default:
+        return RC ( rcFS, rcFile, rcReleasing, rcConstraint, rcViolated );
+    }
+
+    return 0;
+}
+
+/* Make
+ */
+LIB_EXPORT rc_t CC KParZipPoolMake ( KParZipPool **pool, uint32_t num_threads )
+{
+    rc_t rc;
+    KParZipPool *obj;
+
+    if ( pool == NULL )
+        return RC ( rcFS, rcFile, rcConstructing, rcParam, rcNull );
+    * pool = NULL;
+
+    if ( num_threads == 0 )
+        num_threads = KPZIP_DEFAULT_THREADS;
+
+    obj = calloc ( 1, sizeof * obj );
+    if ( obj == NULL )
+        return RC ( rcFS, rcFile, rcConstructing, rcMemory, rcExhausted );
+
+    KRefcountInit ( & obj -> refcount, 1, "KParZipPool", "make", "pool" );
+
+    rc = KLockMake ( & obj -> lock );
+    if ( rc == 0 )
+    {
+        rc = KConditionMake ( & obj -> work );
+        if ( rc == 0 )
+        {
+            obj -> threads = calloc ( num_threads, sizeof obj -> threads [ 0 ] );
+            if ( obj -> threads == NULL )
+                rc = RC ( rcFS, rcFile, rcConstructing, rcMemory, rcExhausted );
+            else
+            {
+                /* running with fewer threads is fine,
+                   and with none the writers compress */
+                uint32_t i;
+                for ( i = 0; i < num_threads; ++ i )
+                {
+                    if ( KThreadMake ( & obj -> threads [ i ], KParZipPoolWorker, obj ) != 0 )
+                        break;
+                }
+                obj -> num_threads = i;
+
+                * pool = obj;
+                return 0;
+            }
+            KConditionRelease ( obj -> work );
+        }
+        KLockRelease ( obj -> lock );
+    }
+    free ( obj );
+
+    return rc;
+}
+
+
+/*--------------------------------------------------------------------------
+ * KParZipFile
+ */
+struct KParZipFile
+{
+    KFile dad;
+    KFile *file;
+    uint64_t filePosition;
+    uint64_t myPosition;
+
+    KParZipPool *pool;
+
+    /* signaled when a chunk of this file is done */
+    KCondition *done;
+
+    KParZipBound bound;
+    KParZipCompress compress;
+    size_t chunk_size;
+    size_t out_size;
+
+    KParZipChunk *chunks;
+    uint32_t num_chunks;
+
+    /* chunk sequence numbers:
+       chunks in [ write_seq, fill_seq ) are queued, busy or done,
+       chunk fill_seq is being filled */
+    uint64_t write_seq;
+    uint64_t fill_seq;
+
+    /* sticky error from any worker or from the destination */
+    rc_t rc;
+};
+
+
+static
+void KParZipPoolCompress ( KParZipPool *self, KParZipChunk *c )
+{
+    rc_t rc;
+    KParZipFile *owner = c -> owner;
+
+    c -> state = pzcBusy;
+    KLockUnlock ( self -> lock );
+
+    rc = ( * owner -> compress ) ( c -> out, owner -> out_size,
+        & c -> out_size, c -> in, c -> in_size );
+
+    KLockAcquire ( self -> lock );
+    c -> rc = rc;
+    c -> state = pzcDone;
+    KConditionBroadcast ( owner -> done );
+}
+
+static
+rc_t CC KParZipPoolWorker ( const KThread *t, void *data )
+{
+    KParZipPool *self = data;
+
+    KLockAcquire ( self -> lock );
+    while ( 1 )
+    {
+        KParZipChunk *c;
+
+        while ( ! self -> quit && self -> head == NULL )
+            KConditionWait ( self -> work, self -> lock );
+        if ( self -> quit )
+            break;
+
+        c = self -> head;
+        KParZipPoolUnlink ( self, c );
+        assert ( c -> state == pzcQueued );
+
+        KParZipPoolCompress ( self, c );
+    }
+    KLockUnlock ( self -> lock );
+
+    return 0;
+}
+
+
+/* WriteChunk
+ *  writes out a compressed chunk
+ *  called by the writer without holding the lock
+ */
+static
+rc_t KParZipFileWriteChunk ( KParZipFile *self, KParZipChunk *c )
+{
+    rc_t rc;
+    size_t num_writ;
+
+    rc = c -> rc;
+    if ( rc == 0 )
+    {
+        rc = KFileWriteAll ( self -> file, self -> filePosition,
+            c -> out, c -> out_size, & num_writ );
+        if ( rc == 0 && num_writ != c -> out_size )
+            rc = RC ( rcFS, rcFile, rcWriting, rcTransfer, rcIncomplete );
+        self -> filePosition += num_writ;
+    }
+    return rc;
+}
+
+/* Drain
+ *  writes out every chunk that is done in order and
+ *  makes progress on the pipeline until chunk "seq" is reusable,
+ *  i.e. every chunk before it has been written out
+ *  called by the writer while holding the lock
+ */
+static
+rc_t KParZipFileDrain ( KParZipFile *self, uint64_t seq )
+{
+    rc_t rc = self -> rc;
+
+    while ( rc == 0 && self -> write_seq < self -> fill_seq )
+    {
+        KParZipChunk *c = & self -> chunks [ self -> write_seq % self -> num_chunks ];
+
+        if ( c -> state == pzcDone )
+        {
+            KLockUnlock ( self -> pool -> lock );
+            rc = KParZipFileWriteChunk ( self, c );
+            KLockAcquire ( self -> pool -> lock );
+
+            free ( c -> in );
+            c -> in = c -> out = NULL;
+            c -> in_size = 0;
+            c -> state = pzcEmpty;
+            ++ self -> write_seq;
+        }
+        else if ( self -> write_seq + self -> num_chunks > seq )
+        {
+            /* nothing has to be waited for */
+            break;
+        }
+        else if ( c -> state == pzcQueued )
+        {
+            /* the workers are busy with other chunks
+               or there are none: compress in line */
+            KParZipPoolUnlink ( self -> pool, c );
+            KParZipPoolCompress ( self -> pool, c );
+        }
+        else
+        {
+            KConditionWait ( self -> done, self -> pool -> lock );
+        }
+    }
+
+    if ( rc != 0 && self -> rc == 0 )
+        self -> rc = rc;
+
+    return rc;
+}
+
+/* Queue
+ *  hands the chunk being filled to the pool
+ *  and makes sure the next one is available
+ */
+static
+rc_t KParZipFileQueue ( KParZipFile *self )
+{
+    rc_t rc;
+    KParZipPool *pool = self -> pool;
+    KParZipChunk *c = & self -> chunks [ self -> fill_seq % self -> num_chunks ];
+
+    KLockAcquire ( pool -> lock );
+
+    c -> state = pzcQueued;
+    c -> next = NULL;
+    if ( pool -> tail == NULL )
+        pool -> head = c;
+    else
+        pool -> tail -> next = c;
+    pool -> tail = c;
+    ++ self -> fill_seq;
+    KConditionSignal ( pool -> work );
+
+    rc = KParZipFileDrain ( self, self -> fill_seq );
+
+    KLockUnlock ( pool -> lock );
+
+    return rc;
+}
+
+/* Cancel
+ *  takes the chunks of a failed file off the queue
+ *  and waits for those being compressed
+ *  called by the writer while holding the lock
+ */
+static
+void KParZipFileCancel ( KParZipFile *self )
+{
+    uint32_t i;
+
+    for ( i = 0; i < self -> num_chunks; ++ i )
+    {
+        KParZipChunk *c = & self -> chunks [ i ];
+        if ( c -> state == pzcQueued )
+        {
+            KParZipPoolUnlink ( self -> pool, c );
+            c -> state = pzcEmpty;
+        }
+        while ( c -> state == pzcBusy )
+            KConditionWait ( self -> done, self -> pool -> lock );
+    }
+}
+
+
+/* Destroy
+ *  compresses and writes anything outstanding
+ *  and releases resources
+ */
+static
+rc_t CC KParZipFileDestroy ( KParZipFile *self )
+{
+    rc_t rc = 0;
+    uint32_t i;
+
+    if ( self -> chunks != NULL )
+    {
+        KParZipChunk *c = & self -> chunks [ self -> fill_seq % self -> num_chunks ];
+
+        /* an empty input still produces one valid, empty member */
+        if ( self -> rc == 0 && c -> in != NULL && ( c -> in_size != 0 || self -> fill_seq == 0 ) )
+            rc = KParZipFileQueue ( self );
+
+        KLockAcquire ( self -> pool -> lock );
+        if ( rc == 0 )
+        {
+            /* every chunk before fill_seq has been written
+               once chunk fill_seq + num_chunks - 1 is reusable */
+            rc = KParZipFileDrain ( self, self -> fill_seq + self -> num_chunks - 1 );
+        }
+        KParZipFileCancel ( self );
+        KLockUnlock ( self -> pool -> lock );
+
+        for ( i = 0; i < self -> num_chunks; ++ i )
+            free ( self -> chunks [ i ] . in );
+    }
+
+    if ( rc == 0 )
+        rc = self -> rc;
+
+    KConditionRelease ( self -> done );
+    KParZipPoolRelease ( self -> pool );
+    KFileRelease ( self -> file );
+    free ( self -> chunks );
+    free ( self );
+
+    return rc;
+}
+
+static
+struct KSysFile* CC KParZipFileGetSysFile ( const KParZipFile *self, uint64_t *offset )
+{
+    * offset = 0;
+    return NULL;
+}
+
+static
+rc_t CC KParZipFileRandomAccess ( const KParZipFile *self )
+{
+    return RC ( rcFS, rcFile, rcAccessing, rcFunction, rcUnsupported );
+}
+
+static
+uint32_t CC KParZipFileType ( const KParZipFile *self )
+{
+    return KFileType ( self -> file );
+}
+
+static
+rc_t CC KParZipFileSize ( const KParZipFile *self, uint64_t *size )
+{
+    * size = 0;
+    return RC ( rcFS, rcFile, rcAccessing, rcFunction, rcUnsupported );
+}
+
+static
+rc_t CC KParZipFileSetSize ( KParZipFile *self, uint64_t size )
+{
+    return RC ( rcFS, rcFile, rcUpdating, rcFunction, rcUnsupported );
+}
+
+static
+rc_t CC KParZipFileRead ( const KParZipFile *self, uint64_t pos,
+    void *buffer, size_t bsize, size_t *num_read )
+{
+    * num_read = 0;
+    return RC ( rcFS, rcFile, rcReading, rcFunction, rcUnsupported );
+}
+
+/* Alloc
+ *  gives an empty chunk its buffers
+ */
+static
+rc_t KParZipChunkAlloc ( KParZipFile *self, KParZipChunk *c )
+{
+    assert ( c -> state == pzcEmpty && c -> in == NULL );
+
+    c -> in = malloc ( self -> chunk_size + self -> out_size );
+    if ( c -> in == NULL )
+        return RC ( rcFS, rcFile, rcWriting, rcMemory, rcExhausted );
+    c -> out = c -> in + self -> chunk_size;
+    c -> in_size = 0;
+    c -> owner = self;
+
+    return 0;
+}
+
+static
+rc_t CC KParZipFileWrite ( KParZipFile *self, uint64_t pos,
+    const void *buffer, size_t size, size_t *num_writ )
+{
+    rc_t rc;
+    size_t total;
+    const uint8_t *src = buffer;
+
+    * num_writ = 0;
+
+    if ( pos != self -> myPosition )
+        return RC ( rcFS, rcFile, rcWriting, rcParam, rcInvalid );
+
+    rc = self -> rc;
+    for ( total = 0; rc == 0 && total < size; )
+    {
+        size_t to_copy;
+        KParZipChunk *c = & self -> chunks [ self -> fill_seq % self -> num_chunks ];
+
+        if ( c -> in == NULL )
+        {
+            rc = KParZipChunkAlloc ( self, c );
+            if ( rc != 0 )
+                break;
+        }
+
+        to_copy = self -> chunk_size - c -> in_size;
+        if ( to_copy > size - total )
+            to_copy = size - total;
+
+        memcpy ( c -> in + c -> in_size, src + total, to_copy );
+        c -> in_size += to_copy;
+        total += to_copy;
+
+        if ( c -> in_size == self -> chunk_size )
+            rc = KParZipFileQueue ( self );
+    }
+
+    * num_writ = total;
+    self -> myPosition += total;
+
+    return rc;
+}
+
+static KFile_vt_v1 vtKParZipFile =
+{
+    /* version 1.1 */
+    1, 1,
+
+    /* start minor version 0 methods */
+    KParZipFileDestroy,
+    KParZipFileGetSysFile,
+    KParZipFileRandomAccess,
+    KParZipFileSize,
+    KParZipFileSetSize,
+    KParZipFileRead,
+    KParZipFileWrite,
+    /* end minor version 0 methods */
+
+    /* start minor version == 1 */
+    KParZipFileType
+    /* end minor version == 1 */
+};
+
+
+/* Make
+ */
+rc_t KParZipFileMake ( KFile **pz, KFile *dst,
+    const char *classname, size_t chunk_size, KParZipPool *pool,
+    KParZipBound bound, KParZipCompress compress )
+{
+    rc_t rc;
+    KParZipFile *obj;
+
+    if ( pz == NULL )
+        return RC ( rcFS, rcFile, rcConstructing, rcParam, rcNull );
+    * pz = NULL;
+
+    if ( dst == NULL || bound == NULL || compress == NULL )
+        return RC ( rcFS, rcFile, rcConstructing, rcParam, rcNull );
+
+    if ( chunk_size == 0 )
+        chunk_size = KPZIP_DEFAULT_CHUNK_SIZE;
+
+    obj = calloc ( 1, sizeof * obj );
+    if ( obj == NULL )
+        return RC ( rcFS, rcFile, rcConstructing, rcMemory, rcExhausted );
+
+    if ( pool == NULL )
+        rc = KParZipPoolMake ( & obj -> pool, 0 );
+    else
+    {
+        rc = KParZipPoolAddRef ( pool );
+        if ( rc == 0 )
+            obj -> pool = pool;
+    }
+    if ( rc != 0 )
+    {
+        free ( obj );
+        return rc;
+    }
+
+    rc = KFileInit ( & obj -> dad, ( const KFile_vt* ) & vtKParZipFile,
+        classname, "no-name", false, true );
+    if ( rc != 0 )
+    {
+        KParZipPoolRelease ( obj -> pool );
+        free ( obj );
+        return rc;
+    }
+
+    obj -> bound = bound;
+    obj -> compress = compress;
+    obj -> chunk_size = chunk_size;
+    obj -> out_size = ( * bound ) ( chunk_size );
+
+    rc = KFileAddRef ( dst );
+    if ( rc == 0 )
+    {
+        obj -> file = dst;
+
+        rc = KConditionMake ( & obj -> done );
+        if ( rc == 0 )
+        {
+            /* two chunks per thread keep every worker busy
+               while the writer fills and drains */
+            obj -> num_chunks = obj -> pool -> num_threads * 2;
+            if ( obj -> num_chunks < 2 )
+                obj -> num_chunks = 2;
+            obj -> chunks = calloc ( obj -> num_chunks, sizeof obj -> chunks [ 0 ] );
+            if ( obj -> chunks == NULL )
+                rc = RC ( rcFS, rcFile, rcConstructing, rcMemory, rcExhausted );
+            else
+            {
+                /* the first chunk is allocated up front:
+                   an empty input still produces a member */
+                rc = KParZipChunkAlloc ( obj, & obj -> chunks [ 0 ] );
+                if ( rc == 0 )
+                {
+                    * pz = & obj -> dad;
+                    return 0;
+                }
+            }
+        }
+    }
+
+    KParZipFileDestroy ( obj );
+
+    return rc;
+}
@@ -51,6 +51,11 @@ struct KSysFile;
 #include <assert.h>
 #include <string.h>
 
+#if LINUX
+#include <sys/syscall.h>
+#include <sys/sendfile.h>
+#endif
+
 #ifdef _DEBUGGING
 #define SYSDEBUG(msg) DBGMSG(DBG_KFS,DBG_FLAG(DBG_KFS_SYS),msg)
 #else
@@ -1055,3 +1060,180 @@ LIB_EXPORT rc_t CC KFileMakeFDFileWrite ( KFile **f, bool update, int fd )
 
     return KStdIOFileMake ( f, fd, seekable, update, true );
 }
+
+/* CopySysRange
+ *  copy a range of bytes from one file to another within the kernel
+ *  uses copy_file_range(2) where available, else sendfile(2)
+ *  only supported under Linux
+ */
+#if LINUX
+static
+ssize_t KSysFileCopyFileRange ( int in_fd, uint64_t *in_pos,
+    int out_fd, uint64_t *out_pos, size_t count )
+{
+#ifdef __NR_copy_file_range
+    loff_t in_off = ( loff_t ) * in_pos;
+    loff_t out_off = ( loff_t ) * out_pos;
+    ssize_t count_copied = syscall ( __NR_copy_file_range,
+        in_fd, & in_off, out_fd, & out_off, count, 0 );
+    if ( count_copied > 0 )
+    {
+        * in_pos = in_off;
+        * out_pos = out_off;
+    }
+    return count_copied;
+#else
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+static
+ssize_t KSysFileSendFile ( int in_fd, uint64_t *in_pos,
+    int out_fd, uint64_t *out_pos, size_t count )
+{
+    off_t in_off = ( off_t ) * in_pos;
+    ssize_t count_copied;
+
+    /* sendfile writes at the current position of the output */
+    if ( lseek ( out_fd, ( off_t ) * out_pos, SEEK_SET ) < 0 )
+        return -1;
+
+    count_copied = sendfile ( out_fd, in_fd, & in_off, count );
+    if ( count_copied > 0 )
+    {
+        * in_pos = in_off;
+        * out_pos += count_copied;
+    }
+    return count_copied;
+}
+#endif
+
+LIB_EXPORT rc_t CC KFileCopySysRange ( KFile *dst, uint64_t dst_pos,
+    const KFile *src, uint64_t src_pos, uint64_t bytes, uint64_t *num_copied )
+{
+    rc_t rc = 0;
+
+    if ( num_copied == NULL )
+        return RC ( rcFS, rcFile, rcCopying, rcParam, rcNull );
+
+    * num_copied = 0;
+
+    if ( dst == NULL || src == NULL )
+        return RC ( rcFS, rcFile, rcCopying, rcSelf, rcNull );
+    if ( ! src -> read_enabled || ! dst -> write_enabled )
+        return RC ( rcFS, rcFile, rcCopying, rcFile, rcNoPerm );
+
+#if LINUX
+    {
+        uint64_t src_off, dst_off;
+        const KSysFile *sf_src = ( const KSysFile* ) KFileGetSysFile ( src, & src_off );
+        KSysFile *sf_dst = KFileGetSysFile ( dst, & dst_off );
+
+        if ( sf_src == NULL || sf_dst == NULL )
+            return RC ( rcFS, rcFile, rcCopying, rcFile, rcUnsupported );
+        else
+        {
+            /* copy_file_range is tried first; once it has been refused
+               by the kernel or file system, fall back upon sendfile */
+            bool use_sendfile = false;
+            uint64_t in_pos = src_off + src_pos;
+            uint64_t out_pos = dst_off + dst_pos;
+
+            while ( * num_copied < bytes )
+            {
+                int lerrno;
+                ssize_t count;
+                uint64_t to_copy = bytes - * num_copied;
+
+                /* stay within the range that ssize_t can report */
+                if ( to_copy > 0x40000000 )
+                    to_copy = 0x40000000;
+
+                if ( use_sendfile )
+                    count = KSysFileSendFile ( sf_src -> fd, & in_pos, sf_dst -> fd, & out_pos, ( size_t ) to_copy );
+                else
+                    count = KSysFileCopyFileRange ( sf_src -> fd, & in_pos, sf_dst -> fd, & out_pos, ( size_t ) to_copy );
+
+                if ( count == 0 )
+                    break;
+
+                if ( count > 0 )
+                {
+                    * num_copied += count;
+                    continue;
+                }
+
+                switch ( lerrno = errno )
+                {
+                case EINTR:
+                case EAGAIN:
+                    continue;
+
+                case ENOSYS:
+                case EXDEV:
+                case EINVAL:
+                case EOPNOTSUPP:
+                case EBADF:
+                    if ( ! use_sendfile )
+                    {
+                        use_sendfile = true;
+                        continue;
+                    }
+                    if ( * num_copied == 0 )
+                        return RC ( rcFS, rcFile, rcCopying, rcFunction, rcUnsupported );
+                    rc = RC ( rcFS, rcFile, rcCopying, rcParam, rcInvalid );
+                    LOGERR ( klogErr, rc, "system invalid argument error" );
+                    return rc;
+
+                case ENOSPC:
+                    rc = RC ( rcFS, rcFile, rcCopying, rcStorage, rcExhausted );
+                    LOGERR ( klogErr, rc, "system storage exhausted error" );
+                    return rc;
+
+                case EFBIG:
+                    rc = RC ( rcFS, rcFile, rcCopying, rcFile, rcExcessive );
+                    LOGERR ( klogErr, rc, "system file too large error" );
+                    return rc;
+
+                case EIO:
+                    rc = RC ( rcFS, rcFile, rcCopying, rcTransfer, rcUnknown );
+                    LOGERR ( klogErr, rc, "system I/O error" );
+                    return rc;
+
+                default:
+                    rc = RC ( rcFS, rcFile, rcCopying, rcNoObj, rcUnknown );
+                    PLOGERR ( klogErr,
+                              ( klogErr, rc, "unknown system error errno='$(S)($(E))'",
+                                "S=%!,E=%d", lerrno, lerrno ) );
+                    return rc;
+                }
+            }
+        }
+    }
+#else
+    rc = RC ( rcFS, rcFile, rcCopying, rcFunction, rcUnsupported );
+#endif
+
+    return rc;
+}
+
+
+LIB_EXPORT rc_t CC KFileAdviseReadAhead ( const KFile *self, uint64_t pos, uint64_t bytes )
+{
+    uint64_t offset;
+    const KSysFile *sf;
+
+    if ( self == NULL )
+        return RC ( rcFS, rcFile, rcAccessing, rcSelf, rcNull );
+
+    sf = ( const KSysFile* ) KFileGetSysFile ( self, & offset );
+    if ( sf == NULL )
+        return RC ( rcFS, rcFile, rcAccessing, rcFile, rcUnsupported );
+
+#if LINUX
+    /* the hint is best effort, its result is of no interest */
+    posix_fadvise ( sf -> fd, ( off_t ) ( offset + pos ), ( off_t ) bytes, POSIX_FADV_WILLNEED );
+#endif
+    return 0;
+}
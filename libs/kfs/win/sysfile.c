@@ -1021,3 +1021,24 @@ LIB_EXPORT rc_t CC KFileMakeFDFileWrite ( KFile **f, bool update, int fd )
 {
     return RC (rcFS, rcFile, rcConstructing, rcFunction, rcUnsupported);
 }
+
+/* CopySysRange
+ *  copy a range of bytes within the kernel
+ *  not supported under Windows
+ */
+LIB_EXPORT rc_t CC KFileCopySysRange ( KFile *dst, uint64_t dst_pos,
+    const KFile *src, uint64_t src_pos, uint64_t bytes, uint64_t *num_copied )
+{
+    if ( num_copied == NULL )
+        return RC ( rcFS, rcFile, rcCopying, rcParam, rcNull );
+    * num_copied = 0;
+    return RC ( rcFS, rcFile, rcCopying, rcFunction, rcUnsupported );
+}
+
+
+LIB_EXPORT rc_t CC KFileAdviseReadAhead ( const KFile *self, uint64_t pos, uint64_t bytes )
+{
+    if ( self == NULL )
+        return RC ( rcFS, rcFile, rcAccessing, rcSelf, rcNull );
+    return RC ( rcFS, rcFile, rcAccessing, rcFunction, rcUnsupported );
+}
@@ -82,6 +82,25 @@ void CC PTChildNodeWhack ( SLNode *n, void *ignore )
     free ( n );
 }
 
+/* PTBTrans
+ *  a TTrans within the skeleton of a PTrieBuilder
+ *  its values are not held in "vals" but loaded on demand
+ */
+typedef struct PTBTrans PTBTrans;
+struct PTBTrans
+{
+    TTrans dad;
+
+    /* caller's position of the first value */
+    uint64_t pos;
+
+    /* number of values */
+    uint32_t nvals;
+
+    /* allocated width of child array */
+    uint32_t cwidth;
+};
+
 typedef struct PTriePersistData PTriePersistData;
 struct PTriePersistData
 {
@@ -128,6 +147,12 @@ struct PTriePersistData
 
     size_t data_size;
 
+    /* set when persisting the skeleton of a PTrieBuilder,
+       whose values are loaded one TTrans at a time */
+    PTLoadFunc load;
+    void *load_param;
+    TNode **load_nodes;
+
     uint32_t num_nodes;
     uint32_t max_nodes;
 
@@ -279,7 +304,15 @@ void CC TTransCountTrans ( const TTransBacktrace *bt, uint32_t width, void *data
     ++ pb -> num_trans;
 
     /* count value nodes */
-    if ( trans -> vals . root != NULL )
+    if ( pb -> load != NULL )
+    {
+        uint32_t num_nodes = ( ( const PTBTrans* ) trans ) -> nvals;
+
+        pb -> num_nodes += num_nodes;
+        if ( num_nodes > pb -> max_nodes )
+            pb -> max_nodes = num_nodes;
+    }
+    else if ( trans -> vals . root != NULL )
     {
         uint32_t num_nodes = 0;
         BSTreeForEach ( & trans -> vals, 0, TTransCountNodes, & num_nodes );
@@ -468,6 +501,60 @@ bool CC TTransPersist1 ( const TTrans *trans, PTriePersistData *pb,
     return false;
 }
 
+/* PTBTransLoad
+ *  loads the values of a skeleton TTrans into its b-tree
+ */
+static
+int CC PTBNodeSort ( const BSTNode *item, const BSTNode *n )
+{
+    return StringCompare ( & ( ( const TNode* ) item ) -> key,
+                           & ( ( const TNode* ) n ) -> key );
+}
+
+static
+void CC PTBNodeWhack ( BSTNode *n, void *ignore )
+{
+    TNodeWhack ( ( TNode* ) n );
+}
+
+static
+rc_t PTBTransLoad ( PTBTrans *self, PTriePersistData *pb )
+{
+    rc_t rc;
+    uint32_t i;
+
+    if ( self -> nvals == 0 )
+        return 0;
+
+    assert ( self -> nvals <= pb -> max_nodes );
+    rc = ( * pb -> load ) ( pb -> load_param, self -> pos, pb -> load_nodes, self -> nvals );
+    for ( i = 0; rc == 0 && i < self -> nvals; ++ i )
+    {
+        rc = BSTreeInsert ( & self -> dad . vals, & pb -> load_nodes [ i ] -> n, PTBNodeSort );
+        if ( rc != 0 )
+        {
+            /* the nodes not yet in the tree are still ours to whack */
+            for ( ; i < self -> nvals; ++ i )
+                TNodeWhack ( pb -> load_nodes [ i ] );
+        }
+    }
+
+    if ( rc != 0 )
+    {
+        BSTreeWhack ( & self -> dad . vals, PTBNodeWhack, NULL );
+        BSTreeInit ( & self -> dad . vals );
+    }
+
+    return rc;
+}
+
+static
+void PTBTransUnload ( PTBTrans *self )
+{
+    BSTreeWhack ( & self -> dad . vals, PTBNodeWhack, NULL );
+    BSTreeInit ( & self -> dad . vals );
+}
+
 static
 bool CC TTransPersist ( const TTrans *trans, PTriePersistData *pb,
      uint32_t dad, uint16_t idx, SLList *sl )
@@ -584,7 +671,8 @@ bool CC TTransPersist ( const TTrans *trans, PTriePersistData *pb,
     if ( ( pb -> data_size & 3 ) != 0 )
     {
         /* may be able to bail before writing b-tree */
-        if ( trans -> vals . root == NULL )
+        if ( pb -> load != NULL ? ( ( const PTBTrans* ) trans ) -> nvals == 0 :
+             trans -> vals . root == NULL )
         {
             pb -> rc = PTAlign ( pb, & pb -> data_size, 4, 0 );
             if ( pb -> rc != 0 )
@@ -601,6 +689,14 @@ bool CC TTransPersist ( const TTrans *trans, PTriePersistData *pb,
             return true;
     }
 
+    /* a skeleton TTrans gets its values only for the moment */
+    if ( pb -> load != NULL )
+    {
+        pb -> rc = PTBTransLoad ( ( PTBTrans* ) trans, pb );
+        if ( pb -> rc != 0 )
+            return true;
+    }
+
     /* detect fake pass */
     if ( pb -> write == NullWrite )
     {
@@ -615,6 +711,9 @@ bool CC TTransPersist ( const TTrans *trans, PTriePersistData *pb,
             pb -> write, pb -> write_param, pb -> live_write, pb );
     }
 
+    if ( pb -> load != NULL )
+        PTBTransUnload ( ( PTBTrans* ) trans );
+
     pb -> data_size += num_writ;
 
     /* align3 */
@@ -974,8 +1073,10 @@ rc_t CC TriePersist3 ( const Trie *tt, PTriePersistData *pb, int ext_keys,
     return pb -> rc;
 }
 
-LIB_EXPORT rc_t CC TriePersist ( const Trie *tt, size_t *num_writ, bool ext_keys,
-    PTWriteFunc write, void *write_param, PTAuxFunc aux, void *aux_param )
+static
+rc_t TriePersistInt ( const Trie *tt, size_t *num_writ, bool ext_keys,
+    PTWriteFunc write, void *write_param, PTAuxFunc aux, void *aux_param,
+    PTLoadFunc load, void *load_param )
 {
     PTriePersistData pb;
     size_t num_writ_buffer;
@@ -1008,6 +1109,9 @@ LIB_EXPORT rc_t CC TriePersist ( const Trie *tt, size_t *num_writ, bool ext_keys
     pb . write_param = NULL;
     pb . aux = aux;
     pb . aux_param = aux_param;
+    pb . load = load;
+    pb . load_param = load_param;
+    pb . load_nodes = NULL;
     pb . rc = 0;
 
     if ( ext_keys )
@@ -1030,6 +1134,17 @@ LIB_EXPORT rc_t CC TriePersist ( const Trie *tt, size_t *num_writ, bool ext_keys
         /* analyze table dimensions based upon counts */
         TriePersist1 ( tt, & pb );
 
+        /* room for the values of the largest TTrans */
+        if ( load != NULL && pb . max_nodes != 0 )
+        {
+            pb . load_nodes = malloc ( pb . max_nodes * sizeof pb . load_nodes [ 0 ] );
+            if ( pb . load_nodes == NULL )
+            {
+                free ( pb . idx_map );
+                return RC ( rcCont, rcTrie, rcPersisting, rcMemory, rcExhausted );
+            }
+        }
+
         /* time to allocate some memory
            allocate trans_map based upon the number of TTrans objects
            and idx_seq for persisting a single child array */
@@ -1092,8 +1207,533 @@ LIB_EXPORT rc_t CC TriePersist ( const Trie *tt, size_t *num_writ, bool ext_keys
             free ( pb . trans_map );
         }
 
+        free ( pb . load_nodes );
         free ( pb . idx_map );
     }
 
     return pb . rc;
 }
+
+LIB_EXPORT rc_t CC TriePersist ( const Trie *tt, size_t *num_writ, bool ext_keys,
+    PTWriteFunc write, void *write_param, PTAuxFunc aux, void *aux_param )
+{
+    return TriePersistInt ( tt, num_writ, ext_keys,
+        write, write_param, aux, aux_param, NULL, NULL );
+}
+
+
+
+/*--------------------------------------------------------------------------
+ * PTrieBuilder
+ *  rebuilds the TTrans structure of a Trie from sorted keys
+ *
+ *  a TTrans holds its keys in a container until their number exceeds
+ *  "limit" while at least one of them is longer than its depth. it is
+ *  then expanded: those keys move into children, one per next character.
+ *  since keys are never removed, this depends only upon the final set
+ *  of keys, and every TTrans can be built when the last key sharing its
+ *  prefix has been seen.
+ *
+ *  sorted keys sharing a prefix are contiguous. the builder keeps one
+ *  level per character of the last key, counting the keys that share
+ *  that prefix, and gathers the children of each level as they close.
+ */
+typedef struct PTBChild PTBChild;
+struct PTBChild
+{
+    /* an expanded child, or NULL for a container */
+    PTBTrans *trans;
+
+    uint64_t pos;
+    uint32_t cnt;
+    uint32_t vcnt;
+    uint32_t idx;
+};
+
+typedef struct PTBLevel PTBLevel;
+struct PTBLevel
+{
+    /* closed children */
+    PTBChild *child;
+    uint32_t ccnt;
+    uint32_t cmax;
+
+    /* position of first key having this prefix */
+    uint64_t pos;
+
+    /* keys having this prefix, and whether the prefix is itself a key */
+    uint64_t cnt;
+    uint32_t vcnt;
+
+    /* transition index from parent */
+    uint32_t idx;
+};
+
+struct PTrieBuilder
+{
+    /* character map, and root once complete */
+    Trie tt;
+
+    /* one level per character of the last key, plus root */
+    PTBLevel *level;
+    uint32_t num_levels;
+    uint32_t max_levels;
+
+    /* the last key */
+    char *last;
+    size_t last_size;
+    size_t last_max;
+
+    bool complete;
+};
+
+/* a level's TTrans is expanded if it has more than "limit" keys
+   and not all of them terminate on it */
+#define PTB_EXPANDS( self, lv ) \
+    ( ( lv ) -> cnt > ( lv ) -> vcnt && ( lv ) -> cnt > ( self ) -> tt . limit )
+
+static
+rc_t PTBTransMake ( PTBTrans **tp, uint32_t depth, uint64_t pos, uint32_t nvals )
+{
+    PTBTrans *trans = malloc ( sizeof * trans );
+    if ( trans == NULL )
+        return RC ( rcCont, rcNode, rcAllocating, rcMemory, rcExhausted );
+
+    trans -> dad . child = NULL;
+    trans -> dad . tcnt = trans -> dad . vcnt = 0;
+    BSTreeInit ( & trans -> dad . vals );
+    trans -> dad . depth = depth;
+    trans -> pos = pos;
+    trans -> nvals = nvals;
+    trans -> cwidth = 0;
+
+    * tp = trans;
+    return 0;
+}
+
+static
+void PTBTransWhack ( PTBTrans *self )
+{
+    if ( self -> dad . child != NULL )
+    {
+        uint32_t i;
+        for ( i = 0; i < self -> cwidth; ++ i )
+        {
+            if ( self -> dad . child [ i ] != NULL )
+                PTBTransWhack ( ( PTBTrans* ) self -> dad . child [ i ] );
+        }
+        free ( self -> dad . child );
+    }
+
+    BSTreeWhack ( & self -> dad . vals, PTBNodeWhack, NULL );
+    free ( self );
+}
+
+/* FitWidth
+ *  child arrays are created with the width of their time,
+ *  and must be extended to the final width of the character set
+ */
+static
+rc_t PTBTransFitWidth ( PTBTrans *self, uint32_t width )
+{
+    uint32_t i;
+
+    if ( self -> dad . child == NULL )
+        return 0;
+
+    if ( self -> cwidth < width )
+    {
+        TTrans **child = realloc ( self -> dad . child, width * sizeof * child );
+        if ( child == NULL )
+            return RC ( rcCont, rcTrie, rcPersisting, rcMemory, rcExhausted );
+
+        memset ( & child [ self -> cwidth ], 0, ( width - self -> cwidth ) * sizeof * child );
+        self -> dad . child = child;
+        self -> cwidth = width;
+    }
+
+    for ( i = 0; i < width; ++ i )
+    {
+        if ( self -> dad . child [ i ] != NULL )
+        {
+            rc_t rc = PTBTransFitWidth ( ( PTBTrans* ) self -> dad . child [ i ], width );
+            if ( rc != 0 )
+                return rc;
+        }
+    }
+
+    return 0;
+}
+
+/* Expand
+ *  create the expanded TTrans of a level from its closed children
+ */
+static
+rc_t PTrieBuilderExpand ( PTrieBuilder *self, PTBLevel *lv, uint32_t depth, PTBTrans **tp )
+{
+    uint32_t i;
+    PTBTrans *trans;
+
+    rc_t rc = PTBTransMake ( & trans, depth, lv -> pos, lv -> vcnt );
+    if ( rc != 0 )
+        return rc;
+
+    trans -> dad . child = calloc ( self -> tt . width, sizeof trans -> dad . child [ 0 ] );
+    if ( trans -> dad . child == NULL )
+    {
+        free ( trans );
+        return RC ( rcCont, rcTrie, rcInserting, rcMemory, rcExhausted );
+    }
+    trans -> cwidth = self -> tt . width;
+    trans -> dad . vcnt = ( uint16_t ) lv -> vcnt;
+
+    for ( i = 0; i < lv -> ccnt; ++ i )
+    {
+        PTBChild *c = & lv -> child [ i ];
+        PTBTrans *child = c -> trans;
+
+        /* a small child stays a container */
+        if ( child == NULL )
+        {
+            rc = PTBTransMake ( & child, depth + 1, c -> pos, c -> cnt );
+            if ( rc != 0 )
+            {
+                PTBTransWhack ( trans );
+                return rc;
+            }
+            child -> dad . vcnt = ( uint16_t ) c -> vcnt;
+            child -> dad . tcnt = ( uint16_t ) ( c -> cnt - c -> vcnt );
+        }
+
+        assert ( c -> idx < trans -> cwidth );
+        trans -> dad . child [ c -> idx ] = & child -> dad;
+        c -> trans = NULL;
+    }
+
+    trans -> dad . tcnt = ( uint16_t ) lv -> ccnt;
+    lv -> ccnt = 0;
+
+    * tp = trans;
+    return 0;
+}
+
+/* Close
+ *  the last key with the prefix of a level has been seen
+ */
+static
+rc_t PTrieBuilderClose ( PTrieBuilder *self, uint32_t depth )
+{
+    rc_t rc = 0;
+    PTBChild c;
+    PTBLevel *dad, *lv = & self -> level [ depth ];
+
+    assert ( depth > 0 );
+    dad = & self -> level [ depth - 1 ];
+
+    c . trans = NULL;
+    c . pos = lv -> pos;
+    c . cnt = 0;
+    c . vcnt = lv -> vcnt;
+    c . idx = lv -> idx;
+
+    if ( PTB_EXPANDS ( self, lv ) )
+    {
+        rc = PTrieBuilderExpand ( self, lv, depth, & c . trans );
+        if ( rc != 0 )
+            return rc;
+    }
+    else
+    {
+        /* all of its keys share one container,
+           none of its children can have been expanded */
+        c . cnt = ( uint32_t ) lv -> cnt;
+        lv -> ccnt = 0;
+    }
+
+    if ( dad -> ccnt == dad -> cmax )
+    {
+        uint32_t cmax = dad -> cmax == 0 ? 16 : dad -> cmax << 1;
+        PTBChild *child = realloc ( dad -> child, cmax * sizeof * child );
+        if ( child == NULL )
+        {
+            if ( c . trans != NULL )
+                PTBTransWhack ( c . trans );
+            return RC ( rcCont, rcTrie, rcInserting, rcMemory, rcExhausted );
+        }
+        dad -> child = child;
+        dad -> cmax = cmax;
+    }
+
+    dad -> child [ dad -> ccnt ++ ] = c;
+    return rc;
+}
+
+/* Complete
+ *  close all levels and create root
+ */
+static
+rc_t PTrieBuilderComplete ( PTrieBuilder *self )
+{
+    rc_t rc;
+    uint32_t depth;
+    PTBTrans *root;
+    PTBLevel *lv;
+
+    if ( self -> num_levels == 0 )
+    {
+        self -> complete = true;
+        return 0;
+    }
+
+    for ( depth = self -> num_levels - 1; depth > 0; -- depth )
+    {
+        rc = PTrieBuilderClose ( self, depth );
+        if ( rc != 0 )
+            return rc;
+    }
+
+    lv = & self -> level [ 0 ];
+    if ( PTB_EXPANDS ( self, lv ) )
+        rc = PTrieBuilderExpand ( self, lv, 0, & root );
+    else
+    {
+        rc = PTBTransMake ( & root, 0, lv -> pos, ( uint32_t ) lv -> cnt );
+        if ( rc == 0 )
+            root -> dad . tcnt = ( uint16_t ) lv -> cnt;
+    }
+
+    if ( rc == 0 )
+    {
+        self -> tt . root = & root -> dad;
+        self -> num_levels = 0;
+        self -> complete = true;
+
+        rc = PTBTransFitWidth ( root, self -> tt . width );
+    }
+
+    return rc;
+}
+
+/* Make
+ */
+LIB_EXPORT rc_t CC PTrieBuilderMake ( PTrieBuilder **bp,
+    const char *accept, uint32_t limit )
+{
+    rc_t rc;
+    PTrieBuilder *b;
+
+    if ( bp == NULL )
+        return RC ( rcCont, rcTrie, rcConstructing, rcParam, rcNull );
+
+    b = calloc ( 1, sizeof * b );
+    if ( b == NULL )
+        rc = RC ( rcCont, rcTrie, rcConstructing, rcMemory, rcExhausted );
+    else
+    {
+        rc = TrieInit ( & b -> tt, accept, limit, true );
+        if ( rc == 0 )
+        {
+            * bp = b;
+            return 0;
+        }
+
+        free ( b );
+    }
+
+    * bp = NULL;
+    return rc;
+}
+
+/* Append
+ */
+LIB_EXPORT rc_t CC PTrieBuilderAppend ( PTrieBuilder *self,
+    const String *key, uint64_t pos )
+{
+    rc_t rc;
+    int ch_len;
+    uint32_t ch, depth, common;
+    const char *src, *end;
+
+    if ( self == NULL )
+        return RC ( rcCont, rcTrie, rcInserting, rcSelf, rcNull );
+    if ( key == NULL )
+        return RC ( rcCont, rcTrie, rcInserting, rcString, rcNull );
+    if ( key -> len == 0 )
+        return RC ( rcCont, rcTrie, rcInserting, rcString, rcEmpty );
+    if ( self -> complete )
+        return RC ( rcCont, rcTrie, rcInserting, rcSelf, rcReadonly );
+
+    common = 0;
+    if ( self -> num_levels != 0 )
+    {
+        /* keys must arrive in order */
+        int diff;
+        String last;
+        const char *lsrc, *lend;
+
+        StringInit ( & last, self -> last, self -> last_size, self -> num_levels - 1 );
+        diff = StringCompare ( key, & last );
+        if ( diff == 0 )
+            return RC ( rcCont, rcTrie, rcInserting, rcString, rcExists );
+        if ( diff < 0 )
+            return RC ( rcCont, rcTrie, rcInserting, rcString, rcOutoforder );
+
+        /* measure the prefix shared with the last key */
+        src = key -> addr;
+        end = src + key -> size;
+        lsrc = last . addr;
+        lend = lsrc + last . size;
+        for ( ; common < last . len; ++ common )
+        {
+            uint32_t lch;
+            int lch_len = utf8_utf32 ( & lch, lsrc, lend );
+            ch_len = utf8_utf32 ( & ch, src, end );
+            if ( ch_len <= 0 || lch_len <= 0 || ch != lch )
+                break;
+            src += ch_len;
+            lsrc += lch_len;
+        }
+
+        /* the groups of the last key beyond it are complete */
+        for ( depth = self -> num_levels - 1; depth > common; -- depth )
+        {
+            rc = PTrieBuilderClose ( self, depth );
+            if ( rc != 0 )
+                return rc;
+        }
+    }
+
+    /* make room for a level per character */
+    if ( key -> len >= self -> max_levels )
+    {
+        uint32_t max_levels = ( key -> len + 16 ) & ~ 15U;
+        PTBLevel *level = realloc ( self -> level, max_levels * sizeof * level );
+        if ( level == NULL )
+            return RC ( rcCont, rcTrie, rcInserting, rcMemory, rcExhausted );
+        memset ( & level [ self -> max_levels ], 0,
+            ( max_levels - self -> max_levels ) * sizeof * level );
+        self -> level = level;
+        self -> max_levels = max_levels;
+    }
+
+    /* open root for the first key */
+    if ( self -> num_levels == 0 )
+    {
+        self -> level [ 0 ] . pos = pos;
+        self -> level [ 0 ] . cnt = 0;
+        self -> level [ 0 ] . vcnt = 0;
+        self -> level [ 0 ] . idx = 0;
+    }
+
+    /* map characters, opening levels beyond the common prefix */
+    for ( depth = 1, src = key -> addr, end = src + key -> size; src < end; ++ depth, src += ch_len )
+    {
+        uint32_t idx;
+
+        ch_len = utf8_utf32 ( & ch, src, end );
+        if ( ch_len <= 0 )
+            return RC ( rcCont, rcTrie, rcInserting, rcChar, rcInvalid );
+
+        idx = TrieMapChar ( & self -> tt, ch );
+        if ( idx == 0 )
+        {
+            /* make sure the expansion would not exceed
+               the 16 bit limit on array width */
+            if ( ( uint16_t ) ( self -> tt . width + 1 ) == 0 )
+                return RC ( rcCont, rcTrie, rcInserting, rcRange, rcExcessive );
+
+            idx = self -> tt . width;
+            rc = TrieAutoExpand ( & self -> tt, ch );
+            if ( rc != 0 )
+                return rc;
+        }
+
+        if ( depth > common )
+        {
+            PTBLevel *lv = & self -> level [ depth ];
+            assert ( lv -> ccnt == 0 );
+            lv -> pos = pos;
+            lv -> cnt = 0;
+            lv -> vcnt = 0;
+            lv -> idx = idx;
+        }
+    }
+
+    /* count the key within every prefix */
+    for ( depth = 0; depth <= key -> len; ++ depth )
+        ++ self -> level [ depth ] . cnt;
+    self -> level [ key -> len ] . vcnt = 1;
+
+    /* remember it */
+    if ( key -> size > self -> last_max )
+    {
+        size_t last_max = ( key -> size + 255 ) & ~ ( size_t ) 255;
+        char *last = realloc ( self -> last, last_max );
+        if ( last == NULL )
+            return RC ( rcCont, rcTrie, rcInserting, rcMemory, rcExhausted );
+        self -> last = last;
+        self -> last_max = last_max;
+    }
+    memcpy ( self -> last, key -> addr, key -> size );
+    self -> last_size = key -> size;
+    self -> num_levels = key -> len + 1;
+
+    return 0;
+}
+
+/* Persist
+ */
+LIB_EXPORT rc_t CC PTrieBuilderPersist ( PTrieBuilder *self, size_t *num_writ,
+    bool ext_keys, PTWriteFunc write, void *write_param,
+    PTAuxFunc aux, void *aux_param, PTLoadFunc load, void *load_param )
+{
+    if ( num_writ != NULL )
+        * num_writ = 0;
+
+    if ( self == NULL )
+        return RC ( rcCont, rcTrie, rcPersisting, rcSelf, rcNull );
+    if ( load == NULL )
+        return RC ( rcCont, rcTrie, rcPersisting, rcFunction, rcNull );
+
+    if ( ! self -> complete )
+    {
+        rc_t rc = PTrieBuilderComplete ( self );
+        if ( rc != 0 )
+            return rc;
+    }
+
+    return TriePersistInt ( & self -> tt, num_writ, ext_keys,
+        write, write_param, aux, aux_param, load, load_param );
+}
+
+/* Whack
+ */
+LIB_EXPORT void CC PTrieBuilderWhack ( PTrieBuilder *self )
+{
+    if ( self != NULL )
+    {
+        uint32_t i, j;
+
+        if ( self -> tt . root != NULL )
+        {
+            PTBTransWhack ( ( PTBTrans* ) self -> tt . root );
+            self -> tt . root = NULL;
+        }
+
+        for ( i = 0; i < self -> max_levels; ++ i )
+        {
+            PTBLevel *lv = & self -> level [ i ];
+            for ( j = 0; j < lv -> ccnt; ++ j )
+            {
+                if ( lv -> child [ j ] . trans != NULL )
+                    PTBTransWhack ( lv -> child [ j ] . trans );
+            }
+            free ( lv -> child );
+        }
+
+        free ( self -> level );
+        free ( self -> last );
+        TrieWhack ( & self -> tt, NULL, NULL );
+        free ( self );
+    }
+}
@@ -1699,6 +1699,63 @@ int CC PTNodeFindRem ( const void *item, const PBSTNode *n, void * data )
     return -1;
 }
 
+/* FindVal
+ *  looks up the remainder of a key within the values of a transition
+ */
+static
+uint32_t PTrieFindVal ( const PTrie *self, const PTTrans *trans, const String *key, PTNode *rtn,
+        int ( CC * custom_cmp ) ( const void *item, const PBSTNode *n, void *data ), void *data )
+{
+    /* any values in b-tree? */
+    if ( trans -> vals != NULL )
+    {
+        int ( CC * cmp ) ( const void *item, const PBSTNode *n, void *data );
+
+        if ( custom_cmp != NULL)
+            cmp = custom_cmp;
+        else if ( self -> ext_keys )
+            cmp = NULL;
+        /* for exact match on node */
+        else if ( key -> len == 0 )
+            cmp = PTNodeFindExact;
+        /* for remainder */
+        else
+            cmp = PTNodeFindRem;
+
+        /* try to find the node */
+        if ( cmp != NULL )
+        {
+            PBSTNode btnode;
+            uint32_t btid = PBSTreeFind ( trans -> vals, & btnode, key, cmp, data );
+            if ( btid != 0 )
+            {
+                /* grab the data */
+                rtn -> data . addr = btnode . data . addr;
+                rtn -> data . size = btnode . data . size;
+
+                /* record reference to self */
+                rtn -> internal = self;
+
+                /* set an id */
+                rtn -> id = PTrieEncodeNodeId ( self,
+                    trans -> tid, btid );
+
+                /* adjust the data block for internal keys */
+                if ( ! self -> ext_keys )
+                {
+                    const char *ptr = ( const char* ) rtn -> data . addr;
+                    for ( ; rtn -> data . size > 1 && * ptr != '\0'; ++ ptr, -- rtn -> data . size )
+                        ( void ) 0;
+                    rtn -> data . addr = ptr + 1; /* skip terminating NUL byte */
+                    -- rtn -> data.size;
+                }
+            }
+        }
+    }
+
+    return rtn -> id;
+}
+
 LIB_EXPORT uint32_t CC PTrieFind ( const PTrie *self, const String *item, PTNode *rtn,
         int ( CC * custom_cmp ) ( const void *item, const PBSTNode *n, void *data ), void *data )
 {
@@ -1719,58 +1776,138 @@ LIB_EXPORT uint32_t CC PTrieFind ( const PTrie *self, const String *item, PTNode
 
         if ( rc == 0 )
         {
-            /* any values in b-tree? */
-            if ( trans -> vals != NULL )
+            PTrieFindVal ( self, trans, & key, rtn, custom_cmp, data );
+            PTTransWhack ( trans );
+        }
+    }
+
+    return rtn -> id;
+}
+
+/* FindBatch
+ *  keeps the transitions taken by the previous key, each with
+ *  the amount of key consumed to reach it, and resumes the walk
+ *  of the next key from the deepest one within their common prefix
+ */
+typedef struct PTrieBatchStep PTrieBatchStep;
+struct PTrieBatchStep
+{
+    PTTrans trans;
+    size_t size;
+    uint32_t len;
+};
+
+LIB_EXPORT uint32_t CC PTrieFindBatch ( const PTrie *self,
+        const String keys [], uint32_t count, PTNode rtn [],
+        int ( CC * custom_cmp ) ( const void *item, const PBSTNode *n, void *data ), void *data )
+{
+    uint32_t i, depth, found;
+    uint32_t max_len;
+    PTrieBatchStep *path;
+
+    if ( rtn == NULL )
+        return 0;
+
+    for ( max_len = i = 0; i < count; ++ i )
+    {
+        rtn [ i ] . data . addr = rtn [ i ] . internal = NULL;
+        rtn [ i ] . data . size = 0;
+        rtn [ i ] . id = 0;
+
+        if ( keys != NULL && keys [ i ] . len > max_len )
+            max_len = keys [ i ] . len;
+    }
+
+    if ( self == NULL || keys == NULL || self -> num_trans == 0 || max_len == 0 )
+        return 0;
+
+    /* a key can take one transition per character. the steps are
+       never reallocated, since each PTTrans points into itself */
+    path = malloc ( ( ( size_t ) max_len + 1 ) * sizeof * path );
+    if ( path == NULL )
+        return 0;
+
+    for ( depth = found = i = 0; i < count; ++ i )
+    {
+        rc_t rc;
+        size_t lcp;
+        String key;
+        PTTrans *trans;
+        const String *item = & keys [ i ];
+
+        if ( item -> len == 0 )
+            continue;
+
+        /* length of prefix shared with previous key */
+        lcp = 0;
+        if ( depth != 0 )
+        {
+            const String *prev = & keys [ i - 1 ];
+            size_t max = prev -> size < item -> size ? prev -> size : item -> size;
+            for ( ; lcp < max; ++ lcp )
             {
-                int ( CC * cmp ) ( const void *item, const PBSTNode *n, void *data );
-                
-                if ( custom_cmp != NULL)
-                    cmp = custom_cmp;
-                else if ( self -> ext_keys )
-                    cmp = NULL;
-                /* for exact match on node */
-                else if ( key . len == 0 )
-                    cmp = PTNodeFindExact;
-                /* for remainder */
-                else
-                    cmp = PTNodeFindRem;
-
-                /* try to find the node */
-                if ( cmp != NULL )
-                {
-                    PBSTNode btnode;
-                    uint32_t btid = PBSTreeFind ( trans -> vals, & btnode, & key, cmp, data );
-                    if ( btid != 0 )
-                    {
-                        /* grab the data */
-                        rtn -> data . addr = btnode . data . addr;
-                        rtn -> data . size = btnode . data . size;
+                if ( prev -> addr [ lcp ] != item -> addr [ lcp ] )
+                    break;
+            }
+        }
 
-                        /* record reference to self */
-                        rtn -> internal = self;
+        /* back up to the deepest transition within the prefix */
+        while ( depth != 0 && path [ depth - 1 ] . size > lcp )
+            -- depth;
 
-                        /* set an id */
-                        rtn -> id = PTrieEncodeNodeId ( self,
-                            trans -> tid, btid );
+        if ( depth == 0 )
+        {
+            rc = PTrieInitNode ( self, & path [ 0 ] . trans, 1 );
+            if ( rc != 0 )
+                break;
+            path [ 0 ] . size = 0;
+            path [ 0 ] . len = 0;
+            depth = 1;
+        }
 
-                        /* adjust the data block for internal keys */
-                        if ( ! self -> ext_keys )
-                        {
-                            const char *ptr = ( const char* ) rtn -> data . addr;
-                            for ( ; rtn -> data . size > 1 && * ptr != '\0'; ++ ptr, -- rtn -> data . size )
-                                ( void ) 0;
-                            rtn -> data . addr = ptr + 1; /* skip terminating NUL byte */
-                            -- rtn -> data.size;
-                        }
-                    }
-                }
+        trans = & path [ depth - 1 ] . trans;
+        StringInit ( & key, item -> addr + path [ depth - 1 ] . size,
+            item -> size - path [ depth - 1 ] . size,
+            item -> len - path [ depth - 1 ] . len );
+
+        /* walk from there, as in FindTrans */
+        for ( rc = 0; trans -> icnt != 0; )
+        {
+            uint32_t tid, key_idx;
+
+            rc = PTrieNextIdx ( self, & key, & key_idx );
+            if ( rc != 0 )
+            {
+                /* end of string */
+                if ( GetRCState ( rc ) == rcEmpty )
+                    rc = 0;
+                break;
             }
 
-            PTTransWhack ( trans );
+            rc = RC ( rcCont, rcTrie, rcSelecting, rcString, rcNotFound );
+            if ( key_idx == 0 )
+                break;
+            tid = PTTransGetChildChildIdx ( trans, self, -- key_idx );
+            if ( tid == 0 )
+                break;
+            tid = PTTransGetChild ( trans, self, tid - 1 ) + 1;
+
+            assert ( depth <= max_len );
+            rc = PTrieInitNode ( self, & path [ depth ] . trans, tid );
+            if ( rc != 0 )
+                break;
+            path [ depth ] . size = item -> size - key . size;
+            path [ depth ] . len = item -> len - key . len;
+            trans = & path [ depth ++ ] . trans;
         }
+
+        if ( rc == 0 && PTrieFindVal ( self, trans, & key, & rtn [ i ], custom_cmp, data ) != 0 )
+            ++ found;
     }
 
-    return rtn -> id;
+    free ( path );
+
+    return found;
 }
 
 LIB_EXPORT uint32_t CC PTrieFindRE ( const PTrie *self, const String *re, PTNode *rtn );
@@ -0,0 +1,425 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include <klib/extern.h>
+#include <klib/seq-conv.h>
+#include <klib/klib-priv.h>
+
+#include <string.h>
+#include <assert.h>
+
+/* vector implementations are compiled for their instruction set
+   regardless of the compiler flags used for the library, and only
+   called after a run-time check of the processor */
+#if defined __GNUC__ && ( defined __x86_64__ || defined __i386__ ) && \
+    ( __GNUC__ > 4 || ( __GNUC__ == 4 && __GNUC_MINOR__ >= 9 ) || defined __clang__ )
+#define USE_SSSE3 1
+#include <cpuid.h>
+#include <tmmintrin.h>
+#define SSSE3_FUNC __attribute__ ( ( target ( "ssse3" ) ) )
+#else
+#define USE_SSSE3 0
+#endif
+
+
+/*--------------------------------------------------------------------------
+ * scalar implementations
+ *  also used for the tails of vector loops
+ */
+static
+size_t SeqMapNibblesScalar ( uint8_t *dst,
+    const uint8_t *src, size_t count, const uint8_t map [ 16 ] )
+{
+    size_t i;
+    for ( i = 0; i < count; ++ i )
+    {
+        uint8_t s = src [ i ];
+        if ( s >= 16 )
+            break;
+        dst [ i ] = map [ s ];
+    }
+    return i;
+}
+
+static
+size_t SeqMapNibblesReverseScalar ( uint8_t *dst,
+    const uint8_t *src, size_t count, const uint8_t map [ 16 ] )
+{
+    size_t i;
+    for ( i = 0; i < count; ++ i )
+    {
+        uint8_t s = src [ count - 1 - i ];
+        if ( s >= 16 )
+            break;
+        dst [ i ] = map [ s ];
+    }
+    return i;
+}
+
+static
+void SeqMapBytesScalar ( uint8_t *dst,
+    const uint8_t *src, size_t count, const uint8_t map [ 256 ] )
+{
+    size_t i;
+    for ( i = 0; i < count; ++ i )
+        dst [ i ] = map [ src [ i ] ];
+}
+
+static
+void SeqMapBytesReverseScalar ( uint8_t *dst,
+    const uint8_t *src, size_t count, const uint8_t map [ 256 ] )
+{
+    size_t i;
+    for ( i = 0; i < count; ++ i )
+        dst [ i ] = map [ src [ count - 1 - i ] ];
+}
+
+static
+void SeqAddOffsetScalar ( uint8_t *dst,
+    const uint8_t *src, size_t count, int offset )
+{
+    size_t i;
+    for ( i = 0; i < count; ++ i )
+        dst [ i ] = ( uint8_t ) ( src [ i ] + offset );
+}
+
+static
+void SeqAddOffsetReverseScalar ( uint8_t *dst,
+    const uint8_t *src, size_t count, int offset )
+{
+    size_t i;
+    for ( i = 0; i < count; ++ i )
+        dst [ i ] = ( uint8_t ) ( src [ count - 1 - i ] + offset );
+}
+
+
+#if USE_SSSE3
+/*--------------------------------------------------------------------------
+ * SSSE3 implementations
+ *  "pshufb" performs 16 parallel lookups into a 16-byte table,
+ *  and also reverses the order of bytes in a register
+ */
+
+/* ProcessorSupport
+ *  run-time check of cpuid flags, performed once
+ */
+static int ssse3_supported = -1;
+static bool ssse3_allowed = true;
+
+static
+bool SeqConvSSSE3Supported ( void )
+{
+    if ( ssse3_supported < 0 )
+    {
+        uint32_t a, b, c, d;
+        int supported = 0;
+        if ( __get_cpuid ( 1, & a, & b, & c, & d ) )
+            supported = ( c & bit_SSSE3 ) != 0;
+        ssse3_supported = supported;
+    }
+    return ssse3_supported > 0 && ssse3_allowed;
+}
+
+#define REVERSE_BYTES \
+    _mm_setr_epi8 ( 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0 )
+
+/* a chunk holds only nibbles if no byte has any of its upper bits set */
+#define ALL_NIBBLES( v, hi ) \
+    ( _mm_movemask_epi8 ( _mm_cmpeq_epi8 ( _mm_and_si128 ( v, hi ), _mm_setzero_si128 () ) ) == 0xFFFF )
+
+static SSSE3_FUNC
+size_t SeqMapNibblesSSSE3 ( uint8_t *dst,
+    const uint8_t *src, size_t count, const uint8_t map [ 16 ] )
+{
+    size_t i;
+    const __m128i tbl = _mm_loadu_si128 ( ( const __m128i* ) map );
+    const __m128i hi = _mm_set1_epi8 ( ( char ) 0xF0 );
+
+    for ( i = 0; i + 16 <= count; i += 16 )
+    {
+        __m128i v = _mm_loadu_si128 ( ( const __m128i* ) & src [ i ] );
+        if ( ! ALL_NIBBLES ( v, hi ) )
+            break;
+        _mm_storeu_si128 ( ( __m128i* ) & dst [ i ], _mm_shuffle_epi8 ( tbl, v ) );
+    }
+
+    return i + SeqMapNibblesScalar ( & dst [ i ], & src [ i ], count - i, map );
+}
+
+static SSSE3_FUNC
+size_t SeqMapNibblesReverseSSSE3 ( uint8_t *dst,
+    const uint8_t *src, size_t count, const uint8_t map [ 16 ] )
+{
+    size_t i;
+    const __m128i tbl = _mm_loadu_si128 ( ( const __m128i* ) map );
+    const __m128i hi = _mm_set1_epi8 ( ( char ) 0xF0 );
+    const __m128i rev = REVERSE_BYTES;
+
+    for ( i = 0; i + 16 <= count; i += 16 )
+    {
+        __m128i v = _mm_loadu_si128 ( ( const __m128i* ) & src [ count - i - 16 ] );
+        if ( ! ALL_NIBBLES ( v, hi ) )
+            break;
+        v = _mm_shuffle_epi8 ( _mm_shuffle_epi8 ( tbl, v ), rev );
+        _mm_storeu_si128 ( ( __m128i* ) & dst [ i ], v );
+    }
+
+    /* the remaining source is the first "count - i" elements */
+    return i + SeqMapNibblesReverseScalar ( & dst [ i ], src, count - i, map );
+}
+
+/* MapBytes
+ *  the 256-byte map is treated as 16 nibble tables. for table "k",
+ *  subtracting 16 * k and adding 0x70 with unsigned saturation leaves
+ *  the high bit clear exactly for source bytes in that table's range,
+ *  so "pshufb" yields the mapped value there and zero everywhere else.
+ *
+ *  tables that map only to zero contribute nothing and are skipped.
+ *  sequence maps are sparse - letters and a few codes - but a dense
+ *  map costs more in vector lookups than the scalar loop, so the
+ *  vector path is only taken when few tables remain.
+ */
+#define SEQ_BYTE_TABLES_MAX 8
+
+typedef struct SeqByteTables SeqByteTables;
+struct SeqByteTables
+{
+    __m128i t [ SEQ_BYTE_TABLES_MAX ];
+    __m128i base [ SEQ_BYTE_TABLES_MAX ];
+    uint32_t count;
+};
+
+static SSSE3_FUNC
+bool SeqByteTablesInit ( SeqByteTables *self, const uint8_t map [ 256 ] )
+{
+    int k, i;
+    self -> count = 0;
+    for ( k = 0; k < 16; ++ k )
+    {
+        for ( i = 0; i < 16; ++ i )
+        {
+            if ( map [ k * 16 + i ] != 0 )
+                break;
+        }
+        if ( i < 16 )
+        {
+            if ( self -> count == SEQ_BYTE_TABLES_MAX )
+                return false;
+            self -> t [ self -> count ] = _mm_loadu_si128 ( ( const __m128i* ) & map [ k * 16 ] );
+            self -> base [ self -> count ] = _mm_set1_epi8 ( ( char ) ( k * 16 ) );
+            ++ self -> count;
+        }
+    }
+    return true;
+}
+
+static SSSE3_FUNC __inline__
+__m128i SeqByteTablesLookup ( const SeqByteTables *self, __m128i v )
+{
+    uint32_t k;
+    const __m128i bias = _mm_set1_epi8 ( 0x70 );
+    __m128i r = _mm_setzero_si128 ();
+    for ( k = 0; k < self -> count; ++ k )
+    {
+        __m128i idx = _mm_adds_epu8 ( _mm_sub_epi8 ( v, self -> base [ k ] ), bias );
+        r = _mm_or_si128 ( r, _mm_shuffle_epi8 ( self -> t [ k ], idx ) );
+    }
+    return r;
+}
+
+static SSSE3_FUNC
+void SeqMapBytesSSSE3 ( uint8_t *dst,
+    const uint8_t *src, size_t count, const uint8_t map [ 256 ] )
+{
+    size_t i = 0;
+    SeqByteTables tbl;
+
+    if ( SeqByteTablesInit ( & tbl, map ) )
+    {
+        for ( ; i + 16 <= count; i += 16 )
+        {
+            __m128i v = _mm_loadu_si128 ( ( const __m128i* ) & src [ i ] );
+            _mm_storeu_si128 ( ( __m128i* ) & dst [ i ], SeqByteTablesLookup ( & tbl, v ) );
+        }
+    }
+
+    SeqMapBytesScalar ( & dst [ i ], & src [ i ], count - i, map );
+}
+
+static SSSE3_FUNC
+void SeqMapBytesReverseSSSE3 ( uint8_t *dst,
+    const uint8_t *src, size_t count, const uint8_t map [ 256 ] )
+{
+    size_t i = 0;
+    SeqByteTables tbl;
+    const __m128i rev = REVERSE_BYTES;
+
+    if ( SeqByteTablesInit ( & tbl, map ) )
+    {
+        for ( ; i + 16 <= count; i += 16 )
+        {
+            __m128i v = _mm_loadu_si128 ( ( const __m128i* ) & src [ count - i - 16 ] );
+            v = _mm_shuffle_epi8 ( SeqByteTablesLookup ( & tbl, v ), rev );
+            _mm_storeu_si128 ( ( __m128i* ) & dst [ i ], v );
+        }
+    }
+
+    SeqMapBytesReverseScalar ( & dst [ i ], src, count - i, map );
+}
+
+static SSSE3_FUNC
+void SeqAddOffsetSSSE3 ( uint8_t *dst,
+    const uint8_t *src, size_t count, int offset )
+{
+    size_t i;
+    const __m128i off = _mm_set1_epi8 ( ( char ) offset );
+
+    for ( i = 0; i + 16 <= count; i += 16 )
+    {
+        __m128i v = _mm_loadu_si128 ( ( const __m128i* ) & src [ i ] );
+        _mm_storeu_si128 ( ( __m128i* ) & dst [ i ], _mm_add_epi8 ( v, off ) );
+    }
+
+    SeqAddOffsetScalar ( & dst [ i ], & src [ i ], count - i, offset );
+}
+
+static SSSE3_FUNC
+void SeqAddOffsetReverseSSSE3 ( uint8_t *dst,
+    const uint8_t *src, size_t count, int offset )
+{
+    size_t i;
+    const __m128i off = _mm_set1_epi8 ( ( char ) offset );
+    const __m128i rev = REVERSE_BYTES;
+
+    for ( i = 0; i + 16 <= count; i += 16 )
+    {
+        __m128i v = _mm_loadu_si128 ( ( const __m128i* ) & src [ count - i - 16 ] );
+        v = _mm_shuffle_epi8 ( _mm_add_epi8 ( v, off ), rev );
+        _mm_storeu_si128 ( ( __m128i* ) & dst [ i ], v );
+    }
+
+    SeqAddOffsetReverseScalar ( & dst [ i ], src, count - i, offset );
+}
+
+#endif /* USE_SSSE3 */
+
+
+/* UseVector
+ */
+LIB_EXPORT bool CC SeqConvUseVector ( bool allow )
+{
+#if USE_SSSE3
+    ssse3_allowed = allow;
+    return SeqConvSSSE3Supported ();
+#else
+    return false;
+#endif
+}
+
+
+/*--------------------------------------------------------------------------
+ * exported entrypoints
+ *  short runs are not worth leaving scalar code for
+ */
+#define SEQ_CONV_VEC_MIN 16
+
+LIB_EXPORT size_t CC SeqMapNibbles ( uint8_t *dst,
+    const uint8_t *src, size_t count, const uint8_t map [ 16 ] )
+{
+    assert ( count == 0 || ( dst != NULL && src != NULL && map != NULL ) );
+#if USE_SSSE3
+    if ( count >= SEQ_CONV_VEC_MIN && SeqConvSSSE3Supported () )
+        return SeqMapNibblesSSSE3 ( dst, src, count, map );
+#endif
+    return SeqMapNibblesScalar ( dst, src, count, map );
+}
+
+LIB_EXPORT size_t CC SeqMapNibblesReverse ( uint8_t *dst,
+    const uint8_t *src, size_t count, const uint8_t map [ 16 ] )
+{
+    assert ( count == 0 || ( dst != NULL && src != NULL && map != NULL ) );
+#if USE_SSSE3
+    if ( count >= SEQ_CONV_VEC_MIN && SeqConvSSSE3Supported () )
+        return SeqMapNibblesReverseSSSE3 ( dst, src, count, map );
+#endif
+    return SeqMapNibblesReverseScalar ( dst, src, count, map );
+}
+
+LIB_EXPORT void CC SeqMapBytes ( uint8_t *dst,
+    const uint8_t *src, size_t count, const uint8_t map [ 256 ] )
+{
+    assert ( count == 0 || ( dst != NULL && src != NULL && map != NULL ) );
+#if USE_SSSE3
+    if ( count >= SEQ_CONV_VEC_MIN && SeqConvSSSE3Supported () )
+    {
+        SeqMapBytesSSSE3 ( dst, src, count, map );
+        return;
+    }
+#endif
+    SeqMapBytesScalar ( dst, src, count, map );
+}
+
+LIB_EXPORT void CC SeqMapBytesReverse ( uint8_t *dst,
+    const uint8_t *src, size_t count, const uint8_t map [ 256 ] )
+{
+    assert ( count == 0 || ( dst != NULL && src != NULL && map != NULL ) );
+#if USE_SSSE3
+    if ( count >= SEQ_CONV_VEC_MIN && SeqConvSSSE3Supported () )
+    {
+        SeqMapBytesReverseSSSE3 ( dst, src, count, map );
+        return;
+    }
+#endif
+    SeqMapBytesReverseScalar ( dst, src, count, map );
+}
+
+LIB_EXPORT void CC SeqAddOffset ( uint8_t *dst,
+    const uint8_t *src, size_t count, int offset )
+{
+    assert ( count == 0 || ( dst != NULL && src != NULL ) );
+#if USE_SSSE3
+    if ( count >= SEQ_CONV_VEC_MIN && SeqConvSSSE3Supported () )
+    {
+        SeqAddOffsetSSSE3 ( dst, src, count, offset );
+        return;
+    }
+#endif
+    SeqAddOffsetScalar ( dst, src, count, offset );
+}
+
+LIB_EXPORT void CC SeqAddOffsetReverse ( uint8_t *dst,
+    const uint8_t *src, size_t count, int offset )
+{
+    assert ( count == 0 || ( dst != NULL && src != NULL ) );
+#if USE_SSSE3
+    if ( count >= SEQ_CONV_VEC_MIN && SeqConvSSSE3Supported () )
+    {
+        SeqAddOffsetReverseSSSE3 ( dst, src, count, offset );
+        return;
+    }
+#endif
+    SeqAddOffsetReverseScalar ( dst, src, count, offset );
+}
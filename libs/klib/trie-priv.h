@@ -233,5 +233,10 @@ uint32_t TrieMapChar ( const Trie *tt, uint32_t ch );
  */
 rc_t TrieNextIdx ( const Trie *tt, String *key, uint32_t *idx );
 
+/* TrieAutoExpand
+ *  incorporates a new character into the accept charset
+ */
+rc_t TrieAutoExpand ( Trie *tt, uint32_t ch );
+
 
 #endif /* _h_trie_priv_ */
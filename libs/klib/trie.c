@@ -488,14 +488,14 @@ bool CC TTransAutoExpand ( const TTransBacktrace *bt, uint32_t width, void *data
     return false;
 }
 
-static
-rc_t CC TrieAutoExpand ( Trie *tt, uint32_t ch )
+rc_t TrieAutoExpand ( Trie *tt, uint32_t ch )
 {
     AutoExpandData pb;
     pb . rc = 0;
 
     /* extend node child arrays */
-    TTransDoUntil ( tt -> root, tt -> width, TTransAutoExpand, & pb );
+    if ( tt -> root != NULL )
+        TTransDoUntil ( tt -> root, tt -> width, TTransAutoExpand, & pb );
     if ( pb . rc == 0 )
     {
         uint16_t *map = ( uint16_t* ) tt -> map;
@@ -0,0 +1,372 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include <kproc/q-extern.h>
+#include <kproc/ordered-queue.h>
+#include <kproc/queue.h>
+#include <kproc/timeout.h>
+#include <kproc/lock.h>
+#include <kproc/cond.h>
+#include <klib/rc.h>
+#include <atomic32.h>
+#include <os-native.h>
+#include <sysalloc.h>
+
+#include <stdlib.h>
+
+/* how long a push or pop waits before it looks at the state of the queue again */
+#define QUEUE_TIMEOUT 100 /* mS */
+
+
+/*--------------------------------------------------------------------------
+ * KOrderedQueue
+ *  one producer submits items, a pool of workers takes them in any order
+ *  and one consumer gets them back in the order they were submitted
+ */
+struct KOrderedQueue
+{
+    KQueue *work;
+    KQueue *order;
+    KLock *lock;
+    KCondition *cond;
+
+    /* popped by Next but not done yet, only when waiting for it failed */
+    KOrderedItem *pending;
+
+    void ( CC * whack ) ( KOrderedItem *item, void *data );
+    void *data;
+
+    atomic32_t refcount;
+    volatile bool quit;
+};
+
+
+/* Whack
+ *  every item in the work queue is in the order queue as well
+ */
+static
+rc_t KOrderedQueueWhack ( KOrderedQueue *self )
+{
+    void *item;
+
+    if ( self -> pending != NULL )
+        ( * self -> whack ) ( self -> pending, self -> data );
+
+    if ( self -> work != NULL )
+    {
+        while ( KQueuePop ( self -> work, & item, NULL ) == 0 )
+            ( void ) 0;
+    }
+    if ( self -> order != NULL )
+    {
+        while ( KQueuePop ( self -> order, & item, NULL ) == 0 )
+            ( * self -> whack ) ( item, self -> data );
+    }
+
+    KQueueRelease ( self -> work );
+    KQueueRelease ( self -> order );
+    KConditionRelease ( self -> cond );
+    KLockRelease ( self -> lock );
+    free ( self );
+    return 0;
+}
+
+/* AddRef
+ * Release
+ *  ignores NULL references
+ */
+LIB_EXPORT rc_t CC KOrderedQueueAddRef ( const KOrderedQueue *cself )
+{
+    if ( cself != NULL )
+        atomic32_inc ( & ( ( KOrderedQueue* ) cself ) -> refcount );
+    return 0;
+}
+
+LIB_EXPORT rc_t CC KOrderedQueueRelease ( const KOrderedQueue *cself )
+{
+    KOrderedQueue *self = ( KOrderedQueue* ) cself;
+    if ( cself != NULL )
+    {
+        if ( atomic32_dec_and_test ( & self -> refcount ) )
+            return KOrderedQueueWhack ( self );
+    }
+    return 0;
+}
+
+/* Make
+ *  create an empty queue object
+ */
+LIB_EXPORT rc_t CC KOrderedQueueMake ( KOrderedQueue **qp, uint32_t work, uint32_t order,
+    void ( CC * whack ) ( KOrderedItem *item, void *data ), void *data )
+{
+    rc_t rc;
+    if ( qp == NULL )
+        rc = RC ( rcCont, rcQueue, rcConstructing, rcParam, rcNull );
+    else if ( whack == NULL )
+    {
+        rc = RC ( rcCont, rcQueue, rcConstructing, rcFunction, rcNull );
+        * qp = NULL;
+    }
+    else
+    {
+        KOrderedQueue *q = calloc ( 1, sizeof * q );
+        if ( q == NULL )
+            rc = RC ( rcCont, rcQueue, rcConstructing, rcMemory, rcExhausted );
+        else
+        {
+            q -> whack = whack;
+            q -> data = data;
+            atomic32_set ( & q -> refcount, 1 );
+
+            rc = KQueueMake ( & q -> work, work );
+            if ( rc == 0 )
+                rc = KQueueMake ( & q -> order, order );
+            if ( rc == 0 )
+                rc = KLockMake ( & q -> lock );
+            if ( rc == 0 )
+                rc = KConditionMake ( & q -> cond );
+            if ( rc == 0 )
+            {
+                * qp = q;
+                return 0;
+            }
+
+            KOrderedQueueWhack ( q );
+        }
+        * qp = NULL;
+    }
+    return rc;
+}
+
+/* Push
+ *  waits for space in a full queue until told to quit
+ */
+static
+rc_t KOrderedQueuePush ( KOrderedQueue *self, KQueue *q, KOrderedItem *item )
+{
+    rc_t rc;
+    do
+    {
+        timeout_t tm;
+        TimeoutInit ( & tm, QUEUE_TIMEOUT );
+        rc = KQueuePush ( q, item, & tm );
+    }
+    while ( rc != 0 && GetRCObject ( rc ) == ( enum RCObject ) rcTimeout && GetRCState ( rc ) == rcExhausted && ! self -> quit );
+    return rc;
+}
+
+/* Pop
+ *  waits for an item until the queue is sealed and empty
+ */
+static
+KOrderedItem *KOrderedQueuePop ( KQueue *q )
+{
+    while ( true )
+    {
+        void *item;
+        timeout_t tm;
+        rc_t rc;
+
+        TimeoutInit ( & tm, QUEUE_TIMEOUT );
+        rc = KQueuePop ( q, & item, & tm );
+        if ( rc == 0 )
+            return item;
+        if ( GetRCObject ( rc ) != ( enum RCObject ) rcTimeout || GetRCState ( rc ) != rcExhausted )
+            return NULL;
+    }
+}
+
+/* Submit
+ *  the item goes into the order queue first, so that the consumer
+ *  never waits for an item that no worker can see
+ */
+LIB_EXPORT rc_t CC KOrderedQueueSubmit ( KOrderedQueue *self, KOrderedItem *item, bool work )
+{
+    rc_t rc;
+
+    if ( self == NULL )
+        return RC ( rcCont, rcQueue, rcInserting, rcSelf, rcNull );
+    if ( item == NULL )
+        return RC ( rcCont, rcQueue, rcInserting, rcParam, rcNull );
+
+    item -> done = ! work;
+    item -> head = false;
+
+    rc = KOrderedQueuePush ( self, self -> order, item );
+    if ( rc != 0 )
+        ( * self -> whack ) ( item, self -> data );
+    else if ( work )
+    {
+        rc = KOrderedQueuePush ( self, self -> work, item );
+        if ( rc != 0 )
+            KOrderedQueueDone ( self, item ); /* nothing done, the consumer drops it */
+    }
+    return rc;
+}
+
+/* Seal
+ *  the producer submits no further items
+ */
+LIB_EXPORT rc_t CC KOrderedQueueSeal ( KOrderedQueue *self )
+{
+    rc_t rc;
+
+    if ( self == NULL )
+        return RC ( rcCont, rcQueue, rcFreezing, rcSelf, rcNull );
+
+    rc = KQueueSeal ( self -> work );
+    if ( rc == 0 )
+        rc = KQueueSeal ( self -> order );
+    return rc;
+}
+
+/* Quit
+ *  Submit and HeadWait stop waiting
+ */
+LIB_EXPORT rc_t CC KOrderedQueueQuit ( KOrderedQueue *self )
+{
+    rc_t rc;
+
+    if ( self == NULL )
+        return RC ( rcCont, rcQueue, rcUpdating, rcSelf, rcNull );
+
+    rc = KLockAcquire ( self -> lock );
+    if ( rc == 0 )
+    {
+        self -> quit = true;
+        KConditionBroadcast ( self -> cond );
+        KLockUnlock ( self -> lock );
+    }
+    return rc;
+}
+
+LIB_EXPORT bool CC KOrderedQueueQuitting ( const KOrderedQueue *self )
+{
+    return self == NULL || self -> quit;
+}
+
+/* Work
+ *  a worker takes the next item
+ */
+LIB_EXPORT rc_t CC KOrderedQueueWork ( KOrderedQueue *self, KOrderedItem **item )
+{
+    if ( item == NULL )
+        return RC ( rcCont, rcQueue, rcRemoving, rcParam, rcNull );
+    * item = NULL;
+    if ( self == NULL )
+        return RC ( rcCont, rcQueue, rcRemoving, rcSelf, rcNull );
+
+    * item = KOrderedQueuePop ( self -> work );
+    return 0;
+}
+
+/* Done
+ *  the worker hands the item back to the consumer
+ */
+LIB_EXPORT rc_t CC KOrderedQueueDone ( KOrderedQueue *self, KOrderedItem *item )
+{
+    rc_t rc;
+
+    if ( self == NULL )
+        return RC ( rcCont, rcQueue, rcUpdating, rcSelf, rcNull );
+    if ( item == NULL )
+        return RC ( rcCont, rcQueue, rcUpdating, rcParam, rcNull );
+
+    rc = KLockAcquire ( self -> lock );
+    if ( rc == 0 )
+    {
+        item -> done = true;
+        KConditionBroadcast ( self -> cond );
+        KLockUnlock ( self -> lock );
+    }
+    return rc;
+}
+
+/* HeadWait
+ *  the worker waits until the consumer waits for the item
+ */
+LIB_EXPORT rc_t CC KOrderedQueueHeadWait ( KOrderedQueue *self, KOrderedItem *item )
+{
+    rc_t rc;
+
+    if ( self == NULL )
+        return RC ( rcCont, rcQueue, rcWaiting, rcSelf, rcNull );
+    if ( item == NULL )
+        return RC ( rcCont, rcQueue, rcWaiting, rcParam, rcNull );
+
+    rc = KLockAcquire ( self -> lock );
+    if ( rc == 0 )
+    {
+        while ( ! item -> head && ! self -> quit && rc == 0 )
+            rc = KConditionWait ( self -> cond, self -> lock );
+        if ( rc == 0 && self -> quit )
+            rc = RC ( rcCont, rcQueue, rcWaiting, rcItem, rcCanceled );
+        KLockUnlock ( self -> lock );
+    }
+    return rc;
+}
+
+/* Next
+ *  the consumer takes the next item in submission order, once it is done
+ */
+LIB_EXPORT rc_t CC KOrderedQueueNext ( KOrderedQueue *self, KOrderedItem **itemp )
+{
+    rc_t rc;
+    KOrderedItem *item;
+
+    if ( itemp == NULL )
+        return RC ( rcCont, rcQueue, rcRemoving, rcParam, rcNull );
+    * itemp = NULL;
+    if ( self == NULL )
+        return RC ( rcCont, rcQueue, rcRemoving, rcSelf, rcNull );
+
+    /* a failed wait left its item here, the next call waits for it again */
+    item = self -> pending;
+    if ( item == NULL )
+    {
+        item = KOrderedQueuePop ( self -> order );
+        if ( item == NULL )
+            return 0;
+        self -> pending = item;
+    }
+
+    rc = KLockAcquire ( self -> lock );
+    if ( rc == 0 )
+    {
+        item -> head = true;
+        KConditionBroadcast ( self -> cond );
+        while ( ! item -> done && rc == 0 )
+            rc = KConditionWait ( self -> cond, self -> lock );
+        KLockUnlock ( self -> lock );
+    }
+
+    if ( rc == 0 )
+    {
+        self -> pending = NULL;
+        * itemp = item;
+    }
+    return rc;
+}
@@ -1216,6 +1216,67 @@ LIB_EXPORT rc_t CC VBlobCellData ( const VBlob *self, int64_t row_id,
     return rc;
 }
 
+LIB_EXPORT rc_t CC VBlobCellDataRange ( const VBlob *self, int64_t first_id,
+    uint32_t max_rows, uint32_t *elem_bits, const void **base,
+    uint32_t *offsets, uint32_t *lengths, uint32_t *num_rows )
+{
+    rc_t rc;
+    uint32_t dummy;
+
+    if ( elem_bits == NULL )
+        elem_bits = & dummy;
+
+    if ( base == NULL || num_rows == NULL )
+        rc = RC ( rcVDB, rcBlob, rcAccessing, rcParam, rcNull );
+    else
+    {
+        * num_rows = 0;
+
+        if ( offsets == NULL || lengths == NULL )
+            rc = RC ( rcVDB, rcBlob, rcAccessing, rcParam, rcNull );
+        else if ( max_rows == 0 )
+            rc = RC ( rcVDB, rcBlob, rcAccessing, rcParam, rcInvalid );
+        else if ( self == NULL )
+            rc = RC ( rcVDB, rcBlob, rcAccessing, rcSelf, rcNull );
+        else if ( first_id < self -> start_id || self -> stop_id < first_id )
+            rc = RC ( rcVDB, rcBlob, rcAccessing, rcRange, rcInvalid );
+        else
+        {
+            PageMapIterator iter;
+            uint64_t avail = ( uint64_t ) ( self -> stop_id - first_id ) + 1;
+            if ( avail > max_rows )
+                avail = max_rows;
+
+            rc = PageMapNewIterator ( self -> pm, & iter, first_id - self -> start_id, avail );
+            if ( rc == 0 )
+            {
+                uint32_t i = 0;
+
+                /* walk the expanded pagemap once for the whole run */
+                do
+                {
+                    offsets [ i ] = PageMapIteratorDataOffset ( & iter );
+                    lengths [ i ] = PageMapIteratorDataLength ( & iter );
+                    ++ i;
+                }
+                while ( i < avail && PageMapIteratorNext ( & iter ) );
+
+                * elem_bits = self -> data . elem_bits;
+                * base = self -> data . base;
+                * num_rows = i;
+
+                return 0;
+            }
+        }
+
+        * base = NULL;
+    }
+
+    * elem_bits = 0;
+
+    return rc;
+}
+
 /* a copy of VCursorRead() */
 LIB_EXPORT rc_t CC VBlobRead ( const VBlob *self, int64_t row_id,
     uint32_t elem_bits, void *buffer, uint32_t blen, uint32_t *row_len )
@@ -1522,7 +1583,8 @@ rc_t VBlobMRUCacheSave(const VBlobMRUCache *cself, uint32_t col_idx, const VBlob
         blob_size += 
                   KDataBufferBytes(&blob->pm->cstorage)
                 + KDataBufferBytes(&blob->pm->dstorage)
-                + KDataBufferBytes(&blob->pm->istorage);
+                + KDataBufferBytes(&blob->pm->istorage)
+                + KDataBufferBytes(&blob->pm->rstorage);
     }
     /** auto-raise capacity for large blob **/
     if(blob_size > self -> capacity) self -> capacity = blob_size;
@@ -1440,6 +1440,53 @@ rc_t VCursorReadColumnDirectInt ( const VCursor *cself, int64_t row_id, uint32_t
     return 0;
 }
 
+/* ReadColumnBlobInt
+ *  obtain a new reference to the blob holding "row_id",
+ *  going through the MRU cache as ReadColumnDirectInt does
+ */
+static
+rc_t VCursorReadColumnBlobInt ( const VCursor *self, int64_t row_id,
+    uint32_t col_idx, const VBlob **blobp )
+{
+    rc_t rc;
+    const VBlob *blob;
+    const void *base;
+    uint32_t elem_bits, boff, row_len;
+
+    const VColumn *col = ( const void* ) VectorGet ( & self -> row, col_idx );
+    if ( col == NULL )
+        return RC ( rcVDB, rcCursor, rcReading, rcColumn, rcInvalid );
+
+    if ( self -> blob_mru_cache == NULL )
+        rc = VColumnReadBlob ( col, & blob, row_id, & elem_bits, & base, & boff, & row_len, NULL );
+    else
+    {
+        VBlobMRUCacheCursorContext cctx;
+
+        blob = VBlobMRUCacheFind ( self -> blob_mru_cache, col_idx, row_id );
+        if ( blob != NULL )
+        {
+            rc = VBlobAddRef ( ( VBlob* ) blob );
+            if ( rc == 0 )
+                * blobp = blob;
+            return rc;
+        }
+
+        cctx . cache = self -> blob_mru_cache;
+        cctx . col_idx = col_idx;
+        rc = VColumnReadBlob ( col, & blob, row_id, & elem_bits, & base, & boff, & row_len, & cctx );
+        if ( rc == 0 && blob != NULL && blob -> stop_id > blob -> start_id + 4 )
+            VBlobMRUCacheSave ( self -> blob_mru_cache, col_idx, blob );
+    }
+
+    if ( rc == 0 && blob == NULL )
+        rc = RC ( rcVDB, rcCursor, rcReading, rcBlob, rcNull );
+    if ( rc == 0 )
+        * blobp = blob;
+
+    return rc;
+}
+
 /* GetBlob
  *  retrieve a blob of data containing the current row id
  * GetBlobDirect
@@ -1469,9 +1516,6 @@ LIB_EXPORT rc_t CC VCursorGetBlob ( const VCursor *self,
             rc = RC ( rcVDB, rcCursor, rcReading, rcCursor, rcWriteonly );
         else
         {
-            const void *base;
-            uint32_t elem_bits, boff, row_len;
-
             switch ( self -> state )
             {
             case vcConstruct:
@@ -1481,14 +1525,9 @@ LIB_EXPORT rc_t CC VCursorGetBlob ( const VCursor *self,
                 rc = RC ( rcVDB, rcCursor, rcReading, rcRow, rcNotOpen );
                 break;
             case vcRowOpen:
-                rc = VCursorReadColumnDirectInt
-                    ( self, self -> row_id, col_idx, &elem_bits, &base, &boff, &row_len, blob );
+                rc = VCursorReadColumnBlobInt ( self, self -> row_id, col_idx, blob );
                 if ( rc == 0 )
-                {
-                    rc = VBlobAddRef ( ( VBlob* ) *blob );
-                    if ( rc == 0 )
-                        return 0;
-                }
+                    return 0;
                 break;
             default:
                 rc = RC ( rcVDB, rcCursor, rcReading, rcCursor, rcInvalid );
@@ -1515,9 +1554,6 @@ LIB_EXPORT rc_t CC VCursorGetBlobDirect ( const VCursor *self,
             rc = RC ( rcVDB, rcCursor, rcReading, rcCursor, rcWriteonly );
         else
         {
-            const void *base;
-            uint32_t elem_bits, boff, row_len;
-
             switch ( self -> state )
             {
             case vcConstruct:
@@ -1525,14 +1561,9 @@ LIB_EXPORT rc_t CC VCursorGetBlobDirect ( const VCursor *self,
                 break;
             case vcReady:
             case vcRowOpen:
-                rc = VCursorReadColumnDirectInt
-                    ( self, row_id, col_idx, &elem_bits, &base, &boff, &row_len, blob );
+                rc = VCursorReadColumnBlobInt ( self, row_id, col_idx, blob );
                 if ( rc == 0 )
-                {
-                    rc = VBlobAddRef ( ( VBlob* ) *blob );
-                    if ( rc == 0 )
-                        return 0;
-                }
+                    return 0;
                 break;
             default:
                 rc = RC ( rcVDB, rcCursor, rcReading, rcCursor, rcInvalid );
@@ -1969,6 +2000,61 @@ LIB_EXPORT rc_t CC VCursorCellDataDirect ( const VCursor *self, int64_t row_id,
 }
 
 
+LIB_EXPORT rc_t CC VCursorCellDataRange ( const VCursor *self, uint32_t col_idx,
+    int64_t first_id, uint32_t max_rows, uint32_t *elem_bits, const void **base,
+    uint32_t *offsets, uint32_t *lengths, uint32_t *num_rows )
+{
+    rc_t rc;
+    uint32_t dummy;
+
+    if ( elem_bits == NULL )
+        elem_bits = & dummy;
+
+    if ( base == NULL || num_rows == NULL )
+        rc = RC ( rcVDB, rcCursor, rcReading, rcParam, rcNull );
+    else
+    {
+        * base = NULL;
+        * num_rows = 0;
+
+        if ( self == NULL )
+            rc = RC ( rcVDB, rcCursor, rcReading, rcSelf, rcNull );
+        else if ( ! self -> read_only )
+            rc = RC ( rcVDB, rcCursor, rcReading, rcCursor, rcWriteonly );
+        else if ( self -> state != vcReady && self -> state != vcRowOpen )
+        {
+            rc = ( self -> state == vcConstruct ) ?
+                RC ( rcVDB, rcCursor, rcReading, rcCursor, rcNotOpen ) :
+                RC ( rcVDB, rcCursor, rcReading, rcCursor, rcInvalid );
+        }
+        else
+        {
+            const VBlob *blob;
+            rc = VCursorReadColumnBlobInt ( self, first_id, col_idx, & blob );
+            if ( rc == 0 )
+            {
+                rc = VBlobCellDataRange ( blob, first_id, max_rows,
+                    elem_bits, base, offsets, lengths, num_rows );
+                if ( rc == 0 )
+                {
+                    const VColumn *col = ( const void* ) VectorGet ( & self -> row, col_idx );
+                    * elem_bits = VTypedescSizeof ( & col -> desc );
+                }
+
+                VBlobRelease ( ( VBlob* ) blob );
+
+                if ( rc == 0 )
+                    return 0;
+            }
+        }
+    }
+
+    * elem_bits = 0;
+
+    return rc;
+}
+
+
 /* OpenParent
  *  duplicate reference to parent table
  *  NB - returned reference must be released
@@ -68,6 +68,8 @@ rc_t VDatabaseLoadSchema ( VDatabase *self )
     rc_t rc = KMetadataOpenNodeRead ( self -> meta, & node, "schema" );
     if ( rc == 0 )
     {
+        VSchema *parsed = NULL;
+
         /* the node is probably within our 4K buffer,
            but by using the callback mechanism we don't
            have buffer or allocation issues. */
@@ -76,11 +78,24 @@ rc_t VDatabaseLoadSchema ( VDatabase *self )
         pb . pos = 0;
         pb . add_v0 = false;
 
-        /* add in schema text. it is not mandatory, but it is
-           the design of the system to store object schema with
-           the object so that it is capable of standing alone */
-        rc = VSchemaParseTextCallback ( self -> schema,
-            "VDatabaseLoadSchema", KMDataNodeFillSchema, & pb );
+        /* databases opened for read share parsed schema text */
+        if ( self -> read_only )
+            rc = VDBManagerCachedSchema ( self -> mgr, self -> schema -> dad,
+                node, "VDatabaseLoadSchema", & parsed );
+
+        if ( rc == 0 && parsed != NULL )
+        {
+            VSchemaRelease ( self -> schema );
+            self -> schema = parsed;
+        }
+        else if ( rc == 0 )
+        {
+            /* add in schema text. it is not mandatory, but it is
+               the design of the system to store object schema with
+               the object so that it is capable of standing alone */
+            rc = VSchemaParseTextCallback ( self -> schema,
+                "VDatabaseLoadSchema", KMDataNodeFillSchema, & pb );
+        }
         if ( rc == 0 )
         {
             /* determine database type */
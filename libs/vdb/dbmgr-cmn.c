@@ -88,6 +88,7 @@ rc_t VDBManagerWhack ( VDBManager *self )
             self -> user_whack = NULL;
         }
 
+        VSchemaCacheWhack ( self -> schema_cache );
         VSchemaRelease ( self -> schema );
         VLinkerRelease ( self -> linker );
         free ( self );
@@ -57,8 +57,10 @@ extern "C" {
  * forwards
  */
 struct KDBManager;
+struct KMDataNode;
 struct VSchema;
 struct VLinker;
+typedef struct VSchemaCache VSchemaCache;
 
 
 /*--------------------------------------------------------------------------
@@ -76,6 +78,9 @@ struct VDBManager
     /* intrinsic functions */
     struct VLinker *linker;
 
+    /* parsed metadata schemas */
+    VSchemaCache *schema_cache;
+
     /* user data */
     void *user;
     void ( CC * user_whack ) ( void *data );
@@ -100,6 +105,25 @@ rc_t VDBManagerSever ( const VDBManager *self );
 rc_t VDBManagerConfigPaths ( VDBManager *self, bool update );
 
 
+/* CachedSchema
+ *  parse the text of a metadata "schema" node on top of "dad"
+ *  or reuse the result of an earlier identical parse
+ *
+ *  "parsed" [ OUT ] - new, empty child of the parsed schema,
+ *  or NULL if "dad" cannot be used as a cache key
+ */
+rc_t VDBManagerCachedSchema ( const VDBManager *self, struct VSchema const *dad,
+    struct KMDataNode const *node, const char *name, struct VSchema **parsed );
+
+
+/*--------------------------------------------------------------------------
+ * VSchemaCache
+ *  parsed metadata schemas shared by all objects of a manager
+ */
+rc_t VSchemaCacheMake ( VSchemaCache **cache );
+void VSchemaCacheWhack ( VSchemaCache *self );
+
+
 /*--------------------------------------------------------------------------
  * generic whackers
  */
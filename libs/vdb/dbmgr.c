@@ -94,6 +94,8 @@ LIB_EXPORT rc_t CC VDBManagerMakeReadWithVFSManager ( const VDBManager **mgrp,
                     if ( rc == 0 )
                     {
                         rc = VDBManagerConfigPaths ( mgr, false );
+                        if ( rc == 0 )
+                            rc = VSchemaCacheMake ( & mgr -> schema_cache );
                         if ( rc == 0 )
                         {
                             mgr -> user = NULL;
@@ -116,6 +116,11 @@ VTRANSFACT_IMPL ( idx_text_insert, 1, 0, 0 ) ( const void *Self,
         rc = VTableCreateIndex ( ( VTable* ) info -> tbl, &self->ndx, kitText | kitProj, kcmOpen,
                                 "%.*s", cp->argv[0].count, cp->argv[0].data.ascii );
         if( rc == 0 ) {
+            /* a new index is filled here and only projected until
+               commit, so its keys can be sorted on disk instead of
+               held in a Trie. an existing index keeps in-core inserts */
+            KIndexSetBulkInsert(self->ndx, 0);
+
             rslt->self = self;
             rslt->whack = self_whack;
             rslt->variant = vftNonDetRow;
@@ -470,6 +470,79 @@ static int DEBUG_PageMapPrintSum(const PageMap *pm, uint32_t row)
 	printf("Leng recs= <%d>, rows_left = <%d>\n",i,r);
 	return 0;
 }
+/*** RUN INDEX ***
+ * A checkpoint of the position in the raw run arrays is kept for every
+ * PM_RUN_INDEX_STEP rows; together with the position of the previous lookup
+ * any row is found by stepping forward over at most PM_RUN_INDEX_STEP data runs.
+ * Building it is one pass over the data runs and nothing gets expanded
+ ****/
+#define PM_DATA_RUN(SELF,DR) ((SELF)->data_run?(SELF)->data_run[DR]:1)
+
+static void PageMapRunPosNext(const PageMap *cself,PageMapRunPos *pos)
+{
+	pos->row += PM_DATA_RUN(cself,pos->dr);
+	pos->data_offset += cself->length[pos->lr];
+	pos->dr++;
+	if(pos->row >= pos->lr_row + cself->leng_run[pos->lr]){
+		pos->lr_row += cself->leng_run[pos->lr];
+		pos->lr++;
+	}
+}
+
+static rc_t PageMapRunIndexBuild(const PageMap *cself)
+{
+	PageMap *self = (PageMap *)cself;
+	PageMapRunPos	pos,*ri;
+	pm_size_t	i,n;
+	rc_t		rc;
+
+	n = (self->row_count + PM_RUN_INDEX_STEP - 1) / PM_RUN_INDEX_STEP;
+	rc = KDataBufferResize(&self->rstorage, n);
+	if(rc) return rc;
+	ri = (PageMapRunPos *)self->rstorage.base;
+
+	memset(&pos,0,sizeof(pos));
+	for(i = 0; i < n; i++){
+		row_count_t row = i * PM_RUN_INDEX_STEP;
+		while(pos.row + PM_DATA_RUN(self,pos.dr) <= row){
+			if(pos.dr + 1 >= self->data_recs || pos.lr >= self->leng_recs)
+				return RC (rcVDB, rcPagemap, rcConstructing, rcData, rcInconsistent );
+			PageMapRunPosNext(self,&pos);
+		}
+		ri[i] = pos;
+	}
+	self->r_last = ri[0];
+	self->r_row_count = self->row_count;
+	return 0;
+}
+
+static rc_t PageMapRunIndexFindRow(const PageMap *cself,row_count_t row,uint32_t * data_offset,uint32_t * data_length,uint32_t * repeat_count)
+{
+	PageMap *self = (PageMap *)cself;
+	PageMapRunPos	pos;
+
+	if(row >= self->row_count)
+		return  RC (rcVDB, rcPagemap, rcSearching, rcRow, rcNotFound );
+	if(self->r_row_count != self->row_count){
+		rc_t rc = PageMapRunIndexBuild(self);
+		if(rc) return rc;
+	}
+	pos = ((const PageMapRunPos *)self->rstorage.base)[row / PM_RUN_INDEX_STEP];
+	/*** previous lookup is closer - typical for sequential scans ***/
+	if(self->r_last.row <= row && self->r_last.row >= pos.row)
+		pos = self->r_last;
+	while(pos.row + PM_DATA_RUN(self,pos.dr) <= row){
+		assert(pos.dr + 1 < self->data_recs);
+		PageMapRunPosNext(self,&pos);
+	}
+	self->r_last = pos;
+
+	if(data_length)  *data_length  = self->length[pos.lr];
+	if(data_offset)  *data_offset  = pos.data_offset;
+	if(repeat_count) *repeat_count = pos.row + PM_DATA_RUN(self,pos.dr) - row;
+	return 0;
+}
+
 rc_t PageMapFindRow(const PageMap *cself,uint64_t row,uint32_t * data_offset,uint32_t * data_length,uint32_t * repeat_count)
 {
 	rc_t	rc=0;
@@ -493,10 +566,14 @@ rc_t PageMapFindRow(const PageMap *cself,uint64_t row,uint32_t * data_offset,uin
 		return 0;
 	}
 
-	rc = PageMapFindRegion(cself,row,&pmr);
-	if(rc) return rc;
+	if(cself->random_access || row < cself->exp_row_last){
+		rc = PageMapFindRegion(cself,row,&pmr);
+		if(rc) return rc;
 
-        rc = PageMapRegionGetData(pmr,cself->dstorage.base,row,data_offset,data_length,repeat_count);
+		rc = PageMapRegionGetData(pmr,cself->dstorage.base,row,data_offset,data_length,repeat_count);
+	} else { /*** not expanded - do not expand just to find a row ***/
+		rc = PageMapRunIndexFindRow(cself,row,data_offset,data_length,repeat_count);
+	}
 	if(rc) return rc;
 
 #if _HEAVY_PAGEMAP_DEBUGGING
@@ -550,7 +627,7 @@ rc_t PageMapNewIterator(const PageMap *self, PageMapIterator *lhs, uint64_t firs
 	    rc = PageMapExpand(self,lhs->last_row-1);
 	    if(rc) return rc;
     }
-    rc = PageMapFindRow(self,first_row,NULL,NULL,NULL);
+    rc = PageMapFindRegion(self,first_row,NULL);
     if(rc) return rc;
     lhs->rgns    = (PageMapRegion**) &self->istorage.base;
     lhs->exp_base = (elem_count_t**) &self->dstorage.base;
@@ -569,6 +646,7 @@ static PageMap *new_PageMap(void) {
         KRefcountInit(&y->refcount, 1, "PageMap", "new", "");
 	y->istorage.elem_bits = sizeof(PageMapRegion)*8;
 	y->dstorage.elem_bits = sizeof(elem_count_t)*8;
+	y->rstorage.elem_bits = sizeof(PageMapRunPos)*8;
     }
     return y;
 }
@@ -604,6 +682,7 @@ static PageMap *new_StaticPageMap(unsigned length, unsigned data) {
         y->pm.reserve_data = data;
 	y->pm.istorage.elem_bits = sizeof(PageMapRegion)*8;
 	y->pm.dstorage.elem_bits = sizeof(elem_count_t)*8;
+	y->pm.rstorage.elem_bits = sizeof(PageMapRunPos)*8;
     }
     return &y->pm;
 }
@@ -1564,6 +1643,7 @@ rc_t PageMapDestroy(PageMap *that)
 #endif
     KDataBufferWhack(&that->istorage);
     KDataBufferWhack(&that->dstorage);
+    KDataBufferWhack(&that->rstorage);
     KDataBufferWhack(&that->cstorage);
     free(that);
     return 0;
@@ -67,6 +67,17 @@ typedef struct PageMapRegion {
 	bool		expanded;   /** if expandable storage is being used ***/
 } PageMapRegion;
 
+/** position of a data run inside the raw run arrays - used by the run index **/
+typedef struct PageMapRunPos {
+	row_count_t	row;        /** first row of data run dr **/
+	row_count_t	lr_row;     /** first row of length run lr **/
+	pm_size_t	lr;         /** index into length[] and leng_run[] **/
+	pm_size_t	dr;         /** index into data_run[] **/
+	elem_count_t	data_offset;/** offset into data of data run dr **/
+} PageMapRunPos;
+
+/** rows between checkpoints of the run index **/
+#define PM_RUN_INDEX_STEP 16
 
 
 
@@ -116,6 +127,11 @@ typedef struct PageMap {
     pm_size_t			i_rgn_last; 	/* region index found in previous lookup **/
     PageMapRegion*		rgn_last; 	/* redundant - region found in previous lookup **/
 
+/** RUN INDEX - row lookup without expansion *****/
+    KDataBuffer			rstorage;	/* one PageMapRunPos per PM_RUN_INDEX_STEP rows */
+    row_count_t			r_row_count;	/* row_count the run index was built for; 0 - not built */
+    PageMapRunPos		r_last;		/* data run found in previous lookup */
+
 /****************************/
 
     pm_size_t leng_recs;     /* number of valid elements in length[] and leng_run[] */
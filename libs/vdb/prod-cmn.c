@@ -519,6 +519,8 @@ rc_t VFunctionProdCallRowFunc( VFunctionProd *self, VBlob **prslt, int64_t row_i
     uint64_t last = 0;
     uint32_t last_len = 0;
     uint64_t  window;
+    uint64_t used = 0; /* elements of blob->data filled; capacity grows geometrically */
+    bool byte_aligned;
     
     if (argc == 0) {
         memset(&scratch, 0, sizeof(scratch));
@@ -604,6 +606,7 @@ rc_t VFunctionProdCallRowFunc( VFunctionProd *self, VBlob **prslt, int64_t row_i
     rslt.data = &scratch;
     rslt.elem_bits = scratch.elem_bits = blob->data.elem_bits = VTypedescSizeof(&self->dad.desc);
     blob->byte_order = vboNative;
+    byte_aligned = ( rslt.elem_bits & 7 ) == 0;
     
     /* create and populate array of input parameters */
     VECTOR_ALLOC_ARRAY(argc, argv, args_os, args_oh);
@@ -656,14 +659,28 @@ rc_t VFunctionProdCallRowFunc( VFunctionProd *self, VBlob **prslt, int64_t row_i
         assert(rslt.elem_count >> 32 == 0);
 
         if ( row_id == self->start_id || last_len != rslt.elem_count || 
-            bitcmp(blob->data.base, last * rslt.elem_bits,
-                   rslt.data->base, 0, rslt.elem_count * rslt.elem_bits) != 0)
+            ( byte_aligned ?
+              memcmp(((const char*)blob->data.base) + (last * rslt.elem_bits >> 3),
+                     rslt.data->base, (size_t)(rslt.elem_count * rslt.elem_bits >> 3)) :
+              bitcmp(blob->data.base, last * rslt.elem_bits,
+                     rslt.data->base, 0, rslt.elem_count * rslt.elem_bits) ) != 0)
         {
-            last = blob->data.elem_count;
-            rc = KDataBufferResize(&blob->data, blob->data.elem_count + rslt.elem_count);
+            last = used;
+            if (used + rslt.elem_count > blob->data.elem_count) {
+                /* double the buffer rather than growing it row by row */
+                uint64_t capacity = blob->data.elem_count * 2;
+                if (capacity < used + rslt.elem_count)
+                    capacity = used + rslt.elem_count;
+                rc = KDataBufferResize(&blob->data, capacity);
+            }
             if (rc == 0) {
-                bitcpy(blob->data.base, last * rslt.elem_bits,
-                       rslt.data->base, 0, rslt.elem_count * rslt.elem_bits);
+                if (byte_aligned)
+                    memcpy(((char*)blob->data.base) + (last * rslt.elem_bits >> 3),
+                           rslt.data->base, (size_t)(rslt.elem_count * rslt.elem_bits >> 3));
+                else
+                    bitcpy(blob->data.base, last * rslt.elem_bits,
+                           rslt.data->base, 0, rslt.elem_count * rslt.elem_bits);
+                used += rslt.elem_count;
                 rc = PageMapAppendRows(blob->pm, rslt.elem_count, row_count, false);
             }
         }
@@ -687,6 +704,10 @@ rc_t VFunctionProdCallRowFunc( VFunctionProd *self, VBlob **prslt, int64_t row_i
     if (args_oh) free(args_oh);
     if (iter_oh) free(iter_oh);
 
+    /* trim to the filled size: shrinking does not reallocate */
+    if (rc == 0)
+        rc = KDataBufferResize(&blob->data, used);
+
     if (rc == 0) {
         *prslt = blob;
         return 0;
@@ -0,0 +1,371 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include <vdb/extern.h>
+
+#define KONST const
+#include "dbmgr-priv.h"
+#undef KONST
+
+#include "schema-priv.h"
+
+#include <vdb/schema.h>
+#include <kdb/meta.h>
+#include <kproc/lock.h>
+#include <klib/checksum.h>
+#include <klib/rc.h>
+#include <sysalloc.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+
+/*--------------------------------------------------------------------------
+ * VSchemaCache
+ *  schema text stored in table and database metadata is parsed on every
+ *  open, yet a few schema versions cover nearly all objects. keep the
+ *  parsed result, keyed by the schema it was parsed against and an MD5
+ *  digest of the text. users get an empty child of the cached schema,
+ *  so anything added later ( physical column schema, etc. ) stays private.
+ */
+
+/* cached schemas are large - keep only a handful */
+#define SCHEMA_CACHE_SIZE 16
+
+typedef struct VSchemaCacheEntry VSchemaCacheEntry;
+struct VSchemaCacheEntry
+{
+    const VSchema *dad;
+    const VSchema *schema;
+    uint64_t stamp;
+    size_t bytes;
+    uint8_t digest [ 16 ];
+};
+
+struct VSchemaCache
+{
+    KLock *lock;
+    uint64_t stamp;
+    uint32_t count;
+    VSchemaCacheEntry entry [ SCHEMA_CACHE_SIZE ];
+};
+
+
+/* Make
+ * Whack
+ */
+rc_t VSchemaCacheMake ( VSchemaCache **cachep )
+{
+    rc_t rc;
+    VSchemaCache *cache = calloc ( 1, sizeof * cache );
+    if ( cache == NULL )
+        rc = RC ( rcVDB, rcMgr, rcConstructing, rcMemory, rcExhausted );
+    else
+    {
+        rc = KLockMake ( & cache -> lock );
+        if ( rc == 0 )
+        {
+            * cachep = cache;
+            return 0;
+        }
+
+        free ( cache );
+    }
+
+    * cachep = NULL;
+    return rc;
+}
+
+void VSchemaCacheWhack ( VSchemaCache *self )
+{
+    if ( self != NULL )
+    {
+        uint32_t i;
+        for ( i = 0; i < self -> count; ++ i )
+        {
+            VSchemaRelease ( self -> entry [ i ] . schema );
+            VSchemaRelease ( self -> entry [ i ] . dad );
+        }
+        KLockRelease ( self -> lock );
+        free ( self );
+    }
+}
+
+
+/* IsEmpty
+ *  true if nothing was ever added to "self" beyond what "dad" had
+ */
+static
+bool VSchemaIsEmpty ( const VSchema *self )
+{
+    return self -> dad != NULL &&
+        self -> file_count == 0 &&
+        self -> num_indirect == self -> dad -> num_indirect &&
+        VectorLength ( & self -> inc ) == 0 &&
+        VectorLength ( & self -> alias ) == 0 &&
+        VectorLength ( & self -> fmt ) == 0 &&
+        VectorLength ( & self -> dt ) == 0 &&
+        VectorLength ( & self -> ts ) == 0 &&
+        VectorLength ( & self -> pt ) == 0 &&
+        VectorLength ( & self -> cnst ) == 0 &&
+        VectorLength ( & self -> func ) == 0 &&
+        VectorLength ( & self -> phys ) == 0 &&
+        VectorLength ( & self -> tbl ) == 0 &&
+        VectorLength ( & self -> db ) == 0;
+}
+
+/* Known
+ *  true if "schema" is safe to key on:
+ *  the manager's intrinsic schema or one held by the cache
+ *  called under lock
+ */
+static
+bool VSchemaCacheKnown ( const VSchemaCache *self,
+    const VDBManager *mgr, const VSchema *schema )
+{
+    uint32_t i;
+
+    if ( schema == mgr -> schema )
+        return true;
+
+    for ( i = 0; i < self -> count; ++ i )
+    {
+        if ( self -> entry [ i ] . schema == schema )
+            return true;
+    }
+
+    return false;
+}
+
+/* Find
+ *  called under lock
+ */
+static
+VSchemaCacheEntry *VSchemaCacheFind ( VSchemaCache *self,
+    const VSchema *dad, const uint8_t digest [ 16 ], size_t bytes )
+{
+    uint32_t i;
+    for ( i = 0; i < self -> count; ++ i )
+    {
+        VSchemaCacheEntry *e = & self -> entry [ i ];
+        if ( e -> dad == dad && e -> bytes == bytes &&
+             memcmp ( e -> digest, digest, sizeof e -> digest ) == 0 )
+        {
+            e -> stamp = ++ self -> stamp;
+            return e;
+        }
+    }
+    return NULL;
+}
+
+/* Insert
+ *  takes over the reference to "schema", evicting the
+ *  least recently used entry when full
+ *  called under lock
+ */
+static
+rc_t VSchemaCacheInsert ( VSchemaCache *self, const VSchema *dad,
+    const VSchema *schema, const uint8_t digest [ 16 ], size_t bytes )
+{
+    rc_t rc;
+    VSchemaCacheEntry *e;
+
+    if ( self -> count < SCHEMA_CACHE_SIZE )
+        e = & self -> entry [ self -> count ++ ];
+    else
+    {
+        uint32_t i;
+        e = & self -> entry [ 0 ];
+        for ( i = 1; i < self -> count; ++ i )
+        {
+            if ( self -> entry [ i ] . stamp < e -> stamp )
+                e = & self -> entry [ i ];
+        }
+
+        VSchemaRelease ( e -> schema );
+        VSchemaRelease ( e -> dad );
+    }
+
+    rc = VSchemaAddRef ( dad );
+    if ( rc != 0 )
+    {
+        /* drop the slot */
+        * e = self -> entry [ -- self -> count ];
+        return rc;
+    }
+
+    e -> dad = dad;
+    e -> schema = schema;
+    e -> stamp = ++ self -> stamp;
+    e -> bytes = bytes;
+    memcpy ( e -> digest, digest, sizeof e -> digest );
+
+    return 0;
+}
+
+/* ReadText
+ *  read the entire value of a schema node
+ */
+static
+rc_t KMDataNodeReadSchemaText ( const KMDataNode *node, char **textp, size_t *bytes )
+{
+    size_t num_read, remaining;
+    rc_t rc = KMDataNodeRead ( node, 0, NULL, 0, & num_read, & remaining );
+    if ( rc == 0 )
+    {
+        char *text = malloc ( remaining + 1 );
+        if ( text == NULL )
+            rc = RC ( rcVDB, rcSchema, rcLoading, rcMemory, rcExhausted );
+        else
+        {
+            rc = KMDataNodeRead ( node, 0, text, remaining, & num_read, NULL );
+            if ( rc == 0 )
+            {
+                text [ num_read ] = 0;
+                * textp = text;
+                * bytes = num_read;
+                return 0;
+            }
+
+            free ( text );
+        }
+    }
+
+    return rc;
+}
+
+
+/* CachedSchema
+ *  parse the text of a metadata "schema" node on top of "dad"
+ *  or find the result of an earlier identical parse
+ *
+ *  "parsed" [ OUT ] - return parameter for a new, empty child of
+ *  the cached schema. NULL if "dad" is not one the cache can key on,
+ *  in which case the caller parses the text itself.
+ */
+rc_t VDBManagerCachedSchema ( const VDBManager *self, const VSchema *dad,
+    const KMDataNode *node, const char *name, VSchema **parsed )
+{
+    rc_t rc;
+    char *text;
+    size_t bytes;
+    MD5State md5;
+    uint8_t digest [ 16 ];
+    const VSchema *cached;
+    VSchemaCacheEntry *e;
+    VSchemaCache *cache;
+
+    assert ( parsed != NULL );
+    * parsed = NULL;
+
+    if ( self == NULL || self -> schema_cache == NULL || dad == NULL )
+        return 0;
+    cache = self -> schema_cache;
+
+    /* empty children are equivalent to their parent */
+    while ( VSchemaIsEmpty ( dad ) )
+        dad = dad -> dad;
+
+    rc = KMDataNodeReadSchemaText ( node, & text, & bytes );
+    if ( rc != 0 )
+        return rc;
+
+    MD5StateInit ( & md5 );
+    MD5StateAppend ( & md5, text, bytes );
+    MD5StateFinish ( & md5, digest );
+
+    rc = KLockAcquire ( cache -> lock );
+    if ( rc == 0 )
+    {
+        cached = NULL;
+        if ( ! VSchemaCacheKnown ( cache, self, dad ) )
+        {
+            /* leave it to the caller */
+            KLockUnlock ( cache -> lock );
+            free ( text );
+            return 0;
+        }
+
+        e = VSchemaCacheFind ( cache, dad, digest, bytes );
+        if ( e != NULL )
+        {
+            cached = e -> schema;
+            rc = VSchemaAddRef ( cached );
+        }
+
+        KLockUnlock ( cache -> lock );
+
+        if ( rc == 0 && cached == NULL )
+        {
+            /* parse outside of the lock */
+            VSchema *schema;
+            rc = VSchemaMake ( & schema, dad );
+            if ( rc == 0 )
+            {
+                rc = VSchemaParseText ( schema, name, text, bytes );
+                if ( rc == 0 )
+                {
+                    rc = KLockAcquire ( cache -> lock );
+                    if ( rc == 0 )
+                    {
+                        /* another thread may have beaten us to it */
+                        e = VSchemaCacheFind ( cache, dad, digest, bytes );
+                        if ( e != NULL )
+                            cached = e -> schema;
+                        else if ( VSchemaCacheKnown ( cache, self, dad ) &&
+                                  VSchemaCacheInsert ( cache, dad, schema, digest, bytes ) == 0 )
+                        {
+                            cached = schema;
+                            schema = NULL;
+                        }
+                        rc = VSchemaAddRef ( cached );
+
+                        KLockUnlock ( cache -> lock );
+                    }
+
+                    if ( cached == NULL && rc == 0 )
+                    {
+                        /* could not be cached - hand it out directly */
+                        cached = schema;
+                        schema = NULL;
+                    }
+                }
+
+                VSchemaRelease ( schema );
+            }
+        }
+
+        if ( rc == 0 )
+        {
+            rc = VSchemaMake ( parsed, cached );
+            VSchemaRelease ( cached );
+        }
+    }
+
+    free ( text );
+    return rc;
+}
@@ -134,6 +134,7 @@ static
 rc_t VTableLoadSchemaNode ( VTable *self, const KMDataNode *node )
 {
     rc_t rc;
+    VSchema *parsed = NULL;
     
     /* the node is probably within our 4K buffer,
      but by using the callback mechanism we don't
@@ -143,11 +144,26 @@ rc_t VTableLoadSchemaNode ( VTable *self, const KMDataNode *node )
     pb . pos = 0;
     pb . add_v0 = false;
     
-    /* add in schema text. it is not mandatory, but it is
-     the design of the system to store object schema with
-     the object so that it is capable of standing alone */
-    rc = VSchemaParseTextCallback ( self -> schema,
-        "VTableLoadSchema", KMDataNodeFillSchema, & pb );
+    /* tables opened for read share parsed schema text */
+    if ( self -> read_only )
+        rc = VDBManagerCachedSchema ( self -> mgr, self -> schema -> dad,
+            node, "VTableLoadSchema", & parsed );
+    else
+        rc = 0;
+
+    if ( rc == 0 && parsed != NULL )
+    {
+        VSchemaRelease ( self -> schema );
+        self -> schema = parsed;
+    }
+    else if ( rc == 0 )
+    {
+        /* add in schema text. it is not mandatory, but it is
+         the design of the system to store object schema with
+         the object so that it is capable of standing alone */
+        rc = VSchemaParseTextCallback ( self -> schema,
+            "VTableLoadSchema", KMDataNodeFillSchema, & pb );
+    }
     if ( rc == 0 )
     {
         /* determine table type */
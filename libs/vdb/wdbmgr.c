@@ -82,6 +82,8 @@ LIB_EXPORT rc_t CC VDBManagerMakeUpdate ( VDBManager **mgrp,  KDirectory *wd )
                     if ( rc == 0 )
                     {
                         rc = VDBManagerConfigPaths ( mgr, true );
+                        if ( rc == 0 )
+                            rc = VSchemaCacheMake ( & mgr -> schema_cache );
                         if ( rc == 0 )
                         {
                             mgr -> user = NULL;
@@ -37,6 +37,7 @@
 #include <kns/KCurlRequest.h>
 #include <kfs/file.h>
 #include <kfs/directory.h>
+#include <kproc/lock.h>
 #include <kfg/repository.h>
 #include <kfg/config.h>
 
@@ -46,6 +47,7 @@
 #include <klib/namelist.h>
 #include <klib/printf.h>
 #include <klib/data-buffer.h>
+#include <klib/time.h>
 #include <klib/debug.h>
 #include <klib/log.h>
 #include <klib/rc.h>
@@ -59,6 +61,7 @@
 #include <string.h>
 #include <ctype.h>
 #include <assert.h>
+#include <strtol.h>
 
 /* to turn off CGI name resolution for
    any refseq accessions */
@@ -765,28 +768,28 @@ rc_t VResolverAlgParseResolverCGIResponse_1_0 ( const char *start, size_t size,
     const char *end = start + size;
     const char *sep = string_chr ( start, size, '|' );
     if ( sep == NULL )
-        return RC ( rcVFS, rcResolver, rcResolving, rcName, rcNotFound );
+        return RC ( rcVFS, rcResolver, rcResolving, rcMessage, rcCorrupt );
     StringInit ( & accession, start, sep - start, ( uint32_t ) ( sep - start ) );
 
     /* get download-ticket */
     start = sep + 1;
     sep = string_chr ( start, end - start, '|' );
     if ( sep == NULL )
-        return RC ( rcVFS, rcResolver, rcResolving, rcName, rcNotFound );
+        return RC ( rcVFS, rcResolver, rcResolving, rcMessage, rcCorrupt );
     StringInit ( & download_ticket, start, sep - start, ( uint32_t ) ( sep - start ) );
 
     /* get url */
     start = sep + 1;
     sep = string_chr ( start, end - start, '|' );
     if ( sep == NULL )
-        return RC ( rcVFS, rcResolver, rcResolving, rcName, rcNotFound );
+        return RC ( rcVFS, rcResolver, rcResolving, rcMessage, rcCorrupt );
     StringInit ( & url, start, sep - start, ( uint32_t ) ( sep - start ) );
 
     /* get result-code */
     start = sep + 1;
     sep = string_chr ( start, end - start, '|' );
     if ( sep == NULL )
-        return RC ( rcVFS, rcResolver, rcResolving, rcName, rcNotFound );
+        return RC ( rcVFS, rcResolver, rcResolving, rcMessage, rcCorrupt );
     StringInit ( & rslt_code, start, sep - start, ( uint32_t ) ( sep - start ) );
 
     /* get msg */
@@ -944,63 +947,63 @@ rc_t VResolverAlgParseResolverCGIResponse_1_1 ( const char *start, size_t size,
     const char *end = start + size;
     const char *sep = string_chr ( start, size, '|' );
     if ( sep == NULL )
-        return RC ( rcVFS, rcResolver, rcResolving, rcName, rcNotFound );
+        return RC ( rcVFS, rcResolver, rcResolving, rcMessage, rcCorrupt );
     StringInit ( & accession, start, sep - start, ( uint32_t ) ( sep - start ) );
 
     /* get obj-id */
     start = sep + 1;
     sep = string_chr ( start, end - start, '|' );
     if ( sep == NULL )
-        return RC ( rcVFS, rcResolver, rcResolving, rcName, rcNotFound );
+        return RC ( rcVFS, rcResolver, rcResolving, rcMessage, rcCorrupt );
     StringInit ( & obj_id, start, sep - start, ( uint32_t ) ( sep - start ) );
 
     /* get name */
     start = sep + 1;
     sep = string_chr ( start, end - start, '|' );
     if ( sep == NULL )
-        return RC ( rcVFS, rcResolver, rcResolving, rcName, rcNotFound );
+        return RC ( rcVFS, rcResolver, rcResolving, rcMessage, rcCorrupt );
     StringInit ( & name, start, sep - start, ( uint32_t ) ( sep - start ) );
 
     /* get size */
     start = sep + 1;
     sep = string_chr ( start, end - start, '|' );
     if ( sep == NULL )
-        return RC ( rcVFS, rcResolver, rcResolving, rcName, rcNotFound );
+        return RC ( rcVFS, rcResolver, rcResolving, rcMessage, rcCorrupt );
     StringInit ( & size_str, start, sep - start, ( uint32_t ) ( sep - start ) );
 
     /* get mod-date */
     start = sep + 1;
     sep = string_chr ( start, end - start, '|' );
     if ( sep == NULL )
-        return RC ( rcVFS, rcResolver, rcResolving, rcName, rcNotFound );
+        return RC ( rcVFS, rcResolver, rcResolving, rcMessage, rcCorrupt );
     StringInit ( & mod_date, start, sep - start, ( uint32_t ) ( sep - start ) );
 
     /* get md5 */
     start = sep + 1;
     sep = string_chr ( start, end - start, '|' );
     if ( sep == NULL )
-        return RC ( rcVFS, rcResolver, rcResolving, rcName, rcNotFound );
+        return RC ( rcVFS, rcResolver, rcResolving, rcMessage, rcCorrupt );
     StringInit ( & md5, start, sep - start, ( uint32_t ) ( sep - start ) );
 
     /* get download-ticket */
     start = sep + 1;
     sep = string_chr ( start, end - start, '|' );
     if ( sep == NULL )
-        return RC ( rcVFS, rcResolver, rcResolving, rcName, rcNotFound );
+        return RC ( rcVFS, rcResolver, rcResolving, rcMessage, rcCorrupt );
     StringInit ( & download_ticket, start, sep - start, ( uint32_t ) ( sep - start ) );
 
     /* get url */
     start = sep + 1;
     sep = string_chr ( start, end - start, '|' );
     if ( sep == NULL )
-        return RC ( rcVFS, rcResolver, rcResolving, rcName, rcNotFound );
+        return RC ( rcVFS, rcResolver, rcResolving, rcMessage, rcCorrupt );
     StringInit ( & url, start, sep - start, ( uint32_t ) ( sep - start ) );
 
     /* get result-code */
     start = sep + 1;
     sep = string_chr ( start, end - start, '|' );
     if ( sep == NULL )
-        return RC ( rcVFS, rcResolver, rcResolving, rcName, rcNotFound );
+        return RC ( rcVFS, rcResolver, rcResolving, rcMessage, rcCorrupt );
     StringInit ( & rslt_code, start, sep - start, ( uint32_t ) ( sep - start ) );
 
     /* get msg */
@@ -1235,7 +1238,7 @@ rc_t VResolverAlgParseResolverCGIResponse ( const KDataBuffer *result,
         while ( false );
     }
 
-    return RC ( rcVFS, rcResolver, rcResolving, rcName, rcNotFound );
+    return RC ( rcVFS, rcResolver, rcResolving, rcMessage, rcUnsupported );
 }
 
 /* RemoteProtectedResolve
@@ -1431,13 +1434,19 @@ rc_t VResolverAlgRemoteProtectedResolve ( const VResolverAlg *self,
                         KStreamRelease ( response );
                     }
                 }
+                else if ( rc == 0 )
+                    rc = RC ( rcVFS, rcResolver, rcResolving, rcError, rcUnexpected );
                 KHttpResultRelease ( rslt );
             }
         }
         KHttpRequestRelease ( req );
     }
 #endif
-    return rc == 0 ? 0 : RC ( rcVFS, rcResolver, rcResolving, rcName, rcNotFound );
+
+    /* only an answer of the service itself says that the accession
+       does not exist. transport failures are passed through as-is,
+       so that callers do not mistake an outage for a missing object */
+    return rc;
 }
 
 /* RemoteResolve
@@ -1452,7 +1461,7 @@ rc_t VResolverAlgRemoteResolve ( const VResolverAlg *self,
     const KNSManager *kns, VRemoteProtocols protocols, const VResolverAccToken *tok,
     const VPath ** path, const VPath ** mapping, const KFile ** opt_file_rtn, bool legacy_wgs_refseq )
 {
-    rc_t rc;
+    rc_t rc, failed;
     uint32_t i, count;
 
     /* expanded accession */
@@ -1514,7 +1523,7 @@ rc_t VResolverAlgRemoteResolve ( const VResolverAlg *self,
 
     /* now search all remote volumes */
     count = VectorLength ( & self -> vols );
-    for ( i = 0; i < count; ++ i )
+    for ( failed = 0, i = 0; i < count; ++ i )
     {
         char url [ 8192 ];
         const String *vol = VectorGet ( & self -> vols, i );
@@ -1527,6 +1536,9 @@ rc_t VResolverAlgRemoteResolve ( const VResolverAlg *self,
 #else
             rc = KNSManagerMakeHttpFile ( kns, & f, NULL, 0x01010000, url );
 #endif
+            /* remember the first failure other than a missing file */
+            if ( rc != 0 && GetRCState ( rc ) != rcNotFound && failed == 0 )
+                failed = rc;
             if ( rc == 0 )
             {
                 if ( opt_file_rtn != NULL )
@@ -1540,7 +1552,10 @@ rc_t VResolverAlgRemoteResolve ( const VResolverAlg *self,
             }
         }
     }
-    
+
+    if ( failed != 0 )
+        return failed;
+
     return RC ( rcVFS, rcResolver, rcResolving, rcName, rcNotFound );
 }
 
@@ -1652,6 +1667,77 @@ rc_t VResolverAlgMakeCacheFilePath ( const VResolverAlg *self,
 
 
 
+/* AnswerCache
+ *  remembers recent answers of the resolver
+ *
+ *  every remote resolution is a round trip to a CGI, which dominates
+ *  the cost of opening an accession, and every local resolution walks
+ *  all volumes of all local repositories probing the file system.
+ *  answers are kept per resolver for a limited time, and "not found"
+ *  answers for a shorter one, so that repeated queries for the same
+ *  accession within a process are answered from memory.
+ *
+ *  a remote "not found" is only remembered when the name service said
+ *  so. a local path is probed once more before it is handed out, and a
+ *  local "not found" lives just long enough to cover a burst of queries.
+ */
+#define REMOTE_CACHE_SIZE 64
+#define REMOTE_CACHE_TTL 600
+#define REMOTE_CACHE_NEG_TTL 30
+
+#define LOCAL_CACHE_SIZE 64
+#define LOCAL_CACHE_TTL 60
+#define LOCAL_CACHE_NEG_TTL 2
+
+/* remote key flags */
+#define REMOTE_CACHE_REFSEQ  0x100
+#define REMOTE_CACHE_OID     0x200
+#define REMOTE_CACHE_MAPPING 0x400
+#define REMOTE_CACHE_FORCED  0x800
+
+/* local key flags */
+#define LOCAL_CACHE_REFSEQ   0x1
+#define LOCAL_CACHE_FILE     0x2
+
+typedef struct VResolverAnswerCacheEntry VResolverAnswerCacheEntry;
+struct VResolverAnswerCacheEntry
+{
+    const String * acc;
+    const VPath * path;
+    const VPath * mapping;
+    KTime_t expires;
+    uint64_t stamp;
+    rc_t rc;
+    uint32_t flags;
+};
+
+typedef struct VResolverAnswerCache VResolverAnswerCache;
+struct VResolverAnswerCache
+{
+    KLock * lock;
+    uint64_t clock;
+    uint32_t size;
+    KTime_t ttl, neg_ttl;
+    VResolverAnswerCacheEntry e [ 1 ];
+};
+
+/* DiskCache
+ *  remote answers that outlive the process
+ *
+ *  configured by "/vfs/resolver-cache/root", a directory holding one
+ *  small text file per answer, and "/vfs/resolver-cache/ttl", the life
+ *  of a positive answer in seconds. answers carrying download tickets
+ *  are never written.
+ */
+#define DISK_CACHE_TTL 3600
+
+typedef struct VResolverDiskCache VResolverDiskCache;
+struct VResolverDiskCache
+{
+    KDirectory * dir;
+    KTime_t ttl;
+};
+
 /*--------------------------------------------------------------------------
  * VResolver
  */
@@ -1682,9 +1768,434 @@ struct VResolver
 
     /* preferred protocols preferences. Default: HTTP */
     VRemoteProtocols protocols;
+
+    /* recent answers of the remote and local resolvers,
+       NULL if unavailable */
+    VResolverAnswerCache * remote_cache;
+    VResolverAnswerCache * local_cache;
+
+    /* remote answers kept on disk, NULL if not configured */
+    VResolverDiskCache * disk_cache;
 };
 
 
+/* ConfirmedNotFound
+ *  true if the rc says that the name service or the server
+ *  answered that the accession does not exist
+ */
+static
+bool VResolverConfirmedNotFound ( rc_t rc )
+{
+    return rc == RC ( rcVFS, rcResolver, rcResolving, rcName, rcNotFound );
+}
+
+static
+void VResolverAnswerCacheEntryWhack ( VResolverAnswerCacheEntry * entry )
+{
+    if ( entry -> acc != NULL )
+        StringWhack ( ( String* ) entry -> acc );
+    VPathRelease ( entry -> path );
+    VPathRelease ( entry -> mapping );
+    memset ( entry, 0, sizeof * entry );
+}
+
+static
+void VResolverAnswerCacheWhack ( VResolverAnswerCache * self )
+{
+    uint32_t i;
+    for ( i = 0; i < self -> size; ++ i )
+        VResolverAnswerCacheEntryWhack ( & self -> e [ i ] );
+    KLockRelease ( self -> lock );
+    free ( self );
+}
+
+static
+VResolverAnswerCache * VResolverAnswerCacheMake ( uint32_t size, KTime_t ttl, KTime_t neg_ttl )
+{
+    VResolverAnswerCache * cache = calloc ( 1, sizeof * cache +
+        ( size - 1 ) * sizeof cache -> e [ 0 ] );
+    if ( cache != NULL )
+    {
+        cache -> size = size;
+        cache -> ttl = ttl;
+        cache -> neg_ttl = neg_ttl;
+        if ( KLockMake ( & cache -> lock ) == 0 )
+            return cache;
+        free ( cache );
+    }
+
+    /* the cache is an optimization - work without it */
+    return NULL;
+}
+
+/* Get
+ *  look for a live answer
+ *  returns true if found, with "rc" set to the cached outcome
+ */
+static
+bool VResolverAnswerCacheGet ( VResolverAnswerCache * self, const String * accession,
+    uint32_t flags, const VPath ** path, const VPath ** mapping, rc_t * rc )
+{
+    uint32_t i;
+    bool found = false;
+    KTime_t now = KTimeStamp ();
+
+    if ( KLockAcquire ( self -> lock ) != 0 )
+        return false;
+
+    for ( i = 0; i < self -> size; ++ i )
+    {
+        VResolverAnswerCacheEntry * entry = & self -> e [ i ];
+        if ( entry -> acc != NULL && entry -> flags == flags &&
+             StringEqual ( entry -> acc, accession ) )
+        {
+            if ( entry -> expires <= now )
+            {
+                VResolverAnswerCacheEntryWhack ( entry );
+                break;
+            }
+
+            * rc = entry -> rc;
+            if ( entry -> rc == 0 )
+            {
+                * rc = VPathAddRef ( entry -> path );
+                if ( * rc == 0 )
+                {
+                    * path = entry -> path;
+                    if ( mapping != NULL )
+                    {
+                        * rc = VPathAddRef ( entry -> mapping );
+                        if ( * rc == 0 )
+                            * mapping = entry -> mapping;
+                        else
+                        {
+                            VPathRelease ( * path );
+                            * path = NULL;
+                        }
+                    }
+                }
+            }
+
+            entry -> stamp = ++ self -> clock;
+            found = true;
+            break;
+        }
+    }
+
+    KLockUnlock ( self -> lock );
+    return found;
+}
+
+/* Put
+ *  record an answer, replacing the least recently used entry
+ *  only successes and confirmed "not found" are recorded
+ */
+static
+void VResolverAnswerCachePut ( VResolverAnswerCache * self, const String * accession,
+    uint32_t flags, const VPath * path, const VPath * mapping, rc_t rc )
+{
+    uint32_t i;
+    VResolverAnswerCacheEntry * victim;
+
+    if ( rc != 0 && ! VResolverConfirmedNotFound ( rc ) )
+        return;
+
+    if ( KLockAcquire ( self -> lock ) != 0 )
+        return;
+
+    victim = & self -> e [ 0 ];
+    for ( i = 0; i < self -> size; ++ i )
+    {
+        VResolverAnswerCacheEntry * entry = & self -> e [ i ];
+        if ( entry -> acc == NULL ||
+             ( entry -> flags == flags && StringEqual ( entry -> acc, accession ) ) )
+        {
+            victim = entry;
+            break;
+        }
+        if ( entry -> stamp < victim -> stamp )
+            victim = entry;
+    }
+
+    VResolverAnswerCacheEntryWhack ( victim );
+
+    if ( StringCopy ( & victim -> acc, accession ) == 0 )
+    {
+        if ( rc == 0 )
+        {
+            if ( VPathAddRef ( path ) == 0 )
+                victim -> path = path;
+            if ( mapping != NULL && VPathAddRef ( mapping ) == 0 )
+                victim -> mapping = mapping;
+            if ( victim -> path == NULL ||
+                 ( ( flags & REMOTE_CACHE_MAPPING ) != 0 && victim -> mapping == NULL ) )
+            {
+                VResolverAnswerCacheEntryWhack ( victim );
+                KLockUnlock ( self -> lock );
+                return;
+            }
+        }
+
+        victim -> rc = rc;
+        victim -> flags = flags;
+        victim -> expires = KTimeStamp () + ( rc == 0 ? self -> ttl : self -> neg_ttl );
+        victim -> stamp = ++ self -> clock;
+    }
+
+    KLockUnlock ( self -> lock );
+}
+
+/* Forget
+ *  drop an answer, e.g. one that turned out to be stale
+ *  when "misses_only" is true, only "not found" answers are dropped,
+ *  whatever their flags
+ */
+static
+void VResolverAnswerCacheForget ( VResolverAnswerCache * self, const String * accession,
+    uint32_t flags, bool misses_only )
+{
+    uint32_t i;
+
+    if ( KLockAcquire ( self -> lock ) != 0 )
+        return;
+
+    for ( i = 0; i < self -> size; ++ i )
+    {
+        VResolverAnswerCacheEntry * entry = & self -> e [ i ];
+        if ( entry -> acc != NULL && StringEqual ( entry -> acc, accession ) )
+        {
+            if ( misses_only ? entry -> rc != 0 : entry -> flags == flags )
+                VResolverAnswerCacheEntryWhack ( entry );
+        }
+    }
+
+    KLockUnlock ( self -> lock );
+}
+
+
+/* DiskCacheMake
+ *  returns NULL unless configured and usable
+ */
+static
+VResolverDiskCache * VResolverDiskCacheMake ( const KConfig * cfg )
+{
+    rc_t rc;
+    size_t num_read;
+    char root [ 4096 ];
+    VResolverDiskCache * cache;
+
+    const KConfigNode * node;
+    if ( KConfigOpenNodeRead ( cfg, & node, "/vfs/resolver-cache/root" ) != 0 )
+        return NULL;
+    rc = KConfigNodeRead ( node, 0, root, sizeof root - 1, & num_read, NULL );
+    KConfigNodeRelease ( node );
+    if ( rc != 0 || num_read == 0 )
+        return NULL;
+    root [ num_read ] = 0;
+
+    cache = calloc ( 1, sizeof * cache );
+    if ( cache != NULL )
+    {
+        KDirectory * ndir;
+
+        cache -> ttl = DISK_CACHE_TTL;
+        if ( KConfigOpenNodeRead ( cfg, & node, "/vfs/resolver-cache/ttl" ) == 0 )
+        {
+            uint64_t ttl;
+            if ( KConfigNodeReadU64 ( node, & ttl ) == 0 )
+                cache -> ttl = ( KTime_t ) ttl;
+            KConfigNodeRelease ( node );
+        }
+
+        if ( cache -> ttl > 0 && KDirectoryNativeDir ( & ndir ) == 0 )
+        {
+            rc = KDirectoryCreateDir ( ndir, 0775, kcmOpen | kcmParents, "%s", root );
+            if ( rc == 0 )
+                rc = KDirectoryOpenDirUpdate ( ndir, & cache -> dir, false, "%s", root );
+            KDirectoryRelease ( ndir );
+            if ( rc == 0 )
+                return cache;
+        }
+
+        free ( cache );
+    }
+
+    /* the cache is an optimization - work without it */
+    return NULL;
+}
+
+static
+void VResolverDiskCacheWhack ( VResolverDiskCache * self )
+{
+    KDirectoryRelease ( self -> dir );
+    free ( self );
+}
+
+/* DiskCacheName
+ *  the file name of an answer, or false if the accession
+ *  cannot be used as part of a file name
+ */
+static
+bool VResolverDiskCacheName ( const String * accession, uint32_t flags,
+    char * name, size_t bsize )
+{
+    size_t i;
+
+    if ( accession -> size == 0 || accession -> addr [ 0 ] == '.' )
+        return false;
+    for ( i = 0; i < accession -> size; ++ i )
+    {
+        if ( isalnum ( accession -> addr [ i ] ) )
+            continue;
+        switch ( accession -> addr [ i ] )
+        {
+        case '.':
+        case '_':
+        case '-':
+            continue;
+        }
+        return false;
+    }
+
+    return string_printf ( name, bsize, NULL, "%S.%x", accession, flags ) == 0;
+}
+
+/* DiskCacheGet
+ *  an answer is stored as four lines:
+ *    <expiration time>
+ *    <0 for a path, 1 for not found>
+ *    <path url>
+ *    <mapping url>
+ */
+static
+bool VResolverDiskCacheGet ( const VResolverDiskCache * self, const String * accession,
+    uint32_t flags, const VPath ** path, const VPath ** mapping, rc_t * rc )
+{
+    const KFile * f;
+    char name [ 256 ];
+    char text [ 8192 ];
+    size_t num_read;
+    const char * line [ 4 ];
+    uint32_t i, count;
+    uint64_t expires;
+    char * end;
+
+    if ( ! VResolverDiskCacheName ( accession, flags, name, sizeof name ) )
+        return false;
+    if ( KDirectoryOpenFileRead ( self -> dir, & f, "%s", name ) != 0 )
+        return false;
+    * rc = KFileReadAll ( f, 0, text, sizeof text - 1, & num_read );
+    KFileRelease ( f );
+    if ( * rc != 0 || num_read == 0 || num_read == sizeof text - 1 )
+        return false;
+    text [ num_read ] = 0;
+
+    /* split into lines */
+    for ( line [ 0 ] = text, count = 1, i = 0; i < num_read; ++ i )
+    {
+        if ( text [ i ] == '\n' )
+        {
+            text [ i ] = 0;
+            if ( count == 4 )
+                break;
+            line [ count ++ ] = & text [ i + 1 ];
+        }
+    }
+    if ( count != 4 || i == num_read )
+        return false;
+
+    /* a written answer is always complete: the file is renamed into place */
+    expires = strtou64 ( line [ 0 ], & end, 10 );
+    if ( * end != 0 || ( KTime_t ) expires <= KTimeStamp () )
+        return false;
+
+    if ( strcmp ( line [ 1 ], "1" ) == 0 )
+    {
+        * rc = RC ( rcVFS, rcResolver, rcResolving, rcName, rcNotFound );
+        return true;
+    }
+    if ( strcmp ( line [ 1 ], "0" ) != 0 || line [ 2 ] [ 0 ] == 0 )
+        return false;
+    if ( mapping != NULL && line [ 3 ] [ 0 ] == 0 )
+        return false;
+
+    * rc = VPathMakeFmt ( ( VPath** ) path, "%s", line [ 2 ] );
+    if ( * rc == 0 && mapping != NULL )
+    {
+        * rc = VPathMakeFmt ( ( VPath** ) mapping, "%s", line [ 3 ] );
+        if ( * rc != 0 )
+        {
+            VPathRelease ( * path );
+            * path = NULL;
+        }
+    }
+
+    return * rc == 0;
+}
+
+/* DiskCachePut
+ *  written into a scratch file and renamed into place,
+ *  so that readers never see a partial answer
+ */
+static
+void VResolverDiskCachePut ( const VResolverDiskCache * self, const String * accession,
+    uint32_t flags, const VPath * path, const VPath * mapping, rc_t rc, uint64_t unique )
+{
+    KFile * f;
+    char name [ 256 ], tmp [ 300 ];
+    char text [ 8192 ];
+    size_t num_writ, size;
+    const String * path_str = NULL, * mapping_str = NULL;
+
+    if ( rc != 0 && ! VResolverConfirmedNotFound ( rc ) )
+        return;
+    if ( ! VResolverDiskCacheName ( accession, flags, name, sizeof name ) )
+        return;
+
+    if ( rc == 0 )
+    {
+        String empty;
+        CONST_STRING ( & empty, "" );
+
+        rc = VPathMakeString ( path, & path_str );
+        if ( rc == 0 && mapping != NULL )
+            rc = VPathMakeString ( mapping, & mapping_str );
+        if ( rc == 0 )
+        {
+            rc = string_printf ( text, sizeof text, & size, "%lu\n0\n%S\n%S\n",
+                ( uint64_t ) ( KTimeStamp () + self -> ttl ), path_str,
+                mapping_str == NULL ? & empty : mapping_str );
+        }
+        free ( ( void* ) path_str );
+        free ( ( void* ) mapping_str );
+    }
+    else
+    {
+        KTime_t ttl = self -> ttl < REMOTE_CACHE_NEG_TTL ? self -> ttl : REMOTE_CACHE_NEG_TTL;
+        rc = string_printf ( text, sizeof text, & size, "%lu\n1\n\n\n",
+            ( uint64_t ) ( KTimeStamp () + ttl ) );
+    }
+    if ( rc != 0 )
+        return;
+
+    /* the scratch name only has to differ between concurrent writers */
+    if ( string_printf ( tmp, sizeof tmp, NULL, "%s.%lx.tmp", name, unique ) != 0 )
+        return;
+
+    if ( KDirectoryCreateFile ( self -> dir, & f, false, 0664, kcmInit, "%s", tmp ) == 0 )
+    {
+        rc = KFileWriteAll ( f, 0, text, size, & num_writ );
+        KFileRelease ( f );
+        if ( rc == 0 && num_writ == size )
+            rc = KDirectoryRename ( self -> dir, true, tmp, name );
+        else if ( rc == 0 )
+            rc = RC ( rcVFS, rcResolver, rcUpdating, rcTransfer, rcIncomplete );
+        if ( rc != 0 )
+            KDirectoryRemove ( self -> dir, false, "%s", tmp );
+    }
+}
+
+
 /* "process" global settings
  *  actually, they are library-closure global
  */
@@ -1711,6 +2222,14 @@ rc_t VResolverWhack ( VResolver *self )
     /* drop root paths */
     VectorWhack ( & self -> roots, string_whack, NULL );
 
+    /* drop cached answers */
+    if ( self -> remote_cache != NULL )
+        VResolverAnswerCacheWhack ( self -> remote_cache );
+    if ( self -> local_cache != NULL )
+        VResolverAnswerCacheWhack ( self -> local_cache );
+    if ( self -> disk_cache != NULL )
+        VResolverDiskCacheWhack ( self -> disk_cache );
+
     /* release kns */
     if ( self -> kns != NULL )
         KNSManagerRelease ( self -> kns );
@@ -2050,7 +2569,7 @@ VResolverAppID get_accession_app ( const String * accession, bool refseq_ctx,
 }
 
 
-/* LocalResolve
+/* LocalResolveVols
  *  resolve an accession into a VPath or not found
  *
  *  1. determine the type of accession we have, i.e. its "app"
@@ -2058,7 +2577,7 @@ VResolverAppID get_accession_app ( const String * accession, bool refseq_ctx,
  *  3. return not found or new VPath
  */
 static
-rc_t VResolverLocalResolve ( const VResolver *self,
+rc_t VResolverLocalResolveVols ( const VResolver *self,
     const String * accession, const VPath ** path, bool refseq_ctx )
 {
     uint32_t i, count;
@@ -2084,11 +2603,11 @@ rc_t VResolverLocalResolve ( const VResolver *self,
     return RC ( rcVFS, rcResolver, rcResolving, rcName, rcNotFound );
 }
 
-/* LocalFile
+/* LocalFileVols
  *  locate a locally stored file
  */
 static
-rc_t VResolverLocalFile ( const VResolver *self, const VPath * query, const VPath ** path )
+rc_t VResolverLocalFileVols ( const VResolver *self, const VPath * query, const VPath ** path )
 {
     uint32_t i, count;
 
@@ -2108,6 +2627,83 @@ rc_t VResolverLocalFile ( const VResolver *self, const VPath * query, const VPat
     return RC ( rcVFS, rcResolver, rcResolving, rcName, rcNotFound );
 }
 
+/* LocalCached
+ *  answer a local query from the local cache, or walk the volumes
+ *
+ *  a remembered path is probed before it is handed out,
+ *  since the file may have been removed in the meantime
+ */
+static
+rc_t VResolverLocalCached ( const VResolver *self, const String * accession,
+    uint32_t flags, const VPath * query, const VPath ** path, bool refseq_ctx )
+{
+    rc_t rc;
+
+    if ( self -> local_cache == NULL )
+    {
+        if ( ( flags & LOCAL_CACHE_FILE ) != 0 )
+            return VResolverLocalFileVols ( self, query, path );
+        return VResolverLocalResolveVols ( self, accession, path, refseq_ctx );
+    }
+
+    if ( VResolverAnswerCacheGet ( self -> local_cache, accession, flags, path, NULL, & rc ) )
+    {
+        if ( rc != 0 )
+            return rc;
+
+        switch ( KDirectoryPathType ( self -> wd, "%.*s",
+            ( int ) ( * path ) -> path . size, ( * path ) -> path . addr ) & ~ kptAlias )
+        {
+        case kptFile:
+        case kptDir:
+            return 0;
+        }
+
+        VResolverAnswerCacheForget ( self -> local_cache, accession, flags, false );
+        VPathRelease ( * path );
+        * path = NULL;
+    }
+
+    if ( ( flags & LOCAL_CACHE_FILE ) != 0 )
+        rc = VResolverLocalFileVols ( self, query, path );
+    else
+        rc = VResolverLocalResolveVols ( self, accession, path, refseq_ctx );
+
+    VResolverAnswerCachePut ( self -> local_cache, accession, flags, rc == 0 ? * path : NULL, NULL, rc );
+
+    return rc;
+}
+
+/* LocalResolve
+ */
+static
+rc_t VResolverLocalResolve ( const VResolver *self,
+    const String * accession, const VPath ** path, bool refseq_ctx )
+{
+    return VResolverLocalCached ( self, accession,
+        refseq_ctx ? LOCAL_CACHE_REFSEQ : 0, NULL, path, refseq_ctx );
+}
+
+/* LocalFile
+ *  locate a locally stored file
+ */
+static
+rc_t VResolverLocalFile ( const VResolver *self, const VPath * query, const VPath ** path )
+{
+    return VResolverLocalCached ( self, & query -> path, LOCAL_CACHE_FILE, query, path, false );
+}
+
+/* ForgetLocalMisses
+ *  a cache path is about to be handed out, and a download into it
+ *  must be seen by the next local query
+ */
+static
+void VResolverForgetLocalMisses ( const VResolver *self, const String * accession )
+{
+    if ( self -> local_cache != NULL )
+        VResolverAnswerCacheForget ( self -> local_cache, accession, 0, true );
+}
+
 static
 bool VPathHasRefseqContext ( const VPath * accession )
 {
@@ -2295,7 +2891,7 @@ VResolverEnableState CC VResolverCacheEnable ( const VResolver * self, VResolver
  *  4. return not found or new VPath
  */
 static
-rc_t VResolverRemoteResolve ( const VResolver *self,
+rc_t VResolverRemoteResolveAlgs ( const VResolver *self,
     VRemoteProtocols protocols, const String * accession,
     const VPath ** path, const VPath **mapping,
     const KFile ** opt_file_rtn, bool refseq_ctx, bool is_oid )
@@ -2346,7 +2942,7 @@ rc_t VResolverRemoteResolve ( const VResolver *self,
                 try_rc = VResolverAlgRemoteResolve ( alg, self -> kns, protocols, & tok, path, mapping, opt_file_rtn, legacy_wgs_refseq );
                 if ( try_rc == 0 )
                     return 0;
-                if ( rc == 0 )
+                if ( rc == 0 || VResolverConfirmedNotFound ( rc ) )
                     rc = try_rc;
             }
         }
@@ -2361,7 +2957,7 @@ rc_t VResolverRemoteResolve ( const VResolver *self,
                 try_rc = VResolverAlgRemoteResolve ( alg, self -> kns, protocols, & tok, path, mapping, opt_file_rtn, legacy_wgs_refseq );
                 if ( try_rc == 0 )
                     return 0;
-                if ( rc == 0 )
+                if ( rc == 0 || VResolverConfirmedNotFound ( rc ) )
                     rc = try_rc;
             }
         }
@@ -2373,6 +2969,64 @@ rc_t VResolverRemoteResolve ( const VResolver *self,
     return RC ( rcVFS, rcResolver, rcResolving, rcName, rcNotFound );
 }
 
+static
+rc_t VResolverRemoteResolve ( const VResolver *self,
+    VRemoteProtocols protocols, const String * accession,
+    const VPath ** path, const VPath **mapping,
+    const KFile ** opt_file_rtn, bool refseq_ctx, bool is_oid )
+{
+    rc_t rc;
+    uint32_t flags;
+    const VResolverDiskCache * disk;
+
+    /* an opened file cannot be shared */
+    if ( ( self -> remote_cache == NULL && self -> disk_cache == NULL ) || opt_file_rtn != NULL )
+    {
+        return VResolverRemoteResolveAlgs ( self, protocols, accession,
+            path, mapping, opt_file_rtn, refseq_ctx, is_oid );
+    }
+
+    flags = ( uint32_t ) protocols;
+    if ( refseq_ctx )
+        flags |= REMOTE_CACHE_REFSEQ;
+    if ( is_oid )
+        flags |= REMOTE_CACHE_OID;
+    if ( mapping != NULL )
+        flags |= REMOTE_CACHE_MAPPING;
+    if ( atomic32_read ( & enable_remote ) == vrAlwaysEnable )
+        flags |= REMOTE_CACHE_FORCED;
+
+    if ( self -> remote_cache != NULL &&
+         VResolverAnswerCacheGet ( self -> remote_cache, accession, flags, path, mapping, & rc ) )
+    {
+        return rc;
+    }
+
+    /* answers within a protected workspace carry its download ticket */
+    disk = self -> ticket == NULL ? self -> disk_cache : NULL;
+    if ( disk != NULL && VResolverDiskCacheGet ( disk, accession, flags, path, mapping, & rc ) )
+        disk = NULL;
+    else
+    {
+        rc = VResolverRemoteResolveAlgs ( self, protocols, accession,
+            path, mapping, NULL, refseq_ctx, is_oid );
+    }
+
+    if ( self -> remote_cache != NULL )
+    {
+        VResolverAnswerCachePut ( self -> remote_cache, accession, flags,
+            rc == 0 ? * path : NULL, ( rc == 0 && mapping != NULL ) ? * mapping : NULL, rc );
+    }
+    if ( disk != NULL )
+    {
+        VResolverDiskCachePut ( disk, accession, flags,
+            rc == 0 ? * path : NULL, ( rc == 0 && mapping != NULL ) ? * mapping : NULL, rc,
+            ( uint64_t ) ( size_t ) self );
+    }
+
+    return rc;
+}
+
 
 /* Remote
  *  Find an existing remote file that is named by the accession.
@@ -2535,6 +3189,8 @@ rc_t VResolverCacheResolve ( const VResolver *self,
 
     VResolverEnableState cache_state = atomic32_read ( & enable_cache );
 
+    VResolverForgetLocalMisses ( self, & accession );
+
     /* check for cache-enable override */
     if ( cache_state == vrAlwaysEnable )
     {
@@ -2608,6 +3264,8 @@ rc_t VResolverCacheFile ( const VResolver *self, const VPath * query, const VPat
 
     VResolverEnableState cache_state = atomic32_read ( & enable_cache );
 
+    VResolverForgetLocalMisses ( self, & query -> path );
+
     /* check for cache-enable override */
     if ( cache_state == vrAlwaysEnable )
     {
@@ -3228,7 +3886,16 @@ rc_t CC VResolverQuery ( const VResolver * self, VRemoteProtocols protocols,
             case vpNameOrAccession:
                 rc = VResolverQueryAcc ( self, protocols, query, local, remote, cache );
                 if ( rc != 0 )
-                    goto try_name;
+                {
+                    /* not finding a name says nothing about why
+                       the accession could not be resolved */
+                    rc_t name_rc = VResolverQueryName ( self, protocols, query, local, remote, cache );
+                    if ( name_rc == 0 || GetRCState ( name_rc ) != rcNotFound ||
+                         GetRCState ( rc ) == rcNotFound )
+                    {
+                        rc = name_rc;
+                    }
+                }
                 break;
 
             case vpName:
@@ -3262,6 +3929,42 @@ rc_t CC VResolverQuery ( const VResolver * self, VRemoteProtocols protocols,
 }
 
 
+/* QueryBatch
+ *  resolve a list of queries
+ */
+LIB_EXPORT
+rc_t CC VResolverQueryBatch ( const VResolver * self, VRemoteProtocols protocols,
+    const VPath * const * queries, uint32_t count, const VPath ** local,
+    const VPath ** remote, const VPath ** cache, rc_t * rcs )
+{
+    uint32_t i;
+    rc_t rc = 0;
+
+    if ( ( ( size_t ) local | ( size_t ) remote | ( size_t ) cache ) == 0 )
+        return RC ( rcVFS, rcResolver, rcResolving, rcParam, rcNull );
+    if ( queries == NULL && count != 0 )
+        return RC ( rcVFS, rcResolver, rcResolving, rcParam, rcNull );
+    if ( self == NULL )
+        return RC ( rcVFS, rcResolver, rcResolving, rcSelf, rcNull );
+
+    /* repeated remote queries are answered by the remote cache */
+    for ( i = 0; i < count; ++ i )
+    {
+        rc_t qrc = VResolverQuery ( self, protocols, queries [ i ],
+            local == NULL ? NULL : & local [ i ],
+            remote == NULL ? NULL : & remote [ i ],
+            cache == NULL ? NULL : & cache [ i ] );
+
+        if ( rcs != NULL )
+            rcs [ i ] = qrc;
+        else if ( rc == 0 )
+            rc = qrc;
+    }
+
+    return rc;
+}
+
+
 
 /* LoadVolume
  *  capture volume path and other information
@@ -4290,6 +4993,12 @@ rc_t VResolverMake ( VResolver ** objp, const KDirectory *wd,
 
         KRefcountInit ( & obj -> refcount, 1, "VResolver", "make", "resolver" );
 
+        obj -> remote_cache = VResolverAnswerCacheMake ( REMOTE_CACHE_SIZE,
+            REMOTE_CACHE_TTL, REMOTE_CACHE_NEG_TTL );
+        obj -> local_cache = VResolverAnswerCacheMake ( LOCAL_CACHE_SIZE,
+            LOCAL_CACHE_TTL, LOCAL_CACHE_NEG_TTL );
+        obj -> disk_cache = VResolverDiskCacheMake ( kfg );
+
         rc = VResolverLoad ( obj, protected, kfg );
         if ( rc == 0 )
         {
@@ -27,6 +27,7 @@
 #include <klib/defs.h>
 #include <klib/sort.h>
 #include <klib/rc.h>
+#include <klib/seq-conv.h>
 #include <vdb/xform.h>
 #include <vdb/schema.h>
 #include <sysalloc.h>
@@ -273,6 +274,40 @@ TYPE2_8BIT_MAP ( uint16_t )
 TYPE2_8BIT_MAP ( uint32_t )
 TYPE2_8BIT_MAP ( uint64_t )
 
+/* type 2: 8-bit to 8-bit where every nibble is mapped
+ *  the common case of 2na/4na to text, where a vectored
+ *  lookup handles the leading run of inputs below 16 and
+ *  the loop above resumes with any remainder
+ */
+static
+rc_t CC type2_nibble_to_uint8_t ( void *vself,
+    const VXformInfo *info, void *vdst, const void *vsrc,
+    uint64_t elem_count )
+{
+    const map_t *self = ( const void* ) vself;
+    const uint8_t *to = self -> to;
+
+    size_t done = SeqMapNibbles ( vdst, vsrc, ( size_t ) elem_count, to );
+    if ( done == elem_count )
+        return 0;
+
+    return type2_uint8_t_to_uint8_t ( vself, info,
+        ( uint8_t* ) vdst + done, ( const uint8_t* ) vsrc + done, elem_count - done );
+}
+
+static
+bool map_t_nibbles_mapped ( const map_t *self )
+{
+    int i;
+    const uint8_t *from = self -> from;
+    for ( i = 0; i < 16; ++ i )
+    {
+        if ( ! from [ i ] )
+            return false;
+    }
+    return true;
+}
+
 /* type2: binary map
  *  due to the combinatorial explosion,
  *  just implement the binary version
@@ -959,6 +994,9 @@ rc_t vdb_map_type2_fact ( VFuncDesc *rslt, const VFactoryParams *cp )
     rslt -> u. af = type2_funcs [ code1 ] [ code2 & 3 ];
     rslt -> variant = vftArray;
 
+    if ( code1 == 0 && ( code2 & 3 ) == 0 && map_t_nibbles_mapped ( self ) )
+        rslt -> u. af = type2_nibble_to_uint8_t;
+
 #if _DEBUGGING
     self -> array = rslt -> u . af;
     rslt -> u . af = type12_driver;
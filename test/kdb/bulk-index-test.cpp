@@ -0,0 +1,389 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/**
+* Unit tests for bulk loading of text indices
+*/
+
+#include <ktst/unit_test.hpp>
+
+#include <kdb/manager.h>
+#include <kdb/table.h>
+#include <kdb/index.h>
+#include <kfs/directory.h>
+#include <kfs/file.h>
+#include <klib/rc.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+TEST_SUITE(KBulkIndexTestSuite);
+
+/* small enough to spill many runs */
+#define MEM_LIMIT 32768
+
+/* one key mapped to a range of ids */
+struct Entry
+{
+    std::string key;
+    int64_t start_id;
+    uint32_t span;
+};
+
+/* "count" entries, with keys in id order when "sorted",
+   spans of 1..3 ids and, with "holes", gaps in id space */
+static std::vector < Entry > MakeEntries ( uint32_t count, bool sorted, bool holes )
+{
+    std::vector < Entry > entries;
+    int64_t id = 1;
+    for ( uint32_t i = 0; i < count; ++ i )
+    {
+        char key [ 32 ];
+        /* a multiplicative permutation of 0..count-1 */
+        uint32_t k = sorted ? i : ( uint32_t ) ( ( ( uint64_t ) i * 7919 ) % count );
+        sprintf ( key, "key-%07u", k );
+
+        Entry e;
+        e . key = key;
+        e . start_id = id;
+        e . span = 1 + i % 3;
+        entries . push_back ( e );
+
+        id += e . span;
+        if ( holes && i % 7 == 6 )
+            id += 2;
+    }
+    return entries;
+}
+
+class BulkIndexFixture
+{
+public:
+    BulkIndexFixture ()
+        : wd ( 0 ), mgr ( 0 )
+    {
+        if ( KDirectoryNativeDir ( & wd ) != 0 )
+            throw std::logic_error ( "BulkIndexFixture: KDirectoryNativeDir failed" );
+        if ( KDBManagerMakeUpdate ( & mgr, wd ) != 0 )
+            throw std::logic_error ( "BulkIndexFixture: KDBManagerMakeUpdate failed" );
+        sprintf ( root, "test-bulk-index.%u", ( unsigned ) getpid () );
+    }
+    ~BulkIndexFixture ()
+    {
+        KDBManagerRelease ( mgr );
+        KDirectoryRemove ( wd, true, "%s", root );
+        KDirectoryRelease ( wd );
+    }
+
+    /* builds index "name" in table "tbl", in bulk if "mem_limit" is not 0.
+       returns the number of refused inserts */
+    uint32_t Build ( const char * tbl, KIdxType type, size_t mem_limit,
+        const std::vector < Entry > & entries )
+    {
+        KTable * t;
+        KIndex * idx;
+        uint32_t refused = 0;
+
+        if ( KDBManagerCreateTable ( mgr, & t, kcmInit | kcmParents, "%s/%s", root, tbl ) != 0 )
+            throw std::logic_error ( "BulkIndexFixture::Build: KDBManagerCreateTable failed" );
+        if ( KTableCreateIndex ( t, & idx, type, kcmInit, "name" ) != 0 )
+            throw std::logic_error ( "BulkIndexFixture::Build: KTableCreateIndex failed" );
+        if ( mem_limit != 0 && KIndexSetBulkInsert ( idx, mem_limit ) != 0 )
+            throw std::logic_error ( "BulkIndexFixture::Build: KIndexSetBulkInsert failed" );
+
+        for ( size_t i = 0; i < entries . size (); ++ i )
+        {
+            const Entry & e = entries [ i ];
+            for ( uint32_t j = 0; j < e . span; ++ j )
+            {
+                if ( KIndexInsertText ( idx, true, e . key . c_str (), e . start_id + j ) != 0 )
+                    ++ refused;
+            }
+        }
+
+        if ( KIndexCommit ( idx ) != 0 )
+            throw std::logic_error ( "BulkIndexFixture::Build: KIndexCommit failed" );
+        KIndexRelease ( idx );
+        KTableRelease ( t );
+        return refused;
+    }
+
+    std::string ReadIndexFile ( const char * tbl )
+    {
+        const KFile * f;
+        uint64_t size;
+        size_t num_read;
+
+        if ( KDirectoryOpenFileRead ( wd, & f, "%s/%s/idx/name", root, tbl ) != 0 )
+            throw std::logic_error ( "BulkIndexFixture::ReadIndexFile: KDirectoryOpenFileRead failed" );
+        if ( KFileSize ( f, & size ) != 0 )
+            throw std::logic_error ( "BulkIndexFixture::ReadIndexFile: KFileSize failed" );
+
+        std::string data ( ( size_t ) size, '\0' );
+        if ( size != 0 && KFileReadAll ( f, 0, & data [ 0 ], ( size_t ) size, & num_read ) != 0 )
+            throw std::logic_error ( "BulkIndexFixture::ReadIndexFile: KFileReadAll failed" );
+        KFileRelease ( f );
+        return data;
+    }
+
+    const KIndex * OpenIndex ( const char * tbl, const KTable ** t )
+    {
+        const KIndex * idx;
+        if ( KDBManagerOpenTableRead ( mgr, t, "%s/%s", root, tbl ) != 0 )
+            throw std::logic_error ( "BulkIndexFixture::OpenIndex: KDBManagerOpenTableRead failed" );
+        if ( KTableOpenIndexRead ( * t, & idx, "name" ) != 0 )
+            throw std::logic_error ( "BulkIndexFixture::OpenIndex: KTableOpenIndexRead failed" );
+        return idx;
+    }
+
+    /* every key and id resolves the same way in both indices */
+    void CompareLookups ( const std::vector < Entry > & entries, bool proj )
+    {
+        const KTable * t1, * t2;
+        const KIndex * incore = OpenIndex ( "incore", & t1 );
+        const KIndex * bulk = OpenIndex ( "bulk", & t2 );
+
+        for ( size_t i = 0; i < entries . size (); ++ i )
+        {
+            const Entry & e = entries [ i ];
+            int64_t start1, start2;
+            uint64_t count1, count2;
+
+            rc_t rc1 = KIndexFindText ( incore, e . key . c_str (), & start1, & count1, NULL, NULL );
+            rc_t rc2 = KIndexFindText ( bulk, e . key . c_str (), & start2, & count2, NULL, NULL );
+            if ( rc1 != rc2 || start1 != start2 || count1 != count2 )
+                throw std::logic_error ( "BulkIndexFixture::CompareLookups: find differs for " + e . key );
+        }
+
+        /* keys that were never inserted */
+        {
+            int64_t start;
+            uint64_t count;
+            if ( KIndexFindText ( bulk, "key-", & start, & count, NULL, NULL ) == 0 ||
+                 KIndexFindText ( bulk, "key-9999999", & start, & count, NULL, NULL ) == 0 )
+            {
+                throw std::logic_error ( "BulkIndexFixture::CompareLookups: found a missing key" );
+            }
+        }
+
+        if ( proj && ! entries . empty () )
+        {
+            const Entry & last = entries . back ();
+            for ( int64_t id = 0; id <= last . start_id + last . span; ++ id )
+            {
+                char key1 [ 64 ], key2 [ 64 ];
+                int64_t start1, start2;
+                uint64_t count1, count2;
+                size_t size1, size2;
+
+                rc_t rc1 = KIndexProjectText ( incore, id, & start1, & count1, key1, sizeof key1, & size1 );
+                rc_t rc2 = KIndexProjectText ( bulk, id, & start2, & count2, key2, sizeof key2, & size2 );
+                if ( rc1 != rc2 )
+                    throw std::logic_error ( "BulkIndexFixture::CompareLookups: project result differs" );
+                if ( rc1 == 0 && ( start1 != start2 || count1 != count2 ||
+                     size1 != size2 || strcmp ( key1, key2 ) != 0 ) )
+                {
+                    throw std::logic_error ( "BulkIndexFixture::CompareLookups: projection differs" );
+                }
+            }
+        }
+
+        KIndexRelease ( incore );
+        KIndexRelease ( bulk );
+        KTableRelease ( t1 );
+        KTableRelease ( t2 );
+    }
+
+    KDirectory * wd;
+    KDBManager * mgr;
+    char root [ 64 ];
+};
+
+FIXTURE_TEST_CASE ( BulkIndex_Proj_Sorted, BulkIndexFixture )
+{
+    std::vector < Entry > entries = MakeEntries ( 5000, true, true );
+    REQUIRE_EQ ( Build ( "incore", ( KIdxType ) ( kitText | kitProj ), 0, entries ), 0u );
+    REQUIRE_EQ ( Build ( "bulk", ( KIdxType ) ( kitText | kitProj ), MEM_LIMIT, entries ), 0u );
+    REQUIRE ( ReadIndexFile ( "incore" ) == ReadIndexFile ( "bulk" ) );
+    CompareLookups ( entries, true );
+}
+
+FIXTURE_TEST_CASE ( BulkIndex_Proj_Unsorted, BulkIndexFixture )
+{
+    std::vector < Entry > entries = MakeEntries ( 5000, false, true );
+    REQUIRE_EQ ( Build ( "incore", ( KIdxType ) ( kitText | kitProj ), 0, entries ), 0u );
+    REQUIRE_EQ ( Build ( "bulk", ( KIdxType ) ( kitText | kitProj ), MEM_LIMIT, entries ), 0u );
+    REQUIRE ( ReadIndexFile ( "incore" ) == ReadIndexFile ( "bulk" ) );
+    CompareLookups ( entries, true );
+}
+
+FIXTURE_TEST_CASE ( BulkIndex_RepeatedKey, BulkIndexFixture )
+{
+    std::vector < Entry > entries = MakeEntries ( 3000, false, true );
+
+    /* repeat a key from an early, spilled run and one from the current run */
+    std::vector < Entry > repeats;
+    for ( size_t i = 0; i < entries . size (); ++ i )
+    {
+        repeats . push_back ( entries [ i ] );
+        if ( i == 2000 || i == 2990 )
+        {
+            Entry e = entries [ i == 2000 ? 3 : 2985 ];
+            e . start_id = entries [ i ] . start_id + entries [ i ] . span;
+            e . span = 1;
+            repeats . push_back ( e );
+
+            /* the refused id becomes a hole */
+            for ( size_t j = i + 1; j < entries . size (); ++ j )
+                ++ entries [ j ] . start_id;
+        }
+    }
+
+    /* both paths refuse the same inserts and leave the same index */
+    REQUIRE_EQ ( Build ( "incore", ( KIdxType ) ( kitText | kitProj ), 0, repeats ), 2u );
+    REQUIRE_EQ ( Build ( "bulk", ( KIdxType ) ( kitText | kitProj ), MEM_LIMIT, repeats ), 2u );
+    REQUIRE ( ReadIndexFile ( "incore" ) == ReadIndexFile ( "bulk" ) );
+    CompareLookups ( entries, true );
+}
+
+FIXTURE_TEST_CASE ( BulkIndex_ProjectBeforeCommit, BulkIndexFixture )
+{
+    std::vector < Entry > entries = MakeEntries ( 3000, false, true );
+
+    KTable * t1, * t2;
+    KIndex * incore, * bulk;
+
+    REQUIRE_RC ( KDBManagerCreateTable ( mgr, & t1, kcmInit | kcmParents, "%s/incore", root ) );
+    REQUIRE_RC ( KTableCreateIndex ( t1, & incore, ( KIdxType ) ( kitText | kitProj ), kcmInit, "name" ) );
+    REQUIRE_RC ( KDBManagerCreateTable ( mgr, & t2, kcmInit | kcmParents, "%s/bulk", root ) );
+    REQUIRE_RC ( KTableCreateIndex ( t2, & bulk, ( KIdxType ) ( kitText | kitProj ), kcmInit, "name" ) );
+    REQUIRE_RC ( KIndexSetBulkInsert ( bulk, MEM_LIMIT ) );
+
+    /* a write cursor projects the rows it has just inserted */
+    for ( size_t i = 0; i < entries . size (); ++ i )
+    {
+        const Entry & e = entries [ i ];
+        for ( uint32_t j = 0; j < e . span; ++ j )
+        {
+            REQUIRE_RC ( KIndexInsertText ( incore, true, e . key . c_str (), e . start_id + j ) );
+            REQUIRE_RC ( KIndexInsertText ( bulk, true, e . key . c_str (), e . start_id + j ) );
+        }
+
+        if ( i % 97 == 0 || i + 1 == entries . size () )
+        {
+            for ( int64_t id = 0; id <= e . start_id + e . span; ++ id )
+            {
+                char key1 [ 64 ], key2 [ 64 ];
+                int64_t start1, start2;
+                uint64_t count1, count2;
+                size_t size1 = 0, size2 = 0;
+
+                rc_t rc1 = KIndexProjectText ( incore, id, & start1, & count1, key1, sizeof key1, & size1 );
+                rc_t rc2 = KIndexProjectText ( bulk, id, & start2, & count2, key2, sizeof key2, & size2 );
+                REQUIRE_EQ ( rc1 == 0, rc2 == 0 );
+                if ( rc1 == 0 )
+                {
+                    REQUIRE_EQ ( start1, start2 );
+                    REQUIRE_EQ ( count1, count2 );
+                    REQUIRE_EQ ( size1, size2 );
+                    REQUIRE_EQ ( std::string ( key1 ), std::string ( key2 ) );
+                }
+            }
+        }
+    }
+
+    /* too small a buffer reports the size needed */
+    {
+        char key [ 4 ];
+        int64_t start;
+        uint64_t count;
+        size_t size;
+        REQUIRE_RC_FAIL ( KIndexProjectText ( bulk, 1, & start, & count, key, sizeof key, & size ) );
+        REQUIRE_EQ ( size, entries [ 0 ] . key . size () );
+    }
+
+    REQUIRE_RC ( KIndexRelease ( incore ) );
+    REQUIRE_RC ( KIndexRelease ( bulk ) );
+    REQUIRE_RC ( KTableRelease ( t1 ) );
+    REQUIRE_RC ( KTableRelease ( t2 ) );
+    REQUIRE ( ReadIndexFile ( "incore" ) == ReadIndexFile ( "bulk" ) );
+}
+
+FIXTURE_TEST_CASE ( BulkIndex_NoFindBeforeCommit, BulkIndexFixture )
+{
+    KTable * t;
+    KIndex * idx;
+    int64_t start;
+    uint64_t count;
+
+    REQUIRE_RC ( KDBManagerCreateTable ( mgr, & t, kcmInit | kcmParents, "%s/tbl", root ) );
+    REQUIRE_RC ( KTableCreateIndex ( t, & idx, ( KIdxType ) ( kitText | kitProj ), kcmInit, "name" ) );
+    REQUIRE_RC ( KIndexSetBulkInsert ( idx, MEM_LIMIT ) );
+    REQUIRE_RC ( KIndexInsertText ( idx, true, "key-1", 1 ) );
+    REQUIRE_RC ( KIndexInsertText ( idx, true, "key-2", 2 ) );
+    REQUIRE_RC ( KIndexInsertText ( idx, true, "key-3", 4 ) );
+    REQUIRE_RC_FAIL ( KIndexFindText ( idx, "key-2", & start, & count, NULL, NULL ) );
+    REQUIRE_RC ( KIndexCommit ( idx ) );
+    REQUIRE_RC ( KIndexFindText ( idx, "key-2", & start, & count, NULL, NULL ) );
+    REQUIRE_EQ ( start, ( int64_t ) 2 );
+    REQUIRE_RC ( KIndexRelease ( idx ) );
+    REQUIRE_RC ( KTableRelease ( t ) );
+}
+
+//////////////////////////////////////////// Main
+extern "C"
+{
+
+#include <kapp/args.h>
+
+ver_t CC KAppVersion ( void )
+{
+    return 0x1000000;
+}
+
+rc_t CC UsageSummary ( const char * progname )
+{
+    return 0;
+}
+
+rc_t CC Usage ( const Args * args )
+{
+    return 0;
+}
+
+const char UsageDefaultName [] = "test-bulk-index";
+
+rc_t CC KMain ( int argc, char * argv [] )
+{
+    return KBulkIndexTestSuite ( argc, argv );
+}
+
+}
@@ -0,0 +1,218 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/**
+* Unit tests for the configuration snapshot ( VDB_CONFIG_SNAPSHOT )
+*/
+
+#include <ktst/unit_test.hpp>
+
+#include <kfg/config.h>
+#include <kfg/kfg-priv.h>
+#include <kfs/directory.h>
+#include <kfs/file.h>
+#include <klib/text.h>
+#include <klib/time.h>
+#include <klib/rc.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+TEST_SUITE(KfgSnapshotTestSuite);
+
+#define WORK_DIR "kfg-snapshot-test.tmp"
+
+class SnapshotFixture
+{
+public:
+    SnapshotFixture ()
+    :   wd ( 0 ),
+        then ( KTimeStamp () - 60 )
+    {
+        if ( KDirectoryNativeDir ( & wd ) != 0 )
+            throw "KDirectoryNativeDir failed";
+        KDirectoryRemove ( wd, true, WORK_DIR );
+        if ( KDirectoryCreateDir ( wd, 0775, kcmCreate | kcmParents, WORK_DIR "/cfg" ) != 0 ||
+             KDirectoryCreateDir ( wd, 0775, kcmCreate | kcmParents, WORK_DIR "/home" ) != 0 ||
+             KDirectoryResolvePath ( wd, true, base, sizeof base, WORK_DIR ) != 0 )
+            throw "cannot make " WORK_DIR;
+
+        SetEnv ( "VDB_CONFIG", "/cfg" );
+        SetEnv ( "HOME", "/home" );
+        SetEnv ( "VDB_CONFIG_SNAPSHOT", "/snapshot" );
+    }
+    ~SnapshotFixture ()
+    {
+        unsetenv ( "VDB_CONFIG_SNAPSHOT" );
+        KDirectoryRemove ( wd, true, WORK_DIR );
+        KDirectoryRelease ( wd );
+    }
+
+    /* writes cfg/<leaf> and dates the configuration directory "date" */
+    rc_t Put ( const char * leaf, const char * text, KTime_t date )
+    {
+        KFile * f;
+        rc_t rc = KDirectoryCreateFile ( wd, & f, false, 0664, kcmInit, WORK_DIR "/cfg/%s", leaf );
+        if ( rc == 0 )
+        {
+            size_t num_writ;
+            rc = KFileWriteAll ( f, 0, text, strlen ( text ), & num_writ );
+            KFileRelease ( f );
+        }
+        if ( rc == 0 )
+            rc = KDirectorySetDate ( wd, true, date, WORK_DIR "/cfg" );
+        return rc;
+    }
+
+    std::string Read ( const char * path )
+    {
+        std::string value;
+        KConfig * cfg;
+        if ( KConfigMakeLocal ( & cfg, NULL ) == 0 )
+        {
+            String * s;
+            if ( KConfigReadString ( cfg, path, & s ) == 0 )
+            {
+                value . assign ( s -> addr, s -> size );
+                StringWhack ( s );
+            }
+            KConfigRelease ( cfg );
+        }
+        return value;
+    }
+
+    bool HaveSnapshot () const
+    {
+        return KDirectoryPathType ( wd, WORK_DIR "/snapshot" ) == kptFile;
+    }
+
+    KDirectory * wd;
+    KTime_t then;
+
+private:
+    void SetEnv ( const char * name, const char * leaf )
+    {
+        std::string value = std::string ( base ) + leaf;
+        setenv ( name, value . c_str (), 1 );
+    }
+
+    char base [ 4096 ];
+};
+
+FIXTURE_TEST_CASE ( Snapshot_SavedAndUsed, SnapshotFixture )
+{
+    REQUIRE_RC ( Put ( "a.kfg", "test/value = \"one\"\n", then ) );
+    REQUIRE_EQ ( Read ( "test/value" ), std::string ( "one" ) );
+    REQUIRE ( HaveSnapshot () );
+
+    /* same size and date: the file is taken as unchanged */
+    REQUIRE_RC ( Put ( "a.kfg", "test/value = \"two\"\n", then ) );
+    REQUIRE_EQ ( Read ( "test/value" ), std::string ( "one" ) );
+}
+
+FIXTURE_TEST_CASE ( Snapshot_ChangedFile, SnapshotFixture )
+{
+    REQUIRE_RC ( Put ( "a.kfg", "test/value = \"one\"\n", then ) );
+    REQUIRE_EQ ( Read ( "test/value" ), std::string ( "one" ) );
+
+    REQUIRE_RC ( Put ( "a.kfg", "test/value = \"two\"\n", then + 1 ) );
+    REQUIRE_EQ ( Read ( "test/value" ), std::string ( "two" ) );
+    REQUIRE_RC ( Put ( "a.kfg", "test/value = \"three\"\n", then + 1 ) );
+    REQUIRE_EQ ( Read ( "test/value" ), std::string ( "three" ) );
+}
+
+FIXTURE_TEST_CASE ( Snapshot_AddedFile, SnapshotFixture )
+{
+    REQUIRE_RC ( Put ( "a.kfg", "test/value = \"one\"\n", then ) );
+    REQUIRE_EQ ( Read ( "test/value" ), std::string ( "one" ) );
+
+    REQUIRE_RC ( Put ( "b.kfg", "test/other = \"two\"\n", then + 1 ) );
+    REQUIRE_EQ ( Read ( "test/value" ), std::string ( "one" ) );
+    REQUIRE_EQ ( Read ( "test/other" ), std::string ( "two" ) );
+}
+
+FIXTURE_TEST_CASE ( Snapshot_YoungFileNotSaved, SnapshotFixture )
+{
+    REQUIRE_RC ( Put ( "a.kfg", "test/value = \"one\"\n", KTimeStamp () ) );
+    REQUIRE_EQ ( Read ( "test/value" ), std::string ( "one" ) );
+    REQUIRE ( ! HaveSnapshot () );
+}
+
+FIXTURE_TEST_CASE ( Snapshot_VolatileNotSaved, SnapshotFixture )
+{
+    REQUIRE_RC ( Put ( "a.kfg", "test/value = \"$(APPNAME)\"\n", then ) );
+    REQUIRE_EQ ( Read ( "test/value" ), std::string ( "test-kfg-snapshot" ) );
+    REQUIRE ( ! HaveSnapshot () );
+}
+
+FIXTURE_TEST_CASE ( Snapshot_CorruptIgnored, SnapshotFixture )
+{
+    REQUIRE_RC ( Put ( "a.kfg", "test/value = \"one\"\n", then ) );
+    REQUIRE_EQ ( Read ( "test/value" ), std::string ( "one" ) );
+    REQUIRE ( HaveSnapshot () );
+
+    KFile * f;
+    uint64_t size;
+    size_t num_writ;
+    REQUIRE_RC ( KDirectoryOpenFileWrite ( wd, & f, true, WORK_DIR "/snapshot" ) );
+    REQUIRE_RC ( KFileSize ( f, & size ) );
+    REQUIRE_RC ( KFileWriteAll ( f, size / 2, "garbage", 7, & num_writ ) );
+    REQUIRE_RC ( KFileRelease ( f ) );
+
+    REQUIRE_RC ( Put ( "a.kfg", "test/value = \"two\"\n", then ) );
+    REQUIRE_EQ ( Read ( "test/value" ), std::string ( "two" ) );
+}
+
+//////////////////////////////////////////// Main
+extern "C"
+{
+
+#include <kapp/args.h>
+
+ver_t CC KAppVersion ( void )
+{
+    return 0x1000000;
+}
+
+rc_t CC UsageSummary ( const char * progname )
+{
+    return 0;
+}
+
+rc_t CC Usage ( const Args * args )
+{
+    return 0;
+}
+
+const char UsageDefaultName [] = "test-kfg-snapshot";
+
+rc_t CC KMain ( int argc, char * argv [] )
+{
+    return KfgSnapshotTestSuite ( argc, argv );
+}
+
+}
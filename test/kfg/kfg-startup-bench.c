@@ -0,0 +1,201 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/**
+* Measures KConfigMake with and without a configuration snapshot
+*
+* writes three .kfg files with about 200 settings, then makes and releases
+* a KConfig "count" times ( first parameter, default 300 ) each way.
+*/
+
+#include <kapp/main.h>
+#include <kapp/args.h>
+#include <kfg/config.h>
+#include <kfg/kfg-priv.h>
+#include <kfs/directory.h>
+#include <kfs/file.h>
+#include <klib/out.h>
+#include <klib/log.h>
+#include <klib/printf.h>
+#include <klib/time.h>
+#include <klib/rc.h>
+
+#include <sys/time.h>
+#include <stdlib.h>
+
+#define WORK_DIR "kfg-startup-bench.tmp"
+
+static
+rc_t write_kfg ( KDirectory *wd, const char *leaf, uint32_t first, uint32_t count )
+{
+    KFile *f;
+    rc_t rc = KDirectoryCreateFile ( wd, & f, false, 0664, kcmInit, WORK_DIR "/cfg/%s", leaf );
+    if ( rc == 0 )
+    {
+        uint64_t pos = 0;
+        uint32_t i;
+        for ( i = first; rc == 0 && i < first + count; ++ i )
+        {
+            char line [ 256 ];
+            size_t num_writ;
+            rc = string_printf ( line, sizeof line, & num_writ,
+                "/bench/group%u/node%u = \"value number %u of the startup benchmark\"\n",
+                i / 16, i, i );
+            if ( rc == 0 )
+                rc = KFileWriteAll ( f, pos, line, num_writ, & num_writ );
+            pos += num_writ;
+        }
+        KFileRelease ( f );
+    }
+    return rc;
+}
+
+static
+uint64_t now_us ( void )
+{
+    struct timeval tv;
+    gettimeofday ( & tv, NULL );
+    return ( uint64_t ) tv . tv_sec * 1000000 + tv . tv_usec;
+}
+
+static
+rc_t run ( uint32_t count, uint64_t *per_make )
+{
+    rc_t rc = 0;
+    uint32_t i;
+    uint64_t start = now_us ();
+
+    for ( i = 0; rc == 0 && i < count; ++ i )
+    {
+        KConfig *cfg;
+        rc = KConfigMakeLocal ( & cfg, NULL );
+        if ( rc == 0 )
+        {
+            uint64_t value;
+            rc = KConfigReadU64 ( cfg, "/bench/count", & value );
+            if ( rc == 0 && value != 200 )
+                rc = RC ( rcExe, rcData, rcValidating, rcData, rcUnequal );
+            KConfigRelease ( cfg );
+        }
+    }
+
+    * per_make = ( now_us () - start ) / count;
+    return rc;
+}
+
+ver_t CC KAppVersion ( void )
+{
+    return 0x1000000;
+}
+
+rc_t CC UsageSummary ( const char * progname )
+{
+    return KOutMsg ( "Usage:\n  %s [count]\n", progname );
+}
+
+rc_t CC Usage ( const Args * args )
+{
+    return UsageSummary ( UsageDefaultName );
+}
+
+const char UsageDefaultName [] = "kfg-startup-bench";
+
+rc_t CC KMain ( int argc, char * argv [] )
+{
+    KDirectory *wd;
+    uint32_t count = 300;
+    rc_t rc;
+
+    if ( argc > 1 )
+        count = strtoul ( argv [ 1 ], NULL, 0 );
+    if ( count == 0 )
+        return UsageSummary ( UsageDefaultName );
+
+    rc = KDirectoryNativeDir ( & wd );
+    if ( rc == 0 )
+    {
+        char base [ 4096 ];
+
+        KDirectoryRemove ( wd, true, WORK_DIR );
+        rc = KDirectoryCreateDir ( wd, 0775, kcmCreate | kcmParents, WORK_DIR "/cfg" );
+        if ( rc == 0 )
+            rc = KDirectoryCreateDir ( wd, 0775, kcmCreate | kcmParents, WORK_DIR "/home" );
+        if ( rc == 0 )
+            rc = write_kfg ( wd, "a.kfg", 0, 100 );
+        if ( rc == 0 )
+            rc = write_kfg ( wd, "b.kfg", 100, 100 );
+        if ( rc == 0 )
+        {
+            KFile *f;
+            rc = KDirectoryCreateFile ( wd, & f, false, 0664, kcmInit, WORK_DIR "/cfg/count.kfg" );
+            if ( rc == 0 )
+            {
+                size_t num_writ;
+                rc = KFileWriteAll ( f, 0, "/bench/count = \"200\"\n", 21, & num_writ );
+                KFileRelease ( f );
+            }
+        }
+        /* a snapshot is only saved for files that have settled */
+        if ( rc == 0 )
+            rc = KDirectorySetDate ( wd, true, KTimeStamp () - 60, WORK_DIR );
+        if ( rc == 0 )
+            rc = KDirectoryResolvePath ( wd, true, base, sizeof base, WORK_DIR );
+        if ( rc == 0 )
+        {
+            char path [ 4096 ];
+            uint64_t parsed, snapped;
+
+            string_printf ( path, sizeof path, NULL, "%s/cfg", base );
+            setenv ( "VDB_CONFIG", path, 1 );
+            string_printf ( path, sizeof path, NULL, "%s/home", base );
+            setenv ( "HOME", path, 1 );
+
+            unsetenv ( "VDB_CONFIG_SNAPSHOT" );
+            rc = run ( count, & parsed );
+            if ( rc == 0 )
+            {
+                string_printf ( path, sizeof path, NULL, "%s/snapshot", base );
+                setenv ( "VDB_CONFIG_SNAPSHOT", path, 1 );
+                rc = run ( count, & snapped );
+                if ( rc == 0 && KDirectoryPathType ( wd, "%s", path ) != kptFile )
+                    rc = RC ( rcExe, rcFile, rcCreating, rcFile, rcNotFound );
+            }
+            if ( rc == 0 )
+            {
+                rc = KOutMsg ( "KConfigMake x %u, 201 settings in 3 files:\n"
+                               "  parsed:   %lu us per make\n"
+                               "  snapshot: %lu us per make\n",
+                               count, parsed, snapped );
+            }
+        }
+        if ( rc != 0 )
+            LOGERR ( klogErr, rc, "benchmark failed" );
+
+        KDirectoryRemove ( wd, true, WORK_DIR );
+        KDirectoryRelease ( wd );
+    }
+    return rc;
+}
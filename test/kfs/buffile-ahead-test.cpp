@@ -0,0 +1,192 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/**
+* Unit tests for the read-ahead KBufReadFile
+*/
+
+#include <ktst/unit_test.hpp>
+
+#include <kfs/buffile.h>
+#include <kfs/directory.h>
+#include <kfs/file.h>
+#include <klib/rc.h>
+
+#include <string.h>
+#include <vector>
+
+TEST_SUITE(KBufReadAheadTestSuite);
+
+#define WORK_DIR "buffile-ahead-test.tmp"
+
+static const size_t FileSize = 3 * 1024 * 1024 + 7;
+static const size_t Window = 16 * 1024;
+static const size_t MaxWindow = 128 * 1024;
+
+class ReadAheadFixture
+{
+public:
+    ReadAheadFixture ()
+    :   wd ( 0 ),
+        original ( 0 ),
+        buf ( 0 ),
+        data ( FileSize )
+    {
+        uint32_t x = 12345;
+        for ( size_t i = 0; i < data . size (); ++ i )
+        {
+            x = x * 1103515245 + 12345;
+            data [ i ] = ( uint8_t ) ( x >> 16 );
+        }
+
+        KFile * f;
+        size_t num_writ;
+        if ( KDirectoryNativeDir ( & wd ) != 0 ||
+             KDirectoryCreateFile ( wd, & f, false, 0664, kcmInit, WORK_DIR ) != 0 )
+            throw "cannot make " WORK_DIR;
+        rc_t rc = KFileWriteAll ( f, 0, & data [ 0 ], data . size (), & num_writ );
+        KFileRelease ( f );
+        if ( rc != 0 ||
+             KDirectoryOpenFileRead ( wd, & original, WORK_DIR ) != 0 ||
+             KBufReadFileMakeReadAhead ( & buf, original, Window, MaxWindow ) != 0 )
+            throw "cannot make the read-ahead file";
+    }
+    ~ReadAheadFixture ()
+    {
+        KFileRelease ( buf );
+        KFileRelease ( original );
+        KDirectoryRemove ( wd, true, WORK_DIR );
+        KDirectoryRelease ( wd );
+    }
+
+    /* one request, checked against the data written;
+       it may return less than asked for, but not nothing before the end */
+    bool ReadMatches ( uint64_t pos, size_t size )
+    {
+        std::vector < uint8_t > buffer ( size );
+        size_t num_read, expected = 0;
+        if ( KFileRead ( buf, pos, & buffer [ 0 ], size, & num_read ) != 0 )
+            return false;
+        if ( pos < data . size () )
+            expected = data . size () - pos;
+        if ( num_read == 0 || num_read > size )
+            return num_read == 0 && expected == 0;
+        return memcmp ( & buffer [ 0 ], & data [ pos ], num_read ) == 0;
+    }
+
+    KDirectory * wd;
+    const KFile * original;
+    const KFile * buf;
+    std::vector < uint8_t > data;
+};
+
+FIXTURE_TEST_CASE ( ReadAhead_Sequential, ReadAheadFixture )
+{
+    uint64_t pos = 0;
+    uint64_t requests = 0;
+    while ( pos < FileSize )
+    {
+        std::vector < uint8_t > buffer ( 5000 );
+        size_t num_read;
+        REQUIRE_RC ( KFileRead ( buf, pos, & buffer [ 0 ], buffer . size (), & num_read ) );
+        REQUIRE_NE ( num_read, ( size_t ) 0 );
+        REQUIRE_EQ ( memcmp ( & buffer [ 0 ], & data [ pos ], num_read ), 0 );
+        pos += num_read;
+        ++ requests;
+    }
+    REQUIRE ( ReadMatches ( FileSize, 10 ) );
+    ++ requests;
+
+    uint64_t num_reads, num_hits, bytes_prefetched;
+    size_t window;
+    REQUIRE_RC ( KBufReadFileGetReadAheadStats ( buf, & num_reads, & num_hits, & bytes_prefetched, & window ) );
+    REQUIRE_EQ ( num_reads, requests );
+    REQUIRE_EQ ( window, MaxWindow );
+    /* only the first request and the one past the end read in the caller's thread */
+    REQUIRE_GE ( num_hits + 2, num_reads );
+    REQUIRE_GT ( bytes_prefetched, ( uint64_t ) FileSize / 2 );
+}
+
+FIXTURE_TEST_CASE ( ReadAhead_Random, ReadAheadFixture )
+{
+    uint32_t x = 4711;
+    for ( int i = 0; i < 2000; ++ i )
+    {
+        x = x * 1103515245 + 12345;
+        uint64_t pos = ( x >> 4 ) % ( FileSize + 100 );
+        x = x * 1103515245 + 12345;
+        size_t size = 1 + ( x >> 8 ) % ( 2 * MaxWindow );
+        REQUIRE ( ReadMatches ( pos, size ) );
+    }
+
+    /* a jump back to the start shrinks the window again */
+    size_t window;
+    REQUIRE ( ReadMatches ( 0, 100 ) );
+    REQUIRE ( ReadMatches ( 100, 100 ) );
+    REQUIRE_RC ( KBufReadFileGetReadAheadStats ( buf, NULL, NULL, NULL, & window ) );
+    REQUIRE_EQ ( window, Window );
+
+    uint64_t num_reads;
+    REQUIRE_RC ( KBufReadFileGetReadAheadStats ( buf, & num_reads, NULL, NULL, NULL ) );
+    REQUIRE_EQ ( num_reads, ( uint64_t ) 2002 );
+}
+
+FIXTURE_TEST_CASE ( ReadAhead_StatsNeedReadAheadFile, ReadAheadFixture )
+{
+    uint64_t num_reads;
+    REQUIRE_RC_FAIL ( KBufReadFileGetReadAheadStats ( original, & num_reads, NULL, NULL, NULL ) );
+    REQUIRE_RC_FAIL ( KBufReadFileGetReadAheadStats ( NULL, & num_reads, NULL, NULL, NULL ) );
+}
+
+//////////////////////////////////////////// Main
+extern "C"
+{
+
+#include <kapp/args.h>
+
+ver_t CC KAppVersion ( void )
+{
+    return 0x1000000;
+}
+
+rc_t CC UsageSummary ( const char * progname )
+{
+    return 0;
+}
+
+rc_t CC Usage ( const Args * args )
+{
+    return 0;
+}
+
+const char UsageDefaultName [] = "test-buffile-ahead";
+
+rc_t CC KMain ( int argc, char * argv [] )
+{
+    return KBufReadAheadTestSuite ( argc, argv );
+}
+
+}
@@ -0,0 +1,369 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/**
+* Unit tests for KCacheTeeFile, against a local stand-in for the remote file
+*/
+
+#define KFILE_IMPL struct StandIn
+#include <kfs/impl.h>
+
+#include <ktst/unit_test.hpp>
+
+#include <kfs/cacheteefile.h>
+#include <kfs/directory.h>
+#include <kfs/file.h>
+#include <kproc/thread.h>
+#include <kproc/lock.h>
+#include <kproc/cond.h>
+#include <kproc/timeout.h>
+#include <klib/rc.h>
+
+#include <os-native.h>
+#include <string.h>
+#include <vector>
+
+TEST_SUITE(KCacheTeeFileTestSuite);
+
+#define WORK_DIR "cacheteefile-test.tmp"
+#define CACHE_PATH WORK_DIR "/remote"
+
+static const uint32_t BlockSize = 4096;
+static const uint64_t RemoteSize = 256 * 4096 + 123;
+
+/* the remote file: serves a pattern from memory, counts requests and can
+   hold a request for one position until it is let go or 5 seconds passed */
+struct StandIn
+{
+    KFile dad;
+    std::vector < uint8_t > data;
+    KLock * lock;
+    KCondition * cond;
+    uint32_t reads;
+    uint64_t hold_pos;
+    bool hold;
+    bool holding;
+};
+
+static rc_t CC StandInDestroy ( StandIn * self )
+{
+    KConditionRelease ( self -> cond );
+    KLockRelease ( self -> lock );
+    delete self;
+    return 0;
+}
+
+static struct KSysFile * CC StandInGetSysFile ( const StandIn * self, uint64_t * offset )
+{
+    * offset = 0;
+    return NULL;
+}
+
+static rc_t CC StandInRandomAccess ( const StandIn * self )
+{
+    return 0;
+}
+
+static rc_t CC StandInSize ( const StandIn * self, uint64_t * size )
+{
+    * size = self -> data . size ();
+    return 0;
+}
+
+static rc_t CC StandInSetSize ( StandIn * self, uint64_t size )
+{
+    return RC ( rcFS, rcFile, rcUpdating, rcFile, rcReadonly );
+}
+
+static rc_t CC StandInRead ( const StandIn * cself, uint64_t pos,
+    void * buffer, size_t bsize, size_t * num_read )
+{
+    StandIn * self = const_cast < StandIn * > ( cself );
+    rc_t rc = KLockAcquire ( self -> lock );
+    if ( rc == 0 )
+    {
+        ++ self -> reads;
+        if ( self -> hold && pos <= self -> hold_pos && self -> hold_pos < pos + bsize )
+        {
+            timeout_t tm;
+            TimeoutInit ( & tm, 5000 );
+            self -> holding = true;
+            KConditionBroadcast ( self -> cond );
+            while ( self -> hold )
+            {
+                if ( KConditionTimedWait ( self -> cond, self -> lock, & tm ) != 0 )
+                    break;
+            }
+            self -> holding = false;
+        }
+        KLockUnlock ( self -> lock );
+    }
+
+    * num_read = 0;
+    if ( pos < self -> data . size () )
+    {
+        * num_read = self -> data . size () - pos;
+        if ( * num_read > bsize )
+            * num_read = bsize;
+        memmove ( buffer, & self -> data [ pos ], * num_read );
+    }
+    return rc;
+}
+
+static rc_t CC StandInWrite ( StandIn * self, uint64_t pos,
+    const void * buffer, size_t size, size_t * num_writ )
+{
+    return RC ( rcFS, rcFile, rcUpdating, rcInterface, rcUnsupported );
+}
+
+static KFile_vt_v1 StandIn_vt =
+{
+    1, 0,
+    StandInDestroy,
+    StandInGetSysFile,
+    StandInRandomAccess,
+    StandInSize,
+    StandInSetSize,
+    StandInRead,
+    StandInWrite
+};
+
+class CacheTeeFixture
+{
+public:
+    CacheTeeFixture ()
+    :   wd ( 0 ),
+        remote ( new StandIn )
+    {
+        remote -> data . resize ( RemoteSize );
+        uint32_t x = 12345;
+        for ( size_t i = 0; i < remote -> data . size (); ++ i )
+        {
+            x = x * 1103515245 + 12345;
+            remote -> data [ i ] = ( uint8_t ) ( x >> 16 );
+        }
+        remote -> reads = 0;
+        remote -> hold = false;
+        remote -> holding = false;
+        remote -> hold_pos = 0;
+        if ( KLockMake ( & remote -> lock ) != 0 ||
+             KConditionMake ( & remote -> cond ) != 0 ||
+             KFileInit ( & remote -> dad, ( const KFile_vt * ) & StandIn_vt,
+                         "StandIn", "remote", true, false ) != 0 )
+            throw "cannot make the stand-in";
+
+        if ( KDirectoryNativeDir ( & wd ) != 0 )
+            throw "KDirectoryNativeDir failed";
+        KDirectoryRemove ( wd, true, WORK_DIR );
+        if ( KDirectoryCreateDir ( wd, 0775, kcmCreate, WORK_DIR ) != 0 )
+            throw "cannot make " WORK_DIR;
+    }
+    ~CacheTeeFixture ()
+    {
+        KFileRelease ( & remote -> dad );
+        KDirectoryRemove ( wd, true, WORK_DIR );
+        KDirectoryRelease ( wd );
+    }
+
+    rc_t MakeTee ( const KFile ** tee )
+    {
+        return KDirectoryMakeCacheTee ( wd, tee, & remote -> dad, NULL,
+                                        BlockSize, 1, false, CACHE_PATH );
+    }
+
+    /* reads [ pos, pos + size [ the way a client does, in as many calls as it takes */
+    bool ReadMatches ( const KFile * tee, uint64_t pos, size_t size )
+    {
+        std::vector < uint8_t > buffer ( size );
+        size_t total = 0;
+        while ( total < size )
+        {
+            size_t num_read;
+            if ( KFileRead ( tee, pos + total, & buffer [ total ], size - total, & num_read ) != 0 )
+                return false;
+            if ( num_read == 0 )
+                break;
+            total += num_read;
+        }
+        if ( pos + size > remote -> data . size () )
+            size = pos < remote -> data . size () ? remote -> data . size () - pos : 0;
+        return total == size && memcmp ( & buffer [ 0 ], & remote -> data [ pos ], size ) == 0;
+    }
+
+    uint32_t RemoteReads ()
+    {
+        KLockAcquire ( remote -> lock );
+        uint32_t reads = remote -> reads;
+        KLockUnlock ( remote -> lock );
+        return reads;
+    }
+
+    KDirectory * wd;
+    StandIn * remote;
+};
+
+FIXTURE_TEST_CASE ( CacheTee_Sequential, CacheTeeFixture )
+{
+    const KFile * tee;
+    REQUIRE_RC ( MakeTee ( & tee ) );
+
+    uint64_t size;
+    REQUIRE_RC ( KFileSize ( tee, & size ) );
+    REQUIRE_EQ ( size, RemoteSize );
+
+    for ( uint64_t pos = 0; pos < RemoteSize; pos += 10000 )
+        REQUIRE ( ReadMatches ( tee, pos, 10000 ) );
+
+    size_t num_read;
+    char c;
+    REQUIRE_RC ( KFileRead ( tee, RemoteSize, & c, 1, & num_read ) );
+    REQUIRE_EQ ( num_read, ( size_t ) 0 );
+
+    /* a complete cache-file is promoted when the tee goes away */
+    REQUIRE_RC ( KFileRelease ( tee ) );
+    REQUIRE_EQ ( KDirectoryPathType ( wd, CACHE_PATH ), ( uint32_t ) kptFile );
+    REQUIRE_EQ ( KDirectoryPathType ( wd, CACHE_PATH ".cache" ), ( uint32_t ) kptNotFound );
+
+    /* holding exactly the remote content */
+    const KFile * promoted;
+    REQUIRE_RC ( KDirectoryOpenFileRead ( wd, & promoted, CACHE_PATH ) );
+    REQUIRE_RC ( KFileSize ( promoted, & size ) );
+    REQUIRE_EQ ( size, RemoteSize );
+    REQUIRE ( ReadMatches ( promoted, 0, RemoteSize ) );
+    REQUIRE_RC ( KFileRelease ( promoted ) );
+}
+
+FIXTURE_TEST_CASE ( CacheTee_Random, CacheTeeFixture )
+{
+    const KFile * tee;
+    REQUIRE_RC ( MakeTee ( & tee ) );
+
+    uint32_t x = 4711;
+    for ( int i = 0; i < 500; ++ i )
+    {
+        x = x * 1103515245 + 12345;
+        uint64_t pos = ( x >> 8 ) % ( RemoteSize + 100 );
+        x = x * 1103515245 + 12345;
+        size_t size = 1 + ( x >> 8 ) % ( 3 * BlockSize );
+        REQUIRE ( ReadMatches ( tee, pos, size ) );
+    }
+
+    /* everything read once more comes from the local file */
+    uint32_t reads = RemoteReads ();
+    x = 4711;
+    for ( int i = 0; i < 500; ++ i )
+    {
+        x = x * 1103515245 + 12345;
+        uint64_t pos = ( x >> 8 ) % ( RemoteSize + 100 );
+        x = x * 1103515245 + 12345;
+        size_t size = 1 + ( x >> 8 ) % ( 3 * BlockSize );
+        REQUIRE ( ReadMatches ( tee, pos, size ) );
+    }
+    REQUIRE_EQ ( RemoteReads (), reads );
+
+    REQUIRE_RC ( KFileRelease ( tee ) );
+}
+
+struct MissReader
+{
+    CacheTeeFixture * fixture;
+    const KFile * tee;
+    uint64_t pos;
+    bool matched;
+};
+
+static rc_t CC ReadMiss ( const KThread * self, void * data )
+{
+    MissReader * r = ( MissReader * ) data;
+    r -> matched = r -> fixture -> ReadMatches ( r -> tee, r -> pos, BlockSize );
+    return 0;
+}
+
+FIXTURE_TEST_CASE ( CacheTee_HitWhileMissIsFetched, CacheTeeFixture )
+{
+    const KFile * tee;
+    REQUIRE_RC ( MakeTee ( & tee ) );
+    REQUIRE ( ReadMatches ( tee, 0, BlockSize ) );
+
+    /* another thread runs into a remote request that does not come back ... */
+    MissReader r = { this, tee, 200 * BlockSize, false };
+    remote -> hold_pos = r . pos;
+    remote -> hold = true;
+
+    KThread * t;
+    REQUIRE_RC ( KThreadMake ( & t, ReadMiss, & r ) );
+    REQUIRE_RC ( KLockAcquire ( remote -> lock ) );
+    while ( ! remote -> holding )
+        REQUIRE_RC ( KConditionWait ( remote -> cond, remote -> lock ) );
+    REQUIRE_RC ( KLockUnlock ( remote -> lock ) );
+
+    /* ... which does not keep this one from reading what is cached */
+    REQUIRE ( ReadMatches ( tee, 0, BlockSize ) );
+    REQUIRE_RC ( KLockAcquire ( remote -> lock ) );
+    bool still_holding = remote -> holding;
+    remote -> hold = false;
+    KConditionBroadcast ( remote -> cond );
+    REQUIRE_RC ( KLockUnlock ( remote -> lock ) );
+    REQUIRE ( still_holding );
+
+    rc_t status;
+    REQUIRE_RC ( KThreadWait ( t, & status ) );
+    REQUIRE_RC ( KThreadRelease ( t ) );
+    REQUIRE ( r . matched );
+    REQUIRE ( ReadMatches ( tee, r . pos, BlockSize ) );
+
+    REQUIRE_RC ( KFileRelease ( tee ) );
+}
+
+//////////////////////////////////////////// Main
+extern "C"
+{
+
+#include <kapp/args.h>
+
+ver_t CC KAppVersion ( void )
+{
+    return 0x1000000;
+}
+
+rc_t CC UsageSummary ( const char * progname )
+{
+    return 0;
+}
+
+rc_t CC Usage ( const Args * args )
+{
+    return 0;
+}
+
+const char UsageDefaultName [] = "test-cacheteefile";
+
+rc_t CC KMain ( int argc, char * argv [] )
+{
+    return KCacheTeeFileTestSuite ( argc, argv );
+}
+
+}
@@ -0,0 +1,271 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/**
+* Unit tests for parallel gzip/bzip2 writers sharing a KParZipPool
+*/
+
+#include <ktst/unit_test.hpp>
+
+#include <kfs/pzip.h>
+#include <kfs/gzip.h>
+#include <kfs/bzip.h>
+#include <kfs/directory.h>
+#include <kfs/file.h>
+#include <klib/rc.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+TEST_SUITE(KParZipPoolTestSuite);
+
+#define WORK_DIR "pzip-test.tmp"
+
+static const size_t Chunk = 64 * 1024;
+
+class PZipFixture
+{
+public:
+    PZipFixture ()
+    :   wd ( 0 )
+    {
+        if ( KDirectoryNativeDir ( & wd ) != 0 )
+            throw std :: logic_error ( "KDirectoryNativeDir failed" );
+        KDirectoryRemove ( wd, true, WORK_DIR );
+        if ( KDirectoryCreateDir ( wd, 0775, kcmInit, WORK_DIR ) != 0 )
+            throw std :: logic_error ( "cannot make " WORK_DIR );
+    }
+    ~PZipFixture ()
+    {
+        KDirectoryRemove ( wd, true, WORK_DIR );
+        KDirectoryRelease ( wd );
+    }
+
+    /* distinct, compressible content for every file */
+    static std :: vector < uint8_t > Data ( size_t size, uint32_t seed )
+    {
+        static const char acgt [] = "ACGT";
+        std :: vector < uint8_t > data ( size );
+        uint32_t x = seed;
+        for ( size_t i = 0; i < size; ++ i )
+        {
+            x = x * 1103515245 + 12345;
+            data [ i ] = ( i % 61 == 60 ) ? '\n' : acgt [ ( x >> 16 ) & 3 ];
+        }
+        return data;
+    }
+
+    KFile * Create ( const char * name, bool bzip2, KParZipPool * pool )
+    {
+        KFile * f;
+        KFile * z;
+        if ( KDirectoryCreateFile ( wd, & f, false, 0664, kcmInit, WORK_DIR "/%s", name ) != 0 )
+            throw std :: logic_error ( std :: string ( "cannot create " ) + name );
+        rc_t rc = bzip2
+            ? KFileMakeParallelBzip2ForWrite ( & z, f, Chunk, pool )
+            : KFileMakeParallelGzipForWrite ( & z, f, Chunk, pool );
+        KFileRelease ( f );
+        if ( rc != 0 )
+            throw std :: logic_error ( std :: string ( "cannot compress " ) + name );
+        return z;
+    }
+
+    std :: vector < uint8_t > Read ( const char * name, bool bzip2 )
+    {
+        const KFile * f;
+        const KFile * z;
+        std :: vector < uint8_t > data;
+        if ( KDirectoryOpenFileRead ( wd, & f, WORK_DIR "/%s", name ) != 0 )
+            throw std :: logic_error ( std :: string ( "cannot open " ) + name );
+        rc_t rc = bzip2 ? KFileMakeBzip2ForRead ( & z, f ) : KFileMakeGzipForRead ( & z, f );
+        KFileRelease ( f );
+        if ( rc != 0 )
+            throw std :: logic_error ( std :: string ( "cannot decompress " ) + name );
+
+        uint64_t pos = 0;
+        while ( true )
+        {
+            uint8_t buff [ 32 * 1024 ];
+            size_t num_read;
+            if ( KFileRead ( z, pos, buff, sizeof buff, & num_read ) != 0 )
+            {
+                KFileRelease ( z );
+                throw std :: logic_error ( std :: string ( "cannot read " ) + name );
+            }
+            if ( num_read == 0 )
+                break;
+            data . insert ( data . end (), buff, buff + num_read );
+            pos += num_read;
+        }
+        KFileRelease ( z );
+        return data;
+    }
+
+    /* writes every file in turns of odd-sized pieces, like a splitter */
+    void WriteInterleaved ( bool bzip2, KParZipPool * pool, size_t files, size_t size )
+    {
+        std :: vector < KFile * > z ( files );
+        std :: vector < std :: vector < uint8_t > > data ( files );
+        size_t i, pos;
+        char name [ 32 ];
+
+        for ( i = 0; i < files; ++ i )
+        {
+            sprintf ( name, "%u", ( unsigned ) i );
+            z [ i ] = Create ( name, bzip2, pool );
+            data [ i ] = Data ( size, ( uint32_t ) i + 1 );
+        }
+        for ( pos = 0; pos < size; )
+        {
+            size_t piece = 1000 + pos % 7919;
+            if ( piece > size - pos )
+                piece = size - pos;
+            for ( i = 0; i < files; ++ i )
+            {
+                size_t num_writ;
+                if ( KFileWriteAll ( z [ i ], pos, & data [ i ] [ pos ], piece, & num_writ ) != 0 || num_writ != piece )
+                    throw std :: logic_error ( "write failed" );
+            }
+            pos += piece;
+        }
+        for ( i = 0; i < files; ++ i )
+        {
+            if ( KFileRelease ( z [ i ] ) != 0 )
+                throw std :: logic_error ( "close failed" );
+        }
+        for ( i = 0; i < files; ++ i )
+        {
+            sprintf ( name, "%u", ( unsigned ) i );
+            if ( Read ( name, bzip2 ) != data [ i ] )
+                throw std :: logic_error ( std :: string ( "content differs in " ) + name );
+        }
+    }
+
+    KDirectory * wd;
+};
+
+TEST_CASE ( PZip_PoolMakeRelease )
+{
+    KParZipPool * pool;
+    REQUIRE_RC_FAIL ( KParZipPoolMake ( NULL, 2 ) );
+    REQUIRE_RC ( KParZipPoolMake ( & pool, 2 ) );
+    REQUIRE_RC ( KParZipPoolAddRef ( pool ) );
+    REQUIRE_RC ( KParZipPoolRelease ( pool ) );
+    REQUIRE_RC ( KParZipPoolRelease ( pool ) );
+    REQUIRE_RC ( KParZipPoolRelease ( NULL ) );
+}
+
+FIXTURE_TEST_CASE ( PZip_SharedPoolGzip, PZipFixture )
+{
+    KParZipPool * pool;
+    REQUIRE_RC ( KParZipPoolMake ( & pool, 3 ) );
+    WriteInterleaved ( false, pool, 5, 20 * Chunk + 12345 );
+    REQUIRE_RC ( KParZipPoolRelease ( pool ) );
+}
+
+FIXTURE_TEST_CASE ( PZip_SharedPoolBzip2, PZipFixture )
+{
+    KParZipPool * pool;
+    REQUIRE_RC ( KParZipPoolMake ( & pool, 2 ) );
+    WriteInterleaved ( true, pool, 3, 8 * Chunk + 321 );
+    REQUIRE_RC ( KParZipPoolRelease ( pool ) );
+}
+
+FIXTURE_TEST_CASE ( PZip_OneThreadManyFiles, PZipFixture )
+{
+    /* the writers compress chunks the single thread has not taken yet */
+    KParZipPool * pool;
+    REQUIRE_RC ( KParZipPoolMake ( & pool, 1 ) );
+    WriteInterleaved ( false, pool, 8, 6 * Chunk + 1 );
+    REQUIRE_RC ( KParZipPoolRelease ( pool ) );
+}
+
+FIXTURE_TEST_CASE ( PZip_PrivatePool, PZipFixture )
+{
+    WriteInterleaved ( false, NULL, 2, 10 * Chunk );
+}
+
+FIXTURE_TEST_CASE ( PZip_WritersOutlivePool, PZipFixture )
+{
+    KParZipPool * pool;
+    REQUIRE_RC ( KParZipPoolMake ( & pool, 2 ) );
+    KFile * z = Create ( "a", false, pool );
+    REQUIRE_RC ( KParZipPoolRelease ( pool ) );
+
+    std :: vector < uint8_t > data = Data ( 5 * Chunk + 17, 7 );
+    size_t num_writ;
+    REQUIRE_RC ( KFileWriteAll ( z, 0, & data [ 0 ], data . size (), & num_writ ) );
+    REQUIRE_EQ ( num_writ, data . size () );
+    REQUIRE_RC ( KFileRelease ( z ) );
+    REQUIRE ( Read ( "a", false ) == data );
+}
+
+FIXTURE_TEST_CASE ( PZip_EmptyInput, PZipFixture )
+{
+    KParZipPool * pool;
+    REQUIRE_RC ( KParZipPoolMake ( & pool, 2 ) );
+    REQUIRE_RC ( KFileRelease ( Create ( "gz", false, pool ) ) );
+    REQUIRE_RC ( KFileRelease ( Create ( "bz", true, pool ) ) );
+    REQUIRE_RC ( KParZipPoolRelease ( pool ) );
+
+    uint64_t size;
+    REQUIRE_RC ( KDirectoryFileSize ( wd, & size, WORK_DIR "/gz" ) );
+    REQUIRE_NE ( size, ( uint64_t ) 0 );
+    REQUIRE_RC ( KDirectoryFileSize ( wd, & size, WORK_DIR "/bz" ) );
+    REQUIRE_NE ( size, ( uint64_t ) 0 );
+    REQUIRE ( Read ( "gz", false ) . empty () );
+}
+
+//////////////////////////////////////////// Main
+extern "C"
+{
+
+#include <kapp/args.h>
+
+ver_t CC KAppVersion ( void )
+{
+    return 0x1000000;
+}
+
+rc_t CC UsageSummary ( const char * progname )
+{
+    return 0;
+}
+
+rc_t CC Usage ( const Args * args )
+{
+    return 0;
+}
+
+const char UsageDefaultName [] = "test-pzip";
+
+rc_t CC KMain ( int argc, char * argv [] )
+{
+    return KParZipPoolTestSuite ( argc, argv );
+}
+
+}
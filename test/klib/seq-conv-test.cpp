@@ -0,0 +1,415 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/**
+* Unit tests for the sequence conversion kernels,
+* comparing every kernel with a plain loop over all byte values,
+* lengths and alignments, with and without vector code
+*/
+
+#include <ktst/unit_test.hpp>
+
+#include <klib/seq-conv.h>
+#include <klib/klib-priv.h>
+
+#include <string.h>
+#include <vector>
+
+TEST_SUITE(SeqConvTestSuite);
+
+/* lengths 0 .. MaxLen cover every vector tail, and LongLen runs many vectors */
+static const size_t MaxLen = 100;
+static const size_t LongLen = 4096 + 15;
+static const size_t MaxAlign = 16;
+static const size_t Guard = 32;
+static const uint8_t GuardByte = 0xA5;
+
+/* the source holds every byte value, at every alignment, in a different order */
+static
+std :: vector < uint8_t > Source ( size_t size, uint32_t seed )
+{
+    std :: vector < uint8_t > src ( size );
+    for ( size_t i = 0; i < size; ++ i )
+        src [ i ] = ( uint8_t ) ( i * 167 + seed );
+    return src;
+}
+
+/* maps exercised by MapBytes: dense maps take the scalar loop
+   inside the vector kernel, sparse ones the vector lookups */
+static
+std :: vector < std :: vector < uint8_t > > ByteMaps ()
+{
+    std :: vector < std :: vector < uint8_t > > maps;
+    std :: vector < uint8_t > m ( 256 );
+    size_t i;
+
+    /* complement of text bases, as used for reverse complement */
+    static const char from [] = "ACGTNacgtnMRWSYKVHDBmrwsykvhdb.-";
+    static const char to   [] = "TGCANtgcanKYWSRMBDHVkywsrmbdhv.-";
+    memset ( & m [ 0 ], 0, 256 );
+    for ( i = 0; from [ i ] != 0; ++ i )
+        m [ ( uint8_t ) from [ i ] ] = to [ i ];
+    maps . push_back ( m );
+
+    /* text to 4na */
+    memset ( & m [ 0 ], 0, 256 );
+    m [ 'A' ] = m [ 'a' ] = 1;
+    m [ 'C' ] = m [ 'c' ] = 2;
+    m [ 'G' ] = m [ 'g' ] = 4;
+    m [ 'T' ] = m [ 't' ] = 8;
+    m [ 'N' ] = m [ 'n' ] = 15;
+    maps . push_back ( m );
+
+    /* values only in the upper half, including 0xFF */
+    memset ( & m [ 0 ], 0, 256 );
+    for ( i = 0x80; i < 0x90; ++ i )
+        m [ i ] = ( uint8_t ) ( 0x100 - i );
+    for ( i = 0xF0; i < 0x100; ++ i )
+        m [ i ] = ( uint8_t ) i;
+    maps . push_back ( m );
+
+    /* exactly as many non-zero tables as the vector path takes, then one more */
+    for ( size_t tables = 8; tables <= 9; ++ tables )
+    {
+        static const int order [ 16 ] = { 0, 15, 7, 8, 3, 12, 1, 14, 5, 10, 2, 13, 4, 11, 6, 9 };
+        memset ( & m [ 0 ], 0, 256 );
+        for ( size_t t = 0; t < tables; ++ t )
+        {
+            for ( i = 0; i < 16; ++ i )
+            {
+                if ( ( i + t ) % 3 != 1 )
+                    m [ order [ t ] * 16 + i ] = ( uint8_t ) ( ( order [ t ] * 16 + i ) * 37 + 1 );
+            }
+        }
+        maps . push_back ( m );
+    }
+
+    /* dense: every byte maps somewhere */
+    for ( i = 0; i < 256; ++ i )
+        m [ i ] = ( uint8_t ) ( 255 - i );
+    maps . push_back ( m );
+
+    /* all zero */
+    memset ( & m [ 0 ], 0, 256 );
+    maps . push_back ( m );
+
+    return maps;
+}
+
+class SeqConvFixture
+{
+public:
+    SeqConvFixture ()
+    :   dst ( LongLen + MaxAlign + Guard ),
+        expected ( LongLen )
+    {
+    }
+
+    /* places output at "align" and checks the guard bytes behind it */
+    uint8_t * Dst ( size_t align, size_t count )
+    {
+        memset ( & dst [ 0 ], GuardByte, dst . size () );
+        return & dst [ align ];
+    }
+
+    bool Same ( size_t align, size_t count, size_t compared )
+    {
+        if ( compared != 0 && memcmp ( & dst [ align ], & expected [ 0 ], compared ) != 0 )
+            return false;
+        for ( size_t i = 0; i < align; ++ i )
+            if ( dst [ i ] != GuardByte )
+                return false;
+        for ( size_t i = align + count; i < dst . size (); ++ i )
+            if ( dst [ i ] != GuardByte )
+                return false;
+        return true;
+    }
+
+    /* runs "check" for every length and every source and destination alignment */
+    template < class Check >
+    void AllShapes ( const std :: vector < uint8_t > & src, Check check )
+    {
+        for ( size_t len = 0; len <= MaxLen; ++ len )
+            for ( size_t sa = 0; sa < MaxAlign; ++ sa )
+                for ( size_t da = 0; da < MaxAlign; ++ da )
+                    check ( & src [ sa ], len, da );
+        for ( size_t sa = 0; sa < MaxAlign; ++ sa )
+            check ( & src [ sa ], LongLen, MaxAlign - 1 - sa );
+    }
+
+    std :: vector < uint8_t > dst;
+    std :: vector < uint8_t > expected;
+};
+
+/* calls a test body once with vector code and once without */
+#define BOTH_PATHS( body ) \
+    do { \
+        SeqConvUseVector ( true ); \
+        body; \
+        SeqConvUseVector ( false ); \
+        body; \
+        SeqConvUseVector ( true ); \
+    } while ( 0 )
+
+///////////////////////////////////////////////// MapBytes
+
+struct CheckMapBytes
+{
+    SeqConvFixture & f;
+    const uint8_t * map;
+    bool reverse;
+    bool & ok;
+
+    void operator () ( const uint8_t * src, size_t len, size_t da ) const
+    {
+        if ( ! ok )
+            return;
+        for ( size_t i = 0; i < len; ++ i )
+            f . expected [ i ] = map [ src [ reverse ? len - 1 - i : i ] ];
+        uint8_t * d = f . Dst ( da, len );
+        if ( reverse )
+            SeqMapBytesReverse ( d, src, len, map );
+        else
+            SeqMapBytes ( d, src, len, map );
+        ok = f . Same ( da, len, len );
+    }
+};
+
+FIXTURE_TEST_CASE ( SeqConv_MapBytes, SeqConvFixture )
+{
+    std :: vector < std :: vector < uint8_t > > maps = ByteMaps ();
+    std :: vector < uint8_t > src = Source ( LongLen + MaxAlign, 3 );
+    for ( size_t m = 0; m < maps . size (); ++ m )
+    {
+        bool ok = true;
+        CheckMapBytes check = { * this, & maps [ m ] [ 0 ], false, ok };
+        BOTH_PATHS ( AllShapes ( src, check ) );
+        REQUIRE ( ok );
+    }
+}
+
+FIXTURE_TEST_CASE ( SeqConv_MapBytesReverse, SeqConvFixture )
+{
+    std :: vector < std :: vector < uint8_t > > maps = ByteMaps ();
+    std :: vector < uint8_t > src = Source ( LongLen + MaxAlign, 5 );
+    for ( size_t m = 0; m < maps . size (); ++ m )
+    {
+        bool ok = true;
+        CheckMapBytes check = { * this, & maps [ m ] [ 0 ], true, ok };
+        BOTH_PATHS ( AllShapes ( src, check ) );
+        REQUIRE ( ok );
+    }
+}
+
+FIXTURE_TEST_CASE ( SeqConv_MapBytesEveryValue, SeqConvFixture )
+{
+    /* every byte value maps to itself plus one, one table at a time */
+    for ( size_t k = 0; k < 16; ++ k )
+    {
+        uint8_t map [ 256 ];
+        memset ( map, 0, sizeof map );
+        for ( size_t i = k * 16; i < k * 16 + 16; ++ i )
+            map [ i ] = ( uint8_t ) ( i + 1 );
+
+        std :: vector < uint8_t > src = Source ( 256, 0 );
+        for ( size_t i = 0; i < 256; ++ i )
+            expected [ i ] = map [ src [ i ] ];
+        BOTH_PATHS (
+            SeqMapBytes ( Dst ( 0, 256 ), & src [ 0 ], 256, map );
+            REQUIRE ( Same ( 0, 256, 256 ) ) );
+    }
+}
+
+///////////////////////////////////////////////// MapNibbles
+
+static const uint8_t NibbleMap [ 16 ] =
+{ 'N', 'A', 'C', 'M', 'G', 'R', 'S', 'V', 'T', 'W', 'Y', 'H', 'K', 'D', 'B', 'N' };
+
+struct CheckMapNibbles
+{
+    SeqConvFixture & f;
+    bool reverse;
+    bool & ok;
+
+    void operator () ( const uint8_t * src, size_t len, size_t da ) const
+    {
+        if ( ! ok )
+            return;
+        size_t i;
+        for ( i = 0; i < len; ++ i )
+        {
+            uint8_t s = src [ reverse ? len - 1 - i : i ];
+            if ( s >= 16 )
+                break;
+            f . expected [ i ] = NibbleMap [ s ];
+        }
+        uint8_t * d = f . Dst ( da, len );
+        size_t n = reverse
+            ? SeqMapNibblesReverse ( d, src, len, NibbleMap )
+            : SeqMapNibbles ( d, src, len, NibbleMap );
+        if ( n != i )
+            ok = false;
+        /* beyond the returned count "dst" is undefined but in bounds */
+        else
+            ok = f . Same ( da, len, n );
+    }
+};
+
+FIXTURE_TEST_CASE ( SeqConv_MapNibbles, SeqConvFixture )
+{
+    std :: vector < uint8_t > src = Source ( LongLen + MaxAlign, 7 );
+    for ( size_t i = 0; i < src . size (); ++ i )
+        src [ i ] &= 15;
+
+    for ( int reverse = 0; reverse < 2; ++ reverse )
+    {
+        bool ok = true;
+        CheckMapNibbles check = { * this, reverse != 0, ok };
+        BOTH_PATHS ( AllShapes ( src, check ) );
+        REQUIRE ( ok );
+    }
+}
+
+FIXTURE_TEST_CASE ( SeqConv_MapNibblesStop, SeqConvFixture )
+{
+    /* every value that is not a nibble, at every position of every length */
+    const size_t len = 3 * 16 + 5;
+    std :: vector < uint8_t > src = Source ( len + MaxAlign, 11 );
+    for ( size_t i = 0; i < src . size (); ++ i )
+        src [ i ] &= 15;
+
+    for ( int reverse = 0; reverse < 2; ++ reverse )
+    {
+        bool ok = true;
+        CheckMapNibbles check = { * this, reverse != 0, ok };
+        for ( unsigned v = 16; v < 256; ++ v )
+        {
+            for ( size_t pos = 0; pos < len; ++ pos )
+            {
+                size_t sa = ( v + pos ) % MaxAlign;
+                uint8_t save = src [ sa + pos ];
+                src [ sa + pos ] = ( uint8_t ) v;
+                for ( size_t n = pos + 1; n <= len; n += 7 )
+                    BOTH_PATHS ( check ( & src [ sa ], n, v % MaxAlign ) );
+                src [ sa + pos ] = save;
+            }
+        }
+        REQUIRE ( ok );
+    }
+}
+
+///////////////////////////////////////////////// AddOffset
+
+struct CheckAddOffset
+{
+    SeqConvFixture & f;
+    int offset;
+    bool reverse;
+    bool & ok;
+
+    void operator () ( const uint8_t * src, size_t len, size_t da ) const
+    {
+        if ( ! ok )
+            return;
+        for ( size_t i = 0; i < len; ++ i )
+            f . expected [ i ] = ( uint8_t ) ( src [ reverse ? len - 1 - i : i ] + offset );
+        uint8_t * d = f . Dst ( da, len );
+        if ( reverse )
+            SeqAddOffsetReverse ( d, src, len, offset );
+        else
+            SeqAddOffset ( d, src, len, offset );
+        ok = f . Same ( da, len, len );
+    }
+};
+
+FIXTURE_TEST_CASE ( SeqConv_AddOffset, SeqConvFixture )
+{
+    static const int offsets [] = { 0, 1, 33, 64, 127, 128, 255, 256, -1, -33, -64, -255 };
+    std :: vector < uint8_t > src = Source ( LongLen + MaxAlign, 13 );
+    for ( size_t o = 0; o < sizeof offsets / sizeof offsets [ 0 ]; ++ o )
+    {
+        for ( int reverse = 0; reverse < 2; ++ reverse )
+        {
+            bool ok = true;
+            CheckAddOffset check = { * this, offsets [ o ], reverse != 0, ok };
+            BOTH_PATHS ( AllShapes ( src, check ) );
+            REQUIRE ( ok );
+        }
+    }
+}
+
+FIXTURE_TEST_CASE ( SeqConv_AddOffsetEveryValue, SeqConvFixture )
+{
+    /* every offset applied to every byte value */
+    std :: vector < uint8_t > src = Source ( 256, 0 );
+    for ( int offset = -256; offset <= 256; ++ offset )
+    {
+        bool ok = true;
+        CheckAddOffset fwd = { * this, offset, false, ok };
+        CheckAddOffset rev = { * this, offset, true, ok };
+        BOTH_PATHS ( fwd ( & src [ 0 ], 256, 0 ); rev ( & src [ 0 ], 256, 0 ) );
+        REQUIRE ( ok );
+    }
+}
+
+///////////////////////////////////////////////// dispatch
+
+TEST_CASE ( SeqConv_UseVector )
+{
+    /* scalar code is always available */
+    REQUIRE ( ! SeqConvUseVector ( false ) );
+    SeqConvUseVector ( true );
+}
+
+//////////////////////////////////////////// Main
+extern "C"
+{
+
+#include <kapp/args.h>
+
+ver_t CC KAppVersion ( void )
+{
+    return 0x1000000;
+}
+
+rc_t CC UsageSummary ( const char * progname )
+{
+    return 0;
+}
+
+rc_t CC Usage ( const Args * args )
+{
+    return 0;
+}
+
+const char UsageDefaultName [] = "test-seq-conv";
+
+rc_t CC KMain ( int argc, char * argv [] )
+{
+    return SeqConvTestSuite ( argc, argv );
+}
+
+}
@@ -0,0 +1,335 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/**
+* Unit tests for KOrderedQueue
+*/
+
+#include <ktst/unit_test.hpp>
+
+#include <kproc/ordered-queue.h>
+#include <kproc/thread.h>
+#include <kproc/lock.h>
+#include <kproc/cond.h>
+#include <kproc/timeout.h>
+#include <klib/rc.h>
+
+#include <os-native.h>
+
+TEST_SUITE(KOrderedQueueTestSuite);
+
+struct TestItem
+{
+    KOrderedItem dad;
+    uint32_t seq;
+    uint32_t delay;     /* mS a worker spends on it */
+    bool worked;
+};
+
+static uint32_t whacked;
+
+static void CC WhackTestItem ( KOrderedItem * item, void * data )
+{
+    ++ whacked;
+    delete ( TestItem * ) item;
+}
+
+static TestItem * MakeItem ( uint32_t seq, uint32_t delay = 0 )
+{
+    TestItem * item = new TestItem;
+    item -> seq = seq;
+    item -> delay = delay;
+    item -> worked = false;
+    return item;
+}
+
+static void Pause ( uint32_t ms )
+{
+    KLock * lock;
+    KCondition * cond;
+    if ( KLockMake ( & lock ) == 0 )
+    {
+        if ( KConditionMake ( & cond ) == 0 )
+        {
+            timeout_t tm;
+            TimeoutInit ( & tm, ms );
+            KLockAcquire ( lock );
+            KConditionTimedWait ( cond, lock, & tm );
+            KLockUnlock ( lock );
+            KConditionRelease ( cond );
+        }
+        KLockRelease ( lock );
+    }
+}
+
+/* takes items until the queue is sealed and empty */
+static rc_t CC Worker ( const KThread * self, void * data )
+{
+    KOrderedQueue * q = ( KOrderedQueue * ) data;
+    KOrderedItem * item;
+    while ( KOrderedQueueWork ( q, & item ) == 0 && item != NULL )
+    {
+        TestItem * t = ( TestItem * ) item;
+        if ( ! KOrderedQueueQuitting ( q ) )
+        {
+            Pause ( t -> delay );
+            t -> worked = true;
+        }
+        KOrderedQueueDone ( q, item );
+    }
+    return 0;
+}
+
+static const uint32_t ItemCount = 200;
+
+static rc_t CC Producer ( const KThread * self, void * data )
+{
+    KOrderedQueue * q = ( KOrderedQueue * ) data;
+    rc_t rc = 0;
+    for ( uint32_t i = 0; i < ItemCount && rc == 0; ++ i )
+    {   /* later items are often finished before earlier ones */
+        rc = KOrderedQueueSubmit ( q, & MakeItem ( i, ( i * 7 ) % 5 ) -> dad, true );
+    }
+    KOrderedQueueSeal ( q );
+    return rc;
+}
+
+TEST_CASE ( KOrderedQueue_Order )
+{
+    KOrderedQueue * q;
+    KThread * workers [ 3 ];
+    KThread * producer;
+    rc_t status;
+
+    whacked = 0;
+    REQUIRE_RC ( KOrderedQueueMake ( & q, 2, 4, WhackTestItem, NULL ) );
+    for ( uint32_t i = 0; i < 3; ++ i )
+        REQUIRE_RC ( KThreadMake ( & workers [ i ], Worker, q ) );
+    REQUIRE_RC ( KThreadMake ( & producer, Producer, q ) );
+
+    uint32_t expected = 0;
+    KOrderedItem * item;
+    while ( KOrderedQueueNext ( q, & item ) == 0 && item != NULL )
+    {
+        TestItem * t = ( TestItem * ) item;
+        CHECK_EQ ( t -> seq, expected );
+        CHECK ( t -> worked );
+        ++ expected;
+        delete t;
+    }
+    REQUIRE_EQ ( expected, ItemCount );
+
+    REQUIRE_RC ( KThreadWait ( producer, & status ) );
+    REQUIRE_RC ( status );
+    KThreadRelease ( producer );
+    for ( uint32_t i = 0; i < 3; ++ i )
+    {
+        REQUIRE_RC ( KThreadWait ( workers [ i ], NULL ) );
+        KThreadRelease ( workers [ i ] );
+    }
+    REQUIRE_RC ( KOrderedQueueRelease ( q ) );
+    REQUIRE_EQ ( whacked, 0u );
+}
+
+TEST_CASE ( KOrderedQueue_Sealed )
+{
+    KOrderedQueue * q;
+    KOrderedItem * item;
+
+    REQUIRE_RC ( KOrderedQueueMake ( & q, 2, 2, WhackTestItem, NULL ) );
+    REQUIRE_RC ( KOrderedQueueSeal ( q ) );
+    REQUIRE_RC ( KOrderedQueueWork ( q, & item ) );
+    REQUIRE_NULL ( item );
+    REQUIRE_RC ( KOrderedQueueNext ( q, & item ) );
+    REQUIRE_NULL ( item );
+    REQUIRE_RC_FAIL ( KOrderedQueueSubmit ( q, & MakeItem ( 0 ) -> dad, true ) );
+    REQUIRE_RC ( KOrderedQueueRelease ( q ) );
+}
+
+TEST_CASE ( KOrderedQueue_NoWork )
+{
+    KOrderedQueue * q;
+    KOrderedItem * item;
+
+    REQUIRE_RC ( KOrderedQueueMake ( & q, 2, 2, WhackTestItem, NULL ) );
+    REQUIRE_RC ( KOrderedQueueSubmit ( q, & MakeItem ( 7 ) -> dad, false ) );
+    REQUIRE_RC ( KOrderedQueueSeal ( q ) );
+
+    /* no worker sees it, the consumer gets it anyway */
+    REQUIRE_RC ( KOrderedQueueWork ( q, & item ) );
+    REQUIRE_NULL ( item );
+    REQUIRE_RC ( KOrderedQueueNext ( q, & item ) );
+    REQUIRE_NOT_NULL ( item );
+    REQUIRE_EQ ( ( ( TestItem * ) item ) -> seq, 7u );
+    REQUIRE ( ! ( ( TestItem * ) item ) -> worked );
+    delete ( TestItem * ) item;
+    REQUIRE_RC ( KOrderedQueueRelease ( q ) );
+}
+
+static rc_t CC Quitter ( const KThread * self, void * data )
+{
+    Pause ( 200 );
+    return KOrderedQueueQuit ( ( KOrderedQueue * ) data );
+}
+
+TEST_CASE ( KOrderedQueue_QuitFullQueue )
+{
+    KOrderedQueue * q;
+    KThread * quitter;
+
+    whacked = 0;
+    REQUIRE_RC ( KOrderedQueueMake ( & q, 2, 2, WhackTestItem, NULL ) );
+    REQUIRE_RC ( KOrderedQueueSubmit ( q, & MakeItem ( 0 ) -> dad, false ) );
+    REQUIRE_RC ( KOrderedQueueSubmit ( q, & MakeItem ( 1 ) -> dad, false ) );
+    REQUIRE ( ! KOrderedQueueQuitting ( q ) );
+
+    /* nobody consumes: the submit waits until told to quit, then drops the item */
+    REQUIRE_RC ( KThreadMake ( & quitter, Quitter, q ) );
+    REQUIRE_RC_FAIL ( KOrderedQueueSubmit ( q, & MakeItem ( 2 ) -> dad, false ) );
+    REQUIRE ( KOrderedQueueQuitting ( q ) );
+    REQUIRE_EQ ( whacked, 1u );
+    REQUIRE_RC ( KThreadWait ( quitter, NULL ) );
+    KThreadRelease ( quitter );
+
+    /* the last release whacks what is still queued */
+    REQUIRE_RC ( KOrderedQueueRelease ( q ) );
+    REQUIRE_EQ ( whacked, 3u );
+}
+
+struct HeadTest
+{
+    KOrderedQueue * q;
+    volatile bool atHead;
+    rc_t rc;
+};
+
+/* finishes the first item, then waits until the consumer waits for the second */
+static rc_t CC HeadWorker ( const KThread * self, void * data )
+{
+    HeadTest * h = ( HeadTest * ) data;
+    KOrderedItem * item;
+
+    KOrderedQueueWork ( h -> q, & item );
+    KOrderedQueueDone ( h -> q, item );
+
+    KOrderedQueueWork ( h -> q, & item );
+    h -> rc = KOrderedQueueHeadWait ( h -> q, item );
+    h -> atHead = true;
+    KOrderedQueueDone ( h -> q, item );
+    return 0;
+}
+
+TEST_CASE ( KOrderedQueue_HeadWait )
+{
+    HeadTest h;
+    KThread * worker;
+    KOrderedItem * item;
+
+    h . atHead = false;
+    h . rc = 0;
+    REQUIRE_RC ( KOrderedQueueMake ( & h . q, 2, 2, WhackTestItem, NULL ) );
+    REQUIRE_RC ( KOrderedQueueSubmit ( h . q, & MakeItem ( 0 ) -> dad, true ) );
+    REQUIRE_RC ( KOrderedQueueSubmit ( h . q, & MakeItem ( 1 ) -> dad, true ) );
+    REQUIRE_RC ( KOrderedQueueSeal ( h . q ) );
+    REQUIRE_RC ( KThreadMake ( & worker, HeadWorker, & h ) );
+
+    REQUIRE_RC ( KOrderedQueueNext ( h . q, & item ) );
+    REQUIRE_EQ ( ( ( TestItem * ) item ) -> seq, 0u );
+    delete ( TestItem * ) item;
+
+    /* the consumer has not asked for the second item yet */
+    Pause ( 200 );
+    REQUIRE ( ! h . atHead );
+
+    REQUIRE_RC ( KOrderedQueueNext ( h . q, & item ) );
+    REQUIRE_EQ ( ( ( TestItem * ) item ) -> seq, 1u );
+    REQUIRE ( h . atHead );
+    delete ( TestItem * ) item;
+
+    REQUIRE_RC ( KThreadWait ( worker, NULL ) );
+    KThreadRelease ( worker );
+    REQUIRE_RC ( h . rc );
+    REQUIRE_RC ( KOrderedQueueRelease ( h . q ) );
+}
+
+TEST_CASE ( KOrderedQueue_QuitHeadWait )
+{
+    HeadTest h;
+    KThread * worker;
+    KOrderedItem * item;
+
+    h . atHead = false;
+    h . rc = 0;
+    REQUIRE_RC ( KOrderedQueueMake ( & h . q, 2, 2, WhackTestItem, NULL ) );
+    REQUIRE_RC ( KOrderedQueueSubmit ( h . q, & MakeItem ( 0 ) -> dad, true ) );
+    REQUIRE_RC ( KOrderedQueueSubmit ( h . q, & MakeItem ( 1 ) -> dad, true ) );
+    REQUIRE_RC ( KOrderedQueueSeal ( h . q ) );
+    REQUIRE_RC ( KThreadMake ( & worker, HeadWorker, & h ) );
+
+    /* the consumer gives up instead of asking for the second item */
+    Pause ( 200 );
+    REQUIRE ( ! h . atHead );
+    REQUIRE_RC ( KOrderedQueueQuit ( h . q ) );
+    REQUIRE_RC ( KThreadWait ( worker, NULL ) );
+    KThreadRelease ( worker );
+    REQUIRE ( h . atHead );
+    REQUIRE_EQ ( GetRCState ( h . rc ), rcCanceled );
+
+    /* both items are done, draining does not block */
+    while ( KOrderedQueueNext ( h . q, & item ) == 0 && item != NULL )
+        delete ( TestItem * ) item;
+    REQUIRE_RC ( KOrderedQueueRelease ( h . q ) );
+}
+
+//////////////////////////////////////////// Main
+extern "C"
+{
+
+#include <kapp/args.h>
+
+ver_t CC KAppVersion ( void )
+{
+    return 0x1000000;
+}
+
+rc_t CC UsageSummary ( const char * progname )
+{
+    return 0;
+}
+
+rc_t CC Usage ( const Args * args )
+{
+    return 0;
+}
+
+const char UsageDefaultName [] = "test-ordered-queue";
+
+rc_t CC KMain ( int argc, char * argv [] )
+{
+    return KOrderedQueueTestSuite ( argc, argv );
+}
+
+}
@@ -0,0 +1,336 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/**
+* Unit tests for the answer caches of VResolver
+*
+*  the name service is stood in for by a local file named by a
+*  file:// url, which answers every query with its current contents
+*/
+
+#include <ktst/unit_test.hpp>
+
+#include <vfs/manager.h>
+#include <vfs/resolver.h>
+#include <vfs/path.h>
+#include <kfg/config.h>
+#include <kfs/directory.h>
+#include <kfs/file.h>
+#include <klib/rc.h>
+
+#include <stdexcept>
+#include <string>
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+TEST_SUITE(VResolverCacheTestSuite);
+
+class ResolverFixture
+{
+public:
+    ResolverFixture ()
+        : wd ( 0 ), vfs ( 0 ), cfg ( 0 ), resolver ( 0 )
+    {
+        if ( KDirectoryNativeDir ( & wd ) != 0 )
+            throw std::logic_error ( "ResolverFixture: KDirectoryNativeDir failed" );
+        if ( VFSManagerMake ( & vfs ) != 0 )
+            throw std::logic_error ( "ResolverFixture: VFSManagerMake failed" );
+        if ( KConfigMake ( & cfg, NULL ) != 0 )
+            throw std::logic_error ( "ResolverFixture: KConfigMake failed" );
+
+        char rel [ 64 ];
+        sprintf ( rel, "test-resolver-cache.%u", ( unsigned ) getpid () );
+        if ( KDirectoryCreateDir ( wd, 0775, kcmInit | kcmParents, "%s/public/sra", rel ) != 0 )
+            throw std::logic_error ( "ResolverFixture: KDirectoryCreateDir failed" );
+        if ( KDirectoryResolvePath ( wd, true, root, sizeof root, "%s", rel ) != 0 )
+            throw std::logic_error ( "ResolverFixture: KDirectoryResolvePath failed" );
+
+        /* nothing but the stand-in name service and one user repository */
+        Set ( "/repository/remote/main/NCBI/disabled", "true" );
+        Set ( "/repository/remote/aux/NCBI/disabled", "true" );
+        Set ( "/repository/remote/main/CGI/resolver-cgi", "file://" + Path ( "names" ) );
+        Set ( "/repository/user/main/public/root", Path ( "public" ) );
+        Set ( "/repository/user/main/public/apps/sra/volumes/sraFlat", "sra" );
+        Set ( "/repository/user/main/public/cache-enabled", "true" );
+        Set ( "/vfs/resolver-cache/root", "" );
+    }
+    ~ResolverFixture ()
+    {
+        VResolverRelease ( resolver );
+        KConfigRelease ( cfg );
+        VFSManagerRelease ( vfs );
+        KDirectoryRemove ( wd, true, "%s", root );
+        KDirectoryRelease ( wd );
+    }
+
+    std::string Path ( const char * leaf ) const
+    {
+        return std::string ( root ) + "/" + leaf;
+    }
+
+    void Set ( const char * node, const std::string & value )
+    {
+        KConfigNode * n;
+        if ( KConfigOpenNodeUpdate ( cfg, & n, "%s", node ) != 0 )
+            throw std::logic_error ( std::string ( "ResolverFixture::Set: cannot open " ) + node );
+        rc_t rc = KConfigNodeWrite ( n, value . data (), value . size () );
+        KConfigNodeRelease ( n );
+        if ( rc != 0 )
+            throw std::logic_error ( std::string ( "ResolverFixture::Set: cannot write " ) + node );
+    }
+
+    /* a new resolver forgets everything but the disk cache */
+    void MakeResolver ()
+    {
+        VResolverRelease ( resolver );
+        resolver = 0;
+        if ( VFSManagerMakeResolver ( vfs, & resolver, cfg ) != 0 )
+            throw std::logic_error ( "ResolverFixture::MakeResolver: VFSManagerMakeResolver failed" );
+    }
+
+    void WriteFile ( const std::string & path, const std::string & text )
+    {
+        KFile * f;
+        size_t num_writ;
+        if ( KDirectoryCreateFile ( wd, & f, false, 0664, kcmInit, "%s", path . c_str () ) != 0 )
+            throw std::logic_error ( "ResolverFixture::WriteFile: KDirectoryCreateFile failed" );
+        rc_t rc = KFileWriteAll ( f, 0, text . data (), text . size (), & num_writ );
+        KFileRelease ( f );
+        if ( rc != 0 || num_writ != text . size () )
+            throw std::logic_error ( "ResolverFixture::WriteFile: KFileWriteAll failed" );
+    }
+
+    /* what the name service will say next, as a version 1.1 table */
+    void Answer ( const char * acc, unsigned code )
+    {
+        std::string url;
+        if ( code == 200 )
+            url = std::string ( "http://stand.in/sra/" ) + acc + ".sra";
+        char row [ 512 ];
+        sprintf ( row, "#1.1\n%s|%s||||||%s|%u|%s\n", acc, acc, url . c_str (), code,
+            code == 200 ? "ok" : "no data" );
+        WriteFile ( Path ( "names" ), row );
+    }
+
+    void Silence ()
+    {
+        KDirectoryRemove ( wd, false, "%s", Path ( "names" ) . c_str () );
+    }
+
+    /* returns the rc, with the url in "uri" */
+    rc_t Remote ( const char * acc, std::string & uri )
+    {
+        const VPath * query, * remote = 0;
+        if ( VFSManagerMakePath ( vfs, ( VPath** ) & query, "%s", acc ) != 0 )
+            throw std::logic_error ( "ResolverFixture::Remote: VFSManagerMakePath failed" );
+        rc_t rc = VResolverQuery ( resolver, eProtocolHttp, query, NULL, & remote, NULL );
+        VPathRelease ( query );
+        uri . clear ();
+        if ( rc == 0 )
+        {
+            char buffer [ 4096 ];
+            size_t num_read;
+            if ( VPathReadUri ( remote, buffer, sizeof buffer, & num_read ) != 0 )
+                throw std::logic_error ( "ResolverFixture::Remote: VPathReadUri failed" );
+            uri . assign ( buffer, num_read );
+            VPathRelease ( remote );
+        }
+        return rc;
+    }
+
+    /* returns the rc of a local or cache query */
+    rc_t Query ( const char * acc, bool cache )
+    {
+        const VPath * query, * path = 0;
+        if ( VFSManagerMakePath ( vfs, ( VPath** ) & query, "%s", acc ) != 0 )
+            throw std::logic_error ( "ResolverFixture::Query: VFSManagerMakePath failed" );
+        rc_t rc = VResolverQuery ( resolver, eProtocolHttp, query,
+            cache ? NULL : & path, NULL, cache ? & path : NULL );
+        VPathRelease ( query );
+        VPathRelease ( path );
+        return rc;
+    }
+
+    static bool NotFound ( rc_t rc )
+    {
+        return GetRCState ( rc ) == rcNotFound;
+    }
+
+    KDirectory * wd;
+    VFSManager * vfs;
+    KConfig * cfg;
+    VResolver * resolver;
+    char root [ 4096 ];
+};
+
+FIXTURE_TEST_CASE ( RemoteAnswerIsRemembered, ResolverFixture )
+{
+    std::string first, second;
+
+    MakeResolver ();
+    Answer ( "SRR000101", 200 );
+    REQUIRE_RC ( Remote ( "SRR000101", first ) );
+    REQUIRE_EQ ( first, std::string ( "http://stand.in/sra/SRR000101.sra" ) );
+
+    /* the service changed its mind, but is not asked again */
+    Answer ( "SRR000101", 404 );
+    REQUIRE_RC ( Remote ( "SRR000101", second ) );
+    REQUIRE_EQ ( first, second );
+}
+
+FIXTURE_TEST_CASE ( ConfirmedNotFoundIsRemembered, ResolverFixture )
+{
+    std::string uri;
+
+    MakeResolver ();
+    Answer ( "SRR000102", 404 );
+    rc_t rc = Remote ( "SRR000102", uri );
+    REQUIRE ( NotFound ( rc ) );
+
+    Answer ( "SRR000102", 200 );
+    rc = Remote ( "SRR000102", uri );
+    REQUIRE ( NotFound ( rc ) );
+}
+
+FIXTURE_TEST_CASE ( TransportErrorIsPassedThrough, ResolverFixture )
+{
+    std::string uri;
+
+    /* no service at all: the real error comes back and is not remembered */
+    MakeResolver ();
+    Silence ();
+    rc_t rc = Remote ( "SRR000103", uri );
+    REQUIRE_NE ( rc, ( rc_t ) 0 );
+    REQUIRE ( ! NotFound ( rc ) );
+
+    Answer ( "SRR000103", 200 );
+    REQUIRE_RC ( Remote ( "SRR000103", uri ) );
+}
+
+FIXTURE_TEST_CASE ( ServerErrorIsNotRemembered, ResolverFixture )
+{
+    std::string uri;
+
+    MakeResolver ();
+    Answer ( "SRR000104", 503 );
+    rc_t rc = Remote ( "SRR000104", uri );
+    REQUIRE_EQ ( GetRCState ( rc ), ( enum RCState ) rcNotAvailable );
+
+    Answer ( "SRR000104", 200 );
+    REQUIRE_RC ( Remote ( "SRR000104", uri ) );
+}
+
+FIXTURE_TEST_CASE ( MalformedAnswerIsNotRemembered, ResolverFixture )
+{
+    std::string uri;
+
+    MakeResolver ();
+    WriteFile ( Path ( "names" ), "#1.1\nSRR000105|truncated\n" );
+    rc_t rc = Remote ( "SRR000105", uri );
+    REQUIRE_NE ( rc, ( rc_t ) 0 );
+    REQUIRE ( ! NotFound ( rc ) );
+
+    Answer ( "SRR000105", 200 );
+    REQUIRE_RC ( Remote ( "SRR000105", uri ) );
+}
+
+FIXTURE_TEST_CASE ( DiskCacheOutlivesResolver, ResolverFixture )
+{
+    std::string first, second;
+
+    Set ( "/vfs/resolver-cache/root", Path ( "names-cache" ) );
+    MakeResolver ();
+    Answer ( "SRR000106", 200 );
+    REQUIRE_RC ( Remote ( "SRR000106", first ) );
+
+    /* a new resolver with the service gone still has the answer */
+    Silence ();
+    MakeResolver ();
+    REQUIRE_RC ( Remote ( "SRR000106", second ) );
+    REQUIRE_EQ ( first, second );
+
+    /* but never an error that was not an answer */
+    std::string uri;
+    rc_t rc = Remote ( "SRR000107", uri );
+    REQUIRE ( ! NotFound ( rc ) );
+    MakeResolver ();
+    Answer ( "SRR000107", 200 );
+    REQUIRE_RC ( Remote ( "SRR000107", uri ) );
+}
+
+FIXTURE_TEST_CASE ( LocalPathIsProbedAgain, ResolverFixture )
+{
+    MakeResolver ();
+    WriteFile ( Path ( "public/sra/SRR000108.sra" ), "" );
+    REQUIRE_RC ( Query ( "SRR000108", false ) );
+
+    KDirectoryRemove ( wd, false, "%s", Path ( "public/sra/SRR000108.sra" ) . c_str () );
+    REQUIRE_RC_FAIL ( Query ( "SRR000108", false ) );
+}
+
+FIXTURE_TEST_CASE ( LocalMissIsForgottenForCache, ResolverFixture )
+{
+    MakeResolver ();
+    REQUIRE_RC_FAIL ( Query ( "SRR000109", false ) );
+
+    /* asking for a cache path announces a download into it */
+    REQUIRE_RC ( Query ( "SRR000109", true ) );
+    WriteFile ( Path ( "public/sra/SRR000109.sra" ), "" );
+    REQUIRE_RC ( Query ( "SRR000109", false ) );
+}
+
+//////////////////////////////////////////// Main
+extern "C"
+{
+
+#include <kapp/args.h>
+
+ver_t CC KAppVersion ( void )
+{
+    return 0x1000000;
+}
+
+rc_t CC UsageSummary ( const char * progname )
+{
+    return 0;
+}
+
+rc_t CC Usage ( const Args * args )
+{
+    return 0;
+}
+
+const char UsageDefaultName [] = "test-resolver-cache";
+
+rc_t CC KMain ( int argc, char * argv [] )
+{
+    KConfigDisableUserSettings ();
+    return VResolverCacheTestSuite ( argc, argv );
+}
+
+}
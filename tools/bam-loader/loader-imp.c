@@ -35,6 +35,7 @@
 #include <klib/rc.h>
 #include <klib/sort.h>
 #include <klib/printf.h>
+#include <klib/seq-conv.h>
 
 #include <kfs/directory.h>
 #include <kfs/file.h>
@@ -592,13 +593,8 @@ static void ContextRelease(context_t *ctx)
 static
 void COPY_QUAL(uint8_t D[], uint8_t const S[], unsigned const L, bool const R) 
 {
-    if (R) {
-        unsigned i;
-        unsigned j;
-        
-        for (i = 0, j = L - 1; i != L; ++i, --j)
-            D[i] = S[j];
-    }
+    if (R)
+        SeqAddOffsetReverse(D, S, L, 0);
     else
         memcpy(D, S, L);
 }
@@ -640,13 +636,8 @@ void COPY_READ(INSDC_dna_text D[], INSDC_dna_text const S[], unsigned const L, b
          0 ,  0 ,  0 ,  0 ,  0 ,  0 ,  0 ,  0 , 
          0 ,  0 ,  0 ,  0 ,  0 ,  0 ,  0 ,  0
     };
-    if (R) {
-        unsigned i;
-        unsigned j;
-        
-        for (i = 0, j = L - 1; i != L; ++i, --j)
-            D[i] = compl[((uint8_t const *)S)[j]];
-    }
+    if (R)
+        SeqMapBytesReverse((uint8_t *)D, (uint8_t const *)S, L, (uint8_t const *)compl);
     else
         memcpy(D, S, L);
 }
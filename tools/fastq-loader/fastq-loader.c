@@ -48,7 +48,8 @@ extern rc_t run(char const argv0[],
                 unsigned countReads, 
                 const char* reads[],
                 uint8_t qualityOffset,
-                const int8_t defaultReadNumbers[]);
+                const int8_t defaultReadNumbers[],
+                uint32_t parseThreads);
 
 /* MARK: Arguments and Usage */
 static char const option_input[] = "input";
@@ -62,6 +63,7 @@ static char const option_platform[] = "platform";
 static char const option_quality[] = "quality";
 static char const option_read[] = "read";
 static char const option_max_err_pct[] = "max-err-pct";
+static char const option_threads[] = "threads";
 
 #define OPTION_INPUT option_input
 #define OPTION_OUTPUT option_output
@@ -74,6 +76,10 @@ static char const option_max_err_pct[] = "max-err-pct";
 #define OPTION_QUALITY option_quality
 #define OPTION_READ option_read
 #define OPTION_MAX_ERR_PCT option_max_err_pct
+#define OPTION_THREADS option_threads
+
+/* every parse thread keeps a few 4MB chunks in flight */
+#define MAX_PARSE_THREADS 64
 
 #define ALIAS_INPUT  "i"
 #define ALIAS_OUTPUT "o"
@@ -155,6 +161,13 @@ char const * use_max_err_pct[] =
     NULL
 };
 
+static
+char const * use_threads[] = 
+{
+    "Number of threads parsing each input file, 1 to 64, default is 1",
+    NULL
+};
+
 OptDef Options[] = 
 {
     /* order here is same as in param array below!!! */               /* max#,  needs param, required */
@@ -167,6 +180,7 @@ OptDef Options[] =
     { OPTION_PLATFORM,      ALIAS_PLATFORM,         NULL, use_platform,     1,  true,        false },
     { OPTION_QUALITY,       ALIAS_QUALITY,          NULL, use_quality,      1,  true,        true },
     { OPTION_MAX_ERR_PCT,   NULL,                   NULL, use_max_err_pct,  1,  true,        false },
+    { OPTION_THREADS,       NULL,                   NULL, use_threads,      1,  true,        false },
 /*    { OPTION_READ,          ALIAS_READ,             NULL, use_read,         0,  true,        false },*/
 };
 
@@ -182,6 +196,7 @@ const char* OptHelpParam[] =
     NULL,
     NULL,
     NULL,
+    "count",
 };
 
 rc_t UsageSummary (char const * progname)
@@ -291,6 +306,8 @@ rc_t CC KMain (int argc, char * argv[])
     char *dummy;
     const XMLLogger* xml_logger = NULL;
     uint8_t qualityOffset;
+    uint32_t parseThreads = 1;
+    unsigned long threads;
     
     memset(&G, 0, sizeof(G));
     
@@ -426,6 +443,25 @@ rc_t CC KMain (int argc, char * argv[])
             G.maxErrPct = strtoul(value, &dummy, 0);
         }
         
+        rc = ArgsOptionCount (args, OPTION_THREADS, &pcount);
+        if (rc)
+            break;
+        if (pcount == 1)
+        {
+            rc = ArgsOptionValue (args, OPTION_THREADS, 0, &value);
+            if (rc)
+                break;
+            threads = strtoul(value, &dummy, 0);
+            if (threads == 0 || threads > MAX_PARSE_THREADS || *dummy != '\0')
+            {
+                rc = RC(rcApp, rcArgv, rcAccessing, rcParam, rcExcessive);
+                (void)PLOGERR(klogErr, (klogErr, rc, "Invalid number of threads $(v), $(max) is the limit",
+                            "v=%s,max=%u", value, MAX_PARSE_THREADS));
+                break;
+            }
+            parseThreads = (uint32_t)threads;
+        }
+        
         rc = ArgsOptionCount (args, OPTION_PLATFORM, &pcount);
         if (rc)
             break;
@@ -519,7 +555,7 @@ rc_t CC KMain (int argc, char * argv[])
         else
             break;
         
-        rc = run(argv[0], &G, pcount, (char const **)files, qualityOffset, defaultReadNumbers);
+        rc = run(argv[0], &G, pcount, (char const **)files, qualityOffset, defaultReadNumbers, parseThreads);
         break;
     }
     free(name_buffer);
@@ -0,0 +1,529 @@
+/*===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ */
+
+typedef struct FastqParallelReaderFile FastqParallelReaderFile;
+
+#define READERFILE_IMPL FastqParallelReaderFile
+
+#include "fastq-reader.h"
+
+#include <loader/common-reader-priv.h>
+
+#include <sysalloc.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+
+#include <kapp/loader-file.h>
+#include <kfs/directory.h>
+#include <kproc/thread.h>
+#include <kproc/ordered-queue.h>
+#include <klib/log.h>
+#include <klib/rc.h>
+
+/*--------------------------------------------------------------------------
+ * FastqParallelReaderFile
+ *  a producer thread cuts the input into chunks of whole 4-line records,
+ *  worker threads parse the chunks into batches of records, and GetRecord
+ *  hands the batches out in input order, so the writer sees the same
+ *  sequence of records as from FastqReaderFileMake().
+ *  From the first record that does not look like a 4-line record on,
+ *  the rest of the input is parsed serially.
+ */
+
+#define CHUNK_SIZE ( 4 * 1024 * 1024 )
+
+typedef struct FastqChunk FastqChunk;
+struct FastqChunk
+{
+    KOrderedItem dad;       /* done once the records are ready */
+
+    char* data;
+    size_t size;
+    size_t firstLine;       /* lines preceding the chunk */
+
+    const Record** records;
+    uint32_t count;
+    uint32_t next;
+    rc_t rc;
+
+    bool fatal;             /* parsing stopped at a fatal error */
+    bool tail;              /* the rest of the input is parsed serially */
+};
+
+struct FastqParallelReaderFile
+{
+    ReaderFile dad;
+
+    const KLoaderFile* reader;  /* used by the producer until it pushes a tail chunk */
+    const ReaderFile* tail;
+    uint8_t phredOffset;
+    uint8_t phredMax;
+    int8_t defaultReadNumber;
+
+    KOrderedQueue* queue;       /* chunks to be parsed, handed out in input order */
+    KThread* producer;
+    KThread** workers;
+    uint32_t workerCount;
+
+    FastqChunk* current;
+    bool fatal;
+};
+
+static rc_t FastqParallelReaderFileWhack ( FastqParallelReaderFile* self );
+static rc_t FastqParallelReaderFileGetRecord ( const FastqParallelReaderFile *self, const Record** result );
+static float FastqParallelReaderFileGetProportionalPosition ( const FastqParallelReaderFile *self );
+static rc_t FastqParallelReaderFileGetReferenceInfo ( const FastqParallelReaderFile *self, const ReferenceInfo** result );
+
+static ReaderFile_vt_v1 FastqParallelReaderFile_vt = 
+{
+    1, 0, 
+    /* start minor version == 0 */
+    FastqParallelReaderFileWhack,
+    FastqParallelReaderFileGetRecord,
+    FastqParallelReaderFileGetProportionalPosition,
+    FastqParallelReaderFileGetReferenceInfo,
+    /* end minor version == 0 */
+};
+
+static void FastqChunkWhack ( FastqChunk* self )
+{
+    while ( self->next < self->count )
+        RecordRelease ( self->records [ self->next ++ ] );
+    free ( self->records );
+    free ( self->data );
+    free ( self );
+}
+
+static void CC FastqChunkWhackItem ( KOrderedItem* item, void* data )
+{
+    FastqChunkWhack ( ( FastqChunk* ) item );
+}
+
+/* Submit
+ *  the tail chunk needs no worker, the consumer parses it
+ */
+static rc_t FastqParallelSubmit ( FastqParallelReaderFile* self, FastqChunk* chunk )
+{
+    return KOrderedQueueSubmit ( self->queue, & chunk->dad, ! chunk->tail );
+}
+
+static FastqChunk* FastqChunkMake ( size_t firstLine, bool tail )
+{
+    FastqChunk* self = calloc ( 1, sizeof * self );
+    if ( self != NULL )
+    {
+        self->firstLine = firstLine;
+        self->tail = tail;
+        if ( ! tail )
+        {
+            self->data = malloc ( CHUNK_SIZE );
+            if ( self->data == NULL )
+            {
+                free ( self );
+                return NULL;
+            }
+        }
+    }
+    return self;
+}
+
+/* LineOk
+ *  a line the lexer reads the same way whatever surrounds it, so that the
+ *  grammar never resynchronizes across a record boundary placed after it
+ */
+static bool FastqParallelLineOk ( const char* line, size_t len, size_t kind )
+{
+    size_t i;
+
+    if ( len == 0 || memchr ( line, '\r', len ) != NULL )
+        return false;
+
+    switch ( kind )
+    {
+    case 0:
+        return line [ 0 ] == '@';
+    case 1:
+        for ( i = 0; i < len; ++ i )
+        {
+            switch ( line [ i ] )
+            {
+            case 'A': case 'C': case 'G': case 'T': case 'N':
+            case 'a': case 'c': case 'g': case 't': case 'n':
+            case '.':
+                break;
+            default:
+                return false;
+            }
+        }
+        return true;
+    case 2:
+        return line [ 0 ] == '+';
+    default:
+        for ( i = 0; i < len; ++ i )
+        {
+            if ( line [ i ] < '!' || line [ i ] > '~' )
+                return false;
+        }
+        return true;
+    }
+}
+
+/* Produce
+ *  cuts the input at record boundaries: every record has to be a '@' line,
+ *  a non-empty line of bases, a '+' line and a quality line of the same length
+ */
+static rc_t CC FastqParallelProduce ( const KThread* t, void* data )
+{
+    FastqParallelReaderFile* self = data;
+    FastqChunk* chunk = NULL;
+    size_t lines = 0;
+    size_t want = 0;
+    bool tail = false;
+    rc_t rc = 0;
+
+    while ( rc == 0 && ! KOrderedQueueQuitting ( self->queue ) )
+    {
+        const char* buf;
+        size_t length, i, end, line, endLine, bases = 0;
+        bool full = false;
+
+        rc = KLoaderFile_Read ( self->reader, 0, want, (const void**) & buf, & length );
+        if ( rc != 0 )
+        {
+            if ( GetRCState ( rc ) == rcInsufficient )
+            {   /* record does not fit into the loader buffer */
+                rc = 0;
+                tail = true;
+            }
+            else
+                LogErr ( klogErr, rc, "FastqParallelProduce failed" );
+            break;
+        }
+        if ( buf == NULL )
+            break;
+        if ( length < want )
+        {   /* incomplete record at the end of file */
+            tail = true;
+            break;
+        }
+
+        end = endLine = 0;
+        for ( i = 0, line = 0; i < length; )
+        {
+            const char* eol;
+            size_t len;
+            eol = memchr ( buf + i, '\n', length - i );
+            if ( eol == NULL )
+                break;
+            len = eol - buf - i;
+            if ( len > 0 && eol [ -1 ] == '\r' )
+                -- len;
+            /* anything unusual goes to the serial tail */
+            if ( ! FastqParallelLineOk ( buf + i, len, line % 4 ) ||
+                 ( line % 4 == 3 && len != bases ) )
+            {
+                tail = true;
+                break;
+            }
+            if ( line % 4 == 1 )
+                bases = len;
+            i = eol + 1 - buf;
+            if ( ++ line % 4 == 0 )
+            {
+                if ( chunk != NULL && chunk->size + i > CHUNK_SIZE )
+                {
+                    full = true;
+                    break;
+                }
+                end = i;
+                endLine = line;
+            }
+        }
+
+        if ( end != 0 )
+        {
+            if ( chunk == NULL )
+            {
+                chunk = FastqChunkMake ( lines, false );
+                if ( chunk == NULL )
+                {
+                    rc = RC ( RC_MODULE, rcFileFormat, rcAllocating, rcMemory, rcExhausted );
+                    break;
+                }
+            }
+            memmove ( chunk->data + chunk->size, buf, end );
+            chunk->size += end;
+            lines += endLine;
+
+            rc = KLoaderFile_Read ( self->reader, end, 0, (const void**) & buf, & length );
+            want = 0;
+        }
+        else if ( ! full && ! tail )
+        {   /* the record continues past the end of the buffer */
+            want = length + 1;
+        }
+
+        if ( rc == 0 && full )
+        {
+            rc = FastqParallelSubmit ( self, chunk );
+            chunk = NULL;
+        }
+        if ( tail )
+            break;
+    }
+
+    if ( chunk != NULL )
+    {
+        if ( rc == 0 && ! KOrderedQueueQuitting ( self->queue ) )
+            rc = FastqParallelSubmit ( self, chunk );
+        else
+            FastqChunkWhack ( chunk );
+    }
+    if ( rc == 0 && tail && ! KOrderedQueueQuitting ( self->queue ) )
+    {   /* the loader file is handed over to the consumer along with this chunk */
+        chunk = FastqChunkMake ( lines, true );
+        if ( chunk == NULL )
+            rc = RC ( RC_MODULE, rcFileFormat, rcAllocating, rcMemory, rcExhausted );
+        else
+            rc = FastqParallelSubmit ( self, chunk );
+    }
+
+    KOrderedQueueSeal ( self->queue );
+    return rc;
+}
+
+static void FastqChunkParse ( FastqParallelReaderFile* self, FastqChunk* chunk )
+{
+    const ReaderFile* reader = NULL;
+    uint32_t capacity = 0;
+    rc_t rc = FastqReaderFileMakeChunk ( & reader, self->dad.pathname, chunk->data, chunk->size, chunk->firstLine,
+                                         self->phredOffset, self->phredMax, self->defaultReadNumber );
+    while ( rc == 0 )
+    {
+        const Record* record = NULL;
+        rc = ReaderFileGetRecord ( reader, & record );
+        if ( rc != 0 || record == NULL )
+            break;
+
+        if ( chunk->count == capacity )
+        {
+            const Record** records;
+            capacity = capacity == 0 ? 4096 : capacity * 2;
+            records = realloc ( chunk->records, capacity * sizeof * records );
+            if ( records == NULL )
+            {
+                RecordRelease ( record );
+                rc = RC ( RC_MODULE, rcFileFormat, rcAllocating, rcMemory, rcExhausted );
+                break;
+            }
+            chunk->records = records;
+        }
+        chunk->records [ chunk->count ++ ] = record;
+    }
+
+    if ( chunk->count != 0 )
+    {   /* the reader stops after a fatal error, so does the consumer */
+        const Rejected* rej = NULL;
+        if ( RecordGetRejected ( chunk->records [ chunk->count - 1 ], & rej ) == 0 && rej != NULL )
+        {
+            const char* text;
+            uint64_t line, column;
+            bool fatal;
+            if ( RejectedGetError ( rej, & text, & line, & column, & fatal ) == 0 )
+                chunk->fatal = fatal;
+            RejectedRelease ( rej );
+        }
+    }
+
+    ReaderFileRelease ( reader );
+    chunk->rc = rc;
+
+    /* records keep their own copies */
+    free ( chunk->data );
+    chunk->data = NULL;
+}
+
+static rc_t CC FastqParallelParse ( const KThread* t, void* data )
+{
+    FastqParallelReaderFile* self = data;
+    KOrderedItem* item;
+
+    while ( KOrderedQueueWork ( self->queue, & item ) == 0 && item != NULL )
+    {
+        if ( ! KOrderedQueueQuitting ( self->queue ) )
+            FastqChunkParse ( self, ( FastqChunk* ) item );
+        KOrderedQueueDone ( self->queue, item );
+    }
+    return 0;
+}
+
+rc_t FastqParallelReaderFileGetRecord ( const FastqParallelReaderFile *cself, const Record** result )
+{
+    FastqParallelReaderFile* self = (FastqParallelReaderFile*) cself;
+    KOrderedItem* item;
+    rc_t rc;
+
+    *result = NULL;
+    while ( true )
+    {
+        FastqChunk* chunk = self->current;
+
+        if ( self->tail != NULL )
+            return ReaderFileGetRecord ( self->tail, result );
+
+        if ( chunk != NULL )
+        {
+            if ( chunk->next < chunk->count )
+            {
+                *result = chunk->records [ chunk->next ++ ];
+                return 0;
+            }
+            rc = chunk->rc;
+            self->fatal = chunk->fatal;
+            self->current = NULL;
+            FastqChunkWhack ( chunk );
+            if ( rc != 0 )
+                return rc;
+        }
+        if ( self->fatal )
+            return 0;
+
+        rc = KOrderedQueueNext ( self->queue, & item );
+        if ( rc != 0 || item == NULL )
+            return rc; /* end of input */
+        chunk = ( FastqChunk* ) item;
+
+        if ( chunk->tail )
+        {   /* the producer is done with the loader file */
+            rc = FastqReaderFileMakeTail ( & self->tail, self->dad.pathname, self->reader, chunk->firstLine,
+                                           self->phredOffset, self->phredMax, self->defaultReadNumber );
+            self->reader = NULL;
+            FastqChunkWhack ( chunk );
+            if ( rc != 0 )
+                return rc;
+        }
+        else
+            self->current = chunk;
+    }
+}
+
+rc_t FastqParallelReaderFileWhack ( FastqParallelReaderFile* self )
+{
+    uint32_t i;
+
+    /* the producer does not block once told to quit */
+    KOrderedQueueQuit ( self->queue );
+    if ( self->producer != NULL )
+    {
+        KThreadWait ( self->producer, NULL );
+        KThreadRelease ( self->producer );
+    }
+    else
+        KOrderedQueueSeal ( self->queue );
+
+    for ( i = 0; i < self->workerCount; ++ i )
+    {
+        KThreadWait ( self->workers [ i ], NULL );
+        KThreadRelease ( self->workers [ i ] );
+    }
+    free ( self->workers );
+
+    /* the queue whacks the chunks the consumer did not get to */
+    if ( self->current != NULL )
+        FastqChunkWhack ( self->current );
+    KOrderedQueueRelease ( self->queue );
+
+    if ( self->tail != NULL )
+        ReaderFileRelease ( self->tail );
+    if ( self->reader != NULL )
+        KLoaderFile_Release ( self->reader, true );
+
+    ReaderFileWhack ( & self->dad );
+
+    free ( self );
+    return 0;
+}
+
+float FastqParallelReaderFileGetProportionalPosition ( const FastqParallelReaderFile *self )
+{
+    return 0.0f;
+}
+
+rc_t FastqParallelReaderFileGetReferenceInfo ( const FastqParallelReaderFile *self, const ReferenceInfo** result )
+{
+    *result = NULL;
+    return 0;
+}
+
+rc_t CC FastqReaderFileMakeParallel( const ReaderFile **reader, const KDirectory* dir, const char* file, uint8_t phredOffset, uint8_t phredMax, int8_t defaultReadNumber, uint32_t threads)
+{
+    rc_t rc;
+    FastqParallelReaderFile* self;
+
+    if ( threads < 2 )
+        return FastqReaderFileMake ( reader, dir, file, phredOffset, phredMax, defaultReadNumber );
+
+    *reader = NULL;
+    self = calloc ( 1, sizeof * self );
+    if ( self == NULL )
+        return RC ( RC_MODULE, rcFileFormat, rcAllocating, rcMemory, rcExhausted );
+
+    rc = ReaderFileInit ( self );
+    self->dad.vt.v1 = & FastqParallelReaderFile_vt;
+    self->phredOffset = phredOffset;
+    self->phredMax = phredMax;
+    self->defaultReadNumber = defaultReadNumber;
+
+    self->dad.pathname = string_dup(file, strlen(file)+1);
+    if ( self->dad.pathname == NULL )
+        rc = RC ( RC_MODULE, rcFileFormat, rcAllocating, rcMemory, rcExhausted );
+    if ( rc == 0 )
+        rc = KLoaderFile_Make( & self->reader, dir, file, 0, true );
+    if ( rc == 0 )
+        rc = KOrderedQueueMake ( & self->queue, threads * 2, threads * 4, FastqChunkWhackItem, NULL );
+    if ( rc == 0 )
+    {
+        self->workers = calloc ( threads, sizeof * self->workers );
+        if ( self->workers == NULL )
+            rc = RC ( RC_MODULE, rcFileFormat, rcAllocating, rcMemory, rcExhausted );
+    }
+    while ( rc == 0 && self->workerCount < threads )
+    {
+        rc = KThreadMake ( & self->workers [ self->workerCount ], FastqParallelParse, self );
+        if ( rc == 0 )
+            ++ self->workerCount;
+    }
+    if ( rc == 0 )
+        rc = KThreadMake ( & self->producer, FastqParallelProduce, self );
+
+    if ( rc == 0 )
+        *reader = (const ReaderFile*) self;
+    else
+        ReaderFileRelease ( & self->dad );
+
+    return rc;
+}
@@ -496,6 +496,13 @@ struct FastqReaderFile
     size_t curPos;           /* current tokenization position relative to recordStart */
     bool lastEol;
     bool eolInserted;
+
+    const char* chunk;       /* in-memory input when there is no reader */
+    size_t chunkSize;
+    bool detach;             /* records keep their own copy of the tag line and quality */
+
+    bool plain;              /* records are still taken by the plain record scanner */
+    size_t lineOffset;       /* lines not seen by the lexer: preceding the chunk or taken by the plain record scanner */
 };
 
 rc_t FastqReaderFileWhack( FastqReaderFile* f )
@@ -513,10 +520,332 @@ rc_t FastqReaderFileWhack( FastqReaderFile* f )
     return 0;
 }
 
+/* Read
+ *  KLoaderFile_Read() over the loader file or the in-memory chunk
+ */
+static rc_t FastqReaderFileRead ( FastqReaderFile *self, size_t advance, size_t size, const char **buffer, size_t *length )
+{
+    if ( self->reader != NULL )
+        return KLoaderFile_Read ( self->reader, advance, size, (const void**) buffer, length );
+
+    if ( advance > self->chunkSize )
+        advance = self->chunkSize;
+    self->chunk += advance;
+    self->chunkSize -= advance;
+
+    *buffer = self->chunkSize == 0 ? NULL : self->chunk;
+    *length = ( size != 0 && size < self->chunkSize ) ? size : self->chunkSize;
+    return 0;
+}
+
+/*--------------------------------------------------------------------------
+ * plain record scanner
+ *  the vast majority of FASTQ files consist of 4-line records with
+ *  a simple tag line; those are split on line boundaries with memchr
+ *  and moved into the parse block directly, without going through
+ *  flex/bison. The first record the scanner does not recognize is left
+ *  to the grammar, which then parses the rest of the file.
+ */
+
+#define PlainIsDigit( ch ) ( ( ch ) >= '0' && ( ch ) <= '9' )
+#define PlainIsAlnum( ch ) ( PlainIsDigit ( ch ) || ( ( ch ) >= 'A' && ( ch ) <= 'Z' ) || ( ( ch ) >= 'a' && ( ch ) <= 'z' ) )
+
+/* PlainToken
+ *  returns the end of the alphanumeric token starting at "i",
+ *  "digits" tells whether the lexer would see it as fqNUMBER
+ */
+static size_t PlainToken ( const char *tag, size_t i, size_t len, bool *digits )
+{
+    * digits = true;
+    for ( ; i < len && PlainIsAlnum ( tag [ i ] ); ++ i )
+    {
+        if ( ! PlainIsDigit ( tag [ i ] ) )
+            * digits = false;
+    }
+    return i;
+}
+
+static uint8_t PlainReadNumber ( const FASTQParseBlock *pb, const char *text, size_t len, uint8_t readnumber )
+{   /* same as SetReadNumber() in the grammar */
+    if ( pb -> defaultReadNumber == -1 )
+        return readnumber;
+    if ( len == 1 && text [ 0 ] == '1' )
+        return 1;
+    if ( len == 1 && text [ 0 ] == '2' )
+        return 2;
+    return pb -> defaultReadNumber;
+}
+
+/* PlainTagLine
+ *  recognizes the tag line shapes accepted by the grammar:
+ *    name [ '#' group ] [ '/' number { '/' alnum } | WS casava1.8 ] { WS tail }
+ *  and reproduces its effect on the parse block.
+ *  "tag" excludes '@' and trailing white space.
+ */
+static bool PlainTagLine ( FASTQParseBlock *pb, const char *tag, size_t len )
+{
+    size_t i, j, nameLength;
+    size_t groupOffset = pb -> spotGroupOffset;
+    size_t groupLength = pb -> spotGroupLength;
+    uint8_t readnumber = 0;
+    bool lowQuality = false;
+    bool casava, digits;
+
+    if ( len == 0 || ! PlainIsAlnum ( tag [ 0 ] ) )
+        return false;
+
+    /* name */
+    for ( i = 1; i < len; ++ i )
+    {
+        char ch = tag [ i ];
+        if ( ! PlainIsAlnum ( ch ) && ch != '_' && ch != '-' && ch != '.' && ch != ':' )
+            break;
+    }
+    nameLength = i;
+
+    /* spot group */
+    if ( i < len && tag [ i ] == '#' )
+    {
+        j = PlainToken ( tag, i + 1, len, & digits );
+        if ( j == i + 1 )
+            return false;
+        if ( j - i - 1 != 1 || tag [ i + 1 ] != '0' )
+        {
+            groupOffset = i + 1;
+            groupLength = j - i - 1;
+        }
+        i = j;
+    }
+
+    /* read number */
+    casava = true;
+    if ( i < len && tag [ i ] == '/' )
+    {
+        j = PlainToken ( tag, i + 1, len, & digits );
+        if ( j == i + 1 || ! digits )
+            return false;
+        if ( pb -> defaultReadNumber == -1 )
+            nameLength = j; /* "/number" is a part of the spot name */
+        readnumber = PlainReadNumber ( pb, tag + i + 1, j - i - 1, readnumber );
+        i = j;
+
+        while ( i < len && tag [ i ] == '/' )
+        {
+            j = PlainToken ( tag, i + 1, len, & digits );
+            if ( j == i + 1 || digits )
+                return false;
+            i = j;
+        }
+        casava = false;
+    }
+
+    while ( i < len )
+    {
+        if ( tag [ i ] != ' ' && tag [ i ] != '\t' )
+            return false;
+        while ( i < len && ( tag [ i ] == ' ' || tag [ i ] == '\t' ) )
+            ++ i;
+
+        j = PlainToken ( tag, i, len, & digits );
+        if ( j == i )
+            return false;
+
+        if ( casava && digits )
+        {   /* NUMBER ':' ALNUM ':' NUMBER ':' [ index ] */
+            readnumber = PlainReadNumber ( pb, tag + i, j - i, readnumber );
+            if ( j == len || tag [ j ] != ':' )
+                return false;
+
+            i = j + 1;
+            j = PlainToken ( tag, i, len, & digits );
+            if ( j == i || digits || j == len || tag [ j ] != ':' )
+                return false;
+            lowQuality = j - i == 1 && tag [ i ] == 'Y';
+
+            i = j + 1;
+            j = PlainToken ( tag, i, len, & digits );
+            if ( j == i || ! digits || j == len || tag [ j ] != ':' )
+                return false;
+
+            i = j + 1;
+            j = PlainToken ( tag, i, len, & digits );
+            if ( j != i && ( j - i != 1 || tag [ i ] != '0' ) )
+            {
+                groupOffset = i;
+                groupLength = j - i;
+            }
+        }
+        else
+        {   /* ALNUM { NUMBER | ALNUM | '_' | '/' | '=' } */
+            if ( digits )
+                return false;
+            while ( j < len && ( PlainIsAlnum ( tag [ j ] ) || tag [ j ] == '_' || tag [ j ] == '/' || tag [ j ] == '=' ) )
+                ++ j;
+        }
+        i = j;
+        casava = false;
+    }
+
+    if ( KDataBufferResize ( & pb -> tagLine, len ) != 0 )
+        return false;
+    memmove ( pb -> tagLine . base, tag, len );
+    pb -> spotNameLength = nameLength;
+    pb -> spotNameDone = true;
+    pb -> spotGroupOffset = groupOffset;
+    pb -> spotGroupLength = groupLength;
+    pb -> record -> seq . readnumber = readnumber;
+    pb -> record -> seq . lowQuality = lowQuality;
+
+    return true;
+}
+
+static bool PlainBases ( const char *bases, size_t len )
+{
+    size_t i;
+    for ( i = 0; i < len; ++ i )
+    {
+        switch ( bases [ i ] )
+        {
+        case 'A': case 'C': case 'G': case 'T': case 'N':
+        case 'a': case 'c': case 'g': case 't': case 'n':
+            break;
+        default:
+            return false;
+        }
+    }
+    return len != 0;
+}
+
+static bool PlainQuality ( const FASTQParseBlock *pb, const char *qual, size_t len )
+{   /* the range checked by AddQuality() in the grammar, within printable ASCII */
+    uint8_t floor = '!';
+    uint8_t ceiling = '~';
+    size_t i;
+
+    if ( pb -> phredOffset != 0 )
+    {
+        uint8_t maxPhred = pb -> maxPhred == 0 ? ( pb -> phredOffset == 33 ? MAX_PHRED_33 : MAX_PHRED_64 ) : pb -> maxPhred;
+        floor = pb -> phredOffset == 33 ? MIN_PHRED_33 : MIN_PHRED_64;
+        if ( maxPhred < ceiling )
+            ceiling = maxPhred;
+    }
+
+    for ( i = 0; i < len; ++ i )
+    {
+        uint8_t q = ( uint8_t ) qual [ i ];
+        if ( q < floor || q > ceiling )
+            return false;
+    }
+    return true;
+}
+
+/* PlainRecord
+ *  parses one record from "buf", returns its length or 0 if not recognized;
+ *  "cut" is set when the record may continue past the end of "buf"
+ */
+static size_t PlainRecord ( FASTQParseBlock *pb, const char *buf, size_t size, bool *cut )
+{
+    const char *end = buf + size;
+    const char *tag, *tagEnd, *bases, *basesEnd, *plus, *plusEnd, *qual, *qualEnd;
+    char *read;
+
+    * cut = false;
+    if ( size == 0 || buf [ 0 ] != '@' )
+        return 0;
+
+    * cut = true;
+
+    tag = buf + 1;
+    tagEnd = memchr ( tag, '\n', end - tag );
+    if ( tagEnd == NULL )
+        return 0;
+    bases = tagEnd + 1;
+    basesEnd = memchr ( bases, '\n', end - bases );
+    if ( basesEnd == NULL )
+        return 0;
+    plus = basesEnd + 1;
+    plusEnd = memchr ( plus, '\n', end - plus );
+    if ( plusEnd == NULL )
+        return 0;
+    qual = plusEnd + 1;
+    qualEnd = memchr ( qual, '\n', end - qual );
+    if ( qualEnd == NULL )
+        return 0;
+
+    * cut = false;
+    if ( plus [ 0 ] != '+' || memchr ( plus, '\r', plusEnd - plus ) != NULL || qualEnd - qual != basesEnd - bases )
+        return 0;
+
+    if ( ! PlainBases ( bases, basesEnd - bases ) || ! PlainQuality ( pb, qual, qualEnd - qual ) )
+        return 0;
+
+    while ( tagEnd > tag && ( tagEnd [ -1 ] == ' ' || tagEnd [ -1 ] == '\t' ) )
+        -- tagEnd;
+
+    read = malloc ( basesEnd - bases + 1 );
+    if ( read == NULL )
+        return 0;
+    if ( KDataBufferResize ( & pb -> quality, qualEnd - qual ) != 0 || ! PlainTagLine ( pb, tag, tagEnd - tag ) )
+    {
+        KDataBufferResize ( & pb -> quality, 0 );
+        free ( read );
+        return 0;
+    }
+    memmove ( read, bases, basesEnd - bases );
+    read [ basesEnd - bases ] = 0;
+    pb -> record -> seq . read = read;
+    memmove ( pb -> quality . base, qual, qualEnd - qual );
+
+    return qualEnd + 1 - buf;
+}
+
+/* returns 1 if a record was parsed, 0 at the end of input, -1 to switch to the grammar */
+static int FastqReaderFileGetPlainRecord ( FastqReaderFile *self )
+{
+    const char *buf;
+    size_t length, want = 0;
+
+    while ( true )
+    {
+        size_t recLength;
+        bool cut;
+        rc_t rc = FastqReaderFileRead ( self, 0, want, & buf, & length );
+        if ( rc != 0 )
+        {
+            if ( GetRCState ( rc ) == rcInsufficient )
+                return -1; /* record does not fit into the loader buffer */
+            LogErr ( klogErr, rc, "FastqReaderFileGetRecord failed" );
+            return 0;
+        }
+        if ( buf == NULL )
+            return 0;
+        if ( length < want )
+            return -1; /* incomplete record at the end of file */
+
+        recLength = PlainRecord ( & self -> pb, buf, length, & cut );
+        if ( recLength != 0 )
+        {
+            rc = FastqReaderFileRead ( self, recLength, 0, & self -> recordStart, & length );
+            if ( rc != 0 )
+                LogErr ( klogErr, rc, "FastqReaderFileGetRecord failed" );
+            self -> lineOffset += 4;
+            return 1;
+        }
+
+        if ( ! cut )
+            return -1;
+
+        /* the record may have been cut off by the end of the buffer */
+        want = length + 1;
+    }
+}
+
 rc_t FastqReaderFileGetRecord ( const FastqReaderFile *f, const Record** result )
 {
     rc_t rc;
     FastqReaderFile* self = (FastqReaderFile*) f;
+    const char* tagLine;
+    const char* quality;
     
     if (self->pb.fatalError)
         return 0;
@@ -535,41 +864,75 @@ rc_t FastqReaderFileGetRecord ( const FastqReaderFile *f, const Record** result
     KDataBufferResize( & self->pb.tagLine, 0 );
     KDataBufferResize( & self->pb.quality, 0 );
     self->pb.spotNameDone = false;
+    self->pb.spotGroupOffset = 0;
+    self->pb.spotGroupLength = 0;
 
-    if ( FASTQ_parse( & self->pb ) == 0 && self->pb.record->rej == 0 )
-    {   /* normal end of input */
-        RecordRelease((const Record*)self->pb.record);
-        *result = 0;
-        return 0;
+    if ( self->plain )
+    {
+        switch ( FastqReaderFileGetPlainRecord ( self ) )
+        {
+        case 0: /* end of input */
+            RecordRelease((const Record*)self->pb.record);
+            *result = 0;
+            return 0;
+        case -1: /* the grammar takes over from this record on */
+            self->plain = false;
+            break;
+        }
     }
 
-    /*TODO: remove? compensate for an artificially inserted trailing \n */
-    if ( self->eolInserted )
+    if ( ! self->plain )
     {
-        -- self->pb.length;
-        self->eolInserted = false;
-    }
+        if ( FASTQ_parse( & self->pb ) == 0 && self->pb.record->rej == 0 )
+        {   /* normal end of input */
+            RecordRelease((const Record*)self->pb.record);
+            *result = 0;
+            return 0;
+        }
 
-    if (self->pb.record->rej != 0) /* had error(s) */
-    {   /* save the complete raw source in the Rejected object */
-        StringInit(& self->pb.record->rej->source, string_dup(self->recordStart, self->pb.length), self->pb.length, self->pb.length);
-        self->pb.record->rej->fatal = self->pb.fatalError;
-    }
+        /*TODO: remove? compensate for an artificially inserted trailing \n */
+        if ( self->eolInserted )
+        {
+            -- self->pb.length;
+            self->eolInserted = false;
+        }
+
+        if (self->pb.record->rej != 0) /* had error(s) */
+        {   /* save the complete raw source in the Rejected object */
+            StringInit(& self->pb.record->rej->source, string_dup(self->recordStart, self->pb.length), self->pb.length, self->pb.length);
+            self->pb.record->rej->fatal = self->pb.fatalError;
+        }
+
+        if (rc == 0)
+        {   
+            /* advance the record start pointer beyond the last token */ 
+            size_t length;
+            rc = FastqReaderFileRead( self, self->pb.length, 0, & self->recordStart, & length);
+            if (rc != 0)
+                LogErr(klogErr, rc, "FastqReaderFileGetRecord failed");
 
-    if (rc == 0 && self->reader != 0)
-    {   
-        /* advance the record start pointer beyond the last token */ 
-        size_t length;
-        rc = KLoaderFile_Read( self->reader, self->pb.length, 0, (const void**)& self->recordStart, & length);
-        if (rc != 0)
-            LogErr(klogErr, rc, "FastqReaderFileGetRecord failed");
+            self->curPos -= self->pb.length;
+        }
+    }
 
-        self->curPos -= self->pb.length;
+    tagLine = (const char*)self->pb.tagLine.base;
+    quality = (const char*)self->pb.quality.base;
+    if (rc == 0 && self->detach)
+    {   /* the parse block is reused by the next record */
+        rc = KDataBufferResize( & self->pb.record->source, self->pb.tagLine.elem_count + self->pb.quality.elem_count );
+        if (rc == 0)
+        {
+            char* copy = (char*)self->pb.record->source.base;
+            memmove(copy, tagLine, self->pb.tagLine.elem_count);
+            memmove(copy + self->pb.tagLine.elem_count, quality, self->pb.quality.elem_count);
+            tagLine = copy;
+            quality = copy + self->pb.tagLine.elem_count;
+        }
     }
 
-    StringInit( & self->pb.record->seq.spotname,    (const char*)self->pb.tagLine.base, self->pb.spotNameLength, self->pb.spotNameLength);
-    StringInit( & self->pb.record->seq.spotgroup,   (const char*)self->pb.tagLine.base + self->pb.spotGroupOffset, self->pb.spotGroupLength, self->pb.spotGroupLength);
-    StringInit( & self->pb.record->seq.quality,     (const char*)self->pb.quality.base, self->pb.quality.elem_count, self->pb.quality.elem_count); 
+    StringInit( & self->pb.record->seq.spotname,    tagLine, self->pb.spotNameLength, self->pb.spotNameLength);
+    StringInit( & self->pb.record->seq.spotgroup,   tagLine + self->pb.spotGroupOffset, self->pb.spotGroupLength, self->pb.spotGroupLength);
+    StringInit( & self->pb.record->seq.quality,     quality, self->pb.quality.elem_count, self->pb.quality.elem_count); 
     self->pb.record->seq.qualityOffset = self->pb.phredOffset;
     
     if (self->pb.record->seq.readnumber == 0)
@@ -588,7 +951,8 @@ void CC FASTQ_error(struct FASTQParseBlock* sb, const char* msg)
         RejectedInit(sb->record->rej);
 
         sb->record->rej->message    = string_dup(msg, strlen(msg));
-        sb->record->rej->line       = sb->lastToken->line_no;
+        /* the lexer only counts lines since the plain record scanner stopped */
+        sb->record->rej->line       = sb->lastToken->line_no + ((FastqReaderFile*)sb->self)->lineOffset;
         sb->record->rej->column     = sb->lastToken->column_no;
     }
     /* subsequent errors in this record will be ignored */
@@ -599,7 +963,7 @@ size_t CC FASTQ_input(FASTQParseBlock* pb, char* buf, size_t max_size)
     FastqReaderFile* self = (FastqReaderFile*)pb->self;
     size_t length;
 
-    rc_t rc = KLoaderFile_Read( self->reader, 0, self->curPos + max_size, (const void**)& self->recordStart, & length);
+    rc_t rc = FastqReaderFileRead( self, 0, self->curPos + max_size, & self->recordStart, & length);
 
     if ( rc != 0 )
     {
@@ -629,29 +993,32 @@ size_t CC FASTQ_input(FASTQParseBlock* pb, char* buf, size_t max_size)
     return length;
 }
 
-rc_t CC FastqReaderFileMake( const ReaderFile **reader, const KDirectory* dir, const char* file, uint8_t phredOffset, uint8_t phredMax, int8_t defaultReadNumber)
+/* MakeSource
+ *  "reader" is the loader file to parse, NULL for an in-memory chunk;
+ *  it is released on failure
+ */
+static rc_t FastqReaderFileMakeSource( FastqReaderFile **result, const char* file, const KLoaderFile* reader, uint8_t phredOffset, uint8_t phredMax, int8_t defaultReadNumber)
 {
     rc_t rc;
     FastqReaderFile* self = (FastqReaderFile*) malloc ( sizeof * self );
     if ( self == NULL )
     {
-         rc = RC ( RC_MODULE, rcFileFormat, rcAllocating, rcMemory, rcExhausted );
+        rc = RC ( RC_MODULE, rcFileFormat, rcAllocating, rcMemory, rcExhausted );
+        if (reader)
+            KLoaderFile_Release( reader, true );
     }
     else
     {
         memset(self, 0, sizeof(*self));
         rc = ReaderFileInit ( self );
         self->dad.vt.v1 = & FastqReaderFile_vt;
+        self->reader = reader;
 
         self->dad.pathname = string_dup(file, strlen(file)+1);
         if ( self->dad.pathname == NULL )
         {
             rc = RC ( RC_MODULE, rcFileFormat, rcAllocating, rcMemory, rcExhausted );
         }
-        else
-        {
-            rc = KLoaderFile_Make( & self->reader, dir, file, 0, true );
-        }
         if (rc == 0)
         {
             self->pb.self = self;
@@ -671,26 +1038,59 @@ rc_t CC FastqReaderFileMake( const ReaderFile **reader, const KDirectory* dir, c
                         if a value below MIN_PHRED_64 seen, abort 
             */
             self->pb.defaultReadNumber = defaultReadNumber;
+            self->plain = true;
             
             rc = FASTQScan_yylex_init(& self->pb, true); 
             if (rc == 0)
             {
-                *reader = (const ReaderFile *) self;
+                *result = self;
+                return 0;
             } 
-            else
-            {
-                KLoaderFile_Release( self->reader, true );
-                ReaderFileRelease( & self->dad );
-                *reader = 0;
-            }
-        }
-        else
-        {
-            ReaderFileRelease( & self->dad );
-            *reader = 0;
         }
+        /* Whack() releases the reader */
+        ReaderFileRelease( & self->dad );
+    }
+    *result = 0;
+    return rc;
+}
+
+rc_t CC FastqReaderFileMake( const ReaderFile **reader, const KDirectory* dir, const char* file, uint8_t phredOffset, uint8_t phredMax, int8_t defaultReadNumber)
+{
+    const KLoaderFile* loader;
+    rc_t rc = KLoaderFile_Make( & loader, dir, file, 0, true );
+    if ( rc == 0 )
+    {
+        rc = FastqReaderFileMakeSource( (FastqReaderFile**) reader, file, loader, phredOffset, phredMax, defaultReadNumber );
     }
- 
+    else
+    {
+        *reader = 0;
+    }
+    return rc;
+}
+
+rc_t CC FastqReaderFileMakeChunk( const ReaderFile **reader, const char* file, const char* chunk, size_t size, size_t firstLine, uint8_t phredOffset, uint8_t phredMax, int8_t defaultReadNumber)
+{
+    FastqReaderFile* self;
+    rc_t rc = FastqReaderFileMakeSource( & self, file, NULL, phredOffset, phredMax, defaultReadNumber );
+    if ( rc == 0 )
+    {
+        self->chunk = chunk;
+        self->chunkSize = size;
+        self->detach = true;
+        self->lineOffset = firstLine;
+    }
+    *reader = (const ReaderFile *) self;
+    return rc;
+}
+
+rc_t CC FastqReaderFileMakeTail( const ReaderFile **reader, const char* file, const struct KLoaderFile* loader, size_t firstLine, uint8_t phredOffset, uint8_t phredMax, int8_t defaultReadNumber)
+{
+    FastqReaderFile* self;
+    rc_t rc = FastqReaderFileMakeSource( & self, file, loader, phredOffset, phredMax, defaultReadNumber );
+    if ( rc == 0 )
+        self->lineOffset = firstLine;
+    *reader = (const ReaderFile *) self;
     return rc;
 }
 
@@ -39,10 +39,29 @@ extern "C" {
  * forwards
  */
 struct KDirectory;
+struct KLoaderFile;
 struct ReaderFile;
 
 rc_t CC FastqReaderFileMake( const struct ReaderFile **self, const struct KDirectory* dir, const char* file, uint8_t phredOffset, uint8_t phredMax, int8_t defaultReadNumber);
 
+/* MakeParallel
+ *  same records in the same order as FastqReaderFileMake(),
+ *  parsed on "threads" worker threads
+ */
+rc_t CC FastqReaderFileMakeParallel( const struct ReaderFile **self, const struct KDirectory* dir, const char* file, uint8_t phredOffset, uint8_t phredMax, int8_t defaultReadNumber, uint32_t threads);
+
+/* MakeChunk
+ *  parses "size" bytes at "chunk", which follow "firstLine" lines of "file";
+ *  records own their data and outlive the reader
+ */
+rc_t CC FastqReaderFileMakeChunk( const struct ReaderFile **self, const char* file, const char* chunk, size_t size, size_t firstLine, uint8_t phredOffset, uint8_t phredMax, int8_t defaultReadNumber);
+
+/* MakeTail
+ *  parses the rest of an open "loader" file, which has consumed "firstLine" lines;
+ *  takes ownership of "loader"
+ */
+rc_t CC FastqReaderFileMakeTail( const struct ReaderFile **self, const char* file, const struct KLoaderFile* loader, size_t firstLine, uint8_t phredOffset, uint8_t phredMax, int8_t defaultReadNumber);
+
 #ifdef __cplusplus
 }
 #endif
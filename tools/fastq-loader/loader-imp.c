@@ -59,7 +59,8 @@ rc_t AcrhiveFASTQ(CommonWriterSettings* G,
                 unsigned seqFiles, 
                 char const *seqFile[], 
                 uint8_t qualityOffset, 
-                const int8_t defaultReadNumbers[])
+                const int8_t defaultReadNumbers[],
+                uint32_t parseThreads)
 {
     rc_t rc = 0;
     unsigned i;
@@ -80,9 +81,9 @@ rc_t AcrhiveFASTQ(CommonWriterSettings* G,
     for (i = 0; i < seqFiles; ++i) {
         const ReaderFile *reader;
         if (G->platform == SRA_PLATFORM_PACBIO_SMRT)  
-            rc = FastqReaderFileMake(&reader, dir, seqFile[i], 33, 33 + 93, -1); 
+            rc = FastqReaderFileMakeParallel(&reader, dir, seqFile[i], 33, 33 + 93, -1, parseThreads); 
         else
-            rc = FastqReaderFileMake(&reader, dir, seqFile[i], qualityOffset, 0, defaultReadNumbers[i]);
+            rc = FastqReaderFileMakeParallel(&reader, dir, seqFile[i], qualityOffset, 0, defaultReadNumbers[i], parseThreads);
         
         if (rc == 0) 
         {
@@ -165,7 +166,7 @@ rc_t ConvertDatabaseToUnmapped(VDatabase* db)
     return rc;
 }
 
-rc_t run(char const progName[], CommonWriterSettings* G, unsigned seqFiles, const char *seqFile[], uint8_t qualityOffset, const int8_t defaultReadNumbers[])
+rc_t run(char const progName[], CommonWriterSettings* G, unsigned seqFiles, const char *seqFile[], uint8_t qualityOffset, const int8_t defaultReadNumbers[], uint32_t parseThreads)
 {
     VDBManager *mgr;
     rc_t rc;
@@ -199,7 +200,7 @@ rc_t run(char const progName[], CommonWriterSettings* G, unsigned seqFiles, cons
                 if (rc == 0)
                     rc = rc2;
                 if (rc == 0) {
-                    rc = AcrhiveFASTQ(G, mgr, db, seqFiles, seqFile, qualityOffset, defaultReadNumbers);
+                    rc = AcrhiveFASTQ(G, mgr, db, seqFiles, seqFile, qualityOffset, defaultReadNumbers, parseThreads);
                 }
 
                 if (rc == 0) {
@@ -37,6 +37,10 @@
 #include <kfs/tar.h>
 #include <kfs/toc.h>
 #include <kfs/sra.h>
+#include <kfs/kfs-priv.h>
+#include <kproc/thread.h>
+#include <kproc/lock.h>
+#include <kproc/cond.h>
 #include <klib/log.h>
 #include <klib/out.h>
 #include <klib/status.h>
@@ -69,6 +73,7 @@ KDirectory * kdir;
 #define OPTION_LONGLIST  "long-list"
 #define OPTION_DIRECTORY "directory"
 #define OPTION_ALIGN     "align"
+#define OPTION_THREADS   "threads"
 
 #define ALIAS_CREATE    "c"
 #define ALIAS_TEST      "t"
@@ -78,6 +83,10 @@ KDirectory * kdir;
 #define ALIAS_LONGLIST  "l"
 #define ALIAS_DIRECTORY "d"
 #define ALIAS_ALIGN     "a"
+#define ALIAS_THREADS   "j"
+
+/* every extract thread holds a copy buffer of its own */
+#define MAX_THREADS 64
 
 static const char * create_usage[] = { "Create a new archive.", NULL };
 static const char * extract_usage[] = { "Extract the contents of an archive into a directory.", NULL };
@@ -105,6 +114,10 @@ static const char * align_usage[] =
 static const char * longlist_usage[] =
 { "more information will be given on each file",
   "in test/list mode.", NULL };
+static const char * threads_usage[] =
+{ "number of files to extract in parallel",
+  "in extract mode, 1 to 64.",
+  "(default=1)", NULL };
 
 OptDef Options[] = 
 {
@@ -115,7 +128,8 @@ OptDef Options[] =
     { OPTION_FORCE,     ALIAS_FORCE,     NULL, force_usage, 0, false, false },
     { OPTION_LONGLIST,  ALIAS_LONGLIST,  NULL, longlist_usage, 0, false, false },
     { OPTION_DIRECTORY, ALIAS_DIRECTORY, NULL, directory_usage, 1, true,  false },
-    { OPTION_ALIGN,     ALIAS_ALIGN,     NULL, align_usage, 1, true,  false }
+    { OPTION_ALIGN,     ALIAS_ALIGN,     NULL, align_usage, 1, true,  false },
+    { OPTION_THREADS,   ALIAS_THREADS,   NULL, threads_usage, 1, true,  false }
 };
 
 const char UsageDefaultName[] = "kar";
@@ -181,6 +195,7 @@ rc_t CC Usage (const Args * args)
     HelpOptionLine (ALIAS_FORCE, OPTION_FORCE, NULL, force_usage);
     HelpOptionLine (ALIAS_ALIGN, OPTION_ALIGN, "alignment", align_usage);
     HelpOptionLine (ALIAS_LONGLIST, OPTION_LONGLIST, NULL, longlist_usage);
+    HelpOptionLine (ALIAS_THREADS, OPTION_THREADS, "count", threads_usage);
 
     HelpOptionsStandard ();
 
@@ -232,6 +247,9 @@ bool force;
 static
 KSRAFileAlignment alignment;
 
+static
+uint32_t num_threads;
+
 
 static BSTree pnames;
 typedef struct pnamesNode
@@ -556,65 +574,270 @@ void remove_out_file (const char * path)
     KDirectoryRemove (kdir, true, path);
 }
 
+/* -----
+ * copy buffers are large and aligned to the page size
+ * so that the underlying file systems see big sequential requests
+ */
+#define COPY_BUFFER_SIZE  ( 4 * 1024 * 1024 )
+#define COPY_BUFFER_ALIGN ( 4 * 1024 )
+
 static
-rc_t copy_file (const KFile * fin, KFile *fout)
+void * copy_buffer_alloc (void ** mem, size_t size)
+{
+    size_t addr;
+
+    * mem = malloc (size + COPY_BUFFER_ALIGN);
+    if (* mem == NULL)
+        return NULL;
+
+    addr = ((size_t)* mem + COPY_BUFFER_ALIGN - 1) & ~ (size_t)(COPY_BUFFER_ALIGN - 1);
+    return (void *)addr;
+}
+
+static
+rc_t copy_file_write (KFile *fout, uint64_t pos, const uint8_t * buff, size_t num_read)
 {
     rc_t rc;
-    uint8_t	buff	[64 * 1024];
-    size_t	num_read;
-    uint64_t	inpos;
-    uint64_t	outpos;
+    size_t num_writ;
 
-    assert (fin != NULL);
-    assert (fout != NULL);
+    rc = KFileWriteAll (fout, pos, buff, num_read, &num_writ);
+    if (rc == 0 && num_writ != num_read)
+        rc = RC (rcExe, rcFile, rcWriting, rcTransfer, rcIncomplete);
+    if (rc != 0)
+    {
+        PLOGERR (klogErr, (klogErr, rc,
+                 "Failed to write to archive in creating archive at $(P)",
+                           PLOG_U64(P), pos));
+    }
+    return rc;
+}
+
+/* -----
+ * single threaded copy
+ * used when a reader thread can not be started
+ */
+static
+rc_t copy_file_serial (const KFile * fin, KFile *fout, uint64_t pos)
+{
+    rc_t rc;
+    void * mem;
+    uint8_t * buff;
+    size_t num_read;
 
-    inpos = 0;
-    outpos = 0;
+    buff = copy_buffer_alloc (&mem, COPY_BUFFER_SIZE);
+    if (buff == NULL)
+    {
+        rc = RC (rcExe, rcFile, rcCopying, rcMemory, rcExhausted);
+        LOGERR (klogErr, rc, "Failed to allocate copy buffer");
+        return rc;
+    }
 
     do
     {
-        rc = KFileRead (fin, inpos, buff, sizeof (buff), &num_read);
+        rc = KFileReadAll (fin, pos, buff, COPY_BUFFER_SIZE, &num_read);
         if (rc != 0)
         {
             PLOGERR (klogErr, (klogErr, rc,
                      "Failed to read from directory structure in creating archive at $(P)",
-                               PLOG_U64(P), inpos));
-            break;
+                               PLOG_U64(P), pos));
         }
         else if (num_read > 0)
         {
-            size_t to_write;
+            STSMSG (2, ("Read %zu bytes to %lu", num_read, pos + num_read));
+            rc = copy_file_write (fout, pos, buff, num_read);
+            pos += num_read;
+        }
+    } while (rc == 0 && num_read != 0);
 
-            inpos += (uint64_t)num_read;
+    free (mem);
+    return rc;
+}
+
+/* -----
+ * double buffered copy
+ * a reader thread fills one buffer while the caller writes out the other
+ */
+typedef struct copy_slot
+{
+    uint8_t * data;
+    uint64_t pos;
+    size_t num_read;
+    rc_t rc;
+    bool full;
+} copy_slot;
+
+typedef struct copy_pipe
+{
+    const KFile * fin;
+    KLock * lock;
+    KCondition * cond;
+    copy_slot slot [ 2 ];
+    uint64_t pos;
+    bool quit;
+} copy_pipe;
+
+static
+rc_t CC copy_file_reader (const KThread * self, void * data)
+{
+    copy_pipe * cpipe;
+    uint64_t pos;
+    uint32_t idx;
+
+    cpipe = data;
+    pos = cpipe -> pos;
+
+    for (idx = 0; ; idx ^= 1)
+    {
+        copy_slot * slot;
+        bool quit;
+        rc_t rc;
+
+        slot = & cpipe -> slot [ idx ];
+
+        KLockAcquire (cpipe -> lock);
+        while (slot -> full && ! cpipe -> quit)
+            KConditionWait (cpipe -> cond, cpipe -> lock);
+        quit = cpipe -> quit;
+        KLockUnlock (cpipe -> lock);
+
+        if (quit)
+            break;
+
+        rc = KFileReadAll (cpipe -> fin, pos, slot -> data, COPY_BUFFER_SIZE, & slot -> num_read);
+        slot -> pos = pos;
+        slot -> rc = rc;
+
+        KLockAcquire (cpipe -> lock);
+        slot -> full = true;
+        KConditionBroadcast (cpipe -> cond);
+        KLockUnlock (cpipe -> lock);
 
-            STSMSG (2, ("Read %zu bytes to %lu", num_read, inpos));
+        if (rc != 0 || slot -> num_read == 0)
+            break;
 
-/*             PLOGMSG (klogDebug10, "Read $(B) Bytes for $(T)", PLOG_2(PLOG_U64(B),PLOG_U64(T)), num_read, inpos); */
-            to_write = num_read;
-            while (to_write > 0)
+        pos += slot -> num_read;
+    }
+    return 0;
+}
+
+static
+rc_t copy_file_pipelined (const KFile * fin, KFile *fout, uint64_t pos)
+{
+    rc_t rc;
+    void * mem;
+    uint8_t * buff;
+    copy_pipe cpipe;
+    KThread * t;
+
+    buff = copy_buffer_alloc (&mem, 2 * COPY_BUFFER_SIZE);
+    if (buff == NULL)
+        return copy_file_serial (fin, fout, pos);
+
+    memset (&cpipe, 0, sizeof cpipe);
+    cpipe . fin = fin;
+    cpipe . pos = pos;
+    cpipe . slot [ 0 ] . data = buff;
+    cpipe . slot [ 1 ] . data = buff + COPY_BUFFER_SIZE;
+
+    rc = KLockMake (& cpipe . lock);
+    if (rc == 0)
+    {
+        rc = KConditionMake (& cpipe . cond);
+        if (rc == 0)
+        {
+            rc = KThreadMake (&t, copy_file_reader, &cpipe);
+            if (rc != 0)
+                rc = copy_file_serial (fin, fout, pos);
+            else
             {
-                size_t num_writ;
-                rc = KFileWrite (fout, outpos, buff, num_read, &num_writ);
-                if (rc != 0)
+                uint32_t idx;
+
+                for (idx = 0; ; idx ^= 1)
                 {
-                    PLOGERR (klogErr, (klogErr, rc,
-                             "Failed to write to archive in creating archive at $(P)",
-                                       PLOG_U64(P), outpos));
-                    break;
+                    copy_slot * slot = & cpipe . slot [ idx ];
+
+                    KLockAcquire (cpipe . lock);
+                    while (! slot -> full)
+                        KConditionWait (cpipe . cond, cpipe . lock);
+                    KLockUnlock (cpipe . lock);
+
+                    rc = slot -> rc;
+                    if (rc != 0)
+                    {
+                        PLOGERR (klogErr, (klogErr, rc,
+                                 "Failed to read from directory structure in creating archive at $(P)",
+                                           PLOG_U64(P), slot -> pos));
+                        break;
+                    }
+                    if (slot -> num_read == 0)
+                        break;
+
+                    STSMSG (2, ("Read %zu bytes to %lu", slot -> num_read, slot -> pos + slot -> num_read));
+
+                    rc = copy_file_write (fout, slot -> pos, slot -> data, slot -> num_read);
+                    if (rc != 0)
+                        break;
+
+                    KLockAcquire (cpipe . lock);
+                    slot -> full = false;
+                    KConditionBroadcast (cpipe . cond);
+                    KLockUnlock (cpipe . lock);
                 }
-                outpos += num_writ;
-/*                 PLOGMSG (klogDebug10, "Wrote $(B) Bytes for $(T)", PLOG_2(PLOG_U64(B),PLOG_U64(T)), num_writ, outpos); */
-                to_write -= num_writ;
+
+                /* release the reader if we are bailing out early */
+                KLockAcquire (cpipe . lock);
+                cpipe . quit = true;
+                KConditionBroadcast (cpipe . cond);
+                KLockUnlock (cpipe . lock);
+
+                KThreadWait (t, NULL);
+                KThreadRelease (t);
             }
+            KConditionRelease (cpipe . cond);
         }
-/*         else */
-/*             PLOGMSG (klogDebug10, "Read $(B) Bytes for $(T)", PLOG_2(PLOG_U64(B),PLOG_U64(T)), num_read, inpos); */
-        if (rc != 0)
-            break;
-    } while (num_read != 0);
+        KLockRelease (cpipe . lock);
+    }
+
+    free (mem);
     return rc;
 }
 
+static
+rc_t copy_file (const KFile * fin, KFile *fout)
+{
+    rc_t rc;
+    uint64_t size;
+    uint64_t num_copied;
+
+    assert (fin != NULL);
+    assert (fout != NULL);
+
+    /* -----
+     * when both ends are local files let the kernel move the bytes;
+     * whatever it did not copy is picked up by the buffered path
+     */
+    num_copied = 0;
+    rc = KFileSize (fin, &size);
+    if (rc == 0 && size != 0)
+    {
+        rc = KFileCopySysRange (fout, 0, fin, 0, size, &num_copied);
+        if (rc == 0)
+        {
+            STSMSG (2, ("Copied %lu bytes within the kernel", num_copied));
+            if (num_copied == size)
+                return 0;
+        }
+        else if (GetRCState (rc) != rcUnsupported)
+        {
+            PLOGERR (klogErr, (klogErr, rc,
+                     "Failed to copy file at $(P)", PLOG_U64(P), num_copied));
+            return rc;
+        }
+    }
+
+    return copy_file_pipelined (fin, fout, num_copied);
+}
+
 #if USE_SKEY_MD5_FIX
 static
 rc_t copy_file_skey_md5_kludge (const KFile * fin, KFile *fout)
@@ -1169,8 +1392,82 @@ typedef struct extract_adata
     KDirectory * dir;
     bool ( CC * filter)(const KDirectory *, const char *, void *);
     void * fdata;
+    /* -----
+     * when extracting in parallel files and directory permissions
+     * are queued here rather than being handled during the walk
+     */
+    Vector * files;
+    Vector * dirs;
 } extract_adata;
 
+typedef struct extract_item
+{
+    uint32_t access;
+    char path [ 1 ];
+} extract_item;
+
+static
+rc_t extract_item_append (Vector * v, const char * path, uint32_t access)
+{
+    rc_t rc;
+    size_t size;
+    extract_item * item;
+
+    size = string_size (path);
+    item = malloc (sizeof * item + size);
+    if (item == NULL)
+        return RC (rcExe, rcNode, rcAllocating, rcMemory, rcExhausted);
+
+    item -> access = access;
+    memcpy (item -> path, path, size + 1);
+
+    rc = VectorAppend (v, NULL, item);
+    if (rc != 0)
+        free (item);
+    return rc;
+}
+
+static
+void CC extract_item_whack (void * item, void * ignored)
+{
+    free (item);
+}
+
+static
+rc_t extract_file (const KDirectory * din, KDirectory * dout,
+                   const char * path, uint32_t access)
+{
+    rc_t rc;
+    const KFile * fin;
+    KFile * fout;
+
+    rc = KDirectoryVCreateFile (dout, &fout, false, access,
+                                kcmCreate|kcmParents,
+                                path, NULL);
+    if (rc == 0)
+    {
+        rc = KDirectoryVOpenFileRead (din, &fin, path, NULL);
+        if (rc == 0)
+        {
+#if USE_SKEY_MD5_FIX
+            /* KLUDGE!!!! */
+            size_t pathz, skey_md5z;
+            static const char skey_md5[] = "skey.md5";
+
+            pathz = string_size (path);
+            skey_md5z = string_size(skey_md5);
+            if ( pathz >= skey_md5z && strcmp ( & path [ pathz - skey_md5z ], skey_md5 ) == 0 )
+                rc = copy_file_skey_md5_kludge (fin, fout);
+            else
+#endif
+                rc = copy_file (fin, fout);
+            KFileRelease (fin);
+        }
+        KFileRelease (fout);
+    }
+    return rc;
+}
+
 static
 rc_t CC extract_action (const KDirectory * dir, const char * path, void * _adata)
 {
@@ -1217,32 +1514,10 @@ rc_t CC extract_action (const KDirectory * dir, const char * path, void * _adata
             rc = KDirectoryVAccess (dir, &access, path, NULL);
             if (rc == 0)
             {
-                const KFile * fin;
-                KFile * fout;
-                rc = KDirectoryVCreateFile (adata->dir, &fout, false, access,
-                                            kcmCreate|kcmParents,
-                                            path, NULL);
-                if (rc == 0)
-                {
-                    rc = KDirectoryVOpenFileRead (dir, &fin, path, NULL);
-                    if (rc == 0)
-                    {
-#if USE_SKEY_MD5_FIX
-                        /* KLUDGE!!!! */
-                        size_t pathz, skey_md5z;
-                        static const char skey_md5[] = "skey.md5";
-
-                        pathz = string_size (path);
-                        skey_md5z = string_size(skey_md5);
-                        if ( pathz >= skey_md5z && strcmp ( & path [ pathz - skey_md5z ], skey_md5 ) == 0 )
-                            rc = copy_file_skey_md5_kludge (fin, fout);
-                        else
-#endif
-                            rc = copy_file (fin, fout);
-                        KFileRelease (fin);
-                    }
-                    KFileRelease (fout);
-                }
+                if (adata->files != NULL)
+                    rc = extract_item_append (adata->files, path, access);
+                else
+                    rc = extract_file (dir, adata->dir, path, access);
             }
             break;
         case kptDir:
@@ -1257,7 +1532,13 @@ rc_t CC extract_action (const KDirectory * dir, const char * path, void * _adata
                     rc = step_through_dir (dir, path, adata->filter, adata->fdata,
                                            extract_action, adata);
                     if (rc == 0)
-                        rc = KDirectoryVSetAccess (adata->dir, false, access, 0777, path, NULL);
+                    {
+                        /* children are queued ahead of their parents */
+                        if (adata->dirs != NULL)
+                            rc = extract_item_append (adata->dirs, path, access);
+                        else
+                            rc = KDirectoryVSetAccess (adata->dir, false, access, 0777, path, NULL);
+                    }
                 }
 
 
@@ -1274,6 +1555,124 @@ rc_t CC extract_action (const KDirectory * dir, const char * path, void * _adata
 
     return rc;
 }
+/* -----
+ * parallel extraction
+ * worker threads take queued files in turn until the queue is drained
+ * or any one of them fails
+ */
+typedef struct extract_pool
+{
+    const KDirectory * din;
+    KDirectory * dout;
+    const Vector * files;
+    KLock * lock;
+    uint32_t next;
+    rc_t rc;
+} extract_pool;
+
+static
+rc_t CC extract_worker (const KThread * self, void * data)
+{
+    extract_pool * pool = data;
+
+    while (1)
+    {
+        rc_t rc;
+        uint32_t idx;
+        const extract_item * item;
+
+        KLockAcquire (pool -> lock);
+        idx = pool -> next ++;
+        rc = pool -> rc;
+        KLockUnlock (pool -> lock);
+
+        if (rc != 0 || idx >= VectorLength (pool -> files))
+            break;
+
+        item = VectorGet (pool -> files, idx);
+        STSMSG (1, ("extract_worker: %s\n", item -> path));
+
+        rc = extract_file (pool -> din, pool -> dout, item -> path, item -> access);
+        if (rc != 0)
+        {
+            PLOGERR (klogErr, (klogErr, rc, "failed to extract '$(P)'", PLOG_S(P), item -> path));
+            KLockAcquire (pool -> lock);
+            if (pool -> rc == 0)
+                pool -> rc = rc;
+            KLockUnlock (pool -> lock);
+            break;
+        }
+    }
+    return 0;
+}
+
+static
+rc_t extract_parallel (const KDirectory * din, KDirectory * dout,
+                       const Vector * files, const Vector * dirs)
+{
+    rc_t rc;
+    extract_pool pool;
+    KThread ** t;
+    uint32_t count, idx;
+
+    pool . din = din;
+    pool . dout = dout;
+    pool . files = files;
+    pool . next = 0;
+    pool . rc = 0;
+
+    count = num_threads;
+    if (count > VectorLength (files))
+        count = VectorLength (files);
+
+    /* the calling thread is one of the count workers */
+    if (count > 0)
+        -- count;
+
+    rc = KLockMake (& pool . lock);
+    if (rc == 0)
+    {
+        t = NULL;
+        if (count > 0)
+        {
+            t = calloc (count, sizeof * t);
+            if (t == NULL)
+                rc = RC (rcExe, rcThread, rcAllocating, rcMemory, rcExhausted);
+        }
+        if (rc == 0)
+        {
+            uint32_t started;
+
+            for (started = 0; started < count; ++ started)
+            {
+                if (KThreadMake (& t [ started ], extract_worker, & pool) != 0)
+                    break;
+            }
+
+            /* the calling thread takes part as well;
+               covers the case where no thread could be started */
+            extract_worker (NULL, & pool);
+
+            for (idx = 0; idx < started; ++ idx)
+            {
+                KThreadWait (t [ idx ], NULL);
+                KThreadRelease (t [ idx ]);
+            }
+            free (t);
+            rc = pool . rc;
+        }
+        KLockRelease (pool . lock);
+    }
+
+    /* directory permissions are applied last as they may deny writing */
+    for (idx = 0; rc == 0 && idx < VectorLength (dirs); ++ idx)
+    {
+        const extract_item * item = VectorGet (dirs, idx);
+        rc = KDirectoryVSetAccess (dout, false, item -> access, 0777, item -> path, NULL);
+    }
+    return rc;
+}
+
 static
 rc_t	run_kar_extract (const char * archive, const char * directory)
 {
@@ -1306,11 +1705,31 @@ rc_t	run_kar_extract (const char * archive, const char * directory)
             else
             {
                 extract_adata adata;
+                Vector files, dirs;
+
                 adata.dir = dout;
                 adata.filter = pnamesFilter;
                 adata.fdata = NULL;
-                
+                adata.files = NULL;
+                adata.dirs = NULL;
+
+                if (num_threads > 1)
+                {
+                    VectorInit (&files, 0, 1024);
+                    VectorInit (&dirs, 0, 64);
+                    adata.files = &files;
+                    adata.dirs = &dirs;
+                }
+
                 rc = step_through_dir (din, ".", pnamesFilter, NULL, extract_action, &adata);
+
+                if (num_threads > 1)
+                {
+                    if (rc == 0)
+                        rc = extract_parallel (din, dout, &files, &dirs);
+                    VectorWhack (&files, extract_item_whack, NULL);
+                    VectorWhack (&dirs, extract_item_whack, NULL);
+                }
                 KDirectoryRelease (dout);
             }
         }
@@ -1353,6 +1772,8 @@ rc_t CC KMain ( int argc, char *argv [] )
         {
             op_mode mode;
             uint32_t ix;
+            unsigned long threads;
+            char * end;
 
             BSTreeInit (&pnames);
 
@@ -1395,6 +1816,27 @@ rc_t CC KMain ( int argc, char *argv [] )
                 break;
             }
 
+            rc = ArgsOptionCount (args, OPTION_THREADS, &pcount);
+            if (rc)
+                break;
+            num_threads = 1;
+            if (pcount)
+            {
+                rc = ArgsOptionValue (args, OPTION_THREADS, 0, &pc);
+                if (rc)
+                    break;
+                threads = strtoul (pc, &end, 0);
+                if (threads == 0 || threads > MAX_THREADS || *end != '\0')
+                {
+                    rc = RC (rcExe, rcArgv, rcParsing, rcParam, rcInvalid);
+                    PLOGERR (klogFatal, (klogFatal, rc,
+                             "Parameter for threads [$(T)] is invalid: must be a number from 1 to $(M)",
+                                         "T=%s,M=%u", pc, MAX_THREADS));
+                    break;
+                }
+                num_threads = (uint32_t) threads;
+            }
+
             rc = ArgsOptionCount (args, OPTION_LONGLIST, &pcount);
             if (rc)
                 break;
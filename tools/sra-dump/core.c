@@ -656,6 +656,9 @@ static rc_t SRADumper_DumpRun( const SRATable* table,
 }
 
 
+/* upper limit of --zip-threads */
+#define MAX_ZIP_THREADS 64
+
 static const SRADumperFmt_Arg KMainArgs[] =
 {
     { NULL, "no-user-settings",  NULL,         { "Internal Only", NULL } },
@@ -664,6 +667,8 @@ static const SRADumperFmt_Arg KMainArgs[] =
     { "Z",   "stdout",           NULL,          { "Output to stdout, all split data become joined into single stream", NULL } },
     { NULL, "gzip",              NULL,         { "Compress output using gzip", NULL } },
     { NULL, "bzip2",             NULL,         { "Compress output using bzip2", NULL } },
+    { NULL, "zip-threads",       "count",      { "Number of threads compressing --gzip or --bzip2 output,",
+                                                  "shared by all output files, 1 to 64, default is 4", NULL } },
     { "N",   "minSpotId",        "rowid",       { "Minimum spot id", NULL } },
     { "X",   "maxSpotId",        "rowid",       { "Maximum spot id", NULL } },
     { "G",   "spot-group",       NULL,          { "Split into files by SPOT_GROUP (member name)", NULL } },
@@ -739,7 +744,9 @@ static void CoreUsage( const char* prog, const SRADumperFmt* fmt, bool brief, in
                       ++ i )
                 {
                     if ( ( !fmt->gzip && strcmp( d[ k ][ i ].full, "gzip" ) == 0 ) ||
-                         ( !fmt->bzip2 && strcmp (d[ k ][ i ].full, "bzip2" ) == 0 ) )
+                         ( !fmt->bzip2 && strcmp (d[ k ][ i ].full, "bzip2" ) == 0 ) ||
+                         ( !fmt->gzip && !fmt->bzip2 && d[ k ][ i ].full != NULL &&
+                           strcmp( d[ k ][ i ].full, "zip-threads" ) == 0 ) )
                     {
                         continue;
                     }
@@ -972,6 +979,7 @@ rc_t CC KMain ( int argc, char* argv[] )
     SRADumperFmt fmt;
 
     bool to_stdout = false, do_gzip = false, do_bzip2 = false;
+    uint32_t zip_threads = 0;
     char const* outdir = NULL;
     spotid_t minSpotId = 1;
     spotid_t maxSpotId = ~0;
@@ -1127,6 +1135,20 @@ rc_t CC KMain ( int argc, char* argv[] )
         {
             do_bzip2 = true;
         }
+        else if ( ( fmt.gzip || fmt.bzip2 ) &&
+                  SRADumper_GetArg( &fmt, NULL, "zip-threads", &i, argc, argv, &arg ) )
+        {
+            char * end;
+            unsigned long n = strtoul( arg, &end, 0 );
+            if ( n == 0 || n > MAX_ZIP_THREADS || *end != '\0' )
+            {
+                rc = RC( rcApp, rcArgv, rcReading, rcParam, rcExcessive );
+                PLOGERR( klogErr, ( klogErr, rc, "invalid number of threads $(v), must be 1 to $(max)",
+                                    "v=%s,max=%u", arg, MAX_ZIP_THREADS ) );
+                CoreUsage( argv[ 0 ], &fmt, false, EXIT_FAILURE );
+            }
+            zip_threads = ( uint32_t )n;
+        }
         else if ( SRADumper_GetArg( &fmt, NULL, "table", &i, argc, argv, &table_name ) )
         {
         }
@@ -1308,7 +1330,7 @@ rc_t CC KMain ( int argc, char* argv[] )
     }
     else
     {
-        rc = SRASplitterFactory_FilerInit( to_stdout, do_gzip, do_bzip2, sub_dir, keep_empty, outdir );
+        rc = SRASplitterFactory_FilerInit( to_stdout, do_gzip, do_bzip2, zip_threads, sub_dir, keep_empty, outdir );
         if ( rc != 0 )
         {
             LOGERR( klogErr, rc, "failed to initialize files" );
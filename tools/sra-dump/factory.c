@@ -30,6 +30,7 @@
 #include <kfs/buffile.h>
 #include <kfs/gzip.h>
 #include <kfs/bzip.h>
+#include <kfs/pzip.h>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -74,6 +75,8 @@ typedef struct SRASplitterFiler_struct {
     bool do_gzip;
     bool do_bzip2;
     const char* arc_extension;
+    /* compression threads shared by all output files */
+    KParZipPool* zip_pool;
     KDirectory* dir;
 
     /* TBD - this should be a BSTree */
@@ -138,6 +141,7 @@ void SRASplitterFiler_Release(void)
     if( g_filer != NULL ) {
         SLListWhack(&g_filer->files, SRASplitterFiler_WhackFile, &g_filer->keep_empty);
         KFileRelease(g_filer->kf_stdout);
+        KParZipPoolRelease(g_filer->zip_pool);
         KDirectoryRelease(g_filer->dir);
         free(g_filer->prefix);
         free(g_filer);
@@ -223,15 +227,16 @@ rc_t SRASplitterFiler_OpenFile(SRASplitterFile* file, bool initial)
             SRA_DUMP_DBG(5, ("Create file: '%s%s'\n", file->key, g_filer->arc_extension));
             if( (rc = KDirectoryCreateFile(file->dir, &file->file, false, 0664, kcmInit,
                                            "%s%s", file->name, g_filer->arc_extension)) == 0 ) {
+                /* all open files are compressed on the same threads */
                 if( g_filer->do_gzip ) {
                     KFile* gz;
-                    if( (rc = KFileMakeGzipForWrite(&gz, file->file)) == 0 ) {
+                    if( (rc = KFileMakeParallelGzipForWrite(&gz, file->file, 0, g_filer->zip_pool)) == 0 ) {
                         KFileRelease(file->file);
                         file->file = gz;
                     }
                 } else if( g_filer->do_bzip2 ) {
                     KFile* bz;
-                    if( (rc = KFileMakeBzip2ForWrite(&bz, file->file)) == 0 ) {
+                    if( (rc = KFileMakeParallelBzip2ForWrite(&bz, file->file, 0, g_filer->zip_pool)) == 0 ) {
                         KFileRelease(file->file);
                         file->file = bz;
                     }
@@ -426,7 +431,8 @@ rc_t SRASplitterFactory_FilerPrefix(const char* prefix)
     return rc;
 }
 
-rc_t SRASplitterFactory_FilerInit(bool to_stdout, bool gzip, bool bzip2, bool key_as_dir, bool keep_empty, const char* path, ...)
+rc_t SRASplitterFactory_FilerInit(bool to_stdout, bool gzip, bool bzip2, uint32_t zip_threads,
+                                  bool key_as_dir, bool keep_empty, const char* path, ...)
 {
     rc_t rc = 0;
 
@@ -446,19 +452,20 @@ rc_t SRASplitterFactory_FilerInit(bool to_stdout, bool gzip, bool bzip2, bool ke
         /* push empty prefix */
         g_filer->prefix = strdup("");
         if( (rc = SRASplitterFiler_PushKey(g_filer->prefix)) == 0 &&
-            (rc = KDirectoryNativeDir(&g_filer->dir)) == 0 ) {
+            (rc = KDirectoryNativeDir(&g_filer->dir)) == 0 &&
+            (!(gzip || bzip2) || (rc = KParZipPoolMake(&g_filer->zip_pool, zip_threads)) == 0) ) {
             if( to_stdout ) {
                 if( (rc = KFileMakeStdOut(&g_filer->kf_stdout)) == 0 ) {
                     KFile *buf = NULL;
                     if( gzip ) {
                         KFile* gz;
-                        if( (rc = KFileMakeGzipForWrite(&gz, g_filer->kf_stdout)) == 0 ) {
+                        if( (rc = KFileMakeParallelGzipForWrite(&gz, g_filer->kf_stdout, 0, g_filer->zip_pool)) == 0 ) {
                             KFileRelease(g_filer->kf_stdout);
                             g_filer->kf_stdout = gz;
                         }
                     } else if( bzip2 ) {
                         KFile* bz;
-                        if( (rc = KFileMakeBzip2ForWrite(&bz, g_filer->kf_stdout)) == 0 ) {
+                        if( (rc = KFileMakeParallelBzip2ForWrite(&bz, g_filer->kf_stdout, 0, g_filer->zip_pool)) == 0 ) {
                             KFileRelease(g_filer->kf_stdout);
                             g_filer->kf_stdout = bz;
                         }
@@ -146,9 +146,11 @@ typedef void (SRASplitterFactory_Release_Func)(const SRASplitterFactory* self);
   * key_as_dir [IN] - if true, subdirs created for each splitting level: SPOT_GROUP/1/prefix.fastq
   *                   if false, single file is used in split chain: prefix_SPOT_GROUP_1.fastq
   * prefix [IN]     - file name prefix, usually run id (accession)
+  * zip_threads [IN] - number of threads compressing all gzip or bzip2 files, 0 for default
   * path, ... [IN]  - path to directory where file will reside
   */
-rc_t SRASplitterFactory_FilerInit(bool to_stdout, bool gzip, bool bzip2, bool key_as_dir, bool keep_empty, const char* path, ...);
+rc_t SRASplitterFactory_FilerInit(bool to_stdout, bool gzip, bool bzip2, uint32_t zip_threads,
+                                  bool key_as_dir, bool keep_empty, const char* path, ...);
 /* this only works correctly on top of the splitter tree !! */
 rc_t SRASplitterFactory_FilerPrefix(const char* prefix);
 void SRASplitterFactory_FilerReport(uint64_t* total, uint64_t* biggest_file);
@@ -71,6 +71,9 @@ const char * schema_usage[] = { "optional schema-file to be used", NULL };
 
 const char * no_mt_usage[] = { "disable multithreading", NULL };
 
+const char * zip_threads_usage[] = { "number of threads compressing --gzip or --bzip2 output,",
+                                     "1 to 64, default is 4", NULL };
+
 
 #define OPTION_OUTF    "outfile"
 #define ALIAS_OUTF     "o"
@@ -92,6 +95,11 @@ const char * no_mt_usage[] = { "disable multithreading", NULL };
 
 #define OPTION_NO_MT  "disable-multithreading"
 
+#define OPTION_ZIP_THREADS "zip-threads"
+
+/* upper limit of --zip-threads */
+#define MAX_ZIP_THREADS 64
+
 OptDef CommonOptions[] =
 {
     /*name,           alias,         hfkt, usage-help,    maxcount, needs value, required */
@@ -102,7 +110,8 @@ OptDef CommonOptions[] =
     { OPTION_BZIP,    ALIAS_BZIP,    NULL, bzip_usage,    1,        false,       false },
     { OPTION_INF,     ALIAS_INF,     NULL, inf_usage,     0,        true,        false },
     { OPTION_SCHEMA,  ALIAS_SCHEMA,  NULL, schema_usage,  1,        true,        false },
-    { OPTION_NO_MT,   NULL,          NULL, no_mt_usage,   1,        false,       false }    
+    { OPTION_NO_MT,   NULL,          NULL, no_mt_usage,   1,        false,       false },
+    { OPTION_ZIP_THREADS, NULL,      NULL, zip_threads_usage, 1,    true,        false }
 };
 
 
@@ -164,7 +173,27 @@ rc_t get_common_options( Args * args, common_options *opts )
 
     if ( rc == 0 )
         rc = get_bool_option( args, OPTION_NO_MT, &opts->no_mt, false );
-        
+
+    opts->zip_threads = 0;
+    if ( rc == 0 )
+    {
+        const char * s = NULL;
+        rc = get_str_option( args, OPTION_ZIP_THREADS, &s );
+        if ( rc == 0 && s != NULL )
+        {
+            char * end;
+            unsigned long n = strtoul( s, &end, 0 );
+            if ( n == 0 || n > MAX_ZIP_THREADS || *end != 0 )
+            {
+                rc = RC( rcApp, rcArgv, rcParsing, rcParam, rcExcessive );
+                PLOGERR( klogErr, ( klogErr, rc, "invalid number of threads $(v), must be 1 to $(max)",
+                                    "v=%s,max=%u", s, MAX_ZIP_THREADS ) );
+            }
+            else
+                opts->zip_threads = ( uint32_t )n;
+        }
+    }
+
     if ( rc == 0 )
         rc = get_str_option( args, OPTION_SCHEMA, &opts->schema_file );
 
@@ -202,6 +231,7 @@ void print_common_helplines( void )
     HelpOptionLine ( ALIAS_BZIP, OPTION_BZIP, NULL, bzip_usage );
     HelpOptionLine ( ALIAS_GZIP, OPTION_GZIP, NULL, gzip_usage );
     HelpOptionLine ( NULL, OPTION_NO_MT, NULL, no_mt_usage );    
+    HelpOptionLine ( NULL, OPTION_ZIP_THREADS, "count", zip_threads_usage );
 }
 
 
@@ -808,19 +808,19 @@ static rc_t print_qslice( const samdump_opts * const opts, bool reverse, const c
             rc = dump_quality_33( opts, ptr, len, reverse ); /* sam-dump-opts.c */
             if ( rc == 0 )
             {
-                rc = KOutMsg( "\t" );
+                rc = sam_out_char( opts->out, '\t' );
                 if ( rc == 0 )
                     *source_offset += len;
             }
         }
         else
-            rc = KOutMsg( "*\t" );
+            rc = sam_out_cstr( opts->out, "*\t" );
     }
     return rc;
 }
 
 
-static rc_t modify_and_print_cigar( const char * cigar, size_t cigar_len,
+static rc_t modify_and_print_cigar( const samdump_opts * const opts, const char * cigar, size_t cigar_len,
                                     CigOps *ref_cig, int32_t ref_cig_len, INSDC_coord_zero ref_pos, uint32_t read_len )
 {
     rc_t rc;
@@ -831,10 +831,11 @@ static rc_t modify_and_print_cigar( const char * cigar, size_t cigar_len,
         CigOps al_cig[ 1024 ];
         ExplodeCIGAR( al_cig, 1024, cigar, cigar_len );
         combined_len = CombineCIGAR( cigbuf, al_cig, read_len, ref_pos, ref_cig, ref_cig_len );
-        rc = KOutMsg( "%s\t", cigbuf );
+        sam_out_cstr( opts->out, cigbuf );
+        rc = sam_out_char( opts->out, '\t' );
     }
     else
-        rc = KOutMsg( "*\t" );
+        rc = sam_out_cstr( opts->out, "*\t" );
     return rc;
 }
 
@@ -933,15 +934,27 @@ static rc_t print_evidence_alignment_cg_sam( const samdump_opts * const opts, co
         if ( opts->print_cg_names )
         {
             if ( spot_group_len > 0 )
+            {
                 /* SAM-FIELD: QNAME     constructed from spot-group/seq-name */
-                rc = KOutMsg( "%.*s-1:%.*s\t", spot_group_len, spot_group, seq_name_len, seq_name );
+                sam_out_str( opts->out, spot_group, spot_group_len );
+                sam_out_cstr( opts->out, "-1:" );
+                sam_out_str( opts->out, seq_name, seq_name_len );
+                rc = sam_out_char( opts->out, '\t' );
+            }
 
         }
         else
         {
             if ( seq_name_len > 0 )
+            {
                 /* SAM-FIELD: QNAME     constructed from allel-id/sub-id */
-                rc = KOutMsg( "%.*s/ALLELE_%li.%u\t", seq_name_len, seq_name, rec->id, ploidy_idx );
+                sam_out_str( opts->out, seq_name, seq_name_len );
+                sam_out_cstr( opts->out, "/ALLELE_" );
+                sam_out_i64( opts->out, rec->id );
+                sam_out_char( opts->out, '.' );
+                sam_out_u64( opts->out, ploidy_idx );
+                rc = sam_out_char( opts->out, '\t' );
+            }
         }
     }
 
@@ -969,7 +982,16 @@ static rc_t print_evidence_alignment_cg_sam( const samdump_opts * const opts, co
     /* SAM-FIELD: POS       SRA-column: REF_POS + 1 */
     /* SAM-FIELD: MAPQ      SRA-column: MAPQ ( from evidence-alignment-table, not from allel! ) */
     if ( rc == 0 )
-        rc = KOutMsg( "%u\t%s\t%i\t%d\t", sam_flags, ref_name, allele_pos + ref_pos + 1, mapq );
+    {
+        sam_out_u64( opts->out, sam_flags );
+        sam_out_char( opts->out, '\t' );
+        sam_out_cstr( opts->out, ref_name );
+        sam_out_char( opts->out, '\t' );
+        sam_out_i64( opts->out, allele_pos + ref_pos + 1 );
+        sam_out_char( opts->out, '\t' );
+        sam_out_i64( opts->out, mapq );
+        rc = sam_out_char( opts->out, '\t' );
+    }
 
     /* get READ, QUALITY and EIDT_DIST before cigar manipulation because we need/change these values */
     if ( rc == 0 )
@@ -983,7 +1005,7 @@ static rc_t print_evidence_alignment_cg_sam( const samdump_opts * const opts, co
         if ( rc == 0 )
             rc = cg_cigar_treatments( opts->cigar_treatment, &cgc_input, &cgc_output, align_id, &atx->eval );
         if ( rc == 0 )
-            rc = modify_and_print_cigar( cgc_output.p_cigar.ptr, cgc_output.p_cigar.len,
+            rc = modify_and_print_cigar( opts, cgc_output.p_cigar.ptr, cgc_output.p_cigar.len,
                                          atx->cig_op_buffer, ref_cig_len, ref_pos, cgc_output.p_read.len );
     }
 
@@ -992,7 +1014,11 @@ static rc_t print_evidence_alignment_cg_sam( const samdump_opts * const opts, co
     /* SAM-FIELD: TLEN      SRA-column: TEMPLATE_LEN '0' not in table */
     /* SAM-FIELD: SEQ       SRA-column: READ  */
     if ( rc == 0 )
-        rc = KOutMsg( "*\t0\t0\t%.*s\t", cgc_output.p_read.len, cgc_output.p_read.ptr );
+    {
+        sam_out_cstr( opts->out, "*\t0\t0\t" );
+        sam_out_str( opts->out, cgc_output.p_read.ptr, cgc_output.p_read.len );
+        rc = sam_out_char( opts->out, '\t' );
+    }
 
     /* SAM-FIELD: QUAL      SRA-column: SAM_QUALITY */
     if ( rc == 0 && cgc_output.p_quality.len > 0 )
@@ -1000,15 +1026,26 @@ static rc_t print_evidence_alignment_cg_sam( const samdump_opts * const opts, co
 
     /* OPT SAM-FIELD: RG     SRA-column: SEQ_SPOT_GROUP */
     if ( rc == 0 && spot_group_len > 0 )
-        rc = KOutMsg( "\tRG:Z:%.*s", spot_group_len, spot_group );
+    {
+        sam_out_cstr( opts->out, "\tRG:Z:" );
+        rc = sam_out_str( opts->out, spot_group, spot_group_len );
+    }
 
     if ( rc == 0 && cgc_output.p_tags.len > 0 )
-        rc = KOutMsg( "\t%.*s", cgc_output.p_tags.len, cgc_output.p_tags.ptr );
+    {
+        sam_out_char( opts->out, '\t' );
+        rc = sam_out_str( opts->out, cgc_output.p_tags.ptr, cgc_output.p_tags.len );
+    }
 
     /* OPT SAM-FIELD: ZI     SRA-column: rec->id */
     /* OPT SAM-FIELD: ZA     SRA-column: ploidy_idx */
     if ( rc == 0 )
-        rc = KOutMsg( "\tZI:i:%li\tZA:i:%u", rec->id, ploidy_idx );
+    {
+        sam_out_cstr( opts->out, "\tZI:i:" );
+        sam_out_i64( opts->out, rec->id );
+        sam_out_cstr( opts->out, "\tZA:i:" );
+        rc = sam_out_u64( opts->out, ploidy_idx );
+    }
 
     /* OPT SAM-FIELD: NH     SRA-column: ALIGNMENT_COUNT */
     if ( rc == 0 && atx->eval.al_count_idx != COL_NOT_AVAILABLE )
@@ -1017,19 +1054,28 @@ static rc_t print_evidence_alignment_cg_sam( const samdump_opts * const opts, co
         uint32_t al_count_len;
         rc = read_uint8_ptr( align_id, cursor, atx->eval.al_count_idx, &al_count, &al_count_len, "ALIGNMENT_COUNT" );
         if ( rc == 0 && al_count_len > 0 )
-            rc = KOutMsg( "\tNH:i:%u", *al_count );
+        {
+            sam_out_cstr( opts->out, "\tNH:i:" );
+            rc = sam_out_u64( opts->out, *al_count );
+        }
     }
 
     /* OPT SAM-FIELD: NM     SRA-column: EDIT_DISTANCE */
     if ( rc == 0 )
-        rc = KOutMsg( "\tNM:i:%u", cgc_output.edit_dist );
+    {
+        sam_out_cstr( opts->out, "\tNM:i:" );
+        rc = sam_out_u64( opts->out, ( uint32_t )cgc_output.edit_dist );
+    }
 
     /* OPT SAM-FIELD: XI     SRA-column: ALIGN_ID */
     if ( rc == 0 && opts->print_alignment_id_in_column_xi )
-        rc = KOutMsg( "\tXI:i:%u", align_id );
+    {
+        sam_out_cstr( opts->out, "\tXI:i:" );
+        rc = sam_out_u64( opts->out, ( uint32_t )align_id );
+    }
 
     if ( rc == 0 )
-        rc = KOutMsg( "\n" );
+        rc = sam_out_char( opts->out, '\n' );
 
     return rc;
 }
@@ -1055,15 +1101,27 @@ static rc_t print_evidence_alignment_cg_ev_dnb( const samdump_opts * const opts,
         if ( opts->print_cg_names )
         {
             if ( spot_group_len > 0 )
+            {
                 /* SAM-FIELD: QNAME     constructed from spot-group/seq-name */
-                rc = KOutMsg( "%.*s-1:%.*s\t", spot_group_len, spot_group, seq_name_len, seq_name );
+                sam_out_str( opts->out, spot_group, spot_group_len );
+                sam_out_cstr( opts->out, "-1:" );
+                sam_out_str( opts->out, seq_name, seq_name_len );
+                rc = sam_out_char( opts->out, '\t' );
+            }
 
         }
         else
         {
             if ( seq_name_len > 0 )
+            {
                 /* SAM-FIELD: QNAME     constructed from allel-id/sub-id */
-                rc = KOutMsg( "%.*s/ALLELE_%li.%u\t", seq_name_len, seq_name, rec->id, ploidy_idx );
+                sam_out_str( opts->out, seq_name, seq_name_len );
+                sam_out_cstr( opts->out, "/ALLELE_" );
+                sam_out_i64( opts->out, rec->id );
+                sam_out_char( opts->out, '.' );
+                sam_out_u64( opts->out, ploidy_idx );
+                rc = sam_out_char( opts->out, '\t' );
+            }
         }
     }
 
@@ -1091,7 +1149,18 @@ static rc_t print_evidence_alignment_cg_ev_dnb( const samdump_opts * const opts,
     /* SAM-FIELD: POS       SRA-column: REF_POS + 1 */
     /* SAM-FIELD: MAPQ      SRA-column: MAPQ ( from evidence-alignment-table, not from allel! ) */
     if ( rc == 0 )
-        rc = KOutMsg( "%u\tALLELE_%li.%u\t%i\t%d\t", sam_flags, rec->id, ploidy_idx, ref_pos + 1, mapq );
+    {
+        sam_out_u64( opts->out, sam_flags );
+        sam_out_cstr( opts->out, "\tALLELE_" );
+        sam_out_i64( opts->out, rec->id );
+        sam_out_char( opts->out, '.' );
+        sam_out_u64( opts->out, ploidy_idx );
+        sam_out_char( opts->out, '\t' );
+        sam_out_i64( opts->out, ref_pos + 1 );
+        sam_out_char( opts->out, '\t' );
+        sam_out_i64( opts->out, mapq );
+        rc = sam_out_char( opts->out, '\t' );
+    }
 
     /* get READ, QUALITY and EIDT_DIST before cigar manipulation because we need/change these values */
     if ( rc == 0 )
@@ -1105,7 +1174,10 @@ static rc_t print_evidence_alignment_cg_ev_dnb( const samdump_opts * const opts,
         if ( rc == 0 )
         rc = cg_cigar_treatments( opts->cigar_treatment, &cgc_input, &cgc_output, align_id, &atx->eval );
         if ( rc == 0 )
-            rc = KOutMsg( "%.*s\t", cgc_output.p_cigar.len, cgc_output.p_cigar.ptr );
+        {
+            sam_out_str( opts->out, cgc_output.p_cigar.ptr, cgc_output.p_cigar.len );
+            rc = sam_out_char( opts->out, '\t' );
+        }
     }
 
     /* SAM-FIELD: RNEXT     SRA-column: MATE_REF_NAME '*' no mates! */
@@ -1113,7 +1185,11 @@ static rc_t print_evidence_alignment_cg_ev_dnb( const samdump_opts * const opts,
     /* SAM-FIELD: TLEN      SRA-column: TEMPLATE_LEN '0' not in table */
     /* SAM-FIELD: SEQ       SRA-column: READ  */
     if ( rc == 0 )
-        rc = KOutMsg( "*\t0\t0\t%.*s\t", cgc_output.p_read.len, cgc_output.p_read.ptr );
+    {
+        sam_out_cstr( opts->out, "*\t0\t0\t" );
+        sam_out_str( opts->out, cgc_output.p_read.ptr, cgc_output.p_read.len );
+        rc = sam_out_char( opts->out, '\t' );
+    }
 
     /* SAM-FIELD: QUAL      SRA-column: SAM_QUALITY */
     if ( rc == 0 && cgc_output.p_quality.len > 0 )
@@ -1121,10 +1197,16 @@ static rc_t print_evidence_alignment_cg_ev_dnb( const samdump_opts * const opts,
 
     /* OPT SAM-FIELD: RG     SRA-column: SEQ_SPOT_GROUP */
     if ( rc == 0 && spot_group_len > 0 )
-        rc = KOutMsg( "\tRG:Z:%.*s", spot_group_len, spot_group );
+    {
+        sam_out_cstr( opts->out, "\tRG:Z:" );
+        rc = sam_out_str( opts->out, spot_group, spot_group_len );
+    }
 
     if ( rc == 0 && cgc_output.p_tags.len > 0 )
-        rc = KOutMsg( "\t%.*s", cgc_output.p_tags.len, cgc_output.p_tags.ptr );
+    {
+        sam_out_char( opts->out, '\t' );
+        rc = sam_out_str( opts->out, cgc_output.p_tags.ptr, cgc_output.p_tags.len );
+    }
 
     /* OPT SAM-FIELD: NH     SRA-column: ALIGNMENT_COUNT */
     if ( rc == 0 && atx->eval.al_count_idx != COL_NOT_AVAILABLE )
@@ -1133,19 +1215,28 @@ static rc_t print_evidence_alignment_cg_ev_dnb( const samdump_opts * const opts,
         uint32_t al_count_len;
         rc = read_uint8_ptr( align_id, cursor, atx->eval.al_count_idx, &al_count, &al_count_len, "ALIGNMENT_COUNT" );
         if ( rc == 0 && al_count_len > 0 )
-            rc = KOutMsg( "\tNH:i:%u", *al_count );
+        {
+            sam_out_cstr( opts->out, "\tNH:i:" );
+            rc = sam_out_u64( opts->out, *al_count );
+        }
     }
 
     /* OPT SAM-FIELD: NM     SRA-column: EDIT_DISTANCE */
     if ( rc == 0 )
-        rc = KOutMsg( "\tNM:i:%u", cgc_output.edit_dist );
+    {
+        sam_out_cstr( opts->out, "\tNM:i:" );
+        rc = sam_out_u64( opts->out, ( uint32_t )cgc_output.edit_dist );
+    }
 
     /* OPT SAM-FIELD: XI     SRA-column: ALIGN_ID */
     if ( rc == 0 && opts->print_alignment_id_in_column_xi )
-        rc = KOutMsg( "\tXI:i:%u", align_id );
+    {
+        sam_out_cstr( opts->out, "\tXI:i:" );
+        rc = sam_out_u64( opts->out, ( uint32_t )align_id );
+    }
 
     if ( rc == 0 )
-        rc = KOutMsg( "\n" );
+        rc = sam_out_char( opts->out, '\n' );
 
     return rc;
 }
@@ -1210,24 +1301,45 @@ static rc_t print_alignment_sam_ev( const samdump_opts * const opts, const char
                 if ( rc == 0 )
                 {
                     if ( opts->print_cg_names )
-                        rc = KOutMsg( "-1:0\t" );
+                        rc = sam_out_cstr( opts->out, "-1:0\t" );
                     else
-                        rc = KOutMsg( "ALLELE_%li.%u\t", rec->id, ploidy_idx + 1 );
+                    {
+                        sam_out_cstr( opts->out, "ALLELE_" );
+                        sam_out_i64( opts->out, rec->id );
+                        sam_out_char( opts->out, '.' );
+                        sam_out_u64( opts->out, ploidy_idx + 1 );
+                        rc = sam_out_char( opts->out, '\t' );
+                    }
                 }
 
                 if ( rc == 0 )
-                    rc = KOutMsg( "0\t%s\t%u\t%d\t", ref_name, pos + 1, rec->mapq );
+                {
+                    sam_out_cstr( opts->out, "0\t" );
+                    sam_out_cstr( opts->out, ref_name );
+                    sam_out_char( opts->out, '\t' );
+                    sam_out_u64( opts->out, ( uint32_t )( pos + 1 ) );
+                    sam_out_char( opts->out, '\t' );
+                    sam_out_i64( opts->out, rec->mapq );
+                    rc = sam_out_char( opts->out, '\t' );
+                }
 
                 /* SAM-FIELD: CIGAR     SRA-column: CIGAR_SHORT / CIGAR_LONG sliced!!! */
                 if ( rc == 0 )
-                    rc = KOutMsg( "%.*s\t", cigar_slice_len, transformed_cigar );
+                {
+                    sam_out_str( opts->out, transformed_cigar, cigar_slice_len );
+                    rc = sam_out_char( opts->out, '\t' );
+                }
 
                 /* SAM-FIELD: RNEXT     SRA-column: MATE_REF_NAME ( !!! row_len can be zero !!! ) */
                 /* SAM-FIELD: PNEXT     SRA-column: MATE_REF_POS + 1 ( !!! row_len can be zero !!! ) */
                 /* SAM-FIELD: TLEN      SRA-column: TEMPLATE_LEN ( !!! row_len can be zero !!! ) */
                 /* SAM-FIELD: SEQ       SRA-column: READ sliced!!! */
                 if ( rc == 0 )
-                    rc = KOutMsg( "*\t0\t0\t%.*s\t", read_slice_len, read );
+                {
+                    sam_out_cstr( opts->out, "*\t0\t0\t" );
+                    sam_out_str( opts->out, read, read_slice_len );
+                    rc = sam_out_char( opts->out, '\t' );
+                }
 
                 /* SAM-FIELD: QUAL      SRA-column: SAM_QUALITY sliced!!! */
                 if ( rc == 0 )
@@ -1235,18 +1347,27 @@ static rc_t print_alignment_sam_ev( const samdump_opts * const opts, const char
 
                 /* OPT SAM-FIELD: RG     SRA-column: ploidy_idx */
                 if ( rc == 0 )
-                    rc = KOutMsg( "RG:Z:ALLELE_%u", ploidy_idx + 1 );
+                {
+                    sam_out_cstr( opts->out, "RG:Z:ALLELE_" );
+                    rc = sam_out_u64( opts->out, ploidy_idx + 1 );
+                }
 
                 /* OPT SAM-FIELD: XI     SRA-column: ALIGN_ID */
                 if ( rc == 0 && opts->print_alignment_id_in_column_xi )
-                    rc = KOutMsg( "\tXI:i:%u", rec->id );
+                {
+                    sam_out_cstr( opts->out, "\tXI:i:" );
+                    rc = sam_out_u64( opts->out, ( uint32_t )rec->id );
+                }
 
                 /* OPT SAM-FIELD: NM     SRA-column: EDIT_DISTANCE sliced!!! */
                 if ( rc == 0 && ( ploidy_idx < edit_dist_vector_len ) )
-                    rc = KOutMsg( "\tNM:i:%u", edit_dist_vector[ ploidy_idx ] );
+                {
+                    sam_out_cstr( opts->out, "\tNM:i:" );
+                    rc = sam_out_u64( opts->out, edit_dist_vector[ ploidy_idx ] );
+                }
 
                 if ( rc == 0 )
-                    rc = KOutMsg( "\n" );
+                    rc = sam_out_char( opts->out, '\n' );
 
                 (*rows_so_far)++;
             }
@@ -1484,11 +1605,11 @@ static rc_t print_alignment_sam_ps( const samdump_opts * const opts, const char
                 rc = dump_name( opts, *seq_spot_id, NULL, 0 ); /* sam-dump-opts.c */
         }
         else
-            rc = KOutMsg( "*" );
+            rc = sam_out_char( opts->out, '*' );
     }
 
     if ( rc == 0 )
-        rc = KOutMsg( "\t" );
+        rc = sam_out_char( opts->out, '\t' );
 
     /* massage the sam-flag if we are not dumping unaligned reads... */
     if ( !opts->dump_unaligned_reads    /** not going to dump unaligned **/
@@ -1503,7 +1624,16 @@ static rc_t print_alignment_sam_ps( const samdump_opts * const opts, const char
     /* SAM-FIELD: POS       SRA-column: REF_POS + 1 */
     /* SAM-FIELD: MAPQ      SRA-column: MAPQ */
     if ( rc == 0 )
-        rc = KOutMsg( "%u\t%s\t%u\t%d\t", sam_flags, ref_name, pos + 1, rec->mapq );
+    {
+        sam_out_u64( opts->out, sam_flags );
+        sam_out_char( opts->out, '\t' );
+        sam_out_cstr( opts->out, ref_name );
+        sam_out_char( opts->out, '\t' );
+        sam_out_u64( opts->out, ( uint32_t )( pos + 1 ) );
+        sam_out_char( opts->out, '\t' );
+        sam_out_i64( opts->out, rec->mapq );
+        rc = sam_out_char( opts->out, '\t' );
+    }
 
     /* get READ, QUALITY and EIDT_DIST before cigar manipulation because we need/change these values */
     if ( rc == 0 )
@@ -1547,7 +1677,10 @@ static rc_t print_alignment_sam_ps( const samdump_opts * const opts, const char
             }
         }
         if ( rc == 0 )
-            rc = KOutMsg( "%.*s\t", cgc_output.p_cigar.len, cgc_output.p_cigar.ptr );
+        {
+            sam_out_str( opts->out, cgc_output.p_cigar.ptr, cgc_output.p_cigar.len );
+            rc = sam_out_char( opts->out, '\t' );
+        }
         if ( temp_cigar != NULL )
             free( temp_cigar );
     }
@@ -1559,20 +1692,38 @@ static rc_t print_alignment_sam_ps( const samdump_opts * const opts, const char
     {
         if ( mate_ref_name_len > 0 )
         {
-            rc = KOutMsg( "%.*s\t%u\t%d\t", mate_ref_name_len, mate_ref_name, mate_ref_pos + 1, tlen );
+            sam_out_str( opts->out, mate_ref_name, mate_ref_name_len );
+            sam_out_char( opts->out, '\t' );
+            sam_out_u64( opts->out, ( uint32_t )( mate_ref_pos + 1 ) );
+            sam_out_char( opts->out, '\t' );
+            sam_out_i64( opts->out, ( int32_t )tlen );
+            rc = sam_out_char( opts->out, '\t' );
         }
         else
         {
             if ( mate_ref_pos_len == 0 )
-                rc = KOutMsg( "*\t0\t%d\t", tlen );
+            {
+                sam_out_cstr( opts->out, "*\t0\t" );
+                sam_out_i64( opts->out, ( int32_t )tlen );
+                rc = sam_out_char( opts->out, '\t' );
+            }
             else
-                rc = KOutMsg( "*\t%u\t%d\t", mate_ref_pos, tlen );
+            {
+                sam_out_cstr( opts->out, "*\t" );
+                sam_out_u64( opts->out, ( uint32_t )mate_ref_pos );
+                sam_out_char( opts->out, '\t' );
+                sam_out_i64( opts->out, ( int32_t )tlen );
+                rc = sam_out_char( opts->out, '\t' );
+            }
         }
     }
 
     /* SAM-FIELD: SEQ       SRA-column: READ */
     if ( rc == 0 )
-        rc = KOutMsg( "%.*s\t", cgc_output.p_read.len, cgc_output.p_read.ptr );
+    {
+        sam_out_str( opts->out, cgc_output.p_read.ptr, cgc_output.p_read.len );
+        rc = sam_out_char( opts->out, '\t' );
+    }
 
     /* SAM-FIELD: QUAL      SRA-column: SAM_QUALITY */
     if ( rc == 0 )
@@ -1580,7 +1731,7 @@ static rc_t print_alignment_sam_ps( const samdump_opts * const opts, const char
         if ( cgc_output.p_quality.len > 0 )
             rc = dump_quality_33( opts, cgc_output.p_quality.ptr, cgc_output.p_quality.len, false );
         else
-            rc = KOutMsg( "*" );
+            rc = sam_out_char( opts->out, '*' );
     }
 
     /* OPT SAM-FIELD: RG     SRA-column: SPOT_GROUP */
@@ -1590,15 +1741,24 @@ static rc_t print_alignment_sam_ps( const samdump_opts * const opts, const char
         uint32_t spot_grp_len;
         rc = read_char_ptr( id, cursor, atx->cmn.seq_spot_group_idx, &spot_grp, &spot_grp_len, "SPOT_GROUP" );
         if ( rc == 0 && spot_grp_len > 0 )
-            rc = KOutMsg( "\tRG:Z:%.*s", spot_grp_len, spot_grp );
+        {
+            sam_out_cstr( opts->out, "\tRG:Z:" );
+            rc = sam_out_str( opts->out, spot_grp, spot_grp_len );
+        }
     }
 
     if ( rc == 0 && cgc_output.p_tags.len > 0 )
-        rc = KOutMsg( "\t%.*s", cgc_output.p_tags.len, cgc_output.p_tags.ptr );
+    {
+        sam_out_char( opts->out, '\t' );
+        rc = sam_out_str( opts->out, cgc_output.p_tags.ptr, cgc_output.p_tags.len );
+    }
 
     /* OPT SAM-FIELD: XI     SRA-column: ALIGN_ID */
     if ( rc == 0 && opts->print_alignment_id_in_column_xi )
-        rc = KOutMsg( "\tXI:i:%u", id );
+    {
+        sam_out_cstr( opts->out, "\tXI:i:" );
+        rc = sam_out_u64( opts->out, ( uint32_t )id );
+    }
 
     /* to match sam-tools output: in case we are dumping this in CG-mode.... */
     if ( rc == 0 && ( opts->cigar_treatment != ct_unchanged ) && ( atx->al_group_idx != COL_NOT_AVAILABLE ) )
@@ -1613,7 +1773,10 @@ static rc_t print_alignment_sam_ps( const samdump_opts * const opts, const char
             {
                 if ( align_grp[ i ] == '_' )
                 {
-                    rc = KOutMsg( "\tZI:i:%.*s\tZA:i:%.1s", i, align_grp, align_grp + i + 1 );
+                    sam_out_cstr( opts->out, "\tZI:i:" );
+                    sam_out_str( opts->out, align_grp, i );
+                    sam_out_cstr( opts->out, "\tZA:i:" );
+                    rc = sam_out_str( opts->out, align_grp + i + 1, 1 );
                     break;
                 }
             }
@@ -1627,20 +1790,26 @@ static rc_t print_alignment_sam_ps( const samdump_opts * const opts, const char
         uint32_t al_count_len;
         rc = read_uint8_ptr( id, cursor, atx->cmn.al_count_idx, &al_count, &al_count_len, "ALIGNMENT_COUNT" );
         if ( rc == 0 && al_count_len > 0 )
-            rc = KOutMsg( "\tNH:i:%u", *al_count );
+        {
+            sam_out_cstr( opts->out, "\tNH:i:" );
+            rc = sam_out_u64( opts->out, *al_count );
+        }
     }
 
     /* OPT SAM-FIELD: NM     SRA-column: EDIT_DISTANCE */
     if ( rc == 0 )
-        rc = KOutMsg( "\tNM:i:%u", cgc_output.edit_dist );
+    {
+        sam_out_cstr( opts->out, "\tNM:i:" );
+        rc = sam_out_u64( opts->out, ( uint32_t )cgc_output.edit_dist );
+    }
 
     /* OPT SAM-FIELD: XS:A:+/-  SRA-column: RNA-SPLICING detected via computation */
     if ( rc == 0 && opts->rna_splicing && ( candidates.fwd_matched > 0 || candidates.rev_matched > 0 ) )
     {
         if ( candidates.fwd_matched > 0 )
-            rc = KOutMsg( "\tXS:A:+" );
+            rc = sam_out_cstr( opts->out, "\tXS:A:+" );
         else 
-            rc = KOutMsg( "\tXS:A:-" );
+            rc = sam_out_cstr( opts->out, "\tXS:A:-" );
 /*
         uint32_t i;
         KOutMsg( "\tXS:A:" );
@@ -1653,7 +1822,7 @@ static rc_t print_alignment_sam_ps( const samdump_opts * const opts, const char
     }
 
     if ( rc == 0 )
-        rc = KOutMsg( "\n" );
+        rc = sam_out_char( opts->out, '\n' );
     return rc;
 }
 
@@ -1684,9 +1853,9 @@ static rc_t print_alignment_fastx( const samdump_opts * const opts, const char *
     ( *rows_so_far )++;
 
     if ( opts->output_format == of_fastq )
-        rc = KOutMsg( "@" );
+        rc = sam_out_char( opts->out, '@' );
     else
-        rc = KOutMsg( ">" );
+        rc = sam_out_char( opts->out, '>' );
 
     /* SAM-FIELD: QNAME     1.row: name */
     if ( rc == 0 )
@@ -1705,14 +1874,17 @@ static rc_t print_alignment_fastx( const samdump_opts * const opts, const char *
                 rc = dump_name( opts, *seq_spot_id, NULL, 0 ); /* sam-dump-opts.c */
         }
         else
-            rc = KOutMsg( "*" );
+            rc = sam_out_char( opts->out, '*' );
 
         if ( rc == 0 )
         {
             uint32_t seq_read_id;
             rc = read_uint32( rec->id, cursor, atx->cmn.seq_read_id_idx, &seq_read_id, 0, "SEQ_READ_ID" );
             if ( rc == 0 )
-                rc = KOutMsg( "/%u", seq_read_id );
+            {
+                sam_out_char( opts->out, '/' );
+                rc = sam_out_u64( opts->out, seq_read_id );
+            }
         }
     }
 
@@ -1725,15 +1897,23 @@ static rc_t print_alignment_fastx( const samdump_opts * const opts, const char *
     {
         switch( atx->align_table_type )
         {
-        case att_primary    :   rc = KOutMsg( " primary" ); break;
-        case att_secondary  :   rc = KOutMsg( " secondary" ); break;
-        case att_evidence   :   rc = KOutMsg( " evidence" ); break;
+        case att_primary    :   rc = sam_out_cstr( opts->out, " primary" ); break;
+        case att_secondary  :   rc = sam_out_cstr( opts->out, " secondary" ); break;
+        case att_evidence   :   rc = sam_out_cstr( opts->out, " evidence" ); break;
         }
     }
 
     /* against what reference aligned, at what position, with what mapping-quality */
     if ( rc == 0 )
-        rc = KOutMsg( " ref=%s pos=%u mapq=%i\n", ref_name, pos + 1, rec->mapq );
+    {
+        sam_out_cstr( opts->out, " ref=" );
+        sam_out_cstr( opts->out, ref_name );
+        sam_out_cstr( opts->out, " pos=" );
+        sam_out_u64( opts->out, ( uint32_t )( pos + 1 ) );
+        sam_out_cstr( opts->out, " mapq=" );
+        sam_out_i64( opts->out, rec->mapq );
+        rc = sam_out_char( opts->out, '\n' );
+    }
 
     /* READ at a new line */
     if ( rc == 0 )
@@ -1744,16 +1924,19 @@ static rc_t print_alignment_fastx( const samdump_opts * const opts, const char *
         if ( rc == 0 )
         {
             if ( read_size > 0 )
-                rc = KOutMsg( "%.*s\n", read_size, read );
+            {
+                sam_out_str( opts->out, read, read_size );
+                rc = sam_out_char( opts->out, '\n' );
+            }
             else
-                rc = KOutMsg( "*\n" );
+                rc = sam_out_cstr( opts->out, "*\n" );
         }
     }
 
     /* QUALITY on a new line if in fastq-mode */
     if ( rc == 0 && opts->output_format == of_fastq )
     {
-        rc = KOutMsg( "+\n" );
+        rc = sam_out_cstr( opts->out, "+\n" );
         if ( rc == 0 )
         {
             const char * quality;
@@ -1764,10 +1947,10 @@ static rc_t print_alignment_fastx( const samdump_opts * const opts, const char *
                 if ( quality_size > 0 )
                     rc = dump_quality_33( opts, quality, quality_size, false );
                 else
-                    rc = KOutMsg( "*" );
+                    rc = sam_out_char( opts->out, '*' );
             }
             if ( rc == 0 )
-                rc = KOutMsg( "\n" );
+                rc = sam_out_char( opts->out, '\n' );
         }
     }
 
@@ -1947,9 +2130,12 @@ static void CC destroy_align_table_context( void *item, void *data )
 }
 
 
-static rc_t print_all_aligned_spots_of_this_reference( const samdump_opts * const opts, const input_database * const ids,
-                                                       matecache * const mc, const AlignMgr * const a_mgr,
-                                                       const ReferenceObj * const ref_obj, uint64_t * const rows_so_far )
+/* prints the alignments that start in ref_pos ... ref_pos + ref_len - 1 on this reference */
+static rc_t print_aligned_spots_of_this_window( const samdump_opts * const opts, const input_database * const ids,
+                                                matecache * const mc, const AlignMgr * const a_mgr,
+                                                const ReferenceObj * const ref_obj,
+                                                INSDC_coord_zero ref_pos, INSDC_coord_len ref_len,
+                                                uint64_t * const rows_so_far )
 {
     PlacementSetIterator * set_iter;
     /* the we ask the alignment-manager to produce a placement-set-iterator... */
@@ -1962,22 +2148,17 @@ static rc_t print_all_aligned_spots_of_this_reference( const samdump_opts * cons
     {
         /* here we need a vector to passed along into the creation of the iterators */
         Vector context_list;
-        INSDC_coord_len ref_len;
 
         VectorInit ( &context_list, 0, 5 );
 
-        rc = ReferenceObj_SeqLength( ref_obj, &ref_len );
+        rc = add_pl_iters( opts, set_iter, ref_obj, ids,
+            ref_pos,            /* where it starts on the reference */
+            ref_len,            /* how many bases of this reference/chromosome */
+            NULL,               /* no spotgroup re-grouping (yet) */
+            &context_list
+            );
         if ( rc == 0 )
-        {
-            rc = add_pl_iters( opts, set_iter, ref_obj, ids,
-                0,                  /* where it starts on the reference */
-                ref_len,            /* the whole length of this reference/chromosome */
-                NULL,               /* no spotgroup re-grouping (yet) */
-                &context_list
-                );
-            if ( rc == 0 )
-                rc = walk_placements( opts, set_iter, mc, rows_so_far );
-        }
+            rc = walk_placements( opts, set_iter, mc, rows_so_far );
 
         /* walk the context_list to free the align_table_context records, close/free the cursors... */
         VectorWhack ( &context_list, destroy_align_table_context, NULL );
@@ -1987,6 +2168,21 @@ static rc_t print_all_aligned_spots_of_this_reference( const samdump_opts * cons
 }
 
 
+static rc_t print_all_aligned_spots_of_this_reference( const samdump_opts * const opts, const input_database * const ids,
+                                                       matecache * const mc, const AlignMgr * const a_mgr,
+                                                       const ReferenceObj * const ref_obj, uint64_t * const rows_so_far )
+{
+    INSDC_coord_len ref_len;
+    rc_t rc = ReferenceObj_SeqLength( ref_obj, &ref_len );
+    if ( rc == 0 )
+        rc = print_aligned_spots_of_this_window( opts, ids, mc, a_mgr, ref_obj,
+                0,                  /* where it starts on the reference */
+                ref_len,            /* the whole length of this reference/chromosome */
+                rows_so_far );
+    return rc;
+}
+
+
 /*
    the user did not specify regions, print all alignments from all input-files
    this is strategy #1 to do this, create a ref_iter for every reference each
@@ -2132,3 +2328,42 @@ rc_t print_aligned_spots( const samdump_opts * const opts, const input_files * c
     }
     return rc;
 }
+
+
+/*
+   this is called from sam-parallel.c, it prints the alignments of one slice
+   of one reference, the ones that start in ref_pos ... ref_pos + ref_len - 1
+*/
+rc_t print_aligned_slice( const samdump_opts * const opts, const input_files * const ifs,
+                          matecache * const mc, uint32_t db_idx, uint32_t ref_idx,
+                          INSDC_coord_zero ref_pos, INSDC_coord_len ref_len,
+                          uint64_t * const rows_so_far )
+{
+    const input_database * ids = VectorGet( &ifs->dbs, db_idx );
+    rc_t rc = 0;
+    if ( ids != NULL )
+    {
+        const ReferenceObj * ref_obj;
+        rc = ReferenceList_Get( ids->reflist, &ref_obj, ref_idx );
+        if ( rc != 0 )
+        {
+            (void)LOGERR( klogErr, rc, "ReferenceList_Get() failed" );
+        }
+        else if ( ref_obj != NULL )
+        {
+            const AlignMgr * a_mgr;
+            rc = AlignMgrMakeRead( &a_mgr );
+            if ( rc != 0 )
+            {
+                (void)LOGERR( klogErr, rc, "cannot create alignment-manager" );
+            }
+            else
+            {
+                rc = print_aligned_spots_of_this_window( opts, ids, mc, a_mgr, ref_obj, ref_pos, ref_len, rows_so_far );
+                AlignMgrRelease( a_mgr );
+            }
+            ReferenceObj_Release( ref_obj );
+        }
+    }
+    return rc;
+}
@@ -42,4 +42,9 @@ extern "C" {
 rc_t print_aligned_spots( const samdump_opts * const opts, const input_files * const ifs,
                           matecache * const mc, uint64_t * const rows_so_far );
 
+rc_t print_aligned_slice( const samdump_opts * const opts, const input_files * const ifs,
+                          matecache * const mc, uint32_t db_idx, uint32_t ref_idx,
+                          INSDC_coord_zero ref_pos, INSDC_coord_len ref_len,
+                          uint64_t * const rows_so_far );
+
 #endif
\ No newline at end of file
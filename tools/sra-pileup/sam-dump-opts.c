@@ -925,6 +925,8 @@ static rc_t gather_int_options( Args * args, samdump_opts * opts )
     {
         rc = get_int32_options( args, OPT_MIN_MAPQ, &opts->min_mapq, &opts->use_min_mapq );
     }
+    if ( rc == 0 )
+        rc = get_int_option( args, OPT_THREADS, 1, &opts->threads, true );
     return rc;
 }
 
@@ -1266,6 +1268,7 @@ void report_options( const samdump_opts * opts )
     KOutMsg( "outputfile            : %s\n",  opts->outputfile );
     KOutMsg( "outputbuffer-size     : %u\n",  opts->output_buffer_size );
     KOutMsg( "cursor-cache-size     : %u\n",  opts->cursor_cache_size );
+    KOutMsg( "threads               : %u\n",  opts->threads );
 
     KOutMsg( "use mate-cache        : %s\n",  opts->use_mate_cache ? "YES" : "NO" );
     KOutMsg( "force legacy code     : %s\n",  opts->force_legacy ? "YES" : "NO" );
@@ -1356,9 +1359,13 @@ rc_t dump_name( const samdump_opts * opts, int64_t seq_spot_id,
     if ( opts->print_cg_names )
     {
         if ( spot_group != NULL && spot_group_len != 0 )
-            rc = KOutMsg( "%.*s-1:%lu", spot_group_len, spot_group, seq_spot_id );
+        {
+            sam_out_str( opts->out, spot_group, spot_group_len );
+            sam_out_cstr( opts->out, "-1:" );
+            rc = sam_out_u64( opts->out, seq_spot_id );
+        }
         else
-            rc = KOutMsg( "%lu", seq_spot_id );
+            rc = sam_out_u64( opts->out, seq_spot_id );
     }
     else
     {
@@ -1366,19 +1373,33 @@ rc_t dump_name( const samdump_opts * opts, int64_t seq_spot_id,
         {
             /* we do have to print a prefix */
             if ( opts->print_spot_group_in_name && spot_group != NULL && spot_group_len > 0 )
-                rc = KOutMsg( "%s.%lu.%.*s", opts->qname_prefix, seq_spot_id, spot_group_len, spot_group );
+            {
+                sam_out_cstr( opts->out, opts->qname_prefix );
+                sam_out_char( opts->out, '.' );
+                sam_out_u64( opts->out, seq_spot_id );
+                sam_out_char( opts->out, '.' );
+                rc = sam_out_str( opts->out, spot_group, spot_group_len );
+            }
             else
-            /* we do NOT have to append the spot-group */
-                rc = KOutMsg( "%s.%lu", opts->qname_prefix, seq_spot_id );
+            {
+                /* we do NOT have to append the spot-group */
+                sam_out_cstr( opts->out, opts->qname_prefix );
+                sam_out_char( opts->out, '.' );
+                rc = sam_out_u64( opts->out, seq_spot_id );
+            }
         }
         else
         {
             /* we do NOT have to print a prefix */
             if ( opts->print_spot_group_in_name && spot_group != NULL && spot_group_len > 0 )
-                rc = KOutMsg( "%lu.%.*s", seq_spot_id, spot_group_len, spot_group );
+            {
+                sam_out_u64( opts->out, seq_spot_id );
+                sam_out_char( opts->out, '.' );
+                rc = sam_out_str( opts->out, spot_group, spot_group_len );
+            }
             else
             /* we do NOT have to append the spot-group */
-                rc = KOutMsg( "%lu", seq_spot_id );
+                rc = sam_out_u64( opts->out, seq_spot_id );
         }
     }
     return rc;
@@ -1394,19 +1415,32 @@ rc_t dump_name_legacy( const samdump_opts * opts, const char * name, size_t name
     {
         /* we do have to print a prefix */
         if ( opts->print_spot_group_in_name && spot_group != NULL && spot_group_len > 0 )
-            rc = KOutMsg( "%s.%.*s%.*s", opts->qname_prefix, name_len, name, spot_group_len, spot_group );
+        {
+            sam_out_cstr( opts->out, opts->qname_prefix );
+            sam_out_char( opts->out, '.' );
+            sam_out_str( opts->out, name, name_len );
+            rc = sam_out_str( opts->out, spot_group, spot_group_len );
+        }
         else
-        /* we do NOT have to append the spot-group */
-            rc = KOutMsg( "%s.%.*s", opts->qname_prefix, name_len, name );
+        {
+            /* we do NOT have to append the spot-group */
+            sam_out_cstr( opts->out, opts->qname_prefix );
+            sam_out_char( opts->out, '.' );
+            rc = sam_out_str( opts->out, name, name_len );
+        }
     }
     else
     {
         /* we do NOT have to print a prefix */
         if ( opts->print_spot_group_in_name && spot_group != NULL && spot_group_len > 0 )
-            rc = KOutMsg( "%.*s.%.*s", name_len, name, spot_group_len, spot_group );
+        {
+            sam_out_str( opts->out, name, name_len );
+            sam_out_char( opts->out, '.' );
+            rc = sam_out_str( opts->out, spot_group, spot_group_len );
+        }
         else
         /* we do NOT have to append the spot-group */
-            rc = KOutMsg( "%.*s", name_len, name );
+            rc = sam_out_str( opts->out, name, name_len );
     }
     return rc;
 }
@@ -1425,7 +1459,7 @@ rc_t dump_quality( const samdump_opts * opts, char const *quality, uint32_t qual
             {
                 uint32_t qual = quality[ qual_len - i - 1 ];
                 char newValue = ( opts->qual_quant_matrix[ qual ] + 33 );
-                rc = KOutMsg( "%c", newValue );
+                rc = sam_out_char( opts->out, newValue );
             }
         }
         else
@@ -1433,7 +1467,7 @@ rc_t dump_quality( const samdump_opts * opts, char const *quality, uint32_t qual
             for ( i = 0; i < qual_len && rc == 0; ++i )
             {
                 char qual = quality[ qual_len - i - 1 ] + 33;
-                rc = KOutMsg( "%c", qual );
+                rc = sam_out_char( opts->out, qual );
             }
         }
     }
@@ -1445,7 +1479,7 @@ rc_t dump_quality( const samdump_opts * opts, char const *quality, uint32_t qual
             {
                 uint32_t qual = quality[ i ];
                 char newValue = opts->qual_quant_matrix[ qual ] + 33;
-                rc = KOutMsg( "%c", newValue );
+                rc = sam_out_char( opts->out, newValue );
             }
 
         }
@@ -1454,7 +1488,7 @@ rc_t dump_quality( const samdump_opts * opts, char const *quality, uint32_t qual
             for ( i = 0; i < qual_len && rc == 0; ++i )
             {
                 char qual = quality[ i ] + 33;
-                rc = KOutMsg( "%c", qual );
+                rc = sam_out_char( opts->out, qual );
             }
         }
     }
@@ -1475,7 +1509,7 @@ rc_t dump_quality_33( const samdump_opts * opts, char const *quality, uint32_t q
             {
                 uint32_t qual = quality[ qual_len - i - 1 ] - 33;
                 char newValue = ( opts->qual_quant_matrix[ qual ] + 33 );
-                rc = KOutMsg( "%c", newValue );
+                rc = sam_out_char( opts->out, newValue );
             }
         }
         else
@@ -1483,7 +1517,7 @@ rc_t dump_quality_33( const samdump_opts * opts, char const *quality, uint32_t q
             for ( i = 0; i < qual_len && rc == 0; ++i )
             {
                 char qual = quality[ qual_len - i - 1 ];
-                rc = KOutMsg( "%c", qual );
+                rc = sam_out_char( opts->out, qual );
             }
         }
     }
@@ -1495,13 +1529,13 @@ rc_t dump_quality_33( const samdump_opts * opts, char const *quality, uint32_t q
             {
                 uint32_t qual = quality[ i ] - 33;
                 char newValue = opts->qual_quant_matrix[ qual ] + 33;
-                rc = KOutMsg( "%c", newValue );
+                rc = sam_out_char( opts->out, newValue );
             }
 
         }
         else
         {
-            rc = KOutMsg( "%.*s", qual_len, quality );
+            rc = sam_out_str( opts->out, quality, qual_len );
         }
     }
     return rc;
@@ -50,6 +50,8 @@ extern "C" {
 #include <assert.h>
 #include <strtol.h>
 
+#include "sam-out.h"
+
 
 #define OPT_UNALIGNED   "unaligned"
 #define OPT_PRIM_ONLY   "primary"
@@ -93,6 +95,7 @@ extern "C" {
 #define OPT_NEW         "new"
 #define OPT_RNA_SPLICE  "rna-splicing"
 #define OPT_NO_MT       "disable-multithreading"
+#define OPT_THREADS     "threads"
 
 typedef struct range
 {
@@ -189,6 +192,9 @@ typedef struct samdump_opts
 
     size_t cursor_cache_size;
 
+    /* how many threads dump slices of the references and ranges of unaligned rows */
+    uint32_t threads;
+
     /* how the sam-headers are treated */
     enum header_mode header_mode;
 
@@ -243,6 +249,9 @@ typedef struct samdump_opts
 
     /* option to disable multi-threading */
     bool no_mt;
+
+    /* where the records are appended to, see sam-out.h */
+    sam_out * out;
     
     uint8_t qual_quant_matrix[ 256 ];
 } samdump_opts;
@@ -39,6 +39,11 @@
 #include "out_redir.h"
 #include "sam-aligned.h"
 #include "sam-unaligned.h"
+#include "sam-parallel.h"
+#include "sam-out.h"
+
+/* how much of the record-output is collected before it is handed to the output-file */
+#define SAM_OUT_BUFFER_SIZE ( 256 * 1024 )
 
 
 char const *sd_unaligned_usage[]      = { "Output unaligned reads along with aligned reads",
@@ -151,6 +156,9 @@ char const *sd_no_mate_cache_usage[]  = { "do not use a mate-cache, slower but l
 char const *rna_splice_usage[]        = { "modify cigar-string and output flags if rna-splicing detected",
                                        NULL };
 
+char const *sd_threads_usage[]        = { "number of threads dumping slices of references and unaligned rows, default 1",
+                                       NULL };
+
 char const *no_mt_usage[]             = { "disable multithreading", NULL };                                       
                                       
 OptDef SamDumpArgs[] =
@@ -193,6 +201,7 @@ OptDef SamDumpArgs[] =
     { OPT_NO_MATE_CACHE,NULL, NULL, sd_no_mate_cache_usage,  0, false, false },  /* do not use mate-cache */
     { OPT_RNA_SPLICE,   NULL, NULL, rna_splice_usage,        0, false, false },  /* detect rna-splicing in sequence */
     { OPT_NO_MT,        NULL, NULL, no_mt_usage,              0, false, false },   /* force new code-path */    
+    { OPT_THREADS,      NULL, NULL, sd_threads_usage,        0, true,  false },  /* dump in parallel on this many threads */
     { OPT_DUMP_MODE,    NULL, NULL, NULL,                    0, true,  false },  /* how to produce aligned reads if no regions given */
     { OPT_CIGAR_TEST,   NULL, NULL, NULL,                    0, true,  false },  /* test cg-treatment of cigar string */
     { OPT_LEGACY,       NULL, NULL, NULL,                    0, false, false },  /* force legacy code-path */
@@ -239,6 +248,7 @@ char const *sd_usage_params[] =
     NULL,                       /* no mate-cache */
     NULL,                       /* detect rna-splicing in sequence */
     NULL,                       /* no-mt */    
+    "count",                    /* threads */
     NULL,                       /* dump_mode */
     NULL,                       /* cigar test */
     NULL,                       /* force legacy code path */
@@ -384,22 +394,36 @@ static rc_t print_samdump( const samdump_opts * const opts )
                             /* ------------------------------------------------------ */
 
 
-                            /* print output of aligned reads */
-                            if ( rc == 0 && 
-                                 ifs->database_count > 0 && 
-                                 !opts->dump_unaligned_only )
-                            /* ------------------------------------------------------ */
-                                rc = print_aligned_spots( opts, ifs, mc, &rows_so_far ); /* sam-aligned.c */
-                            /* ------------------------------------------------------ */
-
-
-                            /* print output of unaligned reads */
-                            if ( rc == 0 )
+                            if ( rc == 0 && use_parallel_dump( opts, ifs ) )
                             {
+                                /* print output of aligned and unaligned reads on opts->threads threads */
                                 /* ------------------------------------------------------ */
-                                rc = print_unaligned_spots( opts, ifs, mc, &rows_so_far ); /* sam-unaligned.c */
+                                rc = print_parallel_spots( opts, mgr, ifs, reflist_opt ); /* sam-parallel.c */
                                 /* ------------------------------------------------------ */
                             }
+                            else
+                            {
+                                /* print output of aligned reads */
+                                if ( rc == 0 && 
+                                     ifs->database_count > 0 && 
+                                     !opts->dump_unaligned_only )
+                                /* ------------------------------------------------------ */
+                                    rc = print_aligned_spots( opts, ifs, mc, &rows_so_far ); /* sam-aligned.c */
+                                /* ------------------------------------------------------ */
+
+
+                                /* print output of unaligned reads */
+                                if ( rc == 0 )
+                                {
+                                    /* ------------------------------------------------------ */
+                                    rc = print_unaligned_spots( opts, ifs, mc, &rows_so_far ); /* sam-unaligned.c */
+                                    /* ------------------------------------------------------ */
+                                }
+                            }
+
+                            /* the cache-report is not part of the records */
+                            if ( rc == 0 )
+                                rc = sam_out_flush( opts->out ); /* sam-out.c */
 
                             if ( opts->use_mate_cache )
                             {
@@ -447,7 +471,7 @@ static rc_t perform_cigar_test( const samdump_opts * const opts )
 
 /* =========================================================================================== */
 
-static rc_t samdump_main( Args * args, const samdump_opts * const opts )
+static rc_t samdump_main( Args * args, samdump_opts * const opts )
 {
     rc_t rc = 0;
     out_redir redir; /* from out_redir.h */
@@ -481,9 +505,22 @@ static rc_t samdump_main( Args * args, const samdump_opts * const opts )
             }
             else
             {
+                sam_out out; /* from sam-out.h */
+
+                rc = init_sam_out( &out, SAM_OUT_BUFFER_SIZE ); /* from sam-out.c */
+                if ( rc == 0 )
+                {
+                    rc_t rc2;
+
+                    opts->out = &out;
             /* ------------------------------------------------------ */
-                rc = print_samdump( opts );
+                    rc = print_samdump( opts );
             /* ------------------------------------------------------ */
+                    rc2 = release_sam_out( &out ); /* from sam-out.c */
+                    if ( rc == 0 )
+                        rc = rc2;
+                    opts->out = NULL;
+                }
             }
         }
         release_out_redir( &redir ); /* from out_redir.c */
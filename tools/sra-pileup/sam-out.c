@@ -0,0 +1,205 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include "sam-out.h"
+
+#include <sysalloc.h>
+#include <stdlib.h>
+#include <string.h>
+
+rc_t init_sam_out( sam_out * self, size_t size )
+{
+    rc_t rc = 0;
+    self->buffer = malloc( size );
+    if ( self->buffer == NULL )
+    {
+        rc = RC( rcExe, rcBuffer, rcConstructing, rcMemory, rcExhausted );
+        self->size = 0;
+    }
+    else
+        self->size = size;
+    self->used = 0;
+    self->limit = size;
+    self->wait = NULL;
+    self->wait_data = NULL;
+    self->rc = rc;
+    self->grow = false;
+    return rc;
+}
+
+
+rc_t init_sam_chunk( sam_out * self, size_t size, size_t limit,
+                     rc_t ( * wait )( void * data ), void * data )
+{
+    rc_t rc = init_sam_out( self, size );
+    self->limit = ( limit > size ) ? limit : size;
+    self->wait = wait;
+    self->wait_data = data;
+    self->grow = true;
+    return rc;
+}
+
+
+rc_t release_sam_out( sam_out * self )
+{
+    rc_t rc = sam_out_flush( self );
+    free( self->buffer );
+    self->buffer = NULL;
+    self->size = 0;
+    return rc;
+}
+
+
+static rc_t sam_out_write( sam_out * self, const char * s, size_t len )
+{
+    KWrtWriter writer = KOutWriterGet();
+    if ( self->rc == 0 && writer != NULL )
+    {
+        size_t num_writ;
+        self->rc = writer( KOutDataGet(), s, len, &num_writ );
+    }
+    return self->rc;
+}
+
+
+rc_t sam_out_flush( sam_out * self )
+{
+    if ( self->used > 0 )
+    {
+        sam_out_write( self, self->buffer, self->used );
+        self->used = 0;
+    }
+    return self->rc;
+}
+
+
+static rc_t sam_out_grow( sam_out * self, size_t needed )
+{
+    size_t size = ( self->size > 0 ) ? self->size : 4096;
+    char * buffer;
+
+    while ( size < needed )
+        size *= 2;
+    if ( size > self->limit && needed <= self->limit )
+        size = self->limit;
+    buffer = realloc( self->buffer, size );
+    if ( buffer == NULL )
+        self->rc = RC( rcExe, rcBuffer, rcResizing, rcMemory, rcExhausted );
+    else
+    {
+        self->buffer = buffer;
+        self->size = size;
+    }
+    return self->rc;
+}
+
+
+static rc_t sam_out_append( sam_out * self, const char * s, size_t len )
+{
+    if ( self->used + len > self->size && self->grow && self->rc == 0 )
+    {
+        if ( self->used + len <= self->limit || self->wait == NULL )
+            sam_out_grow( self, self->used + len );
+        else
+        {
+            /* the chunk is full: wait until it can be written */
+            self->rc = self->wait( self->wait_data );
+            self->grow = false;
+        }
+    }
+    if ( self->used + len > self->size && !self->grow )
+    {
+        sam_out_flush( self );
+        /* does not fit even into the empty buffer: write it directly */
+        if ( len > self->size )
+            return sam_out_write( self, s, len );
+    }
+    if ( self->rc == 0 )
+    {
+        memmove( &self->buffer[ self->used ], s, len );
+        self->used += len;
+    }
+    return self->rc;
+}
+
+
+rc_t sam_out_str( sam_out * self, const char * s, size_t len )
+{
+    const char * nul;
+
+    if ( s == NULL )
+        return sam_out_append( self, "NULL", len < 4 ? len : 4 );
+    nul = memchr( s, 0, len );
+    if ( nul != NULL )
+        len = ( nul - s );
+    return sam_out_append( self, s, len );
+}
+
+
+rc_t sam_out_cstr( sam_out * self, const char * s )
+{
+    if ( s == NULL )
+        s = "NULL";
+    return sam_out_append( self, s, strlen( s ) );
+}
+
+
+rc_t sam_out_char( sam_out * self, char c )
+{
+    if ( self->used < self->size && self->rc == 0 )
+    {
+        self->buffer[ self->used++ ] = c;
+        return 0;
+    }
+    return sam_out_append( self, &c, 1 );
+}
+
+
+rc_t sam_out_u64( sam_out * self, uint64_t value )
+{
+    char digits[ 24 ];
+    size_t idx = sizeof digits;
+
+    do
+    {
+        digits[ --idx ] = ( char )( '0' + ( value % 10 ) );
+        value /= 10;
+    } while ( value != 0 );
+    return sam_out_append( self, &digits[ idx ], sizeof digits - idx );
+}
+
+
+rc_t sam_out_i64( sam_out * self, int64_t value )
+{
+    rc_t rc;
+
+    if ( value >= 0 )
+        return sam_out_u64( self, ( uint64_t )value );
+    rc = sam_out_char( self, '-' );
+    if ( rc == 0 )
+        rc = sam_out_u64( self, ( uint64_t )0 - ( uint64_t )value );
+    return rc;
+}
@@ -0,0 +1,90 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+#ifndef _h_sam_out_
+#define _h_sam_out_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#if 0
+}
+#endif
+
+#include <klib/out.h>
+#include <klib/rc.h>
+#include <klib/defs.h>
+
+/* the record-builder: SAM/FASTX records are appended field by field
+   into this buffer, which is handed to the KOut-writer ( see out_redir.h )
+   in large blocks, instead of going through KOutMsg() for every field.
+   The first write-error sticks: every following call returns it, so a
+   record can be appended without checking each field */
+typedef struct sam_out
+{
+    char * buffer;
+    size_t size;
+    size_t used;
+    size_t limit;
+    rc_t ( * wait )( void * data );
+    void * wait_data;
+    rc_t rc;
+    bool grow;
+} sam_out;
+
+
+rc_t init_sam_out( sam_out * self, size_t size );
+
+/* a chunk collects records in memory: the buffer grows up to limit instead of
+   being flushed, the owner hands it to the KOut-writer later with sam_out_flush().
+   A full chunk calls wait( data ), which returns once nothing can be written
+   ahead of the chunk any more: from then on it is flushed like an output */
+rc_t init_sam_chunk( sam_out * self, size_t size, size_t limit,
+                     rc_t ( * wait )( void * data ), void * data );
+
+/* flushes what is left, and frees the buffer */
+rc_t release_sam_out( sam_out * self );
+
+/* hands the buffered bytes to the KOut-writer */
+rc_t sam_out_flush( sam_out * self );
+
+/* same as KOutMsg( "%.*s", len, s ): stops at a NUL-terminator, NULL prints as "NULL" */
+rc_t sam_out_str( sam_out * self, const char * s, size_t len );
+
+/* same as KOutMsg( "%s", s ) */
+rc_t sam_out_cstr( sam_out * self, const char * s );
+
+rc_t sam_out_char( sam_out * self, char c );
+
+/* decimal numbers: callers cast to the type the former format-string used,
+   for instance "%u" becomes sam_out_u64( self, ( uint32_t )value ) */
+rc_t sam_out_u64( sam_out * self, uint64_t value );
+rc_t sam_out_i64( sam_out * self, int64_t value );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,431 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include "sam-parallel.h"
+#include "sam-aligned.h"
+#include "sam-unaligned.h"
+#include "matecache.h"
+
+#include <kapp/main.h>
+
+#include <kproc/thread.h>
+#include <kproc/ordered-queue.h>
+
+#include <sysalloc.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+    parallel dump:
+    * a producer-thread cuts the references into slices of SLICE_BASES bases
+      and the SEQUENCE-table into ranges of SLICE_ROWS rows ( a job each )
+    * every worker-thread has its own input-files ( cursors ) and its own mate-cache,
+      it dumps a whole job into the sam_out-chunk of the job
+    * the main thread writes the chunks in the order the producer created them
+    * a chunk that reaches CHUNK_LIMIT waits until the main thread waits for it,
+      then the worker writes the rest of the job itself: a circular reference is
+      one job, it does not build up in memory
+
+    a slice prints the alignments that start in it, the same way print_aligned_spots()
+    does for a whole reference, the mate-cache is only a shortcut: whatever is not in the
+    cache of a worker is looked up in the tables
+*/
+
+#define SLICE_BASES ( 256 * 1024 )
+#define SLICE_ROWS ( 32 * 1024 )
+#define CHUNK_SIZE ( 64 * 1024 )
+#define CHUNK_LIMIT ( 4 * 1024 * 1024 )
+
+enum job_type
+{
+    jt_aligned = 0,     /* a slice of a reference */
+    jt_unaligned        /* a range of rows of the SEQUENCE-table */
+};
+
+typedef struct samdump_job
+{
+    KOrderedItem dad;           /* done once the job is printed */
+    enum job_type job_type;
+    uint32_t db_idx;
+    uint32_t ref_idx;
+    INSDC_coord_zero ref_pos;
+    INSDC_coord_len ref_len;
+    int64_t first_row;
+    uint64_t row_count;
+    struct samdump_parallel * par;
+    sam_out out;
+    rc_t rc;
+} samdump_job;
+
+typedef struct samdump_parallel
+{
+    const samdump_opts * opts;
+    const input_files * ifs;    /* only the producer uses it */
+    KOrderedQueue *queue;       /* jobs waiting for a worker, written in output-order */
+} samdump_parallel;
+
+typedef struct samdump_worker
+{
+    samdump_parallel *par;
+    KThread *thread;
+    samdump_opts opts;          /* a copy, opts.out points to the chunk of the current job */
+    input_files *ifs;
+    matecache *mc;
+} samdump_worker;
+
+
+bool use_parallel_dump( const samdump_opts * const opts, const input_files * const ifs )
+{
+    return ( opts->threads > 1 &&
+             !opts->no_mt &&
+             opts->region_count == 0 &&
+             opts->test_rows == 0 &&
+             !opts->report_cache &&
+             opts->dump_mode == dm_one_ref_at_a_time &&
+             ifs->database_count > 0 &&
+             ifs->table_count == 0 );
+}
+
+
+/* the chunk of the job is full: everything before the job has to be written first */
+static rc_t wait_for_head( void * data )
+{
+    samdump_job * job = data;
+    return KOrderedQueueHeadWait( job->par->queue, &job->dad );
+}
+
+
+static samdump_job * make_job( samdump_parallel * par, enum job_type job_type, uint32_t db_idx )
+{
+    samdump_job * job = calloc( 1, sizeof *job );
+    if ( job != NULL )
+    {
+        if ( init_sam_chunk( &job->out, CHUNK_SIZE, CHUNK_LIMIT, wait_for_head, job ) == 0 )
+        {
+            job->par = par;
+            job->job_type = job_type;
+            job->db_idx = db_idx;
+            return job;
+        }
+        free( job );
+    }
+    return NULL;
+}
+
+
+static void whack_job( samdump_job * job )
+{
+    free( job->out.buffer );
+    free( job );
+}
+
+
+static void CC whack_job_item( KOrderedItem * item, void * data )
+{
+    whack_job( ( samdump_job * )item );
+}
+
+
+static rc_t submit_job( samdump_parallel * par, samdump_job * job )
+{
+    return KOrderedQueueSubmit( par->queue, &job->dad, true );
+}
+
+
+/* the slices of one reference, a circular reference is not sliced */
+static rc_t produce_aligned_jobs( samdump_parallel * par, uint32_t db_idx, uint32_t ref_idx,
+                                  const ReferenceObj * ref_obj )
+{
+    INSDC_coord_len ref_len;
+    bool circular;
+    rc_t rc = ReferenceObj_SeqLength( ref_obj, &ref_len );
+    if ( rc == 0 )
+        rc = ReferenceObj_Circular( ref_obj, &circular );
+    if ( rc != 0 )
+    {
+        (void)LOGERR( klogErr, rc, "cannot read length of reference" );
+    }
+    else
+    {
+        INSDC_coord_len step = circular ? ref_len : SLICE_BASES;
+        INSDC_coord_zero pos = 0;
+        do
+        {
+            samdump_job * job = make_job( par, jt_aligned, db_idx );
+            if ( job == NULL )
+                rc = RC( rcExe, rcNoTarg, rcAllocating, rcMemory, rcExhausted );
+            else
+            {
+                job->ref_idx = ref_idx;
+                job->ref_pos = pos;
+                job->ref_len = ( ref_len - pos < step ) ? ref_len - pos : step;
+                rc = submit_job( par, job );
+            }
+            pos += step;
+        } while ( rc == 0 && !KOrderedQueueQuitting( par->queue ) && ( INSDC_coord_len )pos < ref_len );
+    }
+    return rc;
+}
+
+
+static rc_t produce_unaligned_jobs( samdump_parallel * par, uint32_t db_idx )
+{
+    int64_t first_row;
+    uint64_t row_count;
+    rc_t rc = unaligned_row_range( par->opts, par->ifs, db_idx, &first_row, &row_count ); /* sam-unaligned.c */
+    while ( rc == 0 && !KOrderedQueueQuitting( par->queue ) && row_count > 0 )
+    {
+        samdump_job * job = make_job( par, jt_unaligned, db_idx );
+        if ( job == NULL )
+            rc = RC( rcExe, rcNoTarg, rcAllocating, rcMemory, rcExhausted );
+        else
+        {
+            job->first_row = first_row;
+            job->row_count = ( row_count < SLICE_ROWS ) ? row_count : SLICE_ROWS;
+            first_row += job->row_count;
+            row_count -= job->row_count;
+            rc = submit_job( par, job );
+        }
+    }
+    return rc;
+}
+
+
+/* the same order as print_all_aligned_spots_0() followed by print_unaligned_spots() */
+static rc_t CC produce_jobs( const KThread *self, void *data )
+{
+    samdump_parallel * par = data;
+    const samdump_opts * opts = par->opts;
+    const input_files * ifs = par->ifs;
+    uint32_t db_idx;
+    rc_t rc = 0;
+
+    if ( !opts->dump_unaligned_only )
+    {
+        for ( db_idx = 0; db_idx < ifs->database_count && rc == 0 && !KOrderedQueueQuitting( par->queue ); ++db_idx )
+        {
+            const input_database * ids = VectorGet( &ifs->dbs, db_idx );
+            if ( ids != NULL )
+            {
+                uint32_t refobj_count;
+                rc = ReferenceList_Count( ids->reflist, &refobj_count );
+                if ( rc == 0 && refobj_count > 0 )
+                {
+                    uint32_t ref_idx;
+                    for ( ref_idx = 0; ref_idx < refobj_count && rc == 0 && !KOrderedQueueQuitting( par->queue ); ++ref_idx )
+                    {
+                        const ReferenceObj * ref_obj;
+                        rc = ReferenceList_Get( ids->reflist, &ref_obj, ref_idx );
+                        if ( rc == 0 && ref_obj != NULL )
+                        {
+                            rc = produce_aligned_jobs( par, db_idx, ref_idx, ref_obj );
+                            ReferenceObj_Release( ref_obj );
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    if ( opts->dump_unaligned_reads || opts->dump_unaligned_only )
+    {
+        for ( db_idx = 0; db_idx < ifs->database_count && rc == 0 && !KOrderedQueueQuitting( par->queue ); ++db_idx )
+            rc = produce_unaligned_jobs( par, db_idx );
+    }
+
+    KOrderedQueueSeal( par->queue );
+    return rc;
+}
+
+
+static rc_t CC work_on_jobs( const KThread *self, void *data )
+{
+    samdump_worker * w = data;
+    KOrderedItem * item;
+
+    while ( KOrderedQueueWork( w->par->queue, &item ) == 0 && item != NULL )
+    {
+        samdump_job * job = ( samdump_job * )item;
+        uint64_t rows_so_far = 0;
+
+        if ( KOrderedQueueQuitting( w->par->queue ) )
+            job->rc = RC( rcExe, rcNoTarg, rcExecuting, rcProcess, rcCanceled );
+        else
+        {
+            w->opts.out = &job->out;
+            if ( job->job_type == jt_aligned )
+                job->rc = print_aligned_slice( &w->opts, w->ifs, w->mc, job->db_idx, job->ref_idx,
+                                               job->ref_pos, job->ref_len, &rows_so_far ); /* sam-aligned.c */
+            else
+                job->rc = print_unaligned_rows( &w->opts, w->ifs, w->mc, job->db_idx,
+                                                job->first_row, job->row_count, &rows_so_far ); /* sam-unaligned.c */
+            if ( job->rc == 0 )
+                job->rc = job->out.rc;
+            w->opts.out = NULL;
+        }
+        KOrderedQueueDone( w->par->queue, item );
+    }
+    return 0;
+}
+
+
+/* the input-files are opened on the calling thread, the reference-lists
+   of the workers have their own cursors */
+static rc_t prepare_worker( samdump_worker * w, samdump_parallel * par, const VDBManager * const mgr,
+                            uint32_t reflist_options )
+{
+    rc_t rc;
+
+    w->par = par;
+    w->opts = *( par->opts );
+    w->opts.out = NULL;
+    rc = discover_input_files( &w->ifs, mgr, par->opts->input_files, reflist_options ); /* inputfiles.c */
+    if ( rc != 0 )
+        w->ifs = NULL;
+    else if ( w->ifs->database_count != par->ifs->database_count )
+    {
+        rc = RC( rcExe, rcFile, rcOpening, rcItem, rcNotFound );
+        (void)LOGERR( klogErr, rc, "input object(s) not found" );
+    }
+    else if ( par->opts->use_mate_cache )
+        rc = make_matecache( &w->mc, w->ifs->database_count ); /* matecache.c */
+    return rc;
+}
+
+
+static void release_worker( samdump_worker * w )
+{
+    if ( w->mc != NULL )
+        release_matecache( w->mc );
+    if ( w->ifs != NULL )
+        release_input_files( w->ifs );
+}
+
+
+rc_t print_parallel_spots( const samdump_opts * const opts, const VDBManager * const mgr,
+                           const input_files * const ifs, uint32_t reflist_options )
+{
+    samdump_parallel par;
+    samdump_worker * workers;
+    KThread * producer = NULL;
+    uint32_t i, started = 0, threads = opts->threads;
+    rc_t rc;
+
+    /* the header is already in opts->out, the chunks are written behind it */
+    rc = sam_out_flush( opts->out ); /* sam-out.c */
+    if ( rc != 0 )
+        return rc;
+
+    memset( &par, 0, sizeof par );
+    par.opts = opts;
+    par.ifs = ifs;
+
+    workers = calloc( threads, sizeof *workers );
+    if ( workers == NULL )
+        return RC( rcExe, rcNoTarg, rcAllocating, rcMemory, rcExhausted );
+
+    /* the order-queue limits how many finished chunks wait in memory */
+    rc = KOrderedQueueMake( &par.queue, threads, threads * 2, whack_job_item, NULL );
+    if ( rc != 0 )
+    {
+        (void)LOGERR( klogErr, rc, "creating the thread-queues failed" );
+    }
+
+    for ( i = 0; i < threads && rc == 0; ++i )
+        rc = prepare_worker( &workers[ i ], &par, mgr, reflist_options );
+
+    if ( rc == 0 )
+    {
+        for ( i = 0; i < threads && rc == 0; ++i )
+        {
+            rc = KThreadMake( &workers[ i ].thread, work_on_jobs, &workers[ i ] );
+            if ( rc != 0 )
+            {
+                (void)LOGERR( klogErr, rc, "KThreadMake() failed" );
+            }
+            else
+                started++;
+        }
+        if ( rc == 0 )
+        {
+            rc = KThreadMake( &producer, produce_jobs, &par );
+            if ( rc != 0 )
+            {
+                (void)LOGERR( klogErr, rc, "KThreadMake() failed" );
+            }
+        }
+
+        if ( rc == 0 )
+        {
+            /* what was printed before an error is written too, as the serial dump does */
+            KOrderedItem * item;
+            while ( KOrderedQueueNext( par.queue, &item ) == 0 && item != NULL )
+            {
+                samdump_job * job = ( samdump_job * )item;
+                if ( rc == 0 )
+                {
+                    rc = sam_out_flush( &job->out );
+                    if ( rc == 0 )
+                        rc = job->rc;
+                    if ( rc == 0 )
+                        rc = Quitting();
+                    if ( rc != 0 )
+                        KOrderedQueueQuit( par.queue );
+                }
+                whack_job( job );
+            }
+        }
+        else
+        {
+            KOrderedQueueQuit( par.queue );
+            KOrderedQueueSeal( par.queue );
+        }
+
+        if ( producer != NULL )
+        {
+            rc_t rc1;
+            KThreadWait( producer, &rc1 );
+            KThreadRelease( producer );
+            if ( rc == 0 )
+                rc = rc1;
+        }
+        for ( i = 0; i < started; ++i )
+        {
+            KThreadWait( workers[ i ].thread, NULL );
+            KThreadRelease( workers[ i ].thread );
+        }
+    }
+
+    for ( i = 0; i < threads; ++i )
+    {
+        if ( workers[ i ].par != NULL )
+            release_worker( &workers[ i ] );
+    }
+    free( workers );
+
+    KOrderedQueueRelease( par.queue );
+    return rc;
+}
@@ -0,0 +1,54 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _h_sam_parallel_
+#define _h_sam_parallel_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#if 0
+}
+#endif
+
+#include "sam-dump-opts.h"
+#include "inputfiles.h"
+
+/* can the aligned and unaligned reads be dumped by print_parallel_spots()?
+   not if only one thread is requested, or if the options need the state of
+   the whole run: regions, test-rows, the cache-report, all references at once
+   or legacy tables as input */
+bool use_parallel_dump( const samdump_opts * const opts, const input_files * const ifs );
+
+/* dumps the aligned reads in slices of the references and the unaligned reads
+   in ranges of the SEQUENCE-rows on opts->threads threads, every thread opens
+   the input-files again ( own cursors ) and has its own mate-cache.
+   The output of the slices is written in the same order as print_aligned_spots()
+   and print_unaligned_spots() would produce it */
+rc_t print_parallel_spots( const samdump_opts * const opts, const VDBManager * const mgr,
+                           const input_files * const ifs, uint32_t reflist_options );
+
+#endif
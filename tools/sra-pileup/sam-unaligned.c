@@ -353,14 +353,14 @@ static rc_t get_mate_info( const prim_table_ctx * const ptx, const matecache * c
 }
 
 
-static rc_t print_sliced_read( const INSDC_dna_text * read, uint32_t read_idx,
+static rc_t print_sliced_read( const samdump_opts * const opts, const INSDC_dna_text * read, uint32_t read_idx,
                                bool reverse, const INSDC_coord_zero * read_start, const INSDC_coord_len * read_len )
 {
     rc_t rc = 0;
     const INSDC_dna_text * ptr = read + read_start[ read_idx ];
     if ( !reverse )
     {
-        rc = KOutMsg( "%.*s", read_len[ read_idx ], ptr );
+        rc = sam_out_str( opts->out, ptr, read_len[ read_idx ] );
     }
     else
     {
@@ -384,7 +384,7 @@ static rc_t print_sliced_read( const INSDC_dna_text * read, uint32_t read_idx,
                      c = cmp_tbl [ c - 'A' ];
             }
 
-            rc = KOutMsg( "%c", ( char ) c );
+            rc = sam_out_char( opts->out, ( char ) c );
             i--;
         }
     }
@@ -400,8 +400,8 @@ static rc_t print_sliced_quality( const samdump_opts * const opts, const char *
 }
 
 
-static rc_t dump_the_other_read( const seq_table_ctx * const stx, const prim_table_ctx * const ptx,
-                                 const int64_t row_id, const uint32_t mate_idx )
+static rc_t dump_the_other_read( const samdump_opts * const opts, const seq_table_ctx * const stx,
+                                 const prim_table_ctx * const ptx, const int64_t row_id, const uint32_t mate_idx )
 {
     uint32_t row_len;
     const int64_t *prim_al_id_ptr;
@@ -424,7 +424,7 @@ static rc_t dump_the_other_read( const seq_table_ctx * const stx, const prim_tab
             int64_t a_row_id = prim_al_id_ptr[ mate_idx ];
             if ( a_row_id == 0 )
             {
-                rc = KOutMsg( "*\t0\t" );
+                rc = sam_out_cstr( opts->out, "*\t0\t" );
             }
             else
             {
@@ -443,7 +443,10 @@ static rc_t dump_the_other_read( const seq_table_ctx * const stx, const prim_tab
                         rc = read_INSDC_coord_zero_ptr( a_row_id, ptx->cursor, ptx->ref_pos_idx, &ref_pos, &row_len, "REF_POS" );
                         if ( rc == 0 )
                         {
-                            rc = KOutMsg( "%.*s\t%i\t", ref_name_len, ref_name, ref_pos[ 0 ] + 1 );
+                            sam_out_str( opts->out, ref_name, ref_name_len );
+                            sam_out_char( opts->out, '\t' );
+                            sam_out_i64( opts->out, ref_pos[ 0 ] + 1 );
+                            rc = sam_out_char( opts->out, '\t' );
                         }
                     }
                 }
@@ -592,7 +595,10 @@ static rc_t dump_seq_row_sam_filtered( const samdump_opts * const opts, const se
 
                             /* SAM-FIELD: QNAME     SRA-column: SPOT_ID ( int64 ) */
                             if ( rc == 0 )
-                                rc = KOutMsg( "%ld\t", seq_spot_id );
+                            {
+                                sam_out_i64( opts->out, seq_spot_id );
+                                rc = sam_out_char( opts->out, '\t' );
+                            }
 
                             if ( rc == 0 && read_type == NULL )
                                 rc = read_read_type( stx, row_id, &read_type, nreads );
@@ -608,7 +614,8 @@ static rc_t dump_seq_row_sam_filtered( const samdump_opts * const opts, const se
                             {
                                 uint32_t sam_flags = calculate_unaligned_sam_flags_db( nreads, read_idx, mate_idx, 
                                                                                     align_id, read_type, reverse, read_filter );
-                                rc = KOutMsg( "%u\t", sam_flags );
+                                sam_out_u64( opts->out, sam_flags );
+                                rc = sam_out_char( opts->out, '\t' );
                             }
 
                             /* SAM-FIELD: RNAME     SRA-column: none, fix '*' */
@@ -616,16 +623,21 @@ static rc_t dump_seq_row_sam_filtered( const samdump_opts * const opts, const se
                             /* SAM-FIELD: MAPQ      SRA-column: none, fix '0' */
                             /* SAM-FIELD: CIGAR     SRA-column: none, fix '*' */
                             if ( rc == 0 )
-                                rc = KOutMsg( "*\t0\t0\t*\t" );
+                                rc = sam_out_cstr( opts->out, "*\t0\t0\t*\t" );
 
                             /* SAM-FIELD: RNEXT     SRA-column: found in cache */
                             /* SAM-FIELD: POS       SRA-column: found in cache */
                             if ( rc == 0 )
-                                rc = KOutMsg( "%s\t%li\t", mate_ref_name, mate_ref_pos + 1 );
+                            {
+                                sam_out_cstr( opts->out, mate_ref_name );
+                                sam_out_char( opts->out, '\t' );
+                                sam_out_i64( opts->out, mate_ref_pos + 1 );
+                                rc = sam_out_char( opts->out, '\t' );
+                            }
 
                             /* SAM-FIELD: TLEN      SRA-column: none, fix '0' */
                             if ( rc == 0 )
-                                rc = KOutMsg( "0\t" );
+                                rc = sam_out_cstr( opts->out, "0\t" );
 
                             if ( rc == 0 && read == NULL )
                                 rc = read_INSDC_dna_text_ptr( row_id, stx->cursor, stx->read_idx, &read, &rd_len, "READ" );
@@ -636,9 +648,9 @@ static rc_t dump_seq_row_sam_filtered( const samdump_opts * const opts, const se
 
                             /* SAM-FIELD: SEQ       SRA-column: READ, sliced by READ_START/READ_LEN */
                             if ( rc == 0 )
-                                rc = print_sliced_read( read, read_idx, reverse, read_start, read_len );
+                                rc = print_sliced_read( opts, read, read_idx, reverse, read_start, read_len );
                             if ( rc == 0 )
-                                rc = KOutMsg( "\t" );
+                                rc = sam_out_char( opts->out, '\t' );
 
                             /* SAM-FIELD: QUAL      SRA-column: QUALITY, sliced by READ_START/READ_LEN */
                             if ( rc == 0 )
@@ -646,16 +658,22 @@ static rc_t dump_seq_row_sam_filtered( const samdump_opts * const opts, const se
 
                             /* OPT SAM-FIIELD:      SRA-column: ALIGN_ID */
                             if ( rc == 0 && opts->print_alignment_id_in_column_xi )
-                                rc = KOutMsg( "\tXI:i:%u", row_id );
+                            {
+                                sam_out_cstr( opts->out, "\tXI:i:" );
+                                rc = sam_out_u64( opts->out, ( uint32_t )row_id );
+                            }
 
                             /* OPT SAM-FIIELD:      SRA-column: SPOT_GROUP */
                             if ( rc == 0 && spot_group == NULL )
                                 rc = read_char_ptr( row_id, stx->cursor, stx->spot_group_idx, &spot_group, &spot_group_len, "SPOT_GROUP" );
                             if ( rc == 0 && spot_group_len > 0 )
-                                rc = KOutMsg( "\tRG:Z:%.*s", spot_group_len, spot_group );
+                            {
+                                sam_out_cstr( opts->out, "\tRG:Z:" );
+                                rc = sam_out_str( opts->out, spot_group, spot_group_len );
+                            }
 
                             if ( rc == 0 )
-                                rc = KOutMsg( "\n" );
+                                rc = sam_out_char( opts->out, '\n' );
 
                             if ( rc == 0 )
                                 (*printed)++;
@@ -725,7 +743,10 @@ static rc_t dump_seq_prim_row_sam( const samdump_opts * const opts, const seq_ta
 
             /* SAM-FIELD: QNAME     SRA-column: SPOT_ID ( int64 ) */
             if ( rc == 0 )
-                rc = KOutMsg( "%ld\t", row_id );
+            {
+                sam_out_i64( opts->out, row_id );
+                rc = sam_out_char( opts->out, '\t' );
+            }
 
             /* SAM-FIELD: FLAG      SRA-column: calculated from READ_TYPE, READ_FILTER etc. */
             if ( rc == 0 )
@@ -745,7 +766,8 @@ static rc_t dump_seq_prim_row_sam( const samdump_opts * const opts, const seq_ta
                     else
                         sam_flags = 0x04;
                 }
-                rc = KOutMsg( "%u\t", sam_flags );
+                sam_out_u64( opts->out, sam_flags );
+                rc = sam_out_char( opts->out, '\t' );
             }
 
             /* SAM-FIELD: RNAME     SRA-column: none, fix '*' */
@@ -753,7 +775,7 @@ static rc_t dump_seq_prim_row_sam( const samdump_opts * const opts, const seq_ta
             /* SAM-FIELD: MAPQ      SRA-column: none, fix '0' */
             /* SAM-FIELD: CIGAR     SRA-column: none, fix '*' */
             if ( rc == 0 )
-                rc = KOutMsg( "*\t0\t0\t*\t" );
+                rc = sam_out_cstr( opts->out, "*\t0\t0\t*\t" );
 
             /* SAM-FIELD: RNEXT     SRA-column: look up in cache, or none */
             /* SAM-FIELD: POS       SRA-column: look up in cache, or none */
@@ -761,7 +783,7 @@ static rc_t dump_seq_prim_row_sam( const samdump_opts * const opts, const seq_ta
             {
                 if ( ptx == NULL )
                 {
-                    rc = KOutMsg( "0\t0\t" );   /* no way to get that without PRIM_ALIGN-table */
+                    rc = sam_out_cstr( opts->out, "0\t0\t" );   /* no way to get that without PRIM_ALIGN-table */
                 }
                 else
                 {
@@ -773,12 +795,17 @@ static rc_t dump_seq_prim_row_sam( const samdump_opts * const opts, const seq_ta
 
                         rc = get_mate_info( ptx, mc, ids, row_id, mate_id, nreads, &mate_ref_name, &mate_ref_name_len, &mate_ref_pos );
                         if ( rc == 0 )
-                            rc = KOutMsg( "%.*s\t%li\t", mate_ref_name_len, mate_ref_name, mate_ref_pos );
+                        {
+                            sam_out_str( opts->out, mate_ref_name, mate_ref_name_len );
+                            sam_out_char( opts->out, '\t' );
+                            sam_out_i64( opts->out, mate_ref_pos );
+                            rc = sam_out_char( opts->out, '\t' );
+                        }
                     }
                     else
                     {
                         /* print the mate info */
-                        rc = dump_the_other_read( stx, ptx, row_id, mate_idx );
+                        rc = dump_the_other_read( opts, stx, ptx, row_id, mate_idx );
                     }
                 }
             }
@@ -786,7 +813,7 @@ static rc_t dump_seq_prim_row_sam( const samdump_opts * const opts, const seq_ta
 
             /* SAM-FIELD: TLEN      SRA-column: none, fix '0' */
             if ( rc == 0 )
-                rc = KOutMsg( "0\t" );
+                rc = sam_out_cstr( opts->out, "0\t" );
 
             if ( rc == 0 && read == NULL )
                 rc = read_INSDC_dna_text_ptr( row_id, stx->cursor, stx->read_idx, &read, &rd_len, "READ" );
@@ -795,9 +822,9 @@ static rc_t dump_seq_prim_row_sam( const samdump_opts * const opts, const seq_ta
 
             /* SAM-FIELD: SEQ       SRA-column: READ, sliced by READ_START/READ_LEN */
             if ( rc == 0 )
-                rc = print_sliced_read( read, read_idx, reverse, read_start, read_len );
+                rc = print_sliced_read( opts, read, read_idx, reverse, read_start, read_len );
             if ( rc == 0 )
-                rc = KOutMsg( "\t" );
+                rc = sam_out_char( opts->out, '\t' );
 
             if ( rc == 0 && quality == NULL )
                 rc = read_quality( stx, row_id, &quality, rd_len );
@@ -808,16 +835,22 @@ static rc_t dump_seq_prim_row_sam( const samdump_opts * const opts, const seq_ta
 
             /* OPT SAM-FIIELD:      SRA-column: ALIGN_ID */
             if ( rc == 0 && opts->print_alignment_id_in_column_xi )
-                rc = KOutMsg( "\tXI:i:%u", row_id );
+            {
+                sam_out_cstr( opts->out, "\tXI:i:" );
+                rc = sam_out_u64( opts->out, ( uint32_t )row_id );
+            }
 
             /* OPT SAM-FIIELD:      SRA-column: SPOT_GROUP */
             if ( rc == 0 && spot_group == NULL )
                 rc = read_char_ptr( row_id, stx->cursor, stx->spot_group_idx, &spot_group, &spot_group_len, "SPOT_GROUP" );
             if ( rc == 0 && spot_group_len > 0 )
-                rc = KOutMsg( "\tRG:Z:%.*s", spot_group_len, spot_group );
+            {
+                sam_out_cstr( opts->out, "\tRG:Z:" );
+                rc = sam_out_str( opts->out, spot_group, spot_group_len );
+            }
 
             if ( rc == 0 )
-                rc = KOutMsg( "\n" );
+                rc = sam_out_char( opts->out, '\n' );
 
             if ( rc == 0 )
                 (*printed)++;
@@ -878,9 +911,15 @@ static rc_t dump_seq_row_sam( const samdump_opts * const opts, const seq_table_c
             if ( rc == 0 )
             {
                 if ( name != NULL && name_len > 0 )
-                    rc = KOutMsg( "%.*s\t", name_len, name );
+                {
+                    sam_out_str( opts->out, name, name_len );
+                    rc = sam_out_char( opts->out, '\t' );
+                }
                 else
-                    rc = KOutMsg( "%lu\t", row_id );
+                {
+                    sam_out_u64( opts->out, row_id );
+                    rc = sam_out_char( opts->out, '\t' );
+                }
             }
 
             /* SAM-FIELD: FLAG      SRA-column: calculated from READ_TYPE, READ_FILTER etc. */
@@ -888,7 +927,8 @@ static rc_t dump_seq_row_sam( const samdump_opts * const opts, const seq_table_c
             {
                 uint32_t sam_flags = calculate_unaligned_sam_flags_db( nreads, read_idx, mate_idx, 
                                             0, read_type, reverse, read_filter );
-                rc = KOutMsg( "%u\t", sam_flags );
+                sam_out_u64( opts->out, sam_flags );
+                rc = sam_out_char( opts->out, '\t' );
             }
 
             /* SAM-FIELD: RNAME     SRA-column: none, fix '*' */
@@ -900,7 +940,7 @@ static rc_t dump_seq_row_sam( const samdump_opts * const opts, const seq_table_c
             /* SAM-FIELD: TLEN      SRA-column: none, fix '0' */
 
             if ( rc == 0 )
-                rc = KOutMsg( "*\t0\t0\t*\t*\t0\t0\t" );
+                rc = sam_out_cstr( opts->out, "*\t0\t0\t*\t*\t0\t0\t" );
 
             if ( rc == 0 && read == NULL )
                 rc = read_INSDC_dna_text_ptr( row_id, stx->cursor, stx->read_idx, &read, &rd_len, "READ" );
@@ -909,9 +949,9 @@ static rc_t dump_seq_row_sam( const samdump_opts * const opts, const seq_table_c
 
             /* SAM-FIELD: SEQ       SRA-column: READ, sliced by READ_START/READ_LEN */
             if ( rc == 0 )
-                rc = print_sliced_read( read, read_idx, reverse, read_start, read_len );
+                rc = print_sliced_read( opts, read, read_idx, reverse, read_start, read_len );
             if ( rc == 0 )
-                rc = KOutMsg( "\t" );
+                rc = sam_out_char( opts->out, '\t' );
 
             if ( rc == 0 && quality == NULL )
                 rc = read_quality( stx, row_id, &quality, rd_len );
@@ -922,16 +962,22 @@ static rc_t dump_seq_row_sam( const samdump_opts * const opts, const seq_table_c
 
             /* OPT SAM-FIIELD:      SRA-column: ALIGN_ID */
             if ( rc == 0 && opts->print_alignment_id_in_column_xi )
-                rc = KOutMsg( "\tXI:i:%u", row_id );
+            {
+                sam_out_cstr( opts->out, "\tXI:i:" );
+                rc = sam_out_u64( opts->out, ( uint32_t )row_id );
+            }
 
             /* OPT SAM-FIIELD:      SRA-column: SPOT_GROUP */
             if ( rc == 0 && spot_group == NULL )
                 rc = read_char_ptr( row_id, stx->cursor, stx->spot_group_idx, &spot_group, &spot_group_len, "SPOT_GROUP" );
             if ( rc == 0 && ( spot_group != NULL ) && ( spot_group_len > 0 ) )
-                rc = KOutMsg( "\tRG:Z:%.*s", spot_group_len, spot_group );
+            {
+                sam_out_cstr( opts->out, "\tRG:Z:" );
+                rc = sam_out_str( opts->out, spot_group, spot_group_len );
+            }
 
             if ( rc == 0 )
-                rc = KOutMsg( "\n" );
+                rc = sam_out_char( opts->out, '\n' );
 
             if ( rc == 0 )
                 (*printed)++;
@@ -980,9 +1026,9 @@ static rc_t dump_seq_row_fastx_filtered( const samdump_opts * const opts, const
 
                     /* the NAME */
                     if ( opts->output_format == of_fastq )
-                        rc = KOutMsg( "@" );
+                        rc = sam_out_char( opts->out, '@' );
                     else
-                        rc = KOutMsg( ">" );
+                        rc = sam_out_char( opts->out, '>' );
 
                     if ( rc == 0 )
                     {
@@ -991,7 +1037,11 @@ static rc_t dump_seq_row_fastx_filtered( const samdump_opts * const opts, const
                         if ( rc == 0 )
                             rc = dump_name( opts, seq_spot_id, spot_group, spot_group_len ); /* sam-dump-opts.c */
                         if ( rc == 0 )
-                            rc = KOutMsg( "/%u unaligned\n", read_idx + 1 );
+                        {
+                            sam_out_char( opts->out, '/' );
+                            sam_out_u64( opts->out, read_idx + 1 );
+                            rc = sam_out_cstr( opts->out, " unaligned\n" );
+                        }
                     }
 
                     if ( rc == 0 && read == NULL )
@@ -1007,18 +1057,18 @@ static rc_t dump_seq_row_fastx_filtered( const samdump_opts * const opts, const
 
                     /* the READ */
                     if ( rc == 0 )
-                        rc = print_sliced_read( read, read_idx, reverse, read_start, read_len );
+                        rc = print_sliced_read( opts, read, read_idx, reverse, read_start, read_len );
                     if ( rc == 0 )
-                        rc = KOutMsg( "\n" );
+                        rc = sam_out_char( opts->out, '\n' );
 
                     /* in case of fastq : the QUALITY-line */
                     if ( rc == 0 && opts->output_format == of_fastq )
                     {
-                        rc = KOutMsg( "+\n" );
+                        rc = sam_out_cstr( opts->out, "+\n" );
                         if ( rc == 0 )
                             rc = print_sliced_quality( opts, quality, read_idx, reverse, read_start, read_len );
                         if ( rc == 0 )
-                            rc = KOutMsg( "\n" );
+                            rc = sam_out_char( opts->out, '\n' );
                     }
                     (*printed)++;
                 }
@@ -1060,9 +1110,9 @@ static rc_t dump_seq_row_fastx( const samdump_opts * const opts, const seq_table
 
             /* the NAME */
             if ( opts->output_format == of_fastq )
-                rc = KOutMsg( "@" );
+                rc = sam_out_char( opts->out, '@' );
             else
-                rc = KOutMsg( ">" );
+                rc = sam_out_char( opts->out, '>' );
             if ( rc == 0 )
             {
                 if ( opts->print_spot_group_in_name && spot_group == NULL )
@@ -1070,7 +1120,11 @@ static rc_t dump_seq_row_fastx( const samdump_opts * const opts, const seq_table
                 if ( rc == 0 )
                     rc = dump_name( opts, row_id, spot_group, spot_group_len ); /* sam-dump-opts.c */
                 if ( rc == 0 )
-                    rc = KOutMsg( "/%u unaligned\n", read_idx + 1 );
+                {
+                    sam_out_char( opts->out, '/' );
+                    sam_out_u64( opts->out, read_idx + 1 );
+                    rc = sam_out_cstr( opts->out, " unaligned\n" );
+                }
             }
 
             if ( rc == 0 && read == NULL )
@@ -1086,18 +1140,18 @@ static rc_t dump_seq_row_fastx( const samdump_opts * const opts, const seq_table
 
             /* the READ */
             if ( rc == 0 )
-                rc = print_sliced_read( read, read_idx, reverse, read_start, read_len );
+                rc = print_sliced_read( opts, read, read_idx, reverse, read_start, read_len );
             if ( rc == 0 )
-                rc = KOutMsg( "\n" );
+                rc = sam_out_char( opts->out, '\n' );
 
             /* in case of fastq : the QUALITY-line */
             if ( rc == 0 && opts->output_format == of_fastq )
             {
-                rc = KOutMsg( "+\n" );
+                rc = sam_out_cstr( opts->out, "+\n" );
                 if ( rc == 0 )
                     rc = print_sliced_quality( opts, quality, read_idx, reverse, read_start, read_len );
                 if ( rc == 0 )
-                    rc = KOutMsg( "\n" );
+                    rc = sam_out_char( opts->out, '\n' );
             }
             (*printed)++;
         }
@@ -1133,9 +1187,9 @@ static rc_t dump_seq_tab_row_fastx( const samdump_opts * const opts, const seq_t
 
             /* the NAME */
             if ( opts->output_format == of_fastq )
-                rc = KOutMsg( "@" );
+                rc = sam_out_char( opts->out, '@' );
             else
-                rc = KOutMsg( ">" );
+                rc = sam_out_char( opts->out, '>' );
             if ( rc == 0 )
             {
                 if ( opts->print_spot_group_in_name && spot_group == NULL )
@@ -1145,7 +1199,11 @@ static rc_t dump_seq_tab_row_fastx( const samdump_opts * const opts, const seq_t
                     rc = dump_name_legacy( opts, name, name_len, spot_group, spot_group_len ); /* sam-dump-opts.c */
 
                 if ( rc == 0 )
-                    rc = KOutMsg( "/%u unaligned\n", read_idx + 1 );
+                {
+                    sam_out_char( opts->out, '/' );
+                    sam_out_u64( opts->out, read_idx + 1 );
+                    rc = sam_out_cstr( opts->out, " unaligned\n" );
+                }
             }
 
             if ( rc == 0 && read == NULL )
@@ -1159,9 +1217,9 @@ static rc_t dump_seq_tab_row_fastx( const samdump_opts * const opts, const seq_t
 
             /* the READ */
             if ( rc == 0 )
-                rc = print_sliced_read( read, read_idx, reverse, read_start, read_len );
+                rc = print_sliced_read( opts, read, read_idx, reverse, read_start, read_len );
             if ( rc == 0 )
-                rc = KOutMsg( "\n" );
+                rc = sam_out_char( opts->out, '\n' );
 
             /* in case of fastq : the QUALITY-line */
             if ( rc == 0 && opts->output_format == of_fastq )
@@ -1169,11 +1227,11 @@ static rc_t dump_seq_tab_row_fastx( const samdump_opts * const opts, const seq_t
                 if ( quality == NULL )
                     rc = read_quality( stx, row_id, &quality, rd_len );
                 if ( rc == 0 )
-                    rc = KOutMsg( "+\n" );
+                    rc = sam_out_cstr( opts->out, "+\n" );
                 if ( rc == 0 )
                     rc = print_sliced_quality( opts, quality, read_idx, reverse, read_start, read_len );
                 if ( rc == 0 )
-                    rc = KOutMsg( "\n" );
+                    rc = sam_out_char( opts->out, '\n' );
             }
             (*printed)++;
         }
@@ -1312,10 +1370,27 @@ static rc_t print_unaligned_database_filtered( const samdump_opts * const opts,
 }
 
 
-/* we are printing from a sra-database, we print all unaligned read we can find */
+/* narrows first/count down to the rows that are also in win_first ... win_first + win_count - 1 */
+static void clip_row_range( int64_t * first, uint64_t * count, int64_t win_first, uint64_t win_count )
+{
+    int64_t end = *first + *count;
+    int64_t win_end = win_first + win_count;
+
+    if ( *first < win_first )
+        *first = win_first;
+    if ( end > win_end )
+        end = win_end;
+    *count = ( end > *first ) ? ( end - *first ) : 0;
+}
+
+
+/* we are printing from a sra-database, we print all unaligned read we can find,
+   if win_count is not zero only the ones in the rows win_first ... win_first + win_count - 1 */
 static rc_t print_unaligned_database_full( const samdump_opts * const opts, const input_table * const seq,
                                            const input_table * const prim, const matecache * const mc,
-                                           const input_database * const ids, uint64_t * const rows_so_far )
+                                           const input_database * const ids,
+                                           int64_t win_first, uint64_t win_count,
+                                           uint64_t * const rows_so_far )
 {
     seq_table_ctx stx;
     rc_t rc = prepare_seq_table_ctx( opts, seq, &stx, ( prim == NULL ) );
@@ -1343,6 +1418,9 @@ static rc_t print_unaligned_database_full( const samdump_opts * const opts, cons
                 else
                 {
                     seq_row row;
+
+                    if ( win_count > 0 )
+                        clip_row_range( &first_row, &row_count, win_first, win_count );
                     for ( row_id = first_row; ( ( row_id - first_row ) < row_count ) && rc == 0 && !test_limit_reached( opts, *rows_so_far ); ++row_id )
                     {
                         rc = Quitting();
@@ -1420,6 +1498,48 @@ static rc_t print_unaligned_table( const samdump_opts * const opts, const input_
 }
 
 
+/* opens the SEQUENCE and PRIMARY_ALIGNMENT tables of this database and prints the unaligned reads,
+   a win_count of zero means all rows */
+static rc_t print_unaligned_database( const samdump_opts * const opts, const input_database * const ids,
+                                      const matecache * const mc, int64_t win_first, uint64_t win_count,
+                                      uint64_t * const rows_so_far )
+{
+    input_table seq;
+    rc_t rc;
+
+    seq.path = ids->path;
+    rc = VDatabaseOpenTableRead( ids->db, &seq.tab, "SEQUENCE" );
+    if ( rc != 0 )
+    {
+        (void)PLOGERR( klogInt, ( klogInt, rc, "cannot open table SEQUENCE for $(tn)", "tn=%s", ids->path ) );
+    }
+    else
+    {
+        input_table prim;
+        prim.path = ids->path;
+        rc = VDatabaseOpenTableRead( ids->db, &prim.tab, "PRIMARY_ALIGNMENT" );
+        if ( rc != 0 )
+        {
+            (void)PLOGERR( klogInt, ( klogInt, rc, "cannot open table PRIMARY_ALIGNMENT $(tn)", "tn=%s", ids->path ) );
+        }
+        else
+        {
+            if ( opts->region_count > 0 )
+            {
+                rc = print_unaligned_database_filtered( opts, &seq, &prim, mc, ids, rows_so_far );
+            }
+            else
+            {
+                rc = print_unaligned_database_full( opts, &seq, &prim, mc, ids, win_first, win_count, rows_so_far );
+            }
+            VTableRelease( prim.tab );
+        }
+        VTableRelease( seq.tab );
+    }
+    return rc;
+}
+
+
 /* entry point from sam-dump3.c */
 rc_t print_unaligned_spots( const samdump_opts * const opts, const input_files * const ifs,
                             const matecache * const mc, uint64_t * const rows_so_far )
@@ -1432,39 +1552,7 @@ rc_t print_unaligned_spots( const samdump_opts * const opts, const input_files *
         {
             const input_database * ids = VectorGet( &ifs->dbs, db_idx );
             if ( ids != NULL )
-            {
-                input_table seq;
-
-                seq.path = ids->path;
-                rc = VDatabaseOpenTableRead( ids->db, &seq.tab, "SEQUENCE" );
-                if ( rc != 0 )
-                {
-                    (void)PLOGERR( klogInt, ( klogInt, rc, "cannot open table SEQUENCE for $(tn)", "tn=%s", ids->path ) );
-                }
-                else
-                {
-                    input_table prim;
-                    prim.path = ids->path;
-                    rc = VDatabaseOpenTableRead( ids->db, &prim.tab, "PRIMARY_ALIGNMENT" );
-                    if ( rc != 0 )
-                    {
-                        (void)PLOGERR( klogInt, ( klogInt, rc, "cannot open table PRIMARY_ALIGNMENT $(tn)", "tn=%s", ids->path ) );
-                    }
-                    else
-                    {
-                        if ( opts->region_count > 0 )
-                        {
-                            rc = print_unaligned_database_filtered( opts, &seq, &prim, mc, ids, rows_so_far );
-                        }
-                        else
-                        {
-                            rc = print_unaligned_database_full( opts, &seq, &prim, mc, ids, rows_so_far );
-                        }
-                        VTableRelease( prim.tab );
-                    }
-                    VTableRelease( seq.tab );
-                }
-            }
+                rc = print_unaligned_database( opts, ids, mc, 0, 0, rows_so_far );
         }
     }
 
@@ -1480,3 +1568,57 @@ rc_t print_unaligned_spots( const samdump_opts * const opts, const input_files *
     }
     return rc;
 }
+
+
+/* entry point from sam-parallel.c: the rows of the SEQUENCE-table of this database */
+rc_t unaligned_row_range( const samdump_opts * const opts, const input_files * const ifs, uint32_t db_idx,
+                          int64_t * const first_row, uint64_t * const row_count )
+{
+    const input_database * ids = VectorGet( &ifs->dbs, db_idx );
+    rc_t rc = 0;
+
+    *first_row = 0;
+    *row_count = 0;
+    if ( ids != NULL )
+    {
+        input_table seq;
+
+        seq.path = ids->path;
+        rc = VDatabaseOpenTableRead( ids->db, &seq.tab, "SEQUENCE" );
+        if ( rc != 0 )
+        {
+            (void)PLOGERR( klogInt, ( klogInt, rc, "cannot open table SEQUENCE for $(tn)", "tn=%s", ids->path ) );
+        }
+        else
+        {
+            seq_table_ctx stx;
+            rc = prepare_seq_table_ctx( opts, &seq, &stx, false );
+            if ( rc == 0 )
+            {
+                rc = VCursorOpen( stx.cursor );
+                if ( rc == 0 )
+                    rc = VCursorIdRange( stx.cursor, stx.read_type_idx, first_row, row_count );
+                if ( rc != 0 )
+                {
+                    (void)PLOGERR( klogInt, ( klogInt, rc, "VCursorIdRange( SEQUENCE ) for $(tn) failed", "tn=%s", seq.path ) );
+                }
+                VCursorRelease( stx.cursor );
+            }
+            VTableRelease( seq.tab );
+        }
+    }
+    return rc;
+}
+
+
+/* entry point from sam-parallel.c: the unaligned reads in row_count rows starting at first_row */
+rc_t print_unaligned_rows( const samdump_opts * const opts, const input_files * const ifs,
+                           const matecache * const mc, uint32_t db_idx,
+                           int64_t first_row, uint64_t row_count, uint64_t * const rows_so_far )
+{
+    const input_database * ids = VectorGet( &ifs->dbs, db_idx );
+    rc_t rc = 0;
+    if ( ids != NULL && row_count > 0 )
+        rc = print_unaligned_database( opts, ids, mc, first_row, row_count, rows_so_far );
+    return rc;
+}
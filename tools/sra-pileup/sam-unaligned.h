@@ -40,4 +40,11 @@ extern "C" {
 rc_t print_unaligned_spots( const samdump_opts * const opts, const input_files * const ifs,
                             const matecache * const mc, uint64_t * const rows_so_far );
 
+rc_t unaligned_row_range( const samdump_opts * const opts, const input_files * const ifs, uint32_t db_idx,
+                          int64_t * const first_row, uint64_t * const row_count );
+
+rc_t print_unaligned_rows( const samdump_opts * const opts, const input_files * const ifs,
+                           const matecache * const mc, uint32_t db_idx,
+                           int64_t first_row, uint64_t row_count, uint64_t * const rows_so_far );
+
 #endif
\ No newline at end of file
@@ -43,6 +43,7 @@
 #include <kfs/buffile.h>
 #include <kfs/bzip.h>
 #include <kfs/gzip.h>
+#include <kfs/pzip.h>
 
 #include <insdc/sra.h>
 
@@ -555,7 +556,8 @@ static rc_t CC BufferedWriter ( void* self, const char* buffer, size_t bufsize,
 }
 
 
-static rc_t set_stdout_to( bool gzip, bool bzip2, const char * filename, size_t bufsize )
+static rc_t set_stdout_to( bool gzip, bool bzip2, uint32_t zip_threads,
+                           const char * filename, size_t bufsize )
 {
     rc_t rc = 0;
     if ( gzip && bzip2 )
@@ -577,28 +579,36 @@ static rc_t set_stdout_to( bool gzip, bool bzip2, const char * filename, size_t
             if ( rc == 0 )
             {
                 KFile *buf;
-                if ( gzip )
+                KParZipPool *pool = NULL;
+                if ( gzip || bzip2 )
+                {
+                    /* the writer keeps its own reference to the pool */
+                    rc = KParZipPoolMake( &pool, zip_threads );
+                }
+                if ( rc == 0 && gzip )
                 {
                     KFile *gz;
-                    rc = KFileMakeGzipForWrite( &gz, of );
+                    rc = KFileMakeParallelGzipForWrite( &gz, of, 0, pool );
                     if ( rc == 0 )
                     {
                         KFileRelease( of );
                         of = gz;
                     }
                 }
-                if ( bzip2 )
+                if ( rc == 0 && bzip2 )
                 {
                     KFile *bz;
-                    rc = KFileMakeBzip2ForWrite( &bz, of );
+                    rc = KFileMakeParallelBzip2ForWrite( &bz, of, 0, pool );
                     if ( rc == 0 )
                     {
                         KFileRelease( of );
                         of = bz;
                     }
                 }
+                KParZipPoolRelease( pool );
 
-                rc = KBufFileMakeWrite( &buf, of, false, bufsize );
+                if ( rc == 0 )
+                    rc = KBufFileMakeWrite( &buf, of, false, bufsize );
                 if ( rc == 0 )
                 {
                     g_out_writer.kfile = buf;
@@ -2835,6 +2845,7 @@ rc_t CC KMain( int argc, char *argv [] )
                     {
                         rc = set_stdout_to( options.cmn.gzip_output,
                                             options.cmn.bzip_output,
+                                            options.cmn.zip_threads,
                                             options.cmn.output_file,
                                             32 * 1024 );
                     }
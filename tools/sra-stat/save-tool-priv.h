@@ -0,0 +1,63 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _h_sra_stat_save_tool_priv_
+#define _h_sra_stat_save_tool_priv_
+
+#ifndef _h_klib_defs_
+#include <klib/defs.h>
+#endif
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* SaveTool
+ *  a child process that reads its standard input
+ */
+typedef struct SaveTool SaveTool;
+
+/* Run
+ *  start "tool" with a single argument "param"
+ *
+ *  "in" [ OUT ] - stream into the standard input of the tool
+ */
+rc_t SaveToolRun(SaveTool** self, const char* tool, const char* param,
+    FILE** in);
+
+/* Wait
+ *  close the stream and wait for the tool to exit.
+ *  returns non-zero rc unless it exited successfully
+ */
+rc_t SaveToolWait(SaveTool* self);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*  _h_sra_stat_save_tool_priv_ */
@@ -0,0 +1,405 @@
+/*==============================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+
+/* sra-stat-save
+ *  stores statistics computed by "sra-stat --save-stats" into table metadata.
+ *
+ *  sra-stat reads the table with the read-only library and runs this
+ *  helper, linked with the read/write library, only when it was asked to
+ *  save. the statistics come on stdin, one tab-separated line per node:
+ *
+ *    TABLE <spots> <bases> <bio-bases> <cmp-bases>
+ *    GROUP <spots> <bases> <bio-bases> <cmp-bases> <spot-group>
+ *
+ *  nothing is written unless the whole input is read and understood.
+ */
+
+#include "sra-stat-save.vers.h"
+
+#include <kapp/main.h>
+
+#include <vdb/manager.h> /* VDBManager */
+#include <vdb/database.h> /* VDatabase */
+#include <vdb/table.h> /* VTableOpenMetadataUpdate */
+
+#include <kdb/meta.h> /* KMetadata */
+
+#include <klib/printf.h>
+#include <klib/log.h>
+#include <klib/out.h>
+#include <klib/rc.h>
+
+#include <strtol.h> /* strtou64 */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#define DISP_RC(rc, msg) (void)((rc == 0) ? 0 : LOGERR(klogInt, rc, msg))
+
+#define DISP_RC2(rc, name, msg) (void)((rc == 0) ? 0 : \
+    PLOGERR(klogInt, (klogInt, rc, \
+        "$(name): $(msg)", "name=%s,msg=%s", name, msg)))
+
+#define RELEASE(type, obj) do { rc_t rc2 = type##Release(obj); \
+    if (rc2 && !rc) { rc = rc2; } obj = NULL; } while (false)
+
+/* longest spot group name sra-stat can have */
+#define MAX_GROUP 1024
+
+typedef struct SaveNode {
+    uint64_t spot_count;
+    uint64_t base_count;
+    uint64_t bio_base_count;
+    uint64_t cmp_base_count;
+    char* spot_group; /* NULL for the table */
+} SaveNode;
+
+typedef struct SaveInput {
+    SaveNode table;
+    bool hasTable;
+    SaveNode* group;
+    uint32_t groupN;
+    uint32_t groupMax;
+} SaveInput;
+
+static
+void SaveInputWhack(SaveInput* self)
+{
+    uint32_t i = 0;
+    assert(self);
+    for (i = 0; i < self->groupN; ++i) {
+        free(self->group[i].spot_group);
+    }
+    free(self->group);
+    memset(self, 0, sizeof *self);
+}
+
+/* parse 4 counters separated by tabs, return the rest of the line */
+static
+const char* parse_counts(const char* p, SaveNode* node)
+{
+    uint64_t* v[4];
+    uint32_t i = 0;
+
+    v[0] = &node->spot_count;
+    v[1] = &node->base_count;
+    v[2] = &node->bio_base_count;
+    v[3] = &node->cmp_base_count;
+
+    for (i = 0; i < sizeof v / sizeof v[0]; ++i) {
+        char* end = NULL;
+        if (*p != '\t' || p[1] < '0' || p[1] > '9') {
+            return NULL;
+        }
+        *v[i] = strtou64(p + 1, &end, 10);
+        p = end;
+    }
+
+    return p;
+}
+
+static
+rc_t SaveInputRead(SaveInput* self, FILE* in)
+{
+    char line[MAX_GROUP + 256];
+    uint32_t n = 0;
+
+    assert(self && in);
+
+    while (fgets(line, sizeof line, in) != NULL) {
+        size_t len = strlen(line);
+        const char* p = NULL;
+        SaveNode node;
+
+        ++n;
+        memset(&node, 0, sizeof node);
+
+        if (len == 0 || line[len - 1] != '\n') {
+            break;
+        }
+        line[--len] = '\0';
+
+        if (strncmp(line, "TABLE", 5) == 0 && !self->hasTable) {
+            p = parse_counts(line + 5, &node);
+            if (p == NULL || *p != '\0') {
+                break;
+            }
+            self->table = node;
+            self->hasTable = true;
+        }
+        else if (strncmp(line, "GROUP", 5) == 0) {
+            p = parse_counts(line + 5, &node);
+            if (p == NULL || *p != '\t') {
+                break;
+            }
+            node.spot_group = strdup(p + 1);
+            if (node.spot_group == NULL) {
+                return RC(rcExe, rcStorage, rcAllocating, rcMemory, rcExhausted);
+            }
+            if (self->groupN == self->groupMax) {
+                uint32_t max = self->groupMax == 0 ? 64 : self->groupMax * 2;
+                void* tmp = realloc(self->group, max * sizeof *self->group);
+                if (tmp == NULL) {
+                    free(node.spot_group);
+                    return RC(rcExe, rcStorage, rcAllocating, rcMemory, rcExhausted);
+                }
+                self->group = tmp;
+                self->groupMax = max;
+            }
+            self->group[self->groupN++] = node;
+        }
+        else {
+            break;
+        }
+    }
+
+    if (ferror(in) || !feof(in) || !self->hasTable) {
+        rc_t rc = RC(rcExe, rcFile, rcReading, rcData, rcInvalid);
+        PLOGERR(klogErr, (klogErr, rc,
+            "bad statistics at line $(n) of the input", "n=%u", n));
+        return rc;
+    }
+
+    return 0;
+}
+
+static
+rc_t save_node(KMetadata* meta, const char* path,
+    const char* name, const SaveNode* v)
+{
+    rc_t rc = 0;
+    KMDataNode* node = NULL;
+
+    assert(meta && path && v);
+
+    rc = KMetadataOpenNodeUpdate(meta, &node, "%s", path);
+    DISP_RC2(rc, path, "while calling KMetadataOpenNodeUpdate");
+
+    if (rc == 0 && name != NULL) {
+        rc = KMDataNodeWriteAttr(node, "name", name);
+        DISP_RC2(rc, path, "while calling KMDataNodeWriteAttr(name)");
+    }
+    if (rc == 0) {
+        struct {
+            const char* name;
+            uint64_t value;
+        } child[4];
+        uint32_t i = 0;
+
+        child[0].name = "SPOT_COUNT";
+        child[0].value = v->spot_count;
+        child[1].name = "BASE_COUNT";
+        child[1].value = v->base_count;
+        child[2].name = "BIO_BASE_COUNT";
+        child[2].value = v->bio_base_count;
+        child[3].name = "CMP_BASE_COUNT";
+        child[3].value = v->cmp_base_count;
+
+        for (i = 0; i < sizeof child / sizeof child[0] && rc == 0; ++i) {
+            KMDataNode* c = NULL;
+            rc = KMDataNodeOpenNodeUpdate(node, &c, "%s", child[i].name);
+            if (rc == 0) {
+                rc = KMDataNodeWriteB64(c, &child[i].value);
+                RELEASE(KMDataNode, c);
+            }
+            if (rc != 0) {
+                PLOGERR(klogInt, (klogInt, rc, "while writing $(path)/$(name)",
+                    "path=%s,name=%s", path, child[i].name));
+            }
+        }
+    }
+
+    RELEASE(KMDataNode, node);
+
+    return rc;
+}
+
+static
+rc_t save_group(KMetadata* meta, const SaveNode* v)
+{
+    rc_t rc = 0;
+    char path[MAX_GROUP + 64];
+    bool unsafe = false;
+    const char* name = v->spot_group;
+
+    assert(meta && v && v->spot_group);
+
+    /* the same node names as created by the loaders (libs/sraxf/stats.c):
+       empty group is "default", '/' is replaced by '\\' */
+    if (name[0] == '\0') {
+        name = "default";
+    }
+    rc = string_printf(path, sizeof path, NULL, "STATS/SPOT_GROUP/%s", name);
+    if (rc == 0) {
+        char* p = path + sizeof "STATS/SPOT_GROUP/" - 1;
+        for ( ; *p != '\0'; ++p) {
+            if (*p == '/') {
+                *p = '\\';
+                unsafe = true;
+            }
+        }
+        rc = save_node(meta, path, unsafe ? name : NULL, v);
+    }
+
+    return rc;
+}
+
+static
+rc_t run(const char* table_path, const SaveInput* in)
+{
+    rc_t rc = 0;
+    VDBManager* mgr = NULL;
+    VDatabase* db = NULL;
+    VTable* tbl = NULL;
+    KMetadata* meta = NULL;
+
+    assert(table_path && in);
+
+    rc = VDBManagerMakeUpdate(&mgr, NULL);
+    DISP_RC(rc, "while calling VDBManagerMakeUpdate");
+    if (rc == 0) {
+        /* the statistics of a database are kept in its SEQUENCE table */
+        rc = VDBManagerOpenTableUpdate(mgr, &tbl, NULL, "%s", table_path);
+        if (rc != 0) {
+            rc = VDBManagerOpenDBUpdate(mgr, &db, NULL, "%s", table_path);
+            if (rc == 0) {
+                rc = VDatabaseOpenTableUpdate(db, &tbl, "SEQUENCE");
+            }
+        }
+        DISP_RC2(rc, table_path, "while opening table for update");
+    }
+    if (rc == 0) {
+        rc = VTableOpenMetadataUpdate(tbl, &meta);
+        DISP_RC2(rc, table_path, "while calling VTableOpenMetadataUpdate");
+    }
+    if (rc == 0) {
+        rc = save_node(meta, "STATS/TABLE", NULL, &in->table);
+    }
+    if (rc == 0) {
+        uint32_t i = 0;
+        for (i = 0; i < in->groupN && rc == 0; ++i) {
+            rc = save_group(meta, &in->group[i]);
+        }
+    }
+
+    RELEASE(KMetadata, meta);
+    RELEASE(VTable, tbl);
+    RELEASE(VDatabase, db);
+    RELEASE(VDBManager, mgr);
+
+    return rc;
+}
+
+/* Version  EXTERN
+ *  return 4-part version code: 0xMMmmrrrr, where
+ *      MM = major release
+ *      mm = minor release
+ *    rrrr = bug-fix release
+ */
+ver_t CC KAppVersion ( void )
+{
+    return SRA_STAT_SAVE_VERS;
+}
+
+rc_t CC UsageSummary (const char * progname)
+{
+    return KOutMsg (
+        "\n"
+        "Usage:\n"
+        "  %s table < statistics\n"
+        "\n"
+        "Summary:\n"
+        "  Store statistics computed by sra-stat --save-stats into table metadata.\n"
+        "  It is run by sra-stat and is not meant to be run directly.\n"
+        "\n", progname);
+}
+
+const char UsageDefaultName[] = "sra-stat-save";
+rc_t CC Usage (const Args * args)
+{
+    const char * progname = UsageDefaultName;
+    const char * fullpath = UsageDefaultName;
+    rc_t rc;
+
+    if (args == NULL)
+        rc = RC (rcApp, rcArgv, rcAccessing, rcSelf, rcNull);
+    else
+        rc = ArgsProgram (args, &fullpath, &progname);
+    if (rc)
+        progname = fullpath = UsageDefaultName;
+
+    UsageSummary (progname);
+
+    KOutMsg ("Options:\n");
+    HelpOptionsStandard ();
+    HelpVersion (fullpath, KAppVersion());
+    return rc;
+}
+
+rc_t CC KMain ( int argc, char *argv [] )
+{
+    Args* args = NULL;
+    rc_t rc = 0;
+
+    rc = ArgsMakeAndHandle(&args, argc, argv, 0);
+    if (rc == 0) {
+        uint32_t pcount = 0;
+        const char* table_path = NULL;
+
+        rc = ArgsParamCount (args, &pcount);
+        if (rc == 0 && pcount != 1) {
+            MiniUsage (args);
+            rc = RC(rcExe, rcArgv, rcParsing, rcParam, rcInsufficient);
+        }
+        if (rc == 0) {
+            rc = ArgsParamValue (args, 0, &table_path);
+        }
+        if (rc == 0) {
+            SaveInput in;
+            memset(&in, 0, sizeof in);
+
+            rc = SaveInputRead(&in, stdin);
+            if (rc == 0) {
+                rc = run(table_path, &in);
+            }
+
+            SaveInputWhack(&in);
+        }
+
+        {
+            rc_t rc2 = ArgsWhack(args);
+            if (rc == 0)
+            {   rc = rc2; }
+        }
+    }
+
+    return rc;
+}
+
+/* EOF */
@@ -25,6 +25,7 @@
 */
 
 #include "sra-stat.vers.h"
+#include "save-tool-priv.h"
 
 #include <kapp/main.h>
 
@@ -46,6 +47,8 @@
 #include <kfs/directory.h>
 #include <kfs/file.h>
 
+#include <kproc/thread.h> /* KThread */
+
 #include <klib/sort.h> /* ksort */
 #include <klib/checksum.h>
 #include <klib/container.h>
@@ -81,6 +84,12 @@
 
 #define MAX_NREADS 2*1024
 
+/* do not split a table into ranges shorter than this between threads */
+#define MIN_SPOTS_PER_THREAD 4096
+
+/* upper limit of --threads */
+#define MAX_THREADS 64
+
 /*********** XMLLogger_Encode : copied from kapp/log-xml.c (-lload) ***********/
 
 static
@@ -572,6 +581,35 @@ static double StatisticsStdev(const Statistics* self) {
     return sqrt(self->q / self->n);
 }
 
+static void StatisticsMerge(Statistics* self, const Statistics* other) {
+    double delta = 0;
+    int64_t n = 0;
+
+    /* pairwise update of mean and Q: Chan, Golub, LeVeque (1979) */
+
+    assert(self && other);
+
+    if (other->n == 0) {
+        return;
+    }
+    if (self->n == 0) {
+        *self = *other;
+        return;
+    }
+
+    if (other->variable || self->prev_val != other->prev_val) {
+        self->variable = true;
+    }
+
+    n = self->n + other->n;
+    delta = other->a - self->a;
+
+    self->q += other->q
+        + delta * delta * ((double)self->n * other->n / n);
+    self->a += delta * other->n / n;
+    self->n = n;
+}
+
 static
 void SraStatsTotalAdd(SraStatsTotal* self,
     uint32_t* values, uint32_t nreads)
@@ -740,9 +778,13 @@ typedef struct srastat_parms {
     bool test; /* test stdev */
 
     spotid_t start, stop;
+    uint32_t threads; /* number of threads scanning the table */
+    bool save_stats; /* store scanned statistics into table metadata */
+    char save_tool[4096]; /* path of sra-stat-save when save_stats */
 
     bool hasSPOT_GROUP;
     bool variableReadLength;
+    bool scannedAll; /* sra_stat has scanned all the spots of the table */
 
     SraStatsTotal total; /* is used in srastat_print */
 } srastat_parms;
@@ -2352,106 +2394,191 @@ int CC srastats_sort ( const BSTNode *item, const BSTNode *n )
     return srastats_cmp(ss->spot_group,n);
 }
 
-static
-rc_t sra_stat(srastat_parms* pb, const SRATable* tbl,
-    BSTree* tr, SraStatsTotal* total)
-{
-    rc_t rc = 0;
-
 /*  const char CMP_READ  [] = "CMP_READ"; */
-    const char PRIMARY_ALIGNMENT_ID[] = "PRIMARY_ALIGNMENT_ID";
-    const char RD_FILTER [] = "RD_FILTER";
-    const char READ_LEN  [] = "READ_LEN";
-    const char READ_TYPE [] = "READ_TYPE";
-    const char SPOT_GROUP[] = "SPOT_GROUP";
-
-/*  const SRAColumn* cCMP_READ = NULL; */
-    const SRAColumn* cPRIMARY_ALIGNMENT_ID = NULL;
-    const SRAColumn* cRD_FILTER = NULL;
-    const SRAColumn* cREAD_LEN = NULL;
-    const SRAColumn* cREAD_TYPE = NULL;
-    const SRAColumn* cSPOT_GROUP = NULL;
-
-    int g_nreads = 0;
-    spotid_t n_spots = 0;
-    spotid_t start = pb->start, stop = pb->stop;
+static const char PRIMARY_ALIGNMENT_ID[] = "PRIMARY_ALIGNMENT_ID";
+static const char RD_FILTER [] = "RD_FILTER";
+static const char READ_LEN  [] = "READ_LEN";
+static const char READ_TYPE [] = "READ_TYPE";
+static const char SPOT_GROUP[] = "SPOT_GROUP";
+
+/* SraStatsRange
+ *  columns and accumulators used to scan [start, stop] range of spots.
+ *  The table is split into several ranges when scanned by several threads:
+ *  every range has its own columns and counters
+ *  that are merged into the first range at the end.
+ *  The columns of an SRATable share its cursor and a manager shares the
+ *  columns of the tables it opens: every range but the first one reads
+ *  the table opened by its own manager.
+ */
+typedef struct SraStatsRange {
+    const srastat_parms* pb;
+    spotid_t start, stop;
+
+    const SRAMgr* mgr; /* NULL for the first range: it reads sra_stat's table */
+    const SRATable* tbl;
+
+/*  const SRAColumn* cCMP_READ; */
+    const SRAColumn* cPRIMARY_ALIGNMENT_ID;
+    const SRAColumn* cRD_FILTER;
+    const SRAColumn* cREAD_LEN;
+    const SRAColumn* cREAD_TYPE;
+    const SRAColumn* cSPOT_GROUP;
+
+    /* the first range points to the results of sra_stat,
+       other ranges - to their own tr and total */
+    BSTree* tr;
+    SraStatsTotal* total;
+    BSTree own_tr;
+    SraStatsTotal own_total;
+
+    int nreads; /* number of reads of the first spot */
+    bool hasSPOT_GROUP;
+    bool fixedNReads;
+    bool fixedReadLength;
+    bool bad_read_filter;
 
     /* filled with dREAD_LEN[i] for (spotid == start);
        used to check fixedReadLength */
-    uint64_t g_totalREAD_LEN[MAX_NREADS];
-    uint64_t g_nonZeroLenReads[MAX_NREADS];
-    memset(g_totalREAD_LEN, 0, sizeof g_totalREAD_LEN);
-    memset(g_nonZeroLenReads, 0, sizeof g_nonZeroLenReads);
+    uint32_t dREAD_LEN[MAX_NREADS];
+    uint64_t totalREAD_LEN[MAX_NREADS];
+    uint64_t nonZeroLenReads[MAX_NREADS];
 
-    assert(pb && tbl && tr && total);
+    rc_t rc; /* result of the thread */
+} SraStatsRange;
+
+static
+void SraStatsRangeInit(SraStatsRange* self, const srastat_parms* pb,
+    spotid_t start, spotid_t stop, BSTree* tr, SraStatsTotal* total)
+{
+    assert(self && pb);
+
+    memset(self, 0, sizeof *self);
+
+    self->pb = pb;
+    self->start = start;
+    self->stop = stop;
+
+    BSTreeInit(&self->own_tr);
+    if (tr == NULL) {
+        tr = &self->own_tr;
+    }
+    if (total == NULL) {
+        total = &self->own_total;
+    }
+    self->tr = tr;
+    self->total = total;
+
+    self->fixedNReads = true;
+    self->fixedReadLength = true;
+}
+
+static
+rc_t SraStatsRangeOpen(SraStatsRange* self, const SRATable* tbl, bool own)
+{
+    rc_t rc = 0;
+
+    assert(self && self->pb && tbl);
+
+    if (own) {
+        rc = SRAMgrMakeRead(&self->mgr);
+        DISP_RC(rc, "while calling SRAMgrMakeRead");
+        if (rc == 0) {
+            rc = SRAMgrOpenTableRead(self->mgr, &self->tbl,
+                "%s", self->pb->table_path);
+            DISP_RC2(rc, self->pb->table_path,
+                "while calling SRAMgrOpenTableRead");
+        }
+        tbl = self->tbl;
+    }
 
     if (rc == 0) {
         const char* name = READ_LEN;
-        rc = SRATableOpenColumnRead(tbl, &cREAD_LEN, name, vdb_uint32_t);
+        rc = SRATableOpenColumnRead(tbl, &self->cREAD_LEN, name, vdb_uint32_t);
         DISP_RC2(rc, name, "while calling SRATableOpenColumnRead");
     }
     if (rc == 0) {
         const char* name = READ_TYPE;
-        rc = SRATableOpenColumnRead(tbl, &cREAD_TYPE, name, sra_read_type_t);
+        rc = SRATableOpenColumnRead
+            (tbl, &self->cREAD_TYPE, name, sra_read_type_t);
         DISP_RC2(rc, name, "while calling SRATableOpenColumnRead");
     }
-
     if (rc == 0) {
-        {
-            const char* name = SPOT_GROUP;
-            rc = SRATableOpenColumnRead(tbl, &cSPOT_GROUP, name, vdb_ascii_t);
-            if (GetRCState(rc) == rcNotFound)
-            {   rc = 0; }
-            DISP_RC2(rc, name, "while calling SRATableOpenColumnRead");
-        }
-        if (rc == 0) {
-            if (rc == 0) {
-                const char* name = RD_FILTER;
-                rc = SRATableOpenColumnRead
-                    (tbl, &cRD_FILTER, name, sra_read_filter_t);
-                if (GetRCState(rc) == rcNotFound)
-                {   rc = 0; }
-                DISP_RC2(rc, name, "while calling SRATableOpenColumnRead");
-            }
-/*          if (rc == 0) {
-                const char* name = CMP_READ;
-                rc = SRATableOpenColumnRead
-                    (tbl, &cCMP_READ, name, "INSDC:dna:text");
-                if (GetRCState(rc) == rcNotFound)
-                {   rc = 0; }
-                DISP_RC2(rc, name, "while calling SRATableOpenColumnRead");
-            } */
-            if (rc == 0) {
-                const char* name = PRIMARY_ALIGNMENT_ID;
-                rc = SRATableOpenColumnRead
-                    (tbl, &cPRIMARY_ALIGNMENT_ID, name, "I64");
-                if (GetRCState(rc) == rcNotFound)
-                {   rc = 0; }
-                DISP_RC2(rc, name, "while calling SRATableOpenColumnRead");
-            }
-            if (rc == 0) {
-                spotid_t spotid;
-                pb->hasSPOT_GROUP = 0;
-                rc = SRATableMaxSpotId(tbl, &spotid);
-                DISP_RC(rc, "failed to read max spot id");
-                if (rc == 0) {
-                    BasesInit(&total->bases_count, tbl);
-                }
-                if (rc == 0) {
-                    bool bad_read_filter = false;
-                    bool fixedNReads = true;
-                    bool fixedReadLength = true;
+        const char* name = SPOT_GROUP;
+        rc = SRATableOpenColumnRead
+            (tbl, &self->cSPOT_GROUP, name, vdb_ascii_t);
+        if (GetRCState(rc) == rcNotFound)
+        {   rc = 0; }
+        DISP_RC2(rc, name, "while calling SRATableOpenColumnRead");
+    }
+    if (rc == 0) {
+        const char* name = RD_FILTER;
+        rc = SRATableOpenColumnRead
+            (tbl, &self->cRD_FILTER, name, sra_read_filter_t);
+        if (GetRCState(rc) == rcNotFound)
+        {   rc = 0; }
+        DISP_RC2(rc, name, "while calling SRATableOpenColumnRead");
+    }
+/*  if (rc == 0) {
+        const char* name = CMP_READ;
+        rc = SRATableOpenColumnRead
+            (tbl, &self->cCMP_READ, name, "INSDC:dna:text");
+        if (GetRCState(rc) == rcNotFound)
+        {   rc = 0; }
+        DISP_RC2(rc, name, "while calling SRATableOpenColumnRead");
+    } */
+    if (rc == 0) {
+        const char* name = PRIMARY_ALIGNMENT_ID;
+        rc = SRATableOpenColumnRead
+            (tbl, &self->cPRIMARY_ALIGNMENT_ID, name, "I64");
+        if (GetRCState(rc) == rcNotFound)
+        {   rc = 0; }
+        DISP_RC2(rc, name, "while calling SRATableOpenColumnRead");
+    }
+    if (rc == 0) {
+        BasesInit(&self->total->bases_count, tbl);
+    }
+
+    return rc;
+}
+
+static
+rc_t SraStatsRangeRelease(SraStatsRange* self)
+{
+    rc_t rc = 0;
+
+    assert(self);
+
+    RELEASE(SRAColumn, self->cSPOT_GROUP);
+    RELEASE(SRAColumn, self->cPRIMARY_ALIGNMENT_ID);
+    RELEASE(SRAColumn, self->cRD_FILTER);
+    RELEASE(SRAColumn, self->cREAD_TYPE);
+    RELEASE(SRAColumn, self->cREAD_LEN);
+
+    BSTreeWhack(&self->own_tr, bst_whack_free, NULL);
+    SraStatsTotalFree(&self->own_total);
 
-                    uint32_t g_dREAD_LEN[MAX_NREADS];
+    RELEASE(SRATable, self->tbl);
+    RELEASE(SRAMgr, self->mgr);
 
-                    memset(g_dREAD_LEN, 0, sizeof g_dREAD_LEN);
+    return rc;
+}
+
+static
+rc_t SraStatsRangeScan(SraStatsRange* self)
+{
+    rc_t rc = 0;
+    spotid_t spotid = 0;
+    const srastat_parms* pb = NULL;
+    BSTree* tr = NULL;
+    SraStatsTotal* total = NULL;
+
+    assert(self && self->pb && self->tr && self->total);
 
-                    if (start == 0)
-                    {   start = 1; }
-                    if (stop == 0 || pb -> stop > spotid)
-                    {   stop = spotid; }
+    pb = self->pb;
+    tr = self->tr;
+    total = self->total;
 
-                    for (spotid = start; spotid <= stop && rc == 0;
+                    for (spotid = self->start; spotid <= self->stop && rc == 0;
                         ++spotid)
                     {
                         SraStats* ss;
@@ -2469,7 +2596,7 @@ rc_t sra_stat(srastat_parms* pb, const SRATable* tbl,
                         {   LOGMSG(klogWarn, "Interrupted"); }
 
                         if (rc == 0) {
-                            rc = SRAColumnRead(cREAD_LEN, spotid, &base, &boff, &row_bits);
+                            rc = SRAColumnRead(self->cREAD_LEN, spotid, &base, &boff, &row_bits);
                             DISP_RC_Read(rc, READ_LEN, spotid, "while calling SRAColumnRead");
                         }
                         if (rc == 0) {
@@ -2485,19 +2612,19 @@ rc_t sra_stat(srastat_parms* pb, const SRATable* tbl,
                             int i, bio_len, bio_count, bad_cnt, filt_cnt;
                             memcpy(dREAD_LEN, ((const char*)base) + (boff>>3), row_bits>>3);
                             nreads = (row_bits >> 3) / sizeof(*dREAD_LEN);
-                            if (spotid == start) {
-                                g_nreads = nreads;
+                            if (spotid == self->start) {
+                                self->nreads = nreads;
                                 if (pb->statistics) {
                                     rc = SraStatsTotalMakeStatistics
-                                        (total, g_nreads);
+                                        (total, nreads);
                                 }
                             }
-                            else if (g_nreads != nreads) {
-                                fixedNReads = false;
+                            else if (self->nreads != nreads) {
+                                self->fixedNReads = false;
                             }
 
                             if (rc == 0) {
-                                rc = SRAColumnRead(cREAD_TYPE, spotid, &base, &boff, &row_bits);
+                                rc = SRAColumnRead(self->cREAD_TYPE, spotid, &base, &boff, &row_bits);
                                 DISP_RC_Read(rc, READ_TYPE, spotid, "while calling SRAColumnRead");
                                 if (rc == 0) {
                                     if (boff & 7)
@@ -2513,8 +2640,8 @@ rc_t sra_stat(srastat_parms* pb, const SRATable* tbl,
                             }
                             if (rc == 0) {
                                 memcpy(dREAD_TYPE, ((const char*)base) + (boff >> 3), row_bits >> 3);
-                                if (cSPOT_GROUP) {
-                                    rc = SRAColumnRead(cSPOT_GROUP, spotid, &base, &boff, &row_bits);
+                                if (self->cSPOT_GROUP) {
+                                    rc = SRAColumnRead(self->cSPOT_GROUP, spotid, &base, &boff, &row_bits);
                                     DISP_RC_Read(rc, SPOT_GROUP, spotid, "while calling SRAColumnRead");
                                     if (rc == 0) {
                                         if (row_bits > 0) {
@@ -2531,7 +2658,7 @@ rc_t sra_stat(srastat_parms* pb, const SRATable* tbl,
                                                 dSPOT_GROUP[n]='\0';
                                                 if (n > 1 ||
                                                     (n == 1 && dSPOT_GROUP[0]))
-                                                {   pb -> hasSPOT_GROUP = 1; }
+                                                {   self->hasSPOT_GROUP = true; }
                                             }
                                         }
                                         else {  dSPOT_GROUP[0]='\0'; }
@@ -2540,8 +2667,8 @@ rc_t sra_stat(srastat_parms* pb, const SRATable* tbl,
                             }
                             if (rc == 0) {
                                 uint64_t cmp_len = 0; /* CMP_READ */
-                                if (cRD_FILTER) {
-                                    rc = SRAColumnRead(cRD_FILTER, spotid, &base, &boff, &row_bits);
+                                if (self->cRD_FILTER) {
+                                    rc = SRAColumnRead(self->cRD_FILTER, spotid, &base, &boff, &row_bits);
                                     DISP_RC_Read(rc, RD_FILTER, spotid, "while calling SRAColumnRead");
                                     if (rc == 0) {
                                         int size = row_bits >> 3;
@@ -2563,8 +2690,8 @@ rc_t sra_stat(srastat_parms* pb, const SRATable* tbl,
                                                         memcpy(dRD_FILTER + i,
                                                             ((const char*)base) + (boff>>3), 1);
                                                     }
-                                                    if (!bad_read_filter) {
-                                                        bad_read_filter = true;
+                                                    if (!self->bad_read_filter) {
+                                                        self->bad_read_filter = true;
                                                         PLOGMSG(klogWarn, (klogWarn, "RD_FILTER column"
                                                             " size is 1 but it is expected to be $(n)",
                                                             "n=%d", nreads));
@@ -2572,8 +2699,8 @@ rc_t sra_stat(srastat_parms* pb, const SRATable* tbl,
                                                 }
                                                 else { /* something really bad with RD_FILTER column:
                                                           let's pretend it does not exist */
-                                                    cRD_FILTER = NULL;
-                                                    bad_read_filter = true;
+                                                    RELEASE(SRAColumn, self->cRD_FILTER);
+                                                    self->bad_read_filter = true;
                                                     PLOGMSG(klogWarn, (klogWarn, "RD_FILTER column size"
                                                         " is $(real) but it is expected to be $(exp)",
                                                         "real=%d,exp=%d", size, nreads));
@@ -2583,8 +2710,8 @@ rc_t sra_stat(srastat_parms* pb, const SRATable* tbl,
                                     } else { break; }
                                 }
 
-                                if (cPRIMARY_ALIGNMENT_ID) {
-                                    rc = SRAColumnRead(cPRIMARY_ALIGNMENT_ID, spotid, &base, &boff, &row_bits);
+                                if (self->cPRIMARY_ALIGNMENT_ID) {
+                                    rc = SRAColumnRead(self->cPRIMARY_ALIGNMENT_ID, spotid, &base, &boff, &row_bits);
                                     DISP_RC_Read(rc, PRIMARY_ALIGNMENT_ID, spotid, "while calling SRAColumnRead");
                                     if (boff & 7)
                                     {   rc = RC(rcExe, rcColumn, rcReading, rcOffset, rcInvalid); }
@@ -2602,8 +2729,8 @@ rc_t sra_stat(srastat_parms* pb, const SRATable* tbl,
                                         }
                                     }
                                 }
-/*                              if (cCMP_READ) {
-                                    rc = SRAColumnRead(cCMP_READ, spotid, &base, &boff, &row_bits);
+/*                              if (self->cCMP_READ) {
+                                    rc = SRAColumnRead(self->cCMP_READ, spotid, &base, &boff, &row_bits);
                                     DISP_RC_Read(rc, CMP_READ, spotid, "while calling SRAColumnRead");
                                     if (boff & 7)
                                     {   rc = RC(rcExe, rcColumn, rcReading, rcOffset, rcInvalid); }
@@ -2639,14 +2766,14 @@ rc_t sra_stat(srastat_parms* pb, const SRATable* tbl,
                                 }
                                 for (bio_len = bio_count = i = bad_cnt = filt_cnt = 0; (i < nreads) && (rc == 0); i++) {
                                     if (dREAD_LEN[i] > 0) {
-                                        g_totalREAD_LEN[i] += dREAD_LEN[i];
-                                        ++g_nonZeroLenReads[i];
+                                        self->totalREAD_LEN[i] += dREAD_LEN[i];
+                                        ++self->nonZeroLenReads[i];
                                     }
-                                    if (spotid == start) {
-                                        g_dREAD_LEN[i] = dREAD_LEN[i];
+                                    if (spotid == self->start) {
+                                        self->dREAD_LEN[i] = dREAD_LEN[i];
                                     }
-                                    else if (g_dREAD_LEN[i] != dREAD_LEN[i])
-                                    {   fixedReadLength = false; }
+                                    else if (self->dREAD_LEN[i] != dREAD_LEN[i])
+                                    {   self->fixedReadLength = false; }
 
                                     if (dREAD_LEN[i] > 0) {
                                         bool biological = false;
@@ -2657,7 +2784,7 @@ rc_t sra_stat(srastat_parms* pb, const SRATable* tbl,
                                             bio_len += dREAD_LEN[i];
                                             bio_count++;
                                         }
-                                        if (cRD_FILTER) {
+                                        if (self->cRD_FILTER) {
                                             switch (dRD_FILTER[i]) {
                                                 case SRA_READ_FILTER_PASS:
                                                     break;
@@ -2706,72 +2833,424 @@ rc_t sra_stat(srastat_parms* pb, const SRATable* tbl,
                         }
                     } /* for (spotid = start; spotid <= stop && rc == 0; ++spotid) */
 
-                    if (rc == 0) {
-                        BasesFinalize(&total->bases_count);
-                        pb->variableReadLength = !fixedReadLength;
+    return rc;
+}
 
-                        /* --- g_totalREAD_LEN[i] is sum(READ_LEN[i]) for all spots --- */
-                        if (fixedNReads) {
-                            int i = 0;
-                            if (stop >= start) {
-                                n_spots = stop - start + 1;
-                            }
-                            if (n_spots > 0) {
-                                for (i = 0; i < g_nreads && rc == 0; ++i) {
-                                    if (fixedReadLength) {
-                                        assert(g_totalREAD_LEN[i] / n_spots
-                                            == g_dREAD_LEN[i]);
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-                RELEASE(SRAColumn, cSPOT_GROUP);
+/* second pass of --test: READ_LEN deviations from already known averages */
+static
+rc_t SraStatsRangeTest(SraStatsRange* self)
+{
+    rc_t rc = 0;
+    spotid_t spotid = 0;
+
+    assert(self && self->total);
+
+    for (spotid = self->start; spotid <= self->stop && rc == 0; ++spotid) {
+        uint32_t dREAD_LEN[MAX_NREADS];
+        const void* base;
+        bitsz_t boff, row_bits;
+        if (rc == 0) {
+            rc = SRAColumnRead(self->cREAD_LEN, spotid, &base, &boff, &row_bits);
+            DISP_RC_Read(rc, READ_LEN, spotid,
+                "while calling SRAColumnRead");
+        }
+        if (rc == 0) {
+            memcpy(dREAD_LEN, ((const char*)base) + (boff>>3), row_bits>>3);
+            SraStatsTotalAdd2(self->total, dREAD_LEN);
+        }
+    }
+
+    return rc;
+}
+
+static
+rc_t CC SraStatsRangeScanThread(const KThread* self, void* data)
+{
+    SraStatsRange* range = data;
+    assert(range);
+    range->rc = SraStatsRangeScan(range);
+    return range->rc;
+}
+
+static
+rc_t CC SraStatsRangeTestThread(const KThread* self, void* data)
+{
+    SraStatsRange* range = data;
+    assert(range);
+    range->rc = SraStatsRangeTest(range);
+    return range->rc;
+}
+
+/* run "func" for every range:
+   the first range is processed by the calling thread */
+static
+rc_t SraStatsRangesRun(SraStatsRange* ranges, uint32_t n,
+    rc_t (CC* func)(const KThread*, void*))
+{
+    rc_t rc = 0;
+    uint32_t i = 0;
+    KThread** t = NULL;
+
+    assert(ranges && n && func);
+
+    if (n > 1) {
+        t = calloc(n, sizeof *t);
+    }
+
+    for (i = 1; i < n; ++i) {
+        if (t == NULL || KThreadMake(&t[i], func, &ranges[i]) != 0) {
+            /* could not start a thread: do this range ourselves */
+            if (t != NULL) {
+                t[i] = NULL;
             }
+            func(NULL, &ranges[i]);
         }
     }
 
-    RELEASE(SRAColumn, cPRIMARY_ALIGNMENT_ID);
-    RELEASE(SRAColumn, cRD_FILTER);
-    RELEASE(SRAColumn, cREAD_TYPE);
-    RELEASE(SRAColumn, cREAD_LEN);
+    func(NULL, &ranges[0]);
 
-    if (pb->test) {
-        int i = 0;
-        spotid_t spotid = 0;
-        double average[MAX_NREADS];
-        double diff_sq[MAX_NREADS];
-        SraStatsTotalStatistics2Init(total,
-            g_nreads, g_totalREAD_LEN, g_nonZeroLenReads);
-        memset(diff_sq, 0, sizeof diff_sq);
-        for (i = 0; i < g_nreads; ++i) {
-            average[i] = (double)g_totalREAD_LEN[i] / n_spots;
+    for (i = 1; i < n; ++i) {
+        if (t != NULL && t[i] != NULL) {
+            KThreadWait(t[i], NULL);
+            KThreadRelease(t[i]);
         }
-        if (rc == 0) {
-            const char* name = READ_LEN;
-            rc = SRATableOpenColumnRead(tbl, &cREAD_LEN, name, vdb_uint32_t);
-            DISP_RC2(rc, name, "while calling SRATableOpenColumnRead");
-        }
-        for (spotid = start; spotid <= stop && rc == 0; ++spotid) {
-            uint32_t dREAD_LEN[MAX_NREADS];
-            const void* base;
-            bitsz_t boff, row_bits;
-            if (rc == 0) {
-                rc = SRAColumnRead(cREAD_LEN, spotid, &base, &boff, &row_bits);
-                DISP_RC_Read(rc, READ_LEN, spotid,
-                    "while calling SRAColumnRead");
+    }
+    free(t);
+
+    for (i = 0; i < n && rc == 0; ++i) {
+        rc = ranges[i].rc;
+    }
+
+    return rc;
+}
+
+typedef struct SraStatsMergeData {
+    BSTree* tr;
+    rc_t rc;
+} SraStatsMergeData;
+
+static
+void CC srastats_merge(BSTNode* n, void* data)
+{
+    const SraStats* src = (const SraStats*)n;
+    SraStatsMergeData* pd = data;
+    SraStats* ss = NULL;
+
+    assert(src && pd);
+
+    if (pd->rc != 0) {
+        return;
+    }
+
+    ss = (SraStats*)BSTreeFind(pd->tr, src->spot_group, srastats_cmp);
+    if (ss == NULL) {
+        ss = calloc(1, sizeof(*ss));
+        if (ss == NULL) {
+            pd->rc = RC(rcExe, rcStorage, rcAllocating, rcMemory, rcExhausted);
+            return;
+        }
+        strcpy(ss->spot_group, src->spot_group);
+        BSTreeInsert(pd->tr, (BSTNode*)ss, srastats_sort);
+    }
+
+    ss->spot_count += src->spot_count;
+    ss->spot_count_mates += src->spot_count_mates;
+    ss->bio_len += src->bio_len;
+    ss->bio_len_mates += src->bio_len_mates;
+    ss->total_len += src->total_len;
+    ss->bad_spot_count += src->bad_spot_count;
+    ss->bad_bio_len += src->bad_bio_len;
+    ss->filtered_spot_count += src->filtered_spot_count;
+    ss->filtered_bio_len += src->filtered_bio_len;
+    ss->total_cmp_len += src->total_cmp_len;
+}
+
+/* add results of the next (following) range to self */
+static
+rc_t SraStatsRangeMerge(SraStatsRange* self, const SraStatsRange* other)
+{
+    int i = 0;
+    SraStatsTotal* total = NULL;
+    const SraStatsTotal* o = NULL;
+    SraStatsMergeData data;
+
+    assert(self && other && self->total && other->total);
+
+    total = self->total;
+    o = other->total;
+
+    if (other->hasSPOT_GROUP) {
+        self->hasSPOT_GROUP = true;
+    }
+    if (!other->fixedNReads || other->nreads != self->nreads) {
+        self->fixedNReads = false;
+    }
+    if (!other->fixedReadLength) {
+        self->fixedReadLength = false;
+    }
+    else {
+        for (i = 0; i < other->nreads; ++i) {
+            if (other->dREAD_LEN[i] != self->dREAD_LEN[i]) {
+                self->fixedReadLength = false;
+                break;
             }
-            if (rc == 0) {
-                memcpy(dREAD_LEN, ((const char*)base) + (boff>>3), row_bits>>3);
+        }
+    }
+    for (i = 0; i < MAX_NREADS; ++i) {
+        self->totalREAD_LEN[i] += other->totalREAD_LEN[i];
+        self->nonZeroLenReads[i] += other->nonZeroLenReads[i];
+    }
+
+    total->spot_count += o->spot_count;
+    total->spot_count_mates += o->spot_count_mates;
+    total->BIO_BASE_COUNT += o->BIO_BASE_COUNT;
+    total->bio_len_mates += o->bio_len_mates;
+    total->BASE_COUNT += o->BASE_COUNT;
+    total->bad_spot_count += o->bad_spot_count;
+    total->bad_bio_len += o->bad_bio_len;
+    total->filtered_spot_count += o->filtered_spot_count;
+    total->filtered_bio_len += o->filtered_bio_len;
+    total->total_cmp_len += o->total_cmp_len;
+
+    if (self->pb->statistics) {
+        if (o->variable_nreads || o->nreads != total->nreads) {
+            total->variable_nreads = true;
+        }
+        if (!total->variable_nreads) {
+            for (i = 0; i < total->nreads; ++i) {
+                StatisticsMerge(total->stats + i, o->stats + i);
+            }
+        }
+    }
+
+    if (o->bases_count.col == NULL) {
+        /* READ was not read completely: do not print Bases */
+        BasesRelease(&total->bases_count);
+    }
+    else {
+        for (i = 0; i < 5; ++i) {
+            total->bases_count.cnt[i] += o->bases_count.cnt[i];
+        }
+    }
+
+    data.tr = self->tr;
+    data.rc = 0;
+    BSTreeForEach(other->tr, false, srastats_merge, &data);
+
+    return data.rc;
+}
+
+static
+rc_t sra_stat(srastat_parms* pb, const SRATable* tbl,
+    BSTree* tr, SraStatsTotal* total)
+{
+    rc_t rc = 0;
+
+    spotid_t n_spots = 0;
+    spotid_t start = pb->start, stop = pb->stop;
+    spotid_t max_spot = 0;
+
+    SraStatsRange* ranges = NULL;
+    uint32_t n = 1;
+    uint32_t i = 0;
+
+    assert(pb && tbl && tr && total);
+
+    pb->hasSPOT_GROUP = false;
+    pb->scannedAll = false;
+
+    rc = SRATableMaxSpotId(tbl, &max_spot);
+    DISP_RC(rc, "failed to read max spot id");
+    if (rc == 0) {
+        if (start == 0)
+        {   start = 1; }
+        if (stop == 0 || pb -> stop > max_spot)
+        {   stop = max_spot; }
+
+        if (pb->threads > 1 && stop >= start) {
+            uint64_t count = stop - start + 1;
+            n = pb->threads;
+            if (count / n < MIN_SPOTS_PER_THREAD) {
+                n = count / MIN_SPOTS_PER_THREAD;
+            }
+            if (n == 0) {
+                n = 1;
+            }
+        }
+
+        ranges = calloc(n, sizeof *ranges);
+        if (ranges == NULL) {
+            rc = RC(rcExe, rcStorage, rcAllocating, rcMemory, rcExhausted);
+        }
+    }
+
+    if (rc == 0) {
+        /* contiguous ranges in spot order: range 0 starts at "start" */
+        for (i = 0; i < n; ++i) {
+            spotid_t first = start, last = stop;
+            if (n > 1) {
+                uint64_t count = stop - start + 1;
+                first = start + count * i / n;
+                last = start + count * (i + 1) / n - 1;
+            }
+            SraStatsRangeInit(&ranges[i], pb, first, last,
+                i == 0 ? tr : NULL, i == 0 ? total : NULL);
+        }
+
+        /* columns are opened in this thread:
+           every worker reads only the columns of its range */
+        for (i = 0; i < n && rc == 0; ++i) {
+            rc = SraStatsRangeOpen(&ranges[i], tbl, i > 0);
+        }
+    }
+
+    if (rc == 0) {
+        rc = SraStatsRangesRun(ranges, n, SraStatsRangeScanThread);
+    }
+    for (i = 1; i < n && rc == 0; ++i) {
+        rc = SraStatsRangeMerge(&ranges[0], &ranges[i]);
+    }
+
+    if (ranges != NULL) {
+        pb->hasSPOT_GROUP = ranges[0].hasSPOT_GROUP;
+    }
+
+    if (rc == 0) {
+        const SraStatsRange* r = &ranges[0];
+
+        BasesFinalize(&total->bases_count);
+        pb->variableReadLength = !r->fixedReadLength;
+        pb->scannedAll = start == 1 && stop == max_spot;
+
+        /* --- totalREAD_LEN[i] is sum(READ_LEN[i]) for all spots --- */
+        if (r->fixedNReads) {
+            if (stop >= start) {
+                n_spots = stop - start + 1;
+            }
+            if (n_spots > 0) {
+                for (i = 0; i < r->nreads && rc == 0; ++i) {
+                    if (r->fixedReadLength) {
+                        assert(r->totalREAD_LEN[i] / n_spots
+                            == r->dREAD_LEN[i]);
+                    }
+                }
+            }
+        }
+    }
+
+    if (rc == 0 && pb->test && ranges[0].fixedNReads) {
+        /* averages are known now: calculate deviations from them */
+        SraStatsRange* r = &ranges[0];
+        for (i = 0; i < n; ++i) {
+            SraStatsTotalStatistics2Init(ranges[i].total,
+                r->nreads, r->totalREAD_LEN, r->nonZeroLenReads);
+        }
+        rc = SraStatsRangesRun(ranges, n, SraStatsRangeTestThread);
+        for (i = 1; i < n && rc == 0; ++i) {
+            int j = 0;
+            for (j = 0; j < r->nreads; ++j) {
+                total->stats2[j].n += ranges[i].total->stats2[j].n;
+                total->stats2[j].diff_sq_sum
+                    += ranges[i].total->stats2[j].diff_sq_sum;
             }
-            for (i = 0; i < g_nreads; ++i) {
-                diff_sq[i] +=
-                    (dREAD_LEN[i] - average[i]) * (dREAD_LEN[i] - average[i]);
+        }
+    }
+
+    if (ranges != NULL) {
+        for (i = 0; i < n; ++i) {
+            rc_t rc2 = SraStatsRangeRelease(&ranges[i]);
+            if (rc2 != 0 && rc == 0) {
+                rc = rc2;
             }
-            SraStatsTotalAdd2(total, dREAD_LEN);
         }
-        RELEASE(SRAColumn, cREAD_LEN);
+        free(ranges);
+    }
+
+    return rc;
+}
+
+typedef struct SraStatsSaveData {
+    FILE* out;
+    rc_t rc;
+} SraStatsSaveData;
+
+static
+void CC srastats_save(BSTNode* n, void* data)
+{
+    const SraStats* ss = (const SraStats*)n;
+    SraStatsSaveData* pd = data;
+
+    assert(ss && pd);
+
+    if (pd->rc != 0) {
+        return;
+    }
+
+    /* a line of sra-stat-save input cannot hold a line break */
+    if (strpbrk(ss->spot_group, "\r\n") != NULL) {
+        pd->rc = RC(rcExe, rcData, rcWriting, rcName, rcInvalid);
+        PLOGERR(klogWarn, (klogWarn, pd->rc,
+            "cannot save spot group '$(name)'", "name=%s", ss->spot_group));
+        return;
+    }
+
+    if (fprintf(pd->out, "GROUP\t%lu\t%lu\t%lu\t%lu\t%s\n",
+        ss->spot_count, ss->total_len, ss->bio_len, ss->total_cmp_len,
+        ss->spot_group) < 0)
+    {
+        pd->rc = RC(rcExe, rcFile, rcWriting, rcTransfer, rcFailed);
+    }
+}
+
+/* store results of a complete table scan into table metadata
+   to be used by the following --quick runs.
+   sra-stat only reads: the metadata is written by sra-stat-save,
+   which is linked with the read/write library. it is run from the
+   directory of sra-stat and gets the statistics on its stdin */
+static
+rc_t sra_stat_save(const srastat_parms* pb,
+    const BSTree* tr, const SraStatsTotal* total)
+{
+    rc_t rc = 0;
+    rc_t rc2 = 0;
+    FILE* out = NULL;
+    SaveTool* tool = NULL;
+
+    assert(pb && pb->table_path && pb->save_tool[0] && tr && total);
+
+    rc = SaveToolRun(&tool, pb->save_tool, pb->table_path, &out);
+    if (rc != 0) {
+        PLOGERR(klogErr, (klogErr, rc, "cannot run $(tool)",
+            "tool=%s", pb->save_tool));
+        return rc;
+    }
+
+    if (fprintf(out, "TABLE\t%lu\t%lu\t%lu\t%lu\n",
+        total->spot_count, total->BASE_COUNT,
+        total->BIO_BASE_COUNT, total->total_cmp_len) < 0)
+    {
+        rc = RC(rcExe, rcFile, rcWriting, rcTransfer, rcFailed);
+    }
+    if (rc == 0 && pb->hasSPOT_GROUP) {
+        SraStatsSaveData data;
+        data.out = out;
+        data.rc = 0;
+        BSTreeForEach(tr, false, srastats_save, &data);
+        rc = data.rc;
+    }
+    if (rc != 0) {
+        /* the helper saves nothing from an incomplete input */
+        fputs("ABORT\n", out);
+    }
+    else if (fflush(out) != 0) {
+        rc = RC(rcExe, rcFile, rcWriting, rcTransfer, rcFailed);
+    }
+
+    rc2 = SaveToolWait(tool);
+    if (rc2 != 0 && rc == 0) {
+        rc = rc2;
+        PLOGERR(klogErr, (klogErr, rc, "$(tool) failed",
+            "tool=%s", pb->save_tool));
     }
 
     return rc;
@@ -2793,8 +3272,14 @@ rc_t run(srastat_parms* pb)
     rc_t rc = 0;
     const SRAMgr* mgr = NULL;
 
+    BSTree tr;
+    SraStatsTotal total;
+
     assert(pb && pb->table_path);
 
+    BSTreeInit(&tr);
+    memset(&total, 0, sizeof total);
+
     rc = SRAMgrMakeRead(&mgr);
 
     if (rc != 0) {
@@ -2813,20 +3298,15 @@ rc_t run(srastat_parms* pb)
         }
         else {
             MetaDataStats stats;
-            SraStatsTotal total;
             const KTable* ktbl = NULL;
             const KMetadata* meta = NULL;
             const VTable* vtbl = NULL;
             const VDatabase* db = NULL;
 
-            BSTree tr;
             Ctx ctx;
 
-            BSTreeInit(&tr);
             memset(&ctx, 0, sizeof ctx);
 
-            memset(&total, 0, sizeof total);
-
             rc = SRATableGetKTableRead(tbl, &ktbl);
             DISP_RC(rc, "While calling SRATableGetKTableRead");
             if (rc == 0) {
@@ -2884,8 +3364,6 @@ rc_t run(srastat_parms* pb)
                 ctx.tr = &tr;
                 rc = print_results(&ctx);
             }
-            BSTreeWhack(&tr, bst_whack_free, NULL);
-            SraStatsTotalFree(&total);
             RELEASE(VDatabase, db);
             RELEASE(VTable, vtbl);
             RELEASE(KTable, ktbl);
@@ -2908,6 +3386,27 @@ rc_t run(srastat_parms* pb)
 
     RELEASE(SRAMgr, mgr);
 
+    /* sra-stat-save opens the table for update: release all read handles first */
+    if (rc == 0 && pb->save_stats) {
+        if (pb->quick) {
+            LOGMSG(klogInfo, "Statistics were read from metadata: "
+                "nothing to save");
+        }
+        else if (!pb->scannedAll) {
+            LOGMSG(klogWarn, "Statistics of a part of the table "
+                "are not saved into metadata");
+        }
+        else {
+            rc_t rc2 = sra_stat_save(pb, &tr, &total);
+            if (rc2 != 0) {
+                LOGERR(klogWarn, rc2, "Statistics were not saved into metadata");
+            }
+        }
+    }
+
+    BSTreeWhack(&tr, bst_whack_free, NULL);
+    SraStatsTotalFree(&total);
+
     return rc;
 }
 
@@ -2936,6 +3435,8 @@ ver_t CC KAppVersion ( void )
 #define OPTION_TEST  "test"
 #define OPTION_XML   "xml"
 #define OPTION_ARCINFO "archive-info"
+#define OPTION_THREADS "threads"
+#define OPTION_SAVE  "save-stats"
 
 #define ALIAS_ALIGN "a"
 #define ALIAS_SPT_D "d"
@@ -2948,6 +3449,8 @@ ver_t CC KAppVersion ( void )
 #define ALIAS_TEST  "t"
 #define ALIAS_XML   "x"
 #define ALIAS_ARCINFO NULL
+#define ALIAS_THREADS "j"
+#define ALIAS_SAVE  NULL
 
 static const char * align_usage[] = { "print alignment info, default is on", NULL };
 static const char * spt_d_usage[] = { "print table spot descriptor", NULL };
@@ -2960,6 +3463,9 @@ static const char * quick_usage[] = { "quick mode: get statistics from metadata;
 static const char * test_usage[] = { "test READ_LEN average and standard deviation calculation", NULL };
 static const char * xml_usage[] = { "output as XML, default is text", NULL };
 static const char * arcinfo_usage[] = { "output archive info, default is off", NULL };
+static const char * threads_usage[] = { "number of threads scanning the table, 1 to 64, default is 1", NULL };
+static const char * save_usage[] = { "save statistics of the full table scan into metadata:",
+                                     "following --quick runs will use them", NULL };
 
 OptDef Options[] =
 {
@@ -2974,6 +3480,8 @@ OptDef Options[] =
     , { OPTION_STOP,  ALIAS_STOP,  NULL, stop_usage,  1, true,  false }
     , { OPTION_TEST , ALIAS_TEST , NULL, test_usage,  1, false, false }
     , { OPTION_XML,   ALIAS_XML,   NULL, xml_usage,   1, false, false }
+    , { OPTION_THREADS, ALIAS_THREADS, NULL, threads_usage, 1, true, false }
+    , { OPTION_SAVE,  ALIAS_SAVE,  NULL, save_usage,  1, false, false }
 };
 
 rc_t CC UsageSummary (const char * progname)
@@ -3015,6 +3523,8 @@ rc_t CC Usage (const Args * args)
     HelpOptionLine (ALIAS_ARCINFO, OPTION_ARCINFO, NULL, arcinfo_usage);
     HelpOptionLine (ALIAS_STATS, OPTION_STATS, NULL, stats_usage);
     HelpOptionLine (ALIAS_ALIGN, OPTION_ALIGN, "on | off", align_usage);
+    HelpOptionLine (ALIAS_THREADS, OPTION_THREADS, "count", threads_usage);
+    HelpOptionLine (ALIAS_SAVE, OPTION_SAVE, NULL, save_usage);
     KOutMsg ("\n");
     HelpOptionsStandard ();
     HelpVersion (fullpath, KAppVersion());
@@ -3150,6 +3660,54 @@ rc_t CC KMain ( int argc, char *argv [] )
             if (pcount)
                 pb.test = pb.statistics = true;
 
+            rc = ArgsOptionCount (args, OPTION_THREADS, &pcount);
+            if (rc)
+                break;
+
+            if (pcount == 1)
+            {
+                rc = ArgsOptionValue (args, OPTION_THREADS, 0, &pc);
+                if (rc)
+                    break;
+
+                {
+                    char* end = NULL;
+                    unsigned long threads = strtoul (pc, &end, 0);
+                    if (threads == 0 || threads > MAX_THREADS || *end != 0) {
+                        rc = RC(rcExe, rcArgv, rcParsing, rcParam, rcExcessive);
+                        PLOGERR(klogErr, (klogErr, rc,
+                            "invalid number of threads $(v), must be 1 to $(max)",
+                            "v=%s,max=%u", pc, MAX_THREADS));
+                        break;
+                    }
+                    pb.threads = (uint32_t)threads;
+                }
+            }
+
+            rc = ArgsOptionCount (args, OPTION_SAVE, &pcount);
+            if (rc)
+                break;
+
+            if (pcount) {
+                /* sra-stat-save is installed next to sra-stat */
+                const char* fullpath = NULL;
+                const char* progname = NULL;
+                size_t dir = 0;
+                pb.save_stats = true;
+                rc = ArgsProgram (args, &fullpath, &progname);
+                if (rc)
+                    break;
+                if (fullpath != NULL && progname != NULL
+                    && progname > fullpath)
+                {
+                    dir = progname - fullpath;
+                }
+                rc = string_printf (pb.save_tool, sizeof pb.save_tool, NULL,
+                    "%.*ssra-stat-save", (int)dir, fullpath);
+                if (rc)
+                    break;
+            }
+
             rc = ArgsParamCount (args, &pcount);
             if (rc)
                 break;
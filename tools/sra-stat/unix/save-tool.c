@@ -0,0 +1,137 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include "save-tool-priv.h"
+
+#include <klib/rc.h>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+struct SaveTool {
+    pid_t pid;
+    FILE* in;
+    void (*sigpipe)(int);
+};
+
+rc_t SaveToolRun(SaveTool** self, const char* tool, const char* param,
+    FILE** in)
+{
+    int fd[2];
+    SaveTool* obj = NULL;
+
+    if (self == NULL || tool == NULL || param == NULL || in == NULL) {
+        return RC(rcExe, rcProcess, rcCreating, rcParam, rcNull);
+    }
+
+    obj = calloc(1, sizeof *obj);
+    if (obj == NULL) {
+        return RC(rcExe, rcProcess, rcCreating, rcMemory, rcExhausted);
+    }
+
+    if (pipe(fd) != 0) {
+        free(obj);
+        return RC(rcExe, rcProcess, rcCreating, rcFileDesc, rcFailed);
+    }
+
+    /* do not let the child inherit buffered output */
+    fflush(stdout);
+    fflush(stderr);
+
+    obj->pid = fork();
+    if (obj->pid < 0) {
+        close(fd[0]);
+        close(fd[1]);
+        free(obj);
+        return RC(rcExe, rcProcess, rcCreating, rcProcess, rcFailed);
+    }
+
+    if (obj->pid == 0) {
+        char* const argv[] = { (char*)tool, (char*)param, NULL };
+        close(fd[1]);
+        if (dup2(fd[0], 0) < 0) {
+            _exit(126);
+        }
+        close(fd[0]);
+        /* a bare name is looked up in PATH */
+        if (strchr(tool, '/') != NULL) {
+            execv(tool, argv);
+        }
+        else {
+            execvp(tool, argv);
+        }
+        _exit(127);
+    }
+
+    close(fd[0]);
+
+    obj->in = fdopen(fd[1], "w");
+    if (obj->in == NULL) {
+        close(fd[1]);
+        SaveToolWait(obj);
+        return RC(rcExe, rcProcess, rcCreating, rcFileDesc, rcFailed);
+    }
+
+    /* a tool that died is reported by its exit status, not by SIGPIPE */
+    obj->sigpipe = signal(SIGPIPE, SIG_IGN);
+
+    *in = obj->in;
+    *self = obj;
+    return 0;
+}
+
+rc_t SaveToolWait(SaveTool* self)
+{
+    int status = 0;
+    rc_t rc = 0;
+
+    if (self == NULL) {
+        return RC(rcExe, rcProcess, rcWaiting, rcSelf, rcNull);
+    }
+
+    if (self->in != NULL) {
+        fclose(self->in);
+        signal(SIGPIPE, self->sigpipe);
+    }
+
+    while (waitpid(self->pid, &status, 0) < 0) {
+        if (errno != EINTR) {
+            status = -1;
+            break;
+        }
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        rc = RC(rcExe, rcProcess, rcExecuting, rcProcess, rcFailed);
+    }
+
+    free(self);
+    return rc;
+}
@@ -0,0 +1,88 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include "save-tool-priv.h"
+
+#include <klib/printf.h>
+#include <klib/rc.h>
+
+#include <stdlib.h>
+
+struct SaveTool {
+    FILE* in;
+};
+
+rc_t SaveToolRun(SaveTool** self, const char* tool, const char* param,
+    FILE** in)
+{
+    rc_t rc = 0;
+    char cmd[8192];
+    SaveTool* obj = NULL;
+
+    if (self == NULL || tool == NULL || param == NULL || in == NULL) {
+        return RC(rcExe, rcProcess, rcCreating, rcParam, rcNull);
+    }
+
+    /* cmd.exe strips the outer quotes of the whole command line */
+    rc = string_printf(cmd, sizeof cmd, NULL, "\"\"%s\" \"%s\"\"", tool, param);
+    if (rc != 0) {
+        return rc;
+    }
+
+    obj = calloc(1, sizeof *obj);
+    if (obj == NULL) {
+        return RC(rcExe, rcProcess, rcCreating, rcMemory, rcExhausted);
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+
+    obj->in = _popen(cmd, "w");
+    if (obj->in == NULL) {
+        free(obj);
+        return RC(rcExe, rcProcess, rcCreating, rcProcess, rcFailed);
+    }
+
+    *in = obj->in;
+    *self = obj;
+    return 0;
+}
+
+rc_t SaveToolWait(SaveTool* self)
+{
+    rc_t rc = 0;
+
+    if (self == NULL) {
+        return RC(rcExe, rcProcess, rcWaiting, rcSelf, rcNull);
+    }
+
+    if (_pclose(self->in) != 0) {
+        rc = RC(rcExe, rcProcess, rcExecuting, rcProcess, rcFailed);
+    }
+
+    free(self);
+    return rc;
+}
@@ -70,6 +70,7 @@ extern "C" {
 #define OPTION_FORCE             "force"
 #define OPTION_UNLOCK            "unlock"
 #define OPTION_BLOB_CHECKSUM     "blob_checksum"
+#define OPTION_ROW_COPY          "row_copy"
 
 
 #define ALIAS_TABLE             "T"
@@ -95,6 +96,7 @@ extern "C" {
 #define ALIAS_FORCE             "f"
 #define ALIAS_UNLOCK            "u"
 #define ALIAS_BLOB_CHECKSUM     "b"
+#define ALIAS_ROW_COPY          NULL
 
 
 /* *******************************************************************
@@ -126,6 +128,7 @@ typedef struct context
     uint8_t blob_checksum;
     bool force_kcmInit;
     bool force_unlock;
+    bool row_copy;
 
     /* set by application */
     bool dont_remove_target;
@@ -0,0 +1,248 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include "vdb-copy-includes.h"
+#include "definitions.h"
+#include "copy_meta.h"
+#include "copy_blobs.h"
+#include <kapp/main.h>
+#include <kdb/table.h>
+#include <kdb/column.h>
+#include <kdb/namelist.h>
+#include <sysalloc.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct blob_buffer
+{
+    void * data;
+    size_t size;
+} blob_buffer;
+
+
+static rc_t blob_buffer_resize( blob_buffer * self, const size_t new_size )
+{
+    if ( new_size > self->size )
+    {
+        void * p = realloc( self->data, new_size );
+        if ( p == NULL )
+            return RC( rcExe, rcNoTarg, rcCopying, rcMemory, rcExhausted );
+        self->data = p;
+        self->size = new_size;
+    }
+    return 0;
+}
+
+
+/* read the whole source-blob into the buffer, the checksum is not part of it */
+static rc_t read_blob( const KColumnBlob * blob, blob_buffer * buf, size_t * blob_size )
+{
+    size_t num_read, remaining;
+    rc_t rc = KColumnBlobRead( blob, 0, buf->data, buf->size, &num_read, &remaining );
+    DISP_RC( rc, "read_blob:KColumnBlobRead() failed" );
+    if ( rc == 0 && remaining > 0 )
+    {
+        rc = blob_buffer_resize( buf, num_read + remaining );
+        DISP_RC( rc, "read_blob:blob_buffer_resize() failed" );
+        if ( rc == 0 )
+        {
+            size_t more;
+            rc = KColumnBlobRead( blob, num_read, ( char * )buf->data + num_read,
+                                  remaining, &more, &remaining );
+            DISP_RC( rc, "read_blob:KColumnBlobRead() failed" );
+            num_read += more;
+        }
+    }
+    *blob_size = num_read;
+    return rc;
+}
+
+
+static rc_t copy_blob( const KColumnBlob * src_blob, KColumn * dst_col,
+                       blob_buffer * buf, int64_t * next_id )
+{
+    int64_t first;
+    uint32_t count;
+    rc_t rc = KColumnBlobIdRange( src_blob, &first, &count );
+    DISP_RC( rc, "copy_blob:KColumnBlobIdRange() failed" );
+    if ( rc == 0 )
+    {
+        size_t blob_size;
+        rc = read_blob( src_blob, buf, &blob_size );
+        if ( rc == 0 )
+        {
+            KColumnBlob * dst_blob;
+            rc = KColumnCreateBlob( dst_col, &dst_blob );
+            DISP_RC( rc, "copy_blob:KColumnCreateBlob() failed" );
+            if ( rc == 0 )
+            {
+                rc = KColumnBlobAppend( dst_blob, buf->data, blob_size );
+                DISP_RC( rc, "copy_blob:KColumnBlobAppend() failed" );
+                if ( rc == 0 )
+                {
+                    rc = KColumnBlobAssignRange( dst_blob, first, count );
+                    DISP_RC( rc, "copy_blob:KColumnBlobAssignRange() failed" );
+                }
+                if ( rc == 0 )
+                {
+                    /* the destination computes its own checksum on commit */
+                    rc = KColumnBlobCommit( dst_blob );
+                    DISP_RC( rc, "copy_blob:KColumnBlobCommit() failed" );
+                }
+                KColumnBlobRelease( dst_blob );
+            }
+        }
+        *next_id = first + count;
+    }
+    return rc;
+}
+
+
+static rc_t copy_column_blobs( const KColumn * src_col, KColumn * dst_col,
+                               const char * col_name, blob_buffer * buf )
+{
+    int64_t first, id;
+    uint64_t count, blobs = 0;
+    rc_t rc = KColumnIdRange( src_col, &first, &count );
+    DISP_RC( rc, "copy_column_blobs:KColumnIdRange() failed" );
+
+    for ( id = first; rc == 0 && id < first + ( int64_t )count; )
+    {
+        const KColumnBlob * src_blob;
+        rc = Quitting();    /* to be able to cancel the loop by signal */
+        if ( rc == 0 )
+        {
+            rc = KColumnOpenBlobRead( src_col, &src_blob, id );
+            if ( rc == 0 )
+            {
+                rc = copy_blob( src_blob, dst_col, buf, &id );
+                KColumnBlobRelease( src_blob );
+                ++blobs;
+            }
+            else if ( GetRCState( rc ) == rcNotFound )
+            {
+                /* a gap in a sparse column */
+                ++id;
+                rc = 0;
+            }
+            else
+            {
+                PLOGERR( klogInt, ( klogInt, rc,
+                         "KColumnOpenBlobRead( col:$(col_name) at row #$(row_nr) ) failed",
+                         "col_name=%s,row_nr=%ld", col_name, id ));
+            }
+        }
+    }
+
+    if ( rc == 0 )
+        PLOGMSG( klogInfo, ( klogInfo, "$(col_name): $(blob_cnt) blobs copied",
+                             "col_name=%s,blob_cnt=%lu", col_name, blobs ));
+    return rc;
+}
+
+
+static rc_t copy_column( const KTable * src_ktab, KTable * dst_ktab,
+                         const char * col_name,
+                         KCreateMode cmode, KChecksum cs_mode,
+                         blob_buffer * buf, const bool show_meta )
+{
+    const KColumn * src_col;
+    rc_t rc = KTableOpenColumnRead( src_ktab, &src_col, "%s", col_name );
+    DISP_RC( rc, "copy_column:KTableOpenColumnRead() failed" );
+    if ( rc == 0 )
+    {
+        KColumn * dst_col;
+        /* same create-mode and checksum as the vdb-layer would use */
+        rc = KTableCreateColumn( dst_ktab, &dst_col, cmode, cs_mode, 0,
+                                 "%s", col_name );
+        DISP_RC( rc, "copy_column:KTableCreateColumn() failed" );
+        if ( rc == 0 )
+        {
+            rc = copy_column_meta( src_col, dst_col, show_meta );
+            if ( rc == 0 )
+                rc = copy_column_blobs( src_col, dst_col, col_name, buf );
+            KColumnRelease( dst_col );
+        }
+        KColumnRelease( src_col );
+    }
+    return rc;
+}
+
+
+rc_t copy_table_blobs ( const VTable *src_table, VTable *dst_table,
+                        KCreateMode cmode, KChecksum cs_mode,
+                        const bool show_meta, const bool show_progress )
+{
+    const KTable * src_ktab;
+    rc_t rc;
+
+    if ( src_table == NULL || dst_table == NULL )
+        return RC( rcExe, rcNoTarg, rcCopying, rcParam, rcNull );
+
+    rc = VTableOpenKTableRead( src_table, &src_ktab );
+    DISP_RC( rc, "copy_table_blobs:VTableOpenKTableRead() failed" );
+    if ( rc == 0 )
+    {
+        KTable * dst_ktab;
+        rc = VTableOpenKTableUpdate( dst_table, &dst_ktab );
+        DISP_RC( rc, "copy_table_blobs:VTableOpenKTableUpdate() failed" );
+        if ( rc == 0 )
+        {
+            KNamelist * names;
+            rc = KTableListCol( src_ktab, &names );
+            DISP_RC( rc, "copy_table_blobs:KTableListCol() failed" );
+            if ( rc == 0 )
+            {
+                uint32_t idx, count;
+                rc = KNamelistCount( names, &count );
+                DISP_RC( rc, "copy_table_blobs:KNamelistCount() failed" );
+                if ( rc == 0 )
+                {
+                    blob_buffer buf;
+                    memset( &buf, 0, sizeof buf );
+                    for ( idx = 0; idx < count && rc == 0; ++idx )
+                    {
+                        const char * col_name;
+                        rc = KNamelistGet( names, idx, &col_name );
+                        DISP_RC( rc, "copy_table_blobs:KNamelistGet() failed" );
+                        if ( rc == 0 )
+                        {
+                            if ( show_progress )
+                                KOutMsg( "blob-copy of >%s<\n", col_name );
+                            rc = copy_column( src_ktab, dst_ktab, col_name,
+                                              cmode, cs_mode, &buf, show_meta );
+                        }
+                    }
+                    free( buf.data );
+                }
+                KNamelistRelease( names );
+            }
+            KTableRelease( dst_ktab );
+        }
+        KTableRelease( src_ktab );
+    }
+    return rc;
+}
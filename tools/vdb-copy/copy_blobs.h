@@ -0,0 +1,57 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _h_copy_blobs_
+#define _h_copy_blobs_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef _h_kdb_manager_
+#include <kdb/manager.h>
+#endif
+
+#ifndef _h_kdb_column_
+#include <kdb/column.h>
+#endif
+
+/*
+ * copies every physical column of the source-table into the
+ * destination-table blob by blob: the encoded blobs are written as they
+ * are read, nothing is decoded or re-encoded by the schema pipeline.
+ * only valid if the destination-table has the same schema as the source
+ * and all rows are copied unchanged
+*/
+rc_t copy_table_blobs ( const VTable *src_table, VTable *dst_table,
+                        KCreateMode cmode, KChecksum cs_mode,
+                        const bool show_meta, const bool show_progress );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
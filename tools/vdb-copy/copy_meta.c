@@ -31,6 +31,7 @@
 #include <klib/printf.h>
 #include <klib/time.h>
 #include <kdb/meta.h>
+#include <kdb/column.h>
 #include <kdb/namelist.h>
 #include <sysalloc.h>
 #include <stdlib.h>
@@ -114,7 +115,9 @@ static rc_t copy_metadata_child ( const KMDataNode *src_root, KMDataNode *dst_ro
         KOutMsg( "copy child-node: %s\n", node_path );
 
     rc = KMDataNodeOpenNodeUpdate ( dst_root, & dnode, node_path );
-    DISP_RC( rc, "copy_metadata_child:KMDataNodeOpenNodeUpdate(dst) failed" );
+    /* a busy node is held open by the vdb-layer, its children are copied anyway */
+    if ( GetRCState( rc ) != rcBusy )
+        DISP_RC( rc, "copy_metadata_child:KMDataNodeOpenNodeUpdate(dst) failed" );
     if ( rc == 0 )
     {
         rc = copy_metadata_data ( snode, dnode );
@@ -482,6 +485,71 @@ rc_t copy_table_meta ( const VTable *src_table, VTable *dst_table,
 }
 
 
+/* copies only the root-nodes named in "nodes" ( if the source has them ) */
+rc_t copy_table_meta_nodes ( const VTable *src_table, VTable *dst_table,
+                             const char * nodes, const bool show_meta )
+{
+    const KMetadata *src_meta;
+    const KNamelist *wanted;
+    rc_t rc;
+
+    if ( src_table == NULL || dst_table == NULL )
+        return RC( rcExe, rcNoTarg, rcCopying, rcParam, rcNull );
+    if ( nodes == NULL )
+        return 0;
+
+    rc = nlt_make_namelist_from_string( &wanted, nodes );
+    DISP_RC( rc, "copy_table_meta_nodes:nlt_make_namelist_from_string() failed" );
+    if ( rc != 0 ) return rc;
+
+    rc = VTableOpenMetadataRead ( src_table, & src_meta );
+    DISP_RC( rc, "copy_table_meta_nodes:VTableOpenMetadataRead() failed" );
+    if ( rc == 0 )
+    {
+        KMetadata *dst_meta;
+        rc = VTableOpenMetadataUpdate ( dst_table, & dst_meta );
+        DISP_RC( rc, "copy_table_meta_nodes:VTableOpenMetadataUpdate() failed" );
+        if ( rc == 0 )
+        {
+            const KMDataNode *src_root;
+            rc = KMetadataOpenNodeRead ( src_meta, & src_root, NULL );
+            DISP_RC( rc, "copy_table_meta_nodes:KMetadataOpenNodeRead() failed" );
+            if ( rc == 0 )
+            {
+                KMDataNode *dst_root;
+                rc = KMetadataOpenNodeUpdate ( dst_meta, & dst_root, NULL );
+                DISP_RC( rc, "copy_table_meta_nodes:KMetadataOpenNodeUpdate() failed" );
+                if ( rc == 0 )
+                {
+                    KNamelist *names;
+                    rc = KMDataNodeListChild ( src_root, & names );
+                    DISP_RC( rc, "copy_table_meta_nodes:KMDataNodeListChild() failed" );
+                    if ( rc == 0 )
+                    {
+                        uint32_t i, count;
+                        rc = KNamelistCount ( names, & count );
+                        for ( i = 0; rc == 0 && i < count; ++ i )
+                        {
+                            const char *node_path;
+                            rc = KNamelistGet ( names, i, & node_path );
+                            if ( rc == 0 && nlt_is_name_in_namelist( wanted, node_path ) )
+                                rc = copy_metadata_child ( src_root, dst_root, node_path, show_meta );
+                        }
+                        KNamelistRelease ( names );
+                    }
+                    KMDataNodeRelease ( dst_root );
+                }
+                KMDataNodeRelease ( src_root );
+            }
+            KMetadataRelease ( dst_meta );
+        }
+        KMetadataRelease ( src_meta );
+    }
+    KNamelistRelease( wanted );
+    return rc;
+}
+
+
 rc_t copy_database_meta ( const VDatabase *src_db, VDatabase *dst_db,
                           const char * excluded_nodes,
                           const bool show_meta )
@@ -516,3 +584,36 @@ rc_t copy_database_meta ( const VDatabase *src_db, VDatabase *dst_db,
     }
     return rc;
 }
+
+
+rc_t copy_column_meta ( const KColumn *src_col, KColumn *dst_col,
+                        const bool show_meta )
+{
+    const KMetadata *src_meta;
+    rc_t rc;
+
+    if ( src_col == NULL || dst_col == NULL )
+        return RC( rcExe, rcNoTarg, rcCopying, rcParam, rcNull );
+
+    rc = KColumnOpenMetadataRead ( src_col, & src_meta );
+    DISP_RC( rc, "copy_column_meta:KColumnOpenMetadataRead() failed" );
+    if ( rc == 0 )
+    {
+        KMetadata *dst_meta;
+        rc = KColumnOpenMetadataUpdate ( dst_col, & dst_meta );
+        DISP_RC( rc, "copy_column_meta:KColumnOpenMetadataUpdate() failed" );
+        if ( rc == 0 )
+        {
+            if ( show_meta )
+                KOutMsg( "+++copy column-metadata\n" );
+
+            rc = copy_stray_metadata ( src_meta, dst_meta, NULL, show_meta );
+            if ( show_meta )
+                KOutMsg( "+++end of copy column-metadata\n" );
+
+            KMetadataRelease ( dst_meta );
+        }
+        KMetadataRelease ( src_meta );
+    }
+    return rc;
+}
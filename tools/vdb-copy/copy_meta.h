@@ -35,10 +35,19 @@ rc_t copy_table_meta ( const VTable *src_table, VTable *dst_table,
                        const char * excluded_nodes,
                        const bool show_meta, const bool schema_updated );
 
+/* copies only the named root-nodes, used by the blob-copy for the
+   nodes excluded above, because no cursor is going to re-create them */
+rc_t copy_table_meta_nodes ( const VTable *src_table, VTable *dst_table,
+                             const char * nodes, const bool show_meta );
+
 rc_t copy_database_meta ( const VDatabase *src_db, VDatabase *dst_db,
                           const char * excluded_nodes,
                           const bool show_meta );
 
+/* copies the metadata of a physical column, used by the blob-copy */
+rc_t copy_column_meta ( const struct KColumn *src_col, struct KColumn *dst_col,
+                        const bool show_meta );
+
 #ifdef __cplusplus
 }
 #endif
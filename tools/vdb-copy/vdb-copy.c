@@ -35,9 +35,11 @@
 #include "copy_meta.h"
 #include "type_matcher.h"
 #include "redactval.h"
+#include "copy_blobs.h"
 
 #include <kapp/main.h>
 #include <sysalloc.h>
+#include <bitstr.h>
 
 /*
 #if _DEBUGGING
@@ -72,6 +74,7 @@ static const char * md5mode_usage[] = { "MD5-mode def.: auto, '1'...forced ON, '
 static const char * blcmode_usage[] = { "Blob-checksum def.: auto, '1'...CRC32, 'M'...MD5, '0'...OFF)", NULL };
 static const char * force_usage[] = { "forces an existing target to be overwritten", NULL };
 static const char * unlock_usage[] = { "forces a locked target to be unlocked", NULL };
+static const char * row_copy_usage[] = { "copy row by row, even if the blobs could be copied unchanged", NULL };
 
 OptDef MyOptions[] =
 {
@@ -97,7 +100,8 @@ OptDef MyOptions[] =
     { OPTION_MD5_MODE, ALIAS_MD5_MODE, NULL, md5mode_usage, 1, true, false },
     { OPTION_BLOB_CHECKSUM, ALIAS_BLOB_CHECKSUM, NULL, blcmode_usage, 1, true, false },
     { OPTION_FORCE, ALIAS_FORCE, NULL, force_usage, 1, false, false },
-    { OPTION_UNLOCK, ALIAS_UNLOCK, NULL, unlock_usage, 1, false, false }
+    { OPTION_UNLOCK, ALIAS_UNLOCK, NULL, unlock_usage, 1, false, false },
+    { OPTION_ROW_COPY, ALIAS_ROW_COPY, NULL, row_copy_usage, 1, false, false }
 };
 
 
@@ -153,6 +157,7 @@ rc_t CC Usage ( const Args * args )
     HelpOptionLine ( ALIAS_UNLOCK, OPTION_UNLOCK, NULL, unlock_usage );
     HelpOptionLine ( ALIAS_MD5_MODE, OPTION_MD5_MODE, NULL, md5mode_usage );
     HelpOptionLine ( ALIAS_BLOB_CHECKSUM, OPTION_BLOB_CHECKSUM, NULL, blcmode_usage );
+    HelpOptionLine ( ALIAS_ROW_COPY, OPTION_ROW_COPY, NULL, row_copy_usage );
 
     HelpOptionsStandard ();
 
@@ -509,6 +514,110 @@ static rc_t vdb_copy_row_loop( const p_context ctx,
 }
 
 
+/* reads the filter-column over all rows:
+   true if the row-loop would reject or redact at least one row */
+static bool vdb_copy_rows_filtered( const p_context ctx,
+                                    const VCursor * src_cursor,
+                                    col_defs * columns )
+{
+    p_col_def filter_col_def;
+    bool redactable = false;
+    int64_t first, id;
+    uint64_t count;
+    uint32_t idx, len;
+    rc_t rc;
+
+    if ( columns->filter_idx == -1 )
+        return false;
+    filter_col_def = col_defs_get( columns, columns->filter_idx );
+    if ( filter_col_def == NULL || !filter_col_def->src_valid )
+        return false;
+
+    len = VectorLength( &(columns->cols) );
+    for ( idx = 0; idx < len && !redactable; ++idx )
+    {
+        p_col_def col = (p_col_def) VectorGet ( &(columns->cols), idx );
+        if ( col != NULL && col->redactable )
+            redactable = true;
+    }
+    if ( ctx->ignore_reject && ( ctx->ignore_redact || !redactable ) )
+        return false;
+
+    rc = VCursorIdRange( src_cursor, filter_col_def->src_idx, &first, &count );
+    DISP_RC( rc, "vdb_copy_rows_filtered:VCursorIdRange() failed" );
+    for ( id = first; rc == 0 && id < first + ( int64_t )count; )
+    {
+        uint32_t offsets[ 1024 ], lengths[ 1024 ];
+        uint32_t elem_bits, num_rows, i;
+        const void * base;
+
+        rc = VCursorCellDataRange( src_cursor, filter_col_def->src_idx, id, 1024,
+                                   &elem_bits, &base, offsets, lengths, &num_rows );
+        DISP_RC( rc, "vdb_copy_rows_filtered:VCursorCellDataRange() failed" );
+        for ( i = 0; rc == 0 && i < num_rows; ++i )
+        {
+            uint64_t filter = 0;
+            if ( lengths[ i ] > 0 && elem_bits <= 64 )
+                bitcpy ( &filter, 0, base, ( bitsz_t )offsets[ i ] * elem_bits, elem_bits );
+            switch( filter )
+            {
+            case SRA_READ_FILTER_REJECT :
+                if ( ctx->ignore_reject == false ) return true;
+                break;
+
+            case SRA_READ_FILTER_REDACTED :
+                if ( ctx->ignore_redact == false && redactable ) return true;
+                break;
+            }
+        }
+        id += num_rows;
+    }
+    /* if we cannot tell, the row-loop has to do the work */
+    return ( rc != 0 );
+}
+
+
+/* the encoded blobs can be copied as they are instead of decoding and
+   re-encoding every cell, if the destination has the same schema and
+   every row and every column is copied without being filtered or redacted */
+static bool vdb_copy_blobs_possible( const p_context ctx,
+                                     const VCursor * src_cursor,
+                                     col_defs * columns,
+                                     const char * requested,
+                                     const bool is_legacy,
+                                     const bool all_rows )
+{
+    if ( ctx->row_copy || is_legacy || !all_rows )
+        return false;
+    if ( ctx->excluded_columns != NULL )
+        return false;
+    if ( requested != NULL && nlt_strcmp( requested, "*" ) != 0 )
+        return false;
+    return !vdb_copy_rows_filtered( ctx, src_cursor, columns );
+}
+
+
+static rc_t vdb_copy_blobs( const p_context ctx,
+                            const VTable * src_table,
+                            VTable * dst_table,
+                            KCreateMode cmode )
+{
+    /* the metadata-nodes usually excluded ( col, .seq, STATS ) are written
+       by the write-cursor of the row-loop, there is none in this case */
+    rc_t rc = copy_table_meta_nodes( src_table, dst_table,
+                                     ctx->config.meta_ignore_nodes, ctx->show_meta );
+    if ( rc == 0 )
+    {
+        KChecksum cs_mode = helper_assemble_ChecksumMode( ctx->blob_checksum );
+        rc = copy_table_blobs( src_table, dst_table, cmode, cs_mode,
+                               ctx->show_meta, ctx->show_progress );
+    }
+    if ( rc == 0 )
+        LOGMSG( klogInfo, "blobs copied unchanged" );
+    return rc;
+}
+
+
 static rc_t vdb_copy_make_dst_table( const p_context ctx,
                                      VDBManager * vdb_mgr, 
                                      const VSchema * src_schema,
@@ -886,33 +995,45 @@ static rc_t vdb_copy_table2( const p_context ctx,
 
     KCreateMode cmode = helper_assemble_CreateMode( src_table, 
                               ctx->force_kcmInit, ctx->md5_mode );
+    /* the row-range gets filled in by opening the source-table */
+    bool all_rows = num_gen_empty( ctx->row_generator );
     rc_t rc = vdb_copy_open_source_table( ctx, vdb_mgr, src_schema, &dst_schema,
                                      src_table, src_cursor, cmode, &dst_table, columns,
                                      &is_legacy, type_matcher );
     if ( rc == 0 )
     {
-        VCursor * dst_cursor;
-        rc = vdb_copy_open_dest_table( ctx, src_table, dst_table, &dst_cursor, columns, 
-                                       is_legacy );
-        if ( rc == 0 )
-        {
-            /* this function does not fail, because it is ok to not find
-               filter-column, redactable types and excluded columns */
-            vdb_copy_find_filter_and_redact_columns( src_schema,
-                                   columns, &(ctx->config), type_matcher );
+        VCursor * dst_cursor = NULL;
 
-            rc = vdb_copy_row_loop( ctx, src_cursor, dst_cursor,
-                                    columns, ctx->rvals );
+        /* this function does not fail, because it is ok to not find
+           filter-column, redactable types and excluded columns */
+        vdb_copy_find_filter_and_redact_columns( src_schema,
+                               columns, &(ctx->config), type_matcher );
 
-            VCursorRelease( dst_cursor );
+        if ( vdb_copy_blobs_possible( ctx, src_cursor, columns, ctx->columns,
+                                      is_legacy, all_rows ) )
+        {
+            rc = copy_table_meta( src_table, dst_table, 
+                                  ctx->config.meta_ignore_nodes, 
+                                  ctx->show_meta, is_legacy );
             if ( rc == 0 )
+                rc = vdb_copy_blobs( ctx, src_table, dst_table, cmode );
+        }
+        else
+        {
+            rc = vdb_copy_open_dest_table( ctx, src_table, dst_table, &dst_cursor, columns, 
+                                           is_legacy );
+            if ( rc == 0 )
+                rc = vdb_copy_row_loop( ctx, src_cursor, dst_cursor,
+                                        columns, ctx->rvals );
+            VCursorRelease( dst_cursor );
+        }
+        if ( rc == 0 )
+        {
+            if ( ctx->reindex )
             {
-                if ( ctx->reindex )
-                {
-                    /* releasing the cursor is necessary for reindex */
-                    rc = VTableReindex( dst_table );
-                    DISP_RC( rc, "vdb_copy_table2:VTableReindex() failed" );
-                }
+                /* releasing the cursor is necessary for reindex */
+                rc = VTableReindex( dst_table );
+                DISP_RC( rc, "vdb_copy_table2:VTableReindex() failed" );
             }
         }
         VSchemaRelease( dst_schema );
@@ -971,6 +1092,9 @@ static rc_t vdb_copy_table( const p_context ctx,
 
 /*-----------------------------------------------------------------------------*/
 static rc_t vdb_copy_cur_2_cur( const p_context ctx,
+                                const VTable * src_tab,
+                                VTable * dst_tab,
+                                KCreateMode cmode,
                                 const VCursor * src_cursor,
                                 VCursor * dst_cursor,
                                 const VSchema * schema,
@@ -982,45 +1106,53 @@ static rc_t vdb_copy_cur_2_cur( const p_context ctx,
     DISP_RC( rc, "vdb_copy_cur_2_cur:col_defs_apply_casts() failed" );
     if ( rc == 0 )
     {
-        rc = col_defs_add_to_wr_cursor( columns, dst_cursor, false );
-        DISP_RC( rc, "vdb_copy_cur_2_cur:col_defs_add_to_wr_cursor(dst) failed" );
+        rc = col_defs_add_to_rd_cursor( columns, src_cursor, false );
+        DISP_RC( rc, "vdb_copy_cur_2_cur:col_defs_add_to_rd_cursor() failed" );
         if ( rc == 0 )
         {
-            rc = VCursorOpen( dst_cursor );
-            DISP_RC( rc, "vdb_copy_cur_2_cur:VCursorOpen(dst) failed" );
+            rc = VCursorOpen( src_cursor );
+            DISP_RC( rc, "vdb_copy_cur_2_cur:VCursorOpen(src) failed" );
             if ( rc == 0 )
             {
-                rc = col_defs_add_to_rd_cursor( columns, src_cursor, false );
-                DISP_RC( rc, "vdb_copy_cur_2_cur:col_defs_add_to_rd_cursor() failed" );
+                /* set the row-range in ctx to cover the whole table */
+                rc = vdb_copy_set_range( ctx, src_cursor );
+                DISP_RC( rc, "vdb_copy_cur_2_cur:vdb_copy_check_range(src) failed" );
                 if ( rc == 0 )
                 {
-                    rc = VCursorOpen( src_cursor );
-                    DISP_RC( rc, "vdb_copy_cur_2_cur:VCursorOpen(src) failed" );
-                    if ( rc == 0 )
-                    {
-                        /* set the row-range in ctx to cover the whole table */
-                        rc = vdb_copy_set_range( ctx, src_cursor );
-                        DISP_RC( rc, "vdb_copy_cur_2_cur:vdb_copy_check_range(src) failed" );
-                        if ( rc == 0 )
-                        {
-                            /* it is ok to not find a filter-column: no error in this case */
-                            col_defs_detect_filter_col( columns,
-                                                        ctx->config.filter_col_name );
+                    /* it is ok to not find a filter-column: no error in this case */
+                    col_defs_detect_filter_col( columns,
+                                                ctx->config.filter_col_name );
 
-                            /* it is ok to not find columns excluded from redacting: no error in this case */
-                            col_defs_unmark_do_not_redact_columns( columns,
-                                            ctx->config.do_not_redact_columns );
+                    /* it is ok to not find columns excluded from redacting: no error in this case */
+                    col_defs_unmark_do_not_redact_columns( columns,
+                                    ctx->config.do_not_redact_columns );
 
-                            if ( ctx->show_progress )
-                                KOutMsg( "copy of >%s<\n", tab_name );
+                    if ( ctx->show_progress )
+                        KOutMsg( "copy of >%s<\n", tab_name );
 
-                            vdb_copy_find_filter_and_redact_columns( schema,
-                                                   columns, &(ctx->config), type_matcher );
+                    vdb_copy_find_filter_and_redact_columns( schema,
+                                           columns, &(ctx->config), type_matcher );
 
-                            /**************************************************/
-                            rc = vdb_copy_row_loop( ctx, src_cursor, dst_cursor,
-                                                    columns, ctx->rvals );
-                            /**************************************************/
+                    /* the dst-cursor is opened only for the row-copy,
+                       it would create the columns otherwise */
+                    if ( vdb_copy_blobs_possible( ctx, src_cursor, columns, NULL,
+                                                  false, true ) )
+                        rc = vdb_copy_blobs( ctx, src_tab, dst_tab, cmode );
+                    else
+                    {
+                        rc = col_defs_add_to_wr_cursor( columns, dst_cursor, false );
+                        DISP_RC( rc, "vdb_copy_cur_2_cur:col_defs_add_to_wr_cursor(dst) failed" );
+                        if ( rc == 0 )
+                        {
+                            rc = VCursorOpen( dst_cursor );
+                            DISP_RC( rc, "vdb_copy_cur_2_cur:VCursorOpen(dst) failed" );
+                            if ( rc == 0 )
+                            {
+                                /**************************************************/
+                                rc = vdb_copy_row_loop( ctx, src_cursor, dst_cursor,
+                                                        columns, ctx->rvals );
+                                /**************************************************/
+                            }
                         }
                     }
                 }
@@ -1033,6 +1165,7 @@ static rc_t vdb_copy_cur_2_cur( const p_context ctx,
 static rc_t vdb_copy_tab_2_tab( const p_context ctx,
                                 const VTable * src_tab,
                                 VTable * dst_tab,
+                                KCreateMode cmode,
                                 const char * tab_name )
 {
     const VSchema * schema;
@@ -1078,7 +1211,8 @@ static rc_t vdb_copy_tab_2_tab( const p_context ctx,
                                     if ( rc == 0 )
                                     {
                                         /*****************************************************/
-                                        rc = vdb_copy_cur_2_cur( ctx, src_cursor, dst_cursor,
+                                        rc = vdb_copy_cur_2_cur( ctx, src_tab, dst_tab, cmode,
+                                                                 src_cursor, dst_cursor,
                                                                  schema, columns, type_matcher,
                                                                  tab_name );
                                         /*****************************************************/
@@ -1132,7 +1266,7 @@ static rc_t vdb_copy_db_tab( const p_context ctx,
                 if ( rc == 0 )
                 {
                     /********************************************************/
-                    rc = vdb_copy_tab_2_tab( ctx, src_tab, dst_tab, tab_name );
+                    rc = vdb_copy_tab_2_tab( ctx, src_tab, dst_tab, cmode, tab_name );
                     /********************************************************/
                 }
             }
@@ -0,0 +1,100 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include "vdb-dump-cells.h"
+
+#include <klib/rc.h>
+
+
+void vdcw_init( cell_window * win )
+{
+    if ( win == NULL ) return;
+    win->blob = NULL;
+    win->base = NULL;
+    win->first = 0;
+    win->count = 0;
+    win->elem_bits = 0;
+}
+
+
+void vdcw_release( cell_window * win )
+{
+    if ( win == NULL ) return;
+    if ( win->blob != NULL )
+        VBlobRelease( win->blob );
+    vdcw_init( win );
+}
+
+
+static rc_t vdcw_fill( cell_window * win, const VCursor * cursor, uint32_t idx,
+                       int64_t row_id )
+{
+    const VBlob * blob;
+    rc_t rc = VCursorGetBlobDirect( cursor, &blob, row_id, idx );
+    vdcw_release( win );
+    if ( rc == 0 )
+    {
+        win->blob = blob;
+        rc = VBlobCellDataRange( blob, row_id, CELL_WINDOW_ROWS, &win->elem_bits,
+                                 ( const void ** )&win->base, win->offsets,
+                                 win->lengths, &win->count );
+        if ( rc == 0 )
+            win->first = row_id;
+        else
+            vdcw_release( win );
+    }
+    return rc;
+}
+
+
+rc_t vdcw_read( cell_window * win, const VCursor * cursor, uint32_t idx,
+                int64_t row_id, const void ** base, uint32_t * boff,
+                uint32_t * row_len )
+{
+    rc_t rc = 0;
+    if ( win == NULL || base == NULL || boff == NULL || row_len == NULL )
+        return RC( rcExe, rcCursor, rcReading, rcParam, rcNull );
+
+    if ( win->blob == NULL || row_id < win->first ||
+         row_id >= win->first + ( int64_t )win->count )
+        rc = vdcw_fill( win, cursor, idx, row_id );
+
+    if ( rc == 0 )
+    {
+        uint32_t i = ( uint32_t )( row_id - win->first );
+        uint64_t bits = ( uint64_t )win->offsets[ i ] * win->elem_bits;
+        *base = win->base + ( bits >> 3 );
+        *boff = ( uint32_t )( bits & 7 );
+        *row_len = win->lengths[ i ];
+    }
+    else
+    {
+        *base = NULL;
+        *boff = 0;
+        *row_len = 0;
+    }
+    return rc;
+}
@@ -0,0 +1,73 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _h_vdb_dump_cells_
+#define _h_vdb_dump_cells_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <vdb/cursor.h>
+#include <vdb/blob.h>
+
+/********************************************************************************
+
+                   A CELL WINDOW
+
+holds a reference to the blob containing a run of rows of one column,
+together with the offsets and lengths of these rows taken from its pagemap.
+consecutive rows are answered from the window without calling the cursor.
+
+********************************************************************************/
+#define CELL_WINDOW_ROWS 1024
+
+typedef struct cell_window
+{
+    const VBlob * blob;
+    const uint8_t * base;
+    int64_t first;
+    uint32_t count;
+    uint32_t elem_bits;
+    uint32_t offsets[ CELL_WINDOW_ROWS ];
+    uint32_t lengths[ CELL_WINDOW_ROWS ];
+} cell_window;
+typedef cell_window* p_cell_window;
+
+void vdcw_init( cell_window * win );
+void vdcw_release( cell_window * win );
+
+/* same outputs as VCursorCellDataDirect(), the window is refilled
+   from the cursor if "row_id" is not in it */
+rc_t vdcw_read( cell_window * win, const VCursor * cursor, uint32_t idx,
+                int64_t row_id, const void ** base, uint32_t * boff,
+                uint32_t * row_len );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -309,6 +309,11 @@ void vdcd_destroy_col( p_col_def col_def )
     if ( col_def == NULL ) return;
     if ( col_def->name ) free( col_def->name );
     vds_free( &( col_def->content ) );
+    if ( col_def->window )
+    {
+        vdcw_release( col_def->window );
+        free( col_def->window );
+    }
     free( col_def );
 }
 
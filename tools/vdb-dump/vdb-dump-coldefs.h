@@ -36,6 +36,7 @@
 #include <klib/text.h>
 
 #include "vdb-dump-str.h"
+#include "vdb-dump-cells.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -66,6 +67,7 @@ typedef struct col_def
     dump_str content;
     value_trans_fct_t value_trans_fct;
     dim_trans_fct_t dim_trans_fct;
+    p_cell_window window;
 } col_def;
 typedef col_def* p_col_def;
 
@@ -42,6 +42,9 @@
 #include <string.h>
 #include <assert.h>
 
+/* every formatting thread holds a few chunks of rows in flight */
+#define MAX_THREADS 64
+
 /********************************************************************
 the dump context contains all informations needed to execute the dump
 ********************************************************************/
@@ -111,6 +114,7 @@ static void vdco_init_values( p_dump_context ctx )
 	ctx->idx_enum_requested = false;
 	ctx->idx_range_requested = false;
     ctx->disable_multithreading = false;
+    ctx->threads = 1;
 }
 
 rc_t vdco_init( dump_context **ctx )
@@ -517,6 +521,28 @@ static void vdco_evaluate_options( const Args *my_args,
     vdco_set_boolean_char( ctx, vdco_get_str_option( my_args, OPTION_BOOLEAN ) );
 }
 
+static rc_t vdco_set_threads( const Args *my_args, dump_context *ctx )
+{
+    const char *s = vdco_get_str_option( my_args, OPTION_THREADS );
+
+    ctx->threads = 1;
+    if ( s != NULL )
+    {
+        char *end;
+        unsigned long threads = strtoul( s, &end, 0 );
+        if ( threads == 0 || threads > MAX_THREADS || *end != 0 )
+        {
+            rc_t rc = RC( rcVDB, rcNoTarg, rcConstructing, rcParam, rcExcessive );
+            PLOGERR( klogErr, ( klogErr, rc, "invalid number of threads $(v), must be 1 to $(max)",
+                                "v=%s,max=%u", s, MAX_THREADS ) );
+            return rc;
+        }
+        if ( !ctx->disable_multithreading )
+            ctx->threads = ( uint16_t )threads;
+    }
+    return 0;
+}
+
 rc_t vdco_capture_arguments_and_options( const Args * args, dump_context *ctx)
 {
     rc_t rc;
@@ -525,5 +551,7 @@ rc_t vdco_capture_arguments_and_options( const Args * args, dump_context *ctx)
 
     rc = ArgsHandleLogLevel( args );
     DISP_RC( rc, "ArgsHandleLogLevel() failed" );
+    if ( rc == 0 )
+        rc = vdco_set_threads( args, ctx );
     return rc;
 }
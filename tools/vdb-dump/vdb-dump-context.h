@@ -76,6 +76,7 @@ extern "C" {
 #define OPTION_BZIP2             "bzip2"
 #define OPTION_OUT_BUF_SIZE      "output-buffer-size"
 #define OPTION_NO_MULTITHREAD    "disable-multithreading"
+#define OPTION_THREADS           "threads"
 
 #define ALIAS_ROW_ID_ON         "I"
 #define ALIAS_LINE_FEED         "l"
@@ -141,6 +142,7 @@ typedef struct dump_context
     uint32_t generic_idx;
     size_t cur_cache_size;
     size_t output_buffer_size;
+    uint16_t threads;
     dump_format_t format;
     out_redir_mode_t compress_mode;
     char c_boolean;
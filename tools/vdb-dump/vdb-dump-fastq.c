@@ -27,6 +27,7 @@
 #include "vdb-dump-fastq.h"
 #include "vdb-dump-helper.h"
 #include "vdb-dump-num-gen.h"
+#include "vdb-dump-cells.h"
 
 #include <stdlib.h>
 
@@ -46,6 +47,9 @@ typedef struct fastq_ctx
     uint32_t idx_read;
     uint32_t idx_qual;
     uint32_t idx_name;    
+    cell_window win_read;
+    cell_window win_qual;
+    cell_window win_name;
 } fastq_ctx;
 
 
@@ -55,7 +59,7 @@ static void vdb_fastq_row_error( const char * fmt, rc_t rc, int64_t row_id )
 }
 
 
-static rc_t vdb_fastq_loop_with_name( const p_dump_context ctx, const fastq_ctx * fctx )
+static rc_t vdb_fastq_loop_with_name( const p_dump_context ctx, fastq_ctx * fctx )
 {
     rc_t rc = 0;
     int64_t row_id;
@@ -66,30 +70,30 @@ static rc_t vdb_fastq_loop_with_name( const p_dump_context ctx, const fastq_ctx
         rc = Quitting();
         if ( rc == 0 )
         {
-            uint32_t elem_bits, boff, row_len, name_len;
+            uint32_t boff, row_len, name_len;
             const char * data;
             const char * name;
 
-            rc = VCursorCellDataDirect( fctx->cursor, row_id, fctx->idx_name, &elem_bits,
-                                        (const void**)&name, &boff, &name_len );
+            rc = vdcw_read( &fctx->win_name, fctx->cursor, fctx->idx_name, row_id,
+                            (const void**)&name, &boff, &name_len );
             if ( rc != 0 )
-                vdb_fastq_row_error( "VCursorCellDataDirect( row#$(row_nr), NAME ) failed", rc, row_id );
+                vdb_fastq_row_error( "vdcw_read( row#$(row_nr), NAME ) failed", rc, row_id );
             else
             {
-                rc = VCursorCellDataDirect( fctx->cursor, row_id, fctx->idx_read, &elem_bits,
-                                            (const void**)&data, &boff, &row_len );
+                rc = vdcw_read( &fctx->win_read, fctx->cursor, fctx->idx_read, row_id,
+                                (const void**)&data, &boff, &row_len );
                 if ( rc != 0 )
-                    vdb_fastq_row_error( "VCursorCellDataDirect( row#$(row_nr), READ ) failed", rc, row_id );
+                    vdb_fastq_row_error( "vdcw_read( row#$(row_nr), READ ) failed", rc, row_id );
                 else
                 {
                     rc = KOutMsg( "@%s.%li %.*s length=%u\n%.*s\n",
                                   fctx->run_name, row_id, name_len, name, row_len, row_len, data );
                     if ( rc == 0 )
                     {
-                        rc = VCursorCellDataDirect( fctx->cursor, row_id, fctx->idx_qual, &elem_bits,
-                                                    (const void**)&data, &boff, &row_len );
+                        rc = vdcw_read( &fctx->win_qual, fctx->cursor, fctx->idx_qual, row_id,
+                                        (const void**)&data, &boff, &row_len );
                         if ( rc != 0 )
-                            vdb_fastq_row_error( "VCursorCellDataDirect( row#$(row_nr), QUALITY ) failed", rc, row_id );
+                            vdb_fastq_row_error( "vdcw_read( row#$(row_nr), QUALITY ) failed", rc, row_id );
                         else
                             rc = KOutMsg( "+%s.%li %.*s length=%u\n%.*s\n",
                                           fctx->run_name, row_id, name_len, name, row_len, row_len, data );
@@ -102,7 +106,7 @@ static rc_t vdb_fastq_loop_with_name( const p_dump_context ctx, const fastq_ctx
 }
 
 
-static rc_t vdb_fasta_loop_with_name( const p_dump_context ctx, const fastq_ctx * fctx )
+static rc_t vdb_fasta_loop_with_name( const p_dump_context ctx, fastq_ctx * fctx )
 {
     rc_t rc = 0;
     int64_t row_id;
@@ -113,20 +117,20 @@ static rc_t vdb_fasta_loop_with_name( const p_dump_context ctx, const fastq_ctx
         rc = Quitting();
         if ( rc == 0 )
         {
-            uint32_t elem_bits, boff, row_len, name_len;
+            uint32_t boff, row_len, name_len;
             const char * data;
             const char * name;
 
-            rc = VCursorCellDataDirect( fctx->cursor, row_id, fctx->idx_name, &elem_bits,
-                                        (const void**)&name, &boff, &name_len );
+            rc = vdcw_read( &fctx->win_name, fctx->cursor, fctx->idx_name, row_id,
+                            (const void**)&name, &boff, &name_len );
             if ( rc != 0 )
-                vdb_fastq_row_error( "VCursorCellDataDirect( row#$(row_nr), NAME ) failed", rc, row_id );
+                vdb_fastq_row_error( "vdcw_read( row#$(row_nr), NAME ) failed", rc, row_id );
             else
             {
-                rc = VCursorCellDataDirect( fctx->cursor, row_id, fctx->idx_read, &elem_bits,
-                                            (const void**)&data, &boff, &row_len );
+                rc = vdcw_read( &fctx->win_read, fctx->cursor, fctx->idx_read, row_id,
+                                (const void**)&data, &boff, &row_len );
                 if ( rc != 0 )
-                    vdb_fastq_row_error( "VCursorCellDataDirect( row#$(row_nr), READ ) failed", rc, row_id );
+                    vdb_fastq_row_error( "vdcw_read( row#$(row_nr), READ ) failed", rc, row_id );
                 else
                 {
                     uint32_t idx = 0;
@@ -155,7 +159,7 @@ static rc_t vdb_fasta_loop_with_name( const p_dump_context ctx, const fastq_ctx
 }
 
 
-static rc_t vdb_fastq_loop_without_name( const p_dump_context ctx, const fastq_ctx * fctx )
+static rc_t vdb_fastq_loop_without_name( const p_dump_context ctx, fastq_ctx * fctx )
 {
     rc_t rc = 0;
     int64_t row_id;
@@ -166,23 +170,23 @@ static rc_t vdb_fastq_loop_without_name( const p_dump_context ctx, const fastq_c
         rc = Quitting();
         if ( rc == 0 )
         {
-            uint32_t elem_bits, boff, row_len;
+            uint32_t boff, row_len;
             const char * data;
 
-            rc = VCursorCellDataDirect( fctx->cursor, row_id, fctx->idx_read, &elem_bits,
-                                        (const void**)&data, &boff, &row_len );
+            rc = vdcw_read( &fctx->win_read, fctx->cursor, fctx->idx_read, row_id,
+                            (const void**)&data, &boff, &row_len );
             if ( rc != 0 )
-                vdb_fastq_row_error( "VCursorCellDataDirect( row#$(row_nr), READ ) failed", rc, row_id );
+                vdb_fastq_row_error( "vdcw_read( row#$(row_nr), READ ) failed", rc, row_id );
             else
             {
                 rc = KOutMsg( "@%s.%li %li length=%u\n%.*s\n",
                               fctx->run_name, row_id, row_id, row_len, row_len, data );
                 if ( rc == 0 )
                 {
-                    rc = VCursorCellDataDirect( fctx->cursor, row_id, fctx->idx_qual, &elem_bits,
-                                                (const void**)&data, &boff, &row_len );
+                    rc = vdcw_read( &fctx->win_qual, fctx->cursor, fctx->idx_qual, row_id,
+                                    (const void**)&data, &boff, &row_len );
                     if ( rc != 0 )
-                        vdb_fastq_row_error( "VCursorCellDataDirect( row#$(row_nr), QUALITY ) failed", rc, row_id );
+                        vdb_fastq_row_error( "vdcw_read( row#$(row_nr), QUALITY ) failed", rc, row_id );
                     else
                         rc = KOutMsg( "+%s.%li %li length=%u\n%.*s\n",
                                       fctx->run_name, row_id, row_id, row_len, row_len, data );
@@ -194,7 +198,7 @@ static rc_t vdb_fastq_loop_without_name( const p_dump_context ctx, const fastq_c
 }
 
 
-static rc_t vdb_fasta_loop_without_name( const p_dump_context ctx, const fastq_ctx * fctx )
+static rc_t vdb_fasta_loop_without_name( const p_dump_context ctx, fastq_ctx * fctx )
 {
     rc_t rc = 0;
     int64_t row_id;
@@ -205,13 +209,13 @@ static rc_t vdb_fasta_loop_without_name( const p_dump_context ctx, const fastq_c
         rc = Quitting();
         if ( rc == 0 )
         {
-            uint32_t elem_bits, boff, row_len;
+            uint32_t boff, row_len;
             const char * data;
 
-            rc = VCursorCellDataDirect( fctx->cursor, row_id, fctx->idx_read, &elem_bits,
-                                        (const void**)&data, &boff, &row_len );
+            rc = vdcw_read( &fctx->win_read, fctx->cursor, fctx->idx_read, row_id,
+                            (const void**)&data, &boff, &row_len );
             if ( rc != 0 )
-                vdb_fastq_row_error( "VCursorCellDataDirect( row#$(row_nr), READ ) failed", rc, row_id );
+                vdb_fastq_row_error( "vdcw_read( row#$(row_nr), READ ) failed", rc, row_id );
             else
             {
                 uint32_t idx = 0;
@@ -307,6 +311,10 @@ static rc_t vdb_fastq_tbl( const p_dump_context ctx,
 
             if ( vdn_range_defined( ctx->row_generator ) )
             {
+                vdcw_init( &fctx->win_read );
+                vdcw_init( &fctx->win_qual );
+                vdcw_init( &fctx->win_name );
+
                 if ( ctx->format == df_fastq )
                 {
                     if ( fctx->idx_name == INVALID_COLUMN)
@@ -323,6 +331,10 @@ static rc_t vdb_fastq_tbl( const p_dump_context ctx,
                     else
                         rc = vdb_fasta_loop_with_name( ctx, fctx ); /* <--- */
                 }
+
+                vdcw_release( &fctx->win_read );
+                vdcw_release( &fctx->win_qual );
+                vdcw_release( &fctx->win_name );
             }
             else
             {
@@ -29,8 +29,43 @@
 
 #include <klib/rc.h>
 #include <klib/log.h>
+#include <klib/text.h>
 #define DISP_RC(rc,err) if( rc != 0 ) LOGERR( klogInt, rc, err );
 
+/*************************************************************************************
+    the formatted rows are collected in r_ctx->out and written by the caller,
+    nothing on the way goes through printf-style formatting
+*************************************************************************************/
+static rc_t vdfo_puts( const p_row_context r_ctx, const char *s )
+{
+    return vds_append_buf( r_ctx->out, s, string_size( s ) );
+}
+
+static rc_t vdfo_put_u64( const p_row_context r_ctx, uint64_t value )
+{
+    char temp[ 24 ];
+    size_t i = sizeof temp;
+    do
+    {
+        temp[ --i ] = ( char )( '0' + value % 10 );
+        value /= 10;
+    } while ( value != 0 );
+    return vds_append_buf( r_ctx->out, &temp[ i ], sizeof temp - i );
+}
+
+rc_t vdfo_write( p_dump_str out )
+{
+    rc_t rc = 0;
+    KWrtWriter writer = KOutWriterGet();
+    if ( writer != NULL && out->str_len > 0 )
+    {
+        size_t num_writ;
+        rc = writer( KOutDataGet(), out->buf, out->str_len, &num_writ );
+    }
+    vds_clear( out );
+    return rc;
+}
+
 /*************************************************************************************
     default ( with line-length-limitation and pretty print )
 *************************************************************************************/
@@ -81,14 +116,22 @@ static void CC vdfo_print_col_default( void *item, void *data )
     }
 
     /* FINALLY we print the content of a column... */
-    KOutMsg( "%s\n", r_ctx->s_col.buf );
+    rc = vdfo_puts( r_ctx, r_ctx->s_col.buf );
+    if ( rc == 0 )
+        vdfo_puts( r_ctx, "\n" );
 }
 
 static rc_t vdfo_print_row_default( const p_row_context r_ctx )
 {
     rc_t rc = 0;
     if ( r_ctx->ctx->print_row_id )
-        rc = KOutMsg( "ROW-ID = %u\n", r_ctx->row_id );
+    {
+        rc = vdfo_puts( r_ctx, "ROW-ID = " );
+        if ( rc == 0 )
+            rc = vdfo_put_u64( r_ctx, r_ctx->row_id );
+        if ( rc == 0 )
+            rc = vdfo_puts( r_ctx, "\n" );
+    }
 
     if ( rc == 0 )
         VectorForEach( &(r_ctx->col_defs->cols), false, vdfo_print_col_default, r_ctx );
@@ -97,7 +140,7 @@ static rc_t vdfo_print_row_default( const p_row_context r_ctx )
     {
         uint16_t i=0;
         while ( i++ < r_ctx->ctx->lf_after_row && rc == 0 )
-            rc = KOutMsg( "\n" );
+            rc = vdfo_puts( r_ctx, "\n" );
     }
     return 0;
 }
@@ -140,7 +183,9 @@ static rc_t vdfo_print_row_csv( const p_row_context r_ctx )
     {
         r_ctx->col_nr = 0;
         VectorForEach( &(r_ctx->col_defs->cols), false, vdfo_print_col_csv, r_ctx );
-        rc = KOutMsg( "%s\n", r_ctx->s_col.buf );
+        rc = vdfo_puts( r_ctx, r_ctx->s_col.buf );
+        if ( rc == 0 )
+            rc = vdfo_puts( r_ctx, "\n" );
     }
     return rc;
 }
@@ -150,13 +195,25 @@ static rc_t vdfo_print_row_csv( const p_row_context r_ctx )
 *************************************************************************************/
 static void CC vdfo_print_col_xml( void *item, void *data )
 {
+    rc_t rc;
     p_col_def my_col_def = (p_col_def)item;
+    p_row_context r_ctx = (p_row_context)data;
     if ( my_col_def->valid == false ) return;
     if ( my_col_def->excluded == true ) return;
 
-    KOutMsg( " <%s>\n", my_col_def->name );
-    KOutMsg( "%s", my_col_def->content.buf );
-    KOutMsg( " </%s>\n", my_col_def->name );
+    rc = vdfo_puts( r_ctx, " <" );
+    if ( rc == 0 )
+        rc = vdfo_puts( r_ctx, my_col_def->name );
+    if ( rc == 0 )
+        rc = vdfo_puts( r_ctx, ">\n" );
+    if ( rc == 0 )
+        rc = vdfo_puts( r_ctx, my_col_def->content.buf );
+    if ( rc == 0 )
+        rc = vdfo_puts( r_ctx, " </" );
+    if ( rc == 0 )
+        rc = vdfo_puts( r_ctx, my_col_def->name );
+    if ( rc == 0 )
+        vdfo_puts( r_ctx, ">\n" );
 }
 
 static rc_t vdfo_print_row_xml( const p_row_context r_ctx )
@@ -165,11 +222,11 @@ static rc_t vdfo_print_row_xml( const p_row_context r_ctx )
     DISP_RC( rc, "dump_str_clear() failed" )
     if ( rc == 0 )
     {
-        rc = KOutMsg( "<row>\n" );
+        rc = vdfo_puts( r_ctx, "<row>\n" );
         if ( rc  == 0 )
         {
             VectorForEach( &(r_ctx->col_defs->cols), false, vdfo_print_col_xml, r_ctx );
-            rc = KOutMsg( "</row>\n");
+            rc = vdfo_puts( r_ctx, "</row>\n");
         }
     }
     return rc;
@@ -183,6 +240,7 @@ static void CC vdfo_print_col_json( void *item, void *data )
 {
     rc_t rc = 0;
     p_col_def my_col_def = (p_col_def)item;
+    p_row_context r_ctx = (p_row_context)data;
 
     if ( my_col_def->valid == false ) return;
     if ( my_col_def->excluded == true ) return;
@@ -208,7 +266,13 @@ static void CC vdfo_print_col_json( void *item, void *data )
     }
 
     if ( rc == 0 )
-        KOutMsg( ",\n\"%s\":%s", my_col_def->name, my_col_def->content.buf );
+        rc = vdfo_puts( r_ctx, ",\n\"" );
+    if ( rc == 0 )
+        rc = vdfo_puts( r_ctx, my_col_def->name );
+    if ( rc == 0 )
+        rc = vdfo_puts( r_ctx, "\":" );
+    if ( rc == 0 )
+        vdfo_puts( r_ctx, my_col_def->content.buf );
 }
 
 static rc_t vdfo_print_row_json( const p_row_context r_ctx )
@@ -217,14 +281,14 @@ static rc_t vdfo_print_row_json( const p_row_context r_ctx )
     DISP_RC( rc, "dump_str_clear() failed" )
     if ( rc == 0 )
     {
-        rc = KOutMsg( "{\n" );
+        rc = vdfo_puts( r_ctx, "{\n\"row_id\": " );
         if ( rc == 0 )
         {
-            rc = KOutMsg( "\"row_id\": %lu", r_ctx->row_id );
+            rc = vdfo_put_u64( r_ctx, r_ctx->row_id );
             if ( rc == 0 )
             {
                 VectorForEach( &(r_ctx->col_defs->cols), false, vdfo_print_col_json, r_ctx );
-                rc = KOutMsg( "\n},\n\n" );
+                rc = vdfo_puts( r_ctx, "\n},\n\n" );
             }
         }
     }
@@ -245,7 +309,14 @@ static void CC vdfo_print_col_piped( void *item, void *data )
     if ( my_col_def->excluded == true ) return;
 
     /* first we print the row_id and the column-name for every column! */
-    KOutMsg( "%lu, %s: ", r_ctx->row_id, my_col_def->name );
+    rc = vdfo_put_u64( r_ctx, r_ctx->row_id );
+    if ( rc == 0 )
+        rc = vdfo_puts( r_ctx, ", " );
+    if ( rc == 0 )
+        rc = vdfo_puts( r_ctx, my_col_def->name );
+    if ( rc == 0 )
+        rc = vdfo_puts( r_ctx, ": " );
+    if ( rc != 0 ) return;
 
     if ( ( my_col_def->type_desc.domain == vtdAscii )||
          ( my_col_def->type_desc.domain == vtdUnicode ) )
@@ -268,7 +339,9 @@ static void CC vdfo_print_col_piped( void *item, void *data )
     }
 
     if ( rc == 0 )
-        KOutMsg( "%s\n", my_col_def->content.buf );
+        rc = vdfo_puts( r_ctx, my_col_def->content.buf );
+    if ( rc == 0 )
+        vdfo_puts( r_ctx, "\n" );
 }
 
 
@@ -305,7 +378,7 @@ static rc_t vdfo_print_row_piped( const p_row_context r_ctx )
     if ( rc == 0 )
     {
         VectorForEach( &(r_ctx->col_defs->cols), false, vdfo_print_col_piped, r_ctx );
-        rc = KOutMsg( "\n" );
+        rc = vdfo_puts( r_ctx, "\n" );
     }
     return rc;
 }
@@ -318,7 +391,9 @@ static rc_t vdfo_print_row_tab( const p_row_context r_ctx )
     {
         r_ctx->col_nr = 0;
         VectorForEach( &(r_ctx->col_defs->cols), false, vdfo_print_col_tab, r_ctx );
-        rc = KOutMsg( "%s\n", r_ctx->s_col.buf );
+        rc = vdfo_puts( r_ctx, r_ctx->s_col.buf );
+        if ( rc == 0 )
+            rc = vdfo_puts( r_ctx, "\n" );
     }
     return rc;
 }
@@ -44,6 +44,9 @@ extern "C" {
 
 rc_t vdfo_print_row( const p_row_context r_ctx );
 
+/* writes the collected rows to the output-handler and clears them */
+rc_t vdfo_write( p_dump_str out );
+
 #ifdef __cplusplus
 }
 #endif
@@ -221,6 +221,24 @@ rc_t vds_append_str_no_limit_check( p_dump_str s, const char *s1 )
 }
 
 
+rc_t vds_append_buf( p_dump_str s, const char *s1, const size_t len )
+{
+    rc_t rc;
+    if ( ( s == NULL )||( s1 == NULL ) )
+    {
+        return RC( rcVDB, rcNoTarg, rcInserting, rcParam, rcNull );
+    }
+    rc = vds_inc_buffer( s, len );
+    if ( rc == 0 )
+    {
+        memmove( s->buf + s->str_len, s1, len );
+        s->str_len += len;
+        s->buf[ s->str_len ] = 0;
+    }
+    return rc;
+}
+
+
 rc_t vds_rinsert( p_dump_str s, const char *s1 )
 {
     size_t len;
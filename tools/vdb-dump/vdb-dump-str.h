@@ -75,6 +75,9 @@ rc_t vds_append_str( p_dump_str s, const char *s1 );
 /* appends the string, does not truncate */
 rc_t vds_append_str_no_limit_check( p_dump_str s, const char *s1 );
 
+/* appends len bytes, does not truncate, does not scan for the string-end */
+rc_t vds_append_buf( p_dump_str s, const char *s1, const size_t len );
+
 /* right-inserts the string at the end of the ev. limited string */
 rc_t vds_rinsert( p_dump_str s, const char *s1 );
 
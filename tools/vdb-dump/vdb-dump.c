@@ -42,6 +42,9 @@
 #include <kfs/directory.h>
 #include <kns/manager.h>
 
+#include <kproc/thread.h>
+#include <kproc/ordered-queue.h>
+
 #include <kapp/main.h>
 #include <kapp/args.h>
 
@@ -60,6 +63,7 @@
 #include <sysalloc.h>
 
 #include <stdlib.h>
+#include <string.h>
 #include <bitstr.h>
 
 #include "vdb-dump-num-gen.h"
@@ -108,6 +112,7 @@ static const char * gzip_usage[] = { "compress output using gzip", NULL };
 static const char * bzip2_usage[] = { "compress output using bzip2", NULL };
 static const char * outbuf_size_usage[] = { "size of output-buffer, 0...none", NULL };
 static const char * disable_mt_usage[] = { "disable multithreading", NULL };
+static const char * threads_usage[] = { "number of threads formatting rows, 1 to 64, default 1", NULL };
 
 OptDef DumpOptions[] =
 {
@@ -149,6 +154,7 @@ OptDef DumpOptions[] =
     { OPTION_BZIP2, NULL, NULL, bzip2_usage, 1, false, false },
     { OPTION_OUT_BUF_SIZE, NULL, NULL, outbuf_size_usage, 1, true, false },
     { OPTION_NO_MULTITHREAD, NULL, NULL, disable_mt_usage, 1, false, false },
+    { OPTION_THREADS, NULL, NULL, threads_usage, 1, true, false },
 };
 
 const char UsageDefaultName[] = "vdb-dump";
@@ -216,6 +222,7 @@ rc_t CC Usage ( const Args * args )
     HelpOptionLine ( NULL, OPTION_BZIP2, NULL, bzip2_usage );
     HelpOptionLine ( NULL, OPTION_OUT_BUF_SIZE, NULL, outbuf_size_usage );
     HelpOptionLine ( NULL, OPTION_NO_MULTITHREAD, NULL, disable_mt_usage );
+    HelpOptionLine ( NULL, OPTION_THREADS, "count", threads_usage );
     
     HelpOptionsStandard ();
 
@@ -262,9 +269,21 @@ static void CC vdm_read_cell_data( void *item, void *data )
     if ( my_col_def->excluded == true ) return;
 
     /* read the data of a cursor-cell: buffer-addr, offset and element-count
-       is stored in the dump_src-struct */
-    r_ctx->rc = VCursorCellData( r_ctx->cursor, my_col_def->idx, NULL, &src.buf,
-                                 &src.offset_in_bits, &src.number_of_elements );
+       is stored in the dump_src-struct, consecutive rows come from the
+       window of offsets kept per column instead of the cursor */
+    if ( my_col_def->window == NULL )
+    {
+        my_col_def->window = malloc( sizeof *( my_col_def->window ) );
+        if ( my_col_def->window == NULL )
+        {
+            r_ctx->rc = RC( rcExe, rcCursor, rcReading, rcMemory, rcExhausted );
+            return;
+        }
+        vdcw_init( my_col_def->window );
+    }
+    r_ctx->rc = vdcw_read( my_col_def->window, r_ctx->cursor, my_col_def->idx,
+                           r_ctx->row_id, &src.buf, &src.offset_in_bits,
+                           &src.number_of_elements );
     if ( r_ctx->rc != 0 )
     {
         if( UIError(r_ctx->rc, NULL, r_ctx->table) ) {
@@ -273,7 +292,7 @@ static void CC vdm_read_cell_data( void *item, void *data )
             PLOGERR( klogInt,
                      (klogInt,
                      r_ctx->rc,
-                     "VCursorCellData( col:$(col_name) at row #$(row_nr) ) failed",
+                     "vdcw_read( col:$(col_name) at row #$(row_nr) ) failed",
                      "col_name=%s,row_nr=%lu",
                       my_col_def->name, r_ctx->row_id ));
             /* be forgiving and continue if a cell cannot be read */
@@ -378,24 +397,80 @@ static void vdm_row_error( const char * fmt, rc_t rc, uint64_t row_id )
 
 }
 
+/*************************************************************************************
+    dump_one_row:
+    * set the row-id into the cursor and open the cursor-row
+    * loop throuh the columns
+    * close the row
+    * call print_row (vdb-dump-formats.c) which appends the row to r_ctx->out
+    * the collection of the text's for the columns "read_cell_data_and_dump()"
+      is separated from the actual printing "print_row()" !
+
+r_ctx   [IN] ... row-context ( cursor, dump_context, col_defs, row_id ... )
+*************************************************************************************/
+static rc_t vdm_dump_one_row( p_row_context r_ctx )
+{
+    r_ctx->rc = VCursorSetRowId( r_ctx->cursor, r_ctx->row_id );
+    if ( r_ctx->rc != 0 )
+    {
+        vdm_row_error( "VCursorSetRowId( row#$(row_nr) ) failed", 
+                       r_ctx->rc, r_ctx->row_id );
+    }
+    else
+    {
+        r_ctx->rc = VCursorOpenRow( r_ctx->cursor );
+        if ( r_ctx->rc != 0 )
+        {
+            vdm_row_error( "VCursorOpenRow( row#$(row_nr) ) failed", 
+                           r_ctx->rc, r_ctx->row_id );
+        }
+        else
+        {
+            /* first reset the string and valid-flag for every column */
+            vdcd_reset_content( r_ctx->col_defs );
+
+            /* read the data of every column and create a string for it */
+            VectorForEach( &(r_ctx->col_defs->cols),
+                           false, vdm_read_cell_data, r_ctx );
+
+            if ( r_ctx->rc == 0 )
+            {
+                /* prints the collected strings, in vdb-dump-formats.c */
+                if ( !r_ctx->ctx->sum_num_elem )
+                {
+                    r_ctx->rc = vdfo_print_row( r_ctx );
+                    if ( r_ctx->rc != 0 )
+                        vdm_row_error( "vdfo_print_row( row#$(row_nr) ) failed", 
+                               r_ctx->rc, r_ctx->row_id );
+                }
+            }
+            r_ctx->rc = VCursorCloseRow( r_ctx->cursor );
+            if ( r_ctx->rc != 0 )
+                vdm_row_error( "VCursorCloseRow( row#$(row_nr) ) failed", 
+                               r_ctx->rc, r_ctx->row_id );
+        }
+    }
+    return r_ctx->rc;
+}
+
+/* the formatted rows are written in blocks of about this size */
+#define VDM_OUT_BLOCK_SIZE ( 64 * 1024 )
+
 /*************************************************************************************
     dump_rows:
     * is the main loop to dump all rows or all selected rows ( -R1-10 )
     * creates a dump-string ( parameterizes it with the wanted max. line-len )
+    * creates the output-string collecting the formatted rows
     * starts the number-generator
     * as long as the number-generator has a number and the result-code is ok
-      do for every row-id:
-        - set the row-id into the cursor and open the cursor-row
-        - loop throuh the columns
-        - close the row
-        - call print_row (vdb-dump-formats.c) which actually prints the row
-    * the collection of the text's for the columns "read_cell_data_and_dump()"
-      is separated from the actual printing "print_row()" !
+      call "dump_one_row()" for every row-id, write the output-string if full
 
 r_ctx   [IN] ... row-context ( cursor, dump_context, col_defs ... )
 *************************************************************************************/
 static rc_t vdm_dump_rows( p_row_context r_ctx )
 {
+    dump_str out;
+
     /* the important row_id is a member of r_ctx ! */
     r_ctx->rc = vds_make( &(r_ctx->s_col), r_ctx->ctx->max_line_len, 512 );
     if ( r_ctx->rc != 0 )
@@ -403,67 +478,228 @@ static rc_t vdm_dump_rows( p_row_context r_ctx )
                         r_ctx->rc, r_ctx->row_id );
     if ( r_ctx->rc == 0 )
     {
-        vdn_start( r_ctx->ctx->row_generator );
-        while ( ( vdn_next( r_ctx->ctx->row_generator, &(r_ctx->row_id )) )&&
-                ( r_ctx->rc == 0 ) )
+        r_ctx->rc = vds_make( &out, 0, VDM_OUT_BLOCK_SIZE );
+        DISP_RC( r_ctx->rc, "dump_str_make() failed" );
+        if ( r_ctx->rc == 0 )
         {
-            r_ctx-> rc = Quitting();
-            if ( r_ctx->rc != 0 )
-                break;
-            r_ctx->rc = VCursorSetRowId( r_ctx->cursor, r_ctx->row_id );
-            if ( r_ctx->rc != 0 )
+            rc_t rc;
+
+            r_ctx->out = &out;
+            vdn_start( r_ctx->ctx->row_generator );
+            while ( ( vdn_next( r_ctx->ctx->row_generator, &(r_ctx->row_id )) )&&
+                    ( r_ctx->rc == 0 ) )
             {
-                vdm_row_error( "VCursorSetRowId( row#$(row_nr) ) failed", 
-                               r_ctx->rc, r_ctx->row_id );
+                r_ctx-> rc = Quitting();
+                if ( r_ctx->rc != 0 )
+                    break;
+                if ( vdm_dump_one_row( r_ctx ) == 0 && out.str_len >= VDM_OUT_BLOCK_SIZE )
+                    r_ctx->rc = vdfo_write( &out );
             }
-            else
+            if ( r_ctx->rc == 0 && r_ctx->ctx->sum_num_elem )
             {
-                r_ctx->rc = VCursorOpenRow( r_ctx->cursor );
-                if ( r_ctx->rc != 0 )
+                VectorForEach( &(r_ctx->col_defs->cols),
+                               false, vdm_print_elem_sum, r_ctx );
+                if ( r_ctx->rc == 0 )
                 {
-                    vdm_row_error( "VCursorOpenRow( row#$(row_nr) ) failed", 
-                                   r_ctx->rc, r_ctx->row_id );
+                    r_ctx->rc = vdfo_print_row( r_ctx );
+                    DISP_RC( r_ctx->rc, "VTableOpenSchema() failed" );
                 }
-                else
-                {
-                    /* first reset the string and valid-flag for every column */
-                    vdcd_reset_content( r_ctx->col_defs );
+            }
+
+            /* what was formatted before an error is written too */
+            rc = vdfo_write( &out );
+            if ( r_ctx->rc == 0 )
+                r_ctx->rc = rc;
+            r_ctx->out = NULL;
+            vds_free( &out );
+        }
+        vds_free( &(r_ctx->s_col) );
+    }
+    return r_ctx->rc;
+}
 
-                    /* read the data of every column and create a string for it */
-                    VectorForEach( &(r_ctx->col_defs->cols),
-                                   false, vdm_read_cell_data, r_ctx );
 
-                    if ( r_ctx->rc == 0 )
-                    {
-                        /* prints the collected strings, in vdb-dump-formats.c */
-                        if ( !r_ctx->ctx->sum_num_elem )
-                        {
-                            r_ctx->rc = vdfo_print_row( r_ctx );
-                            if ( r_ctx->rc != 0 )
-                                vdm_row_error( "vdfo_print_row( row#$(row_nr) ) failed", 
-                                       r_ctx->rc, r_ctx->row_id );
-                        }
-                    }
-                    r_ctx->rc = VCursorCloseRow( r_ctx->cursor );
-                    if ( r_ctx->rc != 0 )
-                        vdm_row_error( "VCursorCloseRow( row#$(row_nr) ) failed", 
-                                       r_ctx->rc, r_ctx->row_id );
-                }
-            }
+/*************************************************************************************
+    parallel dump:
+    * a producer-thread cuts the rows of the number-generator into chunks,
+      chunk-boundaries follow the blobs of the first physical column
+    * every worker-thread has its own cursor and col-defs, it formats a
+      whole chunk into the output-string of the chunk
+    * the main thread writes the output-strings of the chunks in row-order
+*************************************************************************************/
+
+/* a chunk has at least VDM_CHUNK_ROWS rows, more to reach the end of a blob,
+   but never more than VDM_CHUNK_MAX_ROWS */
+#define VDM_CHUNK_ROWS 1024
+#define VDM_CHUNK_MAX_ROWS ( 16 * VDM_CHUNK_ROWS )
+
+typedef struct vdm_chunk
+{
+    KOrderedItem dad;       /* done once the rows are formatted */
+    uint64_t *rows;
+    uint32_t count;
+    dump_str out;
+    rc_t rc;
+} vdm_chunk;
+
+typedef struct vdm_parallel
+{
+    p_dump_context ctx;
+    const KColumn *kcol;    /* the column defining the blob-boundaries, can be NULL */
+    KOrderedQueue *queue;   /* chunks waiting for a worker, written in row-order */
+} vdm_parallel;
+
+typedef struct vdm_worker
+{
+    vdm_parallel *par;
+    KThread *thread;
+    row_context r_ctx;
+    bool usable;
+} vdm_worker;
+
+
+static vdm_chunk * vdm_chunk_make( void )
+{
+    vdm_chunk * chunk = calloc( 1, sizeof *chunk );
+    if ( chunk != NULL )
+    {
+        chunk->rows = malloc( VDM_CHUNK_MAX_ROWS * sizeof chunk->rows[ 0 ] );
+        if ( chunk->rows != NULL )
+        {
+            if ( vds_make( &(chunk->out), 0, VDM_OUT_BLOCK_SIZE ) == 0 )
+                return chunk;
+            free( chunk->rows );
         }
-        if ( r_ctx->rc == 0 && r_ctx->ctx->sum_num_elem )
+        free( chunk );
+    }
+    return NULL;
+}
+
+
+static void vdm_chunk_whack( vdm_chunk * chunk )
+{
+    vds_free( &(chunk->out) );
+    free( chunk->rows );
+    free( chunk );
+}
+
+
+static void CC vdm_chunk_whack_item( KOrderedItem * item, void * data )
+{
+    vdm_chunk_whack( ( vdm_chunk * )item );
+}
+
+
+/* the last row-id in the blob of the boundary-column containing row_id */
+static int64_t vdm_blob_end( const KColumn * kcol, int64_t row_id )
+{
+    int64_t last = row_id;
+    if ( kcol != NULL )
+    {
+        const KColumnBlob *blob;
+        if ( KColumnOpenBlobRead( kcol, &blob, row_id ) == 0 )
         {
-            VectorForEach( &(r_ctx->col_defs->cols),
-                           false, vdm_print_elem_sum, r_ctx );
-            if ( r_ctx->rc == 0 )
+            int64_t first;
+            uint32_t count;
+            if ( KColumnBlobIdRange( blob, &first, &count ) == 0 && count > 0 )
+                last = first + count - 1;
+            KColumnBlobRelease( blob );
+        }
+    }
+    return last;
+}
+
+
+static rc_t CC vdm_produce_chunks( const KThread *self, void *data )
+{
+    vdm_parallel * par = data;
+    vdm_chunk * chunk = NULL;
+    int64_t blob_end = 0;
+    uint64_t row_id;
+    rc_t rc = 0;
+
+    vdn_start( par->ctx->row_generator );
+    while ( rc == 0 && !KOrderedQueueQuitting( par->queue ) && vdn_next( par->ctx->row_generator, &row_id ) )
+    {
+        if ( chunk != NULL &&
+             ( ( chunk->count >= VDM_CHUNK_ROWS && ( int64_t )row_id > blob_end ) ||
+               chunk->count >= VDM_CHUNK_MAX_ROWS ) )
+        {
+            rc = KOrderedQueueSubmit( par->queue, &(chunk->dad), true );
+            chunk = NULL;
+        }
+        if ( rc == 0 && chunk == NULL )
+        {
+            chunk = vdm_chunk_make();
+            if ( chunk == NULL )
+                rc = RC( rcExe, rcCursor, rcReading, rcMemory, rcExhausted );
+        }
+        if ( rc == 0 )
+        {
+            if ( ( int64_t )row_id > blob_end )
+                blob_end = vdm_blob_end( par->kcol, row_id );
+            chunk->rows[ chunk->count++ ] = row_id;
+        }
+    }
+
+    if ( chunk != NULL )
+    {
+        if ( rc == 0 )
+            rc = KOrderedQueueSubmit( par->queue, &(chunk->dad), true );
+        else
+            vdm_chunk_whack( chunk );
+    }
+
+    KOrderedQueueSeal( par->queue );
+    return rc;
+}
+
+
+static rc_t CC vdm_format_chunks( const KThread *self, void *data )
+{
+    vdm_worker * w = data;
+    KOrderedItem * item;
+
+    while ( KOrderedQueueWork( w->par->queue, &item ) == 0 && item != NULL )
+    {
+        vdm_chunk * chunk = ( vdm_chunk * )item;
+        uint32_t i;
+
+        w->r_ctx.out = &(chunk->out);
+        w->r_ctx.rc = 0;
+        for ( i = 0; i < chunk->count && w->r_ctx.rc == 0 && !KOrderedQueueQuitting( w->par->queue ); ++i )
+        {
+            w->r_ctx.row_id = chunk->rows[ i ];
+            vdm_dump_one_row( &(w->r_ctx) );
+        }
+        chunk->rc = w->r_ctx.rc;
+        w->r_ctx.out = NULL;
+        KOrderedQueueDone( w->par->queue, item );
+    }
+    return 0;
+}
+
+
+/* the first selected column that is physical decides the chunk-boundaries */
+static const KColumn * vdm_boundary_column( const VTable *my_table, p_col_defs col_defs )
+{
+    const KColumn * kcol = NULL;
+    const KTable * ktable;
+    if ( VTableOpenKTableRead( my_table, &ktable ) == 0 )
+    {
+        uint32_t idx, count = VectorLength( &(col_defs->cols) );
+        for ( idx = 0; idx < count && kcol == NULL; ++idx )
+        {
+            p_col_def col_def = ( p_col_def ) VectorGet( &(col_defs->cols), idx );
+            if ( col_def != NULL && col_def->valid && !col_def->excluded )
             {
-                r_ctx->rc = vdfo_print_row( r_ctx );
-                DISP_RC( r_ctx->rc, "VTableOpenSchema() failed" );
+                if ( KTableOpenColumnRead( ktable, &kcol, "%s", col_def->name ) != 0 )
+                    kcol = NULL;
             }
         }
-        vds_free( &(r_ctx->s_col) );
+        KTableRelease( ktable );
     }
-    return r_ctx->rc;
+    return kcol;
 }
 
 
@@ -513,90 +749,233 @@ static bool vdm_extract_or_parse_phys_columns( const p_dump_context ctx,
 }
 
 /*************************************************************************************
-    dump_tab_table:
-    * called by "dump_db_table()" and "dump_tab()" as a fkt-pointer
+    open_row_cursor:
     * opens a cursor to read
     * checks if the user did not specify columns, or wants all columns ( "*" )
         no columns specified ---> calls "col_defs_extract_from_table()"
         columns specified ---> calls "col_defs_parse_string()"
-    * we end up with a list of column-definitions (name,type) in my_col_defs
+    * we end up with a list of column-definitions (name,type) in r_ctx->col_defs
     * calls "col_defs_add_to_cursor()" to add them to the cursor
     * opens the cursor
-    * calls "dump_rows()" to execute the dump
-    * destroys the my_col_defs - structure
-    * releases the cursor
+    * "usable" is false if there is nothing to dump, that is not an error
+    * "close_row_cursor()" has to be called even if this fails
 
 ctx       [IN] ... contains path, tablename, columns, row-range etc.
 my_table  [IN] ... open table needed for vdb-calls
+r_ctx     [OUT] .. receives the cursor and the column-definitions
 *************************************************************************************/
-static rc_t vdm_dump_opened_table( const p_dump_context ctx, const VTable *my_table )
+static rc_t vdm_open_row_cursor( const p_dump_context ctx, const VTable *my_table,
+                                 p_row_context r_ctx, bool *usable )
 {
-    row_context r_ctx;
-    rc_t rc = VTableCreateCachedCursorRead( my_table, &(r_ctx.cursor), ctx->cur_cache_size );
+    rc_t rc;
+
+    *usable = false;
+    r_ctx->table = my_table;
+    r_ctx->ctx = ctx;
+    r_ctx->col_defs = NULL;
+    r_ctx->out = NULL;
+    rc = VTableCreateCachedCursorRead( my_table, &(r_ctx->cursor), ctx->cur_cache_size );
     DISP_RC( rc, "VTableCreateCursorRead() failed" );
+    if ( rc != 0 )
+        r_ctx->cursor = NULL;
+    else if ( !vdcd_init( &(r_ctx->col_defs), ctx->max_line_len ) )
+    {
+        rc = RC( rcVDB, rcNoTarg, rcConstructing, rcMemory, rcExhausted );
+        DISP_RC( rc, "col_defs_init() failed" );
+    }
+    else if ( vdm_extract_or_parse_columns( ctx, my_table, r_ctx->col_defs ) )
+    {
+        if ( vdcd_add_to_cursor( r_ctx->col_defs, r_ctx->cursor ) )
+        {
+            const VSchema *my_schema;
+            rc = VTableOpenSchema( my_table, &my_schema );
+            DISP_RC( rc, "VTableOpenSchema() failed" );
+            if ( rc == 0 )
+            {
+            /* translate in special columns to numeric values to strings */
+                vdcd_ins_trans_fkt( r_ctx->col_defs, my_schema );
+                VSchemaRelease( my_schema );
+            }
+
+            rc = VCursorOpen( r_ctx->cursor );
+            DISP_RC( rc, "VCursorOpen() failed" );
+            *usable = ( rc == 0 );
+        }
+    }
+    return rc;
+}
+
+
+static void vdm_close_row_cursor( p_row_context r_ctx )
+{
+    vdcd_destroy( r_ctx->col_defs );
+    VCursorRelease( r_ctx->cursor );
+}
+
+
+/*************************************************************************************
+    dump_rows_parallel:
+    * opens a cursor and col-defs for every worker
+    * starts the workers and the producer ( see "parallel dump" above )
+    * writes the output of the chunks in row-order
+    * stops everything at the first error, the output of the rows
+      before the error is written, as "dump_rows()" does
+
+r_ctx   [IN] ... row-context of the main cursor ( dump_context, col_defs ... )
+*************************************************************************************/
+static rc_t vdm_dump_rows_parallel( p_row_context r_ctx, uint32_t threads )
+{
+    vdm_parallel par;
+    vdm_worker * workers;
+    KThread * producer = NULL;
+    uint32_t i, started = 0;
+    rc_t rc;
+
+    memset( &par, 0, sizeof par );
+    par.ctx = r_ctx->ctx;
+
+    workers = calloc( threads, sizeof *workers );
+    if ( workers == NULL )
+        return RC( rcExe, rcCursor, rcReading, rcMemory, rcExhausted );
+
+    rc = KOrderedQueueMake( &par.queue, threads * 2, threads * 4, vdm_chunk_whack_item, NULL );
+    DISP_RC( rc, "creating the thread-queues failed" );
+
+    /* every worker needs its own cursor, the columns are the same as in r_ctx */
+    for ( i = 0; i < threads && rc == 0; ++i )
+    {
+        workers[ i ].par = &par;
+        rc = vdm_open_row_cursor( r_ctx->ctx, r_ctx->table, &(workers[ i ].r_ctx), &(workers[ i ].usable) );
+        if ( rc == 0 && workers[ i ].usable )
+        {
+            rc = vds_make( &(workers[ i ].r_ctx.s_col), r_ctx->ctx->max_line_len, 512 );
+            DISP_RC( rc, "dump_str_make() failed" );
+        }
+        else if ( rc == 0 )
+            rc = RC( rcExe, rcCursor, rcOpening, rcColumn, rcNotFound );
+    }
+
     if ( rc == 0 )
     {
-        r_ctx.table = my_table;
-        if ( !vdcd_init( &(r_ctx.col_defs), ctx->max_line_len ) )
+        par.kcol = vdm_boundary_column( r_ctx->table, r_ctx->col_defs );
+        for ( i = 0; i < threads && rc == 0; ++i )
         {
-            rc = RC( rcVDB, rcNoTarg, rcConstructing, rcMemory, rcExhausted );
-            DISP_RC( rc, "col_defs_init() failed" );
+            rc = KThreadMake( &(workers[ i ].thread), vdm_format_chunks, &workers[ i ] );
+            DISP_RC( rc, "KThreadMake() failed" );
+            if ( rc == 0 )
+                started++;
+        }
+        if ( rc == 0 )
+        {
+            rc = KThreadMake( &producer, vdm_produce_chunks, &par );
+            DISP_RC( rc, "KThreadMake() failed" );
         }
 
         if ( rc == 0 )
         {
-            if ( vdm_extract_or_parse_columns( ctx, my_table, r_ctx.col_defs ) )
+            KOrderedItem * item;
+            while ( KOrderedQueueNext( par.queue, &item ) == 0 && item != NULL )
             {
-                if ( vdcd_add_to_cursor( r_ctx.col_defs, r_ctx.cursor ) )
+                vdm_chunk * chunk = ( vdm_chunk * )item;
+                if ( rc == 0 )
                 {
-                    const VSchema *my_schema;
-                    rc = VTableOpenSchema( my_table, &my_schema );
-                    DISP_RC( rc, "VTableOpenSchema() failed" );
+                    rc = vdfo_write( &(chunk->out) );
                     if ( rc == 0 )
-                    {
-                    /* translate in special columns to numeric values to strings */
-                        vdcd_ins_trans_fkt( r_ctx.col_defs, my_schema );
-                        VSchemaRelease( my_schema );
-                    }
-
-                    rc = VCursorOpen( r_ctx.cursor );
-                    DISP_RC( rc, "VCursorOpen() failed" );
+                        rc = chunk->rc;
                     if ( rc == 0 )
-                    {
-                        int64_t  first;
-                        uint64_t count;
-                        rc = VCursorIdRange( r_ctx.cursor, 0, &first, &count );
-                        DISP_RC( rc, "VCursorIdRange() failed" );
-                        if ( rc == 0 )
-                        {
-                            /* if the user did not specify a row-range, take all rows */
-                            if ( vdn_range_defined( ctx->row_generator ) == false )
-                            {
-                                vdn_set_range( ctx->row_generator, first, count );
-                            }
-                            /* if the user did specify a row-range, check the boundaries */
-                            else
-                            {
-                                vdn_check_range( ctx->row_generator, first, count );
-                            }
-
-                            if ( vdn_range_defined( ctx->row_generator ) )
-                            {
-                                r_ctx.ctx = ctx;
-                                rc = vdm_dump_rows( &r_ctx ); /* <--- */
-                            }
-                            else
-                            {
-                                rc = RC( rcExe, rcDatabase, rcReading, rcRange, rcEmpty );
-                            }
-                        }
-                    }
+                        rc = Quitting();
+                    if ( rc != 0 )
+                        KOrderedQueueQuit( par.queue );
                 }
+                vdm_chunk_whack( chunk );
+            }
+        }
+        else
+        {
+            KOrderedQueueQuit( par.queue );
+            KOrderedQueueSeal( par.queue );
+        }
+
+        if ( producer != NULL )
+        {
+            rc_t rc1;
+            KThreadWait( producer, &rc1 );
+            KThreadRelease( producer );
+            if ( rc == 0 )
+                rc = rc1;
+        }
+        for ( i = 0; i < started; ++i )
+        {
+            KThreadWait( workers[ i ].thread, NULL );
+            KThreadRelease( workers[ i ].thread );
+        }
+        KColumnRelease( par.kcol );
+    }
+
+    for ( i = 0; i < threads; ++i )
+    {
+        if ( workers[ i ].usable )
+            vds_free( &(workers[ i ].r_ctx.s_col) );
+        if ( workers[ i ].par != NULL )
+            vdm_close_row_cursor( &(workers[ i ].r_ctx) );
+    }
+    free( workers );
+
+    KOrderedQueueRelease( par.queue );
+    return rc;
+}
+
+
+/*************************************************************************************
+    dump_tab_table:
+    * called by "dump_db_table()" and "dump_tab()" as a fkt-pointer
+    * opens the cursor with the requested columns ( "open_row_cursor()" )
+    * calls "dump_rows()" or "dump_rows_parallel()" to execute the dump
+    * destroys the my_col_defs - structure
+    * releases the cursor
+
+ctx       [IN] ... contains path, tablename, columns, row-range etc.
+my_table  [IN] ... open table needed for vdb-calls
+*************************************************************************************/
+static rc_t vdm_dump_opened_table( const p_dump_context ctx, const VTable *my_table )
+{
+    row_context r_ctx;
+    bool usable;
+    rc_t rc = vdm_open_row_cursor( ctx, my_table, &r_ctx, &usable );
+    if ( rc == 0 && usable )
+    {
+        int64_t  first;
+        uint64_t count;
+        rc = VCursorIdRange( r_ctx.cursor, 0, &first, &count );
+        DISP_RC( rc, "VCursorIdRange() failed" );
+        if ( rc == 0 )
+        {
+            /* if the user did not specify a row-range, take all rows */
+            if ( vdn_range_defined( ctx->row_generator ) == false )
+            {
+                vdn_set_range( ctx->row_generator, first, count );
+            }
+            /* if the user did specify a row-range, check the boundaries */
+            else
+            {
+                vdn_check_range( ctx->row_generator, first, count );
+            }
+
+            if ( vdn_range_defined( ctx->row_generator ) )
+            {
+                /* the element-sum is collected in one set of col-defs */
+                if ( ctx->threads > 1 && !ctx->sum_num_elem )
+                    rc = vdm_dump_rows_parallel( &r_ctx, ctx->threads );
+                else
+                    rc = vdm_dump_rows( &r_ctx ); /* <--- */
+            }
+            else
+            {
+                rc = RC( rcExe, rcDatabase, rcReading, rcRange, rcEmpty );
             }
-            vdcd_destroy( r_ctx.col_defs );
         }
-        VCursorRelease( r_ctx.cursor );
     }
+    vdm_close_row_cursor( &r_ctx );
     return rc;
 }
 